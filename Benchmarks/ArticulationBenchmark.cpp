@@ -0,0 +1,544 @@
+//=========================================================================================================
+// ArticulationBenchmark.cpp: Chains and Trees of Links in Reduced Coordinates
+// - Checks: a pendulum and a swinging chain holding their energy, the links of a long chain staying joined,
+//   hinge and slider limits, drives reaching their targets, a floating base falling freely, a box resting
+//   on a driven arm and the ground holding a floating articulation up, destroying a link body, and the
+//   same results on one thread and several, and the articulation passes solving only the islands an
+//   articulation's links are in
+// - Reports the joint error and time per step of swinging chains of 10, 50 and 200 links, as
+//   articulations and as bodies held by the iterative joints, and the step time of resting boxes with an
+//   articulation far away
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "PhysicsWorld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	const float StepTime = 1.0f / 60;
+	const float Gravity = 9.81f;
+
+	const Shape Box = ShapeBox({ 0.2f, 0.2f, 0.2f });
+	const Shape Ground = ShapeBox({ 10, 0.5f, 10 });
+
+	std::unique_ptr<PhysicsWorld> ArticulationWorld(unsigned int threads = 1)
+	{
+		PhysicsSettings settings;
+		settings.allowSleeping = false;
+		settings.threadCount = threads;
+		return std::make_unique<PhysicsWorld>(settings);
+	}
+
+	// A link of 1 kg hinged about z at the origin, its centre at position
+	ArticulationLinkDesc HingeLink(const Vector3f& position)
+	{
+		ArticulationLinkDesc link;
+		link.body.position = position;
+		link.body.inverseMass = 1;
+		link.body.inverseInertia = { 100, 100, 100 };
+		link.joint = JointType::Hinge;
+		link.axis = { 0, 0, 1 };
+		return link;
+	}
+
+	// Kinetic and potential energy of an articulation's links
+	float Energy(const PhysicsWorld& world, ArticulationHandle articulation, const Vector3f& inverseInertia)
+	{
+		float energy = 0;
+		const Articulation& a = world.GetArticulation(articulation);
+		for (std::size_t link = 0; link < a.LinkCount(); ++link)
+		{
+			const BodyHandle body = a.LinkBody(link);
+			const Vector3f w = Rotate(Conjugate(world.Orientation(body)), world.AngularVelocity(body));
+			energy += 0.5f * world.LinearVelocity(body).LengthSq() + Gravity * world.Position(body).y;
+			energy += 0.5f * (w.x * w.x / inverseInertia.x + w.y * w.y / inverseInertia.y + w.z * w.z / inverseInertia.z);
+		}
+		return energy;
+	}
+
+	// A 0.5m pendulum released level swings for four seconds. Its energy (mgl = 4.9 J) must hold to 1%
+	bool PendulumEnergy()
+	{
+		std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+		ArticulationDesc desc;
+		desc.links.push_back(HingeLink({ 0.5f, 0, 0 }));
+		const ArticulationHandle pendulum = world->CreateArticulation(desc);
+
+		float worst = 0;
+		for (int step = 0; step < 240; ++step)
+		{
+			world->Step(StepTime);
+			worst = std::max(worst, std::abs(Energy(*world, pendulum, { 100, 100, 100 })));
+		}
+		return worst < 0.01f * Gravity * 0.5f;
+	}
+
+	// count chains of links ball jointed end to end, hanging from the world a metre apart, set off swinging
+	// from 1 radian. Links 0.2m long, as JointBenchmark.cpp's chains
+	const float LinkLength = 0.2f;
+	const Vector3f ChainDown = { std::sin(1.0f), -std::cos(1.0f), 0 };
+
+	ArticulationDesc ChainDesc(int links, const Vector3f& top, int substeps)
+	{
+		ArticulationDesc desc;
+		desc.substeps = substeps;
+		for (int i = 0; i < links; ++i)
+		{
+			ArticulationLinkDesc link;
+			link.body.position = top + ChainDown * (LinkLength * (i + 0.5f));
+			link.body.inverseMass = 1;
+			link.body.inverseInertia = { 100, 100, 100 };
+			link.parent = i - 1;
+			link.joint = JointType::Ball;
+			link.anchor = top + ChainDown * (LinkLength * i);
+			desc.links.push_back(link);
+		}
+		return desc;
+	}
+
+	// Furthest a link's end is from the end of the link above, or from the top
+	float ChainGap(const PhysicsWorld& world, ArticulationHandle chain, const Vector3f& top)
+	{
+		const Articulation& a = world.GetArticulation(chain);
+		const Vector3f halfLink = ChainDown * (LinkLength * 0.5f);
+		float worst = 0;
+		Vector3f above = top;
+		for (std::size_t link = 0; link < a.LinkCount(); ++link)
+		{
+			const Transformf transform = world.BodyTransform(a.LinkBody(link));
+			worst = std::max(worst, (transform.TransformPoint(-halfLink) - above).Length());
+			above = transform.TransformPoint(halfLink);
+		}
+		return worst;
+	}
+
+	// A 50 link chain swings for four seconds: its links stay joined and its energy holds to 0.1%
+	bool ChainHolds()
+	{
+		std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+		const ArticulationHandle chain = world->CreateArticulation(ChainDesc(50, { 0, 0, 0 }, 1));
+		const float start = Energy(*world, chain, { 100, 100, 100 });
+
+		float gap = 0, drift = 0;
+		for (int step = 0; step < 240; ++step)
+		{
+			world->Step(StepTime);
+			gap = std::max(gap, ChainGap(*world, chain, { 0, 0, 0 }));
+			drift = std::max(drift, std::abs(Energy(*world, chain, { 100, 100, 100 }) - start));
+		}
+		return gap < 1e-4f && drift < 1e-3f * std::abs(start);
+	}
+
+	// A link swinging down from level on a hinge limited to -0.5 radians stops there
+	bool HingeLimit()
+	{
+		std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+		ArticulationDesc desc;
+		ArticulationLinkDesc link = HingeLink({ 0.5f, 0, 0 });
+		link.limited = true;
+		link.lower = -0.5f;
+		link.upper = 0.5f;
+		desc.links.push_back(link);
+		const ArticulationHandle arm = world->CreateArticulation(desc);
+
+		float lowest = 0;
+		for (int step = 0; step < 120; ++step)
+		{
+			world->Step(StepTime);
+			lowest = std::min(lowest, world->ArticulationJointPosition(arm, 0));
+		}
+		return lowest > -0.52f && std::abs(world->ArticulationJointPosition(arm, 0) + 0.5f) < 0.01f;
+	}
+
+	// A link on a vertical slider falls to the bottom of its travel, then a drive lifts it to the top
+	bool SliderLimitAndDrive()
+	{
+		std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+		ArticulationDesc desc;
+		ArticulationLinkDesc link = HingeLink({ 0, 0, 0 });
+		link.joint = JointType::Slider;
+		link.axis = { 0, 1, 0 };
+		link.limited = true;
+		link.lower = -0.5f;
+		link.upper = 0.5f;
+		desc.links.push_back(link);
+		const ArticulationHandle slider = world->CreateArticulation(desc);
+		for (int step = 0; step < 60; ++step)
+			world->Step(StepTime);
+		const bool atLimit = std::abs(world->ArticulationJointPosition(slider, 0) + 0.5f) < 0.01f;
+
+		// Aimed past the limit, the drive holds the link against it
+		world->SetArticulationDrive(slider, 0, 1000, 100, 1, 0);
+		for (int step = 0; step < 120; ++step)
+			world->Step(StepTime);
+		return atLimit && std::abs(world->ArticulationJointPosition(slider, 0) - 0.5f) < 0.01f;
+	}
+
+	// Two links on driven hinges lift themselves from hanging to their targets and hold there against
+	// gravity. An extremely stiff drive is as steady as a soft one, only closer to its target
+	bool DrivesReachTargets()
+	{
+		bool passed = true;
+		for (float stiffness : { 1e3f, 1e8f })
+		{
+			std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+			ArticulationDesc desc;
+			ArticulationLinkDesc link = HingeLink({ 0, -0.25f, 0 });
+			link.driveStiffness = stiffness;
+			link.driveDamping = stiffness * 0.1f;
+			link.driveTarget = 1;
+			desc.links.push_back(link);
+			link.body.position = { 0, -0.75f, 0 };
+			link.anchor = { 0, -0.5f, 0 };
+			link.parent = 0;
+			link.driveTarget = 0.5f;
+			desc.links.push_back(link);
+			const ArticulationHandle arm = world->CreateArticulation(desc);
+
+			for (int step = 0; step < 240; ++step)
+				world->Step(StepTime);
+			const float sag = std::max(20 / stiffness, 1e-4f); // Roughly the gravity torque over the stiffness
+			passed &= std::abs(world->ArticulationJointPosition(arm, 0) - 1) < sag && std::abs(world->ArticulationJointPosition(arm, 1) - 0.5f) < sag;
+			passed &= std::abs(world->ArticulationJointSpeed(arm, 0)) < 1e-3f && std::abs(world->ArticulationJointSpeed(arm, 1)) < 1e-3f;
+		}
+		return passed;
+	}
+
+	// Three links on hinges with a floating root, thrown spinning: their centre of mass falls as a single
+	// body would, and the links stay joined
+	bool FloatingBaseFalls()
+	{
+		std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+		ArticulationDesc desc = ChainDesc(3, { 0, 10, 0 }, 1);
+		desc.floatingBase = true;
+		const ArticulationHandle body = world->CreateArticulation(desc);
+		world->SetLinearVelocity(world->ArticulationLinkBody(body, 0), { 1, 0, 0 });
+
+		auto centre = [&]
+		{
+			Vector3f sum = { 0, 0, 0 };
+			for (std::size_t link = 0; link < 3; ++link)
+				sum += world->Position(world->ArticulationLinkBody(body, link)) * (1.0f / 3);
+			return sum;
+		};
+		const Vector3f start = centre();
+		const int steps = 60;
+		for (int step = 0; step < steps; ++step)
+			world->Step(StepTime);
+
+		// Setting a link body's velocity doesn't reach the articulation, only contacts and forces do
+		const float time = steps * StepTime;
+		const Vector3f expected = start - Vector3f(0, 0.5f * Gravity * time * time, 0);
+		return (centre() - expected).Length() < 1e-3f && ChainGap(*world, body, world->Position(world->ArticulationLinkBody(body, 0)) - ChainDown * (LinkLength * 0.5f)) < 1e-4f;
+	}
+
+	// A box dropped on the middle of a level arm held up by a drive comes to rest on it, tipping the arm by
+	// the extra torque over the drive's stiffness. The contact impulses reach the articulation
+	bool BoxRestsOnArm()
+	{
+		const Shape plank = ShapeBox({ 0.5f, 0.05f, 0.2f });
+		const float stiffness = 1000;
+		std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+		ArticulationDesc desc;
+		ArticulationLinkDesc link = HingeLink({ 0.5f, 0, 0 });
+		link.body.shape = &plank;
+		link.driveStiffness = stiffness;
+		link.driveDamping = 100;
+		desc.links.push_back(link);
+		const ArticulationHandle arm = world->CreateArticulation(desc);
+
+		BodyDesc box;
+		box.position = { 0.5f, 0.5f, 0 };
+		box.inverseInertia = { 20, 20, 20 };
+		box.shape = &Box;
+		const BodyHandle dropped = world->CreateBody(box);
+
+		for (int step = 0; step < 240; ++step)
+			world->Step(StepTime);
+
+		// The arm's own weight at 0.5m and the box's at about 0.5m
+		const float expected = -(Gravity * 0.5f + Gravity * 0.5f) / stiffness;
+		const BodyHandle armBody = world->ArticulationLinkBody(arm, 0);
+		const float boxHeight = Dot(world->Position(dropped) - world->Position(armBody), Rotate(world->Orientation(armBody), Vector3f(0, 1, 0)));
+		return std::abs(world->ArticulationJointPosition(arm, 0) - expected) < 0.002f && std::abs(boxHeight - 0.25f) < 0.01f &&
+		       world->LinearVelocity(dropped).Length() < 0.01f;
+	}
+
+	// A floating three link articulation dropped on the ground comes to rest on it
+	bool RestsOnGround()
+	{
+		std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+		BodyDesc ground;
+		ground.position = { 0, -0.5f, 0 };
+		ground.inverseMass = 0;
+		ground.shape = &Ground;
+		world->CreateBody(ground);
+
+		ArticulationDesc desc;
+		desc.floatingBase = true;
+		for (int i = 0; i < 3; ++i)
+		{
+			ArticulationLinkDesc link = HingeLink({ 0.4f * i, 1, 0 });
+			link.body.shape = &Box;
+			link.body.inverseInertia = { 20, 20, 20 };
+			link.parent = i - 1;
+			link.anchor = { 0.4f * i - 0.2f, 1, 0 };
+			desc.links.push_back(link);
+		}
+		desc.jointDamping = 1;
+		const ArticulationHandle body = world->CreateArticulation(desc);
+
+		for (int step = 0; step < 240; ++step)
+			world->Step(StepTime);
+		bool resting = true;
+		for (std::size_t link = 0; link < 3; ++link)
+		{
+			const BodyHandle b = world->ArticulationLinkBody(body, link);
+			resting &= world->Position(b).y > 0.15f && world->Position(b).y < 0.25f && world->LinearVelocity(b).Length() < 0.05f;
+		}
+		return resting;
+	}
+
+	bool DestroyingLinkBody()
+	{
+		std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+		const ArticulationHandle chain = world->CreateArticulation(ChainDesc(5, { 0, 0, 0 }, 1));
+		const BodyHandle middle = world->ArticulationLinkBody(chain, 2);
+		world->Step(StepTime);
+		world->DestroyBody(middle);
+		world->Step(StepTime);
+		return !world->IsValid(chain) && world->ArticulationCount() == 0 && world->BodyCount() == 0;
+	}
+
+	// Chains of boxes that swing into each other, on one thread and four
+	bool ThreadsMatch()
+	{
+		auto build = [](unsigned int threads)
+		{
+			std::unique_ptr<PhysicsWorld> world = ArticulationWorld(threads);
+			for (int c = 0; c < 16; ++c)
+			{
+				ArticulationDesc desc = ChainDesc(10, { 0, 0, 0.3f * c }, 1);
+				for (ArticulationLinkDesc& link : desc.links)
+					link.body.shape = &Box;
+				desc.links[0].joint = c % 2 ? JointType::Ball : JointType::Hinge;
+				world->CreateArticulation(desc);
+			}
+			return world;
+		};
+		std::unique_ptr<PhysicsWorld> one = build(1);
+		std::unique_ptr<PhysicsWorld> several = build(4);
+		for (int step = 0; step < 60; ++step)
+		{
+			one->Step(StepTime);
+			several->Step(StepTime);
+		}
+		const RigidBodies& a = one->Bodies();
+		const RigidBodies& b = several->Bodies();
+		bool same = a.Size() == b.Size() && one->Contacts().Size() > 0;
+		for (std::size_t i = 0; i < a.Size() && same; ++i)
+		{
+			const Vector3f p = a.positions.Get(i), q = b.positions.Get(i);
+			same &= p.x == q.x && p.y == q.y && p.z == q.z;
+		}
+		return same;
+	}
+
+	// 64 x 64 boxes resting side by side on the ground, alone and with a driven two link arm 100m away,
+	// first touching nothing, then holding a box. The extra solver passes the articulation needs only go over
+	// the arm's island, the arm and the box, or none while it touches nothing, so the boxes' step takes about
+	// as long. The step times are reported, the passes checked
+	bool ArmLeavesOtherBodiesAlone()
+	{
+		const Shape floor = ShapeBox({ 40, 0.5f, 40 });
+		const Shape plank = ShapeBox({ 0.5f, 0.05f, 0.2f });
+		auto build = [&](bool arm, bool holding)
+		{
+			std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+			BodyDesc ground;
+			ground.position = { 0, -0.5f, 0 };
+			ground.inverseMass = 0;
+			ground.shape = &floor;
+			world->CreateBody(ground);
+			for (int x = 0; x < 64; ++x)
+			{
+				for (int z = 0; z < 64; ++z)
+				{
+					BodyDesc box;
+					box.position = { (x - 32) * 0.41f, 0.2f, (z - 32) * 0.41f };
+					box.inverseInertia = { 20, 20, 20 };
+					box.shape = &Box;
+					world->CreateBody(box);
+				}
+			}
+			if (!arm)
+				return world;
+
+			const Vector3f base = { 100, 0, 0 };
+			ArticulationDesc desc;
+			for (int i = 0; i < 2; ++i)
+			{
+				ArticulationLinkDesc link = HingeLink(base + Vector3f(0.5f + i, 0, 0));
+				link.body.shape = &plank;
+				link.parent = i - 1;
+				link.anchor = base + Vector3f(static_cast<float>(i), 0, 0);
+				link.driveStiffness = 1000;
+				link.driveDamping = 100;
+				desc.links.push_back(link);
+			}
+			world->CreateArticulation(desc);
+			if (holding)
+			{
+				BodyDesc box;
+				box.position = base + Vector3f(1.5f, 0.25f, 0);
+				box.inverseInertia = { 20, 20, 20 };
+				box.shape = &Box;
+				world->CreateBody(box);
+			}
+			return world;
+		};
+		PhysicsWorld::ArticulationStats untouchedStats, holdingStats;
+		auto time = [&](bool arm, bool holding, PhysicsWorld::ArticulationStats& stats)
+		{
+			std::unique_ptr<PhysicsWorld> world = build(arm, holding);
+			for (int step = 0; step < 30; ++step)
+				world->Step(StepTime);
+			stats = world->LastArticulationStats();
+			const int timedSteps = 10;
+			return TimeBest([&]
+			{
+				for (int step = 0; step < timedSteps; ++step)
+					world->Step(StepTime);
+			}, 5) / timedSteps;
+		};
+
+		PhysicsWorld::ArticulationStats aloneStats;
+		const double alone = time(false, false, aloneStats);
+		const double untouched = time(true, false, untouchedStats);
+		const double holding = time(true, true, holdingStats);
+		std::printf("  4096 resting boxes: %.2f ms/step alone, %.2f with an arm touching nothing, %.2f with one holding a box\n",
+			alone * 1e3, untouched * 1e3, holding * 1e3);
+		std::printf("  arm holding a box: %zu more passes over %zu island of %zu bodies\n", holdingStats.passes, holdingStats.islands,
+			holdingStats.bodies);
+		return untouchedStats.passes == 0 && holdingStats.passes == static_cast<std::size_t>(PhysicsSettings().articulationPasses - 1) &&
+		       holdingStats.islands == 1 && holdingStats.bodies <= 3;
+	}
+
+	// The same chain held by the iterative joints, as JointBenchmark.cpp's
+	std::unique_ptr<PhysicsWorld> JointChains(std::size_t count, int links, std::vector<JointHandle>& joints)
+	{
+		std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+		for (std::size_t c = 0; c < count; ++c)
+		{
+			const Vector3f top = { 0, 0, static_cast<float>(c) };
+			BodyDesc anchor;
+			anchor.position = top;
+			anchor.inverseMass = 0;
+			BodyHandle previous = world->CreateBody(anchor);
+			for (int i = 0; i < links; ++i)
+			{
+				BodyDesc desc;
+				desc.position = top + ChainDown * (LinkLength * (i + 0.5f));
+				desc.inverseInertia = { 100, 100, 100 };
+				const BodyHandle link = world->CreateBody(desc);
+
+				JointDesc joint;
+				joint.bodyA = previous;
+				joint.bodyB = link;
+				joint.anchor = top + ChainDown * (LinkLength * i);
+				joints.push_back(world->CreateJoint(joint));
+				previous = link;
+			}
+		}
+		return world;
+	}
+
+	// Worst joint error each step, averaged over two seconds of swinging, and the time per step of 10 chains
+	void CompareChains(int links, int substeps)
+	{
+		const int steps = 120;
+		float articulationError = 0, jointError = 0;
+		{
+			std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+			const ArticulationHandle chain = world->CreateArticulation(ChainDesc(links, { 0, 0, 0 }, substeps));
+			for (int step = 0; step < steps; ++step)
+			{
+				world->Step(StepTime);
+				articulationError += ChainGap(*world, chain, { 0, 0, 0 }) / steps;
+			}
+		}
+		{
+			std::vector<JointHandle> joints;
+			std::unique_ptr<PhysicsWorld> world = JointChains(1, links, joints);
+			for (int step = 0; step < steps; ++step)
+			{
+				world->Step(StepTime);
+				float worst = 0;
+				for (JointHandle joint : joints)
+					worst = std::max(worst, world->MeasureJointError(joint).linear);
+				jointError += worst / steps;
+			}
+		}
+		std::printf("  %3d links: mean worst joint error  articulation %8.4f mm  joints %8.2f mm\n", links, articulationError * 1e3f, jointError * 1e3f);
+
+		const std::size_t chains = 10;
+		const int timedSteps = 10;
+		char label[64];
+		{
+			std::unique_ptr<PhysicsWorld> world = ArticulationWorld();
+			for (std::size_t c = 0; c < chains; ++c)
+				world->CreateArticulation(ChainDesc(links, { 0, 0, static_cast<float>(c) }, substeps));
+			world->Step(StepTime);
+			const double seconds = TimeBest([&]
+			{
+				for (int step = 0; step < timedSteps; ++step)
+					world->Step(StepTime);
+			}, 3);
+			std::snprintf(label, sizeof(label), "10 chains of %d, articulations x%d", links, substeps);
+			Report(label, seconds / timedSteps, 1, "step");
+		}
+		{
+			std::vector<JointHandle> joints;
+			std::unique_ptr<PhysicsWorld> world = JointChains(chains, links, joints);
+			world->Step(StepTime);
+			const double seconds = TimeBest([&]
+			{
+				for (int step = 0; step < timedSteps; ++step)
+					world->Step(StepTime);
+			}, 3);
+			std::snprintf(label, sizeof(label), "10 chains of %d, iterative joints", links);
+			Report(label, seconds / timedSteps, 1, "step");
+		}
+	}
+}
+
+bool RunArticulationBenchmarks()
+{
+	bool passed = true;
+
+	passed &= Check("pendulum holds its energy", PendulumEnergy());
+	passed &= Check("50 link chain joined, energy held", ChainHolds());
+	passed &= Check("hinge stops at its limit", HingeLimit());
+	passed &= Check("slider limits and drive", SliderLimitAndDrive());
+	passed &= Check("soft and stiff drives hold their targets", DrivesReachTargets());
+	passed &= Check("floating base falls freely", FloatingBaseFalls());
+	passed &= Check("box rests on a driven arm, tipping it", BoxRestsOnArm());
+	passed &= Check("floating articulation rests on the ground", RestsOnGround());
+	passed &= Check("destroying a link body removes all", DestroyingLinkBody());
+	passed &= Check("1 and 4 threads give the same chains", ThreadsMatch());
+	passed &= Check("passes only solve the arm's island", ArmLeavesOtherBodiesAlone());
+
+	// The articulation's links are joined exactly whatever the length of the chain, the iterative joints
+	// (8 iterations) stretch more the longer it is. The 200 link chain is stiff enough to need substeps
+	CompareChains(10, 1);
+	CompareChains(50, 1);
+	CompareChains(200, 4);
+
+	return passed;
+}
@@ -0,0 +1,94 @@
+//=========================================================================================================
+// Benchmark.h: Small Timing Helpers shared by the Benchmark Suites
+// - Each Suite is a function returning false if any of its results failed validation
+// - Suites are listed in BenchmarkMain.cpp and selected by name on the command line
+//=========================================================================================================
+
+#ifndef _BENCHMARK_H_DEFINED_
+#define _BENCHMARK_H_DEFINED_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BENCHMARK_NOINLINE __declspec(noinline)
+#else
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#endif
+
+//=============
+// Suites
+//=============
+
+bool RunMathsBenchmarks();
+bool RunSIMDBenchmarks();
+bool RunMatrixBenchmarks();
+bool RunVector3SoABenchmarks();
+bool RunTransformBenchmarks();
+bool RunRandomBenchmarks();
+bool RunPhysicsWorldBenchmarks();
+bool RunBroadphaseBenchmarks();
+bool RunSpatialHashGridBenchmarks();
+bool RunNarrowphaseBenchmarks();
+bool RunContactKernelBenchmarks();
+bool RunStackingBenchmarks();
+bool RunContactSolverBenchmarks();
+bool RunIslandBenchmarks();
+bool RunSleepingBenchmarks();
+bool RunJobSystemBenchmarks();
+bool RunMemoryBenchmarks();
+bool RunContinuousBenchmarks();
+bool RunJointBenchmarks();
+bool RunArticulationBenchmarks();
+bool RunClothBenchmarks();
+bool RunFluidBenchmarks();
+bool RunSoftBodyBenchmarks();
+
+//=============
+// Helpers
+//=============
+
+// Prevent the optimiser removing a value that is calculated but never used
+template<typename T> inline void DoNotOptimise(const T& value)
+{
+#if defined(_MSC_VER)
+	static const void* volatile sink;
+	sink = &value;
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+// Run a function several times and return the fastest time in seconds
+// Taking the best run removes most of the noise from other processes / frequency scaling
+template<typename F> double TimeBest(F&& function, int repeats = 5)
+{
+	double best = 1e30;
+	for (int i = 0; i < repeats; ++i)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if (elapsed.count() < best)
+			best = elapsed.count();
+	}
+	return best;
+}
+
+// Print a single result line, time per operation and operations per second
+inline void Report(const char* name, double seconds, std::size_t operations, const char* unit = "op")
+{
+	std::printf("  %-44s %10.3f ns/%s  %12.0f %s/s\n", name, seconds * 1e9 / operations, unit, operations / seconds, unit);
+}
+
+// Print a validation result line and pass the result through so suites can accumulate it
+inline bool Check(const char* name, bool passed)
+{
+	std::printf("  %-44s %s\n", name, passed ? "OK" : "FAILED");
+	return passed;
+}
+
+#endif // !_BENCHMARK_H_DEFINED_
@@ -0,0 +1,62 @@
+//=============================================================
+// BenchmarkMain.cpp : Entry Point for the Benchmark Runner
+// - Runs every suite, or only those named on the command line
+//   e.g. Benchmarks maths
+//=============================================================
+
+#include "Benchmark.h"
+
+#include <cstring>
+
+struct BenchmarkSuite
+{
+	const char* name;
+	bool (*run)();
+};
+
+static const BenchmarkSuite gSuites[] =
+{
+	{ "maths",       RunMathsBenchmarks },
+	{ "simd",        RunSIMDBenchmarks },
+	{ "matrix",      RunMatrixBenchmarks },
+	{ "soa",         RunVector3SoABenchmarks },
+	{ "transform",   RunTransformBenchmarks },
+	{ "random",      RunRandomBenchmarks },
+	{ "world",       RunPhysicsWorldBenchmarks },
+	{ "broadphase",  RunBroadphaseBenchmarks },
+	{ "grid",        RunSpatialHashGridBenchmarks },
+	{ "narrowphase", RunNarrowphaseBenchmarks },
+	{ "contacts",    RunContactKernelBenchmarks },
+	{ "stacking",    RunStackingBenchmarks },
+	{ "solver",      RunContactSolverBenchmarks },
+	{ "islands",     RunIslandBenchmarks },
+	{ "sleeping",    RunSleepingBenchmarks },
+	{ "jobs",        RunJobSystemBenchmarks },
+	{ "memory",      RunMemoryBenchmarks },
+	{ "ccd",         RunContinuousBenchmarks },
+	{ "joints",      RunJointBenchmarks },
+	{ "articulations", RunArticulationBenchmarks },
+	{ "cloth",       RunClothBenchmarks },
+	{ "fluid",       RunFluidBenchmarks },
+	{ "softbody",    RunSoftBodyBenchmarks },
+};
+
+int main(int argc, char* argv[])
+{
+	bool passed = true;
+	for (const BenchmarkSuite& suite : gSuites)
+	{
+		// No arguments runs everything, otherwise only run the named suites
+		bool selected = argc < 2;
+		for (int i = 1; i < argc; ++i)
+			selected |= std::strcmp(argv[i], suite.name) == 0;
+
+		if (!selected)
+			continue;
+
+		std::printf("[%s]\n", suite.name);
+		passed &= suite.run();
+	}
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,343 @@
+//=========================================================================================================
+// BroadphaseBenchmark.cpp: Broadphase Pair Finding vs Brute Force
+// - Scenes of randomly placed boxes at a roughly constant density, so each box overlaps a few others
+// - Mostly static: 5% of the boxes move each step (dynamic tree)
+// - All moving: every box moves each step like particles (dynamic tree vs sweep and prune)
+// - Pairs from each broadphase are checked against brute force over the same (fat) boxes
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "DynamicTree.h"
+#include "SweepAndPrune.h"
+#include "PhysicsWorld.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	const std::size_t SceneSizes[] = { 1000, 10000, 50000 };
+	const std::size_t MovingSceneSizes[] = { 10000, 50000, 100000 };
+	const float MovingFraction = 0.05f;
+
+	struct Scene
+	{
+		std::vector<AABB> boxes;
+		float size; // Scene is a cube from 0 to size on each axis
+	};
+
+	Scene CreateScene(std::size_t count, RandomGenerator& generator)
+	{
+		Scene scene;
+		scene.size = 4 * std::cbrt(static_cast<float>(count));
+		scene.boxes.resize(count);
+		for (AABB& box : scene.boxes)
+		{
+			Vector3f centre = generator.NextVector3({ 0, 0, 0 }, { scene.size, scene.size, scene.size });
+			Vector3f extents = generator.NextVector3({ 0.25f, 0.25f, 0.25f }, { 1, 1, 1 });
+			box = { centre - extents, centre + extents };
+		}
+		return scene;
+	}
+
+	// Move a random selection of boxes by a small amount, recording which ones moved
+	void MoveBoxes(Scene& scene, RandomGenerator& generator, std::vector<uint32_t>& moved, std::vector<Vector3f>& displacements)
+	{
+		const std::size_t count = static_cast<std::size_t>(scene.boxes.size() * MovingFraction);
+		moved.resize(count);
+		displacements.resize(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			uint32_t index = static_cast<uint32_t>(generator.NextInt(0, static_cast<int>(scene.boxes.size()) - 1));
+			Vector3f d = generator.NextVector3({ -0.2f, -0.2f, -0.2f }, { 0.2f, 0.2f, 0.2f });
+			scene.boxes[index] = { scene.boxes[index].min + d, scene.boxes[index].max + d };
+			moved[i] = index;
+			displacements[i] = d;
+		}
+	}
+
+	// Move every box with its own velocity, bouncing off the sides of the scene
+	void MoveAllBoxes(Scene& scene, std::vector<Vector3f>& velocities, std::vector<Vector3f>& displacements)
+	{
+		const float timeStep = 1.0f / 60;
+		displacements.resize(scene.boxes.size());
+		for (std::size_t i = 0; i < scene.boxes.size(); ++i)
+		{
+			AABB& box = scene.boxes[i];
+			Vector3f& v = velocities[i];
+			const Vector3f c = box.Centre();
+			if ((c.x < 0 && v.x < 0) || (c.x > scene.size && v.x > 0)) v.x = -v.x;
+			if ((c.y < 0 && v.y < 0) || (c.y > scene.size && v.y > 0)) v.y = -v.y;
+			if ((c.z < 0 && v.z < 0) || (c.z > scene.size && v.z > 0)) v.z = -v.z;
+
+			displacements[i] = v * timeStep;
+			box = { box.min + displacements[i], box.max + displacements[i] };
+		}
+	}
+
+	// Pairs in a standard order so different methods can be compared
+	void SortPairs(std::vector<BroadphasePair>& pairs)
+	{
+		for (BroadphasePair& p : pairs)
+		{
+			if (p.a > p.b)
+				std::swap(p.a, p.b);
+		}
+		std::sort(pairs.begin(), pairs.end(), [](const BroadphasePair& x, const BroadphasePair& y) { return x.a != y.a ? x.a < y.a : x.b < y.b; });
+	}
+
+	bool SamePairs(std::vector<BroadphasePair> a, std::vector<BroadphasePair> b)
+	{
+		SortPairs(a);
+		SortPairs(b);
+		return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const BroadphasePair& x, const BroadphasePair& y) { return x.a == y.a && x.b == y.b; });
+	}
+
+	BENCHMARK_NOINLINE void BruteForcePairs(const std::vector<AABB>& boxes, std::vector<BroadphasePair>& pairs)
+	{
+		pairs.clear();
+		for (std::size_t i = 0; i < boxes.size(); ++i)
+		{
+			for (std::size_t j = i + 1; j < boxes.size(); ++j)
+			{
+				if (Overlaps(boxes[i], boxes[j]))
+					pairs.push_back({ static_cast<uint32_t>(i), static_cast<uint32_t>(j) });
+			}
+		}
+	}
+}
+
+bool RunBroadphaseBenchmarks()
+{
+	bool passed = true;
+	RandomGenerator generator(2024);
+	std::vector<BroadphasePair> pairs, expected;
+	std::vector<uint32_t> moved;
+	std::vector<Vector3f> displacements;
+
+	for (std::size_t count : SceneSizes)
+	{
+		Scene scene = CreateScene(count, generator);
+		char label[64];
+
+		//--- Dynamic Tree ---
+		DynamicTree tree;
+		std::vector<uint32_t> proxies(count);
+		auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < count; ++i)
+			proxies[i] = tree.CreateProxy(scene.boxes[i], static_cast<uint32_t>(i));
+		std::chrono::duration<double> buildTime = std::chrono::steady_clock::now() - start;
+
+		std::snprintf(label, sizeof(label), "tree build (%zu)", count);
+		Report(label, buildTime.count(), count, "proxy");
+
+		// Each step moves 5% of the boxes then finds all pairs
+		const int Steps = 10;
+		double seconds = TimeBest([&]()
+		{
+			for (int step = 0; step < Steps; ++step)
+			{
+				MoveBoxes(scene, generator, moved, displacements);
+				for (std::size_t i = 0; i < moved.size(); ++i)
+					tree.MoveProxy(proxies[moved[i]], scene.boxes[moved[i]], displacements[i]);
+				tree.FindPairs(pairs);
+			}
+			DoNotOptimise(pairs);
+		}, 3);
+		std::snprintf(label, sizeof(label), "tree step (%zu, %zu pairs)", count, pairs.size());
+		Report(label, seconds / Steps, 1, "step");
+
+		std::snprintf(label, sizeof(label), "tree valid (%zu, height %d, area %.1f)", count, tree.Height(), tree.AreaRatio());
+		passed &= Check(label, tree.Validate());
+
+		//--- Brute Force ---
+		// Over the tree's fat boxes so the pairs should match exactly
+		std::vector<AABB> fatBoxes(count);
+		for (std::size_t i = 0; i < count; ++i)
+			fatBoxes[i] = tree.FatAABB(proxies[i]);
+
+		seconds = TimeBest([&]() { BruteForcePairs(fatBoxes, expected); DoNotOptimise(expected); }, count > 10000 ? 1 : 3);
+		std::snprintf(label, sizeof(label), "brute force (%zu)", count);
+		Report(label, seconds, 1, "step");
+
+		std::snprintf(label, sizeof(label), "tree pairs match brute force (%zu)", count);
+		passed &= Check(label, SamePairs(pairs, expected));
+	}
+
+	//--- All Moving ---
+	for (std::size_t count : MovingSceneSizes)
+	{
+		Scene scene = CreateScene(count, generator);
+		std::vector<Vector3f> velocities(count);
+		for (Vector3f& v : velocities)
+			v = generator.NextVector3({ -5, -5, -5 }, { 5, 5, 5 });
+		char label[64];
+
+		DynamicTree tree;
+		SweepAndPrune sapSingle(1);
+		SweepAndPrune sap(std::max(4u, std::thread::hardware_concurrency())); // At least 4, so the threaded sweep is checked on any machine
+		std::vector<uint32_t> treeProxies(count), sapSingleProxies(count), sapProxies(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			treeProxies[i] = tree.CreateProxy(scene.boxes[i], static_cast<uint32_t>(i));
+			sapSingleProxies[i] = sapSingle.CreateProxy(scene.boxes[i], static_cast<uint32_t>(i));
+			sapProxies[i] = sap.CreateProxy(scene.boxes[i], static_cast<uint32_t>(i));
+		}
+
+		// Each broadphase runs the same sequence of steps from the same start
+		const int Steps = 10;
+		const Scene startScene = scene;
+		const std::vector<Vector3f> startVelocities = velocities;
+		auto timeSteps = [&](Broadphase& broadphase, const std::vector<uint32_t>& proxies)
+		{
+			// Best of 3 runs, only timing the broadphase - not moving the scene boxes
+			broadphase.FindPairs(pairs); // First sort / pair list outside the timing
+			double best = 1e30;
+			for (int repeat = 0; repeat < 3; ++repeat)
+			{
+				scene = startScene;
+				velocities = startVelocities;
+				for (std::size_t i = 0; i < count; ++i)
+					broadphase.MoveProxy(proxies[i], scene.boxes[i], { 0, 0, 0 });
+
+				double seconds = 0;
+				for (int step = 0; step < Steps; ++step)
+				{
+					MoveAllBoxes(scene, velocities, displacements);
+					auto start = std::chrono::steady_clock::now();
+					for (std::size_t i = 0; i < count; ++i)
+						broadphase.MoveProxy(proxies[i], scene.boxes[i], displacements[i]);
+					broadphase.FindPairs(pairs);
+					seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				}
+				best = std::min(best, seconds);
+			}
+			DoNotOptimise(pairs);
+			return best;
+		};
+
+		double treeSeconds = timeSteps(tree, treeProxies);
+		std::snprintf(label, sizeof(label), "moving tree (%zu)", count);
+		Report(label, treeSeconds / Steps, 1, "step");
+
+		double sapSingleSeconds = timeSteps(sapSingle, sapSingleProxies);
+		std::vector<BroadphasePair> singlePairs = pairs;
+		std::snprintf(label, sizeof(label), "moving sap 1 thread (%zu)", count);
+		Report(label, sapSingleSeconds / Steps, 1, "step");
+
+		double sapSeconds = timeSteps(sap, sapProxies);
+		std::snprintf(label, sizeof(label), "moving sap %u threads (%zu, %zu pairs)", sap.ThreadCount(), count, pairs.size());
+		Report(label, sapSeconds / Steps, 1, "step");
+		std::printf("    axis %d, %s sort on the last step\n", sap.SortAxis(), sap.UsedRadixSort() ? "radix" : "insertion");
+
+		// The pair list does not depend on the thread count
+		std::snprintf(label, sizeof(label), "sap threads match 1 thread (%zu)", count);
+		passed &= Check(label, pairs.size() == singlePairs.size() &&
+		                       std::equal(pairs.begin(), pairs.end(), singlePairs.begin(),
+		                                  [](const BroadphasePair& x, const BroadphasePair& y) { return x.a == y.a && x.b == y.b; }));
+
+		// Sweep and prune boxes are exact, so compare with brute force over the actual boxes
+		if (count <= 10000)
+		{
+			BruteForcePairs(scene.boxes, expected);
+			std::snprintf(label, sizeof(label), "sap pairs match brute force (%zu)", count);
+			passed &= Check(label, SamePairs(pairs, expected));
+		}
+	}
+
+	// Sweep and prune after creating, destroying and reusing proxies, and through both sorts
+	{
+		Scene scene = CreateScene(5000, generator);
+		SweepAndPrune sap(4);
+		std::vector<uint32_t> proxies(scene.boxes.size());
+		for (std::size_t i = 0; i < scene.boxes.size(); ++i)
+			proxies[i] = sap.CreateProxy(scene.boxes[i], static_cast<uint32_t>(i));
+		sap.FindPairs(pairs);
+		bool sapOK = sap.UsedRadixSort();
+
+		// Small moves: insertion sort
+		MoveBoxes(scene, generator, moved, displacements);
+		for (std::size_t i = 0; i < moved.size(); ++i)
+			sap.MoveProxy(proxies[moved[i]], scene.boxes[moved[i]], displacements[i]);
+		sap.FindPairs(pairs);
+		BruteForcePairs(scene.boxes, expected);
+		sapOK &= !sap.UsedRadixSort() && SamePairs(pairs, expected);
+
+		// Destroy half then recreate them (reusing proxies) in new places: too much to insertion sort
+		for (std::size_t i = 0; i < proxies.size(); i += 2)
+			sap.DestroyProxy(proxies[i]);
+		sap.FindPairs(pairs);
+		for (std::size_t i = 0; i < proxies.size(); i += 2)
+		{
+			const Vector3f offset = generator.NextVector3({ -20, 0, 0 }, { 20, 0, 0 });
+			scene.boxes[i] = { scene.boxes[i].min + offset, scene.boxes[i].max + offset };
+			proxies[i] = sap.CreateProxy(scene.boxes[i], static_cast<uint32_t>(i));
+		}
+		sap.FindPairs(pairs);
+		BruteForcePairs(scene.boxes, expected);
+		sapOK &= sap.ProxyCount() == scene.boxes.size() && SamePairs(pairs, expected);
+		passed &= Check("sap create / destroy / sorts", sapOK);
+	}
+
+	// World broadphase choice: both report every overlapping pair of bodies
+	{
+		bool worldOK = true;
+		for (BroadphaseType type : { BroadphaseType::DynamicTree, BroadphaseType::SweepAndPrune })
+		{
+			PhysicsSettings settings;
+			settings.broadphase = type;
+			PhysicsWorld world(settings);
+			RandomGenerator sceneGenerator(7);
+			for (int i = 0; i < 2000; ++i)
+			{
+				BodyDesc desc;
+				desc.position = sceneGenerator.NextVector3({ 0, 0, 0 }, { 40, 40, 40 });
+				desc.linearVelocity = sceneGenerator.NextVector3({ -5, -5, -5 }, { 5, 5, 5 });
+				desc.boundingRadius = 0.5f;
+				world.CreateBody(desc);
+			}
+			for (int step = 0; step < 10; ++step)
+				world.Step(1.0f / 60);
+
+			// Brute force over the exact boxes, the tree's fat boxes may also give some extra pairs
+			const RigidBodies& bodies = world.Bodies();
+			std::vector<AABB> boxes(bodies.Size());
+			for (std::size_t i = 0; i < bodies.Size(); ++i)
+			{
+				const Vector3f p = bodies.positions.Get(i);
+				boxes[i] = { p - Vector3f(0.5f, 0.5f, 0.5f), p + Vector3f(0.5f, 0.5f, 0.5f) };
+			}
+			BruteForcePairs(boxes, expected);
+
+			std::vector<BroadphasePair> found;
+			for (const BroadphasePair& p : world.BroadphasePairs())
+			{
+				const std::size_t a = bodies.SlotIndex(p.a);
+				const std::size_t b = bodies.SlotIndex(p.b);
+				if (Overlaps(boxes[a], boxes[b]))
+					found.push_back({ static_cast<uint32_t>(a), static_cast<uint32_t>(b) });
+			}
+			worldOK &= !expected.empty() && SamePairs(found, expected);
+		}
+		passed &= Check("world pairs match brute force (tree, sap)", worldOK);
+	}
+
+	// Removing proxies keeps the tree consistent
+	DynamicTree tree;
+	Scene scene = CreateScene(1000, generator);
+	std::vector<uint32_t> proxies;
+	for (std::size_t i = 0; i < scene.boxes.size(); ++i)
+		proxies.push_back(tree.CreateProxy(scene.boxes[i], static_cast<uint32_t>(i)));
+	for (std::size_t i = 0; i < proxies.size(); i += 2)
+		tree.DestroyProxy(proxies[i]);
+	bool removedOK = tree.Validate() && tree.ProxyCount() == 500;
+	tree.FindPairs(pairs);
+	for (const BroadphasePair& p : pairs)
+		removedOK &= p.a % 2 == 1 && p.b % 2 == 1;
+	passed &= Check("tree consistent after DestroyProxy", removedOK);
+
+	return passed;
+}
@@ -0,0 +1,251 @@
+//=========================================================================================================
+// ContactKernelBenchmark.cpp: Sphere / Capsule / Box Contact Kernels Against GJK, Scalar Against Batched
+// - Kernel results are checked against GJK / EPA on the same pairs, box stacking is checked for a full
+//   four point manifold, and batches at every SIMD level are checked against the scalar kernels
+// - Timing runs each pair type through GJK, the scalar kernel via Collide(), and the batched kernels
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "ContactBatch.h"
+#include "Random.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	const std::size_t PairCount = 4096;
+
+	bool Near(float a, float b, float tolerance)
+	{
+		return std::abs(a - b) <= tolerance;
+	}
+
+	bool Near(const Vector3f& a, const Vector3f& b, float tolerance)
+	{
+		return (a - b).Length() <= tolerance;
+	}
+
+	float DeepestDepth(const Contact& contact)
+	{
+		float depth = contact.points[0].depth;
+		for (int i = 1; i < contact.pointCount; ++i)
+			depth = std::fmax(depth, contact.points[i].depth);
+		return depth;
+	}
+
+	struct PairType
+	{
+		const char* name;
+		ContactKernel kernel;
+		Shape a;
+		Shape b;
+	};
+
+	struct PairSet
+	{
+		std::vector<Transformf> transformsA;
+		std::vector<Transformf> transformsB;
+	};
+
+	// Pairs from well apart to deeply overlapping, about half of them touching, turned at random
+	PairSet MakePairs(RandomGenerator& generator, const PairType& type, std::size_t count)
+	{
+		const float reach = type.a.BoundingBox(Transformf({ 0, 0, 0 })).Extents().Length() +
+		                    type.b.BoundingBox(Transformf({ 0, 0, 0 })).Extents().Length();
+		PairSet pairs;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const Vector3f position = generator.NextVector3({ -50, -50, -50 }, { 50, 50, 50 });
+			const Vector3f offset = generator.NextOnUnitSphere() * (reach * generator.NextFloat(0.2f, 1.1f));
+			pairs.transformsA.push_back(Transformf(position, QuaternionAxisAngle(generator.NextOnUnitSphere(), generator.NextFloat(0, 6.283f))));
+			pairs.transformsB.push_back(Transformf(position + offset, QuaternionAxisAngle(generator.NextOnUnitSphere(), generator.NextFloat(0, 6.283f))));
+		}
+		return pairs;
+	}
+
+	// Kernels give the same contact depth as GJK / EPA, and moving b that far along the normal separates the
+	// shapes (normals themselves can differ where two directions are equally good, e.g. a sphere centre
+	// equally near two faces of a box). Pairs within a whisker of touching are skipped, either answer is
+	// right for them. Box - box picks face axes over nearly equal edge axes so its depth may be a little more
+	bool CheckAgainstGJK(const PairType& type, const PairSet& pairs)
+	{
+		const float tolerance = type.kernel == ContactKernel::BoxBox ? 1e-2f : 2e-3f;
+		bool passed = true;
+		int compared = 0;
+		for (std::size_t i = 0; i < pairs.transformsA.size(); ++i)
+		{
+			Contact kernelContact, gjkContact;
+			const bool kernelHit = Collide(type.a, pairs.transformsA[i], type.b, pairs.transformsB[i], kernelContact);
+			CollideConvex(type.a, pairs.transformsA[i], type.b, pairs.transformsB[i], gjkContact, nullptr, 10);
+			if (std::abs(gjkContact.points[0].depth) < 1e-3f)
+				continue;
+
+			++compared;
+			passed &= kernelHit == (gjkContact.points[0].depth > 0);
+			if (kernelHit)
+			{
+				passed &= Near(DeepestDepth(kernelContact), gjkContact.points[0].depth, tolerance);
+				Transformf separated = pairs.transformsB[i];
+				separated.position += kernelContact.normal * (DeepestDepth(kernelContact) + 2e-3f);
+				passed &= !CollideConvex(type.a, pairs.transformsA[i], type.b, separated, gjkContact);
+			}
+		}
+		return passed && compared > 0;
+	}
+
+	// Batches at each level give the same contacts as the scalar kernels. FMA in the AVX2 kernels rounds a
+	// little differently, which moves normals most where the closest points nearly meet
+	bool CheckBatch(const PairType& type, const PairSet& pairs, SIMDLevel level)
+	{
+		ContactBatch batch(type.kernel);
+		for (std::size_t i = 0; i < pairs.transformsA.size(); ++i)
+		{
+			// Every other pair the other way round, the batch puts them back in kernel order
+			if (i % 2 == 0)
+				batch.Add(type.a, pairs.transformsA[i], type.b, pairs.transformsB[i]);
+			else
+				batch.Add(type.b, pairs.transformsB[i], type.a, pairs.transformsA[i]);
+		}
+
+		std::vector<Contact> contacts(batch.Size());
+		CollideBatch(batch, 0.01f, contacts.data(), GetContactBatchKernels(level));
+
+		bool passed = true;
+		for (std::size_t i = 0; i < pairs.transformsA.size(); ++i)
+		{
+			Contact expected;
+			expected.pointCount = 0;
+			if (i % 2 == 0)
+				Collide(type.a, pairs.transformsA[i], type.b, pairs.transformsB[i], expected, nullptr, 0.01f);
+			else
+				Collide(type.b, pairs.transformsB[i], type.a, pairs.transformsA[i], expected, nullptr, 0.01f);
+
+			const Contact& contact = contacts[i];
+			if (contact.pointCount != expected.pointCount)
+			{
+				// Only a pair right on the margin can go either way
+				const Contact& hit = expected.pointCount > 0 ? expected : contact;
+				passed &= (expected.pointCount == 0 || contact.pointCount == 0) && Near(DeepestDepth(hit), -0.01f, 1e-4f);
+				continue;
+			}
+			if (contact.pointCount > 0)
+				passed &= Near(contact.normal, expected.normal, 1e-3f);
+			for (int p = 0; p < contact.pointCount; ++p)
+				passed &= Near(contact.points[p].position, expected.points[p].position, 1e-4f) && Near(contact.points[p].depth, expected.points[p].depth, 1e-4f);
+		}
+		return passed;
+	}
+
+	bool CheckManifolds()
+	{
+		bool passed = true;
+		const Shape box = ShapeBox({ 0.5f, 0.5f, 0.5f });
+
+		// Box resting on a larger box, slightly turned: four points all 1cm deep
+		Contact contact;
+		const Transformf ground({ 0, -1, 0 });
+		const Transformf resting({ 0.1f, 0.49f, -0.05f }, QuaternionAxisAngle({ 0, 1, 0 }, 0.3f));
+		bool stackOK = Collide(ShapeBox({ 2, 1, 2 }), Transformf({ 0, -1, 0 }), box, resting, contact) && contact.pointCount == 4 &&
+		               Near(contact.normal, { 0, 1, 0 }, 1e-4f);
+		for (int i = 0; i < contact.pointCount; ++i)
+			stackOK &= Near(contact.points[i].depth, 0.01f, 1e-4f);
+		passed &= Check("box resting on box, four points", stackOK);
+
+		// Swapping the shapes flips the normal, the points are the same (maybe in another order)
+		Contact swapped;
+		bool swapOK = Collide(box, resting, ShapeBox({ 2, 1, 2 }), ground, swapped) && swapped.pointCount == contact.pointCount &&
+		              Near(swapped.normal, -contact.normal, 1e-5f);
+		for (int i = 0; i < swapped.pointCount; ++i)
+		{
+			bool found = false;
+			for (int j = 0; j < contact.pointCount; ++j)
+				found |= Near(swapped.points[i].position, contact.points[j].position, 1e-5f) && Near(swapped.points[i].depth, contact.points[j].depth, 1e-5f);
+			swapOK &= found;
+		}
+		passed &= Check("swapped shapes flip the normal", swapOK);
+
+		// Capsule lying along another: two points
+		const bool capsulesOK = Collide(ShapeCapsule(0.2f, 1), Transformf({ 0, 0, 0 }, QuaternionAxisAngle({ 0, 0, 1 }, 1.5708f)),
+		                                ShapeCapsule(0.2f, 0.5f), Transformf({ 0.3f, 0.39f, 0 }, QuaternionAxisAngle({ 0, 0, 1 }, 1.5708f)), contact) &&
+		                        contact.pointCount == 2 && Near(contact.points[0].depth, 0.01f, 1e-4f) && Near(contact.points[1].depth, 0.01f, 1e-4f);
+		passed &= Check("capsule lying on capsule, two points", capsulesOK);
+
+		return passed;
+	}
+}
+
+bool RunContactKernelBenchmarks()
+{
+	bool passed = true;
+	RandomGenerator generator(13);
+
+	const PairType types[] =
+	{
+		{ "sphere - sphere",   ContactKernel::SphereSphere,   ShapeSphere(0.4f),               ShapeSphere(0.3f) },
+		{ "sphere - capsule",  ContactKernel::SphereCapsule,  ShapeSphere(0.4f),               ShapeCapsule(0.25f, 0.4f) },
+		{ "capsule - capsule", ContactKernel::CapsuleCapsule, ShapeCapsule(0.25f, 0.4f),       ShapeCapsule(0.2f, 0.6f) },
+		{ "sphere - box",      ContactKernel::SphereBox,      ShapeSphere(0.4f),               ShapeBox({ 0.5f, 0.3f, 0.4f }) },
+		{ "box - box",         ContactKernel::BoxBox,         ShapeBox({ 0.5f, 0.3f, 0.4f }), ShapeBox({ 0.6f, 0.2f, 0.3f }) },
+	};
+
+	passed &= CheckManifolds();
+
+	const SIMDLevel levels[] = { SIMDLevel::Scalar, SIMDLevel::SSE2, SIMDLevel::AVX2 };
+	std::vector<Contact> contacts(PairCount);
+	for (const PairType& type : types)
+	{
+		const PairSet pairs = MakePairs(generator, type, PairCount);
+		std::printf(" %s\n", type.name);
+
+		char label[64];
+		std::snprintf(label, sizeof(label), "%s kernel matches GJK", type.name);
+		passed &= Check(label, CheckAgainstGJK(type, pairs));
+
+		bool batchOK = true;
+		for (SIMDLevel level : levels)
+			batchOK &= !IsSIMDLevelSupported(level) || CheckBatch(type, pairs, level);
+		std::snprintf(label, sizeof(label), "%s batches match scalar", type.name);
+		passed &= Check(label, batchOK);
+
+		// Timing
+		const double gjkSeconds = TimeBest([&]()
+		{
+			for (std::size_t i = 0; i < PairCount; ++i)
+			{
+				DoNotOptimise(CollideConvex(type.a, pairs.transformsA[i], type.b, pairs.transformsB[i], contacts[i]));
+			}
+		});
+		Report("GJK / EPA", gjkSeconds, PairCount, "pair");
+
+		const double kernelSeconds = TimeBest([&]()
+		{
+			for (std::size_t i = 0; i < PairCount; ++i)
+			{
+				DoNotOptimise(Collide(type.a, pairs.transformsA[i], type.b, pairs.transformsB[i], contacts[i]));
+			}
+		});
+		Report("kernel via Collide()", kernelSeconds, PairCount, "pair");
+
+		ContactBatch batch(type.kernel);
+		for (std::size_t i = 0; i < PairCount; ++i)
+			batch.Add(type.a, pairs.transformsA[i], type.b, pairs.transformsB[i]);
+		for (SIMDLevel level : levels)
+		{
+			if (!IsSIMDLevelSupported(level))
+				continue;
+
+			const ContactBatchKernels& kernels = GetContactBatchKernels(level);
+			const double batchSeconds = TimeBest([&]()
+			{
+				CollideBatch(batch, 0, contacts.data(), kernels);
+				DoNotOptimise(contacts[0]);
+			});
+			std::snprintf(label, sizeof(label), "batch (%s)", SIMDLevelName(level));
+			Report(label, batchSeconds, PairCount, "pair");
+		}
+	}
+
+	return passed;
+}
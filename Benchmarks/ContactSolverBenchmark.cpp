@@ -0,0 +1,235 @@
+//=========================================================================================================
+// ContactSolverBenchmark.cpp: Sequential Impulse Solver, Sequential Against Coloured SIMD Batches
+// - Colouring is checked for groups that never share a dynamic body, and the batched solver at every SIMD
+//   level is checked against the sequential solver run over the manifolds in the same (colour) order
+// - Restitution is checked by the height of a bounce, and for not bouncing bodies that are only resting
+// - Timing solves the contacts of a field of small box stacks, reported as constraint rows per millisecond
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "PhysicsWorld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	const float StepTime = 1.0f / 60;
+
+	const Shape Ground = ShapeBox({ 100, 0.5f, 100 });
+	const Shape Box = ShapeBox({ 0.5f, 0.5f, 0.5f });
+
+	void AddGround(PhysicsWorld& world)
+	{
+		BodyDesc desc;
+		desc.position = { 0, -0.5f, 0 };
+		desc.inverseMass = 0;
+		desc.shape = &Ground;
+		world.CreateBody(desc);
+	}
+
+	// side * side stacks of unit boxes, slightly offset so the contacts aren't all perfectly aligned
+	void BuildStackField(PhysicsWorld& world, int side, int height)
+	{
+		AddGround(world);
+		for (int x = 0; x < side; ++x)
+		{
+			for (int z = 0; z < side; ++z)
+			{
+				for (int i = 0; i < height; ++i)
+				{
+					BodyDesc desc;
+					desc.position = { (x - side / 2) * 2.0f + 0.02f * i, 0.5f + i, (z - side / 2) * 2.0f };
+					desc.inverseInertia = { 6, 6, 6 };
+					desc.shape = &Box;
+					world.CreateBody(desc);
+				}
+			}
+		}
+	}
+
+	// Every lane of a group has its own dynamic bodies. Group bodies are the solver's local slots, at most
+	// one per body plus the spare
+	bool GroupsShareNoBody(const ContactSolver& solver, const RigidBodies& bodies)
+	{
+		std::vector<uint32_t> lastGroup(bodies.Size() + 1, ~0u);
+		for (std::size_t g = 0; g < solver.Groups().size(); ++g)
+		{
+			const ContactSolverGroup& group = solver.Groups()[g];
+			for (int lane = 0; lane < ContactSolverGroup::Lanes; ++lane)
+			{
+				const uint32_t dynamicBodies[] = { group.inverseMassA[lane] != 0 ? group.bodyA[lane] : ~0u,
+				                                   group.inverseMassB[lane] != 0 ? group.bodyB[lane] : ~0u };
+				for (uint32_t body : dynamicBodies)
+				{
+					if (body == ~0u)
+						continue;
+					if (lastGroup[body] == g)
+						return false;
+					lastGroup[body] = static_cast<uint32_t>(g);
+				}
+			}
+		}
+		return true;
+	}
+
+	// Batched solve at one level against the sequential solver over the manifolds in colour order
+	bool CheckBatched(const PhysicsWorld& world, const ContactSolverSettings& settings, SIMDLevel level, bool& sharesNoBody)
+	{
+		RigidBodies batchedBodies = world.Bodies();
+		std::vector<ContactManifold> batchedManifolds = world.Contacts().Manifolds();
+		ContactSolver batched;
+		batched.Solve(batchedBodies, batchedManifolds, settings, StepTime, GetContactSolverKernels(level));
+		sharesNoBody &= GroupsShareNoBody(batched, batchedBodies);
+
+		RigidBodies sequentialBodies = world.Bodies();
+		std::vector<ContactManifold> sequentialManifolds;
+		for (uint32_t m : batched.SolveOrder())
+			sequentialManifolds.push_back(world.Contacts().Manifolds()[m]);
+		ContactSolver sequential;
+		sequential.SolveSequential(sequentialBodies, sequentialManifolds, settings, StepTime);
+
+		// Lanes may fuse multiply-adds, so allow a little rounding difference
+		float difference = 0;
+		for (std::size_t i = 0; i < batchedBodies.Size(); ++i)
+		{
+			difference = std::max(difference, (batchedBodies.linearVelocities.Get(i) - sequentialBodies.linearVelocities.Get(i)).Length());
+			difference = std::max(difference, (batchedBodies.angularVelocities.Get(i) - sequentialBodies.angularVelocities.Get(i)).Length());
+		}
+		for (std::size_t k = 0; k < sequentialManifolds.size(); ++k)
+		{
+			const ContactManifold& manifold = batchedManifolds[batched.SolveOrder()[k]];
+			for (int p = 0; p < manifold.pointCount; ++p)
+				difference = std::max(difference, std::abs(manifold.points[p].normalImpulse - sequentialManifolds[k].points[p].normalImpulse));
+		}
+		return difference < 1e-4f;
+	}
+
+	// Highest point of a box dropped from a height after its first bounce, or its height range while resting
+	struct BounceResult
+	{
+		float bounceHeight;
+		float restingRange;
+	};
+
+	BounceResult DropBox(float dropHeight, float restitution, bool batched)
+	{
+		PhysicsSettings settings;
+		settings.solver.restitution = restitution;
+		settings.solver.batched = batched;
+		PhysicsWorld world(settings);
+		AddGround(world);
+
+		BodyDesc desc;
+		desc.position = { 0, 0.5f + dropHeight, 0 };
+		desc.inverseInertia = { 6, 6, 6 };
+		desc.shape = &Box;
+		world.CreateBody(desc);
+
+		// Fall, bounce and come down again, then rest
+		BounceResult result = { 0, 0 };
+		bool bounced = false;
+		float lowest = 1e30f, highest = -1e30f;
+		for (int step = 0; step < 600; ++step)
+		{
+			world.Step(StepTime);
+			const float height = world.Bodies().positions.Get(1).y - 0.5f;
+			const float velocity = world.Bodies().linearVelocities.Get(1).y;
+			bounced |= velocity > 0;
+			if (bounced && step < 300)
+				result.bounceHeight = std::max(result.bounceHeight, height);
+			if (step >= 450)
+			{
+				lowest = std::min(lowest, height);
+				highest = std::max(highest, height);
+			}
+		}
+		result.restingRange = highest - lowest;
+		return result;
+	}
+}
+
+bool RunContactSolverBenchmarks()
+{
+	bool passed = true;
+	const SIMDLevel levels[] = { SIMDLevel::Scalar, SIMDLevel::SSE2, SIMDLevel::AVX2 };
+
+	// A settled field of stacks, the contacts solved by every batched level
+	PhysicsWorld world;
+	BuildStackField(world, 32, 4);
+	for (int step = 0; step < 30; ++step)
+		world.Step(StepTime);
+
+	ContactSolverSettings settings;
+	{
+		bool sharesNoBody = true, matches = true;
+		for (SIMDLevel level : levels)
+			matches &= !IsSIMDLevelSupported(level) || CheckBatched(world, settings, level, sharesNoBody);
+		passed &= Check("no group shares a dynamic body", sharesNoBody);
+		passed &= Check("batches match sequential in colour order", matches);
+	}
+
+	// Restitution: a bounce reaches about restitution squared of the drop height, resting bodies don't bounce
+	{
+		const float dropHeight = 2;
+		bool bounces = true, rests = true;
+		for (bool batched : { false, true })
+		{
+			const BounceResult bounce = DropBox(dropHeight, 0.5f, batched);
+			bounces &= bounce.bounceHeight > 0.15f * dropHeight && bounce.bounceHeight < 0.35f * dropHeight;
+			rests &= bounce.restingRange < 0.01f;
+
+			const BounceResult dead = DropBox(dropHeight, 0, batched);
+			bounces &= dead.bounceHeight < 0.05f;
+		}
+		passed &= Check("restitution 0.5 bounces to a quarter height", bounces);
+		passed &= Check("bouncy box comes to rest", rests);
+	}
+
+	// Timing: the field's contacts solved from the same starting point each run
+	RigidBodies bodies = world.Bodies();
+	std::vector<ContactManifold> manifolds = world.Contacts().Manifolds();
+	ContactSolver solver;
+	solver.Solve(bodies, manifolds, settings, StepTime);
+
+	const std::size_t lanes = solver.GroupCount() * ContactSolverGroup::Lanes;
+	std::printf("  %zu manifolds, %zu rows, %zu colours, %zu groups, %.0f%% of lanes used\n", manifolds.size(), solver.RowCount(),
+		solver.ColourCount(), solver.GroupCount(), 100.0 * manifolds.size() / lanes);
+
+	const std::size_t rowsSolved = solver.RowCount() * settings.iterations;
+	auto reportRows = [&](const char* label, double seconds)
+	{
+		std::printf("  %-44s %10.3f ms/solve  %12.0f rows/ms\n", label, seconds * 1e3, rowsSolved / (seconds * 1e3));
+	};
+
+	const double sequentialSeconds = TimeBest([&]
+	{
+		bodies = world.Bodies();
+		manifolds = world.Contacts().Manifolds();
+		solver.SolveSequential(bodies, manifolds, settings, StepTime);
+		DoNotOptimise(bodies.linearVelocities.Get(1));
+	});
+	reportRows("sequential", sequentialSeconds);
+
+	for (SIMDLevel level : levels)
+	{
+		if (!IsSIMDLevelSupported(level))
+			continue;
+
+		const ContactSolverKernels& kernels = GetContactSolverKernels(level);
+		const double seconds = TimeBest([&]
+		{
+			bodies = world.Bodies();
+			manifolds = world.Contacts().Manifolds();
+			solver.Solve(bodies, manifolds, settings, StepTime, kernels);
+			DoNotOptimise(bodies.linearVelocities.Get(1));
+		});
+		char label[64];
+		std::snprintf(label, sizeof(label), "batched (%s)", SIMDLevelName(level));
+		reportRows(label, seconds);
+	}
+
+	return passed;
+}
@@ -0,0 +1,246 @@
+//=========================================================================================================
+// ContinuousBenchmark.cpp: Continuous Collision for Fast Bodies
+// - Checks: a bullet passing through a thin box without continuous collision, then bullets of each shape
+//   at several speeds and angles stopping at thin boxes with it, on both broadphases. Also a bullet
+//   pushing a loose plank, bouncing with restitution, and flagged bodies that move slowly giving exactly
+//   the same results as unflagged ones
+// - Timing steps fast spheres in a room of thin walls with none, 1%, 10% and all of them flagged
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "PhysicsWorld.h"
+#include "Random.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	const float StepTime = 1.0f / 60;
+
+	// Thin wall across the x axis at x = 0
+	const float WallHalfThickness = 0.01f;
+	const Shape Wall = ShapeBox({ WallHalfThickness, 3, 3 });
+
+	std::unique_ptr<PhysicsWorld> BulletWorld(BroadphaseType broadphase, float restitution = 0)
+	{
+		PhysicsSettings settings;
+		settings.gravity = { 0, 0, 0 };
+		settings.broadphase = broadphase;
+		settings.solver.restitution = restitution;
+		return std::make_unique<PhysicsWorld>(settings);
+	}
+
+	BodyHandle AddWall(PhysicsWorld& world, float inverseMass = 0)
+	{
+		BodyDesc desc;
+		desc.inverseMass = inverseMass;
+		desc.inverseInertia = { 10, 10, 10 };
+		desc.shape = &Wall;
+		return world.CreateBody(desc);
+	}
+
+	// Starts 2m in front of the wall, aimed at its centre
+	BodyHandle AddBullet(PhysicsWorld& world, const Shape& shape, float speed, float angle, bool continuous)
+	{
+		const Vector3f direction = { std::cos(angle), 0, std::sin(angle) };
+		BodyDesc desc;
+		desc.position = direction * -2.0f;
+		desc.linearVelocity = direction * speed;
+		desc.inverseMass = 10;
+		desc.inverseInertia = { 100, 100, 100 };
+		desc.shape = &shape;
+		desc.continuousCollision = continuous;
+		return world.CreateBody(desc);
+	}
+
+	bool Tunnels(bool continuous)
+	{
+		const Shape sphere = ShapeSphere(0.05f);
+		std::unique_ptr<PhysicsWorld> world = BulletWorld(BroadphaseType::DynamicTree);
+		AddWall(*world);
+		const BodyHandle bullet = AddBullet(*world, sphere, 300, 0, continuous);
+		for (int step = 0; step < 30; ++step)
+			world->Step(StepTime);
+		return world->Position(bullet).x > 0;
+	}
+
+	bool BulletsStop()
+	{
+		const Shape shapes[] = { ShapeSphere(0.05f), ShapeBox({ 0.05f, 0.05f, 0.05f }), ShapeCapsule(0.03f, 0.1f) };
+		bool stopped = true;
+		for (BroadphaseType broadphase : { BroadphaseType::DynamicTree, BroadphaseType::SweepAndPrune })
+			for (const Shape& shape : shapes)
+				for (float speed : { 50.0f, 150.0f, 400.0f })
+					for (float angle : { 0.0f, 0.5f, 1.0f })
+					{
+						std::unique_ptr<PhysicsWorld> world = BulletWorld(broadphase);
+						AddWall(*world);
+						const BodyHandle bullet = AddBullet(*world, shape, speed, angle, true);
+						for (int step = 0; step < 60; ++step)
+						{
+							world->Step(StepTime);
+							stopped &= world->Position(bullet).x < 0;
+						}
+					}
+		return stopped;
+	}
+
+	// A heavy bullet into a light plank: the plank is pushed along and the bullet stays behind it
+	bool PushesPlank()
+	{
+		const Shape sphere = ShapeSphere(0.05f);
+		std::unique_ptr<PhysicsWorld> world = BulletWorld(BroadphaseType::DynamicTree);
+		const BodyHandle plank = AddWall(*world, 1);
+		const BodyHandle bullet = AddBullet(*world, sphere, 200, 0, true);
+		bool behind = true;
+		for (int step = 0; step < 30; ++step)
+		{
+			world->Step(StepTime);
+			behind &= world->Position(bullet).x < world->Position(plank).x;
+		}
+		return behind && world->LinearVelocity(plank).x > 1;
+	}
+
+	bool Bounces()
+	{
+		const Shape sphere = ShapeSphere(0.05f);
+		std::unique_ptr<PhysicsWorld> world = BulletWorld(BroadphaseType::DynamicTree, 1);
+		AddWall(*world);
+		const BodyHandle bullet = AddBullet(*world, sphere, 100, 0, true);
+		std::size_t impacts = 0;
+		for (int step = 0; step < 30; ++step)
+		{
+			world->Step(StepTime);
+			impacts += world->LastContinuousStats().impacts;
+		}
+		return impacts > 0 && world->Position(bullet).x < 0 && world->LinearVelocity(bullet).x < -50;
+	}
+
+	// Boxes falling onto a floor never move half their size in a step, so are never swept
+	RigidBodies Pile(bool continuous)
+	{
+		static const Shape ground = ShapeBox({ 20, 0.5f, 20 });
+		static const Shape box = ShapeBox({ 0.5f, 0.5f, 0.5f });
+		PhysicsWorld world;
+		BodyDesc desc;
+		desc.position = { 0, -0.5f, 0 };
+		desc.inverseMass = 0;
+		desc.shape = &ground;
+		world.CreateBody(desc);
+		desc.inverseMass = 1;
+		desc.inverseInertia = { 6, 6, 6 };
+		desc.shape = &box;
+		desc.continuousCollision = continuous;
+		for (int x = 0; x < 6; ++x)
+			for (int y = 0; y < 3; ++y)
+			{
+				desc.position = { x * 1.5f - 4 + 0.1f * y, 0.6f + y * 1.2f, 0 };
+				world.CreateBody(desc);
+			}
+		for (int step = 0; step < 120; ++step)
+			world.Step(StepTime);
+		return world.Bodies();
+	}
+
+	bool SlowBodiesUnchanged()
+	{
+		const RigidBodies flagged = Pile(true);
+		const RigidBodies plain = Pile(false);
+		bool same = flagged.Size() == plain.Size();
+		for (std::size_t i = 0; i < flagged.Size() && same; ++i)
+		{
+			const Vector3f p = flagged.positions.Get(i), q = plain.positions.Get(i);
+			same &= p.x == q.x && p.y == q.y && p.z == q.z;
+		}
+		return same;
+	}
+
+	// Small fast spheres bouncing around a 20m room with thin walls, every continuousEvery'th flagged
+	std::unique_ptr<PhysicsWorld> Room(std::size_t count, std::size_t continuousEvery)
+	{
+		static const Shape sphere = ShapeSphere(0.1f);
+		static const Shape wallX = ShapeBox({ WallHalfThickness, 10, 10 });
+		static const Shape wallY = ShapeBox({ 10, WallHalfThickness, 10 });
+		static const Shape wallZ = ShapeBox({ 10, 10, WallHalfThickness });
+
+		PhysicsSettings settings;
+		settings.gravity = { 0, 0, 0 };
+		settings.broadphase = BroadphaseType::SweepAndPrune;
+		settings.allowSleeping = false;
+		settings.solver.restitution = 1;
+		auto world = std::make_unique<PhysicsWorld>(settings);
+
+		BodyDesc desc;
+		desc.inverseMass = 0;
+		const Shape* walls[] = { &wallX, &wallY, &wallZ };
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			for (float side : { -10.0f, 10.0f })
+			{
+				desc.position = { axis == 0 ? side : 0, axis == 1 ? side : 0, axis == 2 ? side : 0 };
+				desc.shape = walls[axis];
+				world->CreateBody(desc);
+			}
+		}
+
+		RandomGenerator random(7);
+		desc.inverseMass = 1;
+		desc.inverseInertia = { 250, 250, 250 };
+		desc.shape = &sphere;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			desc.position = random.NextVector3({ -9, -9, -9 }, { 9, 9, 9 });
+			desc.linearVelocity = random.NextOnUnitSphere() * 20.0f; // A third of a metre per step
+			desc.continuousCollision = continuousEvery != 0 && i % continuousEvery == 0;
+			world->CreateBody(desc);
+		}
+		return world;
+	}
+}
+
+bool RunContinuousBenchmarks()
+{
+	bool passed = true;
+
+	passed &= Check("bullet tunnels without continuous", Tunnels(false));
+	passed &= Check("bullet stops at thin box with continuous", !Tunnels(true));
+	passed &= Check("bullets of each shape, speed, angle stop", BulletsStop());
+	passed &= Check("bullet pushes a loose plank", PushesPlank());
+	passed &= Check("bullet bounces with restitution", Bounces());
+	passed &= Check("slow flagged bodies same as unflagged", SlowBodiesUnchanged());
+
+	// Overhead of sweeping, against the same room with nothing flagged
+	{
+		const std::size_t count = 4000;
+		const int steps = 10;
+		double baseline = 0;
+		const std::size_t everys[] = { 0, 100, 10, 1 };
+		const char* names[] = { "none", "1%", "10%", "100%" };
+		for (int k = 0; k < 4; ++k)
+		{
+			std::unique_ptr<PhysicsWorld> world = Room(count, everys[k]);
+			world->Step(StepTime);
+			std::size_t swept = 0;
+			const double seconds = TimeBest([&]
+			{
+				for (int step = 0; step < steps; ++step)
+				{
+					world->Step(StepTime);
+					swept += world->LastContinuousStats().swept;
+				}
+			}, 3);
+			if (k == 0)
+				baseline = seconds;
+
+			char label[64];
+			std::snprintf(label, sizeof(label), "4000 fast spheres, %s continuous", names[k]);
+			Report(label, seconds / steps, 1, "step");
+			std::printf("    %zu swept per step, %+.1f%% step time\n", swept / (steps * 3), (seconds / baseline - 1) * 100);
+		}
+	}
+
+	return passed;
+}
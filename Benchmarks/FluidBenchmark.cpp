@@ -0,0 +1,240 @@
+//=========================================================================================================
+// FluidBenchmark.cpp: Position Based Fluid Dam Breaks at Each SIMD Level
+// - Checks: the grid's runs holding every neighbour, a resting lattice at the rest density, every SIMD
+//   level and thread count giving the same fluid, and a dam break reaching the far wall then settling
+//   to the rest density and the depth its volume fills the tank to
+// - Reports particle steps per second of dam breaks of 100k particles, at each SIMD level, and 1M, on one
+//   thread and several
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "Fluid.h"
+#include "JobSystem.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+	const float StepTime = 1.0f / 240;
+	const float Spacing = 0.02f;
+	const SIMDLevel Levels[] = { SIMDLevel::Scalar, SIMDLevel::SSE2, SIMDLevel::AVX2 };
+
+	// A block of columns * layers * rows particles in the corner of a tank three times as long and twice as
+	// high, the same width
+	FluidDesc DamBreak(int columns, int layers, int rows)
+	{
+		FluidDesc desc;
+		desc.spacing = Spacing;
+		desc.positions = FluidBlock({ Spacing / 2, Spacing / 2, Spacing / 2 }, columns, layers, rows, Spacing);
+		desc.boundsMin = { 0, 0, 0 };
+		desc.boundsMax = { 3 * columns * Spacing, 2 * layers * Spacing, rows * Spacing };
+		return desc;
+	}
+
+	bool Finite(const Vector3f& v)
+	{
+		return std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z);
+	}
+
+	bool Inside(const Vector3f& p, const FluidDesc& desc)
+	{
+		return p.x >= desc.boundsMin.x && p.y >= desc.boundsMin.y && p.z >= desc.boundsMin.z &&
+		       p.x <= desc.boundsMax.x && p.y <= desc.boundsMax.y && p.z <= desc.boundsMax.z;
+	}
+
+	// After a few steps of a dam break, each particle's neighbours found by testing every other particle
+	// are all in the grid's runs, and the particles are still each of the description's once
+	bool GridHoldsNeighbours()
+	{
+		Fluid fluid(DamBreak(12, 12, 12));
+		for (int step = 0; step < 20; ++step)
+			fluid.Step(StepTime);
+
+		const SpatialHashGrid& grid = fluid.Grid();
+		const float radiusSq = fluid.KernelRadius() * fluid.KernelRadius();
+		std::vector<uint8_t> seen(fluid.ParticleCount(), 0);
+		std::size_t missing = 0;
+		for (std::size_t i = 0; i < fluid.ParticleCount(); ++i)
+		{
+			seen[fluid.Id(i)]++;
+			SpatialHashGrid::ParticleRange ranges[SpatialHashGrid::MaxNeighbourRanges];
+			const int rangeCount = grid.NeighbourRanges(grid.Cell(fluid.Position(i)), ranges);
+			for (std::size_t j = 0; j < fluid.ParticleCount(); ++j)
+			{
+				const Vector3f d = fluid.Position(j) - fluid.Position(i);
+				if (Dot(d, d) >= radiusSq * 0.99f) // Particles moved a little since the grid was built
+					continue;
+				bool found = false;
+				for (int r = 0; r < rangeCount; ++r)
+					found |= j >= ranges[r].begin && j < ranges[r].end;
+				missing += !found;
+			}
+		}
+		return missing == 0 && std::all_of(seen.begin(), seen.end(), [](uint8_t count) { return count == 1; });
+	}
+
+	// Without gravity the middle of a lattice spacing apart is at the rest density, and nothing moves more
+	// than a whisker (the repulsion pushes the corners out a little)
+	bool LatticeAtRestDensity()
+	{
+		FluidDesc desc = DamBreak(10, 10, 10);
+		desc.gravity = { 0, 0, 0 };
+		Fluid fluid(desc);
+		fluid.Step(StepTime);
+
+		float worst = 0;
+		float furthest = 0;
+		for (std::size_t i = 0; i < fluid.ParticleCount(); ++i)
+		{
+			const Vector3f p = fluid.Position(i);
+			const Vector3f fromCorner = p - desc.positions[0];
+			const float inside = std::min({ fromCorner.x, fromCorner.y, fromCorner.z, 9 * Spacing - fromCorner.x,
+			                                9 * Spacing - fromCorner.y, 9 * Spacing - fromCorner.z });
+			if (inside > fluid.KernelRadius())
+				worst = std::max(worst, std::abs(fluid.Density(i) / desc.restDensity - 1));
+			furthest = std::max(furthest, (p - desc.positions[fluid.Id(i)]).Length());
+		}
+		std::printf("  10 x 10 x 10 lattice: particle mass %.3g kg, middle within %.2g%% of the rest density\n", fluid.ParticleMass(),
+			100.0 * worst);
+		return worst < 1e-3f && furthest < 1e-4f;
+	}
+
+	// Every level, a twentieth of a second of a dam break. The kernels sum the neighbours in a different order
+	// (a lane each, added together at the end) and AVX2 fuses multiply-adds, so they agree to rounding,
+	// which a splashing fluid soon grows. Particles are compared by Id as rounding can put one in another cell
+	// and so in a different order. Threads over half a second, which never reorder a sum so match exactly
+	bool LevelsAndThreadsMatch()
+	{
+		const FluidDesc desc = DamBreak(12, 12, 12);
+		auto run = [&](SIMDLevel level, JobSystem* jobs, int steps)
+		{
+			Fluid fluid(desc);
+			fluid.SetJobSystem(jobs);
+			for (int step = 0; step < steps; ++step)
+				fluid.Step(StepTime, GetFluidKernels(level));
+			return fluid;
+		};
+
+		const Fluid reference = run(SIMDLevel::Scalar, nullptr, 12);
+		std::vector<Vector3f> referencePositions(reference.ParticleCount());
+		for (std::size_t i = 0; i < reference.ParticleCount(); ++i)
+			referencePositions[reference.Id(i)] = reference.Position(i);
+		float worst = 0;
+		for (SIMDLevel level : Levels)
+		{
+			if (!IsSIMDLevelSupported(level))
+				continue;
+			const Fluid fluid = run(level, nullptr, 12);
+			for (std::size_t i = 0; i < fluid.ParticleCount(); ++i)
+				worst = std::max(worst, (fluid.Position(i) - referencePositions[fluid.Id(i)]).Length());
+		}
+
+		JobSystem jobs(4);
+		const Fluid single = run(DetectSIMDLevel(), nullptr, 120);
+		const Fluid threaded = run(DetectSIMDLevel(), &jobs, 120);
+		bool same = true;
+		for (std::size_t i = 0; i < single.ParticleCount(); ++i)
+			same &= single.Id(i) == threaded.Id(i) && single.Position(i).x == threaded.Position(i).x &&
+			        single.Position(i).y == threaded.Position(i).y && single.Position(i).z == threaded.Position(i).z;
+		return worst < 1e-4f && same;
+	}
+
+	// A 24cm cube of water let go in a 72cm tank: it reaches the far wall within half a second, never leaves
+	// the tank, and after three seconds lies at the rest density, as deep as its volume fills the floor to,
+	// still lapping a little
+	bool DamBreakSettles()
+	{
+		const int side = 12;
+		const FluidDesc desc = DamBreak(side, side, side);
+		Fluid fluid(desc);
+		bool inside = true;
+		float front = 0;
+		for (int step = 0; step < 720; ++step)
+		{
+			fluid.Step(StepTime);
+			for (std::size_t i = 0; i < fluid.ParticleCount(); ++i)
+			{
+				inside &= Finite(fluid.Position(i)) && Inside(fluid.Position(i), desc);
+				if (step < 120)
+					front = std::max(front, fluid.Position(i).x);
+			}
+		}
+
+		double density = 0;
+		double speed = 0;
+		float densest = 0;
+		float top = 0;
+		for (std::size_t i = 0; i < fluid.ParticleCount(); ++i)
+		{
+			density += fluid.Density(i);
+			speed += fluid.Velocity(i).Length();
+			densest = std::max(densest, fluid.Density(i));
+			top = std::max(top, fluid.Position(i).y);
+		}
+		density /= fluid.ParticleCount();
+		speed /= fluid.ParticleCount();
+
+		// Particle centres are half a spacing below the surface
+		const float floorArea = (desc.boundsMax.x - desc.boundsMin.x) * (desc.boundsMax.z - desc.boundsMin.z);
+		const float depth = fluid.ParticleCount() * Spacing * Spacing * Spacing / floorArea;
+		std::printf("  12 x 12 x 12 dam break after 3s: mean density %.0f, highest %.0f kg/m^3, mean speed %.3f m/s, %.1fcm deep (%.1fcm)\n",
+			density, densest, speed, 100 * (top + Spacing / 2), 100 * depth);
+		return inside && front >= desc.boundsMax.x - Spacing && std::abs(density / desc.restDensity - 1) < 0.05 &&
+		       densest < desc.restDensity * 1.1f && speed < 0.1 && std::abs(top + Spacing / 2 - depth) < Spacing;
+	}
+
+	// Dam breaks timed from a few steps in, as the column starts to fall
+	void Throughput(int columns, int layers, int rows, bool everyLevel, int steps, int repeats)
+	{
+		const FluidDesc desc = DamBreak(columns, layers, rows);
+		Fluid started(desc);
+		for (int step = 0; step < 2; ++step)
+			started.Step(StepTime);
+		std::printf("  %d x %d x %d dam break: %zu particles\n", columns, layers, rows, started.ParticleCount());
+
+		auto time = [&](const char* label, const FluidKernels& kernels, JobSystem* jobs)
+		{
+			Fluid fluid = started;
+			fluid.SetJobSystem(jobs);
+			const double seconds = TimeBest([&]
+			{
+				for (int step = 0; step < steps; ++step)
+					fluid.Step(StepTime, kernels);
+				DoNotOptimise(fluid.Position(0));
+			}, repeats);
+			Report(label, seconds / steps, fluid.ParticleCount(), "particle");
+		};
+
+		char label[64];
+		for (SIMDLevel level : Levels)
+		{
+			if (!IsSIMDLevelSupported(level) || (!everyLevel && level != DetectSIMDLevel()))
+				continue;
+			std::snprintf(label, sizeof(label), "%s, 1 thread", SIMDLevelName(level));
+			time(label, GetFluidKernels(level), nullptr);
+		}
+
+		JobSystem jobs(HardwareThreadCount());
+		std::snprintf(label, sizeof(label), "%s, %u thread%s", SIMDLevelName(DetectSIMDLevel()), jobs.ThreadCount(),
+			jobs.ThreadCount() == 1 ? "" : "s");
+		time(label, GetFluidKernels(), &jobs);
+	}
+}
+
+bool RunFluidBenchmarks()
+{
+	bool passed = true;
+	passed &= Check("grid runs hold every neighbour", GridHoldsNeighbours());
+	passed &= Check("lattice is at the rest density", LatticeAtRestDensity());
+	passed &= Check("SIMD levels and threads give the same fluid", LevelsAndThreadsMatch());
+	passed &= Check("dam break settles", DamBreakSettles());
+
+	Throughput(50, 40, 50, true, 2, 2);
+	Throughput(100, 100, 100, false, 2, 1);
+	return passed;
+}
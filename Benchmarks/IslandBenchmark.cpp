@@ -0,0 +1,196 @@
+//=========================================================================================================
+// IslandBenchmark.cpp: Union-Find Islands and Solving them on Worker Threads
+// - Islands are checked on a field of separate stacks (one island each) and on a floor of boxes all
+//   touching their neighbours (one island), and the threaded solve is checked against a single solve
+//   of every manifold: exactly equal for the sequential solver, and equal to one thread for the batched
+//   solver splitting a large island colour by colour
+// - Timing solves the contacts of many separate stacks on 1, 2, 4 ... threads, then the large island
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "PhysicsWorld.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	const float StepTime = 1.0f / 60;
+
+	const Shape Ground = ShapeBox({ 200, 0.5f, 200 });
+	const Shape Box = ShapeBox({ 0.5f, 0.5f, 0.5f });
+
+	void AddGround(PhysicsWorld& world)
+	{
+		BodyDesc desc;
+		desc.position = { 0, -0.5f, 0 };
+		desc.inverseMass = 0;
+		desc.shape = &Ground;
+		world.CreateBody(desc);
+	}
+
+	void AddBox(PhysicsWorld& world, const Vector3f& position)
+	{
+		BodyDesc desc;
+		desc.position = position;
+		desc.inverseInertia = { 6, 6, 6 };
+		desc.shape = &Box;
+		world.CreateBody(desc);
+	}
+
+	// side * side stacks of unit boxes two apart, so no stack touches another
+	void BuildStackField(PhysicsWorld& world, int side, int height)
+	{
+		AddGround(world);
+		for (int x = 0; x < side; ++x)
+			for (int z = 0; z < side; ++z)
+				for (int i = 0; i < height; ++i)
+					AddBox(world, { (x - side / 2) * 2.0f, 0.5f + i, (z - side / 2) * 2.0f });
+	}
+
+	// side * side boxes side by side, each within the contact margin of its neighbours
+	void BuildFloor(PhysicsWorld& world, int side)
+	{
+		AddGround(world);
+		for (int x = 0; x < side; ++x)
+			for (int z = 0; z < side; ++z)
+				AddBox(world, { (x - side / 2) * 1.01f, 0.5f, (z - side / 2) * 1.01f });
+	}
+
+	template<typename Build> PhysicsWorld SettledWorld(Build&& build)
+	{
+		PhysicsSettings settings;
+		settings.threadCount = 1;
+		PhysicsWorld world(settings);
+		build(world);
+		for (int step = 0; step < 10; ++step)
+			world.Step(StepTime);
+		return world;
+	}
+
+	// Largest difference in velocity or impulse between two solves of the same contacts
+	float Difference(const RigidBodies& bodiesA, const std::vector<ContactManifold>& manifoldsA,
+	                 const RigidBodies& bodiesB, const std::vector<ContactManifold>& manifoldsB)
+	{
+		float difference = 0;
+		for (std::size_t i = 0; i < bodiesA.Size(); ++i)
+		{
+			difference = std::max(difference, (bodiesA.linearVelocities.Get(i) - bodiesB.linearVelocities.Get(i)).Length());
+			difference = std::max(difference, (bodiesA.angularVelocities.Get(i) - bodiesB.angularVelocities.Get(i)).Length());
+		}
+		for (std::size_t m = 0; m < manifoldsA.size(); ++m)
+		{
+			for (int p = 0; p < manifoldsA[m].pointCount; ++p)
+				difference = std::max(difference, std::abs(manifoldsA[m].points[p].normalImpulse - manifoldsB[m].points[p].normalImpulse));
+		}
+		return difference;
+	}
+
+	// Solve the world's contacts with the island solver on some threads, from the world's current state
+	void SolveIslands(const PhysicsWorld& world, const ContactSolverSettings& settings, unsigned int threads,
+	                  RigidBodies& bodies, std::vector<ContactManifold>& manifolds, IslandSolver& solver)
+	{
+		bodies = world.Bodies();
+		manifolds = world.Contacts().Manifolds();
+		solver.SetThreadCount(threads);
+		solver.Solve(bodies, manifolds, settings, StepTime);
+	}
+
+	// 1, 2, 4 ... up to at least the hardware thread count
+	std::vector<unsigned int> ThreadCounts()
+	{
+		std::vector<unsigned int> counts;
+		for (unsigned int threads = 1; threads < std::max(4u, HardwareThreadCount()) * 2; threads *= 2)
+			counts.push_back(threads);
+		return counts;
+	}
+
+	void ReportScaling(const char* name, const PhysicsWorld& world, const ContactSolverSettings& settings)
+	{
+		RigidBodies bodies;
+		std::vector<ContactManifold> manifolds;
+		IslandSolver solver;
+		double oneThreadSeconds = 0;
+		for (unsigned int threads : ThreadCounts())
+		{
+			const double seconds = TimeBest([&]
+			{
+				SolveIslands(world, settings, threads, bodies, manifolds, solver);
+				DoNotOptimise(bodies.linearVelocities.Get(1));
+			});
+			if (threads == 1)
+				oneThreadSeconds = seconds;
+
+			char label[64];
+			std::snprintf(label, sizeof(label), "%s, %u thread%s", name, threads, threads == 1 ? "" : "s");
+			std::printf("  %-44s %10.3f ms/solve  %5.2fx\n", label, seconds * 1e3, oneThreadSeconds / seconds);
+		}
+	}
+}
+
+bool RunIslandBenchmarks()
+{
+	bool passed = true;
+	std::printf("  %u hardware threads\n", HardwareThreadCount());
+
+	const int side = 48, height = 4;
+	const PhysicsWorld stacks = SettledWorld([&](PhysicsWorld& world) { BuildStackField(world, side, height); });
+	const PhysicsWorld floor = SettledWorld([&](PhysicsWorld& world) { BuildFloor(world, 64); });
+
+	// Island building
+	{
+		const Islands& islands = stacks.ContactIslands();
+		bool allStacks = islands.Count() == std::size_t(side * side);
+		for (std::size_t i = 0; i < islands.Count(); ++i)
+			allStacks &= islands.BodyCount(i) == std::size_t(height) && islands.ManifoldCount(i) == std::size_t(height);
+		passed &= Check("one island per stack", allStacks);
+
+		passed &= Check("touching floor is one island", floor.ContactIslands().Count() == 1 &&
+			floor.ContactIslands().BodyCount(0) == floor.BodyCount() - 1 && floor.ContactIslands().ManifoldCount(0) == floor.Contacts().Size());
+	}
+
+	// Threaded solves against one solve of everything
+	{
+		ContactSolverSettings settings;
+		RigidBodies expectedBodies = stacks.Bodies();
+		std::vector<ContactManifold> expectedManifolds = stacks.Contacts().Manifolds();
+		ContactSolver single;
+		single.SolveSequential(expectedBodies, expectedManifolds, settings, StepTime);
+
+		RigidBodies bodies;
+		std::vector<ContactManifold> manifolds;
+		IslandSolver solver;
+		bool equal = true;
+		for (unsigned int threads : ThreadCounts())
+		{
+			SolveIslands(stacks, settings, threads, bodies, manifolds, solver);
+			equal &= Difference(bodies, manifolds, expectedBodies, expectedManifolds) == 0;
+		}
+		passed &= Check("sequential islands equal one solve", equal);
+
+		settings.batched = true;
+		SolveIslands(floor, settings, 1, expectedBodies, expectedManifolds, solver);
+		equal = true;
+		for (unsigned int threads : ThreadCounts())
+		{
+			SolveIslands(floor, settings, threads, bodies, manifolds, solver);
+			equal &= Difference(bodies, manifolds, expectedBodies, expectedManifolds) == 0;
+		}
+		passed &= Check("large batched island same on any threads", equal);
+	}
+
+	// Scaling
+	std::printf("  %zu separate stacks, %zu manifolds\n", stacks.ContactIslands().Count(), stacks.Contacts().Size());
+	ContactSolverSettings settings;
+	ReportScaling("stacks, sequential", stacks, settings);
+	settings.batched = true;
+	ReportScaling("stacks, batched", stacks, settings);
+
+	std::printf("  one island of %zu boxes, %zu manifolds\n", floor.BodyCount() - 1, floor.Contacts().Size());
+	ReportScaling("floor, batched", floor, settings);
+
+	return passed;
+}
@@ -0,0 +1,288 @@
+//=========================================================================================================
+// JobSystemBenchmark.cpp: Work-Stealing Jobs against a Thread per Task
+// - Stress checks: many tiny jobs, parallel loops visiting every index exactly once at many sizes and
+//   grains, jobs that wait for jobs of their own, chains of held back jobs running in order, and worlds
+//   stepped on different thread counts giving exactly the same bodies
+// - Timing runs small tasks as jobs and as a std::thread each, and a parallel loop on the job system and
+//   with ParallelFor starting threads for the call
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "JobSystem.h"
+#include "ParallelFor.h"
+#include "PhysicsWorld.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// 1, 2, 4 ... up to at least the hardware thread count
+	std::vector<unsigned int> ThreadCounts()
+	{
+		std::vector<unsigned int> counts;
+		for (unsigned int threads = 1; threads < std::max(4u, HardwareThreadCount()) * 2; threads *= 2)
+			counts.push_back(threads);
+		return counts;
+	}
+
+	// A little arithmetic the optimiser can't remove, standing in for a task's work
+	BENCHMARK_NOINLINE float Work(std::size_t seed, int steps)
+	{
+		float x = static_cast<float>(seed & 0xFF) * 0.01f;
+		for (int i = 0; i < steps; ++i)
+			x = x * 0.999f + 0.5f;
+		return x;
+	}
+
+	bool ManyJobs(JobSystem& jobs)
+	{
+		// More jobs than the rings hold, so slots are reused while others are still queued
+		const std::size_t count = 100000;
+		std::atomic<std::size_t> sum{ 0 };
+		std::vector<std::function<void()>> functions(count);
+		for (std::size_t i = 0; i < count; ++i)
+			functions[i] = [&sum, i] { sum += i; };
+
+		JobCounter counter;
+		for (std::size_t i = 0; i < count; ++i)
+			jobs.Run(functions[i], counter);
+		jobs.Wait(counter);
+		return sum == count * (count - 1) / 2;
+	}
+
+	bool EveryIndexOnce(JobSystem& jobs)
+	{
+		bool passed = true;
+		for (std::size_t count : { std::size_t(0), std::size_t(1), std::size_t(7), std::size_t(1000), std::size_t(100003) })
+		{
+			for (std::size_t grain : { std::size_t(1), std::size_t(3), std::size_t(64), std::size_t(5000) })
+			{
+				std::vector<std::atomic<uint8_t>> visits(count);
+				std::atomic<bool> tooLarge{ false };
+				jobs.ParallelFor(count, grain, [&](std::size_t begin, std::size_t end)
+				{
+					tooLarge = tooLarge || end - begin > grain;
+					for (std::size_t i = begin; i < end; ++i)
+						++visits[i];
+				});
+				passed &= !tooLarge;
+				for (std::size_t i = 0; i < count; ++i)
+					passed &= visits[i] == 1;
+			}
+		}
+		return passed;
+	}
+
+	// Each outer piece runs a parallel loop of its own and waits for it from inside a job
+	bool NestedLoops(JobSystem& jobs)
+	{
+		const std::size_t outer = 64, inner = 1000;
+		std::vector<std::size_t> sums(outer, 0);
+		jobs.ParallelFor(outer, 1, [&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t o = begin; o < end; ++o)
+			{
+				std::atomic<std::size_t> sum{ 0 };
+				jobs.ParallelFor(inner, 16, [&](std::size_t b, std::size_t e)
+				{
+					std::size_t local = 0;
+					for (std::size_t i = b; i < e; ++i)
+						local += i;
+					sum += local;
+				});
+				sums[o] = sum;
+			}
+		});
+		return std::all_of(sums.begin(), sums.end(), [&](std::size_t sum) { return sum == inner * (inner - 1) / 2; });
+	}
+
+	// A chain of stages, each held back until the one before has finished, with parallel work in each
+	bool Chain(JobSystem& jobs)
+	{
+		const std::size_t stages = 200, width = 8;
+		std::vector<std::atomic<std::size_t>> done(stages);
+		std::atomic<bool> early{ false };
+
+		std::vector<std::function<void()>> work(stages);
+		std::vector<JobCounter> counters(stages);
+		for (std::size_t s = 0; s < stages; ++s)
+		{
+			work[s] = [&, s]
+			{
+				early = early || (s > 0 && done[s - 1] != width);
+				DoNotOptimise(Work(s, 100));
+				++done[s];
+			};
+			for (std::size_t w = 0; w < width; ++w)
+			{
+				if (s == 0)
+					jobs.Run(work[s], counters[s]);
+				else
+					jobs.RunAfter(counters[s - 1], work[s], counters[s]);
+			}
+		}
+		jobs.Wait(counters.back());
+		for (JobCounter& counter : counters)
+			jobs.Wait(counter);
+		return !early && std::all_of(done.begin(), done.end(), [&](const std::atomic<std::size_t>& d) { return d == width; });
+	}
+
+	// Boxes dropped onto a floor and each other, stepped for a while
+	RigidBodies SteppedWorld(unsigned int threads)
+	{
+		static const Shape ground = ShapeBox({ 50, 0.5f, 50 });
+		static const Shape box = ShapeBox({ 0.5f, 0.5f, 0.5f });
+		PhysicsSettings settings;
+		settings.threadCount = threads;
+		settings.broadphase = BroadphaseType::SweepAndPrune;
+		PhysicsWorld world(settings);
+
+		BodyDesc desc;
+		desc.position = { 0, -0.5f, 0 };
+		desc.inverseMass = 0;
+		desc.shape = &ground;
+		world.CreateBody(desc);
+		desc.inverseMass = 1;
+		desc.inverseInertia = { 6, 6, 6 };
+		desc.shape = &box;
+		for (int x = 0; x < 24; ++x)
+			for (int z = 0; z < 24; ++z)
+				for (int y = 0; y < 3; ++y)
+				{
+					desc.position = { x * 1.5f - 18 + 0.1f * y, 0.6f + y * 1.2f, z * 1.5f - 18 };
+					world.CreateBody(desc);
+				}
+		for (int step = 0; step < 60; ++step)
+			world.Step(1.0f / 60);
+		return world.Bodies();
+	}
+
+	bool SameOnAnyThreads()
+	{
+		const RigidBodies expected = SteppedWorld(1);
+		bool same = true;
+		for (unsigned int threads : ThreadCounts())
+		{
+			const RigidBodies bodies = SteppedWorld(threads);
+			same &= bodies.Size() == expected.Size();
+			for (std::size_t i = 0; i < bodies.Size() && same; ++i)
+			{
+				const Vector3f p = bodies.positions.Get(i), q = expected.positions.Get(i);
+				same &= p.x == q.x && p.y == q.y && p.z == q.z;
+			}
+		}
+		return same;
+	}
+}
+
+bool RunJobSystemBenchmarks()
+{
+	bool passed = true;
+	std::printf("  %u hardware threads\n", HardwareThreadCount());
+
+	// Stress checks on each thread count, several rounds so timing differences change the interleaving
+	{
+		bool many = true, once = true, nested = true, chain = true, restart = true;
+		for (unsigned int threads : ThreadCounts())
+		{
+			JobSystem jobs(threads);
+			for (int round = 0; round < 3; ++round)
+			{
+				many &= ManyJobs(jobs);
+				once &= EveryIndexOnce(jobs);
+				nested &= NestedLoops(jobs);
+				chain &= Chain(jobs);
+			}
+			jobs.SetThreadCount(threads + 1);
+			restart &= jobs.ThreadCount() == threads + 1 && ManyJobs(jobs);
+		}
+		passed &= Check("100k jobs all run once", many);
+		passed &= Check("parallel loops visit every index once", once);
+		passed &= Check("jobs wait for their own loops", nested);
+		passed &= Check("held back stages run in order", chain);
+		passed &= Check("restarted with more threads", restart);
+		passed &= Check("world same on any thread count", SameOnAnyThreads());
+	}
+
+	// Small tasks: a thread started for each against jobs
+	{
+		const std::size_t tasks = 1000;
+		const int workSteps = 2000;
+		std::vector<float> results(tasks);
+
+		const double threadSeconds = TimeBest([&]
+		{
+			std::vector<std::thread> threads;
+			threads.reserve(tasks);
+			for (std::size_t t = 0; t < tasks; ++t)
+				threads.emplace_back([&results, t, workSteps] { results[t] = Work(t, workSteps); });
+			for (std::thread& thread : threads)
+				thread.join();
+			DoNotOptimise(results[0]);
+		}, 3);
+		Report("1000 tasks, std::thread per task", threadSeconds, tasks, "task");
+
+		for (unsigned int threadCount : ThreadCounts())
+		{
+			JobSystem jobs(threadCount);
+			std::vector<std::function<void()>> functions(tasks);
+			for (std::size_t t = 0; t < tasks; ++t)
+				functions[t] = [&results, t, workSteps] { results[t] = Work(t, workSteps); };
+
+			const double seconds = TimeBest([&]
+			{
+				JobCounter counter;
+				for (std::size_t t = 0; t < tasks; ++t)
+					jobs.Run(functions[t], counter);
+				jobs.Wait(counter);
+				DoNotOptimise(results[0]);
+			});
+			char label[64];
+			std::snprintf(label, sizeof(label), "1000 tasks, jobs on %u thread%s", threadCount, threadCount == 1 ? "" : "s");
+			Report(label, seconds, tasks, "task");
+		}
+	}
+
+	// A loop over a million items, many times in a row as a step's stages would be
+	{
+		const std::size_t count = 1000000;
+		const int loops = 20;
+		std::vector<float> values(count, 1);
+		auto body = [&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; ++i)
+				values[i] = values[i] * 0.999f + 0.001f;
+		};
+
+		for (unsigned int threadCount : ThreadCounts())
+		{
+			const double threadSeconds = TimeBest([&]
+			{
+				for (int loop = 0; loop < loops; ++loop)
+					ParallelFor(count, threadCount, 1, [&](std::size_t begin, std::size_t end, unsigned int) { body(begin, end); });
+				DoNotOptimise(values[0]);
+			});
+
+			JobSystem jobs(threadCount);
+			const double jobSeconds = TimeBest([&]
+			{
+				for (int loop = 0; loop < loops; ++loop)
+					jobs.ParallelFor(count, 16384, body);
+				DoNotOptimise(values[0]);
+			});
+
+			char label[64];
+			std::snprintf(label, sizeof(label), "1M loop, threads per call, %u thread%s", threadCount, threadCount == 1 ? "" : "s");
+			Report(label, threadSeconds / loops, count, "item");
+			std::snprintf(label, sizeof(label), "1M loop, jobs, %u thread%s", threadCount, threadCount == 1 ? "" : "s");
+			Report(label, jobSeconds / loops, count, "item");
+		}
+	}
+
+	return passed;
+}
@@ -0,0 +1,433 @@
+//=========================================================================================================
+// JointBenchmark.cpp: Ball, Hinge, Slider, Distance and Fixed Joints
+// - Checks: each joint type holding a spinning box against gravity, hinge and slider limits and motors,
+//   distance ranges, joints going with their bodies, contacts between jointed bodies only if asked for,
+//   the same results on one thread and several, and the block solve holding driven 50 link chains to
+//   under three quarters of the rows' error at the default iterations
+// - Reports the worst joint error of those chains against iterations, block and rows, and the time per
+//   step of many swinging chains
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "PhysicsWorld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	const float StepTime = 1.0f / 60;
+
+	const Shape Box = ShapeBox({ 0.2f, 0.2f, 0.2f });
+
+	BodyHandle AddStatic(PhysicsWorld& world)
+	{
+		BodyDesc desc;
+		desc.inverseMass = 0;
+		return world.CreateBody(desc);
+	}
+
+	BodyHandle AddBox(PhysicsWorld& world, const Vector3f& position)
+	{
+		BodyDesc desc;
+		desc.position = position;
+		desc.inverseMass = 1;
+		desc.inverseInertia = { 20, 20, 20 };
+		desc.shape = &Box;
+		return world.CreateBody(desc);
+	}
+
+	std::unique_ptr<PhysicsWorld> JointWorld(int iterations = 8, bool blocks = true, unsigned int threads = 1)
+	{
+		PhysicsSettings settings;
+		settings.allowSleeping = false;
+		settings.threadCount = threads;
+		settings.solver.iterations = iterations;
+		settings.solver.jointBlocks = blocks;
+		return std::make_unique<PhysicsWorld>(settings);
+	}
+
+	// A box hung 0.5m to the side of a static body, thrown and spinning. The locked directions must hold to
+	// within the drift of a step's turn, which the next steps pull back
+	bool Holds(JointType type)
+	{
+		std::unique_ptr<PhysicsWorld> world = JointWorld();
+		const BodyHandle ground = AddStatic(*world);
+		const BodyHandle box = AddBox(*world, { 0.5f, 0, 0 });
+		world->SetLinearVelocity(box, { 0, 1, 2 });
+		world->SetAngularVelocity(box, { 3, -2, 5 });
+
+		JointDesc desc;
+		desc.type = type;
+		desc.bodyA = ground;
+		desc.bodyB = box;
+		desc.axis = { 1, 0, 0 };
+		const JointHandle joint = world->CreateJoint(desc);
+
+		float worst = 0;
+		for (int step = 0; step < 120; ++step)
+		{
+			world->Step(StepTime);
+			const JointError error = world->MeasureJointError(joint);
+			worst = std::max({ worst, error.linear, error.angular * 0.5f });
+		}
+		return worst < 0.02f;
+	}
+
+	// A box on a hinge about z, swinging down under gravity from level, stops at the lower limit
+	bool HingeLimit()
+	{
+		std::unique_ptr<PhysicsWorld> world = JointWorld();
+		JointDesc desc;
+		desc.type = JointType::Hinge;
+		desc.bodyA = AddStatic(*world);
+		desc.bodyB = AddBox(*world, { 0.5f, 0, 0 });
+		desc.axis = { 0, 0, 1 };
+		desc.limited = true;
+		desc.lower = -0.5f;
+		desc.upper = 0.5f;
+		const JointHandle joint = world->CreateJoint(desc);
+
+		float lowest = 0;
+		for (int step = 0; step < 120; ++step)
+		{
+			world->Step(StepTime);
+			lowest = std::min(lowest, world->JointPosition(joint));
+		}
+		return lowest > -0.52f && std::abs(world->JointPosition(joint) + 0.5f) < 0.01f;
+	}
+
+	// A wheel turned by its motor in free space: full speed with enough torque, slower with too little to
+	// overcome a weight hanging from its rim
+	bool HingeMotor()
+	{
+		std::unique_ptr<PhysicsWorld> world = JointWorld();
+		JointDesc desc;
+		desc.type = JointType::Hinge;
+		desc.bodyA = AddStatic(*world);
+		desc.bodyB = AddBox(*world, { 0, 0, 0 });
+		desc.axis = { 0, 0, 1 };
+		const JointHandle joint = world->CreateJoint(desc);
+		world->SetJointMotor(joint, 2, 100);
+		for (int step = 0; step < 30; ++step)
+			world->Step(StepTime);
+		const bool fullSpeed = std::abs(world->AngularVelocity(desc.bodyB).z - 2) < 0.01f;
+
+		// 1 kg at 0.5m needs 4.9 N m to hold level, 1 N m can't lift it
+		std::unique_ptr<PhysicsWorld> weak = JointWorld();
+		desc.bodyA = AddStatic(*weak);
+		desc.bodyB = AddBox(*weak, { 0.5f, 0, 0 });
+		const JointHandle weakJoint = weak->CreateJoint(desc);
+		weak->SetJointMotor(weakJoint, 2, 1);
+		for (int step = 0; step < 10; ++step)
+			weak->Step(StepTime);
+		return fullSpeed && weak->JointPosition(weakJoint) < 0;
+	}
+
+	// A box on a vertical slider falls to the bottom of its travel, then the motor drives it along
+	bool SliderLimitAndMotor()
+	{
+		std::unique_ptr<PhysicsWorld> world = JointWorld();
+		JointDesc desc;
+		desc.type = JointType::Slider;
+		desc.bodyA = AddStatic(*world);
+		desc.bodyB = AddBox(*world, { 0, 0, 0 });
+		desc.axis = { 0, 1, 0 };
+		desc.limited = true;
+		desc.lower = -0.5f;
+		desc.upper = 0.5f;
+		const JointHandle joint = world->CreateJoint(desc);
+		for (int step = 0; step < 60; ++step)
+			world->Step(StepTime);
+		const bool atLimit = std::abs(world->JointPosition(joint) + 0.5f) < 0.01f;
+
+		world->SetJointMotor(joint, 1, 100);
+		for (int step = 0; step < 10; ++step)
+			world->Step(StepTime);
+		const bool moving = std::abs(world->LinearVelocity(desc.bodyB).y - 1) < 0.01f;
+		for (int step = 0; step < 60; ++step)
+			world->Step(StepTime);
+		return atLimit && moving && std::abs(world->JointPosition(joint) - 0.5f) < 0.01f;
+	}
+
+	// A rope (1 to 2m) lets the box fall to 2m and no further, a rod keeps it at its starting distance
+	bool DistanceRange()
+	{
+		bool passed = true;
+		for (bool limited : { true, false })
+		{
+			std::unique_ptr<PhysicsWorld> world = JointWorld();
+			JointDesc desc;
+			desc.type = JointType::Distance;
+			desc.bodyA = AddStatic(*world);
+			desc.bodyB = AddBox(*world, { 1.5f, 0, 0 });
+			desc.anchorB = { 1.5f, 0, 0 };
+			desc.limited = limited;
+			desc.lower = 1;
+			desc.upper = 2;
+			const JointHandle joint = world->CreateJoint(desc);
+			for (int step = 0; step < 120; ++step)
+			{
+				world->Step(StepTime);
+				const float distance = world->JointPosition(joint);
+				passed &= limited ? distance < 2.02f && distance > 0.98f : std::abs(distance - 1.5f) < 0.02f;
+			}
+			if (limited)
+				passed &= world->JointPosition(joint) > 1.95f;
+		}
+		return passed;
+	}
+
+	bool DestroyingBodyRemovesJoints()
+	{
+		std::unique_ptr<PhysicsWorld> world = JointWorld();
+		const BodyHandle ground = AddStatic(*world);
+		const BodyHandle a = AddBox(*world, { 1, 0, 0 });
+		const BodyHandle b = AddBox(*world, { 2, 0, 0 });
+		JointDesc desc;
+		desc.bodyA = ground;
+		desc.bodyB = a;
+		const JointHandle first = world->CreateJoint(desc);
+		desc.bodyA = a;
+		desc.bodyB = b;
+		desc.anchor = { 1.5f, 0, 0 };
+		const JointHandle second = world->CreateJoint(desc);
+		desc.bodyA = ground;
+		const JointHandle third = world->CreateJoint(desc);
+
+		world->DestroyBody(a);
+		world->Step(StepTime);
+		return !world->IsValid(first) && !world->IsValid(second) && world->IsValid(third) && world->JointCount() == 1;
+	}
+
+	// Two overlapping boxes joined at the middle, with and without collideConnected
+	std::size_t ContactsBetweenJoined(bool collideConnected)
+	{
+		std::unique_ptr<PhysicsWorld> world = JointWorld();
+		JointDesc desc;
+		desc.bodyA = AddBox(*world, { 0, 0, 0 });
+		desc.bodyB = AddBox(*world, { 0.3f, 0, 0 });
+		desc.anchor = { 0.15f, 0, 0 };
+		desc.collideConnected = collideConnected;
+		world->CreateJoint(desc);
+		world->Step(StepTime); // Finds the pair
+		world->Step(StepTime);
+		return world->Contacts().Size();
+	}
+
+	// count chains of links ball jointed end to end, hanging from static bodies a metre apart, set off swinging
+	struct Chains
+	{
+		std::unique_ptr<PhysicsWorld> world;
+		std::vector<JointHandle> joints;
+	};
+
+	Chains BuildChains(std::size_t count, int links, int iterations, bool blocks, unsigned int threads = 1)
+	{
+		const float length = 0.2f;
+		const Vector3f down = { std::sin(1.0f), -std::cos(1.0f), 0 };
+		Chains chains = { JointWorld(iterations, blocks, threads), {} };
+		for (std::size_t c = 0; c < count; ++c)
+		{
+			const Vector3f top = { 0, 0, static_cast<float>(c) };
+			BodyHandle previous = AddStatic(*chains.world);
+			chains.world->SetPosition(previous, top);
+			for (int i = 0; i < links; ++i)
+			{
+				BodyDesc desc;
+				desc.position = top + down * (length * (i + 0.5f));
+				desc.inverseMass = 1;
+				desc.inverseInertia = { 100, 100, 100 };
+				const BodyHandle link = chains.world->CreateBody(desc);
+
+				JointDesc joint;
+				joint.bodyA = previous;
+				joint.bodyB = link;
+				joint.anchor = top + down * (length * i);
+				chains.joints.push_back(chains.world->CreateJoint(joint));
+				previous = link;
+			}
+		}
+		return chains;
+	}
+
+	// Points at equal lengths along the catenary a chain of the given length hangs in between two points
+	// span apart: y = a cosh(x / a), with a from the length, 2 a sinh(span / 2a), and x = a asinh(s / a) at
+	// length s from the middle
+	std::vector<Vector3f> CatenaryPoints(int links, float length, float span)
+	{
+		float low = 0.01f, high = 100;
+		for (int k = 0; k < 50; ++k)
+		{
+			const float a = (low + high) / 2;
+			(2 * a * std::sinh(span / (2 * a)) > length ? low : high) = a;
+		}
+		const float a = (low + high) / 2;
+		const float lowest = a * std::cosh(span / (2 * a));
+		std::vector<Vector3f> points;
+		for (int i = 0; i <= links; ++i)
+		{
+			const float x = a * std::asinh((length * i / links - length / 2) / a);
+			points.push_back({ x, a * std::cosh(x / a) - lowest, 0 });
+		}
+		return points;
+	}
+
+	// 10m chains of 50 links hung between static bodies 8.5 to 9.2m apart, started in their catenaries.
+	// One end of each is shaken 0.5m sideways every two seconds, and 3/s of the links' speeds is taken off
+	// each step, as bodies have no damping of their own, so after ten seconds they have settled into a
+	// steady swing. Worst joint error of each chain each step, averaged over the next two seconds and the
+	// chains. How a single chain settles depends a lot on its exact shape, so there are a few
+	float DrivenChainError(int iterations, bool blocks)
+	{
+		struct Chain
+		{
+			std::vector<BodyHandle> links;
+			std::vector<JointHandle> joints;
+			BodyHandle end;
+		};
+
+		const int links = 50;
+		std::unique_ptr<PhysicsWorld> world = JointWorld(iterations, blocks);
+		std::vector<Chain> chains;
+		for (float span : { 8.5f, 8.8f, 9.0f, 9.2f })
+		{
+			const Vector3f offset = { 0, 0, 3.0f * chains.size() };
+			std::vector<Vector3f> points = CatenaryPoints(links, 10, span);
+			Chain chain;
+			BodyHandle previous = AddStatic(*world);
+			world->SetPosition(previous, points.front() + offset);
+			for (int i = 0; i <= links; ++i)
+			{
+				BodyHandle body;
+				if (i < links)
+				{
+					BodyDesc desc;
+					desc.position = (points[i] + points[i + 1]) * 0.5f + offset;
+					desc.inverseMass = 1;
+					desc.inverseInertia = { 100, 100, 100 };
+					body = world->CreateBody(desc);
+					chain.links.push_back(body);
+				}
+				else
+				{
+					body = AddStatic(*world);
+					world->SetPosition(body, points.back() + offset);
+				}
+
+				JointDesc joint;
+				joint.bodyA = previous;
+				joint.bodyB = body;
+				joint.anchor = points[i] + offset;
+				chain.joints.push_back(world->CreateJoint(joint));
+				previous = body;
+			}
+			chain.end = previous;
+			chains.push_back(chain);
+		}
+
+		const float amplitude = 0.5f;
+		const float frequency = 3.14159265f; // rad/s
+		const float damping = 3;
+		const int settleSteps = 600;
+		const int steps = 120;
+		float total = 0;
+		for (int step = 0; step < settleSteps + steps; ++step)
+		{
+			for (const Chain& chain : chains)
+			{
+				world->SetLinearVelocity(chain.end, { 0, 0, amplitude * frequency * std::cos(frequency * step * StepTime) });
+				for (BodyHandle body : chain.links)
+				{
+					world->SetLinearVelocity(body, world->LinearVelocity(body) * (1 - damping * StepTime));
+					world->SetAngularVelocity(body, world->AngularVelocity(body) * (1 - damping * StepTime));
+				}
+			}
+			world->Step(StepTime);
+			if (step < settleSteps)
+				continue;
+
+			for (const Chain& chain : chains)
+			{
+				float worst = 0;
+				for (JointHandle joint : chain.joints)
+					worst = std::max(worst, world->MeasureJointError(joint).linear);
+				total += worst;
+			}
+		}
+		return total / (steps * chains.size());
+	}
+
+	bool ThreadsMatch()
+	{
+		Chains one = BuildChains(32, 20, 8, true, 1);
+		Chains several = BuildChains(32, 20, 8, true, 4);
+		for (int step = 0; step < 60; ++step)
+		{
+			one.world->Step(StepTime);
+			several.world->Step(StepTime);
+		}
+		const RigidBodies& a = one.world->Bodies();
+		const RigidBodies& b = several.world->Bodies();
+		bool same = a.Size() == b.Size();
+		for (std::size_t i = 0; i < a.Size() && same; ++i)
+		{
+			const Vector3f p = a.positions.Get(i), q = b.positions.Get(i);
+			same &= p.x == q.x && p.y == q.y && p.z == q.z;
+		}
+		return same;
+	}
+}
+
+bool RunJointBenchmarks()
+{
+	bool passed = true;
+
+	passed &= Check("ball joint holds", Holds(JointType::Ball));
+	passed &= Check("hinge joint holds", Holds(JointType::Hinge));
+	passed &= Check("slider joint holds", Holds(JointType::Slider));
+	passed &= Check("fixed joint holds", Holds(JointType::Fixed));
+	passed &= Check("hinge stops at its limit", HingeLimit());
+	passed &= Check("hinge motor speed and torque limit", HingeMotor());
+	passed &= Check("slider limits and motor", SliderLimitAndMotor());
+	passed &= Check("distance joint range and rod", DistanceRange());
+	passed &= Check("destroying a body removes its joints", DestroyingBodyRemovesJoints());
+	passed &= Check("joined bodies collide only if asked", ContactsBetweenJoined(false) == 0 && ContactsBetweenJoined(true) > 0);
+	passed &= Check("1 and 4 threads give the same chains", ThreadsMatch());
+
+	// The block makes each joint exact on its own, which matters where the chain bends: there each joint's
+	// rows push each other's anchors about. A long chain still needs many iterations to pass the weight of
+	// the links up to the ends. Fewer than 8 and this slack a chain gets away from the rows entirely
+	std::printf("  driven 50 link chains, mean worst joint error (mm):\n");
+	float blockError = 0, rowsError = 0;
+	for (int iterations : { 2, 4, 8, 16, 32 })
+	{
+		const float block = DrivenChainError(iterations, true);
+		const float rows = DrivenChainError(iterations, false);
+		std::printf("    %2d iterations  block %8.2f  rows %8.2f\n", iterations, block * 1e3f, rows * 1e3f);
+		if (iterations == ContactSolverSettings().iterations)
+		{
+			blockError = block;
+			rowsError = rows;
+		}
+	}
+	passed &= Check("50 link chains, block beats rows", blockError < 0.75f * rowsError);
+
+	for (bool blocks : { true, false })
+	{
+		Chains chains = BuildChains(100, 50, 8, blocks);
+		chains.world->Step(StepTime);
+		const int steps = 10;
+		const double seconds = TimeBest([&]
+		{
+			for (int step = 0; step < steps; ++step)
+				chains.world->Step(StepTime);
+		}, 3);
+		Report(blocks ? "100 chains of 50, block" : "100 chains of 50, rows", seconds / steps, 1, "step");
+	}
+
+	return passed;
+}
@@ -0,0 +1,78 @@
+//=========================================================================================================
+// MathsBenchmark.cpp: Per-Operation Cost of the Vector Maths Types
+// - "out-of-line" versions call the operation through a function that cannot be inlined, matching the
+//   cost of the old .cpp / explicit instantiation layout. "inline" versions use the header directly
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Matrix4x4.h"
+
+#include <random>
+#include <vector>
+
+// The header-only types can be evaluated at compile time
+static_assert(Dot(Vector3(1, 2, 3), Vector3(4, 5, 6)) == 32);
+static_assert(Cross(Vector3(1, 0, 0), Vector3(0, 1, 0)).z == 1);
+static_assert((Vector2i(1, 2) + Vector2i(3, 4)).LengthSq() == 52);
+static_assert(IsZero(ToRadians(0.0)));
+
+namespace
+{
+	const std::size_t NumVectors = 1 << 14;
+	const int Passes = 64;
+
+	// Previous layout: every operator was an out-of-line call
+	BENCHMARK_NOINLINE Vector3 CallAdd(const Vector3& v, const Vector3& w) { return v + w; }
+	BENCHMARK_NOINLINE Vector3 CallScale(const Vector3& v, float s) { return v * s; }
+	BENCHMARK_NOINLINE float CallDot(const Vector3& v, const Vector3& w) { return Dot(v, w); }
+	BENCHMARK_NOINLINE Vector3 CallCross(const Vector3& v, const Vector3& w) { return Cross(v, w); }
+	BENCHMARK_NOINLINE Vector3 CallNormalise(const Vector3& v) { return Normalise(v); }
+
+	// Time "operation" applied across the whole array for several passes
+	template<typename F> void Time(const char* name, F&& operation)
+	{
+		double seconds = TimeBest([&]()
+			{
+				for (int pass = 0; pass < Passes; ++pass)
+					operation();
+			});
+		Report(name, seconds, NumVectors * Passes);
+	}
+}
+
+bool RunMathsBenchmarks()
+{
+	std::mt19937 generator(1234);
+	std::uniform_real_distribution<float> range(-10, 10);
+
+	std::vector<Vector3> a(NumVectors), b(NumVectors), out(NumVectors);
+	for (std::size_t i = 0; i < NumVectors; ++i)
+	{
+		a[i] = { range(generator), range(generator), range(generator) };
+		b[i] = { range(generator), range(generator), range(generator) };
+	}
+	float sum = 0;
+
+	Time("Vector3 add (out-of-line)", [&]() { for (std::size_t i = 0; i < NumVectors; ++i) out[i] = CallAdd(a[i], b[i]); DoNotOptimise(out); });
+	Time("Vector3 add (inline)", [&]() { for (std::size_t i = 0; i < NumVectors; ++i) out[i] = a[i] + b[i]; DoNotOptimise(out); });
+
+	Time("Vector3 scale (out-of-line)", [&]() { for (std::size_t i = 0; i < NumVectors; ++i) out[i] = CallScale(a[i], 0.5f); DoNotOptimise(out); });
+	Time("Vector3 scale (inline)", [&]() { for (std::size_t i = 0; i < NumVectors; ++i) out[i] = a[i] * 0.5f; DoNotOptimise(out); });
+
+	Time("Vector3 dot (out-of-line)", [&]() { for (std::size_t i = 0; i < NumVectors; ++i) sum += CallDot(a[i], b[i]); DoNotOptimise(sum); });
+	Time("Vector3 dot (inline)", [&]() { for (std::size_t i = 0; i < NumVectors; ++i) sum += Dot(a[i], b[i]); DoNotOptimise(sum); });
+
+	Time("Vector3 cross (out-of-line)", [&]() { for (std::size_t i = 0; i < NumVectors; ++i) out[i] = CallCross(a[i], b[i]); DoNotOptimise(out); });
+	Time("Vector3 cross (inline)", [&]() { for (std::size_t i = 0; i < NumVectors; ++i) out[i] = Cross(a[i], b[i]); DoNotOptimise(out); });
+
+	Time("Vector3 normalise (out-of-line)", [&]() { for (std::size_t i = 0; i < NumVectors; ++i) out[i] = CallNormalise(a[i]); DoNotOptimise(out); });
+	Time("Vector3 normalise (inline)", [&]() { for (std::size_t i = 0; i < NumVectors; ++i) out[i] = Normalise(a[i]); DoNotOptimise(out); });
+
+	bool passed = true;
+	passed &= Check("Normalise gives unit length", std::abs(Normalise(a[0]).Length() - 1) < 1e-5f);
+	passed &= Check("AngleBetween of perpendicular axes", std::abs(AngleBetween(Vector3(1, 0, 0), Vector3(0, 0, 1)) - std::numbers::pi_v<float> / 2) < 1e-6f);
+	return passed;
+}
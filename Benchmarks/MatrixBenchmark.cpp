@@ -0,0 +1,102 @@
+//=========================================================================================================
+// MatrixBenchmark.cpp: Matrix4x4T Affine Algebra - General vs Affine Inverse and Batched Multiplication
+// - World matrices are built from random position / rotation / scale as they would be for bodies
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "Matrix4x4.h"
+#include "MathsSIMD.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	const std::size_t NumMatrices = 1 << 14;
+
+	float MaxError(const Matrix4x4f& a, const Matrix4x4f& b)
+	{
+		float error = 0;
+		for (int i = 0; i < 16; ++i)
+			error = std::max(error, std::abs((&a.e00)[i] - (&b.e00)[i]));
+		return error;
+	}
+}
+
+bool RunMatrixBenchmarks()
+{
+	std::mt19937 generator(99);
+	std::uniform_real_distribution<float> position(-100, 100);
+	std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+	std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+	std::vector<Matrix4x4f> worlds(NumMatrices), inverses(NumMatrices), results(NumMatrices), expected(NumMatrices);
+	for (Matrix4x4f& m : worlds)
+	{
+		m = Matrix4x4f({ position(generator), position(generator), position(generator) },
+		               { angle(generator), angle(generator), angle(generator) },
+		               { scale(generator), scale(generator), scale(generator) });
+	}
+
+	//--- Validation ---
+	bool passed = true;
+	const Matrix4x4f identity = MatrixIdentity();
+	Vector3f p(1, 2, 3), r(0.3f, -1.2f, 2.0f), s(0.5f, 2, 1.5f);
+
+	Matrix4x4f composed = MatrixScale(s) * MatrixRotationZ(r.z) * MatrixRotationX(r.x) * MatrixRotationY(r.y) * MatrixTranslation(p);
+	passed &= Check("constructor = scale * rotZ * rotX * rotY * translation", MaxError(Matrix4x4f(p, r, s), composed) < 1e-5f);
+
+	float generalError = 0, affineError = 0;
+	for (const Matrix4x4f& m : worlds)
+	{
+		generalError = std::max(generalError, MaxError(m * Inverse(m), identity));
+		affineError = std::max(affineError, MaxError(InverseAffine(m), Inverse(m)));
+	}
+	passed &= Check("Inverse(m) * m = identity", generalError < 1e-4f);
+	passed &= Check("InverseAffine matches Inverse", affineError < 1e-4f);
+
+	Matrix4x4f world = worlds[0];
+	Vector3f point = world.TransformPoint(p);
+	passed &= Check("TransformPoint round trip", (InverseAffine(world).TransformPoint(point) - p).Length() < 1e-3f);
+	passed &= Check("TransformVector ignores translation", (MatrixTranslation(p).TransformVector(s) - s).Length() == 0);
+	passed &= Check("Transpose twice is unchanged", MaxError(Transpose(Transpose(world)), world) == 0);
+
+	MultiplyBatch(worlds.data(), world, expected.data(), NumMatrices);
+	for (SIMDLevel level : { SIMDLevel::SSE2, SIMDLevel::AVX2 })
+	{
+		if (!IsSIMDLevelSupported(level))
+			continue;
+
+		GetMatrixKernels(level).multiplyBatch(worlds.data(), world, results.data(), NumMatrices);
+		float error = 0;
+		for (std::size_t i = 0; i < NumMatrices; ++i)
+			error = std::max(error, MaxError(results[i], expected[i]));
+
+		char label[64];
+		std::snprintf(label, sizeof(label), "multiplyBatch (%s) matches MultiplyBatch", SIMDLevelName(level));
+		passed &= Check(label, error < 1e-2f); // Large translations, so absolute error is relative to ~100
+	}
+
+	//--- Timing ---
+	double seconds = TimeBest([&]() { for (std::size_t i = 0; i < NumMatrices; ++i) inverses[i] = Inverse(worlds[i]); DoNotOptimise(inverses); });
+	Report("Inverse (general)", seconds, NumMatrices, "matrix");
+
+	seconds = TimeBest([&]() { for (std::size_t i = 0; i < NumMatrices; ++i) inverses[i] = InverseAffine(worlds[i]); DoNotOptimise(inverses); });
+	Report("InverseAffine", seconds, NumMatrices, "matrix");
+
+	const MatrixKernels& kernels = GetMatrixKernels();
+	seconds = TimeBest([&]() { for (std::size_t i = 0; i < NumMatrices; ++i) kernels.inverse(worlds[i], inverses[i]); DoNotOptimise(inverses); });
+	Report("Inverse (SIMD kernel, general)", seconds, NumMatrices, "matrix");
+
+	seconds = TimeBest([&]() { for (std::size_t i = 0; i < NumMatrices; ++i) results[i] = worlds[i] * world; DoNotOptimise(results); });
+	Report("operator* loop", seconds, NumMatrices, "matrix");
+
+	seconds = TimeBest([&]() { MultiplyBatch(worlds.data(), world, results.data(), NumMatrices); DoNotOptimise(results); });
+	Report("MultiplyBatch", seconds, NumMatrices, "matrix");
+
+	seconds = TimeBest([&]() { kernels.multiplyBatch(worlds.data(), world, results.data(), NumMatrices); DoNotOptimise(results); });
+	Report("multiplyBatch (SIMD kernel)", seconds, NumMatrices, "matrix");
+
+	return passed;
+}
@@ -0,0 +1,326 @@
+//=========================================================================================================
+// MemoryBenchmark.cpp: Arenas and Pools against the Global Allocator
+// - Checks: arena alignment and reuse after Reset, a large frame growing into one block, pools handing
+//   freed slots out again, node containers on a PoolAllocator, a world giving exactly the same bodies
+//   with and without its arenas, and steady steps asking the system for nothing
+// - Timing compares small allocations from an arena, a pool and new/delete, on one thread and from jobs
+//   on every thread, then world steps taking their temporaries from the arenas and from the global allocator
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "Arena.h"
+#include "Pool.h"
+#include "JobSystem.h"
+#include "ParallelFor.h"
+#include "PhysicsWorld.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	const float StepTime = 1.0f / 60;
+
+	// 1, 2, 4 ... up to at least the hardware thread count
+	std::vector<unsigned int> ThreadCounts()
+	{
+		std::vector<unsigned int> counts;
+		for (unsigned int threads = 1; threads < std::max(4u, HardwareThreadCount()) * 2; threads *= 2)
+			counts.push_back(threads);
+		return counts;
+	}
+
+	// Stand-in for a small per-step object, e.g. a contact
+	struct Small
+	{
+		float values[8];
+	};
+
+	bool IsAligned(const void* p, std::size_t alignment)
+	{
+		return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+	}
+
+	bool ArenaReuse()
+	{
+		Arena arena(4096);
+		bool passed = true;
+		void* first = nullptr;
+		std::size_t systemAllocations = 0;
+		for (int frame = 0; frame < 3; ++frame)
+		{
+			arena.Reset();
+			for (std::size_t k = 0; k < 100; ++k)
+			{
+				const std::size_t alignment = std::size_t(1) << (k % 7);
+				void* p = arena.Allocate(1 + k % 13, alignment);
+				passed &= IsAligned(p, alignment);
+				if (k == 0 && frame == 0)
+					first = p;
+				else if (k == 0)
+					passed &= p == first;
+			}
+			passed &= arena.Stats().allocations == 100;
+			if (frame == 0)
+				systemAllocations = arena.Stats().systemAllocations;
+		}
+		return passed && arena.Stats().systemAllocations == systemAllocations;
+	}
+
+	// A frame much larger than a block needs several, after Reset one block holds it all
+	bool ArenaGrows()
+	{
+		Arena arena(4096);
+		auto frame = [&]
+		{
+			for (int k = 0; k < 1000; ++k)
+				arena.Allocate<Small>(4);
+		};
+		frame();
+		const MemoryStats grown = arena.Stats();
+		arena.Reset();
+		const MemoryStats reset = arena.Stats();
+		frame();
+		const MemoryStats again = arena.Stats();
+		return grown.systemAllocations > 1 && grown.bytesInUse >= 1000 * 4 * sizeof(Small) && reset.bytesInUse == 0 &&
+		       reset.capacity >= grown.bytesInUse && again.systemAllocations == reset.systemAllocations &&
+		       again.peakBytes == grown.bytesInUse;
+	}
+
+	bool PoolReuse()
+	{
+		Pool<Small> pool(64);
+		std::vector<Small*> objects;
+		for (int k = 0; k < 1000; ++k)
+			objects.push_back(pool.Create());
+		const MemoryStats full = pool.Stats();
+		for (Small* object : objects)
+			pool.Destroy(object);
+		const MemoryStats empty = pool.Stats();
+		for (int k = 0; k < 1000; ++k)
+			objects[k] = pool.Create();
+		std::sort(objects.begin(), objects.end());
+		const bool distinct = std::adjacent_find(objects.begin(), objects.end()) == objects.end();
+		const MemoryStats again = pool.Stats();
+		for (Small* object : objects)
+			pool.Destroy(object);
+		return full.allocations == 1000 && empty.allocations == 0 && again.systemAllocations == full.systemAllocations &&
+		       again.peakBytes == full.bytesInUse && distinct;
+	}
+
+	bool PoolContainers()
+	{
+		PoolResource resource;
+		bool passed = true;
+		{
+			std::list<int, PoolAllocator<int>> list{ PoolAllocator<int>(resource) };
+			std::map<int, int, std::less<int>, PoolAllocator<std::pair<const int, int>>> map{ PoolAllocator<std::pair<const int, int>>(resource) };
+			for (int k = 0; k < 1000; ++k)
+			{
+				list.push_back(k);
+				map[k * 7 % 1000] = k;
+			}
+			list.remove_if([](int k) { return k % 2 == 0; });
+			for (int k = 0; k < 1000; k += 3)
+				map.erase(k);
+
+			int expected = 1;
+			for (int value : list)
+			{
+				passed &= value == expected;
+				expected += 2;
+			}
+			passed &= list.size() == 500 && map.size() == 666 && resource.Stats().allocations == 500 + 666;
+		}
+		return passed && resource.Stats().allocations == 0;
+	}
+
+	// Boxes dropped onto a floor and each other in piles, so there are plenty of contacts and islands
+	std::unique_ptr<PhysicsWorld> BoxWorld(int size, int layers, bool useArenas, unsigned int threads)
+	{
+		static const Shape ground = ShapeBox({ 200, 0.5f, 200 });
+		static const Shape box = ShapeBox({ 0.5f, 0.5f, 0.5f });
+		PhysicsSettings settings;
+		settings.threadCount = threads;
+		settings.broadphase = BroadphaseType::SweepAndPrune;
+		settings.allowSleeping = false;
+		settings.useArenas = useArenas;
+		auto world = std::make_unique<PhysicsWorld>(settings);
+
+		BodyDesc desc;
+		desc.position = { 0, -0.5f, 0 };
+		desc.inverseMass = 0;
+		desc.shape = &ground;
+		world->CreateBody(desc);
+		desc.inverseMass = 1;
+		desc.inverseInertia = { 6, 6, 6 };
+		desc.shape = &box;
+		for (int x = 0; x < size; ++x)
+			for (int z = 0; z < size; ++z)
+				for (int y = 0; y < layers; ++y)
+				{
+					desc.position = { x * 1.5f - size * 0.75f + 0.1f * y, 0.6f + y * 1.2f, z * 1.5f - size * 0.75f };
+					world->CreateBody(desc);
+				}
+		return world;
+	}
+
+	bool SameWithoutArenas()
+	{
+		std::unique_ptr<PhysicsWorld> arenas = BoxWorld(16, 3, true, 0);
+		std::unique_ptr<PhysicsWorld> global = BoxWorld(16, 3, false, 0);
+		for (int step = 0; step < 60; ++step)
+		{
+			arenas->Step(StepTime);
+			global->Step(StepTime);
+		}
+
+		const RigidBodies& a = arenas->Bodies();
+		const RigidBodies& b = global->Bodies();
+		bool same = a.Size() == b.Size() && arenas->Contacts().Size() == global->Contacts().Size();
+		for (std::size_t i = 0; i < a.Size() && same; ++i)
+		{
+			const Vector3f p = a.positions.Get(i), q = b.positions.Get(i);
+			same &= p.x == q.x && p.y == q.y && p.z == q.z;
+		}
+		return same && arenas->FrameArena().Stats().allocations > 0 && global->FrameArena().Stats().allocations == 0;
+	}
+
+	// Once the arenas have grown to fit a step, further steps of the same scene need no new blocks
+	bool SteadyStepsNoSystemAllocations()
+	{
+		std::unique_ptr<PhysicsWorld> world = BoxWorld(16, 3, true, 0);
+		for (int step = 0; step < 30; ++step)
+			world->Step(StepTime);
+		const std::size_t before = world->FrameArena().Stats().systemAllocations + world->ScratchArenas().Stats().systemAllocations;
+		for (int step = 0; step < 30; ++step)
+			world->Step(StepTime);
+		const std::size_t after = world->FrameArena().Stats().systemAllocations + world->ScratchArenas().Stats().systemAllocations;
+		return before == after;
+	}
+}
+
+bool RunMemoryBenchmarks()
+{
+	bool passed = true;
+
+	passed &= Check("arena aligns and reuses its block", ArenaReuse());
+	passed &= Check("large frame grows into one block", ArenaGrows());
+	passed &= Check("pool hands freed slots out again", PoolReuse());
+	passed &= Check("list and map on a PoolAllocator", PoolContainers());
+	passed &= Check("world same with and without arenas", SameWithoutArenas());
+	passed &= Check("steady steps ask the system for nothing", SteadyStepsNoSystemAllocations());
+
+	// Allocating a frame's worth of small objects then freeing them all
+	{
+		const std::size_t count = 100000;
+		std::vector<Small*> objects(count);
+
+		const double globalSeconds = TimeBest([&]
+		{
+			for (std::size_t k = 0; k < count; ++k)
+				objects[k] = new Small();
+			DoNotOptimise(objects[count - 1]);
+			for (Small* object : objects)
+				delete object;
+		});
+		Report("100k small objects, new/delete", globalSeconds, count, "object");
+
+		Arena arena;
+		const double arenaSeconds = TimeBest([&]
+		{
+			arena.Reset();
+			for (std::size_t k = 0; k < count; ++k)
+				objects[k] = new (arena.Allocate<Small>()) Small();
+			DoNotOptimise(objects[count - 1]);
+		});
+		Report("100k small objects, arena", arenaSeconds, count, "object");
+
+		Pool<Small> pool(4096);
+		const double poolSeconds = TimeBest([&]
+		{
+			for (std::size_t k = 0; k < count; ++k)
+				objects[k] = pool.Create();
+			DoNotOptimise(objects[count - 1]);
+			for (Small* object : objects)
+				pool.Destroy(object);
+		});
+		Report("100k small objects, pool", poolSeconds, count, "object");
+	}
+
+	// The same from jobs on every thread at once, each job allocating its own objects
+	{
+		const std::size_t count = 1000000;
+		const std::size_t grain = 1024;
+		for (unsigned int threadCount : ThreadCounts())
+		{
+			JobSystem jobs(threadCount);
+			ThreadArenas scratch(jobs.ThreadCount());
+			auto allocate = [&](bool useArena)
+			{
+				return TimeBest([&]
+				{
+					scratch.Reset();
+					jobs.ParallelFor(count, grain, [&](std::size_t begin, std::size_t end)
+					{
+						ArenaAllocator<Small> allocator(useArena ? &scratch[jobs.ThreadIndex()] : nullptr);
+						Small* objects[grain];
+						for (std::size_t k = begin; k < end; ++k)
+						{
+							objects[k - begin] = new (allocator.allocate(1)) Small();
+							DoNotOptimise(objects[k - begin]);
+						}
+						for (std::size_t k = begin; k < end; ++k)
+							allocator.deallocate(objects[k - begin], 1);
+					});
+				});
+			};
+			const double globalSeconds = allocate(false);
+			const double arenaSeconds = allocate(true);
+
+			char label[64];
+			std::snprintf(label, sizeof(label), "1M objects from jobs, global, %u thread%s", threadCount, threadCount == 1 ? "" : "s");
+			Report(label, globalSeconds, count, "object");
+			std::snprintf(label, sizeof(label), "1M objects from jobs, arenas, %u thread%s", threadCount, threadCount == 1 ? "" : "s");
+			Report(label, arenaSeconds, count, "object");
+		}
+	}
+
+	// World steps, the step's temporaries from the global allocator against the world's arenas
+	{
+		const int steps = 20;
+		for (unsigned int threadCount : ThreadCounts())
+		{
+			double seconds[2];
+			std::size_t frameBytes = 0, scratchBytes = 0;
+			for (int useArenas = 0; useArenas < 2; ++useArenas)
+			{
+				std::unique_ptr<PhysicsWorld> world = BoxWorld(40, 4, useArenas != 0, threadCount);
+				for (int step = 0; step < 30; ++step)
+					world->Step(StepTime); // Settle into resting contact
+				seconds[useArenas] = TimeBest([&]
+				{
+					for (int step = 0; step < steps; ++step)
+						world->Step(StepTime);
+				}, 3);
+				frameBytes = world->FrameArena().Stats().peakBytes;
+				scratchBytes = world->ScratchArenas().Stats().peakBytes;
+			}
+
+			char label[64];
+			std::snprintf(label, sizeof(label), "6400 boxes step, global, %u thread%s", threadCount, threadCount == 1 ? "" : "s");
+			Report(label, seconds[0] / steps, 1, "step");
+			std::snprintf(label, sizeof(label), "6400 boxes step, arenas, %u thread%s", threadCount, threadCount == 1 ? "" : "s");
+			Report(label, seconds[1] / steps, 1, "step");
+			if (threadCount == 1)
+				std::printf("  step temporaries: %zu KB frame arena, %zu KB scratch arenas\n", frameBytes / 1024, scratchBytes / 1024);
+		}
+	}
+
+	return passed;
+}
@@ -0,0 +1,297 @@
+//=========================================================================================================
+// NarrowphaseBenchmark.cpp: Convex Contact Generation (GJK / EPA)
+// - Results are checked against exact answers for spheres, capsules and axis aligned boxes, and boxes
+//   are checked against convex hulls of their corners
+// - Timing runs pairs of mixed shapes resting against each other and turning slowly over many steps,
+//   the usual case for contacts. Each pair is tested every step starting from nothing, then again
+//   starting from the simplex cached from the step before
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "GJK.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	const std::size_t PairCount = 1000;
+	const int StepCount = 50;
+
+	bool Near(float a, float b, float tolerance = 1e-3f)
+	{
+		return std::abs(a - b) <= tolerance;
+	}
+
+	bool Near(const Vector3f& a, const Vector3f& b, float tolerance = 1e-3f)
+	{
+		return (a - b).Length() <= tolerance;
+	}
+
+	Quaternionf RandomRotation(RandomGenerator& generator)
+	{
+		return QuaternionAxisAngle(generator.NextOnUnitSphere(), generator.NextFloat(0, 6.283f));
+	}
+
+	// Closest distance between segments p1-q1 and p2-q2 by nested ternary search (the distance is convex
+	// in both segment parameters) - slow but simple enough to trust
+	float SegmentDistance(const Vector3f& p1, const Vector3f& q1, const Vector3f& p2, const Vector3f& q2)
+	{
+		auto distanceTo = [&](const Vector3f& p)
+		{
+			float lo = 0, hi = 1;
+			for (int i = 0; i < 60; ++i)
+			{
+				const float m1 = lo + (hi - lo) / 3, m2 = hi - (hi - lo) / 3;
+				if (Distance(p, p2 + (q2 - p2) * m1) < Distance(p, p2 + (q2 - p2) * m2)) hi = m2; else lo = m1;
+			}
+			return Distance(p, p2 + (q2 - p2) * lo);
+		};
+		float lo = 0, hi = 1;
+		for (int i = 0; i < 60; ++i)
+		{
+			const float m1 = lo + (hi - lo) / 3, m2 = hi - (hi - lo) / 3;
+			if (distanceTo(p1 + (q1 - p1) * m1) < distanceTo(p1 + (q1 - p1) * m2)) hi = m2; else lo = m1;
+		}
+		return distanceTo(p1 + (q1 - p1) * lo);
+	}
+
+	std::vector<Vector3f> BoxCorners(const Vector3f& halfExtents)
+	{
+		std::vector<Vector3f> corners;
+		for (int i = 0; i < 8; ++i)
+			corners.push_back({ (i & 1) ? halfExtents.x : -halfExtents.x, (i & 2) ? halfExtents.y : -halfExtents.y, (i & 4) ? halfExtents.z : -halfExtents.z });
+		return corners;
+	}
+
+	// Random points on a squashed sphere, a rounded rock-like hull
+	std::vector<Vector3f> RockPoints(RandomGenerator& generator, int count)
+	{
+		std::vector<Vector3f> points(count);
+		for (Vector3f& point : points)
+		{
+			const Vector3f p = generator.NextOnUnitSphere();
+			point = { p.x * 0.6f, p.y * 0.4f, p.z * 0.5f };
+		}
+		return points;
+	}
+
+	bool CheckExactResults(RandomGenerator& generator)
+	{
+		bool passed = true;
+		Contact contact;
+
+		// Sphere - sphere, apart and overlapping
+		bool spheresOK = true;
+		for (int i = 0; i < 200; ++i)
+		{
+			const float ra = generator.NextFloat(0.2f, 1), rb = generator.NextFloat(0.2f, 1);
+			const Vector3f pa = generator.NextVector3({ -2, -2, -2 }, { 2, 2, 2 });
+			const Vector3f pb = generator.NextVector3({ -2, -2, -2 }, { 2, 2, 2 });
+			const float depth = ra + rb - Distance(pa, pb);
+			const bool hit = CollideConvex(ShapeSphere(ra), Transformf(pa), ShapeSphere(rb), Transformf(pb), contact);
+			spheresOK &= hit == (depth >= 0);
+			if (hit)
+				spheresOK &= Near(contact.points[0].depth, depth) && Near(contact.normal, Normalise(pb - pa));
+		}
+		passed &= Check("sphere - sphere exact", spheresOK);
+
+		// Sphere - rotated box, centre outside (GJK) and inside (EPA)
+		bool sphereBoxOK = true;
+		for (int i = 0; i < 200; ++i)
+		{
+			const Vector3f halfExtents = generator.NextVector3({ 0.3f, 0.3f, 0.3f }, { 1, 1, 1 });
+			const Transformf boxTransform(generator.NextVector3({ -1, -1, -1 }, { 1, 1, 1 }), RandomRotation(generator));
+			const Vector3f local = i % 2 == 1 ? generator.NextVector3(-halfExtents * 0.9f, halfExtents * 0.9f)
+			                                  : generator.NextVector3(-halfExtents * 2.0f, halfExtents * 2.0f);
+			const Vector3f clamped = { std::clamp(local.x, -halfExtents.x, halfExtents.x), std::clamp(local.y, -halfExtents.y, halfExtents.y),
+			                           std::clamp(local.z, -halfExtents.z, halfExtents.z) };
+			const bool inside = local.x == clamped.x && local.y == clamped.y && local.z == clamped.z;
+			const float radius = 0.3f;
+
+			float depth;
+			if (inside)
+			{
+				const Vector3f gap = halfExtents - Vector3f(std::abs(local.x), std::abs(local.y), std::abs(local.z));
+				depth = radius + std::min({ gap.x, gap.y, gap.z });
+			}
+			else
+			{
+				depth = radius - Distance(local, clamped);
+			}
+
+			const bool hit = CollideConvex(ShapeBox(halfExtents), boxTransform, ShapeSphere(radius), Transformf(boxTransform.TransformPoint(local)), contact);
+			sphereBoxOK &= hit == (depth >= 0);
+			if (hit)
+				sphereBoxOK &= Near(contact.points[0].depth, depth);
+		}
+		passed &= Check("sphere - box exact (outside and inside)", sphereBoxOK);
+
+		// Capsule - capsule apart, distance between the segments
+		bool capsulesOK = true;
+		for (int i = 0; i < 100; ++i)
+		{
+			const Transformf ta(generator.NextVector3({ -2, -2, -2 }, { 2, 2, 2 }), RandomRotation(generator));
+			const Transformf tb(generator.NextVector3({ -2, -2, -2 }, { 2, 2, 2 }), RandomRotation(generator));
+			const Shape a = ShapeCapsule(0.1f, 0.8f), b = ShapeCapsule(0.1f, 0.5f);
+			const float expected = SegmentDistance(ta.TransformPoint({ 0, -0.8f, 0 }), ta.TransformPoint({ 0, 0.8f, 0 }),
+			                                       tb.TransformPoint({ 0, -0.5f, 0 }), tb.TransformPoint({ 0, 0.5f, 0 }));
+			const GJKResult result = GJKDistance(a, ta, b, tb);
+			capsulesOK &= expected < 1e-3f || (!result.overlap && Near(result.distance, expected));
+		}
+		passed &= Check("capsule - capsule distance exact", capsulesOK);
+
+		// Axis aligned boxes overlapping: depth is the smallest overlap on any axis
+		bool boxesOK = true;
+		for (int i = 0; i < 200; ++i)
+		{
+			const Vector3f ha = generator.NextVector3({ 0.3f, 0.3f, 0.3f }, { 1, 1, 1 });
+			const Vector3f hb = generator.NextVector3({ 0.3f, 0.3f, 0.3f }, { 1, 1, 1 });
+			const Vector3f offset = generator.NextVector3(-(ha + hb) * 0.95f, (ha + hb) * 0.95f);
+			const Vector3f overlap = ha + hb - Vector3f(std::abs(offset.x), std::abs(offset.y), std::abs(offset.z));
+			const bool hit = CollideConvex(ShapeBox(ha), Transformf({ 0, 0, 0 }), ShapeBox(hb), Transformf(offset), contact);
+			boxesOK &= hit && Near(contact.points[0].depth, std::min({ overlap.x, overlap.y, overlap.z }));
+		}
+		passed &= Check("box - box overlap exact", boxesOK);
+
+		// Rotated boxes give the same contact as hulls of their corners
+		bool hullsOK = true;
+		for (int i = 0; i < 200; ++i)
+		{
+			const Vector3f ha = generator.NextVector3({ 0.3f, 0.3f, 0.3f }, { 1, 1, 1 });
+			const Vector3f hb = generator.NextVector3({ 0.3f, 0.3f, 0.3f }, { 1, 1, 1 });
+			const std::vector<Vector3f> cornersA = BoxCorners(ha), cornersB = BoxCorners(hb);
+			const Transformf ta(generator.NextVector3({ -1, -1, -1 }, { 1, 1, 1 }), RandomRotation(generator));
+			const Transformf tb(generator.NextVector3({ -1, -1, -1 }, { 1, 1, 1 }), RandomRotation(generator));
+
+			Contact boxContact, hullContact;
+			const bool boxHit = CollideConvex(ShapeBox(ha), ta, ShapeBox(hb), tb, boxContact);
+			const bool hullHit = CollideConvex(ShapeConvexHull(cornersA.data(), 8), ta, ShapeConvexHull(cornersB.data(), 8), tb, hullContact);
+			hullsOK &= boxHit == hullHit;
+			if (boxHit && hullHit)
+				hullsOK &= Near(boxContact.points[0].depth, hullContact.points[0].depth);
+		}
+		passed &= Check("box - box matches hull - hull", hullsOK);
+
+		return passed;
+	}
+
+	struct ShapePair
+	{
+		Shape a;
+		Shape b;
+		Vector3f position;     // Of A
+		Vector3f direction;    // From A to B
+		float gap;             // Between the surfaces, negative for overlapping
+		Vector3f spinAxis;     // B turns about this
+	};
+}
+
+bool RunNarrowphaseBenchmarks()
+{
+	bool passed = true;
+	RandomGenerator generator(12);
+
+	passed &= CheckExactResults(generator);
+
+	// Mixed pairs touching or nearly touching, as if resting on each other
+	const std::vector<Vector3f> rock = RockPoints(generator, 24);
+	const Shape shapes[] = { ShapeBox({ 0.5f, 0.3f, 0.4f }), ShapeConvexHull(rock.data(), static_cast<uint32_t>(rock.size())),
+	                         ShapeCapsule(0.25f, 0.4f), ShapeSphere(0.4f) };
+	const Shape pairShapes[][2] = { { shapes[0], shapes[0] }, { shapes[1], shapes[1] }, { shapes[2], shapes[0] }, { shapes[3], shapes[1] },
+	                                { shapes[1], shapes[0] } };
+	std::vector<ShapePair> pairs(PairCount);
+	for (std::size_t i = 0; i < PairCount; ++i)
+	{
+		ShapePair& pair = pairs[i];
+		pair.a = pairShapes[i % std::size(pairShapes)][0];
+		pair.b = pairShapes[i % std::size(pairShapes)][1];
+		pair.position = generator.NextVector3({ -50, -50, -50 }, { 50, 50, 50 });
+		pair.direction = generator.NextOnUnitSphere();
+		pair.gap = generator.NextFloat(-0.01f, 0.03f);
+		pair.spinAxis = generator.NextOnUnitSphere();
+	}
+
+	// Transforms for every step, B turning about 1 degree per step. B's distance along the pair's direction
+	// is searched for each step so the gap stays the same as it turns
+	std::vector<Transformf> transformsA(PairCount * StepCount), transformsB(PairCount * StepCount);
+	for (std::size_t i = 0; i < PairCount; ++i)
+	{
+		const ShapePair& pair = pairs[i];
+		float distance = 1;
+		float range = 1;
+		for (int step = 0; step < StepCount; ++step)
+		{
+			const Transformf transformA(pair.position);
+			Transformf transformB(pair.position, QuaternionAxisAngle(pair.spinAxis, 0.0175f * step));
+			float lo = distance - range, hi = distance + range;
+			for (int bisect = 0; bisect < 16; ++bisect)
+			{
+				distance = (lo + hi) * 0.5f;
+				transformB.position = pair.position + pair.direction * distance;
+				Contact contact;
+				CollideConvex(pair.a, transformA, pair.b, transformB, contact, nullptr, 10);
+				(-contact.points[0].depth < pair.gap ? lo : hi) = distance;
+			}
+			range = 0.05f;
+
+			transformsA[step * PairCount + i] = transformA;
+			transformsB[step * PairCount + i] = transformB;
+		}
+	}
+
+	// Contacts found over all the steps, each pair starting from nothing or from its cached simplex
+	std::vector<GJKCache> caches(PairCount);
+	auto runSteps = [&](bool useCache)
+	{
+		std::fill(caches.begin(), caches.end(), GJKCache());
+		int contactCount = 0;
+		Contact contact;
+		for (int step = 0; step < StepCount; ++step)
+		{
+			for (std::size_t i = 0; i < PairCount; ++i)
+			{
+				const std::size_t t = step * PairCount + i;
+				contactCount += CollideConvex(pairs[i].a, transformsA[t], pairs[i].b, transformsB[t], contact, useCache ? &caches[i] : nullptr, 0.05f);
+				DoNotOptimise(contact);
+			}
+		}
+		return contactCount;
+	};
+
+	// Average GJK iterations for the same steps
+	auto averageIterations = [&](bool useCache)
+	{
+		std::fill(caches.begin(), caches.end(), GJKCache());
+		long long iterations = 0;
+		for (int step = 0; step < StepCount; ++step)
+		{
+			for (std::size_t i = 0; i < PairCount; ++i)
+			{
+				const std::size_t t = step * PairCount + i;
+				iterations += GJKDistance(pairs[i].a, transformsA[t], pairs[i].b, transformsB[t], useCache ? &caches[i] : nullptr).iterations;
+			}
+		}
+		return static_cast<double>(iterations) / (PairCount * StepCount);
+	};
+
+	int coldContacts = 0, warmContacts = 0;
+	const double coldSeconds = TimeBest([&]() { coldContacts = runSteps(false); }, 3);
+	const double warmSeconds = TimeBest([&]() { warmContacts = runSteps(true); }, 3);
+	const double coldIterations = averageIterations(false);
+	const double warmIterations = averageIterations(true);
+
+	char label[64];
+	std::snprintf(label, sizeof(label), "pair test, no cache (%.2f GJK iterations)", coldIterations);
+	Report(label, coldSeconds, PairCount * StepCount, "test");
+	std::snprintf(label, sizeof(label), "pair test, cached (%.2f GJK iterations)", warmIterations);
+	Report(label, warmSeconds, PairCount * StepCount, "test");
+
+	passed &= Check("cache gives the same contacts", coldContacts == warmContacts && coldContacts > 0);
+	passed &= Check("cache reduces GJK iterations", warmIterations < coldIterations);
+
+	return passed;
+}
@@ -0,0 +1,180 @@
+//=========================================================================================================
+// PhysicsWorldBenchmark.cpp: Rigid Body Storage and Integration
+// - Integrates 1M bodies with the SIMD and scalar integrators over the SoA arrays, and with the same
+//   calculation over an array of body structs (AoS) for comparison
+// - Checks the SIMD integrator against the scalar one, free fall against the exact answer, and that
+//   body handles survive other bodies being removed
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "PhysicsWorld.h"
+#include "Integrator.h"
+#include "Random.h"
+
+#include <vector>
+
+namespace
+{
+	const std::size_t NumBodies = 1 << 20;
+	const float TimeStep = 1.0f / 60.0f;
+
+	// Array of structures layout - everything about one body together
+	struct BodyAoS
+	{
+		Vector3f position;
+		Quaternionf orientation;
+		Vector3f linearVelocity;
+		Vector3f angularVelocity;
+		float inverseMass;
+		Vector3f inverseInertia;
+		Vector3f force;
+		Vector3f torque;
+	};
+
+	// Same calculation as IntegrateScalar
+	BENCHMARK_NOINLINE void IntegrateAoS(std::vector<BodyAoS>& bodies, const Vector3f& gravity, float timeStep)
+	{
+		for (BodyAoS& b : bodies)
+		{
+			if (b.inverseMass > 0)
+			{
+				b.linearVelocity += (gravity + b.force * b.inverseMass) * timeStep;
+				Vector3f localTorque = Rotate(Conjugate(b.orientation), b.torque);
+				Vector3f local = { localTorque.x * b.inverseInertia.x, localTorque.y * b.inverseInertia.y, localTorque.z * b.inverseInertia.z };
+				b.angularVelocity += Rotate(b.orientation, local) * timeStep;
+			}
+			b.position += b.linearVelocity * timeStep;
+
+			Quaternionf spin = Quaternionf(b.angularVelocity, 0) * b.orientation;
+			const float h = 0.5f * timeStep;
+			b.orientation = Normalise(Quaternionf{ b.orientation.x + spin.x * h, b.orientation.y + spin.y * h, b.orientation.z + spin.z * h, b.orientation.w + spin.w * h });
+			b.force = { 0, 0, 0 };
+			b.torque = { 0, 0, 0 };
+		}
+	}
+
+	BodyDesc RandomBody(RandomGenerator& generator)
+	{
+		BodyDesc desc;
+		desc.position = generator.NextVector3({ -100, 0, -100 }, { 100, 100, 100 });
+		desc.orientation = QuaternionAxisAngle(generator.NextOnUnitSphere(), generator.NextFloat(0, 6.28f));
+		desc.linearVelocity = generator.NextVector3({ -5, -5, -5 }, { 5, 5, 5 });
+		desc.angularVelocity = generator.NextVector3({ -3, -3, -3 }, { 3, 3, 3 });
+		desc.inverseMass = generator.NextInt(0, 9) == 0 ? 0 : generator.NextFloat(0.1f, 2); // 10% static
+		desc.inverseInertia = generator.NextVector3({ 0.5f, 0.5f, 0.5f }, { 2, 2, 2 });
+		return desc;
+	}
+
+	// Forces and torques are cleared each step, so add some before each validation step
+	void AddRandomForces(RigidBodies& bodies, RandomGenerator& generator)
+	{
+		for (std::size_t i = 0; i < bodies.Size(); ++i)
+		{
+			bodies.forces.Set(i, generator.NextVector3({ -10, -10, -10 }, { 10, 10, 10 }));
+			bodies.torques.Set(i, generator.NextVector3({ -10, -10, -10 }, { 10, 10, 10 }));
+		}
+	}
+}
+
+bool RunPhysicsWorldBenchmarks()
+{
+	RandomGenerator generator(8);
+	const Vector3f gravity = PhysicsSettings().gravity;
+
+	//--- Validation ---
+	bool passed = true;
+
+	// SIMD against scalar, odd size to include the scalar tail
+	RigidBodies simd;
+	for (int i = 0; i < 1001; ++i)
+		simd.Add(RandomBody(generator));
+	RigidBodies scalar = simd;
+
+	float positionError = 0, orientationError = 0, velocityError = 0;
+	for (int step = 0; step < 60; ++step)
+	{
+		RandomGenerator forces(step);
+		AddRandomForces(simd, forces);
+		forces.Seed(step);
+		AddRandomForces(scalar, forces);
+
+		Integrate(simd, gravity, TimeStep);
+		IntegrateScalar(scalar, gravity, TimeStep);
+	}
+	for (std::size_t i = 0; i < simd.Size(); ++i)
+	{
+		positionError = std::max(positionError, (simd.positions.Get(i) - scalar.positions.Get(i)).Length());
+		orientationError = std::max(orientationError, 1 - std::abs(Dot(simd.Orientation(i), scalar.Orientation(i))));
+		velocityError = std::max(velocityError, (simd.angularVelocities.Get(i) - scalar.angularVelocities.Get(i)).Length());
+	}
+	passed &= Check("Integrate matches IntegrateScalar", positionError < 1e-3f && orientationError < 1e-5f && velocityError < 1e-3f);
+
+	// Semi-implicit Euler free fall: v = g * n * dt, y = y0 + g * dt^2 * n(n+1)/2
+	PhysicsWorld world;
+	BodyHandle falling = world.CreateBody({});
+	BodyDesc staticDesc;
+	staticDesc.position = { 5, 0, 0 };
+	staticDesc.inverseMass = 0;
+	BodyHandle fixed = world.CreateBody(staticDesc);
+	const int steps = 120;
+	for (int step = 0; step < steps; ++step)
+		world.Step(TimeStep);
+	float expectedY = gravity.y * TimeStep * TimeStep * steps * (steps + 1) / 2;
+	passed &= Check("free fall matches exact result", std::abs(world.Position(falling).y - expectedY) < 1e-3f);
+	passed &= Check("static body does not move", (world.Position(fixed) - Vector3f(5, 0, 0)).Length() == 0);
+
+	// Spinning around y for one second at 1 radian / second
+	BodyDesc spinningDesc;
+	spinningDesc.inverseMass = 0;
+	spinningDesc.angularVelocity = { 0, 1, 0 };
+	BodyHandle spinning = world.CreateBody(spinningDesc);
+	for (int step = 0; step < 60; ++step)
+		world.Step(TimeStep);
+	passed &= Check("spin of 1 rad/s for 1 s", 1 - std::abs(Dot(world.Orientation(spinning), QuaternionAxisAngle(Vector3f(0, 1, 0), 1.0f))) < 1e-4f);
+
+	// Handles
+	std::vector<BodyHandle> handles;
+	RigidBodies bodies;
+	for (int i = 0; i < 10; ++i)
+	{
+		BodyDesc desc;
+		desc.position = { float(i), 0, 0 };
+		handles.push_back(bodies.Add(desc));
+	}
+	bodies.Remove(handles[2]);
+	bodies.Remove(handles[7]);
+	bool handlesOK = !bodies.IsValid(handles[2]) && !bodies.IsValid(handles[7]) && bodies.Size() == 8;
+	for (int i = 0; i < 10; ++i)
+	{
+		if (i != 2 && i != 7)
+			handlesOK &= bodies.IsValid(handles[i]) && bodies.positions.Get(bodies.Index(handles[i])).x == i;
+	}
+	BodyHandle reused = bodies.Add({});
+	handlesOK &= reused.slot == handles[7].slot && !bodies.IsValid(handles[7]) && bodies.IsValid(reused);
+	for (std::size_t i = 0; i < bodies.Size(); ++i)
+		handlesOK &= bodies.Index(bodies.Handle(i)) == i;
+	passed &= Check("handles survive removal, stale ones invalid", handlesOK);
+
+	//--- Timing ---
+	RigidBodies large;
+	large.Reserve(NumBodies);
+	std::vector<BodyAoS> largeAoS(NumBodies);
+	for (std::size_t i = 0; i < NumBodies; ++i)
+	{
+		BodyDesc desc = RandomBody(generator);
+		large.Add(desc);
+		largeAoS[i] = { desc.position, desc.orientation, desc.linearVelocity, desc.angularVelocity, desc.inverseMass, desc.inverseInertia, { 0, 0, 0 }, { 0, 0, 0 } };
+	}
+
+	double seconds = TimeBest([&]() { IntegrateAoS(largeAoS, gravity, TimeStep); DoNotOptimise(largeAoS); });
+	Report("integrate 1M (AoS structs, scalar)", seconds, NumBodies, "body");
+
+	seconds = TimeBest([&]() { IntegrateScalar(large, gravity, TimeStep); DoNotOptimise(large); });
+	Report("integrate 1M (SoA, IntegrateScalar)", seconds, NumBodies, "body");
+
+	seconds = TimeBest([&]() { Integrate(large, gravity, TimeStep); DoNotOptimise(large); });
+	Report("integrate 1M (SoA, Integrate SIMD)", seconds, NumBodies, "body");
+
+	return passed;
+}
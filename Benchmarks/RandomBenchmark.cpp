@@ -0,0 +1,129 @@
+//=========================================================================================================
+// RandomBenchmark.cpp: RandomGenerator and Bulk Fills vs rand()
+// - Checks ranges, determinism per seed and the shape of the sphere / disc samples
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "Random.h"
+
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	const std::size_t NumValues = 1 << 20;
+}
+
+bool RunRandomBenchmarks()
+{
+	std::vector<float> floats(NumValues), repeat(NumValues);
+	std::vector<Vector3f> points(NumValues);
+	std::vector<Vector2f> discPoints(NumValues);
+
+	//--- Validation ---
+	bool passed = true;
+
+	RandomGenerator generator(1234);
+	FillUniform(generator, floats.data(), NumValues, -2.0f, 3.0f);
+	RandomGenerator sameSeed(1234);
+	FillUniform(sameSeed, repeat.data(), NumValues, -2.0f, 3.0f);
+	passed &= Check("FillUniform same seed gives same values", floats == repeat);
+
+	FillUniform(generator, repeat.data(), NumValues, -2.0f, 3.0f);
+	passed &= Check("consecutive fills differ", floats != repeat);
+
+	float min = 1e30f, max = -1e30f;
+	double sum = 0;
+	for (float f : floats)
+	{
+		min = std::min(min, f);
+		max = std::max(max, f);
+		sum += f;
+	}
+	passed &= Check("FillUniform in range", min >= -2.0f && max <= 3.0f && max - min > 4.99f);
+	passed &= Check("FillUniform mean", std::abs(sum / NumValues - 0.5) < 0.01);
+
+	// Values that rand() / RAND_MAX could never produce, e.g. anything other than "a"
+	SeedThreadRandom(42);
+	float first = Random(0.0f, 1.0f);
+	bool floatsVary = false;
+	int intMin = 10, intMax = -10;
+	for (int i = 0; i < 10000; ++i)
+	{
+		floatsVary |= Random(0.0f, 1.0f) != first;
+		int r = Random(-3, 3);
+		intMin = std::min(intMin, r);
+		intMax = std::max(intMax, r);
+	}
+	passed &= Check("Random<float> varies", floatsVary);
+	passed &= Check("Random<int> covers a to b inclusive", intMin == -3 && intMax == 3);
+
+	SeedThreadRandom(42);
+	passed &= Check("SeedThreadRandom replays", Random(0.0f, 1.0f) == first);
+
+	RandomGenerator jumped = generator;
+	jumped.Jump();
+	passed &= Check("Jump gives a different sequence", jumped.Next() != generator.Next());
+
+	FillOnUnitSphere(generator, points.data(), NumValues);
+	float lengthError = 0;
+	Vector3f centre(0, 0, 0);
+	for (const Vector3f& p : points)
+	{
+		lengthError = std::max(lengthError, std::abs(p.Length() - 1));
+		centre += p;
+	}
+	passed &= Check("FillOnUnitSphere length 1, centred", lengthError < 1e-5f && (centre / float(NumValues)).Length() < 0.01f);
+
+	FillInUnitSphere(generator, points.data(), NumValues);
+	float maxLength = 0;
+	std::size_t inner = 0;
+	for (const Vector3f& p : points)
+	{
+		maxLength = std::max(maxLength, p.Length());
+		inner += p.Length() < 0.5f;
+	}
+	// An even spread puts 1/8 of the points inside half the radius
+	passed &= Check("FillInUnitSphere inside, even spread", maxLength <= 1 && std::abs(double(inner) / NumValues - 0.125) < 0.005);
+
+	FillInUnitDisc(generator, discPoints.data(), NumValues);
+	maxLength = 0;
+	inner = 0;
+	for (const Vector2f& p : discPoints)
+	{
+		maxLength = std::max(maxLength, p.Length());
+		inner += p.Length() < 0.5f;
+	}
+	passed &= Check("FillInUnitDisc inside, even spread", maxLength <= 1 && std::abs(double(inner) / NumValues - 0.25) < 0.005);
+
+	//--- Timing ---
+	double seconds = TimeBest([&]() { for (float& f : floats) f = -1 + 2 * (static_cast<float>(std::rand()) / RAND_MAX); DoNotOptimise(floats); });
+	Report("rand() float", seconds, NumValues, "value");
+
+	seconds = TimeBest([&]() { for (float& f : floats) f = Random(-1.0f, 1.0f); DoNotOptimise(floats); });
+	Report("Random<float> (ThreadRandom)", seconds, NumValues, "value");
+
+	seconds = TimeBest([&]() { for (float& f : floats) f = generator.NextFloat(-1, 1); DoNotOptimise(floats); });
+	Report("RandomGenerator::NextFloat", seconds, NumValues, "value");
+
+	seconds = TimeBest([&]() { FillUniform(generator, floats.data(), NumValues, -1, 1); DoNotOptimise(floats); });
+	Report("FillUniform (SIMD)", seconds, NumValues, "value");
+
+	seconds = TimeBest([&]() { FillUniform(generator, points.data(), NumValues, { -1, -1, -1 }, { 1, 1, 1 }); DoNotOptimise(points); });
+	Report("FillUniform Vector3f", seconds, NumValues, "vector");
+
+	seconds = TimeBest([&]() { for (Vector3f& p : points) p = generator.NextOnUnitSphere(); DoNotOptimise(points); });
+	Report("NextOnUnitSphere", seconds, NumValues, "vector");
+
+	seconds = TimeBest([&]() { FillOnUnitSphere(generator, points.data(), NumValues); DoNotOptimise(points); });
+	Report("FillOnUnitSphere", seconds, NumValues, "vector");
+
+	seconds = TimeBest([&]() { FillInUnitSphere(generator, points.data(), NumValues); DoNotOptimise(points); });
+	Report("FillInUnitSphere", seconds, NumValues, "vector");
+
+	seconds = TimeBest([&]() { FillInUnitDisc(generator, discPoints.data(), NumValues); DoNotOptimise(discPoints); });
+	Report("FillInUnitDisc", seconds, NumValues, "vector");
+
+	return passed;
+}
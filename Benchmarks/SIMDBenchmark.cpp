@@ -0,0 +1,114 @@
+//=========================================================================================================
+// SIMDBenchmark.cpp: Matrix4x4f / Vector4f Kernels at each SIMD Level
+// - Every supported kernel table is first checked against the scalar kernels on random input
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "MathsSIMD.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	const std::size_t NumMatrices = 1 << 12;
+	const std::size_t NumVectors = 1 << 16;
+
+	// Largest absolute difference between two arrays of floats
+	float MaxError(const float* a, const float* b, std::size_t count)
+	{
+		float error = 0;
+		for (std::size_t i = 0; i < count; ++i)
+			error = std::max(error, std::abs(a[i] - b[i]));
+		return error;
+	}
+
+	Matrix4x4f RandomMatrix(std::mt19937& generator)
+	{
+		std::uniform_real_distribution<float> range(-2, 2);
+		Matrix4x4f m;
+		for (float* e = &m.e00; e <= &m.e33; ++e)
+			*e = range(generator);
+		return m;
+	}
+}
+
+bool RunSIMDBenchmarks()
+{
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> range(-10, 10);
+
+	std::vector<Matrix4x4f> matrices(NumMatrices), results(NumMatrices), expected(NumMatrices);
+	for (Matrix4x4f& m : matrices)
+		m = RandomMatrix(generator);
+
+	std::vector<Vector4f> vectors(NumVectors), transformed(NumVectors), expectedVectors(NumVectors);
+	for (Vector4f& v : vectors)
+		v = { range(generator), range(generator), range(generator), 1 };
+
+	const MatrixKernels& scalar = GetMatrixKernels(SIMDLevel::Scalar);
+	const Matrix4x4f& transform = matrices[0];
+	std::printf("  Detected: %s\n", SIMDLevelName(DetectSIMDLevel()));
+
+	bool passed = true;
+	for (SIMDLevel level : { SIMDLevel::Scalar, SIMDLevel::SSE2, SIMDLevel::AVX2 })
+	{
+		if (!IsSIMDLevelSupported(level))
+		{
+			std::printf("  %s not supported on this CPU - skipped\n", SIMDLevelName(level));
+			continue;
+		}
+		const MatrixKernels& kernels = GetMatrixKernels(level);
+		std::printf("  -- %s --\n", SIMDLevelName(level));
+
+		//--- Validation against the scalar kernels ---
+		float multiplyError = 0, transposeError = 0, inverseError = 0;
+		for (std::size_t i = 0; i + 1 < NumMatrices; ++i)
+		{
+			Matrix4x4f a, b;
+			scalar.multiply(matrices[i], matrices[i + 1], a);
+			kernels.multiply(matrices[i], matrices[i + 1], b);
+			multiplyError = std::max(multiplyError, MaxError(&a.e00, &b.e00, 16));
+
+			scalar.transpose(matrices[i], a);
+			kernels.transpose(matrices[i], b);
+			transposeError = std::max(transposeError, MaxError(&a.e00, &b.e00, 16));
+
+			// Compare M * Inverse(M) with the identity rather than the two inverses directly - random matrices
+			// can be badly conditioned so different (equally valid) rounding can give large element differences
+			if (kernels.inverse(matrices[i], b))
+			{
+				kernels.multiply(matrices[i], b, a);
+				Matrix4x4f identity(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+				float error = MaxError(&a.e00, &identity.e00, 16);
+				if (error < 1) // Skip near-singular matrices
+					inverseError = std::max(inverseError, error);
+			}
+		}
+		scalar.transform(transform, vectors.data(), expectedVectors.data(), NumVectors);
+		kernels.transform(transform, vectors.data(), transformed.data(), NumVectors);
+		float transformError = MaxError(&expectedVectors[0].x, &transformed[0].x, NumVectors * 4);
+
+		std::printf("  max error: multiply %g, transpose %g, inverse %g, transform %g\n", multiplyError, transposeError, inverseError, transformError);
+		passed &= Check("multiply matches scalar", multiplyError < 1e-4f);
+		passed &= Check("transpose matches scalar", transposeError == 0);
+		passed &= Check("inverse gives identity", inverseError < 1e-2f);
+		passed &= Check("transform matches scalar", transformError < 1e-4f);
+
+		//--- Timing ---
+		double seconds = TimeBest([&]() { for (std::size_t i = 0; i + 1 < NumMatrices; ++i) kernels.multiply(matrices[i], matrices[i + 1], results[i]); DoNotOptimise(results); });
+		Report("multiply", seconds, NumMatrices - 1, "matrix");
+
+		seconds = TimeBest([&]() { for (std::size_t i = 0; i < NumMatrices; ++i) kernels.transpose(matrices[i], results[i]); DoNotOptimise(results); });
+		Report("transpose", seconds, NumMatrices, "matrix");
+
+		seconds = TimeBest([&]() { for (std::size_t i = 0; i < NumMatrices; ++i) kernels.inverse(matrices[i], results[i]); DoNotOptimise(results); });
+		Report("inverse", seconds, NumMatrices, "matrix");
+
+		seconds = TimeBest([&]() { kernels.transform(transform, vectors.data(), transformed.data(), NumVectors); DoNotOptimise(transformed); });
+		Report("transform", seconds, NumVectors, "vector");
+	}
+
+	return passed;
+}
@@ -0,0 +1,159 @@
+//=========================================================================================================
+// SleepingBenchmark.cpp: Islands Going to Sleep and Waking Up Together
+// - A resting stack is checked to fall asleep as one island and then not move at all, and to wake as a
+//   whole when a box lands on it, when a body is set moving, or when a body it rests on is destroyed
+// - Timing steps a scene of 100k resting boxes with 95% asleep, against the same scene kept awake
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "PhysicsWorld.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	const float StepTime = 1.0f / 60;
+
+	const Shape Box = ShapeBox({ 0.5f, 0.5f, 0.5f });
+
+	void AddGround(PhysicsWorld& world, float halfSize)
+	{
+		const Shape ground = ShapeBox({ halfSize, 0.5f, halfSize }); // Copied into the body
+
+		BodyDesc desc;
+		desc.position = { 0, -0.5f, 0 };
+		desc.inverseMass = 0;
+		desc.shape = &ground;
+		world.CreateBody(desc);
+	}
+
+	BodyHandle AddBox(PhysicsWorld& world, const Vector3f& position)
+	{
+		BodyDesc desc;
+		desc.position = position;
+		desc.inverseInertia = { 6, 6, 6 };
+		desc.shape = &Box;
+		return world.CreateBody(desc);
+	}
+
+	std::vector<BodyHandle> BuildStack(PhysicsWorld& world, int height)
+	{
+		AddGround(world, 20);
+		std::vector<BodyHandle> stack;
+		for (int i = 0; i < height; ++i)
+			stack.push_back(AddBox(world, { 0, 0.5f + i, 0 }));
+		return stack;
+	}
+
+	bool AllAwake(const PhysicsWorld& world, const std::vector<BodyHandle>& bodies, bool awake)
+	{
+		for (BodyHandle body : bodies)
+		{
+			if (world.IsValid(body) && world.IsAwake(body) != awake)
+				return false;
+		}
+		return true;
+	}
+
+	void Steps(PhysicsWorld& world, int steps)
+	{
+		for (int step = 0; step < steps; ++step)
+			world.Step(StepTime);
+	}
+
+	bool CheckSleeping()
+	{
+		bool passed = true;
+
+		// Falling asleep, then staying exactly where it is
+		PhysicsWorld world;
+		std::vector<BodyHandle> stack = BuildStack(world, 5);
+		Steps(world, 120);
+		passed &= Check("resting stack sleeps as one island", AllAwake(world, stack, false) && world.Sleeping().Count() == 1);
+
+		std::vector<Vector3f> positions;
+		for (BodyHandle body : stack)
+			positions.push_back(world.Position(body));
+		Steps(world, 60);
+		bool still = true;
+		for (std::size_t i = 0; i < stack.size(); ++i)
+			still &= world.Position(stack[i]).x == positions[i].x && world.Position(stack[i]).y == positions[i].y &&
+			         world.Position(stack[i]).z == positions[i].z;
+		passed &= Check("sleeping bodies don't move", still);
+
+		// A box landing on top wakes the whole stack, which then sleeps again with the box
+		const BodyHandle dropped = AddBox(world, { 0, 7, 0 });
+		bool woken = false;
+		for (int step = 0; step < 60 && !woken; ++step)
+		{
+			world.Step(StepTime);
+			woken = AllAwake(world, stack, true);
+		}
+		passed &= Check("landing box wakes the stack", woken);
+		stack.push_back(dropped);
+		Steps(world, 240);
+		passed &= Check("stack sleeps again with the box", AllAwake(world, stack, false) && world.Sleeping().Count() == 1);
+
+		// Setting a velocity wakes the body's island
+		world.SetLinearVelocity(stack[0], { 0, 0, 0 });
+		passed &= Check("setting velocity wakes the island", AllAwake(world, stack, true) && world.Sleeping().Count() == 0);
+
+		// Destroying a body wakes the island it supported
+		Steps(world, 120);
+		world.DestroyBody(stack[2]);
+		passed &= Check("destroying a body wakes those on it", AllAwake(world, stack, true));
+
+		return passed;
+	}
+}
+
+bool RunSleepingBenchmarks()
+{
+	bool passed = CheckSleeping();
+
+	// Separate boxes resting on the ground, every twentieth kept awake for each timed run
+	const int side = 316;
+	const int steps = 10;
+	auto build = [&](PhysicsWorld& world)
+	{
+		AddGround(world, side + 2.0f);
+		std::vector<BodyHandle> boxes;
+		for (int x = 0; x < side; ++x)
+			for (int z = 0; z < side; ++z)
+				boxes.push_back(AddBox(world, { (x - side / 2) * 2.0f, 0.5f, (z - side / 2) * 2.0f }));
+		Steps(world, 40);
+		return boxes;
+	};
+
+	{
+		PhysicsWorld world;
+		const std::vector<BodyHandle> boxes = build(world);
+		passed &= Check("resting boxes all fall asleep", world.Bodies().AwakeCount() == 1);
+
+		// Woken boxes stay awake for the timed steps, they are still slow for less than timeToSleep
+		const double seconds = TimeBest([&]
+		{
+			for (std::size_t i = 0; i < boxes.size(); i += 20)
+				world.WakeBody(boxes[i]);
+			Steps(world, steps);
+		}, 3);
+		char label[64];
+		std::snprintf(label, sizeof(label), "%zu boxes, %.0f%% asleep", boxes.size(), 100.0 * (boxes.size() - (boxes.size() + 19) / 20) / boxes.size());
+		Report(label, seconds, steps, "step");
+	}
+
+	{
+		PhysicsSettings settings;
+		settings.allowSleeping = false;
+		PhysicsWorld world(settings);
+		const std::vector<BodyHandle> boxes = build(world);
+		const double seconds = TimeBest([&] { Steps(world, steps); }, 3);
+		char label[64];
+		std::snprintf(label, sizeof(label), "%zu boxes, sleeping off", boxes.size());
+		Report(label, seconds, steps, "step");
+	}
+
+	return passed;
+}
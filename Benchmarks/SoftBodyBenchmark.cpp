@@ -0,0 +1,231 @@
+//=========================================================================================================
+// SoftBodyBenchmark.cpp: Corotational Finite Element Soft Bodies
+// - Checks: the 3x3 inverse and polar decomposition, a body turned and spinning staying unstrained, a
+//   cantilever sagging as beam theory says (a little less, as linear tetrahedra are stiff) and coming to
+//   rest, and any thread count giving the same body
+// - Reports milliseconds a step, and the conjugate gradient iterations and residual, of cantilevers of 10k
+//   and 100k tetrahedra, on one thread and several, and checks each timed step was solved to the tolerance
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "SoftBody.h"
+#include "JobSystem.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+	const float StepTime = 1.0f / 60;
+
+	// A block of cubes the given size, its x = 0 end pinned
+	SoftBodyDesc Cantilever(int columns, int layers, int rows, float size)
+	{
+		SoftBodyDesc desc = SoftBodyBlock({ 0, 0, 0 }, columns, layers, rows, size);
+		for (uint32_t i = 0; i < desc.positions.size(); ++i)
+		{
+			if (desc.positions[i].x == 0)
+				desc.pinned.push_back(i);
+		}
+		return desc;
+	}
+
+	float MaxError(const Matrix3x3& a, const Matrix3x3& b)
+	{
+		return Norm(a - b);
+	}
+
+	// Random rotations times random symmetric stretches are split back into the same rotation and stretch.
+	// So are those turned inside out along their smallest stretch, as long as it is well apart from the next
+	bool PolarDecompositionRecovers()
+	{
+		std::mt19937 generator(25);
+		std::uniform_real_distribution<float> unit(-1, 1);
+		std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+		std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+		std::uniform_real_distribution<float> smallScale(0.2f, 0.4f);
+		auto randomRotation = [&]
+		{
+			const Vector3f axis = Normalise(Vector3f(unit(generator), unit(generator), unit(generator)));
+			return Matrix3x3Rotation(QuaternionAxisAngle(axis, angle(generator)));
+		};
+
+		float inverseError = 0;
+		float splitError = 0;
+		for (int i = 0; i < 1000; ++i)
+		{
+			const Matrix3x3 rotation = randomRotation();
+			const Matrix3x3 axes = randomRotation();
+			const bool insideOut = i % 2 == 1;
+			const Vector3f scales = { scale(generator), scale(generator), insideOut ? -smallScale(generator) : scale(generator) };
+			const Matrix3x3 stretch = Transpose(axes) * Matrix3x3Scale(scales) * axes;
+			const Matrix3x3 m = stretch * rotation;
+			inverseError = std::max(inverseError, MaxError(m * Inverse(m), Matrix3x3Identity<float>()));
+
+			Matrix3x3 foundRotation, foundStretch;
+			PolarDecomposition(m, foundRotation, foundStretch);
+			splitError = std::max({ splitError, MaxError(foundRotation, rotation), MaxError(foundStretch, stretch) });
+		}
+		return inverseError < 1e-4f && splitError < 1e-4f;
+	}
+
+	// Largest change in any element's edge length from its rest length, as a fraction of it
+	float WorstStrain(const SoftBody& body, const SoftBodyDesc& desc)
+	{
+		float worst = 0;
+		for (std::size_t e = 0; e < body.TetrahedronCount(); ++e)
+		{
+			const uint32_t* nodes = body.Tetrahedron(e).nodes;
+			for (int a = 0; a < 4; ++a)
+			{
+				for (int b = a + 1; b < 4; ++b)
+				{
+					const float rest = (desc.positions[nodes[b]] - desc.positions[nodes[a]]).Length();
+					const float now = (body.Position(nodes[b]) - body.Position(nodes[a])).Length();
+					worst = std::max(worst, std::abs(now / rest - 1));
+				}
+			}
+		}
+		return worst;
+	}
+
+	// Without gravity, a block started most of a turn round and spinning about another axis keeps its
+	// shape for two seconds, however far its elements have turned from their rest
+	bool RotatedBodyUnstrained()
+	{
+		SoftBodyDesc desc = SoftBodyBlock({ -0.3f, -0.15f, -0.15f }, 6, 3, 3, 0.1f);
+		desc.gravity = { 0, 0, 0 };
+		SoftBody body(desc);
+
+		const Matrix3x3 turn = Matrix3x3Rotation(QuaternionAxisAngle(Normalise(Vector3f(1, 1, 0)), 2.6f));
+		const Vector3f spin = { 0, 0, 2 }; // rad/s
+		for (std::size_t i = 0; i < body.NodeCount(); ++i)
+		{
+			body.SetPosition(i, desc.positions[i] * turn);
+			body.SetVelocity(i, Cross(spin, body.Position(i)));
+		}
+
+		float worst = WorstStrain(body, desc);
+		for (int step = 0; step < 120; ++step)
+		{
+			body.Step(StepTime);
+			worst = std::max(worst, WorstStrain(body, desc));
+		}
+		std::printf("  %zu tetrahedra turned and spinning: edges within %.2g%% of their rest lengths\n", body.TetrahedronCount(), 100.0 * worst);
+		return worst < 0.01f;
+	}
+
+	// A 1m long, 10cm square beam of 50MPa plastic held at one end. Euler-Bernoulli theory says its tip
+	// sags rho g A L^4 / (8 E I). Linear tetrahedra lock in bending, so the sag is less, by more the coarser
+	// they are. After three seconds the damping has it at rest
+	bool CantileverSags()
+	{
+		const float length = 1;
+		const float side = 0.1f;
+		SoftBodyDesc desc = Cantilever(20, 2, 2, side / 2);
+		desc.youngsModulus = 5e7f;
+		SoftBody body(desc);
+		for (int step = 0; step < 180; ++step)
+			body.Step(StepTime);
+
+		float sag = 0;
+		int tipNodes = 0;
+		float fastest = 0;
+		for (std::size_t i = 0; i < body.NodeCount(); ++i)
+		{
+			fastest = std::max(fastest, body.Velocity(i).Length());
+			if (desc.positions[i].x > length - 1e-4f)
+			{
+				sag += desc.positions[i].y - body.Position(i).y;
+				++tipNodes;
+			}
+		}
+		sag /= tipNodes;
+
+		const float theory = desc.density * 9.81f * length * length * length * length * 12 / (8 * desc.youngsModulus * side * side);
+		std::printf("  1m cantilever of %zu tetrahedra: tip sags %.1fmm (beam theory %.1fmm), fastest node %.2g m/s\n", body.TetrahedronCount(),
+			1000 * sag, 1000 * theory, fastest);
+		return sag > 0.4f * theory && sag < theory && fastest < 1e-3f;
+	}
+
+	// Elements write their own corners and nodes add them up in order, so threads give the same body exactly
+	bool ThreadsMatch()
+	{
+		const SoftBodyDesc desc = Cantilever(24, 9, 8, 0.05f);
+		auto run = [&](JobSystem* jobs)
+		{
+			SoftBody body(desc);
+			body.SetJobSystem(jobs);
+			for (int step = 0; step < 10; ++step)
+				body.Step(StepTime);
+			return body;
+		};
+
+		JobSystem jobs(4);
+		const SoftBody single = run(nullptr);
+		const SoftBody threaded = run(&jobs);
+		bool same = true;
+		for (std::size_t i = 0; i < single.NodeCount(); ++i)
+			same &= single.Position(i).x == threaded.Position(i).x && single.Position(i).y == threaded.Position(i).y &&
+			        single.Position(i).z == threaded.Position(i).z;
+		return same;
+	}
+
+	// Rubber cantilevers of 5cm cubes, timed from a few steps in as they start to sag. Returns whether every
+	// timed step's solve reached the tolerance, rather than stopping at the iteration limit
+	bool Throughput(int columns, int layers, int rows, int steps, int repeats)
+	{
+		const SoftBodyDesc desc = Cantilever(columns, layers, rows, 0.05f);
+		SoftBody started(desc);
+		for (int step = 0; step < 2; ++step)
+			started.Step(StepTime);
+		std::printf("  %d x %d x %d cube cantilever: %zu tetrahedra, %zu nodes\n", columns, layers, rows, started.TetrahedronCount(),
+			started.NodeCount());
+
+		bool solved = true;
+		auto time = [&](const char* label, JobSystem* jobs)
+		{
+			SoftBody body = started;
+			body.SetJobSystem(jobs);
+			int iterations = 0;
+			float residual = 0;
+			const double seconds = TimeBest([&]
+			{
+				for (int step = 0; step < steps; ++step)
+				{
+					body.Step(StepTime);
+					iterations = std::max(iterations, body.Iterations());
+					residual = std::max(residual, body.Residual());
+				}
+				DoNotOptimise(body.Position(0));
+			}, repeats);
+			std::printf("  %-44s %10.2f ms/step  %4d iterations  residual %.2g\n", label, seconds * 1e3 / steps, iterations, residual);
+			solved &= residual <= desc.tolerance;
+		};
+
+		time("1 thread", nullptr);
+
+		JobSystem jobs(HardwareThreadCount());
+		char label[64];
+		std::snprintf(label, sizeof(label), "%u thread%s", jobs.ThreadCount(), jobs.ThreadCount() == 1 ? "" : "s");
+		time(label, &jobs);
+		return solved;
+	}
+}
+
+bool RunSoftBodyBenchmarks()
+{
+	bool passed = true;
+	passed &= Check("polar decomposition and inverse", PolarDecompositionRecovers());
+	passed &= Check("turned, spinning body is unstrained", RotatedBodyUnstrained());
+	passed &= Check("cantilever sags and comes to rest", CantileverSags());
+	passed &= Check("threads give the same body", ThreadsMatch());
+
+	passed &= Check("10k tetrahedra solved to tolerance", Throughput(24, 9, 8, 5, 2));
+	passed &= Check("100k tetrahedra solved to tolerance", Throughput(40, 20, 21, 2, 1));
+	return passed;
+}
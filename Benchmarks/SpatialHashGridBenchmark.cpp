@@ -0,0 +1,135 @@
+//=========================================================================================================
+// SpatialHashGridBenchmark.cpp: Particle Grid Rebuild and Neighbour Pairs
+// - Equal radius particles spread through a cube at about one per unit volume, cell size the particle
+//   diameter, so each particle has a few neighbours in contact range
+// - Times a full rebuild and a full pair finding pass (the per-step cost for particle scenes) on one
+//   thread and on all threads
+// - Pairs are checked against brute force, and must be identical for any thread count, on threads started
+//   for each pass or as jobs on a JobSystem
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "SpatialHashGrid.h"
+#include "JobSystem.h"
+#include "ParallelFor.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	const std::size_t ParticleCounts[] = { 100000, 1000000 };
+	const float Radius = 0.5f;
+
+	std::vector<Vector3f> CreateParticles(std::size_t count, RandomGenerator& generator)
+	{
+		const float size = std::cbrt(static_cast<float>(count));
+		std::vector<Vector3f> positions(count);
+		for (Vector3f& p : positions)
+			p = generator.NextVector3({ 0, 0, 0 }, { size, size, size });
+		return positions;
+	}
+
+	bool SamePairs(const std::vector<BroadphasePair>& a, const std::vector<BroadphasePair>& b)
+	{
+		return a.size() == b.size() &&
+		       std::equal(a.begin(), a.end(), b.begin(), [](const BroadphasePair& x, const BroadphasePair& y) { return x.a == y.a && x.b == y.b; });
+	}
+
+	void SortPairs(std::vector<BroadphasePair>& pairs)
+	{
+		std::sort(pairs.begin(), pairs.end(), [](const BroadphasePair& x, const BroadphasePair& y) { return x.a != y.a ? x.a < y.a : x.b < y.b; });
+	}
+}
+
+bool RunSpatialHashGridBenchmarks()
+{
+	bool passed = true;
+	RandomGenerator generator(99);
+	std::vector<BroadphasePair> pairs, singlePairs;
+
+	// Against brute force on a small scene, including negative cell coordinates
+	{
+		std::vector<Vector3f> positions = CreateParticles(4000, generator);
+		for (Vector3f& p : positions)
+			p = p - Vector3f(8, 8, 8);
+
+		SpatialHashGrid grid(2 * Radius);
+		grid.Build(positions);
+		grid.FindPairs(2 * Radius, pairs);
+
+		std::vector<BroadphasePair> expected;
+		for (uint32_t i = 0; i < positions.size(); ++i)
+		{
+			for (uint32_t j = i + 1; j < positions.size(); ++j)
+			{
+				const Vector3f d = positions[j] - positions[i];
+				if (Dot(d, d) <= 4 * Radius * Radius)
+					expected.push_back({ i, j });
+			}
+		}
+		SortPairs(pairs);
+		passed &= Check("grid pairs match brute force", !expected.empty() && SamePairs(pairs, expected));
+
+		// Every particle within range is visited by ForEachNeighbour, and none twice
+		bool neighboursOK = true;
+		std::vector<int> visits(positions.size());
+		for (std::size_t i = 0; i < positions.size(); i += 37)
+		{
+			std::fill(visits.begin(), visits.end(), 0);
+			grid.ForEachNeighbour(positions[i], [&](uint32_t j) { ++visits[j]; });
+			for (std::size_t j = 0; j < positions.size(); ++j)
+			{
+				const Vector3f d = positions[j] - positions[i];
+				neighboursOK &= visits[j] <= 1 && (Dot(d, d) > 4 * Radius * Radius || visits[j] == 1);
+			}
+		}
+		passed &= Check("grid neighbours visited once", neighboursOK);
+	}
+
+	// At least 4 threads so the threaded build is checked on any machine
+	const unsigned int threads = std::max(4u, HardwareThreadCount());
+	JobSystem jobs(threads);
+	for (std::size_t count : ParticleCounts)
+	{
+		std::vector<Vector3f> positions = CreateParticles(count, generator);
+		char label[64];
+
+		for (unsigned int threadCount : { 1u, threads })
+		{
+			SpatialHashGrid grid(2 * Radius, threadCount);
+			double buildSeconds = TimeBest([&]() { grid.Build(positions); }, 3);
+			double pairSeconds = TimeBest([&]() { grid.FindPairs(2 * Radius, pairs); DoNotOptimise(pairs); }, 3);
+			double totalSeconds = TimeBest([&]()
+			{
+				grid.Build(positions);
+				grid.FindPairs(2 * Radius, pairs);
+				DoNotOptimise(pairs);
+			}, 3);
+
+			std::snprintf(label, sizeof(label), "grid build (%zu, %u threads)", count, threadCount);
+			Report(label, buildSeconds, count, "particle");
+			std::snprintf(label, sizeof(label), "grid pairs (%zu, %u threads)", count, threadCount);
+			Report(label, pairSeconds, count, "particle");
+			std::snprintf(label, sizeof(label), "build + pairs (%zu, %u thr, %zu pairs)", count, threadCount, pairs.size());
+			Report(label, totalSeconds, 1, "step");
+
+			if (threadCount == 1)
+				singlePairs = pairs;
+		}
+
+		std::snprintf(label, sizeof(label), "grid threads match 1 thread (%zu)", count);
+		passed &= Check(label, SamePairs(pairs, singlePairs));
+
+		SpatialHashGrid jobGrid(2 * Radius, threads);
+		jobGrid.SetJobSystem(&jobs);
+		jobGrid.Build(positions);
+		jobGrid.FindPairs(2 * Radius, pairs);
+		std::snprintf(label, sizeof(label), "grid jobs match 1 thread (%zu)", count);
+		passed &= Check(label, SamePairs(pairs, singlePairs));
+	}
+
+	return passed;
+}
@@ -0,0 +1,227 @@
+//=========================================================================================================
+// StackingBenchmark.cpp: Contact Cache and Warm Starting on Box Stacks
+// - The contact cache is checked for pair lookups in either order, for keeping impulses through table
+//   growth, and for matching every point of a resting stack to last step's points
+// - Stacks of unit boxes are run for ten seconds at doubling solver iteration counts, with and without
+//   warm starting, to find the fewest iterations that keep each stack standing
+// - Timing covers the cache update alone (per manifold) and whole steps of the tallest stack
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "PhysicsWorld.h"
+#include "Random.h"
+
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+	const int StackHeights[] = { 5, 10, 20 };
+	const int MaxIterations = 128;
+	const float StepTime = 1.0f / 60;
+	const int StandSteps = 600;
+
+	// Boxes of size 1 dropped into place on a large static ground box, body 0
+	void BuildStack(PhysicsWorld& world, int height)
+	{
+		const Shape ground = ShapeBox({ 20, 0.5f, 20 });
+		const Shape box = ShapeBox({ 0.5f, 0.5f, 0.5f });
+
+		BodyDesc groundDesc;
+		groundDesc.position = { 0, -0.5f, 0 };
+		groundDesc.inverseMass = 0;
+		groundDesc.shape = &ground;
+		world.CreateBody(groundDesc);
+
+		for (int i = 0; i < height; ++i)
+		{
+			BodyDesc desc;
+			desc.position = { 0, 0.5f + i, 0 };
+			desc.inverseInertia = { 6, 6, 6 }; // Unit cube of mass 1
+			desc.shape = &box;
+			world.CreateBody(desc);
+		}
+	}
+
+	// Run a stack for the full time, false as soon as the top box has moved sideways or sunk. Each contact
+	// may sink by the allowed penetration, so the height tolerance is generous
+	bool StackStands(int height, int iterations, bool warmStarting)
+	{
+		PhysicsSettings settings;
+		settings.solver.iterations = iterations;
+		settings.solver.warmStarting = warmStarting;
+		settings.allowSleeping = false; // A stack put to sleep would stand with any iterations
+		PhysicsWorld world(settings);
+		BuildStack(world, height);
+
+		const std::size_t top = world.BodyCount() - 1;
+		for (int step = 0; step < StandSteps; ++step)
+		{
+			world.Step(StepTime);
+			const Vector3f p = world.Bodies().positions.Get(top);
+			if (std::sqrt(p.x * p.x + p.z * p.z) > 0.1f || std::abs(p.y - (height - 0.5f)) > 0.3f)
+				return false;
+		}
+		return true;
+	}
+
+	// Fewest of 1, 2, 4 ... MaxIterations for which the stack stands, or 0 if none
+	int IterationsToStand(int height, bool warmStarting)
+	{
+		for (int iterations = 1; iterations <= MaxIterations; iterations *= 2)
+		{
+			if (StackStands(height, iterations, warmStarting))
+				return iterations;
+		}
+		return 0;
+	}
+
+	// Single point contact for cache tests, feature id 0 so points are matched by position
+	Contact PointContact(const Vector3f& position, const Vector3f& normal)
+	{
+		Contact contact;
+		contact.normal = normal;
+		contact.pointCount = 1;
+		contact.points[0] = { position, 0.01f, 0 };
+		return contact;
+	}
+
+	bool CheckCache()
+	{
+		bool passed = true;
+
+		// Body order and the normal flip
+		{
+			ContactCache cache;
+			cache.BeginStep();
+			cache.Add(7, 3, PointContact({ 0, 0, 0 }, { 0, 1, 0 })).points[0].normalImpulse = 2;
+			const ContactManifold* found = cache.Find(3, 7);
+			passed &= Check("pair found in either order, normal flipped", found && found == cache.Find(7, 3) &&
+				found->bodyA == 3 && found->normal.y == -1);
+
+			cache.BeginStep();
+			const ContactManifold& next = cache.Add(3, 7, PointContact({ 0.005f, 0, 0 }, { 0, -1, 0 }));
+			const ContactManifold& far = cache.Add(3, 8, PointContact({ 0, 0, 0 }, { 0, -1, 0 }));
+			passed &= Check("nearby point keeps its impulse", next.points[0].normalImpulse == 2 && far.points[0].normalImpulse == 0 &&
+				cache.MatchedPointCount() == 1 && cache.PointCount() == 2);
+		}
+
+		// Enough pairs to grow the table several times, every impulse must come through
+		{
+			const uint32_t pairCount = 20000;
+			ContactCache cache;
+			cache.BeginStep();
+			for (uint32_t i = 0; i < pairCount; ++i)
+				cache.Add(i, i * 7 + 1, PointContact({ 0, 0, 0 }, { 0, 1, 0 })).points[0].normalImpulse = static_cast<float>(i);
+
+			cache.BeginStep();
+			bool allKept = true;
+			for (uint32_t i = pairCount; i-- > 0; )
+				allKept &= cache.Add(i * 7 + 1, i, PointContact({ 0, 0, 0 }, { 0, -1, 0 })).points[0].normalImpulse == static_cast<float>(i);
+			passed &= Check("impulses kept through table growth", allKept && cache.Size() == pairCount);
+		}
+
+		// A resting stack: same pairs and features every step. Kept awake, as sleeping manifolds aren't matched
+		{
+			PhysicsSettings settings;
+			settings.allowSleeping = false;
+			PhysicsWorld world(settings);
+			BuildStack(world, 10);
+			for (int step = 0; step < 120; ++step)
+				world.Step(StepTime);
+			const ContactCache& contacts = world.Contacts();
+			passed &= Check("resting stack matches every point", contacts.Size() == 10 && contacts.PointCount() == 40 &&
+				contacts.MatchedPointCount() == contacts.PointCount());
+		}
+
+		return passed;
+	}
+}
+
+bool RunStackingBenchmarks()
+{
+	bool passed = CheckCache();
+
+	// Iterations needed to stand
+	int warmIterations[std::size(StackHeights)];
+	int coldIterations[std::size(StackHeights)];
+	for (std::size_t h = 0; h < std::size(StackHeights); ++h)
+	{
+		warmIterations[h] = IterationsToStand(StackHeights[h], true);
+		coldIterations[h] = IterationsToStand(StackHeights[h], false);
+
+		char label[64], warm[32], cold[32];
+		std::snprintf(label, sizeof(label), "%d-box stack, iterations to stand %.0fs", StackHeights[h], StandSteps * StepTime);
+		std::snprintf(warm, sizeof(warm), warmIterations[h] ? "%d" : "over %d", warmIterations[h] ? warmIterations[h] : MaxIterations);
+		std::snprintf(cold, sizeof(cold), coldIterations[h] ? "%d" : "over %d", coldIterations[h] ? coldIterations[h] : MaxIterations);
+		std::printf("  %-44s warm started %s, cold %s\n", label, warm, cold);
+	}
+
+	bool warmNeedsFewer = true;
+	for (std::size_t h = 0; h < std::size(StackHeights); ++h)
+		warmNeedsFewer &= warmIterations[h] != 0 && (coldIterations[h] == 0 || warmIterations[h] <= coldIterations[h]);
+	passed &= Check("warm starting stands with fewer iterations", warmNeedsFewer);
+
+	// Cache update alone: scattered pairs, each touching at four points that move slightly every step
+	{
+		const std::size_t pairCount = 10000;
+		const int steps = 10;
+		RandomGenerator generator(14);
+		// Even ids paired with random odd ids, so no pair repeats
+		std::vector<uint32_t> bodies(pairCount * 2);
+		for (std::size_t i = 0; i < pairCount; ++i)
+		{
+			bodies[2 * i] = static_cast<uint32_t>(2 * i);
+			bodies[2 * i + 1] = 2 * (generator.NextUInt32() % 100000) + 1;
+		}
+
+		Contact contact;
+		contact.normal = { 0, 1, 0 };
+		contact.pointCount = Contact::MaxPoints;
+		for (int i = 0; i < Contact::MaxPoints; ++i)
+			contact.points[i] = { { (i & 1) - 0.5f, 0, (i >> 1) - 0.5f }, 0.01f, 0 };
+
+		ContactCache cache;
+		const double seconds = TimeBest([&]
+		{
+			for (int step = 0; step < steps; ++step)
+			{
+				cache.BeginStep();
+				for (std::size_t i = 0; i < pairCount; ++i)
+				{
+					contact.points[0].position.x = -0.5f + step * 0.001f;
+					cache.Add(bodies[2 * i], bodies[2 * i + 1], contact);
+				}
+			}
+			DoNotOptimise(cache.MatchedPointCount());
+		});
+		Report("cache update, 4 points matched by distance", seconds, pairCount * steps, "manifold");
+	}
+
+	// Whole steps of the tallest stack at the iterations it needs warm started
+	const std::size_t tallest = std::size(StackHeights) - 1;
+	if (warmIterations[tallest] != 0)
+	{
+		PhysicsSettings settings;
+		settings.solver.iterations = warmIterations[tallest];
+		settings.allowSleeping = false;
+		PhysicsWorld world(settings);
+		BuildStack(world, StackHeights[tallest]);
+		for (int step = 0; step < 60; ++step)
+			world.Step(StepTime);
+
+		const int steps = 100;
+		const double seconds = TimeBest([&]
+		{
+			for (int step = 0; step < steps; ++step)
+				world.Step(StepTime);
+		});
+		char label[64];
+		std::snprintf(label, sizeof(label), "%d-box stack step, %d iterations", StackHeights[tallest], warmIterations[tallest]);
+		Report(label, seconds, steps, "step");
+	}
+
+	return passed;
+}
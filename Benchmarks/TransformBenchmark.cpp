@@ -0,0 +1,100 @@
+//=========================================================================================================
+// TransformBenchmark.cpp: Quaternion / Transform Composition and Inverse vs the Matrix4x4f Equivalents
+// - Transforms are random rigid (position + rotation) transforms, matrices are built from the same values
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "Transform.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	const std::size_t NumTransforms = 1 << 14;
+
+	float MaxError(const Matrix4x4f& a, const Matrix4x4f& b)
+	{
+		float error = 0;
+		for (int i = 0; i < 16; ++i)
+			error = std::max(error, std::abs((&a.e00)[i] - (&b.e00)[i]));
+		return error;
+	}
+
+	// q and -q are the same rotation
+	float MaxError(const Quaternionf& a, const Quaternionf& b)
+	{
+		return 1 - std::abs(Dot(a, b));
+	}
+}
+
+bool RunTransformBenchmarks()
+{
+	std::mt19937 generator(5);
+	std::uniform_real_distribution<float> position(-100, 100);
+	std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+
+	std::vector<Transformf> transforms(NumTransforms), transformResults(NumTransforms);
+	std::vector<Matrix4x4f> matrices(NumTransforms), matrixResults(NumTransforms);
+	for (std::size_t i = 0; i < NumTransforms; ++i)
+	{
+		Vector3f p(position(generator), position(generator), position(generator));
+		Vector3f r(angle(generator), angle(generator), angle(generator));
+		transforms[i] = Transformf(p, QuaternionFromEuler(r));
+		matrices[i] = Matrix4x4f(p, r);
+	}
+
+	//--- Validation ---
+	bool passed = true;
+	Vector3f r(0.3f, -1.2f, 2.0f), p(1, 2, 3);
+
+	passed &= Check("axis-angle matches MatrixRotationX",
+		MaxError(MatrixRotation(QuaternionAxisAngle(Vector3f(1, 0, 0), r.x)), MatrixRotationX(r.x)) < 1e-6f);
+	passed &= Check("FromEuler matches MatrixRotation(euler)",
+		MaxError(MatrixRotation(QuaternionFromEuler(r)), MatrixRotation(r)) < 1e-5f);
+
+	float matrixError = 0, fromMatrixError = 0, composeError = 0, inverseError = 0;
+	for (std::size_t i = 0; i + 1 < NumTransforms; ++i)
+	{
+		matrixError = std::max(matrixError, MaxError(transforms[i].ToMatrix(), matrices[i]) / 100);
+		fromMatrixError = std::max(fromMatrixError, MaxError(QuaternionFromMatrix(matrices[i]), transforms[i].rotation));
+		composeError = std::max(composeError, MaxError((transforms[i] * transforms[i + 1]).ToMatrix(), matrices[i] * matrices[i + 1]) / 100);
+		inverseError = std::max(inverseError, MaxError(Inverse(transforms[i]).ToMatrix(), InverseAffine(matrices[i])) / 100);
+	}
+	passed &= Check("ToMatrix matches Matrix4x4f(p, r)", matrixError < 1e-5f);
+	passed &= Check("QuaternionFromMatrix round trip", fromMatrixError < 1e-5f);
+	passed &= Check("a * b matches matrix a * b", composeError < 1e-5f);
+	passed &= Check("Inverse matches InverseAffine", inverseError < 1e-5f);
+
+	const Transformf& t = transforms[0];
+	passed &= Check("TransformPoint matches matrix",
+		(t.TransformPoint(p) - matrices[0].TransformPoint(p)).Length() < 1e-3f);
+
+	Quaternionf a = QuaternionAxisAngle(Vector3f(0, 1, 0), 0.2f), b = QuaternionAxisAngle(Vector3f(0, 1, 0), 1.4f);
+	passed &= Check("Slerp halfway", MaxError(Slerp(a, b, 0.5f), QuaternionAxisAngle(Vector3f(0, 1, 0), 0.8f)) < 1e-6f);
+	passed &= Check("Slerp takes the shorter path", MaxError(Slerp(a, -b, 0.5f), QuaternionAxisAngle(Vector3f(0, 1, 0), 0.8f)) < 1e-6f);
+
+	Vector3f axis;
+	float axisAngle;
+	ToAxisAngle(QuaternionAxisAngle(Normalise(p), 2.5f), axis, axisAngle);
+	passed &= Check("ToAxisAngle round trip", (axis - Normalise(p)).Length() < 1e-5f && std::abs(axisAngle - 2.5f) < 1e-5f);
+
+	//--- Timing ---
+	double seconds = TimeBest([&]() { for (std::size_t i = 0; i + 1 < NumTransforms; ++i) matrixResults[i] = matrices[i] * matrices[i + 1]; DoNotOptimise(matrixResults); });
+	Report("compose (Matrix4x4f operator*)", seconds, NumTransforms - 1, "op");
+
+	seconds = TimeBest([&]() { for (std::size_t i = 0; i + 1 < NumTransforms; ++i) transformResults[i] = transforms[i] * transforms[i + 1]; DoNotOptimise(transformResults); });
+	Report("compose (Transform operator*)", seconds, NumTransforms - 1, "op");
+
+	seconds = TimeBest([&]() { for (std::size_t i = 0; i < NumTransforms; ++i) matrixResults[i] = InverseAffine(matrices[i]); DoNotOptimise(matrixResults); });
+	Report("inverse (InverseAffine)", seconds, NumTransforms, "op");
+
+	seconds = TimeBest([&]() { for (std::size_t i = 0; i < NumTransforms; ++i) transformResults[i] = Inverse(transforms[i]); DoNotOptimise(transformResults); });
+	Report("inverse (Transform)", seconds, NumTransforms, "op");
+
+	seconds = TimeBest([&]() { for (std::size_t i = 0; i < NumTransforms; ++i) matrixResults[i] = transforms[i].ToMatrix(); DoNotOptimise(matrixResults); });
+	Report("Transform::ToMatrix", seconds, NumTransforms, "op");
+
+	return passed;
+}
@@ -0,0 +1,111 @@
+//=========================================================================================================
+// Vector3SoABenchmark.cpp: Throughput of Vector3SoA Bulk Operations vs a Loop over std::vector<Vector3f>
+// - Results of each bulk operation are checked against the same loop over Vector3f
+//=========================================================================================================
+
+#include "Benchmark.h"
+
+#include "Vector3SoA.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	const std::size_t NumPoints = 1 << 20;
+
+	// Largest difference between a Vector3SoA and an array of Vector3f
+	float MaxError(const Vector3SoA& soa, const std::vector<Vector3f>& aos)
+	{
+		float error = 0;
+		for (std::size_t i = 0; i < aos.size(); ++i)
+			error = std::max(error, (soa.Get(i) - aos[i]).Length());
+		return error;
+	}
+
+	float MaxError(const std::vector<float>& a, const std::vector<float>& b)
+	{
+		float error = 0;
+		for (std::size_t i = 0; i < a.size(); ++i)
+			error = std::max(error, std::abs(a[i] - b[i]));
+		return error;
+	}
+
+	// Time the AoS loop and the SoA call for the same operation and print both
+	template<typename AoS, typename SoA> void Compare(const char* name, AoS&& aos, SoA&& soa)
+	{
+		char label[64];
+		std::snprintf(label, sizeof(label), "%s (Vector3f loop)", name);
+		Report(label, TimeBest(aos), NumPoints, "point");
+		std::snprintf(label, sizeof(label), "%s (Vector3SoA)", name);
+		Report(label, TimeBest(soa), NumPoints, "point");
+	}
+}
+
+bool RunVector3SoABenchmarks()
+{
+	std::mt19937 generator(7);
+	std::uniform_real_distribution<float> range(-100, 100);
+
+	std::vector<Vector3f> a(NumPoints), b(NumPoints), outAoS(NumPoints);
+	for (std::size_t i = 0; i < NumPoints; ++i)
+	{
+		a[i] = { range(generator), range(generator), range(generator) };
+		b[i] = { range(generator), range(generator), range(generator) };
+	}
+	a[3] = { 0, 0, 0 }; // Check zero length handling in Normalise
+
+	Vector3SoA soaA(a), soaB(b), soaOut;
+	std::vector<float> scalarsAoS(NumPoints), scalarsSoA;
+
+	Matrix4x4f m(0.36f, 0.48f, -0.8f, 0, -0.8f, 0.6f, 0, 0, 0.48f, 0.64f, 0.6f, 0, 10, -5, 2, 1);
+	bool passed = true;
+
+	Compare("add",
+		[&]() { for (std::size_t i = 0; i < NumPoints; ++i) outAoS[i] = a[i] + b[i]; DoNotOptimise(outAoS); },
+		[&]() { Add(soaA, soaB, soaOut); DoNotOptimise(soaOut); });
+	passed &= Check("add matches Vector3f", MaxError(soaOut, outAoS) == 0);
+
+	std::vector<Vector3f> y = a;
+	Vector3SoA soaY(a);
+	Compare("scale-add (axpy)",
+		[&]() { for (std::size_t i = 0; i < NumPoints; ++i) y[i] += 0.01f * b[i]; DoNotOptimise(y); },
+		[&]() { ScaleAdd(soaY, 0.01f, soaB); DoNotOptimise(soaY); });
+	passed &= Check("scale-add matches Vector3f", MaxError(soaY, y) < 1e-3f);
+
+	Compare("dot",
+		[&]() { for (std::size_t i = 0; i < NumPoints; ++i) scalarsAoS[i] = Dot(a[i], b[i]); DoNotOptimise(scalarsAoS); },
+		[&]() { Dot(soaA, soaB, scalarsSoA); DoNotOptimise(scalarsSoA); });
+	passed &= Check("dot matches Vector3f", MaxError(scalarsSoA, scalarsAoS) < 1e-2f);
+
+	Compare("cross",
+		[&]() { for (std::size_t i = 0; i < NumPoints; ++i) outAoS[i] = Cross(a[i], b[i]); DoNotOptimise(outAoS); },
+		[&]() { Cross(soaA, soaB, soaOut); DoNotOptimise(soaOut); });
+	passed &= Check("cross matches Vector3f", MaxError(soaOut, outAoS) < 1e-2f);
+
+	Compare("length",
+		[&]() { for (std::size_t i = 0; i < NumPoints; ++i) scalarsAoS[i] = a[i].Length(); DoNotOptimise(scalarsAoS); },
+		[&]() { Length(soaA, scalarsSoA); DoNotOptimise(scalarsSoA); });
+	passed &= Check("length matches Vector3f", MaxError(scalarsSoA, scalarsAoS) < 1e-4f);
+
+	Compare("normalise",
+		[&]() { for (std::size_t i = 0; i < NumPoints; ++i) outAoS[i] = Normalise(a[i]); DoNotOptimise(outAoS); },
+		[&]() { Normalise(soaA, soaOut); DoNotOptimise(soaOut); });
+	passed &= Check("normalise matches Vector3f", MaxError(soaOut, outAoS) < 1e-5f);
+
+	Compare("transform points",
+		[&]()
+		{
+			for (std::size_t i = 0; i < NumPoints; ++i)
+			{
+				const Vector3f& v = a[i];
+				outAoS[i] = v.x * m.XAxis() + v.y * m.YAxis() + v.z * m.ZAxis() + m.Position();
+			}
+			DoNotOptimise(outAoS);
+		},
+		[&]() { TransformPoints(m, soaA, soaOut); DoNotOptimise(soaOut); });
+	passed &= Check("transform matches Vector3f", MaxError(soaOut, outAoS) < 1e-3f);
+
+	passed &= Check("round trip to std::vector<Vector3f>", MaxError(Vector3SoA(soaA.ToVector()), a) == 0);
+	return passed;
+}
@@ -1,21 +1,240 @@
+//=========================================================================================================
+// CSystem.cpp: Win32 Window Front End
+//=========================================================================================================
+
 #include "CSystem.h"
 
-bool CSystem::Initilize()
-{
+#include <shellapi.h> // For SHGetStockIconInfo
+
+#include <chrono>
+#include <string>
 
-	
+// The CSystem that owns the window, used by WndProc to pass messages on
+static CSystem* gApplicationHandle = nullptr;
+
+CSystem::CSystem()
+	: mApplicationName(L"Physics Engine"), mHInstance(nullptr), mHWnd(nullptr)
+{
 }
 
-void CSystem::Initialize(int&, int&)
+CSystem::~CSystem()
 {
-	// Initialize width and height of screen to zero before snedinf variables to function
-	int windowWidth = 0;
-	int windowHeight = 0;
+}
+
+//====================================
+// Setup / Shutdown
+//====================================
 
-	//GetDesktopResolution(windowWidth, windowHeight);
+bool CSystem::Initialize()
+{
+	int windowWidth = 1280;
+	int windowHeight = 720;
 
 	// Initialize Windows API
-	InitializeWindows(windowWidth, windowHeight);
+	if (!InitializeWindows(windowWidth, windowHeight))
+		return false;
+
+	// Nothing to simulate yet - scenes are added to the step function as the engine grows
+	mSimulationHost = std::make_unique<CSimulationHost>([](float) {});
+
+	return true;
+}
+
+void CSystem::Shutdown()
+{
+	mSimulationHost.reset();
+	ShutdownWindows();
+}
+
+
+//====================================
+// Main Loop
+//====================================
 
+void CSystem::Run()
+{
+	MSG msg = {};
+	auto previousTime = std::chrono::steady_clock::now();
+
+	// Loop until a Quit Message is received or Frame asks to stop
+	bool running = true;
+	while (running)
+	{
+		// Handle all Windows Messages waiting, then do a frame
+		while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
+		{
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+
+			if (msg.message == WM_QUIT)
+				running = false;
+		}
+
+		if (!running)
+			break;
+
+		auto time = std::chrono::steady_clock::now();
+		std::chrono::duration<float> frameTime = time - previousTime;
+		previousTime = time;
+
+		running = Frame(frameTime.count());
+	}
+}
+
+bool CSystem::Frame(float frameTime)
+{
+	// Simulation runs in fixed steps, however long the frame took
+	mSimulationHost->Advance(frameTime);
+
+	UpdateWindowTitle(frameTime);
 	return true;
 }
+
+void CSystem::UpdateWindowTitle(float frameTime)
+{
+	const float UpdatePeriod = 0.5f;
+
+	mTitleTime += frameTime;
+	++mTitleFrames;
+	if (mTitleTime < UpdatePeriod)
+		return;
+
+	uint64_t steps = mSimulationHost->StepCount() - mTitleSteps;
+	float averageFrameTime = mTitleTime / mTitleFrames;
+
+	std::wstring title = std::wstring(mApplicationName) +
+	                     L" - Frame Time: " + std::to_wstring(averageFrameTime * 1000.0f).substr(0, 5) + L"ms" +
+	                     L", Steps/s: " + std::to_wstring(static_cast<int>(steps / mTitleTime));
+	SetWindowText(mHWnd, title.c_str());
+
+	mTitleTime = 0;
+	mTitleFrames = 0;
+	mTitleSteps = mSimulationHost->StepCount();
+}
+
+
+//====================================
+// Create Window to Display Scene
+// - Returns false on failure
+//====================================
+
+bool CSystem::InitializeWindows(int windowWidth, int windowHeight)
+{
+	gApplicationHandle = this;
+	mHInstance = GetModuleHandle(nullptr);
+
+	SHSTOCKICONINFO stockIcon;
+	stockIcon.cbSize = sizeof(stockIcon);
+
+	if (SHGetStockIconInfo(SIID_APPLICATION, SHGSI_ICON, &stockIcon) != S_OK)
+		return false;
+
+	// Register Window Class. Defines various UI featrues of the window for the engine
+	WNDCLASSEX wcex;
+	wcex.cbSize = sizeof(WNDCLASSEX);
+	wcex.style = CS_HREDRAW | CS_VREDRAW;
+	wcex.lpfnWndProc = WndProc; // Function to deal with Window Messages
+	wcex.cbClsExtra = 0;
+	wcex.cbWndExtra = 0;
+	wcex.hInstance = mHInstance;
+	wcex.hIcon = stockIcon.hIcon; // Which Icon to use for the Window
+	wcex.hCursor = LoadCursor(nullptr, IDC_ARROW); // What Cursor to Use
+	wcex.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
+	wcex.lpszMenuName = nullptr;
+	wcex.lpszClassName = mApplicationName;
+	wcex.hIconSm = stockIcon.hIcon;
+
+	if (!RegisterClassEx(&wcex))
+		return false;
+
+	// Select Type of Window to Start in
+	DWORD windowStyle = WS_OVERLAPPEDWINDOW & ~WS_THICKFRAME; // Standard Window, not resizable
+
+	// Calculate Overall Dimensions of the Window. Will Render inside of the Window
+	// Overall Window will be Larger (Boarders, Title Bar, Etc.)
+	RECT rc = { 0, 0, windowWidth, windowHeight };
+	AdjustWindowRect(&rc, windowStyle, FALSE);
+
+	// Create Window, Second Parameter is the Text in the Title Bar
+	mHWnd = CreateWindow(
+		mApplicationName, mApplicationName, windowStyle,
+		CW_USEDEFAULT, CW_USEDEFAULT, rc.right - rc.left, rc.bottom - rc.top,
+		nullptr, nullptr, mHInstance, nullptr);
+
+	if (mHWnd == NULL)
+		return false;
+
+	ShowWindow(mHWnd, SW_SHOW);
+	UpdateWindow(mHWnd);
+	return true;
+}
+
+void CSystem::ShutdownWindows()
+{
+	if (mHWnd != NULL)
+	{
+		DestroyWindow(mHWnd);
+		mHWnd = NULL;
+	}
+
+	if (mHInstance != NULL)
+	{
+		UnregisterClass(mApplicationName, mHInstance);
+		mHInstance = NULL;
+	}
+
+	gApplicationHandle = nullptr;
+}
+
+
+//==========================================================================
+// Deal with Messages from Windows
+// There are Many Possible Messages, such as Keyboard or Mouse Inputs,
+// Resizing or Minimising Windows, etc.
+// Only deal with Messages we're intrested in - Add as Project Evolves
+//==========================================================================
+
+LRESULT CALLBACK CSystem::MessageHandler(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+{
+	switch (message)
+	{
+	case WM_PAINT: // Message to ensure Window Content is Dispalyed
+	{
+		PAINTSTRUCT ps;
+		BeginPaint(hWnd, &ps);
+		EndPaint(hWnd, &ps);
+		break;
+	}
+
+	// The WM_KEYXXXX Messages Report Key Input to our Window
+	// ADD WHEN INPUT.H/CPP IS WRITTEN
+
+	// Using Raw Input for Mouse Movement so we can still get Mouse Movement even after after Mouse Cursor hits Edge of Screen
+	// ADD WHEN INPUT.H/CPP IS WRITTEN
+
+	// Any Messages NOT Handled are Passed back to Windows Default Handling
+	default:
+		return DefWindowProc(hWnd, message, wParam, lParam);
+	}
+
+	return 0;
+}
+
+LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+{
+	switch (message)
+	{
+	case WM_DESTROY: // A Message to deal with Window Closing
+	case WM_CLOSE:
+	{
+		PostQuitMessage(0);
+		return 0;
+	}
+
+	// All other messages are handled by the CSystem that owns the window
+	default:
+		if (gApplicationHandle != nullptr)
+			return gApplicationHandle->MessageHandler(hWnd, message, wParam, lParam);
+		return DefWindowProc(hWnd, message, wParam, lParam);
+	}
+}
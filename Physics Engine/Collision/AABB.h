@@ -0,0 +1,83 @@
+//=========================================================================================================
+// AABB.h: Axis Aligned Bounding Box and Supporting Functions
+// - Stored as the minimum and maximum corners, which makes overlap tests and merging cheap
+//=========================================================================================================
+// Header-only: All functions are defined here so the compiler can inline them at the call site
+//=========================================================================================================
+
+#ifndef _AABB_H_DEFINED_
+#define _AABB_H_DEFINED_
+
+#include "Vector3.h"
+
+#include <algorithm>
+
+class AABB
+{
+// ALLOW PUBLIC ACCESS. For simple, well-defined Class
+public:
+	Vector3f min;
+	Vector3f max;
+
+	//===============
+	// Constructors
+	//===============
+
+	// Default Constructor - Leaves Values Uninitialised (For Performance)
+#pragma warning(suppress: 26495)
+	constexpr AABB() noexcept {}
+
+	constexpr AABB(const Vector3f& minIn, const Vector3f& maxIn) noexcept : min(minIn), max(maxIn) {}
+
+	//==========================
+	// Other Member Functions
+	//==========================
+
+	constexpr Vector3f Centre() const noexcept { return (min + max) * 0.5f; }
+	constexpr Vector3f Extents() const noexcept { return (max - min) * 0.5f; } // Half size on each axis
+
+	// Surface area - the cost measure used to build bounding volume trees (see DynamicTree.h)
+	constexpr float SurfaceArea() const noexcept
+	{
+		Vector3f d = max - min;
+		return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	// Box grown by margin on all sides
+	constexpr AABB Expanded(float margin) const noexcept
+	{
+		return { min - Vector3f(margin, margin, margin), max + Vector3f(margin, margin, margin) };
+	}
+
+	// True if b is entirely inside this box
+	constexpr bool Contains(const AABB& b) const noexcept
+	{
+		return min.x <= b.min.x && min.y <= b.min.y && min.z <= b.min.z &&
+		       max.x >= b.max.x && max.y >= b.max.y && max.z >= b.max.z;
+	}
+};
+
+
+//========================
+// Non-Member Functions
+//========================
+
+// True if the boxes overlap or touch
+constexpr bool Overlaps(const AABB& a, const AABB& b) noexcept
+{
+	return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+	       a.min.y <= b.max.y && a.max.y >= b.min.y &&
+	       a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+// Smallest box containing both boxes
+inline AABB Union(const AABB& a, const AABB& b) noexcept
+{
+	return
+	{
+		{ std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z) },
+		{ std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z) }
+	};
+}
+
+#endif // !_AABB_H_DEFINED_
@@ -0,0 +1,21 @@
+//=========================================================================================================
+// Broadphase.cpp: Common Interface for Broadphase Collision Detection
+//=========================================================================================================
+
+#include "Broadphase.h"
+
+#include "DynamicTree.h"
+#include "SweepAndPrune.h"
+
+//=================
+// Construction
+//=================
+
+std::unique_ptr<Broadphase> CreateBroadphase(BroadphaseType type)
+{
+	switch (type)
+	{
+	case BroadphaseType::SweepAndPrune: return std::make_unique<SweepAndPrune>();
+	default:                            return std::make_unique<DynamicTree>();
+	}
+}
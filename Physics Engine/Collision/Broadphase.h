@@ -0,0 +1,72 @@
+//=========================================================================================================
+// Broadphase.h: Common Interface for Broadphase Collision Detection
+// - The broadphase finds pairs of objects whose bounding boxes overlap, so the more expensive exact
+//   collision tests only run on objects that might actually be touching
+// - Each object is a "proxy" with an AABB and a user value (e.g. a body index) that is reported in pairs
+// - Implementations:
+//     DynamicTree (DynamicTree.h)     - best for scenes that are mostly static
+//     SweepAndPrune (SweepAndPrune.h) - best when most objects move every step (particles, debris)
+//=========================================================================================================
+
+#ifndef _BROADPHASE_H_DEFINED_
+#define _BROADPHASE_H_DEFINED_
+
+#include "AABB.h"
+#include "JobSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Pair of overlapping proxies, given as their user values
+struct BroadphasePair
+{
+	uint32_t a;
+	uint32_t b;
+};
+
+class Broadphase
+{
+public:
+	static constexpr uint32_t NullProxy = 0xFFFFFFFF;
+
+	virtual ~Broadphase() {}
+
+	// Add an object, returns the id used to move / destroy it
+	virtual uint32_t CreateProxy(const AABB& box, uint32_t userValue) = 0;
+	virtual void DestroyProxy(uint32_t proxy) = 0;
+
+	// Update an object's box. Displacement is how far it moved this step, used to predict where it's going
+	virtual void MoveProxy(uint32_t proxy, const AABB& box, const Vector3f& displacement) = 0;
+
+	// Replace the contents of "pairs" with every pair of proxies whose boxes overlap, each pair once
+	// Boxes may be enlarged by the implementation, so some pairs may not quite touch
+	virtual void FindPairs(std::vector<BroadphasePair>& pairs) = 0;
+
+	// Replace the contents of "userValues" with the user value of every proxy whose box overlaps the given
+	// box, e.g. for a body's swept path. Boxes may be enlarged as with FindPairs
+	virtual void FindOverlaps(const AABB& box, std::vector<uint32_t>& userValues) const = 0;
+
+	virtual std::size_t ProxyCount() const = 0;
+
+	// Run any work split between threads as jobs on the given system (JobSystem.h), rather than on threads
+	// started for it. Null to go back. Implementations that don't use threads ignore it
+	virtual void SetJobSystem(JobSystem* /*jobs*/) {}
+};
+
+
+//=================
+// Construction
+//=================
+
+enum class BroadphaseType
+{
+	DynamicTree,
+	SweepAndPrune,
+};
+
+// Create a broadphase of the given type with default settings
+std::unique_ptr<Broadphase> CreateBroadphase(BroadphaseType type);
+
+#endif // !_BROADPHASE_H_DEFINED_
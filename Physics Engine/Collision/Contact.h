@@ -0,0 +1,29 @@
+//=========================================================================================================
+// Contact.h: Contact Points Found by the Narrowphase
+// - One normal shared by up to four points, enough to hold a face resting on a face steady
+//=========================================================================================================
+
+#ifndef _CONTACT_H_DEFINED_
+#define _CONTACT_H_DEFINED_
+
+#include "Vector3.h"
+
+#include <cstdint>
+
+struct ContactPoint
+{
+	Vector3f position;  // World space, midway between the two surfaces
+	float depth;        // Penetration depth, negative if the shapes are apart (within the contact margin)
+	uint32_t featureId; // Identifies the features touching, so the point can be matched next step. 0 if unknown
+};
+
+struct Contact
+{
+	static constexpr int MaxPoints = 4;
+
+	Vector3f normal;    // World space, unit length, from shape A towards shape B
+	int pointCount = 0;
+	ContactPoint points[MaxPoints];
+};
+
+#endif // !_CONTACT_H_DEFINED_
@@ -0,0 +1,115 @@
+//=========================================================================================================
+// ContactBatch.cpp: Batch Storage, Scalar and SSE2 Batched Kernels, Kernel Dispatch
+//=========================================================================================================
+
+#include "ContactBatch.h"
+#include "ContactLanes.h"
+#include "SIMDFloat.h"
+
+#include <utility>
+
+//=====================
+// Storage
+//=====================
+
+ContactBatch::ContactBatch(ContactKernel kernel) : mKernel(kernel) {}
+
+void ContactBatch::Add(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB)
+{
+	const bool swapped = b.type < a.type;
+	const Pair& pair = swapped ? mPairs.emplace_back(Pair{ b, a, transformB, transformA })
+	                           : mPairs.emplace_back(Pair{ a, b, transformA, transformB });
+	mSwapped.push_back(swapped ? 1 : 0);
+
+	// Grow a whole set of lanes at a time, the padding is zeros
+	const std::size_t i = mPairs.size() - 1;
+	if (i % MaxLanes == 0)
+	{
+		for (auto& shape : mData)
+			for (auto& component : shape)
+				component.resize(i + MaxLanes, 0.0f);
+	}
+
+	const ShapeLanes<float> lanes[2] = { ScalarShape(pair.a, pair.transformA), ScalarShape(pair.b, pair.transformB) };
+	for (int s = 0; s < 2; ++s)
+	{
+		auto* data = mData[s];
+		data[PositionX][i] = lanes[s].position.x;
+		data[PositionY][i] = lanes[s].position.y;
+		data[PositionZ][i] = lanes[s].position.z;
+		for (int k = 0; k < 3; ++k)
+		{
+			data[AxisXX + k * 3][i] = lanes[s].axes[k].x;
+			data[AxisXY + k * 3][i] = lanes[s].axes[k].y;
+			data[AxisXZ + k * 3][i] = lanes[s].axes[k].z;
+		}
+		data[SizeX][i] = lanes[s].size[0];
+		data[SizeY][i] = lanes[s].size[1];
+		data[SizeZ][i] = lanes[s].size[2];
+		data[Radius][i] = lanes[s].radius;
+	}
+}
+
+void ContactBatch::Clear()
+{
+	mPairs.clear();
+	mSwapped.clear();
+	for (auto& shape : mData)
+		for (auto& component : shape)
+			component.clear();
+}
+
+
+//=====================
+// Kernel Tables
+//=====================
+
+static const ContactBatchKernels gScalarContactBatchKernels =
+{
+	SphereSphereBatch<float>, SphereCapsuleBatch<float>, CapsuleCapsuleBatch<float>, SphereBoxBatch<float>, BoxBoxBatch<float>
+};
+
+#if defined(MATHS_SIMD_X86)
+
+static const ContactBatchKernels gSSE2ContactBatchKernels =
+{
+	SphereSphereBatch<Float4>, SphereCapsuleBatch<Float4>, CapsuleCapsuleBatch<Float4>, SphereBoxBatch<Float4>, BoxBoxBatch<Float4>
+};
+
+// ContactBatch_AVX2.cpp
+extern const ContactBatchKernels gAVX2ContactBatchKernels;
+
+#endif
+
+const ContactBatchKernels& GetContactBatchKernels(SIMDLevel level)
+{
+	if (level > DetectSIMDLevel())
+		level = DetectSIMDLevel();
+
+#if defined(MATHS_SIMD_X86)
+	if (level == SIMDLevel::AVX2)
+		return gAVX2ContactBatchKernels;
+	if (level == SIMDLevel::SSE2)
+		return gSSE2ContactBatchKernels;
+#endif
+	return gScalarContactBatchKernels;
+}
+
+const ContactBatchKernels& GetContactBatchKernels()
+{
+	static const ContactBatchKernels& kernels = GetContactBatchKernels(DetectSIMDLevel());
+	return kernels;
+}
+
+void CollideBatch(const ContactBatch& batch, float margin, Contact* contacts, const ContactBatchKernels& kernels)
+{
+	switch (batch.Kernel())
+	{
+	case ContactKernel::SphereSphere:   kernels.sphereSphere(batch, margin, contacts); break;
+	case ContactKernel::SphereCapsule:  kernels.sphereCapsule(batch, margin, contacts); break;
+	case ContactKernel::CapsuleCapsule: kernels.capsuleCapsule(batch, margin, contacts); break;
+	case ContactKernel::SphereBox:      kernels.sphereBox(batch, margin, contacts); break;
+	case ContactKernel::BoxBox:         kernels.boxBox(batch, margin, contacts); break;
+	case ContactKernel::Convex:         break;
+	}
+}
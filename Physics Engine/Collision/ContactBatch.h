@@ -0,0 +1,109 @@
+//=========================================================================================================
+// ContactBatch.h: Many Pairs of One Shape Pair Type, Collided Four or Eight at a Time
+// - Pairs are stored as Structure-of-Arrays (all the x positions together...) so the kernels of
+//   ContactKernels.h can run on a pair per SIMD lane: SSE2 four lanes, AVX2 eight lanes, chosen at runtime
+//   the same way as the matrix kernels (see MathsSIMD.h)
+// - Results are the same as calling the kernel for each pair. Rare cases that need more than the
+//   branch-free maths (box contacts after the separating axis test, parallel capsules) are finished one
+//   lane at a time by the scalar code
+//=========================================================================================================
+
+#ifndef _CONTACT_BATCH_H_DEFINED_
+#define _CONTACT_BATCH_H_DEFINED_
+
+#include "ContactKernels.h"
+#include "MathsSIMD.h" // For SIMDLevel
+#include "AlignedAllocator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ContactBatch
+{
+public:
+	// Lanes of the widest kernels - arrays are padded to a multiple of this so every load is whole
+	static constexpr std::size_t MaxLanes = 8;
+
+	// Per pair values stored for each of the two shapes
+	enum Component
+	{
+		PositionX, PositionY, PositionZ,
+		AxisXX, AxisXY, AxisXZ, // Shape's local axes in world space
+		AxisYX, AxisYY, AxisYZ,
+		AxisZX, AxisZY, AxisZZ,
+		SizeX, SizeY, SizeZ,    // Box half extents, capsule half height in y
+		Radius,
+		ComponentCount
+	};
+
+	//================
+	// Constructors
+	//================
+
+	// For any kernel except Convex
+	explicit ContactBatch(ContactKernel kernel);
+
+	//=================
+	// Pairs
+	//=================
+
+	// Shapes may be in either order, they must be the types of the batch's kernel. Contacts for the pair
+	// still have the normal from a to b
+	void Add(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB);
+	void Clear();
+
+	ContactKernel Kernel() const { return mKernel; }
+	std::size_t Size() const { return mPairs.size(); }
+
+	// Values for shape 0 or 1 of each pair, in kernel order (e.g. the sphere is shape 0 for SphereBox).
+	// Aligned and padded to a multiple of MaxLanes
+	const float* Data(int shape, Component component) const { return mData[shape][component].data(); }
+
+	// A pair as added, in kernel order
+	struct Pair
+	{
+		Shape a;
+		Shape b;
+		Transformf transformA;
+		Transformf transformB;
+	};
+	const Pair& GetPair(std::size_t i) const { return mPairs[i]; }
+
+	// True if the pair was added in the opposite order to the kernel, so its normal must be flipped back
+	bool Swapped(std::size_t i) const { return mSwapped[i] != 0; }
+
+private:
+	ContactKernel mKernel;
+	std::vector<Pair> mPairs;
+	std::vector<uint8_t> mSwapped; // Kept apart from the pairs so the kernels don't pull them into the cache
+	AlignedVector<float> mData[2][ComponentCount];
+};
+
+
+//=====================
+// Kernel Tables
+//=====================
+
+// Function table of batched kernels for one instruction set. Each fills contacts[i] for every pair i of
+// the batch, with pointCount 0 where the shapes are further apart than margin
+struct ContactBatchKernels
+{
+	void (*sphereSphere)(const ContactBatch& batch, float margin, Contact* contacts);
+	void (*sphereCapsule)(const ContactBatch& batch, float margin, Contact* contacts);
+	void (*capsuleCapsule)(const ContactBatch& batch, float margin, Contact* contacts);
+	void (*sphereBox)(const ContactBatch& batch, float margin, Contact* contacts);
+	void (*boxBox)(const ContactBatch& batch, float margin, Contact* contacts);
+};
+
+// Kernel table for a specific level - used to compare kernels against each other
+// Asking for an unsupported level returns the best supported level below it
+const ContactBatchKernels& GetContactBatchKernels(SIMDLevel level);
+
+// Kernel table for the best level on this CPU
+const ContactBatchKernels& GetContactBatchKernels();
+
+// Run the batch's kernel from the given table (the best one by default)
+void CollideBatch(const ContactBatch& batch, float margin, Contact* contacts, const ContactBatchKernels& kernels = GetContactBatchKernels());
+
+#endif // !_CONTACT_BATCH_H_DEFINED_
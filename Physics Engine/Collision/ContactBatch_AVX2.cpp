@@ -0,0 +1,24 @@
+//=========================================================================================================
+// ContactBatch_AVX2.cpp: Batched Contact Kernels Eight Pairs at a Time
+// - Only called after DetectSIMDLevel() has confirmed AVX2 and FMA are available
+// - Built with AVX2 code generation for this file only, as MathsSIMD_AVX2.cpp
+//=========================================================================================================
+
+#include "ContactBatch.h"
+
+#if defined(MATHS_SIMD_X86)
+
+#if !defined(_MSC_VER)
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "ContactLanes.h"
+#include "SIMDFloat8.h"
+
+extern const ContactBatchKernels gAVX2ContactBatchKernels;
+const ContactBatchKernels gAVX2ContactBatchKernels =
+{
+	SphereSphereBatch<Float8>, SphereCapsuleBatch<Float8>, CapsuleCapsuleBatch<Float8>, SphereBoxBatch<Float8>, BoxBoxBatch<Float8>
+};
+
+#endif // MATHS_SIMD_X86
@@ -0,0 +1,170 @@
+//=========================================================================================================
+// ContactCache.cpp: Persistent Contact Manifolds Between Steps, for Warm Starting the Solver
+//=========================================================================================================
+
+#include "ContactCache.h"
+
+#include <utility>
+
+//=================
+// Updating
+//=================
+
+void ContactCache::BeginStep()
+{
+	std::swap(mManifolds, mOldManifolds);
+	std::swap(mTable, mOldTable);
+	mManifolds.clear();
+	for (Slot& slot : mTable)
+		slot.key = EmptyKey;
+
+	mPointCount = 0;
+	mMatchedPointCount = 0;
+}
+
+ContactManifold& ContactCache::Add(uint32_t bodyA, uint32_t bodyB, const Contact& contact, bool warmStart)
+{
+	const bool swap = bodyB < bodyA;
+	ContactManifold& manifold = mManifolds.emplace_back();
+	manifold.bodyA = swap ? bodyB : bodyA;
+	manifold.bodyB = swap ? bodyA : bodyB;
+	manifold.normal = swap ? -contact.normal : contact.normal;
+	manifold.pointCount = contact.pointCount;
+	for (int i = 0; i < contact.pointCount; ++i)
+		manifold.points[i] = { contact.points[i], 0 };
+	mPointCount += contact.pointCount;
+
+	const uint64_t key = Key(bodyA, bodyB);
+	if (warmStart)
+	{
+		const uint32_t old = Lookup(mOldTable, key);
+		if (old != ~0u)
+			MatchPoints(manifold, mOldManifolds[old]);
+	}
+
+	Insert(key, static_cast<uint32_t>(mManifolds.size() - 1));
+	return manifold;
+}
+
+bool ContactCache::Keep(uint32_t bodyA, uint32_t bodyB)
+{
+	const uint64_t key = Key(bodyA, bodyB);
+	const uint32_t old = Lookup(mOldTable, key);
+	if (old == ~0u)
+		return false;
+
+	mManifolds.push_back(mOldManifolds[old]);
+	Insert(key, static_cast<uint32_t>(mManifolds.size() - 1));
+	return true;
+}
+
+void ContactCache::Clear()
+{
+	mManifolds.clear();
+	mOldManifolds.clear();
+	mTable.clear();
+	mOldTable.clear();
+	mPointCount = 0;
+	mMatchedPointCount = 0;
+}
+
+// Each new point takes the impulse of the old point with its feature id, or else the nearest old point
+// within the match distance. Each old point is used at most once
+void ContactCache::MatchPoints(ContactManifold& manifold, const ContactManifold& old)
+{
+	bool used[Contact::MaxPoints] = {};
+	const float matchDistanceSq = mMatchDistance * mMatchDistance;
+	for (int i = 0; i < manifold.pointCount; ++i)
+	{
+		ManifoldPoint& point = manifold.points[i];
+		int match = -1;
+		if (point.point.featureId != 0)
+		{
+			for (int j = 0; j < old.pointCount && match < 0; ++j)
+			{
+				if (!used[j] && old.points[j].point.featureId == point.point.featureId)
+					match = j;
+			}
+		}
+		if (match < 0)
+		{
+			float bestDistanceSq = matchDistanceSq;
+			for (int j = 0; j < old.pointCount; ++j)
+			{
+				const float distanceSq = (old.points[j].point.position - point.point.position).LengthSq();
+				if (!used[j] && distanceSq <= bestDistanceSq)
+				{
+					match = j;
+					bestDistanceSq = distanceSq;
+				}
+			}
+		}
+		if (match < 0)
+			continue;
+
+		used[match] = true;
+		point.normalImpulse = old.points[match].normalImpulse;
+		++mMatchedPointCount;
+	}
+}
+
+
+//=================
+// Access
+//=================
+
+const ContactManifold* ContactCache::Find(uint32_t bodyA, uint32_t bodyB) const
+{
+	const uint32_t manifold = Lookup(mTable, Key(bodyA, bodyB));
+	return manifold != ~0u ? &mManifolds[manifold] : nullptr;
+}
+
+
+//=================
+// Hash Table
+//=================
+
+uint32_t ContactCache::Lookup(const std::vector<Slot>& table, uint64_t key)
+{
+	if (table.empty())
+		return ~0u;
+
+	// Probe from the key's slot until it is found or an empty slot is reached
+	const std::size_t mask = table.size() - 1;
+	for (std::size_t slot = Hash(key, mask); ; slot = (slot + 1) & mask)
+	{
+		if (table[slot].key == key)
+			return table[slot].manifold;
+		if (table[slot].key == EmptyKey)
+			return ~0u;
+	}
+}
+
+void ContactCache::Insert(uint64_t key, uint32_t manifold)
+{
+	// Keep the table at most half full so probe sequences stay short, doubling it and reinserting the
+	// current manifolds when needed
+	if (2 * mManifolds.size() > mTable.size())
+	{
+		std::size_t size = mTable.empty() ? 64 : mTable.size();
+		while (2 * mManifolds.size() > size)
+			size *= 2;
+		mTable.assign(size, { EmptyKey, 0 });
+
+		const std::size_t mask = size - 1;
+		for (uint32_t i = 0; i < manifold; ++i)
+		{
+			const uint64_t existing = Key(mManifolds[i].bodyA, mManifolds[i].bodyB);
+			std::size_t slot = Hash(existing, mask);
+			while (mTable[slot].key != EmptyKey)
+				slot = (slot + 1) & mask;
+			mTable[slot] = { existing, i };
+		}
+	}
+
+	const std::size_t mask = mTable.size() - 1;
+	std::size_t slot = Hash(key, mask);
+	while (mTable[slot].key != EmptyKey)
+		slot = (slot + 1) & mask;
+	mTable[slot] = { key, manifold };
+}
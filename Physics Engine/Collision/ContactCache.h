@@ -0,0 +1,128 @@
+//=========================================================================================================
+// ContactCache.h: Persistent Contact Manifolds Between Steps, for Warm Starting the Solver
+// - A resting contact needs much the same impulses every step. Keeping each point's accumulated impulses
+//   from the last step and applying them before the solver iterates ("warm starting") means the solver
+//   only has to correct the small change, so stacks settle in a few iterations rather than dozens
+// - Manifolds are keyed on the pair of bodies. Each new point takes the normal impulse of the old point
+//   with the same feature id, or failing that the nearest old point within a match distance. Unmatched
+//   points start from zero. Only normal impulses are kept: friction in a resting stack isn't unique, and
+//   carrying it over lets a balanced friction load build up from step to step until it tips the stack
+// - Storage is double buffered: this step's manifolds are built in one array while last step's are looked
+//   up in the other. Each array has a flat open addressing hash table (linear probing) from the pair key
+//   to the manifold, so there are no per-manifold allocations and lookups touch one or two cache lines.
+//   Pairs that stopped touching simply aren't carried into the new array, so nothing is ever deleted
+//=========================================================================================================
+
+#ifndef _CONTACT_CACHE_H_DEFINED_
+#define _CONTACT_CACHE_H_DEFINED_
+
+#include "Contact.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ManifoldPoint
+{
+	ContactPoint point;
+	float normalImpulse; // Accumulated over the solver iterations, kept for the next step
+};
+
+struct ContactManifold
+{
+	uint32_t bodyA;        // Ids given to ContactCache::Add, bodyA < bodyB
+	uint32_t bodyB;
+	Vector3f normal;       // From body A towards body B
+	int pointCount;
+	ManifoldPoint points[Contact::MaxPoints];
+};
+
+class ContactCache
+{
+public:
+	//================
+	// Constructors
+	//================
+
+	// matchDistance: a new point without a matching feature id takes the impulses of an old point at most
+	//                this far away
+	explicit ContactCache(float matchDistance = 0.02f) : mMatchDistance(matchDistance) {}
+
+	//=================
+	// Updating
+	//=================
+
+	// Start a new step: the manifolds from the last step become the ones matched against, and the list of
+	// current manifolds is emptied
+	void BeginStep();
+
+	// Add the contact found between two bodies this step, with impulses carried over from the same pair's
+	// manifold last step. Each pair at most once per step. The bodies are any unique ids (e.g. handle
+	// slots); if bodyA > bodyB they are swapped and the contact's normal flipped
+	// warmStart false gives every point zero impulses
+	ContactManifold& Add(uint32_t bodyA, uint32_t bodyB, const Contact& contact, bool warmStart = true);
+
+	// Carry a pair's manifold over from last step unchanged, impulses and all, for bodies that haven't
+	// moved (e.g. asleep). False if the pair had no manifold last step
+	bool Keep(uint32_t bodyA, uint32_t bodyB);
+
+	// Forget all manifolds, e.g. after teleporting bodies
+	void Clear();
+
+	//=================
+	// Access
+	//=================
+
+	// This step's manifolds, in the order added. The solver writes the final impulses back into them
+	std::vector<ContactManifold>& Manifolds() { return mManifolds; }
+	const std::vector<ContactManifold>& Manifolds() const { return mManifolds; }
+	std::size_t Size() const { return mManifolds.size(); }
+
+	// This step's manifold for a pair of bodies (in either order), or null if they have none
+	const ContactManifold* Find(uint32_t bodyA, uint32_t bodyB) const;
+
+	// Points added since the last BeginStep (not counting kept manifolds), and how many of them took an old
+	// point's impulses
+	std::size_t PointCount() const { return mPointCount; }
+	std::size_t MatchedPointCount() const { return mMatchedPointCount; }
+
+private:
+	static uint64_t Key(uint32_t bodyA, uint32_t bodyB)
+	{
+		return bodyA < bodyB ? (static_cast<uint64_t>(bodyA) << 32) | bodyB : (static_cast<uint64_t>(bodyB) << 32) | bodyA;
+	}
+
+	// Multiplicative (Fibonacci) hashing, the high bits are well mixed for any pattern of body ids
+	static std::size_t Hash(uint64_t key, std::size_t mask)
+	{
+		return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+	}
+
+	// Hash table entry, key is EmptyKey if unused. The key is kept here so probing doesn't visit manifolds
+	struct Slot
+	{
+		uint64_t key;
+		uint32_t manifold;
+	};
+	static constexpr uint64_t EmptyKey = ~0ull;
+
+	// Index of the manifold with a key in a table, or ~0u if none
+	static uint32_t Lookup(const std::vector<Slot>& table, uint64_t key);
+	void Insert(uint64_t key, uint32_t manifold);
+
+	void MatchPoints(ContactManifold& manifold, const ContactManifold& old);
+
+private:
+	float mMatchDistance;
+
+	std::vector<ContactManifold> mManifolds;
+	std::vector<Slot> mTable; // Power of two size, at most half full
+
+	std::vector<ContactManifold> mOldManifolds;
+	std::vector<Slot> mOldTable;
+
+	std::size_t mPointCount = 0;
+	std::size_t mMatchedPointCount = 0;
+};
+
+#endif // !_CONTACT_CACHE_H_DEFINED_
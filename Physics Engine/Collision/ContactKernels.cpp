@@ -0,0 +1,422 @@
+//=========================================================================================================
+// ContactKernels.cpp: Scalar Sphere / Capsule / Box Kernels, Box Clipping and Shape Pair Dispatch
+// - The maths shared with the batched kernels is in ContactLanes.h, used here with one float lane
+//=========================================================================================================
+
+#include "ContactKernels.h"
+#include "ContactLanes.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace
+{
+	// Capsules lying along each other closer than this get a single point
+	const float MinCapsuleOverlap = 1e-3f;
+
+	// Feature ids of box contacts, top byte says which kind
+	const uint32_t BoxFaceFeature = 0x01000000;
+	const uint32_t BoxEdgeFeature = 0x02000000;
+
+	//=====================
+	// Capsules
+	//=====================
+
+	// Two points where b's segment lies along a's, at each end of the overlap, so a capsule lying on
+	// another doesn't roll about a single point. Falls back to the single closest point if the overlap
+	// is too short
+	void ParallelCapsuleContact(const ShapeLanes<float>& a, const ShapeLanes<float>& b, const PointContactLanes<float>& closest,
+	                            float margin, Contact& contact)
+	{
+		const Vector3f normal = ToVector3(closest.normal);
+		const Vector3f startA = ToVector3(CapsuleStart(a));
+		const Vector3f directionA = ToVector3(CapsuleDirection(a));
+		const Vector3N<float> startB = CapsuleStart(b);
+		const Vector3N<float> directionB = CapsuleDirection(b);
+
+		// Part of a's segment covered by b's, as 0 -> 1 along a
+		const float lengthSq = directionA.LengthSq();
+		float low = 0, high = 0;
+		if (lengthSq > 0)
+		{
+			const float t0 = Dot(ToVector3(startB) - startA, directionA) / lengthSq;
+			const float t1 = Dot(ToVector3(startB + directionB) - startA, directionA) / lengthSq;
+			low = std::fmax(0.0f, std::fmin(t0, t1));
+			high = std::fmin(1.0f, std::fmax(t0, t1));
+		}
+
+		contact.normal = normal;
+		contact.pointCount = 0;
+		if ((high - low) * std::sqrt(lengthSq) > MinCapsuleOverlap)
+		{
+			const float ends[2] = { low, high };
+			for (int i = 0; i < 2; ++i)
+			{
+				const Vector3f pointA = startA + directionA * ends[i];
+				const Vector3f pointB = ToVector3(ClosestPointOnSegment(ToLanes(pointA), startB, directionB));
+				const float depth = a.radius + b.radius - Dot(pointB - pointA, normal);
+				if (depth >= -margin)
+				{
+					const Vector3f position = (pointA + normal * a.radius + pointB - normal * b.radius) * 0.5f;
+					contact.points[contact.pointCount++] = { position, depth, static_cast<uint32_t>(i + 1) };
+				}
+			}
+		}
+
+		if (contact.pointCount == 0)
+			SetPointContact(normal, ToVector3(closest.position), closest.depth, contact);
+	}
+
+
+	//=====================
+	// Boxes
+	//=====================
+
+	struct Box
+	{
+		Vector3f centre;
+		Vector3f axes[3];
+		float extents[3];
+	};
+
+	Box ToBox(const ShapeLanes<float>& lanes)
+	{
+		Box box;
+		box.centre = ToVector3(lanes.position);
+		for (int k = 0; k < 3; ++k)
+		{
+			box.axes[k] = ToVector3(lanes.axes[k]);
+			box.extents[k] = lanes.size[k];
+		}
+		return box;
+	}
+
+	// Incident face vertices while clipping. Corners are 0-3, points cut by a side plane get the plane
+	// (1-4) in the second four bits and the corner they came from in the first
+	struct ClipVertex
+	{
+		Vector3f position;
+		uint32_t id;
+	};
+
+	// Keep the part of a polygon where Dot(p, normal) <= offset (Sutherland-Hodgman). Output has at most one
+	// more vertex than the input
+	int ClipPolygon(const ClipVertex* in, int count, const Vector3f& normal, float offset, uint32_t plane, ClipVertex* out)
+	{
+		int outCount = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			const ClipVertex& start = in[(i + count - 1) % count];
+			const ClipVertex& end = in[i];
+			const float startDistance = Dot(start.position, normal) - offset;
+			const float endDistance = Dot(end.position, normal) - offset;
+
+			if ((startDistance <= 0) != (endDistance <= 0))
+			{
+				const float t = startDistance / (startDistance - endDistance);
+				out[outCount++] = { start.position + (end.position - start.position) * t, (plane << 4) | (start.id & 0xF) };
+			}
+			if (endDistance <= 0)
+				out[outCount++] = end;
+		}
+		return outCount;
+	}
+
+	// Index of the point with the highest score, skipping those already chosen
+	template<typename Score> int BestPoint(int count, const int* chosen, int chosenCount, Score score)
+	{
+		int best = -1;
+		float bestScore = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			bool used = false;
+			for (int c = 0; c < chosenCount; ++c)
+				used = used || chosen[c] == i;
+
+			const float s = score(i);
+			if (!used && (best < 0 || s > bestScore))
+			{
+				best = i;
+				bestScore = s;
+			}
+		}
+		return best;
+	}
+
+	// Reduce to Contact::MaxPoints, keeping the area they cover as large as possible: the deepest point,
+	// the point furthest from it, then the points furthest to either side of the line between them
+	int ReducePoints(ContactPoint* points, int count, const Vector3f& normal)
+	{
+		if (count <= Contact::MaxPoints)
+			return count;
+
+		int chosen[Contact::MaxPoints];
+		chosen[0] = BestPoint(count, chosen, 0, [&](int i) { return points[i].depth; });
+
+		const Vector3f first = points[chosen[0]].position;
+		chosen[1] = BestPoint(count, chosen, 1, [&](int i) { return (points[i].position - first).LengthSq(); });
+
+		const Vector3f line = points[chosen[1]].position - first;
+		auto area = [&](int i) { return Dot(Cross(line, points[i].position - first), normal); };
+		chosen[2] = BestPoint(count, chosen, 2, area);
+		chosen[3] = BestPoint(count, chosen, 3, [&](int i) { return -area(i); });
+
+		ContactPoint kept[Contact::MaxPoints];
+		for (int i = 0; i < Contact::MaxPoints; ++i)
+			kept[i] = points[chosen[i]];
+		for (int i = 0; i < Contact::MaxPoints; ++i)
+			points[i] = kept[i];
+		return Contact::MaxPoints;
+	}
+
+	// Face of the reference box (0-2 its axis) against the face of the incident box most opposed to it.
+	// The incident face is clipped to the sides of the reference face, and clipped points no more than
+	// margin above the reference face are kept
+	bool FaceContact(const Box& reference, const Box& incident, int referenceAxis, bool referenceIsB, float margin, Contact& contact)
+	{
+		// Reference face normal, pointing towards the incident box
+		const bool referencePositive = Dot(incident.centre - reference.centre, reference.axes[referenceAxis]) >= 0;
+		const Vector3f normal = reference.axes[referenceAxis] * (referencePositive ? 1.0f : -1.0f);
+
+		int incidentAxis = 0;
+		for (int k = 1; k < 3; ++k)
+		{
+			if (std::abs(Dot(incident.axes[k], normal)) > std::abs(Dot(incident.axes[incidentAxis], normal)))
+				incidentAxis = k;
+		}
+		const bool incidentPositive = Dot(incident.axes[incidentAxis], normal) < 0;
+		const Vector3f incidentNormal = incident.axes[incidentAxis] * (incidentPositive ? 1.0f : -1.0f);
+		const Vector3f faceCentre = incident.centre + incidentNormal * incident.extents[incidentAxis];
+
+		const int u = (incidentAxis + 1) % 3;
+		const int v = (incidentAxis + 2) % 3;
+		const Vector3f du = incident.axes[u] * incident.extents[u];
+		const Vector3f dv = incident.axes[v] * incident.extents[v];
+
+		ClipVertex polygon[8] = { { faceCentre + du + dv, 0 }, { faceCentre - du + dv, 1 }, { faceCentre - du - dv, 2 }, { faceCentre + du - dv, 3 } };
+		ClipVertex clipped[8];
+		int count = 4;
+
+		// Sides of the reference face
+		uint32_t plane = 1;
+		for (int side = 1; side <= 2; ++side)
+		{
+			const int k = (referenceAxis + side) % 3;
+			for (float sign = 1; sign >= -1; sign -= 2)
+			{
+				const Vector3f sideNormal = reference.axes[k] * sign;
+				count = ClipPolygon(polygon, count, sideNormal, Dot(reference.centre, sideNormal) + reference.extents[k], plane++, clipped);
+				for (int i = 0; i < count; ++i)
+					polygon[i] = clipped[i];
+			}
+		}
+
+		// Faces are numbered 0-5 on each box as axis * 2 + 1 for the positive side, reference faces of b from 6
+		const uint32_t referenceFace = (referenceIsB ? 6 : 0) + referenceAxis * 2 + (referencePositive ? 1 : 0);
+		const uint32_t incidentFace = incidentAxis * 2 + (incidentPositive ? 1 : 0);
+		const uint32_t faceFeature = BoxFaceFeature | (referenceFace << 16) | (incidentFace << 8);
+
+		const float faceOffset = Dot(reference.centre, normal) + reference.extents[referenceAxis];
+		ContactPoint points[8];
+		int pointCount = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			const float separation = Dot(polygon[i].position, normal) - faceOffset;
+			if (separation <= margin)
+				points[pointCount++] = { polygon[i].position - normal * (separation * 0.5f), -separation, faceFeature | polygon[i].id };
+		}
+		if (pointCount == 0)
+			return false;
+
+		pointCount = ReducePoints(points, pointCount, normal);
+		contact.normal = referenceIsB ? -normal : normal;
+		contact.pointCount = pointCount;
+		for (int i = 0; i < pointCount; ++i)
+			contact.points[i] = points[i];
+		return true;
+	}
+
+	// Edge of a along its axis edgeA against edge of b along its axis edgeB: the closest points of the
+	// two edges nearest each other along the separating direction
+	bool EdgeContact(const Box& a, const Box& b, int edgeA, int edgeB, float margin, Contact& contact)
+	{
+		Vector3f normal = Normalise(Cross(a.axes[edgeA], b.axes[edgeB]));
+		if (Dot(normal, b.centre - a.centre) < 0)
+			normal = -normal;
+
+		// Edge of a furthest along the normal, edge of b furthest against it. Ids are the axis and which of
+		// the four parallel edges
+		Vector3f middleA = a.centre;
+		Vector3f middleB = b.centre;
+		uint32_t idA = edgeA << 2;
+		uint32_t idB = edgeB << 2;
+		for (int k = 0, bitA = 0, bitB = 0; k < 3; ++k)
+		{
+			if (k != edgeA)
+			{
+				const bool positive = Dot(a.axes[k], normal) >= 0;
+				middleA += a.axes[k] * (positive ? a.extents[k] : -a.extents[k]);
+				idA |= (positive ? 1u : 0u) << bitA++;
+			}
+			if (k != edgeB)
+			{
+				const bool positive = Dot(b.axes[k], normal) <= 0;
+				middleB += b.axes[k] * (positive ? b.extents[k] : -b.extents[k]);
+				idB |= (positive ? 1u : 0u) << bitB++;
+			}
+		}
+
+		const Vector3f halfA = a.axes[edgeA] * a.extents[edgeA];
+		const Vector3f halfB = b.axes[edgeB] * b.extents[edgeB];
+		Vector3N<float> closestA, closestB;
+		ClosestSegmentPoints(ToLanes(middleA - halfA), ToLanes(halfA * 2.0f), ToLanes(middleB - halfB), ToLanes(halfB * 2.0f), 0.0f, closestA, closestB);
+
+		const float separation = Dot(ToVector3(closestB) - ToVector3(closestA), normal);
+		if (separation > margin)
+			return false;
+
+		contact.normal = normal;
+		contact.pointCount = 1;
+		contact.points[0] = { (ToVector3(closestA) + ToVector3(closestB)) * 0.5f, -separation, BoxEdgeFeature | (idA << 8) | idB };
+		return true;
+	}
+
+
+	//=====================
+	// Dispatch
+	//=====================
+
+	using CollideFunction = bool (*)(const Shape&, const Transformf&, const Shape&, const Transformf&, Contact&, GJKCache*, float);
+
+	template<ContactKernel K>
+	bool RunKernel(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB, Contact& contact, GJKCache* cache, float margin)
+	{
+		if constexpr (K == ContactKernel::SphereSphere)   return CollideSpheres(a, transformA, b, transformB, contact, margin);
+		if constexpr (K == ContactKernel::SphereCapsule)  return CollideSphereCapsule(a, transformA, b, transformB, contact, margin);
+		if constexpr (K == ContactKernel::CapsuleCapsule) return CollideCapsules(a, transformA, b, transformB, contact, margin);
+		if constexpr (K == ContactKernel::SphereBox)      return CollideSphereBox(a, transformA, b, transformB, contact, margin);
+		if constexpr (K == ContactKernel::BoxBox)         return CollideBoxes(a, transformA, b, transformB, contact, margin);
+		if constexpr (K == ContactKernel::Convex)         return CollideConvex(a, transformA, b, transformB, contact, cache, margin);
+	}
+
+	// Entry for one pair of shape types. Kernels take their shapes in type order, so pairs the other way
+	// round are swapped and the normal flipped back. GJK takes either order and keeps its cache the same way
+	template<ShapeType A, ShapeType B>
+	bool CollidePair(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB, Contact& contact, GJKCache* cache, float margin)
+	{
+		constexpr ContactKernel kernel = KernelFor(A, B);
+		if constexpr (kernel != ContactKernel::Convex && B < A)
+		{
+			if (!RunKernel<kernel>(b, transformB, a, transformA, contact, cache, margin))
+				return false;
+
+			contact.normal = -contact.normal;
+			return true;
+		}
+		else
+		{
+			return RunKernel<kernel>(a, transformA, b, transformB, contact, cache, margin);
+		}
+	}
+
+	template<std::size_t... I>
+	constexpr std::array<CollideFunction, sizeof...(I)> MakeCollideTable(std::index_sequence<I...>)
+	{
+		return { &CollidePair<static_cast<ShapeType>(I / ShapeTypeCount), static_cast<ShapeType>(I % ShapeTypeCount)>... };
+	}
+
+	// Indexed by type of a * ShapeTypeCount + type of b
+	constexpr std::array<CollideFunction, ShapeTypeCount * ShapeTypeCount> CollideTable =
+		MakeCollideTable(std::make_index_sequence<ShapeTypeCount * ShapeTypeCount>());
+}
+
+
+//=====================
+// Kernels
+//=====================
+
+bool CollideSpheres(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB, Contact& contact, float margin)
+{
+	const ShapeLanes<float> lanesA = ScalarShape(a, transformA);
+	const ShapeLanes<float> lanesB = ScalarShape(b, transformB);
+
+	PointContactLanes<float> result;
+	if (!SphereContactLanes(lanesA.position, lanesA.radius, lanesB.position, lanesB.radius, margin, result))
+		return false;
+
+	SetPointContact(ToVector3(result.normal), ToVector3(result.position), result.depth, contact);
+	return true;
+}
+
+bool CollideSphereCapsule(const Shape& sphere, const Transformf& transformA, const Shape& capsule, const Transformf& transformB, Contact& contact, float margin)
+{
+	PointContactLanes<float> result;
+	if (!SphereCapsuleContactLanes(ScalarShape(sphere, transformA), ScalarShape(capsule, transformB), margin, result))
+		return false;
+
+	SetPointContact(ToVector3(result.normal), ToVector3(result.position), result.depth, contact);
+	return true;
+}
+
+bool CollideCapsules(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB, Contact& contact, float margin)
+{
+	const ShapeLanes<float> lanesA = ScalarShape(a, transformA);
+	const ShapeLanes<float> lanesB = ScalarShape(b, transformB);
+
+	PointContactLanes<float> result;
+	bool parallel;
+	if (!CapsuleContactLanes(lanesA, lanesB, margin, result, parallel))
+		return false;
+
+	if (parallel)
+		ParallelCapsuleContact(lanesA, lanesB, result, margin, contact);
+	else
+		SetPointContact(ToVector3(result.normal), ToVector3(result.position), result.depth, contact);
+	return true;
+}
+
+bool CollideSphereBox(const Shape& sphere, const Transformf& transformA, const Shape& box, const Transformf& transformB, Contact& contact, float margin)
+{
+	PointContactLanes<float> result;
+	if (!SphereBoxContactLanes(ScalarShape(sphere, transformA), ScalarShape(box, transformB), margin, result))
+		return false;
+
+	SetPointContact(ToVector3(result.normal), ToVector3(result.position), result.depth, contact);
+	return true;
+}
+
+bool CollideBoxes(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB, Contact& contact, float margin)
+{
+	const ShapeLanes<float> lanesA = ScalarShape(a, transformA);
+	const ShapeLanes<float> lanesB = ScalarShape(b, transformB);
+
+	float axis;
+	if (BoxSeparationLanes(lanesA, lanesB, axis) > margin)
+		return false;
+
+	return BoxContactOnAxis(lanesA, lanesB, static_cast<int>(axis), margin, contact);
+}
+
+bool BoxContactOnAxis(const ShapeLanes<float>& a, const ShapeLanes<float>& b, int axis, float margin, Contact& contact)
+{
+	const Box boxA = ToBox(a);
+	const Box boxB = ToBox(b);
+	if (axis < 3)
+		return FaceContact(boxA, boxB, axis, false, margin, contact);
+	if (axis < 6)
+		return FaceContact(boxB, boxA, axis - 3, true, margin, contact);
+	return EdgeContact(boxA, boxB, (axis - 6) / 3, (axis - 6) % 3, margin, contact);
+}
+
+
+//=====================
+// Dispatch
+//=====================
+
+bool Collide(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB, Contact& contact,
+             GJKCache* cache, float margin)
+{
+	return CollideTable[static_cast<int>(a.type) * ShapeTypeCount + static_cast<int>(b.type)](a, transformA, b, transformB, contact, cache, margin);
+}
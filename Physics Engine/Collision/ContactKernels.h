@@ -0,0 +1,66 @@
+//=========================================================================================================
+// ContactKernels.h: Closed Form Contacts for Spheres, Capsules and Boxes, and Shape Pair Dispatch
+// - Most contacts are between these primitives, where a direct calculation is several times faster than
+//   GJK / EPA (GJK.h) and gives a full manifold rather than a single point:
+//     sphere - sphere, sphere - capsule: closest points, then as two spheres
+//     capsule - capsule:  closest points of the segments, two points when lying side by side
+//     sphere - box:       closest point on the box, or the nearest face if the centre is inside
+//     box - box:          separating axis test on the 15 axes, then the incident face clipped against the
+//                         reference face for up to four points, or closest points of two edges
+// - Collide() picks the kernel for any pair of shapes through a table built at compile time, with GJK /
+//   EPA for pairs without one (anything with a convex hull, capsule - box)
+// - Kernels take shapes in ShapeType order (sphere first...). Collide() swaps other pairs and flips the
+//   normal back, so its normal is always from a to b
+// - The same kernels process whole batches of pairs with SIMD, see ContactBatch.h
+//=========================================================================================================
+
+#ifndef _CONTACT_KERNELS_H_DEFINED_
+#define _CONTACT_KERNELS_H_DEFINED_
+
+#include "Contact.h"
+#include "GJK.h"
+#include "Shapes.h"
+
+#include <cstdint>
+
+enum class ContactKernel : uint8_t
+{
+	SphereSphere,
+	SphereCapsule,
+	CapsuleCapsule,
+	SphereBox,
+	BoxBox,
+	Convex, // GJK / EPA
+};
+
+// Kernel used for a pair of shape types, given in either order
+constexpr ContactKernel KernelFor(ShapeType a, ShapeType b)
+{
+	const ShapeType low = a < b ? a : b;
+	const ShapeType high = a < b ? b : a;
+	if (low == ShapeType::Sphere && high == ShapeType::Sphere) return ContactKernel::SphereSphere;
+	if (low == ShapeType::Sphere && high == ShapeType::Capsule) return ContactKernel::SphereCapsule;
+	if (low == ShapeType::Capsule && high == ShapeType::Capsule) return ContactKernel::CapsuleCapsule;
+	if (low == ShapeType::Sphere && high == ShapeType::Box) return ContactKernel::SphereBox;
+	if (low == ShapeType::Box && high == ShapeType::Box) return ContactKernel::BoxBox;
+	return ContactKernel::Convex;
+}
+
+
+//=====================
+// Kernels
+//=====================
+// Same conventions as CollideConvex: returns false (contact untouched) if the shapes are further apart
+// than margin, otherwise fills contact with the normal from a to b and up to four points
+
+bool CollideSpheres(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB, Contact& contact, float margin = 0);
+bool CollideSphereCapsule(const Shape& sphere, const Transformf& transformA, const Shape& capsule, const Transformf& transformB, Contact& contact, float margin = 0);
+bool CollideCapsules(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB, Contact& contact, float margin = 0);
+bool CollideSphereBox(const Shape& sphere, const Transformf& transformA, const Shape& box, const Transformf& transformB, Contact& contact, float margin = 0);
+bool CollideBoxes(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB, Contact& contact, float margin = 0);
+
+// Any two shapes, in any order. The cache is only used by pairs that fall back to GJK
+bool Collide(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB, Contact& contact,
+             GJKCache* cache = nullptr, float margin = 0);
+
+#endif // !_CONTACT_KERNELS_H_DEFINED_
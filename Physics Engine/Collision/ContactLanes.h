@@ -0,0 +1,512 @@
+//=========================================================================================================
+// ContactLanes.h: The Contact Kernels Written Once for Any Lane Type (internal to the Collision code)
+// - Templates on the lane type F: float for the scalar kernels (ContactKernels.cpp), Float4 / Float8 for
+//   batches (ContactBatch.cpp, ContactBatch_AVX2.cpp). Branches become Select() so every lane runs the
+//   same instructions, and the scalar and batched kernels give the same answers
+// - Shapes are reduced to a position, three world space axes, three sizes and a radius (ShapeLanes),
+//   which covers spheres, capsules (segment along axis y) and boxes
+//=========================================================================================================
+// Header-only: Templates, defined here so each kernel file can instantiate them for its own lane type
+//=========================================================================================================
+
+#ifndef _CONTACT_LANES_H_DEFINED_
+#define _CONTACT_LANES_H_DEFINED_
+
+#include "ContactBatch.h"
+#include "Contact.h"
+#include "Shapes.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+//=====================
+// Lane Helpers
+//=====================
+
+// Scalar versions of the Float4 / Float8 functions, so a float is a batch of one lane
+inline float Select(bool mask, float a, float b) { return mask ? a : b; }
+inline float Min(float a, float b) { return a < b ? a : b; }
+inline float Max(float a, float b) { return a > b ? a : b; }
+inline float Abs(float a) { return std::abs(a); }
+inline float Sqrt(float a) { return std::sqrt(a); }
+
+template<typename F> constexpr int LaneWidth = F::Width;
+template<> inline constexpr int LaneWidth<float> = 1;
+
+template<typename F> F LoadLanes(const float* p) { return F::Load(p); }
+template<> inline float LoadLanes<float>(const float* p) { return *p; }
+
+template<typename F> void StoreLanes(const F& lanes, float* p) { lanes.Store(p); }
+inline void StoreLanes(float lanes, float* p) { *p = lanes; }
+
+// Masks from comparisons are bools for float, otherwise F
+template<typename M> M And(const M& a, const M& b) { return a & b; }
+template<typename M> M Or(const M& a, const M& b) { return a | b; }
+inline bool And(bool a, bool b) { return a && b; }
+inline bool Or(bool a, bool b) { return a || b; }
+
+// One bit per lane from a mask, lane 0 in bit 0
+template<typename M> int LaneBits(const M& mask) { return MoveMask(mask); }
+inline int LaneBits(bool mask) { return mask ? 1 : 0; }
+
+template<typename F> F Clamp(const F& x, const F& low, const F& high) { return Min(Max(x, low), high); }
+
+
+//=====================
+// Lane Vectors
+//=====================
+
+// Vector3 with each component a lane type
+template<typename F> struct Vector3N
+{
+	F x, y, z;
+};
+
+template<typename F> Vector3N<F> operator+(const Vector3N<F>& a, const Vector3N<F>& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+template<typename F> Vector3N<F> operator-(const Vector3N<F>& a, const Vector3N<F>& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+template<typename F> Vector3N<F> operator-(const Vector3N<F>& a) { return { -a.x, -a.y, -a.z }; }
+template<typename F> Vector3N<F> operator*(const Vector3N<F>& a, const F& s) { return { a.x * s, a.y * s, a.z * s }; }
+
+template<typename F> F Dot(const Vector3N<F>& a, const Vector3N<F>& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+template<typename F> Vector3N<F> Cross(const Vector3N<F>& a, const Vector3N<F>& b)
+{
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+template<typename M, typename F> Vector3N<F> Select(const M& mask, const Vector3N<F>& a, const Vector3N<F>& b)
+{
+	return { Select(mask, a.x, b.x), Select(mask, a.y, b.y), Select(mask, a.z, b.z) };
+}
+
+inline Vector3f ToVector3(const Vector3N<float>& v) { return { v.x, v.y, v.z }; }
+inline Vector3N<float> ToLanes(const Vector3f& v) { return { v.x, v.y, v.z }; }
+
+
+//=====================
+// Shapes
+//=====================
+
+template<typename F> struct ShapeLanes
+{
+	Vector3N<F> position;
+	Vector3N<F> axes[3]; // Local x, y and z in world space
+	F size[3];           // Box half extents, capsule (0, half height, 0), sphere zero
+	F radius;
+};
+
+// A placed shape as a single lane. ContactBatch stores exactly these values, so a batch sees the same
+// numbers as the scalar kernel would
+inline ShapeLanes<float> ScalarShape(const Shape& shape, const Transformf& transform)
+{
+	ShapeLanes<float> lanes;
+	lanes.position = ToLanes(transform.position);
+	lanes.axes[0] = ToLanes(Rotate(transform.rotation, Vector3f{ 1, 0, 0 }));
+	lanes.axes[1] = ToLanes(Rotate(transform.rotation, Vector3f{ 0, 1, 0 }));
+	lanes.axes[2] = ToLanes(Rotate(transform.rotation, Vector3f{ 0, 0, 1 }));
+
+	const Vector3f size = shape.type == ShapeType::Box ? shape.halfExtents :
+	                      shape.type == ShapeType::Capsule ? Vector3f{ 0, shape.halfHeight, 0 } : Vector3f{ 0, 0, 0 };
+	lanes.size[0] = size.x;
+	lanes.size[1] = size.y;
+	lanes.size[2] = size.z;
+	lanes.radius = shape.radius;
+	return lanes;
+}
+
+// Shape 0 or 1 of pairs i onwards of a batch
+template<typename F> ShapeLanes<F> LoadShape(const ContactBatch& batch, int shape, std::size_t i)
+{
+	auto load = [&](ContactBatch::Component component) { return LoadLanes<F>(batch.Data(shape, component) + i); };
+
+	ShapeLanes<F> lanes;
+	lanes.position = { load(ContactBatch::PositionX), load(ContactBatch::PositionY), load(ContactBatch::PositionZ) };
+	for (int k = 0; k < 3; ++k)
+	{
+		const auto axis = static_cast<ContactBatch::Component>(ContactBatch::AxisXX + k * 3);
+		lanes.axes[k] = { load(axis), load(static_cast<ContactBatch::Component>(axis + 1)), load(static_cast<ContactBatch::Component>(axis + 2)) };
+	}
+	lanes.size[0] = load(ContactBatch::SizeX);
+	lanes.size[1] = load(ContactBatch::SizeY);
+	lanes.size[2] = load(ContactBatch::SizeZ);
+	lanes.radius = load(ContactBatch::Radius);
+	return lanes;
+}
+
+
+//=====================
+// Point Contacts
+//=====================
+// Kernels that give one point return the mask of lanes in contact (within margin) and fill a
+// PointContactLanes. Lanes that are not in contact hold meaningless values
+
+template<typename F> struct PointContactLanes
+{
+	Vector3N<F> normal; // From a to b
+	Vector3N<F> position;
+	F depth;
+};
+
+// Two spheres. Also the final step of the sphere / capsule kernels once the closest points are known
+// Concentric spheres get an arbitrary normal of +y
+template<typename F> auto SphereContactLanes(const Vector3N<F>& centreA, const F& radiusA, const Vector3N<F>& centreB, const F& radiusB,
+                                             const F& margin, PointContactLanes<F>& contact)
+{
+	const F zero(0.0f), one(1.0f), half(0.5f);
+
+	const Vector3N<F> d = centreB - centreA;
+	const F distance = Sqrt(Dot(d, d));
+	const auto apart = distance > zero;
+	contact.normal = Select(apart, d * (one / Select(apart, distance, one)), Vector3N<F>{ zero, one, zero });
+	contact.depth = radiusA + radiusB - distance;
+
+	// Half way between the two surfaces
+	contact.position = (centreA + contact.normal * radiusA + centreB - contact.normal * radiusB) * half;
+	return contact.depth >= -margin;
+}
+
+// Closest point to p on the segment start + t * direction, 0 <= t <= 1
+template<typename F> Vector3N<F> ClosestPointOnSegment(const Vector3N<F>& p, const Vector3N<F>& start, const Vector3N<F>& direction)
+{
+	const F zero(0.0f), one(1.0f);
+
+	const F lengthSq = Dot(direction, direction);
+	const F t = Clamp(Dot(p - start, direction) / Select(lengthSq > zero, lengthSq, one), zero, one);
+	return start + direction * t;
+}
+
+// Capsule segment as start + t * direction
+template<typename F> Vector3N<F> CapsuleStart(const ShapeLanes<F>& capsule) { return capsule.position - capsule.axes[1] * capsule.size[1]; }
+template<typename F> Vector3N<F> CapsuleDirection(const ShapeLanes<F>& capsule) { return capsule.axes[1] * (capsule.size[1] + capsule.size[1]); }
+
+template<typename F> auto SphereCapsuleContactLanes(const ShapeLanes<F>& sphere, const ShapeLanes<F>& capsule, const F& margin, PointContactLanes<F>& contact)
+{
+	const Vector3N<F> closest = ClosestPointOnSegment(sphere.position, CapsuleStart(capsule), CapsuleDirection(capsule));
+	return SphereContactLanes(sphere.position, sphere.radius, closest, capsule.radius, margin, contact);
+}
+
+// Closest points c1, c2 of the segments p1 + s * d1 and p2 + t * d2, 0 <= s, t <= 1 (Ericson, Real-Time
+// Collision Detection 5.1.9 with the branches as selects). Returns the mask of lanes where the segments
+// are parallel within the tolerance, where the closest points are not unique
+template<typename F> auto ClosestSegmentPoints(const Vector3N<F>& p1, const Vector3N<F>& d1, const Vector3N<F>& p2, const Vector3N<F>& d2,
+                                               const F& parallelTolerance, Vector3N<F>& c1, Vector3N<F>& c2)
+{
+	const F zero(0.0f), one(1.0f);
+
+	const Vector3N<F> r = p1 - p2;
+	const F a = Dot(d1, d1);
+	const F e = Dot(d2, d2);
+	const F b = Dot(d1, d2);
+	const F c = Dot(d1, r);
+	const F f = Dot(d2, r);
+	const F safeA = Select(a > zero, a, one);
+	const F safeE = Select(e > zero, e, one);
+
+	// Closest points of the infinite lines, s = 0 if they are parallel
+	const F denominator = a * e - b * b;
+	const auto skew = denominator > zero;
+	F s = Select(skew, Clamp((b * f - c * e) / Select(skew, denominator, one), zero, one), zero);
+
+	// Closest point on segment 2 to that, and back to segment 1 if it had to be clamped
+	F t = (b * s + f) / safeE;
+	s = Select(t < zero, Clamp(-c / safeA, zero, one), Select(t > one, Clamp((b - c) / safeA, zero, one), s));
+	t = Clamp(t, zero, one);
+
+	// Segments that are really points
+	s = Select(e > zero, s, Clamp(-c / safeA, zero, one));
+	s = Select(a > zero, s, zero);
+
+	c1 = p1 + d1 * s;
+	c2 = p2 + d2 * t;
+	return denominator <= parallelTolerance * a * e;
+}
+
+// Capsules whose segments are closer to parallel than this (1 - cos^2 of the angle) may lie along each
+// other, and get two points from the scalar kernel rather than the single closest point
+constexpr float CapsuleParallelTolerance = 1e-3f;
+
+template<typename F, typename M> auto CapsuleContactLanes(const ShapeLanes<F>& a, const ShapeLanes<F>& b, const F& margin,
+                                                          PointContactLanes<F>& contact, M& parallel)
+{
+	Vector3N<F> closestA, closestB;
+	parallel = ClosestSegmentPoints(CapsuleStart(a), CapsuleDirection(a), CapsuleStart(b), CapsuleDirection(b),
+	                                F(CapsuleParallelTolerance), closestA, closestB);
+	return SphereContactLanes(closestA, a.radius, closestB, b.radius, margin, contact);
+}
+
+// Sphere against a box. Outside the box it is a sphere against the closest point on the box, with the
+// centre inside the sphere is pushed out through the nearest face
+template<typename F> auto SphereBoxContactLanes(const ShapeLanes<F>& sphere, const ShapeLanes<F>& box, const F& margin, PointContactLanes<F>& contact)
+{
+	const F zero(0.0f), one(1.0f), half(0.5f);
+
+	// Sphere centre in box space, and the closest point of the box to it
+	const Vector3N<F> d = sphere.position - box.position;
+	F local[3], clamped[3];
+	for (int k = 0; k < 3; ++k)
+	{
+		local[k] = Dot(d, box.axes[k]);
+		clamped[k] = Clamp(local[k], -box.size[k], box.size[k]);
+	}
+	const auto inside = And(And(Abs(local[0]) <= box.size[0], Abs(local[1]) <= box.size[1]), Abs(local[2]) <= box.size[2]);
+
+	const Vector3N<F> closest = box.position + box.axes[0] * clamped[0] + box.axes[1] * clamped[1] + box.axes[2] * clamped[2];
+	PointContactLanes<F> outside;
+	const auto outsideHit = SphereContactLanes(sphere.position, sphere.radius, closest, zero, margin, outside);
+
+	// Face with the smallest gap to the centre
+	F gap = box.size[0] - Abs(local[0]);
+	F faceLocal = local[0];
+	Vector3N<F> faceAxis = box.axes[0];
+	for (int k = 1; k < 3; ++k)
+	{
+		const F kGap = box.size[k] - Abs(local[k]);
+		const auto closer = kGap < gap;
+		gap = Select(closer, kGap, gap);
+		faceLocal = Select(closer, local[k], faceLocal);
+		faceAxis = Select(closer, box.axes[k], faceAxis);
+	}
+
+	// The face points out of the box towards the sphere, so the normal from sphere to box is against it
+	const Vector3N<F> normal = faceAxis * Select(faceLocal >= zero, -one, one);
+	contact.normal = Select(inside, normal, outside.normal);
+	contact.depth = Select(inside, sphere.radius + gap, outside.depth);
+	contact.position = Select(inside, sphere.position + normal * ((sphere.radius - gap) * half), outside.position);
+
+	// Always touching with the centre inside
+	return Or(inside, outsideHit);
+}
+
+
+//=====================
+// Box Separating Axes
+//=====================
+
+// Face axis of b, or an edge axis, is only chosen over a face of a if it is better by these amounts, so
+// the contact doesn't flip between nearly equal axes from one step to the next
+constexpr float BoxFaceTolerance = 1e-3f;
+constexpr float BoxEdgeTolerance = 5e-3f;
+
+// Edge pairs closer to parallel than this (squared sine of the angle) are left to the face axes
+constexpr float BoxEdgeParallelTolerance = 1e-6f;
+
+// Separating axis test of two boxes on the 15 possible axes. Returns the largest separation (> 0 means
+// apart), and sets axis to the one to build contacts on: 0-2 faces of a, 3-5 faces of b, 6 + 3i + j the
+// edge direction of a's axis i crossed with b's axis j. Works in a's space so every axis only needs the
+// dot products of the two sets of axes (Gottschalk's OBB test)
+template<typename F> F BoxSeparationLanes(const ShapeLanes<F>& a, const ShapeLanes<F>& b, F& axis)
+{
+	const F one(1.0f);
+
+	// b's axes and position in a's space
+	F r[3][3], absR[3][3];
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			r[i][j] = Dot(a.axes[i], b.axes[j]);
+			absR[i][j] = Abs(r[i][j]);
+		}
+	}
+	const Vector3N<F> d = b.position - a.position;
+	const F t[3] = { Dot(d, a.axes[0]), Dot(d, a.axes[1]), Dot(d, a.axes[2]) };
+
+	// Faces of a
+	F faceA(0.0f), axisA(0.0f);
+	for (int i = 0; i < 3; ++i)
+	{
+		const F s = Abs(t[i]) - (a.size[i] + b.size[0] * absR[i][0] + b.size[1] * absR[i][1] + b.size[2] * absR[i][2]);
+		const auto better = s > faceA;
+		faceA = i == 0 ? s : Select(better, s, faceA);
+		axisA = i == 0 ? axisA : Select(better, F(static_cast<float>(i)), axisA);
+	}
+
+	// Faces of b
+	F faceB(0.0f), axisB(3.0f);
+	for (int j = 0; j < 3; ++j)
+	{
+		const F s = Abs(t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j]) -
+		            (b.size[j] + a.size[0] * absR[0][j] + a.size[1] * absR[1][j] + a.size[2] * absR[2][j]);
+		const auto better = s > faceB;
+		faceB = j == 0 ? s : Select(better, s, faceB);
+		axisB = j == 0 ? axisB : Select(better, F(static_cast<float>(3 + j)), axisB);
+	}
+
+	// Edge pairs, axis a(i) x b(j). Its length squared is 1 - r[i][j]^2
+	F edge(-FLT_MAX), axisEdge(6.0f);
+	for (int i = 0; i < 3; ++i)
+	{
+		const int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+		for (int j = 0; j < 3; ++j)
+		{
+			const int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+			const F lengthSq = one - r[i][j] * r[i][j];
+			const auto valid = lengthSq > F(BoxEdgeParallelTolerance);
+
+			const F distance = Abs(t[i2] * r[i1][j] - t[i1] * r[i2][j]);
+			const F projectionA = a.size[i1] * absR[i2][j] + a.size[i2] * absR[i1][j];
+			const F projectionB = b.size[j1] * absR[i][j2] + b.size[j2] * absR[i][j1];
+			const F s = Select(valid, (distance - projectionA - projectionB) / Sqrt(Select(valid, lengthSq, one)), F(-FLT_MAX));
+
+			const auto better = s > edge;
+			edge = Select(better, s, edge);
+			axisEdge = Select(better, F(static_cast<float>(6 + i * 3 + j)), axisEdge);
+		}
+	}
+
+	const auto useB = faceB > faceA + F(BoxFaceTolerance);
+	const F face = Select(useB, faceB, faceA);
+	const F axisFace = Select(useB, axisB, axisA);
+	axis = Select(edge > face + F(BoxEdgeTolerance), axisEdge, axisFace);
+	return Max(Max(faceA, faceB), edge);
+}
+
+// Contact points for two boxes known to be within margin, on an axis from BoxSeparationLanes. Face
+// axes clip the incident face against the reference face for up to four points, edge axes give the
+// closest points of the two edges. Returns false if no point ends up within margin (ContactKernels.cpp)
+bool BoxContactOnAxis(const ShapeLanes<float>& a, const ShapeLanes<float>& b, int axis, float margin, Contact& contact);
+
+
+//=====================
+// Batches
+//=====================
+// Batch kernels: run the lane kernels across a batch LaneWidth<F> pairs at a time. Arrays are padded
+// so the last loads are whole, the padding lanes are computed and thrown away
+
+inline void SetPointContact(const Vector3f& normal, const Vector3f& position, float depth, Contact& contact)
+{
+	contact.normal = normal;
+	contact.pointCount = 1;
+	contact.points[0] = { position, depth, 0 };
+}
+
+// Lanes of pairs from i that exist in the batch
+template<typename F> std::size_t BatchLanes(const ContactBatch& batch, std::size_t i)
+{
+	return std::min<std::size_t>(LaneWidth<F>, batch.Size() - i);
+}
+
+// Write one point per lane in contact (pointCount 0 for the others), normals back in the order the pairs
+// were added
+template<typename F, typename M> void StorePointContacts(const ContactBatch& batch, std::size_t i, const M& hit,
+                                                         const PointContactLanes<F>& lanes, Contact* contacts)
+{
+	constexpr int Width = LaneWidth<F>;
+	alignas(32) float values[7][Width];
+	StoreLanes(lanes.normal.x, values[0]);
+	StoreLanes(lanes.normal.y, values[1]);
+	StoreLanes(lanes.normal.z, values[2]);
+	StoreLanes(lanes.position.x, values[3]);
+	StoreLanes(lanes.position.y, values[4]);
+	StoreLanes(lanes.position.z, values[5]);
+	StoreLanes(lanes.depth, values[6]);
+
+	const int bits = LaneBits(hit);
+	const std::size_t count = BatchLanes<F>(batch, i);
+	for (std::size_t j = 0; j < count; ++j)
+	{
+		Contact& contact = contacts[i + j];
+		if (((bits >> j) & 1) == 0)
+		{
+			contact.pointCount = 0;
+			continue;
+		}
+
+		const float sign = batch.Swapped(i + j) ? -1.0f : 1.0f;
+		SetPointContact(Vector3f{ values[0][j], values[1][j], values[2][j] } * sign, { values[3][j], values[4][j], values[5][j] }, values[6][j], contact);
+	}
+}
+
+template<typename F> void SphereSphereBatch(const ContactBatch& batch, float margin, Contact* contacts)
+{
+	const F marginLanes(margin);
+	for (std::size_t i = 0; i < batch.Size(); i += LaneWidth<F>)
+	{
+		const ShapeLanes<F> a = LoadShape<F>(batch, 0, i);
+		const ShapeLanes<F> b = LoadShape<F>(batch, 1, i);
+
+		PointContactLanes<F> result;
+		const auto hit = SphereContactLanes(a.position, a.radius, b.position, b.radius, marginLanes, result);
+		StorePointContacts(batch, i, hit, result, contacts);
+	}
+}
+
+template<typename F> void SphereCapsuleBatch(const ContactBatch& batch, float margin, Contact* contacts)
+{
+	const F marginLanes(margin);
+	for (std::size_t i = 0; i < batch.Size(); i += LaneWidth<F>)
+	{
+		PointContactLanes<F> result;
+		const auto hit = SphereCapsuleContactLanes(LoadShape<F>(batch, 0, i), LoadShape<F>(batch, 1, i), marginLanes, result);
+		StorePointContacts(batch, i, hit, result, contacts);
+	}
+}
+
+template<typename F> void CapsuleCapsuleBatch(const ContactBatch& batch, float margin, Contact* contacts)
+{
+	const F marginLanes(margin);
+	for (std::size_t i = 0; i < batch.Size(); i += LaneWidth<F>)
+	{
+		PointContactLanes<F> result;
+		decltype(F() < F()) parallel;
+		const auto hit = CapsuleContactLanes(LoadShape<F>(batch, 0, i), LoadShape<F>(batch, 1, i), marginLanes, result, parallel);
+		StorePointContacts(batch, i, hit, result, contacts);
+
+		// Capsules lying along each other get their two points from the scalar kernel
+		const int sideBySide = LaneBits(And(hit, parallel));
+		const std::size_t count = BatchLanes<F>(batch, i);
+		for (std::size_t j = 0; j < count; ++j)
+		{
+			if ((sideBySide >> j) & 1)
+			{
+				const ContactBatch::Pair& pair = batch.GetPair(i + j);
+				CollideCapsules(pair.a, pair.transformA, pair.b, pair.transformB, contacts[i + j], margin);
+			}
+		}
+	}
+}
+
+template<typename F> void SphereBoxBatch(const ContactBatch& batch, float margin, Contact* contacts)
+{
+	const F marginLanes(margin);
+	for (std::size_t i = 0; i < batch.Size(); i += LaneWidth<F>)
+	{
+		PointContactLanes<F> result;
+		const auto hit = SphereBoxContactLanes(LoadShape<F>(batch, 0, i), LoadShape<F>(batch, 1, i), marginLanes, result);
+		StorePointContacts(batch, i, hit, result, contacts);
+	}
+}
+
+// The separating axis test rejects most pairs with SIMD, the few in contact are clipped one at a time
+template<typename F> void BoxBoxBatch(const ContactBatch& batch, float margin, Contact* contacts)
+{
+	const F marginLanes(margin);
+	for (std::size_t i = 0; i < batch.Size(); i += LaneWidth<F>)
+	{
+		F axis;
+		const F separation = BoxSeparationLanes(LoadShape<F>(batch, 0, i), LoadShape<F>(batch, 1, i), axis);
+		const int hit = LaneBits(separation <= marginLanes);
+
+		alignas(32) float axes[LaneWidth<F>];
+		StoreLanes(axis, axes);
+
+		const std::size_t count = BatchLanes<F>(batch, i);
+		for (std::size_t j = 0; j < count; ++j)
+		{
+			Contact& contact = contacts[i + j];
+			if (((hit >> j) & 1) == 0 ||
+			    !BoxContactOnAxis(LoadShape<float>(batch, 0, i + j), LoadShape<float>(batch, 1, i + j), static_cast<int>(axes[j]), margin, contact))
+			{
+				contact.pointCount = 0;
+			}
+			else if (batch.Swapped(i + j))
+			{
+				contact.normal = -contact.normal;
+			}
+		}
+	}
+}
+
+#endif // !_CONTACT_LANES_H_DEFINED_
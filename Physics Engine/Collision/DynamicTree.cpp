@@ -0,0 +1,393 @@
+//=========================================================================================================
+// DynamicTree.cpp: Dynamic AABB Tree Broadphase
+// - Insertion, removal and balancing follow the well known dynamic tree used in Box2D, in 3D
+//=========================================================================================================
+
+#include "DynamicTree.h"
+
+#include <algorithm>
+#include <cassert>
+
+DynamicTree::DynamicTree(float margin, float prediction)
+	: mMargin(margin), mPrediction(prediction)
+{
+}
+
+//=====================
+// Node Pool
+//=====================
+
+uint32_t DynamicTree::AllocateNode()
+{
+	if (mFreeList == NullProxy)
+	{
+		mNodes.push_back({});
+		mFreeList = static_cast<uint32_t>(mNodes.size() - 1);
+		mNodes[mFreeList].parent = NullProxy;
+	}
+
+	const uint32_t node = mFreeList;
+	mFreeList = mNodes[node].parent;
+
+	Node& n = mNodes[node];
+	n.parent = NullProxy;
+	n.child1 = NullProxy;
+	n.child2 = NullProxy;
+	n.height = 0;
+	n.userValue = 0;
+	return node;
+}
+
+void DynamicTree::BufferMove(uint32_t node)
+{
+	if (!mNodes[node].moved)
+	{
+		mNodes[node].moved = true;
+		mMoveBuffer.push_back(node);
+	}
+}
+
+// Leaves the moved flag alone - a destroyed proxy's node may be reused before FindPairs and its old pairs
+// must still be removed
+void DynamicTree::FreeNode(uint32_t node)
+{
+	mNodes[node].parent = mFreeList;
+	mNodes[node].height = -1;
+	mFreeList = node;
+}
+
+
+//=====================
+// Broadphase
+//=====================
+
+uint32_t DynamicTree::CreateProxy(const AABB& box, uint32_t userValue)
+{
+	const uint32_t proxy = AllocateNode();
+	mNodes[proxy].box = box.Expanded(mMargin);
+	mNodes[proxy].userValue = userValue;
+
+	InsertLeaf(proxy);
+	BufferMove(proxy);
+	++mProxyCount;
+	return proxy;
+}
+
+void DynamicTree::DestroyProxy(uint32_t proxy)
+{
+	assert(proxy < mNodes.size() && mNodes[proxy].IsLeaf() && mNodes[proxy].height == 0);
+
+	RemoveLeaf(proxy);
+	BufferMove(proxy);
+	FreeNode(proxy);
+	--mProxyCount;
+}
+
+void DynamicTree::MoveProxy(uint32_t proxy, const AABB& box, const Vector3f& displacement)
+{
+	assert(proxy < mNodes.size() && mNodes[proxy].IsLeaf());
+
+	// New fat box, extended in the direction of movement
+	AABB fat = box.Expanded(mMargin);
+	const Vector3f d = displacement * mPrediction;
+	if (d.x < 0) fat.min.x += d.x; else fat.max.x += d.x;
+	if (d.y < 0) fat.min.y += d.y; else fat.max.y += d.y;
+	if (d.z < 0) fat.min.z += d.z; else fat.max.z += d.z;
+
+	const AABB& treeBox = mNodes[proxy].box;
+	if (treeBox.Contains(box))
+	{
+		// Still inside the fat box, nothing to do unless the fat box has become much too large (e.g. the
+		// object was moving fast and has slowed down), as large boxes give false pairs
+		const AABB huge = fat.Expanded(4 * mMargin);
+		if (huge.Contains(treeBox))
+			return;
+	}
+
+	RemoveLeaf(proxy);
+	mNodes[proxy].box = fat;
+	InsertLeaf(proxy);
+	BufferMove(proxy);
+}
+
+void DynamicTree::FindPairs(std::vector<BroadphasePair>& pairs)
+{
+	if (!mMoveBuffer.empty())
+	{
+		// Drop every pair involving a moved node, then query the tree again for the ones still in use
+		mPairs.erase(std::remove_if(mPairs.begin(), mPairs.end(), [&](const BroadphasePair& p)
+		{
+			return mNodes[p.a].moved || mNodes[p.b].moved;
+		}), mPairs.end());
+
+		for (uint32_t proxy : mMoveBuffer)
+		{
+			const Node& node = mNodes[proxy];
+			if (node.height != 0) // Destroyed, or the node was reused inside the tree
+				continue;
+
+			Query(node.box, [&](uint32_t other)
+			{
+				// If both moved the pair is added by the lower index only
+				if (other != proxy && !(mNodes[other].moved && other < proxy))
+					mPairs.push_back({ std::min(proxy, other), std::max(proxy, other) });
+				return true;
+			});
+		}
+
+		for (uint32_t proxy : mMoveBuffer)
+			mNodes[proxy].moved = false;
+		mMoveBuffer.clear();
+	}
+
+	pairs.resize(mPairs.size());
+	for (std::size_t i = 0; i < mPairs.size(); ++i)
+		pairs[i] = { mNodes[mPairs[i].a].userValue, mNodes[mPairs[i].b].userValue };
+}
+
+void DynamicTree::FindOverlaps(const AABB& box, std::vector<uint32_t>& userValues) const
+{
+	userValues.clear();
+	Query(box, [&](uint32_t proxy)
+	{
+		userValues.push_back(mNodes[proxy].userValue);
+		return true;
+	});
+}
+
+
+//=====================
+// Insert / Remove
+//=====================
+
+void DynamicTree::InsertLeaf(uint32_t leaf)
+{
+	if (mRoot == NullProxy)
+	{
+		mRoot = leaf;
+		mNodes[leaf].parent = NullProxy;
+		return;
+	}
+
+	// Find the best sibling. At each node the choice is to make the leaf a sibling of this node (cost of
+	// a new parent enclosing both), or go down into a child. Every ancestor's box grows by the same amount
+	// whichever child is chosen, so that "inherited" cost is added to both children
+	const AABB leafBox = mNodes[leaf].box;
+	uint32_t index = mRoot;
+	while (!mNodes[index].IsLeaf())
+	{
+		const Node& node = mNodes[index];
+		const float area = node.box.SurfaceArea();
+		const float combinedArea = Union(node.box, leafBox).SurfaceArea();
+
+		const float cost = 2 * combinedArea;
+		const float inheritanceCost = 2 * (combinedArea - area);
+
+		auto childCost = [&](uint32_t child)
+		{
+			const Node& c = mNodes[child];
+			const float newArea = Union(leafBox, c.box).SurfaceArea();
+			return c.IsLeaf() ? newArea + inheritanceCost : (newArea - c.box.SurfaceArea()) + inheritanceCost;
+		};
+		const float cost1 = childCost(node.child1);
+		const float cost2 = childCost(node.child2);
+
+		if (cost < cost1 && cost < cost2)
+			break;
+
+		index = cost1 < cost2 ? node.child1 : node.child2;
+	}
+	const uint32_t sibling = index;
+
+	// New parent for the sibling and the leaf
+	const uint32_t oldParent = mNodes[sibling].parent;
+	const uint32_t newParent = AllocateNode();
+	mNodes[newParent].parent = oldParent;
+	mNodes[newParent].box = Union(leafBox, mNodes[sibling].box);
+	mNodes[newParent].height = mNodes[sibling].height + 1;
+	mNodes[newParent].child1 = sibling;
+	mNodes[newParent].child2 = leaf;
+	mNodes[sibling].parent = newParent;
+	mNodes[leaf].parent = newParent;
+
+	if (oldParent == NullProxy)
+	{
+		mRoot = newParent;
+	}
+	else
+	{
+		if (mNodes[oldParent].child1 == sibling)
+			mNodes[oldParent].child1 = newParent;
+		else
+			mNodes[oldParent].child2 = newParent;
+	}
+
+	FixUpwards(oldParent);
+}
+
+void DynamicTree::RemoveLeaf(uint32_t leaf)
+{
+	if (leaf == mRoot)
+	{
+		mRoot = NullProxy;
+		return;
+	}
+
+	// The leaf's parent is removed and the sibling takes its place
+	const uint32_t parent = mNodes[leaf].parent;
+	const uint32_t grandParent = mNodes[parent].parent;
+	const uint32_t sibling = mNodes[parent].child1 == leaf ? mNodes[parent].child2 : mNodes[parent].child1;
+
+	if (grandParent == NullProxy)
+	{
+		mRoot = sibling;
+		mNodes[sibling].parent = NullProxy;
+		FreeNode(parent);
+		return;
+	}
+
+	if (mNodes[grandParent].child1 == parent)
+		mNodes[grandParent].child1 = sibling;
+	else
+		mNodes[grandParent].child2 = sibling;
+	mNodes[sibling].parent = grandParent;
+	FreeNode(parent);
+
+	FixUpwards(grandParent);
+}
+
+void DynamicTree::FixUpwards(uint32_t node)
+{
+	while (node != NullProxy)
+	{
+		Node& n = mNodes[node];
+		const Node& c1 = mNodes[n.child1];
+		const Node& c2 = mNodes[n.child2];
+		n.height = 1 + std::max(c1.height, c2.height);
+		n.box = Union(c1.box, c2.box);
+
+		Rotate(node);
+		node = n.parent;
+	}
+}
+
+
+//=====================
+// Rotations
+//=====================
+
+// Tree rotations: swap a child of A with one of its grandchildren if that reduces the area of the internal
+// nodes. A and the node that was moved into stay where they are, only their contents change, e.g.
+//   Before: A = (B, C), C = (F, G)
+//   After:  A = (F, C), C = (B, G)   - swap B and F, if area(B + G) is less than area(C)
+// Balancing on area rather than height keeps the tree shallow where objects are dense without the
+// badly shaped boxes that purely height-based rotations can produce
+void DynamicTree::Rotate(uint32_t iA)
+{
+	Node& A = mNodes[iA];
+	if (A.height < 2)
+		return;
+
+	const uint32_t iB = A.child1;
+	const uint32_t iC = A.child2;
+
+	// Candidate swaps: child "iChild" of A with grandchild "iGrandChild" (a child of the other child
+	// "iParent"), reducing the parent's area by "saving"
+	uint32_t bestChild = NullProxy, bestGrandChild = NullProxy, bestParent = NullProxy;
+	float bestSaving = 0;
+
+	auto consider = [&](uint32_t iChild, uint32_t iParent)
+	{
+		const Node& parent = mNodes[iParent];
+		if (parent.IsLeaf())
+			return;
+
+		const float area = parent.box.SurfaceArea();
+		const AABB& childBox = mNodes[iChild].box;
+
+		// Swapping with child1 leaves child2 with the moved node, and vice versa
+		const float saving1 = area - Union(childBox, mNodes[parent.child2].box).SurfaceArea();
+		const float saving2 = area - Union(childBox, mNodes[parent.child1].box).SurfaceArea();
+		if (saving1 > bestSaving)
+		{
+			bestSaving = saving1;
+			bestChild = iChild; bestGrandChild = parent.child1; bestParent = iParent;
+		}
+		if (saving2 > bestSaving)
+		{
+			bestSaving = saving2;
+			bestChild = iChild; bestGrandChild = parent.child2; bestParent = iParent;
+		}
+	};
+	consider(iB, iC);
+	consider(iC, iB);
+
+	if (bestChild == NullProxy)
+		return;
+
+	// Swap child and grandchild
+	Node& parent = mNodes[bestParent];
+	if (A.child1 == bestChild) A.child1 = bestGrandChild; else A.child2 = bestGrandChild;
+	if (parent.child1 == bestGrandChild) parent.child1 = bestChild; else parent.child2 = bestChild;
+	mNodes[bestGrandChild].parent = iA;
+	mNodes[bestChild].parent = bestParent;
+
+	const Node& p1 = mNodes[parent.child1];
+	const Node& p2 = mNodes[parent.child2];
+	parent.box = Union(p1.box, p2.box);
+	parent.height = 1 + std::max(p1.height, p2.height);
+
+	// A's box is unchanged (it holds the same leaves), but its height may not be
+	A.height = 1 + std::max(mNodes[A.child1].height, mNodes[A.child2].height);
+}
+
+
+//=================
+// Tree Quality
+//=================
+
+float DynamicTree::AreaRatio() const
+{
+	if (mRoot == NullProxy)
+		return 0;
+
+	float totalArea = 0;
+	for (const Node& node : mNodes)
+	{
+		if (node.height > 0) // Internal nodes only, not leaves or free nodes
+			totalArea += node.box.SurfaceArea();
+	}
+	return totalArea / mNodes[mRoot].box.SurfaceArea();
+}
+
+bool DynamicTree::Validate() const
+{
+	if (mRoot == NullProxy)
+		return mProxyCount == 0;
+
+	std::size_t freeCount = 0;
+	for (uint32_t node = mFreeList; node != NullProxy; node = mNodes[node].parent)
+		++freeCount;
+
+	// Every node is either in the tree (proxyCount leaves, proxyCount - 1 internal) or free
+	return ValidateNode(mRoot, NullProxy) && freeCount + 2 * mProxyCount - 1 == mNodes.size();
+}
+
+bool DynamicTree::ValidateNode(uint32_t node, uint32_t parent) const
+{
+	const Node& n = mNodes[node];
+	if (n.parent != parent)
+		return false;
+
+	if (n.IsLeaf())
+		return n.child2 == NullProxy && n.height == 0;
+
+	const Node& c1 = mNodes[n.child1];
+	const Node& c2 = mNodes[n.child2];
+	if (n.height != 1 + std::max(c1.height, c2.height))
+		return false;
+	if (!n.box.Contains(c1.box) || !n.box.Contains(c2.box))
+		return false;
+
+	return ValidateNode(n.child1, node) && ValidateNode(n.child2, node);
+}
@@ -0,0 +1,145 @@
+//=========================================================================================================
+// DynamicTree.h: Dynamic AABB Tree Broadphase
+// - A binary tree of bounding boxes: leaves hold the objects, each parent's box encloses its children
+// - Leaves store "fat" boxes, enlarged by a margin and in the direction of movement, so an object can move
+//   a little without the tree changing. Only objects that leave their fat box are removed and reinserted
+// - Insertion walks down the tree choosing the cheaper child by the Surface Area Heuristic (the chance
+//   of a random query hitting a box is proportional to its surface area), then rotations on the way back
+//   up reduce the area further and keep the tree balanced
+// - The pair list is kept between steps. Only proxies that were created, destroyed or reinserted since the
+//   last FindPairs have their pairs recalculated (by querying the tree), so static objects cost nothing
+//=========================================================================================================
+
+#ifndef _DYNAMIC_TREE_H_DEFINED_
+#define _DYNAMIC_TREE_H_DEFINED_
+
+#include "Broadphase.h"
+
+#include <vector>
+
+class DynamicTree : public Broadphase
+{
+public:
+	//================
+	// Constructors
+	//================
+
+	// margin:     fat boxes are grown by this amount on all sides
+	// prediction: fat boxes are also grown by this multiple of the displacement passed to MoveProxy
+	explicit DynamicTree(float margin = 0.1f, float prediction = 2.0f);
+
+	//=====================
+	// Broadphase
+	//=====================
+
+	uint32_t CreateProxy(const AABB& box, uint32_t userValue) override;
+	void DestroyProxy(uint32_t proxy) override;
+	void MoveProxy(uint32_t proxy, const AABB& box, const Vector3f& displacement) override;
+	void FindPairs(std::vector<BroadphasePair>& pairs) override;
+	void FindOverlaps(const AABB& box, std::vector<uint32_t>& userValues) const override;
+	std::size_t ProxyCount() const override { return mProxyCount; }
+
+	//=================
+	// Queries
+	//=================
+
+	// Call callback(proxy) for every proxy whose fat box overlaps the given box
+	// The callback returns false to stop the query early
+	template<typename F> void Query(const AABB& box, F&& callback) const;
+
+	const AABB& FatAABB(uint32_t proxy) const { return mNodes[proxy].box; }
+	uint32_t UserValue(uint32_t proxy) const { return mNodes[proxy].userValue; }
+
+	//=================
+	// Tree Quality
+	//=================
+
+	// Height of the tree (0 for a single leaf), a balanced tree is around log2(ProxyCount)
+	int Height() const { return mRoot == NullProxy ? 0 : mNodes[mRoot].height; }
+
+	// Total surface area of all internal nodes divided by the root area. Lower is better
+	float AreaRatio() const;
+
+	// Check parent / child links, heights and boxes are consistent. Returns false if not (for debugging)
+	bool Validate() const;
+
+private:
+	struct Node
+	{
+		AABB box;
+		uint32_t parent;    // Next free node when this node is on the free list
+		uint32_t child1;    // NullProxy for leaves
+		uint32_t child2;
+		int height;         // Leaves are 0, -1 for free nodes
+		uint32_t userValue;
+		bool moved;         // In the move buffer, pairs involving this node are recalculated in FindPairs
+
+		bool IsLeaf() const { return child1 == NullProxy; }
+	};
+
+	uint32_t AllocateNode();
+	void FreeNode(uint32_t node);
+
+	void InsertLeaf(uint32_t leaf);
+	void RemoveLeaf(uint32_t leaf);
+
+	// Swap a child and grandchild of node if that reduces the total area of the subtree
+	void Rotate(uint32_t node);
+
+	// Recalculate boxes and heights from node up to the root, rotating on the way
+	void FixUpwards(uint32_t node);
+
+	void BufferMove(uint32_t node);
+
+	bool ValidateNode(uint32_t node, uint32_t parent) const;
+
+private:
+	std::vector<Node> mNodes;
+	uint32_t mRoot = NullProxy;
+	uint32_t mFreeList = NullProxy;
+	std::size_t mProxyCount = 0;
+
+	std::vector<uint32_t> mMoveBuffer;     // Nodes with moved set
+	std::vector<BroadphasePair> mPairs;    // Overlapping pairs as node indexes, a < b
+
+	float mMargin;
+	float mPrediction;
+};
+
+
+//=================
+// Queries
+//=================
+
+template<typename F> void DynamicTree::Query(const AABB& box, F&& callback) const
+{
+	if (mRoot == NullProxy)
+		return;
+
+	// Explicit stack rather than recursion, the callback may be called many times
+	uint32_t stack[256];
+	int stackSize = 0;
+	stack[stackSize++] = mRoot;
+
+	while (stackSize > 0)
+	{
+		const uint32_t index = stack[--stackSize];
+		const Node& node = mNodes[index];
+		if (!Overlaps(node.box, box))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			if (!callback(index))
+				return;
+		}
+		else
+		{
+			// Stack can hold a tree of height 255, rotations keep the tree far below that
+			stack[stackSize++] = node.child1;
+			stack[stackSize++] = node.child2;
+		}
+	}
+}
+
+#endif // !_DYNAMIC_TREE_H_DEFINED_
@@ -0,0 +1,586 @@
+//=========================================================================================================
+// GJK.cpp: Convex Shape Distance (GJK) and Penetration Depth (EPA)
+//=========================================================================================================
+
+#include "GJK.h"
+
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+	const int MaxGJKIterations = 32;
+	const int MaxEPAIterations = 64;
+
+	// Cores closer than this count as overlapping - the direction between them is too inaccurate to use
+	// as a normal, so EPA finds it instead
+	const float OverlapDistance = 1e-4f;
+
+	// GJK stops when a new support point gets the simplex closer to the origin by less than this fraction
+	// of the squared distance
+	const float GJKRelativeTolerance = 1e-5f;
+
+	// EPA stops when the surface of A - B is no more than this beyond the closest face
+	const float EPATolerance = 1e-4f;
+
+	// A new EPA point must be this far in front of a face to remove it. Boxes give many points in the same
+	// plane, and rounding would otherwise remove some of a flat region's faces but not others, folding the
+	// new faces back over the ones left
+	const float EPAVisibleTolerance = 1e-5f;
+
+
+	//=====================
+	// Minkowski Difference
+	//=====================
+
+	// Point of the Minkowski difference A - B with the points on A and B that made it. All in A's local space
+	struct SimplexVertex
+	{
+		Vector3f w;      // a - b
+		Vector3f a;
+		Vector3f b;
+		Vector3f localB; // b in B's local space, for the cache
+	};
+
+	// Support function of A - B, in A's local space
+	class MinkowskiDifference
+	{
+	public:
+		MinkowskiDifference(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB)
+			: mA(a), mB(b), mBToA(transformB * Inverse(transformA)), mAToB(Conjugate(mBToA.rotation)) {}
+
+		// Furthest point in the given direction, of the cores, or of the whole shapes if withRadius
+		SimplexVertex Support(const Vector3f& direction, bool withRadius) const
+		{
+			const Vector3f directionB = Rotate(mAToB, -direction);
+			SimplexVertex v;
+			v.a = withRadius ? mA.Support(direction) : mA.SupportCore(direction);
+			v.localB = withRadius ? mB.Support(directionB) : mB.SupportCore(directionB);
+			v.b = mBToA.TransformPoint(v.localB);
+			v.w = v.a - v.b;
+			return v;
+		}
+
+		// Rebuild a vertex from cached local points
+		SimplexVertex Vertex(const Vector3f& localA, const Vector3f& localB) const
+		{
+			SimplexVertex v;
+			v.a = localA;
+			v.localB = localB;
+			v.b = mBToA.TransformPoint(localB);
+			v.w = v.a - v.b;
+			return v;
+		}
+
+		Vector3f CentreOfB() const { return mBToA.position; }
+
+	private:
+		const Shape& mA;
+		const Shape& mB;
+		Transformf mBToA;
+		Quaternionf mAToB;
+	};
+
+
+	//=====================
+	// Simplex
+	//=====================
+
+	struct Simplex
+	{
+		SimplexVertex vertices[4];
+		float weights[4]; // Barycentric weights of the closest point to the origin
+		int count;
+	};
+
+	// Closest point to the origin on part of a simplex: the vertices of the smallest feature holding it,
+	// with their weights. A count of 4 means the origin is inside the tetrahedron
+	struct SimplexSolution
+	{
+		int count;
+		int indexes[3];
+		float weights[3];
+		Vector3f point;
+	};
+
+	SimplexSolution SolveVertex(const SimplexVertex* v, int i0)
+	{
+		return { 1, { i0, 0, 0 }, { 1, 0, 0 }, v[i0].w };
+	}
+
+	SimplexSolution SolveSegment(const SimplexVertex* v, int i0, int i1)
+	{
+		const Vector3f a = v[i0].w;
+		const Vector3f ab = v[i1].w - a;
+		const float lengthSq = Dot(ab, ab);
+		const float t = lengthSq > 0 ? -Dot(a, ab) / lengthSq : 0;
+		if (t <= 0)
+			return SolveVertex(v, i0);
+		if (t >= 1)
+			return SolveVertex(v, i1);
+		return { 2, { i0, i1, 0 }, { 1 - t, t, 0 }, a + ab * t };
+	}
+
+	SimplexSolution Closer(const SimplexSolution& s1, const SimplexSolution& s2)
+	{
+		return Dot(s1.point, s1.point) <= Dot(s2.point, s2.point) ? s1 : s2;
+	}
+
+	// Voronoi region tests from Ericson, "Real-Time Collision Detection" 5.1.5, with the origin as the point
+	SimplexSolution SolveTriangle(const SimplexVertex* v, int i0, int i1, int i2)
+	{
+		const Vector3f a = v[i0].w, b = v[i1].w, c = v[i2].w;
+		const Vector3f ab = b - a, ac = c - a;
+
+		const float d1 = -Dot(ab, a), d2 = -Dot(ac, a);
+		if (d1 <= 0 && d2 <= 0)
+			return SolveVertex(v, i0);
+
+		const float d3 = -Dot(ab, b), d4 = -Dot(ac, b);
+		if (d3 >= 0 && d4 <= d3)
+			return SolveVertex(v, i1);
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0 && d1 >= 0 && d3 <= 0)
+		{
+			const float t = d1 / (d1 - d3);
+			return { 2, { i0, i1, 0 }, { 1 - t, t, 0 }, a + ab * t };
+		}
+
+		const float d5 = -Dot(ab, c), d6 = -Dot(ac, c);
+		if (d6 >= 0 && d5 <= d6)
+			return SolveVertex(v, i2);
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0 && d2 >= 0 && d6 <= 0)
+		{
+			const float t = d2 / (d2 - d6);
+			return { 2, { i0, i2, 0 }, { 1 - t, t, 0 }, a + ac * t };
+		}
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0)
+		{
+			const float t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			return { 2, { i1, i2, 0 }, { 1 - t, t, 0 }, b + (c - b) * t };
+		}
+
+		// A triangle with no area can reach here, take its closest edge
+		const float sum = va + vb + vc;
+		if (!(sum > 0))
+			return Closer(Closer(SolveSegment(v, i0, i1), SolveSegment(v, i0, i2)), SolveSegment(v, i1, i2));
+
+		const float wb = vb / sum, wc = vc / sum;
+		return { 3, { i0, i1, i2 }, { 1 - wb - wc, wb, wc }, a + ab * wb + ac * wc };
+	}
+
+	SimplexSolution SolveTetrahedron(const SimplexVertex* v)
+	{
+		// Faces with the vertex opposite each
+		const int faces[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+
+		SimplexSolution best = {};
+		bool outside = false;
+		for (const int* face : faces)
+		{
+			// The origin is outside this face if it's on the other side of the face's plane to the opposite
+			// vertex. A flat tetrahedron counts as outside all its faces
+			const Vector3f a = v[face[0]].w;
+			const Vector3f normal = Cross(v[face[1]].w - a, v[face[2]].w - a);
+			if (-Dot(a, normal) * Dot(v[face[3]].w - a, normal) <= 0)
+			{
+				const SimplexSolution solution = SolveTriangle(v, face[0], face[1], face[2]);
+				best = outside ? Closer(best, solution) : solution;
+				outside = true;
+			}
+		}
+
+		if (!outside)
+			best.count = 4;
+		return best;
+	}
+
+	// Reduce the simplex to the smallest feature nearest the origin. Returns false if the origin is inside
+	bool Solve(Simplex& simplex, Vector3f& closest)
+	{
+		SimplexSolution solution;
+		switch (simplex.count)
+		{
+		case 1: solution = SolveVertex(simplex.vertices, 0); break;
+		case 2: solution = SolveSegment(simplex.vertices, 0, 1); break;
+		case 3: solution = SolveTriangle(simplex.vertices, 0, 1, 2); break;
+		default:
+			solution = SolveTetrahedron(simplex.vertices);
+			if (solution.count == 4)
+				return false;
+		}
+
+		SimplexVertex kept[3];
+		for (int i = 0; i < solution.count; ++i)
+			kept[i] = simplex.vertices[solution.indexes[i]];
+		for (int i = 0; i < solution.count; ++i)
+		{
+			simplex.vertices[i] = kept[i];
+			simplex.weights[i] = solution.weights[i];
+		}
+		simplex.count = solution.count;
+		closest = solution.point;
+		return true;
+	}
+
+
+	//=====================
+	// GJK
+	//=====================
+
+	// Run GJK on the cores, leaving the final simplex in "simplex". Results are in A's local space
+	GJKResult RunGJK(const MinkowskiDifference& difference, GJKCache* cache, Simplex& simplex)
+	{
+		GJKResult result = {};
+		if (cache != nullptr && cache->count > 0)
+		{
+			for (int i = 0; i < cache->count; ++i)
+				simplex.vertices[i] = difference.Vertex(cache->localA[i], cache->localB[i]);
+			simplex.count = cache->count;
+		}
+		else
+		{
+			// Start in the direction from B's centre to A's, the closest point of A - B is often that way
+			Vector3f direction = -difference.CentreOfB();
+			if (Dot(direction, direction) == 0)
+				direction = { 1, 0, 0 };
+			simplex.vertices[0] = difference.Support(direction, false);
+			simplex.count = 1;
+			result.iterations = 1;
+		}
+
+		Vector3f closest = { 0, 0, 0 };
+		float distanceSq = 0;
+		result.overlap = !Solve(simplex, closest);
+		while (!result.overlap)
+		{
+			distanceSq = Dot(closest, closest);
+			if (distanceSq <= OverlapDistance * OverlapDistance)
+			{
+				result.overlap = true;
+				break;
+			}
+			if (result.iterations >= MaxGJKIterations)
+				break;
+
+			// Stop when the support point in the direction of the origin gets no closer to it
+			const SimplexVertex v = difference.Support(-closest, false);
+			++result.iterations;
+			if (distanceSq - Dot(closest, v.w) <= GJKRelativeTolerance * distanceSq)
+				break;
+
+			// Rounding can make the test above miss a support point that's already in the simplex
+			bool duplicate = false;
+			for (int i = 0; i < simplex.count; ++i)
+				duplicate |= (simplex.vertices[i].w - v.w).LengthSq() == 0;
+			if (duplicate)
+				break;
+
+			// The new simplex must be closer. Near the end rounding in the solve can make it further away, then
+			// the current one is as good as it gets (and continuing can cycle)
+			Simplex next = simplex;
+			next.vertices[next.count++] = v;
+			Vector3f nextClosest;
+			if (!Solve(next, nextClosest))
+			{
+				simplex = next;
+				result.overlap = true;
+				break;
+			}
+			if (Dot(nextClosest, nextClosest) >= distanceSq)
+				break;
+			simplex = next;
+			closest = nextClosest;
+		}
+
+		result.distance = result.overlap ? 0 : std::sqrt(distanceSq);
+		result.pointA = { 0, 0, 0 };
+		result.pointB = { 0, 0, 0 };
+		if (!result.overlap)
+		{
+			for (int i = 0; i < simplex.count; ++i)
+			{
+				result.pointA += simplex.vertices[i].a * simplex.weights[i];
+				result.pointB += simplex.vertices[i].b * simplex.weights[i];
+			}
+		}
+
+		if (cache != nullptr)
+		{
+			cache->count = simplex.count;
+			for (int i = 0; i < simplex.count; ++i)
+			{
+				cache->localA[i] = simplex.vertices[i].a;
+				cache->localB[i] = simplex.vertices[i].localB;
+			}
+		}
+		return result;
+	}
+
+
+	//=====================
+	// EPA
+	//=====================
+
+	const int MaxEPAVertices = MaxEPAIterations + 4;
+	const int MaxEPAFaces = 2 * MaxEPAVertices;
+
+	struct EPAFace
+	{
+		int v[3]; // Wound so the normal faces out of the polytope
+		Vector3f normal;
+		float distance; // From the origin to the face's plane
+	};
+
+	struct EPAEdge
+	{
+		int a;
+		int b;
+	};
+
+	class Polytope
+	{
+	public:
+		SimplexVertex vertices[MaxEPAVertices];
+		EPAFace faces[MaxEPAFaces];
+		int vertexCount = 0;
+		int faceCount = 0;
+
+		void AddFace(int a, int b, int c)
+		{
+			EPAFace& face = faces[faceCount++];
+			face.v[0] = a; face.v[1] = b; face.v[2] = c;
+			const Vector3f n = Cross(vertices[b].w - vertices[a].w, vertices[c].w - vertices[a].w);
+			const float length = n.Length();
+			if (length > 0)
+			{
+				face.normal = n * (1 / length);
+				face.distance = Dot(face.normal, vertices[a].w);
+			}
+			else
+			{
+				// No area (new point in line with an edge), keeps the surface closed but is never the closest
+				face.normal = { 0, 0, 0 };
+				face.distance = FLT_MAX;
+			}
+		}
+
+		int ClosestFace() const
+		{
+			int closest = 0;
+			for (int f = 1; f < faceCount; ++f)
+			{
+				if (faces[f].distance < faces[closest].distance)
+					closest = f;
+			}
+			return closest;
+		}
+	};
+
+	// Grow a simplex holding the origin (possibly on its surface) into a tetrahedron. Returns false if A - B
+	// is flat and no tetrahedron fits inside it
+	bool FillTetrahedron(const MinkowskiDifference& difference, Simplex& simplex)
+	{
+		const float MinSeparation = 1e-6f;
+		const Vector3f axes[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+		SimplexVertex* v = simplex.vertices;
+
+		if (simplex.count == 1)
+		{
+			for (const Vector3f& axis : axes)
+			{
+				v[1] = difference.Support(axis, true);
+				if ((v[1].w - v[0].w).LengthSq() > MinSeparation)
+				{
+					simplex.count = 2;
+					break;
+				}
+			}
+		}
+
+		if (simplex.count == 2)
+		{
+			// Search around the segment for a point off its line
+			const Vector3f line = v[1].w - v[0].w;
+			const Vector3f absLine = { std::abs(line.x), std::abs(line.y), std::abs(line.z) };
+			const int smallest = absLine.x < absLine.y ? (absLine.x < absLine.z ? 0 : 2) : (absLine.y < absLine.z ? 1 : 2);
+			const Vector3f side1 = Normalise(Cross(line, axes[2 * smallest]));
+			const Vector3f side2 = Normalise(Cross(line, side1));
+			for (const Vector3f& direction : { side1, -side1, side2, -side2 })
+			{
+				v[2] = difference.Support(direction, true);
+				if (Cross(v[2].w - v[0].w, line).LengthSq() > MinSeparation * line.LengthSq())
+				{
+					simplex.count = 3;
+					break;
+				}
+			}
+		}
+
+		if (simplex.count == 3)
+		{
+			const Vector3f normal = Normalise(Cross(v[1].w - v[0].w, v[2].w - v[0].w));
+			for (const Vector3f& direction : { normal, -normal })
+			{
+				v[3] = difference.Support(direction, true);
+				if (std::abs(Dot(v[3].w - v[0].w, normal)) > MinSeparation)
+				{
+					simplex.count = 4;
+					break;
+				}
+			}
+		}
+
+		return simplex.count == 4;
+	}
+
+	// Penetration of the whole shapes, starting from a tetrahedron holding the origin. Gives the normal from
+	// A to B, the depth and the deepest points on each shape, in A's local space
+	int RunEPA(const MinkowskiDifference& difference, const Simplex& simplex, Vector3f& normal, float& depth,
+	           Vector3f& pointA, Vector3f& pointB)
+	{
+		Polytope polytope;
+		for (int i = 0; i < 4; ++i)
+			polytope.vertices[i] = simplex.vertices[i];
+		polytope.vertexCount = 4;
+
+		// Wind the faces so their normals point away from the opposite vertex
+		const Vector3f* w[4] = { &simplex.vertices[0].w, &simplex.vertices[1].w, &simplex.vertices[2].w, &simplex.vertices[3].w };
+		if (Dot(Cross(*w[1] - *w[0], *w[2] - *w[0]), *w[3] - *w[0]) > 0)
+			std::swap(polytope.vertices[1], polytope.vertices[2]);
+		polytope.AddFace(0, 1, 2);
+		polytope.AddFace(0, 3, 1);
+		polytope.AddFace(0, 2, 3);
+		polytope.AddFace(1, 3, 2);
+
+		int iterations = 0;
+		int closest = polytope.ClosestFace();
+		while (iterations < MaxEPAIterations)
+		{
+			// Expand the closest face out to the surface of A - B, unless it's already there
+			const EPAFace& face = polytope.faces[closest];
+			const SimplexVertex v = difference.Support(face.normal, true);
+			++iterations;
+			if (Dot(v.w, face.normal) - face.distance <= EPATolerance || polytope.vertexCount == MaxEPAVertices)
+				break;
+
+			// Remove every face the new point can see. The edges left open (the horizon) are the ones in only
+			// one removed face, seen in one direction but not the other
+			const int newVertex = polytope.vertexCount++;
+			polytope.vertices[newVertex] = v;
+
+			EPAEdge horizon[MaxEPAFaces];
+			int horizonCount = 0;
+			for (int f = 0; f < polytope.faceCount;)
+			{
+				const EPAFace& visible = polytope.faces[f];
+				if (Dot(visible.normal, v.w - polytope.vertices[visible.v[0]].w) <= EPAVisibleTolerance)
+				{
+					++f;
+					continue;
+				}
+
+				for (int e = 0; e < 3; ++e)
+				{
+					const EPAEdge edge = { visible.v[e], visible.v[(e + 1) % 3] };
+					int reverse = 0;
+					while (reverse < horizonCount && !(horizon[reverse].a == edge.b && horizon[reverse].b == edge.a))
+						++reverse;
+					if (reverse < horizonCount)
+						horizon[reverse] = horizon[--horizonCount];
+					else
+						horizon[horizonCount++] = edge;
+				}
+				polytope.faces[f] = polytope.faces[--polytope.faceCount];
+			}
+
+			if (polytope.faceCount + horizonCount > MaxEPAFaces)
+				break;
+			for (int e = 0; e < horizonCount; ++e)
+				polytope.AddFace(horizon[e].a, horizon[e].b, newVertex);
+			closest = polytope.ClosestFace();
+		}
+
+		// The point on the closest face nearest the origin, as weights of the face's vertices (Ericson 3.4)
+		const EPAFace& face = polytope.faces[closest];
+		const SimplexVertex& a = polytope.vertices[face.v[0]];
+		const SimplexVertex& b = polytope.vertices[face.v[1]];
+		const SimplexVertex& c = polytope.vertices[face.v[2]];
+		const Vector3f ab = b.w - a.w, ac = c.w - a.w, ap = face.normal * face.distance - a.w;
+		const float d00 = Dot(ab, ab), d01 = Dot(ab, ac), d11 = Dot(ac, ac);
+		const float d20 = Dot(ap, ab), d21 = Dot(ap, ac);
+		const float denominator = d00 * d11 - d01 * d01;
+		const float wb = denominator > 0 ? (d11 * d20 - d01 * d21) / denominator : 0;
+		const float wc = denominator > 0 ? (d00 * d21 - d01 * d20) / denominator : 0;
+		const float wa = 1 - wb - wc;
+
+		normal = face.normal;
+		depth = face.distance;
+		pointA = a.a * wa + b.a * wb + c.a * wc;
+		pointB = a.b * wa + b.b * wb + c.b * wc;
+		return iterations;
+	}
+}
+
+
+//=====================
+// Queries
+//=====================
+
+GJKResult GJKDistance(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB,
+                      GJKCache* cache)
+{
+	const MinkowskiDifference difference(a, transformA, b, transformB);
+	Simplex simplex;
+	GJKResult result = RunGJK(difference, cache, simplex);
+	result.pointA = transformA.TransformPoint(result.pointA);
+	result.pointB = transformA.TransformPoint(result.pointB);
+	return result;
+}
+
+bool CollideConvex(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB,
+                   Contact& contact, GJKCache* cache, float margin)
+{
+	const MinkowskiDifference difference(a, transformA, b, transformB);
+	Simplex simplex;
+	const GJKResult result = RunGJK(difference, cache, simplex);
+
+	Vector3f normal, pointA, pointB;
+	float depth;
+	if (!result.overlap)
+	{
+		// Cores apart: the normal is the line between their closest points, then move out by the radii
+		depth = a.radius + b.radius - result.distance;
+		if (depth < -margin)
+			return false;
+		normal = (result.pointB - result.pointA) * (1 / result.distance);
+		pointA = result.pointA + normal * a.radius;
+		pointB = result.pointB - normal * b.radius;
+	}
+	else if (FillTetrahedron(difference, simplex))
+	{
+		RunEPA(difference, simplex, normal, depth, pointA, pointB);
+	}
+	else
+	{
+		// A - B is flat, only possible for flat hulls. Call it touching, along the line between the centres
+		normal = Normalise(difference.CentreOfB());
+		if (Dot(normal, normal) == 0)
+			normal = { 0, 1, 0 };
+		depth = 0;
+		pointA = pointB = simplex.vertices[0].a;
+	}
+
+	contact.normal = transformA.TransformVector(normal);
+	contact.pointCount = 1;
+	contact.points[0].position = transformA.TransformPoint((pointA + pointB) * 0.5f);
+	contact.points[0].depth = depth;
+	contact.points[0].featureId = 0;
+	return true;
+}
@@ -0,0 +1,50 @@
+//=========================================================================================================
+// GJK.h: Convex Shape Distance (GJK) and Penetration Depth (EPA)
+// - GJK (Gilbert-Johnson-Keerthi) finds the closest points of two convex shapes using only their support
+//   functions. It builds a simplex (point, segment, triangle or tetrahedron) inside the Minkowski
+//   difference A - B and moves it towards the origin until it can get no closer
+// - GJK runs on the shape cores (see Shapes.h) and the radii are added after, so spheres and capsules
+//   are exact. Only when the cores themselves overlap is EPA (Expanding Polytope Algorithm) used: it grows
+//   the final simplex out to the surface of A - B to find the smallest move that separates the shapes
+// - A GJKCache kept per pair between steps holds the last simplex as points in each shape's local space.
+//   Shapes only move a little each step, so restarting from it usually finishes in one or two iterations
+//   instead of five to ten
+// - Works in A's local space, so only B's support points need transforming
+//=========================================================================================================
+
+#ifndef _GJK_H_DEFINED_
+#define _GJK_H_DEFINED_
+
+#include "Contact.h"
+#include "Shapes.h"
+#include "Transform.h"
+
+// Last simplex for a pair of shapes. Zero initialise for a new pair. Only valid for the same two shapes in
+// the same order
+struct GJKCache
+{
+	int count = 0;
+	Vector3f localA[4]; // Support points on each core, in the shape's local space
+	Vector3f localB[4];
+};
+
+struct GJKResult
+{
+	float distance;   // Between the cores, 0 if they overlap
+	Vector3f pointA;  // Closest points on each core, world space. Not meaningful if the cores overlap
+	Vector3f pointB;
+	int iterations;   // Support point searches used
+	bool overlap;     // Cores are touching or overlapping
+};
+
+// Closest points of the cores of two shapes. Pass a cache to start from the simplex it holds (if any) and
+// store the final simplex back in it
+GJKResult GJKDistance(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB,
+                      GJKCache* cache = nullptr);
+
+// Contact between two shapes: a single point at the deepest place. Returns false (contact untouched) if
+// the shapes are further apart than margin. Margin > 0 gives speculative contacts for shapes about to touch
+bool CollideConvex(const Shape& a, const Transformf& transformA, const Shape& b, const Transformf& transformB,
+                   Contact& contact, GJKCache* cache = nullptr, float margin = 0);
+
+#endif // !_GJK_H_DEFINED_
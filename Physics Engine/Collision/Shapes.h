@@ -0,0 +1,134 @@
+//=========================================================================================================
+// Shapes.h: Convex Collision Shapes and their Support Functions
+// - Every shape is a "core" grown by a radius: a sphere is a point plus radius, a capsule a segment plus
+//   radius, boxes and hulls have no radius. The narrowphase works on the cores and adds the radii after,
+//   so round shapes are exact rather than approximated by many support points
+// - Shapes are in their own local space with the centre at the origin, a body's Transform places them
+// - A shape is a small value, cheap to copy. Convex hulls refer to points stored elsewhere, which must
+//   outlive the shape
+//=========================================================================================================
+// Header-only: All functions are defined here so the compiler can inline them at the call site
+//=========================================================================================================
+
+#ifndef _SHAPES_H_DEFINED_
+#define _SHAPES_H_DEFINED_
+
+#include "AABB.h"
+#include "Transform.h"
+#include "Vector3.h"
+
+#include <cmath>
+#include <cstdint>
+
+enum class ShapeType : uint8_t
+{
+	Sphere,
+	Capsule,
+	Box,
+	ConvexHull,
+};
+constexpr int ShapeTypeCount = 4;
+
+class Shape
+{
+// ALLOW PUBLIC ACCESS. For simple, well-defined Class
+public:
+	ShapeType type;
+	float radius;             // Sphere and Capsule, 0 for the others
+	float halfHeight;         // Capsule: half the length of the core segment, which lies along local y
+	Vector3f halfExtents;     // Box
+	const Vector3f* points;   // ConvexHull: the hull's vertices, not owned
+	uint32_t pointCount;
+
+	//==========================
+	// Other Member Functions
+	//==========================
+
+	// Furthest point of the core in the given direction (need not be unit length), local space
+	Vector3f SupportCore(const Vector3f& direction) const noexcept
+	{
+		switch (type)
+		{
+		case ShapeType::Capsule:
+			return { 0, direction.y >= 0 ? halfHeight : -halfHeight, 0 };
+
+		case ShapeType::Box:
+			return { direction.x >= 0 ? halfExtents.x : -halfExtents.x,
+			         direction.y >= 0 ? halfExtents.y : -halfExtents.y,
+			         direction.z >= 0 ? halfExtents.z : -halfExtents.z };
+
+		case ShapeType::ConvexHull:
+		{
+			uint32_t best = 0;
+			float bestDistance = Dot(points[0], direction);
+			for (uint32_t i = 1; i < pointCount; ++i)
+			{
+				const float distance = Dot(points[i], direction);
+				if (distance > bestDistance)
+				{
+					best = i;
+					bestDistance = distance;
+				}
+			}
+			return points[best];
+		}
+
+		default: // Sphere
+			return { 0, 0, 0 };
+		}
+	}
+
+	// Furthest point of the whole shape (core plus radius) in the given direction, local space
+	Vector3f Support(const Vector3f& direction) const noexcept
+	{
+		const Vector3f core = SupportCore(direction);
+		if (radius == 0)
+			return core;
+		return core + Normalise(direction) * radius;
+	}
+
+	// Bounding box of the shape placed by a transform
+	AABB BoundingBox(const Transformf& transform) const noexcept
+	{
+		// Support on each world axis gives the box exactly for all the shape types
+		const Quaternionf toLocal = Conjugate(transform.rotation);
+		const Vector3f axes[3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+		float min[3], max[3];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const Vector3f localAxis = Rotate(toLocal, axes[axis]);
+			max[axis] = Dot(transform.TransformPoint(Support(localAxis)), axes[axis]);
+			min[axis] = Dot(transform.TransformPoint(Support(-localAxis)), axes[axis]);
+		}
+		return { { min[0], min[1], min[2] }, { max[0], max[1], max[2] } };
+	}
+};
+
+
+//=========================
+// Non-Member Functions
+//=========================
+
+inline Shape ShapeSphere(float radius) noexcept
+{
+	return { ShapeType::Sphere, radius, 0, { 0, 0, 0 }, nullptr, 0 };
+}
+
+// Capsule along local y, halfHeight is half the distance between the centres of its two end spheres
+inline Shape ShapeCapsule(float radius, float halfHeight) noexcept
+{
+	return { ShapeType::Capsule, radius, halfHeight, { 0, 0, 0 }, nullptr, 0 };
+}
+
+inline Shape ShapeBox(const Vector3f& halfExtents) noexcept
+{
+	return { ShapeType::Box, 0, 0, halfExtents, nullptr, 0 };
+}
+
+// Hull of the given points (at least one), which may include interior points. The points are not copied
+inline Shape ShapeConvexHull(const Vector3f* points, uint32_t pointCount) noexcept
+{
+	return { ShapeType::ConvexHull, 0, 0, { 0, 0, 0 }, points, pointCount };
+}
+
+#endif // !_SHAPES_H_DEFINED_
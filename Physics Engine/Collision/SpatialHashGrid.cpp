@@ -0,0 +1,255 @@
+//=========================================================================================================
+// SpatialHashGrid.cpp: Uniform Grid for Large Numbers of Equal Size Particles
+//=========================================================================================================
+
+#include "SpatialHashGrid.h"
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace
+{
+	// Minimum work per thread, below this starting the threads costs more than it saves
+	const std::size_t MinParticlesPerThread = 16384;
+	const std::size_t MinBucketsPerThread = 65536;
+}
+
+SpatialHashGrid::SpatialHashGrid(float cellSize, unsigned int threadCount)
+	: mCellSize(cellSize), mInverseCellSize(1 / cellSize)
+{
+	SetThreadCount(threadCount);
+}
+
+void SpatialHashGrid::SetThreadCount(unsigned int threadCount)
+{
+	mThreadCount = threadCount > 0 ? threadCount : HardwareThreadCount();
+}
+
+
+//=================
+// Building
+//=================
+
+void SpatialHashGrid::Build(const Vector3f* positions, std::size_t count)
+{
+	// Table of at least twice the particle count so most buckets hold a single cell. A power of two so
+	// the hash can be masked
+	std::size_t tableSize = 64;
+	while (tableSize < 2 * count)
+		tableSize *= 2;
+	mTableMask = static_cast<uint32_t>(tableSize - 1);
+
+	mBucketStart.assign(tableSize + 1, 0);
+	mParticles.resize(count);
+	mSortedPositions.resize(count);
+	mParticleBuckets.resize(count);
+
+	// Count the particles in each bucket
+	ParallelFor(mJobs, count, mThreadCount, MinParticlesPerThread, [&](std::size_t begin, std::size_t end, unsigned int)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const uint32_t bucket = Hash(Cell(positions[i]));
+			mParticleBuckets[i] = bucket;
+			std::atomic_ref<uint32_t>(mBucketStart[bucket]).fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+
+	// Running total so each entry is the end of its bucket. Each range totals its own entries first, then
+	// adds the sum of all the ranges before it
+	const std::size_t entries = tableSize + 1;
+	const unsigned int ranges = ParallelRangeCount(entries, mThreadCount, MinBucketsPerThread);
+	std::vector<uint32_t> rangeOffsets(ranges + 1, 0);
+	ParallelFor(mJobs, entries, mThreadCount, MinBucketsPerThread, [&](std::size_t begin, std::size_t end, unsigned int range)
+	{
+		uint32_t sum = 0;
+		for (std::size_t h = begin; h < end; ++h)
+		{
+			sum += mBucketStart[h];
+			mBucketStart[h] = sum;
+		}
+		rangeOffsets[range + 1] = sum;
+	});
+	for (unsigned int r = 0; r < ranges; ++r)
+		rangeOffsets[r + 1] += rangeOffsets[r];
+	if (ranges > 1)
+	{
+		ParallelFor(mJobs, entries, mThreadCount, MinBucketsPerThread, [&](std::size_t begin, std::size_t end, unsigned int range)
+		{
+			for (std::size_t h = begin; h < end; ++h)
+				mBucketStart[h] += rangeOffsets[range];
+		});
+	}
+
+	// Each particle takes the last free place in its bucket, counting down, so afterwards each entry is the
+	// start of its bucket
+	ParallelFor(mJobs, count, mThreadCount, MinParticlesPerThread, [&](std::size_t begin, std::size_t end, unsigned int)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const uint32_t place = std::atomic_ref<uint32_t>(mBucketStart[mParticleBuckets[i]]).fetch_sub(1, std::memory_order_relaxed) - 1;
+			mParticles[place] = static_cast<uint32_t>(i);
+		}
+	});
+
+	// Threads fill buckets in any order, sort each one by particle index so results are repeatable. Buckets
+	// only hold a few particles so an insertion sort is fastest. Then copy the positions into the same order
+	ParallelFor(mJobs, tableSize, mThreadCount, MinBucketsPerThread, [&](std::size_t begin, std::size_t end, unsigned int)
+	{
+		for (std::size_t h = begin; h < end; ++h)
+		{
+			const uint32_t bucketEnd = mBucketStart[h + 1];
+			for (uint32_t k = mBucketStart[h] + 1; k < bucketEnd; ++k)
+			{
+				const uint32_t particle = mParticles[k];
+				uint32_t j = k;
+				for (; j > mBucketStart[h] && mParticles[j - 1] > particle; --j)
+					mParticles[j] = mParticles[j - 1];
+				mParticles[j] = particle;
+			}
+		}
+	});
+	ParallelFor(mJobs, count, mThreadCount, MinParticlesPerThread, [&](std::size_t begin, std::size_t end, unsigned int)
+	{
+		for (std::size_t k = begin; k < end; ++k)
+			mSortedPositions[k] = positions[mParticles[k]];
+	});
+}
+
+
+//=================
+// Queries
+//=================
+
+int SpatialHashGrid::NeighbourRanges(const Vector3i& cell, ParticleRange ranges[MaxNeighbourRanges]) const
+{
+	// Cells x - 1, x, x + 1 of each row are three consecutive buckets, so one range of particles
+	uint32_t firstBuckets[9];
+	int row = 0;
+	for (int z = cell.z - 1; z <= cell.z + 1; ++z)
+	{
+		for (int y = cell.y - 1; y <= cell.y + 1; ++y)
+			firstBuckets[row++] = Hash({ cell.x - 1, y, z });
+	}
+
+	// Usually the rows' buckets are well apart and don't wrap around the end of the table, then the
+	// ranges can't overlap. Checked without branching as it is almost always true
+	bool separate = true;
+	for (int a = 0; a < 9; ++a)
+	{
+		separate &= firstBuckets[a] + 2 <= mTableMask;
+		for (int b = 0; b < a; ++b)
+			separate &= ((firstBuckets[a] - firstBuckets[b] + 2) & mTableMask) > 4; // Not within 2 buckets
+	}
+	if (separate)
+	{
+		for (int r = 0; r < 9; ++r)
+			ranges[r] = { mBucketStart[firstBuckets[r]], mBucketStart[firstBuckets[r] + 3] };
+		return 9;
+	}
+
+	// Otherwise split the rows that wrap into two ranges
+	int rangeCount = 0;
+	for (uint32_t first : firstBuckets)
+	{
+		if (first + 2 <= mTableMask)
+		{
+			ranges[rangeCount++] = { mBucketStart[first], mBucketStart[first + 3] };
+		}
+		else
+		{
+			ranges[rangeCount++] = { mBucketStart[first], mBucketStart[mTableMask + 1] };
+			ranges[rangeCount++] = { mBucketStart[0], mBucketStart[(first + 3) & mTableMask] };
+		}
+	}
+
+	// Rows can hash to nearby buckets and overlap. Sort the ranges then merge any that overlap, dropping
+	// empty ones
+	for (int i = 1; i < rangeCount; ++i)
+	{
+		const ParticleRange range = ranges[i];
+		int j = i;
+		for (; j > 0 && ranges[j - 1].begin > range.begin; --j)
+			ranges[j] = ranges[j - 1];
+		ranges[j] = range;
+	}
+	int merged = 0;
+	for (int i = 0; i < rangeCount; ++i)
+	{
+		if (ranges[i].begin == ranges[i].end)
+			continue;
+		if (merged > 0 && ranges[i].begin <= ranges[merged - 1].end)
+			ranges[merged - 1].end = std::max(ranges[merged - 1].end, ranges[i].end);
+		else
+			ranges[merged++] = ranges[i];
+	}
+	return merged;
+}
+
+void SpatialHashGrid::FindPairs(float distance, std::vector<BroadphasePair>& pairs)
+{
+	assert(distance <= mCellSize);
+	pairs.clear();
+
+	// Each thread finds the pairs for a range of the sorted particles, merged in order after
+	const std::size_t count = mParticles.size();
+	const unsigned int threads = ParallelRangeCount(count, mThreadCount, MinParticlesPerThread);
+	if (threads == 1)
+	{
+		FindPairsInRange(0, count, distance * distance, pairs);
+		return;
+	}
+
+	mThreadPairs.resize(threads);
+	ParallelFor(mJobs, count, mThreadCount, MinParticlesPerThread, [&](std::size_t begin, std::size_t end, unsigned int t)
+	{
+		mThreadPairs[t].clear();
+		FindPairsInRange(begin, end, distance * distance, mThreadPairs[t]);
+	});
+
+	std::size_t total = 0;
+	for (unsigned int t = 0; t < threads; ++t)
+		total += mThreadPairs[t].size();
+	pairs.reserve(total);
+	for (unsigned int t = 0; t < threads; ++t)
+		pairs.insert(pairs.end(), mThreadPairs[t].begin(), mThreadPairs[t].end());
+}
+
+// Pairs for sorted particles [begin, end). Each pair is found from its lower index particle only
+void SpatialHashGrid::FindPairsInRange(std::size_t begin, std::size_t end, float distanceSquared, std::vector<BroadphasePair>& pairs) const
+{
+	ParticleRange ranges[MaxNeighbourRanges];
+	int rangeCount = 0;
+	Vector3i lastCell = { 0, 0, 0 };
+	bool haveCell = false;
+
+	for (std::size_t k = begin; k < end; ++k)
+	{
+		const uint32_t i = mParticles[k];
+		const Vector3f p = mSortedPositions[k];
+
+		// Particles are sorted by bucket so the one before is often in the same cell, with the same neighbours
+		const Vector3i cell = Cell(p);
+		if (!haveCell || cell.x != lastCell.x || cell.y != lastCell.y || cell.z != lastCell.z)
+		{
+			rangeCount = NeighbourRanges(cell, ranges);
+			lastCell = cell;
+			haveCell = true;
+		}
+
+		for (int r = 0; r < rangeCount; ++r)
+		{
+			for (uint32_t k2 = ranges[r].begin; k2 < ranges[r].end; ++k2)
+			{
+				// One branch for both tests - the index test alone is unpredictable, and taken half the time
+				const uint32_t j = mParticles[k2];
+				const Vector3f d = mSortedPositions[k2] - p;
+				if ((j > i) & (Dot(d, d) <= distanceSquared))
+					pairs.push_back({ i, j });
+			}
+		}
+	}
+}
@@ -0,0 +1,137 @@
+//=========================================================================================================
+// SpatialHashGrid.h: Uniform Grid for Large Numbers of Equal Size Particles
+// - Space is divided into cubic cells at least as large as the interaction distance, so everything within
+//   that distance of a particle is in the particle's cell or one of the 26 around it
+// - Cells are keyed on their Vector3i coordinates, hashed into a table of about twice the particle count,
+//   so the grid covers unbounded space with memory only for the particles. Only y and z are hashed, x is
+//   added after: a row of cells along x goes into consecutive buckets, so the 27 cells around a particle
+//   are 9 runs of memory rather than 27 scattered lookups
+// - Rebuilt from scratch each step with a counting sort: count the particles in each hash bucket, prefix
+//   sum for where each bucket starts, then scatter the particle indexes into one flat array. No per-cell
+//   allocations and no incremental updates to go wrong
+// - Building and finding pairs are split across threads, run as jobs on a JobSystem if one is set. Results
+//   are the same for any thread count
+// - For mixed sizes or mostly static objects use a Broadphase instead (see Broadphase.h)
+//=========================================================================================================
+
+#ifndef _SPATIAL_HASH_GRID_H_DEFINED_
+#define _SPATIAL_HASH_GRID_H_DEFINED_
+
+#include "Broadphase.h" // For BroadphasePair
+#include "JobSystem.h"
+#include "Vector3.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class SpatialHashGrid
+{
+public:
+	//================
+	// Constructors
+	//================
+
+	// cellSize:    at least the largest distance that neighbours are looked for at
+	// threadCount: threads to split the work over, 0 for one per hardware thread
+	explicit SpatialHashGrid(float cellSize, unsigned int threadCount = 0);
+
+	//=================
+	// Building
+	//=================
+
+	// Rebuild the grid for a new set of positions. The positions are copied, they can change afterwards
+	void Build(const Vector3f* positions, std::size_t count);
+	void Build(const std::vector<Vector3f>& positions) { Build(positions.data(), positions.size()); }
+
+	//=================
+	// Queries
+	//=================
+	// All from the last Build. Particles are referred to by their index in the positions passed to Build
+
+	// Call function(index) for every particle in the 27 cells around point p, each one once. This includes
+	// particles up to two cells away, so the caller checks the actual distance
+	template<typename F> void ForEachNeighbour(const Vector3f& p, F&& function) const;
+
+	// Replace the contents of "pairs" with every pair of particles no further apart than distance, which
+	// must not be more than the cell size. Each pair once with a < b
+	void FindPairs(float distance, std::vector<BroadphasePair>& pairs);
+
+	Vector3i Cell(const Vector3f& p) const
+	{
+		return { static_cast<int>(std::floor(p.x * mInverseCellSize)),
+		         static_cast<int>(std::floor(p.y * mInverseCellSize)),
+		         static_cast<int>(std::floor(p.z * mInverseCellSize)) };
+	}
+
+	// Particle indexes in the order the grid holds them, sorted by bucket then index. Callers that copy
+	// their particle data into this order can read the ranges below as runs of their own arrays
+	const std::vector<uint32_t>& SortedParticles() const { return mParticles; }
+
+	// Part of SortedParticles
+	struct ParticleRange
+	{
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	// Ranges of SortedParticles holding the 27 cells around a cell. Ranges don't overlap, so no particle is
+	// in two (different cells can share a bucket). Returns the number of ranges
+	static constexpr int MaxNeighbourRanges = 18; // 9 rows, each may wrap around the end of the table
+	int NeighbourRanges(const Vector3i& cell, ParticleRange ranges[MaxNeighbourRanges]) const;
+
+	float CellSize() const { return mCellSize; }
+	std::size_t ParticleCount() const { return mParticles.size(); }
+
+	unsigned int ThreadCount() const { return mThreadCount; }
+	void SetThreadCount(unsigned int threadCount);
+
+	// Run the split work as jobs on this system (JobSystem.h), rather than on threads started for each
+	// pass. Null to go back. The thread count still sets how many ranges the work is split into
+	void SetJobSystem(JobSystem* jobs) { mJobs = jobs; }
+
+private:
+	uint32_t Hash(const Vector3i& cell) const
+	{
+		// Large primes spread the rows across the table (from Teschner et al. 2003)
+		const uint32_t row = (static_cast<uint32_t>(cell.y) * 19349663u) ^ (static_cast<uint32_t>(cell.z) * 83492791u);
+		return (row + static_cast<uint32_t>(cell.x)) & mTableMask;
+	}
+
+	void FindPairsInRange(std::size_t begin, std::size_t end, float distanceSquared, std::vector<BroadphasePair>& pairs) const;
+
+private:
+	float mCellSize;
+	float mInverseCellSize;
+	unsigned int mThreadCount;
+	JobSystem* mJobs = nullptr;
+
+	uint32_t mTableMask = 0;
+	std::vector<uint32_t> mBucketStart;    // Particles in bucket h are mParticles[mBucketStart[h]] up to mBucketStart[h + 1]
+	std::vector<uint32_t> mParticles;      // Particle indexes sorted by bucket, then index
+	std::vector<Vector3f> mSortedPositions; // Positions in mParticles order
+	std::vector<uint32_t> mParticleBuckets; // Bucket of each particle, by particle index
+
+	std::vector<std::vector<BroadphasePair>> mThreadPairs;
+};
+
+
+//=================
+// Queries
+//=================
+
+template<typename F> void SpatialHashGrid::ForEachNeighbour(const Vector3f& p, F&& function) const
+{
+	if (mParticles.empty())
+		return;
+
+	ParticleRange ranges[MaxNeighbourRanges];
+	const int rangeCount = NeighbourRanges(Cell(p), ranges);
+	for (int r = 0; r < rangeCount; ++r)
+	{
+		for (uint32_t k = ranges[r].begin; k < ranges[r].end; ++k)
+			function(mParticles[k]);
+	}
+}
+
+#endif // !_SPATIAL_HASH_GRID_H_DEFINED_
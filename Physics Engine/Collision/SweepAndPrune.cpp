@@ -0,0 +1,362 @@
+//=========================================================================================================
+// SweepAndPrune.cpp: Sort and Sweep Broadphase
+//=========================================================================================================
+
+#include "SweepAndPrune.h"
+
+#include "SIMDFloat.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+	// Only split the sweep across threads when each has at least this many proxies, below this starting
+	// the threads costs more than it saves
+	const std::size_t MinProxiesPerThread = 4096;
+
+	// The sort axis only changes when another axis has this much more variance, so it doesn't switch
+	// back and forth (with a full radix sort each time) when two axes are similar
+	const double AxisChangeRatio = 1.2;
+
+	// Insertion sort gives up and a radix sort is used once it has moved more than this many entries
+	// per proxy - by then most of the list is out of order
+	const std::size_t MaxInsertionShiftsPerProxy = 4;
+
+	// Boxes longer on the sort axis than this many times the mean are tested on their own by FindOverlaps
+	const float LongBoxRatio = 8;
+
+	float Component(const Vector3f& v, int axis)
+	{
+		return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+	}
+
+	// Float bits rearranged so unsigned integer order matches float order: negative floats have all bits
+	// flipped (larger magnitude is smaller), positive floats have just the sign bit flipped
+	uint32_t SortKey(float f)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &f, 4);
+		return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+	}
+}
+
+SweepAndPrune::SweepAndPrune(unsigned int threadCount)
+{
+	SetThreadCount(threadCount);
+}
+
+void SweepAndPrune::SetThreadCount(unsigned int threadCount)
+{
+	mThreadCount = threadCount > 0 ? threadCount : HardwareThreadCount();
+}
+
+
+//=====================
+// Broadphase
+//=====================
+
+uint32_t SweepAndPrune::CreateProxy(const AABB& box, uint32_t userValue)
+{
+	uint32_t proxy;
+	if (!mFreeList.empty())
+	{
+		proxy = mFreeList.back();
+		mFreeList.pop_back();
+		mProxies[proxy] = { box, userValue, true };
+	}
+	else
+	{
+		proxy = static_cast<uint32_t>(mProxies.size());
+		mProxies.push_back({ box, userValue, true });
+	}
+
+	// Added at the end, the next sort moves it into place
+	mOrder.push_back(proxy);
+	++mProxyCount;
+	mChanged = true;
+	return proxy;
+}
+
+void SweepAndPrune::DestroyProxy(uint32_t proxy)
+{
+	assert(proxy < mProxies.size() && mProxies[proxy].alive);
+
+	// Still in mOrder, so it can't be reused until the next FindPairs has removed it from there
+	mProxies[proxy].alive = false;
+	mPendingFree.push_back(proxy);
+	--mProxyCount;
+	mChanged = true;
+}
+
+void SweepAndPrune::MoveProxy(uint32_t proxy, const AABB& box, const Vector3f& /*displacement*/)
+{
+	assert(proxy < mProxies.size() && mProxies[proxy].alive);
+	mProxies[proxy].box = box;
+	mChanged = true;
+}
+
+void SweepAndPrune::FindPairs(std::vector<BroadphasePair>& pairs)
+{
+	pairs.clear();
+	Sort();
+
+	const std::size_t count = mOrder.size();
+	const unsigned int threads = ParallelRangeCount(count, mThreadCount, MinProxiesPerThread);
+	if (threads == 1)
+	{
+		Sweep(0, count, pairs);
+		return;
+	}
+
+	// Each thread sweeps an equal share of the sorted list into its own pair list
+	mThreadPairs.resize(threads);
+	ParallelFor(mJobs, count, mThreadCount, MinProxiesPerThread, [this](std::size_t begin, std::size_t end, unsigned int t)
+	{
+		mThreadPairs[t].clear();
+		Sweep(begin, end, mThreadPairs[t]);
+	});
+
+	// Merge in thread order, so the result doesn't depend on the thread count
+	std::size_t total = 0;
+	for (unsigned int t = 0; t < threads; ++t)
+		total += mThreadPairs[t].size();
+	pairs.reserve(total);
+	for (unsigned int t = 0; t < threads; ++t)
+		pairs.insert(pairs.end(), mThreadPairs[t].begin(), mThreadPairs[t].end());
+}
+
+
+void SweepAndPrune::FindOverlaps(const AABB& box, std::vector<uint32_t>& userValues) const
+{
+	userValues.clear();
+	if (mChanged || mAxis < 0)
+	{
+		for (const Proxy& proxy : mProxies)
+		{
+			if (proxy.alive && Overlaps(proxy.box, box))
+				userValues.push_back(proxy.userValue);
+		}
+		return;
+	}
+
+	// Only boxes starting between (query min - longest box) and query max on the sort axis can overlap
+	const float queryMin = Component(box.min, mAxis);
+	const float queryMax = Component(box.max, mAxis);
+	const int axisB = (mAxis + 1) % 3;
+	const int axisC = (mAxis + 2) % 3;
+	auto overlapsOthers = [&](std::size_t i)
+	{
+		return mSortedMax[i] >= queryMin && mMaxB[i] >= Component(box.min, axisB) && mMinB[i] <= Component(box.max, axisB) &&
+		       mMaxC[i] >= Component(box.min, axisC) && mMinC[i] <= Component(box.max, axisC);
+	};
+
+	const std::size_t first = std::lower_bound(mSortedMin.begin(), mSortedMin.end(), queryMin - mMaxLength) - mSortedMin.begin();
+	const std::size_t last = std::upper_bound(mSortedMin.begin(), mSortedMin.end(), queryMax) - mSortedMin.begin();
+	for (std::size_t i = first; i < last; ++i)
+	{
+		if (mSortedMax[i] - mSortedMin[i] <= mMaxLength && overlapsOthers(i))
+			userValues.push_back(mSortedUserValues[i]);
+	}
+	for (uint32_t i : mLongEntries)
+	{
+		if (mSortedMin[i] <= queryMax && overlapsOthers(i))
+			userValues.push_back(mSortedUserValues[i]);
+	}
+}
+
+
+//=================
+// Sorting
+//=================
+
+void SweepAndPrune::Sort()
+{
+	// Remove destroyed proxies from the order, after which they can be reused
+	if (!mPendingFree.empty())
+	{
+		mOrder.erase(std::remove_if(mOrder.begin(), mOrder.end(), [&](uint32_t p) { return !mProxies[p].alive; }), mOrder.end());
+		mFreeList.insert(mFreeList.end(), mPendingFree.begin(), mPendingFree.end());
+		mPendingFree.clear();
+	}
+
+	// Variance of the box centres on each axis (using sums of the doubled centre, min + max)
+	double sum[3] = { 0, 0, 0 };
+	double sumSquares[3] = { 0, 0, 0 };
+	for (uint32_t p : mOrder)
+	{
+		const AABB& box = mProxies[p].box;
+		const Vector3f c = box.min + box.max;
+		sum[0] += c.x; sum[1] += c.y; sum[2] += c.z;
+		sumSquares[0] += c.x * c.x; sumSquares[1] += c.y * c.y; sumSquares[2] += c.z * c.z;
+	}
+	double variance[3];
+	const double n = static_cast<double>(std::max<std::size_t>(1, mOrder.size()));
+	for (int axis = 0; axis < 3; ++axis)
+		variance[axis] = sumSquares[axis] / n - (sum[axis] / n) * (sum[axis] / n);
+
+	int bestAxis = 0;
+	if (variance[1] > variance[bestAxis]) bestAxis = 1;
+	if (variance[2] > variance[bestAxis]) bestAxis = 2;
+
+	// Keep the current axis unless another is clearly better, then the previous order can be reused
+	mUsedRadixSort = true;
+	if (mAxis >= 0 && variance[bestAxis] <= variance[mAxis] * AxisChangeRatio)
+		mUsedRadixSort = !InsertionSort(mOrder.size() * MaxInsertionShiftsPerProxy);
+	else
+		mAxis = bestAxis;
+
+	if (mUsedRadixSort)
+		RadixSort();
+
+	// Gather the data for the sweep into sorted order
+	const std::size_t count = mOrder.size();
+	const int axisB = (mAxis + 1) % 3;
+	const int axisC = (mAxis + 2) % 3;
+	mSortedMin.resize(count);
+	mSortedMax.resize(count);
+	mMinB.resize(count + Float4::Width);
+	mMaxB.resize(count + Float4::Width);
+	mMinC.resize(count + Float4::Width);
+	mMaxC.resize(count + Float4::Width);
+	mSortedUserValues.resize(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const Proxy& proxy = mProxies[mOrder[i]];
+		mSortedMin[i] = Component(proxy.box.min, mAxis);
+		mSortedMax[i] = Component(proxy.box.max, mAxis);
+		mMinB[i] = Component(proxy.box.min, axisB);
+		mMaxB[i] = Component(proxy.box.max, axisB);
+		mMinC[i] = Component(proxy.box.min, axisC);
+		mMaxC[i] = Component(proxy.box.max, axisC);
+		mSortedUserValues[i] = proxy.userValue;
+	}
+
+	// Set the long boxes aside for FindOverlaps
+	double totalLength = 0;
+	for (std::size_t i = 0; i < count; ++i)
+		totalLength += mSortedMax[i] - mSortedMin[i];
+	const float longLength = static_cast<float>(totalLength / std::max<std::size_t>(1, count)) * LongBoxRatio;
+	mMaxLength = 0;
+	mLongEntries.clear();
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const float length = mSortedMax[i] - mSortedMin[i];
+		if (length > longLength)
+			mLongEntries.push_back(static_cast<uint32_t>(i));
+		else
+			mMaxLength = std::max(mMaxLength, length);
+	}
+	mChanged = false;
+}
+
+// Sort the existing order using the new box positions, cheap if it is already nearly sorted
+bool SweepAndPrune::InsertionSort(std::size_t maxShifts)
+{
+	const std::size_t count = mOrder.size();
+	mSortedMin.resize(count);
+	for (std::size_t i = 0; i < count; ++i)
+		mSortedMin[i] = Component(mProxies[mOrder[i]].box.min, mAxis);
+
+	std::size_t shifts = 0;
+	for (std::size_t i = 1; i < count; ++i)
+	{
+		const float key = mSortedMin[i];
+		const uint32_t proxy = mOrder[i];
+		std::size_t j = i;
+		while (j > 0 && mSortedMin[j - 1] > key)
+		{
+			mSortedMin[j] = mSortedMin[j - 1];
+			mOrder[j] = mOrder[j - 1];
+			--j;
+		}
+		mSortedMin[j] = key;
+		mOrder[j] = proxy;
+
+		// Order is left a valid (partly sorted) permutation if giving up
+		shifts += i - j;
+		if (shifts > maxShifts)
+			return false;
+	}
+	return true;
+}
+
+// Least significant digit radix sort of the 32-bit keys, in three passes of 11 bits
+void SweepAndPrune::RadixSort()
+{
+	const std::size_t count = mOrder.size();
+	mKeys.resize(count);
+	mKeysTemp.resize(count);
+	mOrderTemp.resize(count);
+	for (std::size_t i = 0; i < count; ++i)
+		mKeys[i] = SortKey(Component(mProxies[mOrder[i]].box.min, mAxis));
+
+	const int Bits = 11;
+	const uint32_t Buckets = 1 << Bits;
+	for (int shift = 0; shift < 32; shift += Bits)
+	{
+		uint32_t offsets[Buckets] = {};
+		for (uint32_t key : mKeys)
+			++offsets[(key >> shift) & (Buckets - 1)];
+
+		// Skip the pass if every key has the same digit (common for the high bits)
+		if (count > 0 && offsets[(mKeys[0] >> shift) & (Buckets - 1)] == count)
+			continue;
+
+		uint32_t total = 0;
+		for (uint32_t& offset : offsets)
+		{
+			const uint32_t bucketCount = offset;
+			offset = total;
+			total += bucketCount;
+		}
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const uint32_t position = offsets[(mKeys[i] >> shift) & (Buckets - 1)]++;
+			mKeysTemp[position] = mKeys[i];
+			mOrderTemp[position] = mOrder[i];
+		}
+		mKeys.swap(mKeysTemp);
+		mOrder.swap(mOrderTemp);
+	}
+}
+
+
+//=================
+// Sweep
+//=================
+
+void SweepAndPrune::Sweep(std::size_t begin, std::size_t end, std::vector<BroadphasePair>& pairs) const
+{
+	const std::size_t count = mSortedMin.size();
+	for (std::size_t i = begin; i < end; ++i)
+	{
+		// Only the boxes starting before this one ends on the sort axis can overlap it, they follow it in
+		// the sorted list up to sweepEnd
+		const float max = mSortedMax[i];
+		const std::size_t sweepEnd = std::upper_bound(mSortedMin.begin() + i + 1, mSortedMin.begin() + count, max) - mSortedMin.begin();
+
+		// Test them on the other two axes four at a time
+		const Float4 minB(mMinB[i]), maxB(mMaxB[i]);
+		const Float4 minC(mMinC[i]), maxC(mMaxC[i]);
+		for (std::size_t j = i + 1; j < sweepEnd; j += Float4::Width)
+		{
+			const Float4 overlap = (Float4::LoadUnaligned(&mMinB[j]) <= maxB) & (Float4::LoadUnaligned(&mMaxB[j]) >= minB) &
+			                       (Float4::LoadUnaligned(&mMinC[j]) <= maxC) & (Float4::LoadUnaligned(&mMaxC[j]) >= minC);
+			unsigned int hits = static_cast<unsigned int>(MoveMask(overlap));
+			if (sweepEnd - j < Float4::Width)
+				hits &= (1u << (sweepEnd - j)) - 1; // Lanes past the end of the sweep
+
+			while (hits != 0)
+			{
+				const std::size_t k = j + std::countr_zero(hits);
+				pairs.push_back({ mSortedUserValues[i], mSortedUserValues[k] });
+				hits &= hits - 1;
+			}
+		}
+	}
+}
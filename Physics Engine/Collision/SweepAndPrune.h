@@ -0,0 +1,112 @@
+//=========================================================================================================
+// SweepAndPrune.h: Sort and Sweep Broadphase
+// - Boxes are sorted by their minimum on one axis. Sweeping along the sorted list, each box only needs
+//   testing against the following boxes that start before it ends on that axis
+// - The axis is chosen each FindPairs as the one where the box centres are most spread out (greatest
+//   variance), so the fewest boxes share an interval on it
+// - The order from the previous FindPairs is kept: when objects only move a little it is nearly sorted and
+//   an insertion sort fixes it in close to linear time. A radix sort is used for the first sort, when the
+//   axis changes, or when the insertion sort finds too much has changed
+// - The sweep tests four boxes at a time on the other two axes (SIMD), and is split across worker threads
+//   for large scenes, or across jobs when given a job system
+// - No fat boxes or tree to refit, so suits scenes where most objects move every step. For mostly static
+//   scenes use DynamicTree, which only does work for the objects that move
+//=========================================================================================================
+
+#ifndef _SWEEP_AND_PRUNE_H_DEFINED_
+#define _SWEEP_AND_PRUNE_H_DEFINED_
+
+#include "Broadphase.h"
+
+#include <vector>
+
+class SweepAndPrune : public Broadphase
+{
+public:
+	//================
+	// Constructors
+	//================
+
+	// threadCount: threads to split the sweep over, 0 for one per hardware thread
+	explicit SweepAndPrune(unsigned int threadCount = 0);
+
+	//=====================
+	// Broadphase
+	//=====================
+
+	uint32_t CreateProxy(const AABB& box, uint32_t userValue) override;
+	void DestroyProxy(uint32_t proxy) override;
+
+	// Displacement is not used, boxes are not enlarged
+	void MoveProxy(uint32_t proxy, const AABB& box, const Vector3f& displacement) override;
+
+	void FindPairs(std::vector<BroadphasePair>& pairs) override;
+
+	// Binary search of the sorted boxes from the last FindPairs, or a test of every box if any have been
+	// created, destroyed or moved since
+	void FindOverlaps(const AABB& box, std::vector<uint32_t>& userValues) const override;
+
+	std::size_t ProxyCount() const override { return mProxyCount; }
+	void SetJobSystem(JobSystem* jobs) override { mJobs = jobs; }
+
+	//=================
+	// Statistics
+	//=================
+	// From the most recent FindPairs
+
+	int SortAxis() const { return mAxis; } // 0, 1, 2 for x, y, z. -1 before the first FindPairs
+	bool UsedRadixSort() const { return mUsedRadixSort; }
+
+	unsigned int ThreadCount() const { return mThreadCount; }
+	void SetThreadCount(unsigned int threadCount);
+
+private:
+	struct Proxy
+	{
+		AABB box;
+		uint32_t userValue;
+		bool alive;
+	};
+
+	// Choose the sort axis and bring mOrder into order on it
+	void Sort();
+	void RadixSort();
+	bool InsertionSort(std::size_t maxShifts); // False if more than maxShifts moves were needed
+
+	// Sweep sorted entries [begin, end) against all entries after them
+	void Sweep(std::size_t begin, std::size_t end, std::vector<BroadphasePair>& pairs) const;
+
+private:
+	std::vector<Proxy> mProxies;
+	std::vector<uint32_t> mFreeList;       // Proxies that can be reused
+	std::vector<uint32_t> mPendingFree;    // Destroyed but still in mOrder, freed in the next FindPairs
+	std::size_t mProxyCount = 0;
+
+	// Proxy indexes sorted on mAxis by the last FindPairs. New proxies are added to the end
+	std::vector<uint32_t> mOrder;
+	int mAxis = -1;
+	bool mUsedRadixSort = false;
+	bool mChanged = true; // Boxes changed since the sorted data was gathered
+
+	// Longest box on the sort axis, leaving out the few far longer than the rest (e.g. the ground). A query
+	// only needs to look back this far from its own minimum, the long ones are tested separately
+	float mMaxLength = 0;
+	std::vector<uint32_t> mLongEntries; // Index into the sorted arrays
+
+	// Sorted data for the sweep, in mOrder order. B and C are the two axes other than the sort axis, their
+	// arrays are padded by Float4::Width so the sweep can load four at a time past the end
+	std::vector<float> mSortedMin;         // Minimum on the sort axis, also the sort keys
+	std::vector<float> mSortedMax;
+	std::vector<float> mMinB, mMaxB, mMinC, mMaxC;
+	std::vector<uint32_t> mSortedUserValues;
+
+	// Radix sort working space
+	std::vector<uint32_t> mKeys, mKeysTemp, mOrderTemp;
+
+	// Per-thread pair lists, merged at the end of FindPairs
+	unsigned int mThreadCount;
+	JobSystem* mJobs = nullptr;
+	std::vector<std::vector<BroadphasePair>> mThreadPairs;
+};
+
+#endif // !_SWEEP_AND_PRUNE_H_DEFINED_
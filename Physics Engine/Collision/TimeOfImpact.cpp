@@ -0,0 +1,63 @@
+//=========================================================================================================
+// TimeOfImpact.cpp: Conservative Advancement with GJK
+//=========================================================================================================
+
+#include "TimeOfImpact.h"
+
+#include "GJK.h"
+
+namespace
+{
+	// A face-on approach reaches the plane in one step, a glancing one on round shapes may take more
+	const int MaxIterations = 32;
+
+	// Close enough to the target distance to count as an impact, as a fraction of it
+	const float TargetTolerance = 0.25f;
+}
+
+TimeOfImpactResult TimeOfImpact(const Shape& a, const Transformf& transformA, const Vector3f& displacement,
+                                const Shape& b, const Transformf& transformB, float targetDistance)
+{
+	TimeOfImpactResult result = { false, 0, { 0, 0, 0 }, { 0, 0, 0 }, 0 };
+	const float tolerance = targetDistance * TargetTolerance;
+
+	GJKCache cache;
+	Transformf current = transformA;
+	float time = 0;
+	while (result.iterations < MaxIterations)
+	{
+		const GJKResult closest = GJKDistance(a, current, b, transformB, &cache);
+		++result.iterations;
+
+		// Overlapping at the start is for the contacts. Later only rounding can get here, stop at the last safe time
+		if (closest.overlap)
+		{
+			result.hit = time > 0;
+			return result;
+		}
+
+		const Vector3f normal = (closest.pointB - closest.pointA) * (1.0f / closest.distance);
+		const float distance = closest.distance - a.radius - b.radius;
+		result.time = time;
+		result.normal = normal;
+		result.point = closest.pointA + normal * a.radius;
+		if (distance <= targetDistance + tolerance)
+		{
+			result.hit = time > 0;
+			return result;
+		}
+
+		// Move to where the closest plane is targetDistance away, B is entirely beyond it
+		const float approach = Dot(displacement, normal);
+		if (approach <= 0)
+			return result;
+		time += (distance - targetDistance) / approach;
+		if (time > 1)
+			return result;
+		current.position = transformA.position + displacement * time;
+	}
+
+	// Still closing in on a glancing approach. Every step was safe, so stopping here is too
+	result.hit = true;
+	return result;
+}
@@ -0,0 +1,34 @@
+//=========================================================================================================
+// TimeOfImpact.h: When a Moving Shape First Comes Within Reach of Another (Continuous Collision)
+// - Conservative advancement: GJK gives the closest points and the plane between the shapes at the current
+//   time. The whole of B is beyond that plane, so A can safely be moved along its path until it reaches
+//   the plane, and the process repeated from there. Each step moves A all the way to the next plane, so
+//   flat faces are reached in one or two steps and round ones in a few more
+// - A moves in a straight line without rotating, B stays where it is. For a body moving faster than its
+//   own thickness in one step, which is what the discrete contacts would miss, the rotation over the step
+//   matters far less than the translation
+// - The GJK simplex is carried from one step to the next, so later GJK runs start next to the answer
+//=========================================================================================================
+
+#ifndef _TIME_OF_IMPACT_H_DEFINED_
+#define _TIME_OF_IMPACT_H_DEFINED_
+
+#include "Shapes.h"
+#include "Transform.h"
+
+struct TimeOfImpactResult
+{
+	bool hit;
+	float time;      // Fraction of the displacement travelled before the impact, 0 to 1
+	Vector3f normal; // World space, unit length, from A towards B at the impact
+	Vector3f point;  // On A's surface at the impact, world space
+	int iterations;  // GJK runs used
+};
+
+// Earliest time A, moved by time * displacement from transformA, comes within targetDistance of B
+// No hit if A is already that close at the start (the contacts deal with it), never gets that close, or
+// is moving away from B
+TimeOfImpactResult TimeOfImpact(const Shape& a, const Transformf& transformA, const Vector3f& displacement,
+                                const Shape& b, const Transformf& transformB, float targetDistance);
+
+#endif // !_TIME_OF_IMPACT_H_DEFINED_
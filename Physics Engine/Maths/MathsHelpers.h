@@ -2,6 +2,8 @@
 // MathsHelpers.h: Contains Conveient Maths Functions
 // - Uses Template Functions to work on Integer, Float and Double Values
 //=========================================================================
+// Header-only so every helper can be inlined into the calling code
+//=========================================================================
 
 #ifndef _MATHS_HELPERS_H_DEFINED_
 #define _MATHS_HELPERS_H_DEFINED_
@@ -18,39 +20,50 @@
 // FloatTypeFor<double> is double
 template<typename T> using FloatTypeFor = std::conditional_t<std::is_floating_point_v<T>, T, float>;
 
+//=================================================
+// Float and Double Versions of IsZero Function
+//=================================================
+
+// Epsilon value is the Range around Zero which is considered Zero
+template<typename T> inline constexpr T EPSILON = T(0);
+template<> inline constexpr float EPSILON<float> = 0.5e-6f;
+template<> inline constexpr double EPSILON<double> = 0.5e-15;
+
 // Test is Floating Point value is Approximately 0
-template <typename T> bool IsZero(const T x);
+// Written without std::abs so it can be used in constant expressions
+template <typename T> constexpr bool IsZero(const T x) noexcept
+{
+	static_assert(std::is_floating_point_v<T>, "IsZero only supports Float and Double values");
+	return x < EPSILON<T> && x > -EPSILON<T>;
+}
 
 // 1 / Sqrt. Used often (e.g. Normalising) so can be optimised, so it gets it's own function
 // Supports Int, Float and Double Values.
 // Use of conditional_t ensures Int version returns a Float result
-template<typename T, typename U = std::conditional_t<std::is_integral_v<T>, float, T>> constexpr U InvSqrt(const T x)
+template<typename T, typename U = std::conditional_t<std::is_integral_v<T>, float, T>> inline U InvSqrt(const T x) noexcept
 {
-	return 1 / std::sqrt(x);
+	return 1 / std::sqrt(static_cast<U>(x));
 }
 
-template<typename T, typename U = std::conditional_t<std::is_integral_v<T>, float, T>> constexpr U Square(const T x)
+template<typename T, typename U = std::conditional_t<std::is_integral_v<T>, float, T>> constexpr U Square(const T x) noexcept
 {
-	return x * x;
+	return static_cast<U>(x) * static_cast<U>(x);
 }
 
 // Pass an angle in Degrees, Returns angle in Radians
 // Supports Int, Float and Double values. use of conditional_t ensure Int versions Returns a Float result
-template<typename T, typename U = std::conditional_t<std::is_integral_v<T>, float, T>> constexpr U ToRadians(T d)
+template<typename T, typename U = std::conditional_t<std::is_integral_v<T>, float, T>> constexpr U ToRadians(T d) noexcept
 {
 	return static_cast<U>(d) * std::numbers::pi_v<U> / 180;
 }
 
 // Pass an angle in Radians. Returns angle in Degrees
 // Supports int, Float and Dobule values. Use of conditional_t ensures Int versions Returns a Float result
-template<typename T, typename U = std::conditional_t<std::is_integral_v<T>, float, T>> constexpr U ToDegrees(T r)
+template<typename T, typename U = std::conditional_t<std::is_integral_v<T>, float, T>> constexpr U ToDegrees(T r) noexcept
 {
 	return static_cast<U>(r) * 180 / std::numbers::pi_v<U>;
 }
 
-// Return random number from a to b (inclusive> - Will return Int, Float or Double of a Random number matching Type of parameters a & b
-template<typename T> T Random(const T a, const T b);
+// Random numbers (Random<T>, RandomGenerator) are in Random.h
 
 #endif // !_MATHS_HELPERS_H_DEFINED_
-
-
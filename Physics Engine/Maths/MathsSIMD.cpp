@@ -0,0 +1,330 @@
+//=========================================================================================================
+// MathsSIMD.cpp: Scalar and SSE2 Matrix Kernels, CPU Feature Detection and Kernel Dispatch
+// - AVX2 / FMA kernels are in MathsSIMD_AVX2.cpp as that file needs different compiler settings
+//=========================================================================================================
+
+#include "MathsSIMD.h"
+
+#if defined(MATHS_SIMD_X86)
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+//===================
+// Scalar Kernels
+//===================
+// Reference implementations, using the Matrix4x4.h functions
+
+static void MultiplyScalar(const Matrix4x4f& a, const Matrix4x4f& b, Matrix4x4f& out)
+{
+	out = a * b;
+}
+
+static void MultiplyBatchScalar(const Matrix4x4f* in, const Matrix4x4f& m, Matrix4x4f* out, std::size_t count)
+{
+	MultiplyBatch(in, m, out, count);
+}
+
+static void TransposeScalar(const Matrix4x4f& m, Matrix4x4f& out)
+{
+	out = Transpose(m);
+}
+
+static bool InverseScalar(const Matrix4x4f& m, Matrix4x4f& out)
+{
+	return Inverse(m, out);
+}
+
+static void TransformScalar(const Matrix4x4f& m, const Vector4f* in, Vector4f* out, std::size_t count)
+{
+	for (std::size_t i = 0; i < count; ++i)
+		out[i] = in[i] * m;
+}
+
+static const MatrixKernels gScalarMatrixKernels = { MultiplyScalar, MultiplyBatchScalar, TransposeScalar, InverseScalar, TransformScalar };
+
+
+#if defined(MATHS_SIMD_X86)
+
+//=================
+// SSE2 Kernels
+//=================
+
+// Shuffle helpers - Select elements x, y, z, w (0-3) from one or two registers
+#define SIMD_SHUFFLE_MASK(x, y, z, w)  ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define SIMD_SWIZZLE(v, x, y, z, w)    _mm_shuffle_ps(v, v, SIMD_SHUFFLE_MASK(x, y, z, w))
+#define SIMD_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, SIMD_SHUFFLE_MASK(x, y, z, w))
+#define SIMD_SPLAT(v, i)               _mm_shuffle_ps(v, v, SIMD_SHUFFLE_MASK(i, i, i, i))
+
+static void MultiplySSE2(const Matrix4x4f& a, const Matrix4x4f& b, Matrix4x4f& out)
+{
+	const float* A = &a.e00;
+	const float* B = &b.e00;
+
+	// Load everything before writing so that "out" can alias either input
+	__m128 a0 = _mm_load_ps(A + 0), a1 = _mm_load_ps(A + 4), a2 = _mm_load_ps(A + 8), a3 = _mm_load_ps(A + 12);
+	__m128 b0 = _mm_load_ps(B + 0), b1 = _mm_load_ps(B + 4), b2 = _mm_load_ps(B + 8), b3 = _mm_load_ps(B + 12);
+
+	// Each result row is a linear combination of the rows of b, weighted by the matching row of a
+	__m128 rows[4] = { a0, a1, a2, a3 };
+	float* R = &out.e00;
+	for (int i = 0; i < 4; ++i)
+	{
+		__m128 r = _mm_mul_ps(SIMD_SPLAT(rows[i], 0), b0);
+		r = _mm_add_ps(r, _mm_mul_ps(SIMD_SPLAT(rows[i], 1), b1));
+		r = _mm_add_ps(r, _mm_mul_ps(SIMD_SPLAT(rows[i], 2), b2));
+		r = _mm_add_ps(r, _mm_mul_ps(SIMD_SPLAT(rows[i], 3), b3));
+		_mm_store_ps(R + i * 4, r);
+	}
+}
+
+static void MultiplyBatchSSE2(const Matrix4x4f* in, const Matrix4x4f& m, Matrix4x4f* out, std::size_t count)
+{
+	// The rows of m stay in registers for the whole batch
+	const float* B = &m.e00;
+	__m128 b0 = _mm_load_ps(B + 0), b1 = _mm_load_ps(B + 4), b2 = _mm_load_ps(B + 8), b3 = _mm_load_ps(B + 12);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const float* A = &in[i].e00;
+		float* R = &out[i].e00;
+		for (int row = 0; row < 4; ++row)
+		{
+			__m128 a = _mm_load_ps(A + row * 4);
+			__m128 r = _mm_mul_ps(SIMD_SPLAT(a, 0), b0);
+			r = _mm_add_ps(r, _mm_mul_ps(SIMD_SPLAT(a, 1), b1));
+			r = _mm_add_ps(r, _mm_mul_ps(SIMD_SPLAT(a, 2), b2));
+			r = _mm_add_ps(r, _mm_mul_ps(SIMD_SPLAT(a, 3), b3));
+			_mm_store_ps(R + row * 4, r); // Each row only depends on the same row of the input, so in-place is safe
+		}
+	}
+}
+
+// Also used by the AVX2 kernel table - a 4x4 transpose doesn't benefit from wider registers
+void TransposeSSE2(const Matrix4x4f& m, Matrix4x4f& out)
+{
+	const float* M = &m.e00;
+	__m128 r0 = _mm_load_ps(M + 0), r1 = _mm_load_ps(M + 4), r2 = _mm_load_ps(M + 8), r3 = _mm_load_ps(M + 12);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	float* R = &out.e00;
+	_mm_store_ps(R + 0, r0);
+	_mm_store_ps(R + 4, r1);
+	_mm_store_ps(R + 8, r2);
+	_mm_store_ps(R + 12, r3);
+}
+
+// 2x2 matrix helpers for the block inverse below. A 2x2 matrix is stored in one register as (m00, m01, m10, m11)
+
+// A * B
+static inline __m128 Mat2Mul(__m128 a, __m128 b)
+{
+	return _mm_add_ps(_mm_mul_ps(a, SIMD_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(SIMD_SWIZZLE(a, 1, 0, 3, 2), SIMD_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// Adjugate(A) * B
+static inline __m128 Mat2AdjMul(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(SIMD_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(SIMD_SWIZZLE(a, 1, 1, 2, 2), SIMD_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// A * Adjugate(B)
+static inline __m128 Mat2MulAdj(__m128 a, __m128 b)
+{
+	return _mm_sub_ps(_mm_mul_ps(a, SIMD_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(SIMD_SWIZZLE(a, 1, 0, 3, 2), SIMD_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// General inverse by splitting the matrix into four 2x2 blocks | A B |
+//                                                               | C D |
+// Also used by the AVX2 kernel table
+bool InverseSSE2(const Matrix4x4f& m, Matrix4x4f& out)
+{
+	const float* M = &m.e00;
+	__m128 r0 = _mm_load_ps(M + 0), r1 = _mm_load_ps(M + 4), r2 = _mm_load_ps(M + 8), r3 = _mm_load_ps(M + 12);
+
+	// Sub-matrices
+	__m128 A = _mm_movelh_ps(r0, r1);
+	__m128 B = _mm_movehl_ps(r1, r0);
+	__m128 C = _mm_movelh_ps(r2, r3);
+	__m128 D = _mm_movehl_ps(r3, r2);
+
+	// Determinants of the sub-matrices as (|A|, |B|, |C|, |D|)
+	__m128 detSub = _mm_sub_ps
+	(
+		_mm_mul_ps(SIMD_SHUFFLE(r0, r2, 0, 2, 0, 2), SIMD_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+		_mm_mul_ps(SIMD_SHUFFLE(r0, r2, 1, 3, 1, 3), SIMD_SHUFFLE(r1, r3, 0, 2, 0, 2))
+	);
+	__m128 detA = SIMD_SPLAT(detSub, 0);
+	__m128 detB = SIMD_SPLAT(detSub, 1);
+	__m128 detC = SIMD_SPLAT(detSub, 2);
+	__m128 detD = SIMD_SPLAT(detSub, 3);
+
+	// Inverse = 1/|M| * | X Y |, working with the adjugates of X, Y, Z and W
+	//                   | Z W |
+	__m128 D_C = Mat2AdjMul(D, C);
+	__m128 A_B = Mat2AdjMul(A, B);
+	__m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, D_C));
+	__m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, A_B));
+	__m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, A_B));
+	__m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, D_C));
+
+	// |M| = |A||D| + |B||C| - trace(A#B * D#C)
+	__m128 tr = _mm_mul_ps(A_B, SIMD_SWIZZLE(D_C, 0, 2, 1, 3));
+	tr = _mm_add_ps(tr, _mm_movehl_ps(tr, tr));
+	tr = _mm_add_ss(tr, SIMD_SPLAT(tr, 1));
+	tr = SIMD_SPLAT(tr, 0);
+	__m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+	if (_mm_cvtss_f32(detM) == 0)
+		return false;
+
+	// (1/|M|, -1/|M|, -1/|M|, 1/|M|) - signs complete the adjugates
+	__m128 rDetM = _mm_div_ps(_mm_setr_ps(1, -1, -1, 1), detM);
+	X_ = _mm_mul_ps(X_, rDetM);
+	Y_ = _mm_mul_ps(Y_, rDetM);
+	Z_ = _mm_mul_ps(Z_, rDetM);
+	W_ = _mm_mul_ps(W_, rDetM);
+
+	// Adjugate swizzle and reassembly of the blocks into rows
+	float* R = &out.e00;
+	_mm_store_ps(R + 0, SIMD_SHUFFLE(X_, Y_, 3, 1, 3, 1));
+	_mm_store_ps(R + 4, SIMD_SHUFFLE(X_, Y_, 2, 0, 2, 0));
+	_mm_store_ps(R + 8, SIMD_SHUFFLE(Z_, W_, 3, 1, 3, 1));
+	_mm_store_ps(R + 12, SIMD_SHUFFLE(Z_, W_, 2, 0, 2, 0));
+	return true;
+}
+
+static void TransformSSE2(const Matrix4x4f& m, const Vector4f* in, Vector4f* out, std::size_t count)
+{
+	const float* M = &m.e00;
+	__m128 r0 = _mm_load_ps(M + 0), r1 = _mm_load_ps(M + 4), r2 = _mm_load_ps(M + 8), r3 = _mm_load_ps(M + 12);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		__m128 v = _mm_load_ps(&in[i].x);
+		__m128 r = _mm_mul_ps(SIMD_SPLAT(v, 0), r0);
+		r = _mm_add_ps(r, _mm_mul_ps(SIMD_SPLAT(v, 1), r1));
+		r = _mm_add_ps(r, _mm_mul_ps(SIMD_SPLAT(v, 2), r2));
+		r = _mm_add_ps(r, _mm_mul_ps(SIMD_SPLAT(v, 3), r3));
+		_mm_store_ps(&out[i].x, r);
+	}
+}
+
+static const MatrixKernels gSSE2MatrixKernels = { MultiplySSE2, MultiplyBatchSSE2, TransposeSSE2, InverseSSE2, TransformSSE2 };
+
+// AVX2 kernels (MathsSIMD_AVX2.cpp). Transpose and inverse reuse the SSE2 versions
+void MultiplyAVX2(const Matrix4x4f& a, const Matrix4x4f& b, Matrix4x4f& out);
+void MultiplyBatchAVX2(const Matrix4x4f* in, const Matrix4x4f& m, Matrix4x4f* out, std::size_t count);
+void TransformAVX2(const Matrix4x4f& m, const Vector4f* in, Vector4f* out, std::size_t count);
+
+static const MatrixKernels gAVX2MatrixKernels = { MultiplyAVX2, MultiplyBatchAVX2, TransposeSSE2, InverseSSE2, TransformAVX2 };
+
+
+//=====================
+// Feature Detection
+//=====================
+
+// Read CPUID leaf / subleaf into registers (eax, ebx, ecx, edx). Returns false if the leaf is not supported
+static bool CPUID(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (static_cast<unsigned int>(info[0]) < leaf)
+		return false;
+
+	__cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+	for (int i = 0; i < 4; ++i)
+		regs[i] = static_cast<unsigned int>(info[i]);
+	return true;
+#else
+	return __get_cpuid_count(leaf, subleaf, &regs[0], &regs[1], &regs[2], &regs[3]) != 0;
+#endif
+}
+
+// Which register states the OS saves on a context switch (XCR0)
+static unsigned long long ReadXCR0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int lo, hi;
+	__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+}
+
+static SIMDLevel DetectSIMDLevelUncached()
+{
+	unsigned int regs[4];
+	if (!CPUID(1, 0, regs))
+		return SIMDLevel::SSE2;
+
+	// AVX registers are only usable if the OS saves them (OSXSAVE and XCR0 bits 1 and 2)
+	bool fma     = (regs[2] & (1u << 12)) != 0;
+	bool osxsave = (regs[2] & (1u << 27)) != 0;
+	bool avx     = (regs[2] & (1u << 28)) != 0;
+	if (!fma || !osxsave || !avx || (ReadXCR0() & 0x6) != 0x6)
+		return SIMDLevel::SSE2;
+
+	if (!CPUID(7, 0, regs) || (regs[1] & (1u << 5)) == 0)
+		return SIMDLevel::SSE2;
+
+	return SIMDLevel::AVX2;
+}
+
+#endif // MATHS_SIMD_X86
+
+
+//=============
+// Dispatch
+//=============
+
+const char* SIMDLevelName(SIMDLevel level)
+{
+	switch (level)
+	{
+	case SIMDLevel::SSE2: return "SSE2";
+	case SIMDLevel::AVX2: return "AVX2";
+	default:              return "Scalar";
+	}
+}
+
+SIMDLevel DetectSIMDLevel()
+{
+#if defined(MATHS_SIMD_X86)
+	static const SIMDLevel level = DetectSIMDLevelUncached();
+	return level;
+#else
+	return SIMDLevel::Scalar;
+#endif
+}
+
+bool IsSIMDLevelSupported(SIMDLevel level)
+{
+	return level <= DetectSIMDLevel();
+}
+
+const MatrixKernels& GetMatrixKernels(SIMDLevel level)
+{
+	if (level > DetectSIMDLevel())
+		level = DetectSIMDLevel();
+
+#if defined(MATHS_SIMD_X86)
+	if (level == SIMDLevel::AVX2)
+		return gAVX2MatrixKernels;
+	if (level == SIMDLevel::SSE2)
+		return gSSE2MatrixKernels;
+#endif
+	return gScalarMatrixKernels;
+}
+
+const MatrixKernels& GetMatrixKernels()
+{
+	static const MatrixKernels& kernels = GetMatrixKernels(DetectSIMDLevel());
+	return kernels;
+}
@@ -0,0 +1,91 @@
+//=========================================================================================================
+// MathsSIMD.h: SIMD Kernels for Matrix4x4f and Vector4f with Runtime Dispatch
+// - Scalar kernels work on any CPU and are the reference results
+// - SSE2 kernels are the x86 baseline (always present on x64)
+// - AVX2 / FMA kernels are only selected when CPUID (and the OS) report support for them
+//=========================================================================================================
+// Matrices use the row-vector convention of Matrix4x4T (Row(3) is the position), so a vector is
+// transformed as v * M and a combined matrix A * B applies A first then B
+//=========================================================================================================
+
+#ifndef _MATHS_SIMD_H_DEFINED_
+#define _MATHS_SIMD_H_DEFINED_
+
+#include "Vector4.h"
+#include "Matrix4x4.h"
+#include "SIMDFloat.h" // For MATHS_SIMD_X86
+
+#include <cstddef>
+
+//============
+// Constants
+//============
+
+// Instruction sets a kernel table can be built for. Ordered so a higher value is a superset of those below
+enum class SIMDLevel
+{
+	Scalar,
+	SSE2,
+	AVX2, // Also requires FMA
+};
+
+// Readable name for a SIMDLevel (e.g. for benchmark output)
+const char* SIMDLevelName(SIMDLevel level);
+
+//=====================
+// Kernel Tables
+//=====================
+
+// Function table of matrix kernels for one instruction set
+// All pointers must be 16 byte aligned, which Matrix4x4f and Vector4f already guarantee
+struct MatrixKernels
+{
+	// out = a * b. "out" may alias "a" or "b"
+	void (*multiply)(const Matrix4x4f& a, const Matrix4x4f& b, Matrix4x4f& out);
+
+	// out[i] = in[i] * m for "count" matrices. "out" may alias "in"
+	void (*multiplyBatch)(const Matrix4x4f* in, const Matrix4x4f& m, Matrix4x4f* out, std::size_t count);
+
+	// out = Transpose(m). "out" may alias "m"
+	void (*transpose)(const Matrix4x4f& m, Matrix4x4f& out);
+
+	// out = General inverse of m. Returns false (and leaves "out" unchanged) if m is singular
+	bool (*inverse)(const Matrix4x4f& m, Matrix4x4f& out);
+
+	// out[i] = in[i] * m for "count" vectors. "out" may alias "in"
+	void (*transform)(const Matrix4x4f& m, const Vector4f* in, Vector4f* out, std::size_t count);
+};
+
+// Best instruction set supported by this CPU and OS (detected once using CPUID)
+SIMDLevel DetectSIMDLevel();
+
+// Returns true if kernels for the given level were compiled in and can run on this CPU
+bool IsSIMDLevelSupported(SIMDLevel level);
+
+// Kernel table for a specific level - used to compare kernels against each other
+// Asking for an unsupported level returns the best supported level below it
+const MatrixKernels& GetMatrixKernels(SIMDLevel level);
+
+// Kernel table for the best level on this CPU - this is the one normal code should use
+const MatrixKernels& GetMatrixKernels();
+
+
+//=====================
+// Convenience Calls
+//=====================
+
+// Multiply two matrices using the best kernels available
+inline Matrix4x4f MultiplySIMD(const Matrix4x4f& a, const Matrix4x4f& b)
+{
+	Matrix4x4f out;
+	GetMatrixKernels().multiply(a, b, out);
+	return out;
+}
+
+// Transform an array of vectors by a matrix using the best kernels available
+inline void TransformSIMD(const Matrix4x4f& m, const Vector4f* in, Vector4f* out, std::size_t count)
+{
+	GetMatrixKernels().transform(m, in, out, count);
+}
+
+#endif // !_MATHS_SIMD_H_DEFINED_
@@ -0,0 +1,107 @@
+//=========================================================================================================
+// MathsSIMD_AVX2.cpp: AVX2 / FMA Matrix Kernels
+// - Only called after DetectSIMDLevel() has confirmed AVX2 and FMA are available
+// - Built with AVX2 code generation enabled for this file only (/arch:AVX2 in the project settings,
+//   the target pragma below for GCC / Clang) so the rest of the engine still runs on SSE2-only CPUs
+//=========================================================================================================
+
+#include "MathsSIMD.h"
+
+#if defined(MATHS_SIMD_X86)
+
+#if !defined(_MSC_VER)
+#pragma GCC target("avx2,fma")
+#endif
+
+#include <immintrin.h>
+
+// Two rows of a are processed at once in the two 128-bit halves of a 256-bit register
+void MultiplyAVX2(const Matrix4x4f& a, const Matrix4x4f& b, Matrix4x4f& out)
+{
+	const float* A = &a.e00;
+	const float* B = &b.e00;
+
+	// Each row of b repeated in both halves
+	__m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B + 0));
+	__m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B + 4));
+	__m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B + 8));
+	__m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B + 12));
+
+	// Rows 0 & 1, then rows 2 & 3. Loaded before storing so "out" can alias either input
+	// Matrix4x4f is only 16 byte aligned so 256-bit loads and stores must be unaligned
+	__m256 a01 = _mm256_loadu_ps(A + 0);
+	__m256 a23 = _mm256_loadu_ps(A + 8);
+
+	__m256 r01 = _mm256_mul_ps(_mm256_permute_ps(a01, 0x00), b0);
+	r01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, 0x55), b1, r01);
+	r01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, 0xAA), b2, r01);
+	r01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, 0xFF), b3, r01);
+
+	__m256 r23 = _mm256_mul_ps(_mm256_permute_ps(a23, 0x00), b0);
+	r23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, 0x55), b1, r23);
+	r23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, 0xAA), b2, r23);
+	r23 = _mm256_fmadd_ps(_mm256_permute_ps(a23, 0xFF), b3, r23);
+
+	float* R = &out.e00;
+	_mm256_storeu_ps(R + 0, r01);
+	_mm256_storeu_ps(R + 8, r23);
+}
+
+// Two rows of each input matrix at once, with the rows of m held in registers for the whole batch
+void MultiplyBatchAVX2(const Matrix4x4f* in, const Matrix4x4f& m, Matrix4x4f* out, std::size_t count)
+{
+	const float* B = &m.e00;
+	__m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B + 0));
+	__m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B + 4));
+	__m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B + 8));
+	__m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(B + 12));
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const float* A = &in[i].e00;
+		float* R = &out[i].e00;
+		for (int half = 0; half < 2; ++half)
+		{
+			__m256 a = _mm256_loadu_ps(A + half * 8);
+			__m256 r = _mm256_mul_ps(_mm256_permute_ps(a, 0x00), b0);
+			r = _mm256_fmadd_ps(_mm256_permute_ps(a, 0x55), b1, r);
+			r = _mm256_fmadd_ps(_mm256_permute_ps(a, 0xAA), b2, r);
+			r = _mm256_fmadd_ps(_mm256_permute_ps(a, 0xFF), b3, r);
+			_mm256_storeu_ps(R + half * 8, r);
+		}
+	}
+}
+
+// Two vectors are transformed at once, with a single SSE / FMA step for an odd vector at the end
+void TransformAVX2(const Matrix4x4f& m, const Vector4f* in, Vector4f* out, std::size_t count)
+{
+	const float* M = &m.e00;
+	__m256 r0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M + 0));
+	__m256 r1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M + 4));
+	__m256 r2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M + 8));
+	__m256 r3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(M + 12));
+
+	std::size_t i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		// Two Vector4f are 32 bytes but only 16 byte aligned, so use an unaligned load
+		__m256 v = _mm256_loadu_ps(&in[i].x);
+		__m256 r = _mm256_mul_ps(_mm256_permute_ps(v, 0x00), r0);
+		r = _mm256_fmadd_ps(_mm256_permute_ps(v, 0x55), r1, r);
+		r = _mm256_fmadd_ps(_mm256_permute_ps(v, 0xAA), r2, r);
+		r = _mm256_fmadd_ps(_mm256_permute_ps(v, 0xFF), r3, r);
+		_mm256_storeu_ps(&out[i].x, r);
+	}
+
+	if (i < count)
+	{
+		__m128 v = _mm_load_ps(&in[i].x);
+		__m128 r = _mm_mul_ps(_mm_permute_ps(v, 0x00), _mm256_castps256_ps128(r0));
+		r = _mm_fmadd_ps(_mm_permute_ps(v, 0x55), _mm256_castps256_ps128(r1), r);
+		r = _mm_fmadd_ps(_mm_permute_ps(v, 0xAA), _mm256_castps256_ps128(r2), r);
+		r = _mm_fmadd_ps(_mm_permute_ps(v, 0xFF), _mm256_castps256_ps128(r3), r);
+		_mm_store_ps(&out[i].x, r);
+	}
+}
+
+#endif // MATHS_SIMD_X86
@@ -0,0 +1,412 @@
+//=========================================================================================================
+// Matrix3x3.h: Encapsulates components of a 3x3 Linear Matrix and Supporting Functions
+// - Uses Template Functions to work on Float and Double Values
+// Float(Matrix3x3, Matrix3x3f), Double(Matrix3x3d) - NOT SUPPORTING INT
+// - For Rotations, Scales and Deformations without Translation, e.g. Inertia Tensors or the Deformation
+//   of a Tetrahedron, where a Matrix4x4 would carry an unused Row and Column
+//=========================================================================================================
+// Header-only: All functions are defined here (constexpr / noexcept where possible) so the compiler
+// can inline them at the call site rather than calling into a seperate .cpp file
+//=========================================================================================================
+// Follows the same conventions as Matrix4x4.h: Row Vectors (v * M), so the Rows are the images of the
+// X, Y and Z axes and A * B applies A first then B. Left-Handed Rotations, Angles in Radians
+//=========================================================================================================
+
+#ifndef _MATRIX3X3_H_DEFINED_
+#define _MATRIX3X3_H_DEFINED_
+
+#include "Vector3.h"
+#include "Matrix4x4.h"
+#include "Quaternion.h"
+
+#include <cmath>
+#include <limits>
+
+// Template Class to Support Float or Double Values. DO NOT use this typename, use simpler ones below.
+template<typename T> class Matrix3x3T;
+
+// Define Convinient names for Matrices of Different Types to avoid using Angle Bracket Syntax in Main Code
+using Matrix3x3f = Matrix3x3T<float>;	// 3x3 Matrix with Float Values
+using Matrix3x3d = Matrix3x3T<double>;	// 3x3 Matrix with Double Values
+using Matrix3x3 = Matrix3x3f;			// Add Extra simple name for Float Values (Most Common Use-Case)
+
+template<typename T> class Matrix3x3T
+{
+	// Only Float and Double are Supported
+	static_assert(std::is_floating_point_v<T>, "Matrix3x3T only supports Float and Double Types");
+
+// ALLOW PUBLIC ACCESS. For simple, well-defined Class
+public:
+	// Matrix Elements
+	T e00, e01, e02;
+	T e10, e11, e12;
+	T e20, e21, e22;
+
+	//===============
+	// Constructors
+	//===============
+
+	// Default Constructor - Leaves Values Uninitialised (For Performance)
+#pragma warning(suppress : 26495)
+	constexpr Matrix3x3T() noexcept {}
+
+	// Construct with 9 Values
+	constexpr Matrix3x3T
+		(
+			T v00, T v01, T v02,
+			T v10, T v11, T v12,
+			T v20, T v21, T v22
+		) noexcept :
+		e00(v00), e01(v01), e02(v02),
+		e10(v10), e11(v11), e12(v12),
+		e20(v20), e21(v21), e22(v22) {}
+
+	// Construct from the Rotation / Scale part of a 4x4 Matrix (its Top-Left 3x3), dropping the Translation
+	constexpr explicit Matrix3x3T(const Matrix4x4T<T>& m) noexcept :
+		e00(m.e00), e01(m.e01), e02(m.e02),
+		e10(m.e10), e11(m.e11), e12(m.e12),
+		e20(m.e20), e21(m.e21), e22(m.e22) {}
+
+	//===============
+	// Data Access
+	//===============
+
+	// Direct Access to rows (0-2) of the Matrix using a Vector3. Returns a Reference so the Result can be
+	// used to Get/Set Values, as Matrix4x4T::Row
+	Vector3T<T>& Row(int row)
+	{
+		return *reinterpret_cast<Vector3T<T>*>(&e00 + row * 3);
+	}
+
+	const Vector3T<T>& Row(int row) const
+	{
+		return *reinterpret_cast<const Vector3T<T>*>(&e00 + row * 3);
+	}
+
+	// Column (0-2) of the Matrix, as a Copy - Columns aren't contiguous so can't be Referenced
+	constexpr Vector3T<T> Column(int column) const noexcept
+	{
+		const T* e = &e00 + column;
+		return { e[0], e[3], e[6] };
+	}
+
+	//=====================
+	// Member Operators
+	//=====================
+
+	// Post-multiply this Matrix by another - applies the other after this one
+	constexpr Matrix3x3T& operator*=(const Matrix3x3T& m) noexcept;
+
+	constexpr Matrix3x3T& operator+=(const Matrix3x3T& m) noexcept;
+	constexpr Matrix3x3T& operator-=(const Matrix3x3T& m) noexcept;
+	constexpr Matrix3x3T& operator*=(const T s) noexcept;
+
+	//==========================
+	// Other Member Functions
+	//==========================
+
+	// Transform a Vector by this Matrix (v * M)
+	constexpr Vector3T<T> TransformVector(const Vector3T<T>& v) const noexcept
+	{
+		return
+		{
+			v.x * e00 + v.y * e10 + v.z * e20,
+			v.x * e01 + v.y * e11 + v.z * e21,
+			v.x * e02 + v.y * e12 + v.z * e22
+		};
+	}
+};
+
+
+//===============================
+// Matrix Factory Functions
+//===============================
+
+// Identity Matrix (No Transformation)
+template<typename T = float> constexpr Matrix3x3T<T> Matrix3x3Identity() noexcept
+{
+	return
+	{
+		1, 0, 0,
+		0, 1, 0,
+		0, 0, 1
+	};
+}
+
+// Matrix with the given Rows - the images of the X, Y and Z axes
+template<typename T> constexpr Matrix3x3T<T> Matrix3x3FromRows(const Vector3T<T>& x, const Vector3T<T>& y, const Vector3T<T>& z) noexcept
+{
+	return
+	{
+		x.x, x.y, x.z,
+		y.x, y.y, y.z,
+		z.x, z.y, z.z
+	};
+}
+
+// Scaling Matrix - Scales x, y and z Seperately
+template<typename T> constexpr Matrix3x3T<T> Matrix3x3Scale(const Vector3T<T>& s) noexcept
+{
+	return
+	{
+		s.x,   0,   0,
+		  0, s.y,   0,
+		  0,   0, s.z
+	};
+}
+
+// Rotation Matrix from a Unit Quaternion - the same Rotation as MatrixRotation(q) in Quaternion.h
+template<typename T> constexpr Matrix3x3T<T> Matrix3x3Rotation(const QuaternionT<T>& q) noexcept
+{
+	T xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	T xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	T wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+	return
+	{
+		1 - 2 * (yy + zz),     2 * (xy + wz),     2 * (xz - wy),
+		    2 * (xy - wz), 1 - 2 * (xx + zz),     2 * (yz + wx),
+		    2 * (xz + wy),     2 * (yz - wx), 1 - 2 * (xx + yy)
+	};
+}
+
+// Outer Product of two Vectors - the Matrix with v * OuterProduct(a, b) = Dot(v, a) * b
+template<typename T> constexpr Matrix3x3T<T> OuterProduct(const Vector3T<T>& a, const Vector3T<T>& b) noexcept
+{
+	return
+	{
+		a.x * b.x, a.x * b.y, a.x * b.z,
+		a.y * b.x, a.y * b.y, a.y * b.z,
+		a.z * b.x, a.z * b.y, a.z * b.z
+	};
+}
+
+
+//========================
+// Non-Member Operators
+//========================
+
+// Matrix - Matrix Multiplication (Order Is Important) - A * B applies A first then B
+template<typename T> constexpr Matrix3x3T<T> operator*(const Matrix3x3T<T>& a, const Matrix3x3T<T>& b) noexcept
+{
+	return
+	{
+		a.e00 * b.e00 + a.e01 * b.e10 + a.e02 * b.e20,
+		a.e00 * b.e01 + a.e01 * b.e11 + a.e02 * b.e21,
+		a.e00 * b.e02 + a.e01 * b.e12 + a.e02 * b.e22,
+
+		a.e10 * b.e00 + a.e11 * b.e10 + a.e12 * b.e20,
+		a.e10 * b.e01 + a.e11 * b.e11 + a.e12 * b.e21,
+		a.e10 * b.e02 + a.e11 * b.e12 + a.e12 * b.e22,
+
+		a.e20 * b.e00 + a.e21 * b.e10 + a.e22 * b.e20,
+		a.e20 * b.e01 + a.e21 * b.e11 + a.e22 * b.e21,
+		a.e20 * b.e02 + a.e21 * b.e12 + a.e22 * b.e22
+	};
+}
+
+// Vector3 - Matrix Multiplication (Row Vector, v * M)
+template<typename T> constexpr Vector3T<T> operator*(const Vector3T<T>& v, const Matrix3x3T<T>& m) noexcept
+{
+	return m.TransformVector(v);
+}
+
+template<typename T> constexpr Matrix3x3T<T> operator+(const Matrix3x3T<T>& a, const Matrix3x3T<T>& b) noexcept
+{
+	return
+	{
+		a.e00 + b.e00, a.e01 + b.e01, a.e02 + b.e02,
+		a.e10 + b.e10, a.e11 + b.e11, a.e12 + b.e12,
+		a.e20 + b.e20, a.e21 + b.e21, a.e22 + b.e22
+	};
+}
+
+template<typename T> constexpr Matrix3x3T<T> operator-(const Matrix3x3T<T>& a, const Matrix3x3T<T>& b) noexcept
+{
+	return
+	{
+		a.e00 - b.e00, a.e01 - b.e01, a.e02 - b.e02,
+		a.e10 - b.e10, a.e11 - b.e11, a.e12 - b.e12,
+		a.e20 - b.e20, a.e21 - b.e21, a.e22 - b.e22
+	};
+}
+
+template<typename T> constexpr Matrix3x3T<T> operator*(const Matrix3x3T<T>& m, const T s) noexcept
+{
+	return
+	{
+		m.e00 * s, m.e01 * s, m.e02 * s,
+		m.e10 * s, m.e11 * s, m.e12 * s,
+		m.e20 * s, m.e21 * s, m.e22 * s
+	};
+}
+
+template<typename T> constexpr Matrix3x3T<T> operator*(const T s, const Matrix3x3T<T>& m) noexcept
+{
+	return m * s;
+}
+
+template<typename T> constexpr Matrix3x3T<T>& Matrix3x3T<T>::operator*=(const Matrix3x3T<T>& m) noexcept
+{
+	return *this = *this * m;
+}
+
+template<typename T> constexpr Matrix3x3T<T>& Matrix3x3T<T>::operator+=(const Matrix3x3T<T>& m) noexcept
+{
+	return *this = *this + m;
+}
+
+template<typename T> constexpr Matrix3x3T<T>& Matrix3x3T<T>::operator-=(const Matrix3x3T<T>& m) noexcept
+{
+	return *this = *this - m;
+}
+
+template<typename T> constexpr Matrix3x3T<T>& Matrix3x3T<T>::operator*=(const T s) noexcept
+{
+	return *this = *this * s;
+}
+
+
+//========================
+// Non-Member Functions
+//========================
+
+// Transpose of a Matrix (Rows become Columns). The Inverse of a Rotation
+template<typename T> constexpr Matrix3x3T<T> Transpose(const Matrix3x3T<T>& m) noexcept
+{
+	return
+	{
+		m.e00, m.e10, m.e20,
+		m.e01, m.e11, m.e21,
+		m.e02, m.e12, m.e22
+	};
+}
+
+// Sum of the Diagonal
+template<typename T> constexpr T Trace(const Matrix3x3T<T>& m) noexcept
+{
+	return m.e00 + m.e11 + m.e22;
+}
+
+// Determinant - the Volume the Matrix scales by, negative if it turns a Shape inside out
+template<typename T> constexpr T Determinant(const Matrix3x3T<T>& m) noexcept
+{
+	return m.e00 * (m.e11 * m.e22 - m.e12 * m.e21) - m.e01 * (m.e10 * m.e22 - m.e12 * m.e20) + m.e02 * (m.e10 * m.e21 - m.e11 * m.e20);
+}
+
+// Inverse of any Matrix using Cofactors (Adjugate / Determinant)
+// Returns false and leaves "out" unchanged if the Matrix is Singular (has no Inverse)
+template<typename T> constexpr bool Inverse(const Matrix3x3T<T>& m, Matrix3x3T<T>& out) noexcept
+{
+	T c00 = m.e11 * m.e22 - m.e12 * m.e21;
+	T c01 = m.e12 * m.e20 - m.e10 * m.e22;
+	T c02 = m.e10 * m.e21 - m.e11 * m.e20;
+
+	T det = m.e00 * c00 + m.e01 * c01 + m.e02 * c02;
+	if (det == 0)
+		return false;
+
+	T invDet = 1 / det;
+	out =
+	{
+		c00 * invDet, (m.e02 * m.e21 - m.e01 * m.e22) * invDet, (m.e01 * m.e12 - m.e02 * m.e11) * invDet,
+		c01 * invDet, (m.e00 * m.e22 - m.e02 * m.e20) * invDet, (m.e02 * m.e10 - m.e00 * m.e12) * invDet,
+		c02 * invDet, (m.e01 * m.e20 - m.e00 * m.e21) * invDet, (m.e00 * m.e11 - m.e01 * m.e10) * invDet
+	};
+	return true;
+}
+
+// Inverse of any Matrix. Returns the Identity Matrix if the Matrix is Singular (has no Inverse)
+template<typename T> constexpr Matrix3x3T<T> Inverse(const Matrix3x3T<T>& m) noexcept
+{
+	Matrix3x3T<T> out = Matrix3x3Identity<T>();
+	Inverse(m, out);
+	return out;
+}
+
+// Square Root of the Sum of the Squares of the Elements (Frobenius Norm)
+template<typename T> T Norm(const Matrix3x3T<T>& m) noexcept
+{
+	return std::sqrt(m.Row(0).LengthSq() + m.Row(1).LengthSq() + m.Row(2).LengthSq());
+}
+
+
+//========================
+// Polar Decomposition
+//========================
+
+// Rotation closest to m, found by turning q towards it - q is the starting guess and the result.
+// Each iteration turns the rotation's axes towards m's rows by the torque between them, scaled as a Newton
+// step (Mueller et al. 2016, "A Robust Method to Extract the Rotational Part of Deformations"). Always a
+// rotation however m is deformed, even turned inside out, and from a nearby guess (e.g. last step's) it
+// takes one or two iterations. Stops when the turn is below tolerance (Radians) or after maxIterations.
+// Inside out with its two smallest stretches nearly equal, the closest rotation is barely better than
+// its neighbours and is only found roughly
+template<typename T> void ExtractRotation(const Matrix3x3T<T>& m, QuaternionT<T>& q, int maxIterations = 20, T tolerance = T(1e-6)) noexcept
+{
+	auto alignmentOf = [&](const Matrix3x3T<T>& r)
+	{
+		return Dot(r.Row(0), m.Row(0)) + Dot(r.Row(1), m.Row(1)) + Dot(r.Row(2), m.Row(2));
+	};
+	auto turned = [](const QuaternionT<T>& from, const Vector3T<T>& turn, T angle)
+	{
+		return Normalise(QuaternionAxisAngle(turn / angle, angle) * from);
+	};
+
+	for (int iteration = 0; iteration < maxIterations; ++iteration)
+	{
+		const Matrix3x3T<T> r = Matrix3x3Rotation(q);
+		const Vector3T<T> torque = Cross(r.Row(0), m.Row(0)) + Cross(r.Row(1), m.Row(1)) + Cross(r.Row(2), m.Row(2));
+		const T alignment = alignmentOf(r);
+		const Vector3T<T> turn = torque * (1 / (std::abs(alignment) + T(1e-9)));
+		const T angle = turn.Length();
+		if (angle < tolerance)
+			break;
+
+		// The paper's step leaves the symmetric part of sum OuterProduct(r_i, m_i) out of the curvature, which
+		// slows it a lot when m is turned inside out. Near the answer the curvature with it is positive
+		// definite (its leading minors all positive), and the full Newton step is taken if it aligns better
+		const Matrix3x3T<T> w = Transpose(r) * m;
+		Matrix3x3T<T> curvature = (w + Transpose(w)) * T(-0.5);
+		curvature.e00 += alignment;
+		curvature.e11 += alignment;
+		curvature.e22 += alignment;
+		const T minor = curvature.e00 * curvature.e11 - curvature.e01 * curvature.e10;
+		Matrix3x3T<T> inverse;
+		if (curvature.e00 > 0 && minor > 0 && Determinant(curvature) > 0 && Inverse(curvature, inverse))
+		{
+			const Vector3T<T> newton = torque * inverse;
+			const T newtonAngle = newton.Length();
+			const QuaternionT<T> candidate = turned(q, newton, newtonAngle);
+			if (newtonAngle > 0 && alignmentOf(Matrix3x3Rotation(candidate)) > alignment)
+			{
+				q = candidate;
+				if (newtonAngle < tolerance)
+					break;
+				continue;
+			}
+		}
+		q = turned(q, turn, angle);
+	}
+}
+
+// Split m into a Stretch then a Rotation: m = stretch * rotation, stretch Symmetric. For a Matrix that
+// doesn't turn Shapes inside out (positive Determinant) the Stretch is Positive Definite, the Standard
+// Polar Decomposition. Otherwise the Rotation is still the closest one, the Stretch takes the Reflection
+template<typename T> void PolarDecomposition(const Matrix3x3T<T>& m, Matrix3x3T<T>& rotation, Matrix3x3T<T>& stretch) noexcept
+{
+	// Start from m's rows made orthonormal (Gram-Schmidt, the third from the first two so it is a rotation),
+	// already close, as from far away (e.g. half a turn) the iteration can start with no torque at all
+	QuaternionT<T> q = QuaternionIdentity<T>();
+	const Vector3T<T> x = Normalise(m.Row(0));
+	const Vector3T<T> y = Normalise(m.Row(1) - x * Dot(m.Row(1), x));
+	if (!IsZero(x.LengthSq()) && !IsZero(y.LengthSq()))
+	{
+		const Vector3T<T> z = Cross(x, y);
+		q = Normalise(QuaternionFromMatrix(Matrix4x4T<T>{ x.x, x.y, x.z, 0, y.x, y.y, y.z, 0, z.x, z.y, z.z, 0, 0, 0, 0, 1 }));
+	}
+	ExtractRotation(m, q, 50, std::numeric_limits<T>::epsilon() * 8);
+	rotation = Matrix3x3Rotation(q);
+	stretch = m * Transpose(rotation);
+}
+
+#endif // !_MATRIX3X3_H_DEFINED_
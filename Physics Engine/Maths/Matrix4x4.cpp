@@ -1 +0,0 @@
-#include "Matrix4x4.h"
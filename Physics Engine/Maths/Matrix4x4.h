@@ -3,9 +3,8 @@
 // - Uses Template Functions to work on Float and Double Values
 // Float(Vector3, Vector3i), Double(Vector3d) - NOT SUPPORTING INT
 //=========================================================================================================
-// Template Classes usually put all code in Header.h files. However explicit template instantiation is
-// used at the end of the .cpp file. Allows for code to be in the cpp file and
-// the Class Interface here
+// Header-only: All functions are defined here (constexpr / noexcept where possible) so the compiler
+// can inline them at the call site rather than calling into a seperate .cpp file
 //=========================================================================================================
 
 #ifndef _MATRIX4X4_H_DEFINED_
@@ -14,6 +13,8 @@
 #include "Vector3.h"
 #include "Vector4.h"
 
+#include <cstddef>
+
 // Template Class to Support Float or Double Values. DO NOT use this typename, use simpler ones below.
 template<typename T> class Matrix4x4T;
 
@@ -22,8 +23,12 @@ using Matrix4x4f = Matrix4x4T<float>;	// 4x4 Matrix with Float Values
 using Matrix4x4d = Matrix4x4T<double>;	// 4x4 Matrix with Double Values
 using Matrix4x4 = Matrix4x4f;		// Add Extra simple name for Float Values (Most Common Use-Case)
 
-template<typename T> class Matrix4x4T
+// Aligned to 16 bytes so each row of a Matrix4x4f can be loaded directly into an SSE register (see MathsSIMD.h)
+template<typename T> class alignas(16) Matrix4x4T
 {
+	// Only Float and Double are Supported
+	static_assert(std::is_floating_point_v<T>, "Matrix4x4T only supports Float and Double Types");
+
 // ALLOW PUBLIC ACCESS. For simple, well-defined Class
 public:
 	// Matrix Elements
@@ -38,23 +43,23 @@ public:
 
 	// Default Constructor - Leaves Values Uninitialised (For Performance)
 #pragma warning(suppress : 26495)
-	Matrix4x4T<T>() {}
+	constexpr Matrix4x4T() noexcept {}
 
 	// Construct with 16 Values
-	Matrix4x4T<T>
+	constexpr Matrix4x4T
 		(
 			T v00, T v01, T v02, T v03,
 			T v10, T v11, T v12, T v13,
 			T v20, T v21, T v22, T v23,
 			T v30, T v31, T v32, T v33
-		) :
+		) noexcept :
 		e00(v00), e01(v01), e02(v02), e03(v03),
 		e10(v10), e11(v11), e12(v12), e13(v13),
 		e20(v20), e21(v21), e22(v22), e23(v23),
 		e30(v30), e31(v31), e32(v32), e33(v33) {}
 
 	// Construct using Pointer to 16 Values
-	explicit Matrix4x4T<T>(T* elts)
+	explicit Matrix4x4T(const T* elts) noexcept
 		// Explicit doesn't allow Conversion from Pointer to Vector2 without writing the constuctor name
 		// NOT ALLOWED:
 		// Vector2 v = pointer;
@@ -62,18 +67,16 @@ public:
 		// ALLOWED:
 		// Vector2 v = Vector2(pointer)
 	{
-		*this = *reinterpret_cast<Matrix4x4T<T>*>(elts);
+		*this = *reinterpret_cast<const Matrix4x4T<T>*>(elts);
 	}
 
 	// Construct Matrix from Position, Euler Angles(x, y and z Rotations), and Scale (x, y and z Seprately)
-	Matrix4x4T<T>(Vector3T<T> position, Vector3T<T> rotations, Vector3T<T> scales)
-	{
-		//*this = MatrixScale(scales) * MatrixRotation(rotations) * MatrixTranslation(position);
-	}
+	// Defined after the Matrix Factory Functions below
+	Matrix4x4T(Vector3T<T> position, Vector3T<T> rotations, Vector3T<T> scales) noexcept;
 
 	// Construct Matrix from Position, Euler Angles (x, y and z rotation) and uniform scale
 	// Scale and Rotations have Defaults, only Position is Required
-	explicit Matrix4x4T<T>(Vector3T<T> position, Vector3T<T> rotations = { 0,0,0 }, float scale = 1)
+	explicit Matrix4x4T(Vector3T<T> position, Vector3T<T> rotations = { 0,0,0 }, T scale = 1)
 		: Matrix4x4T<T>(position, rotations, { scale, scale, scale }) {} // Forward to Constructor Above
 
 	//===============
@@ -95,7 +98,7 @@ public:
 	// Using as a Getter when the Matrix is a Constant
 	const Vector3T<T>& Row(int row) const
 	{
-		return Vector3T<T>(&e00 + row * 4);
+		return *reinterpret_cast<const Vector3T<T>*>(&e00 + row * 4);
 	}
 
 	// Direct Access to X axis of the Matrix
@@ -114,7 +117,7 @@ public:
 	// Returns a reference can be used to Get/Set
 	//		Vector3 v = myMatrix.ZAxis()
 	//		myMatrix.ZAxis() = {1, 2, 3}
-	Vector3T<T>& ZAxis() { return Row(0); }
+	Vector3T<T>& ZAxis() { return Row(2); }
 
 	// Direct Access to Position of the Matrix
 	// Returns a reference can be used to Get/Set
@@ -122,7 +125,329 @@ public:
 	//		myMatrix.Position() = {1, 2, 3}
 	Vector3T<T>& Position() { return Row(3); }
 
+	// Const versions of the Axis / Position Getters
+	const Vector3T<T>& XAxis() const { return Row(0); }
+	const Vector3T<T>& YAxis() const { return Row(1); }
+	const Vector3T<T>& ZAxis() const { return Row(2); }
+	const Vector3T<T>& Position() const { return Row(3); }
+
+	//=====================
+	// Member Operators
+	//=====================
+
+	// Post-multiply this Matrix by another (e.g. World *= MatrixTranslation(v) - moves the Model after its Current Transform)
+	constexpr Matrix4x4T& operator*=(const Matrix4x4T& m) noexcept;
+
+	//==========================
+	// Other Member Functions
+	//==========================
+
+	// Transform a Point by this Matrix (w = 1, so includes Translation)
+	constexpr Vector3T<T> TransformPoint(const Vector3T<T>& p) const noexcept
+	{
+		return
+		{
+			p.x * e00 + p.y * e10 + p.z * e20 + e30,
+			p.x * e01 + p.y * e11 + p.z * e21 + e31,
+			p.x * e02 + p.y * e12 + p.z * e22 + e32
+		};
+	}
 
+	// Transform a Direction Vector by this Matrix (w = 0, so no Translation)
+	constexpr Vector3T<T> TransformVector(const Vector3T<T>& v) const noexcept
+	{
+		return
+		{
+			v.x * e00 + v.y * e10 + v.z * e20,
+			v.x * e01 + v.y * e11 + v.z * e21,
+			v.x * e02 + v.y * e12 + v.z * e22
+		};
+	}
 };
 
+
+//=============================================================================================
+// Matrix Conventions
+//=============================================================================================
+// Row Vectors are used (v * M), so Row(3) holds the Translation and a Combined Matrix A * B
+// applies A first then B. e.g. MatrixScale(s) * MatrixRotation(r) * MatrixTranslation(p)
+// scales, then rotates, then positions a Model.
+// Rotations are Left-Handed (DirectX Convention), Angles are in Radians
+//=============================================================================================
+
+//===============================
+// Matrix Factory Functions
+//===============================
+
+// Identity Matrix (No Transformation)
+template<typename T = float> constexpr Matrix4x4T<T> MatrixIdentity() noexcept
+{
+	return
+	{
+		1, 0, 0, 0,
+		0, 1, 0, 0,
+		0, 0, 1, 0,
+		0, 0, 0, 1
+	};
+}
+
+// Translation Matrix - Moves by Vector t
+template<typename T> constexpr Matrix4x4T<T> MatrixTranslation(const Vector3T<T>& t) noexcept
+{
+	return
+	{
+		  1,   0,   0, 0,
+		  0,   1,   0, 0,
+		  0,   0,   1, 0,
+		t.x, t.y, t.z, 1
+	};
+}
+
+// Rotation Matrices around the X, Y and Z axes by Angle (in Radians)
+template<typename T> Matrix4x4T<T> MatrixRotationX(const T angle) noexcept
+{
+	T s = std::sin(angle);
+	T c = std::cos(angle);
+	return
+	{
+		1,  0, 0, 0,
+		0,  c, s, 0,
+		0, -s, c, 0,
+		0,  0, 0, 1
+	};
+}
+
+template<typename T> Matrix4x4T<T> MatrixRotationY(const T angle) noexcept
+{
+	T s = std::sin(angle);
+	T c = std::cos(angle);
+	return
+	{
+		c, 0, -s, 0,
+		0, 1,  0, 0,
+		s, 0,  c, 0,
+		0, 0,  0, 1
+	};
+}
+
+template<typename T> Matrix4x4T<T> MatrixRotationZ(const T angle) noexcept
+{
+	T s = std::sin(angle);
+	T c = std::cos(angle);
+	return
+	{
+		 c, s, 0, 0,
+		-s, c, 0, 0,
+		 0, 0, 1, 0,
+		 0, 0, 0, 1
+	};
+}
+
+// Rotation Matrix from Euler Angles (x, y and z Rotations in Radians)
+// Applied in the order Z, X, then Y. Written out in full rather than multiplying the three Matrices above
+template<typename T> Matrix4x4T<T> MatrixRotation(const Vector3T<T>& rotations) noexcept
+{
+	T sx = std::sin(rotations.x), cx = std::cos(rotations.x);
+	T sy = std::sin(rotations.y), cy = std::cos(rotations.y);
+	T sz = std::sin(rotations.z), cz = std::cos(rotations.z);
+	return
+	{
+		cz * cy + sz * sx * sy,  sz * cx, -cz * sy + sz * sx * cy, 0,
+		-sz * cy + cz * sx * sy, cz * cx,  sz * sy + cz * sx * cy, 0,
+		cx * sy,                 -sx,      cx * cy,                0,
+		0,                       0,        0,                      1
+	};
+}
+
+// Scaling Matrix - Scales x, y and z Seperately
+template<typename T> constexpr Matrix4x4T<T> MatrixScale(const Vector3T<T>& s) noexcept
+{
+	return
+	{
+		s.x,   0,   0, 0,
+		  0, s.y,   0, 0,
+		  0,   0, s.z, 0,
+		  0,   0,   0, 1
+	};
+}
+
+// Scaling Matrix - Uniform Scale
+template<typename T> constexpr Matrix4x4T<T> MatrixScale(const T s) noexcept
+{
+	return MatrixScale(Vector3T<T>{ s, s, s });
+}
+
+
+//========================
+// Non-Member Operators
+//========================
+
+// Matrix - Matrix Multiplication (Order Is Important)
+template<typename T> constexpr Matrix4x4T<T> operator*(const Matrix4x4T<T>& a, const Matrix4x4T<T>& b) noexcept
+{
+	return
+	{
+		a.e00 * b.e00 + a.e01 * b.e10 + a.e02 * b.e20 + a.e03 * b.e30,
+		a.e00 * b.e01 + a.e01 * b.e11 + a.e02 * b.e21 + a.e03 * b.e31,
+		a.e00 * b.e02 + a.e01 * b.e12 + a.e02 * b.e22 + a.e03 * b.e32,
+		a.e00 * b.e03 + a.e01 * b.e13 + a.e02 * b.e23 + a.e03 * b.e33,
+
+		a.e10 * b.e00 + a.e11 * b.e10 + a.e12 * b.e20 + a.e13 * b.e30,
+		a.e10 * b.e01 + a.e11 * b.e11 + a.e12 * b.e21 + a.e13 * b.e31,
+		a.e10 * b.e02 + a.e11 * b.e12 + a.e12 * b.e22 + a.e13 * b.e32,
+		a.e10 * b.e03 + a.e11 * b.e13 + a.e12 * b.e23 + a.e13 * b.e33,
+
+		a.e20 * b.e00 + a.e21 * b.e10 + a.e22 * b.e20 + a.e23 * b.e30,
+		a.e20 * b.e01 + a.e21 * b.e11 + a.e22 * b.e21 + a.e23 * b.e31,
+		a.e20 * b.e02 + a.e21 * b.e12 + a.e22 * b.e22 + a.e23 * b.e32,
+		a.e20 * b.e03 + a.e21 * b.e13 + a.e22 * b.e23 + a.e23 * b.e33,
+
+		a.e30 * b.e00 + a.e31 * b.e10 + a.e32 * b.e20 + a.e33 * b.e30,
+		a.e30 * b.e01 + a.e31 * b.e11 + a.e32 * b.e21 + a.e33 * b.e31,
+		a.e30 * b.e02 + a.e31 * b.e12 + a.e32 * b.e22 + a.e33 * b.e32,
+		a.e30 * b.e03 + a.e31 * b.e13 + a.e32 * b.e23 + a.e33 * b.e33
+	};
+}
+
+// Vector4 - Matrix Multiplication (Row Vector, v * M)
+template<typename T> constexpr Vector4T<T> operator*(const Vector4T<T>& v, const Matrix4x4T<T>& m) noexcept
+{
+	return
+	{
+		v.x * m.e00 + v.y * m.e10 + v.z * m.e20 + v.w * m.e30,
+		v.x * m.e01 + v.y * m.e11 + v.z * m.e21 + v.w * m.e31,
+		v.x * m.e02 + v.y * m.e12 + v.z * m.e22 + v.w * m.e32,
+		v.x * m.e03 + v.y * m.e13 + v.z * m.e23 + v.w * m.e33
+	};
+}
+
+// Post-multiply this Matrix by another
+template<typename T> constexpr Matrix4x4T<T>& Matrix4x4T<T>::operator*=(const Matrix4x4T<T>& m) noexcept
+{
+	return *this = *this * m;
+}
+
+// Construct Matrix from Position, Euler Angles and Scale - Scales, then Rotates, then Translates
+template<typename T> Matrix4x4T<T>::Matrix4x4T(Vector3T<T> position, Vector3T<T> rotations, Vector3T<T> scales) noexcept
+{
+	*this = MatrixRotation(rotations);
+
+	// Equivalent to MatrixScale(scales) * MatrixRotation(rotations) * MatrixTranslation(position), but cheaper
+	XAxis() *= scales.x;
+	YAxis() *= scales.y;
+	ZAxis() *= scales.z;
+	Position() = position;
+}
+
+
+//========================
+// Non-Member Functions
+//========================
+
+// Transpose of a Matrix (Rows become Columns)
+template<typename T> constexpr Matrix4x4T<T> Transpose(const Matrix4x4T<T>& m) noexcept
+{
+	return
+	{
+		m.e00, m.e10, m.e20, m.e30,
+		m.e01, m.e11, m.e21, m.e31,
+		m.e02, m.e12, m.e22, m.e32,
+		m.e03, m.e13, m.e23, m.e33
+	};
+}
+
+// General Inverse of any Matrix using Cofactors (Adjugate / Determinant)
+// Returns false and leaves "out" unchanged if the Matrix is Singular (has no Inverse)
+template<typename T> constexpr bool Inverse(const Matrix4x4T<T>& m, Matrix4x4T<T>& out) noexcept
+{
+	// 2x2 Determinants of the Bottom Two Rows, shared between the Cofactors
+	T s0 = m.e20 * m.e31 - m.e21 * m.e30;
+	T s1 = m.e20 * m.e32 - m.e22 * m.e30;
+	T s2 = m.e20 * m.e33 - m.e23 * m.e30;
+	T s3 = m.e21 * m.e32 - m.e22 * m.e31;
+	T s4 = m.e21 * m.e33 - m.e23 * m.e31;
+	T s5 = m.e22 * m.e33 - m.e23 * m.e32;
+
+	// 2x2 Determinants of the Top Two Rows
+	T c0 = m.e00 * m.e11 - m.e01 * m.e10;
+	T c1 = m.e00 * m.e12 - m.e02 * m.e10;
+	T c2 = m.e00 * m.e13 - m.e03 * m.e10;
+	T c3 = m.e01 * m.e12 - m.e02 * m.e11;
+	T c4 = m.e01 * m.e13 - m.e03 * m.e11;
+	T c5 = m.e02 * m.e13 - m.e03 * m.e12;
+
+	T det = c0 * s5 - c1 * s4 + c2 * s3 + c3 * s2 - c4 * s1 + c5 * s0;
+	if (det == 0)
+		return false;
+
+	T invDet = 1 / det;
+	out =
+	{
+		( m.e11 * s5 - m.e12 * s4 + m.e13 * s3) * invDet,
+		(-m.e01 * s5 + m.e02 * s4 - m.e03 * s3) * invDet,
+		( m.e31 * c5 - m.e32 * c4 + m.e33 * c3) * invDet,
+		(-m.e21 * c5 + m.e22 * c4 - m.e23 * c3) * invDet,
+
+		(-m.e10 * s5 + m.e12 * s2 - m.e13 * s1) * invDet,
+		( m.e00 * s5 - m.e02 * s2 + m.e03 * s1) * invDet,
+		(-m.e30 * c5 + m.e32 * c2 - m.e33 * c1) * invDet,
+		( m.e20 * c5 - m.e22 * c2 + m.e23 * c1) * invDet,
+
+		( m.e10 * s4 - m.e11 * s2 + m.e13 * s0) * invDet,
+		(-m.e00 * s4 + m.e01 * s2 - m.e03 * s0) * invDet,
+		( m.e30 * c4 - m.e31 * c2 + m.e33 * c0) * invDet,
+		(-m.e20 * c4 + m.e21 * c2 - m.e23 * c0) * invDet,
+
+		(-m.e10 * s3 + m.e11 * s1 - m.e12 * s0) * invDet,
+		( m.e00 * s3 - m.e01 * s1 + m.e02 * s0) * invDet,
+		(-m.e30 * c3 + m.e31 * c1 - m.e32 * c0) * invDet,
+		( m.e20 * c3 - m.e21 * c1 + m.e22 * c0) * invDet
+	};
+	return true;
+}
+
+// General Inverse of any Matrix. Returns the Identity Matrix if the Matrix is Singular (has no Inverse)
+template<typename T> constexpr Matrix4x4T<T> Inverse(const Matrix4x4T<T>& m) noexcept
+{
+	Matrix4x4T<T> out = MatrixIdentity<T>();
+	Inverse(m, out);
+	return out;
+}
+
+// Fast Inverse for Affine Matrices built from Scale, Rotation and Translation only (e.g. Model World Matrices)
+// Requires the X, Y and Z axes to be at Right Angles to each other (No Shear) and the Last Column to be (0, 0, 0, 1)
+// The Axes are then an Orthonormal Rotation scaled per-axis, so the 3x3 Inverse is the Transpose with each
+// Axis divided by its Square Length - No Determinant or Cofactors needed
+template<typename T> Matrix4x4T<T> InverseAffine(const Matrix4x4T<T>& m) noexcept
+{
+	const Vector3T<T>& x = m.XAxis();
+	const Vector3T<T>& y = m.YAxis();
+	const Vector3T<T>& z = m.ZAxis();
+	const Vector3T<T>& p = m.Position();
+
+	// Zero Length Axes give a zero Row rather than Infinities
+	T lengthSq;
+	lengthSq = x.LengthSq(); T invX = IsZero(lengthSq) ? 0 : 1 / lengthSq;
+	lengthSq = y.LengthSq(); T invY = IsZero(lengthSq) ? 0 : 1 / lengthSq;
+	lengthSq = z.LengthSq(); T invZ = IsZero(lengthSq) ? 0 : 1 / lengthSq;
+
+	return
+	{
+		x.x * invX,          y.x * invY,          z.x * invZ,          0,
+		x.y * invX,          y.y * invY,          z.y * invZ,          0,
+		x.z * invX,          y.z * invY,          z.z * invZ,          0,
+		-Dot(p, x) * invX,   -Dot(p, y) * invY,   -Dot(p, z) * invZ,   1
+	};
+}
+
+// Multiply an Array of Matrices by the same Matrix: out[i] = in[i] * m (e.g. Model World Matrices by a View Matrix)
+// "out" may be the same array as "in". For Matrix4x4f see also MatrixKernels::multiplyBatch in MathsSIMD.h
+template<typename T> void MultiplyBatch(const Matrix4x4T<T>* in, const Matrix4x4T<T>& m, Matrix4x4T<T>* out, std::size_t count) noexcept
+{
+	// Copy so m can't alias "out", which would stop the compiler keeping it in registers
+	const Matrix4x4T<T> b = m;
+	for (std::size_t i = 0; i < count; ++i)
+		out[i] = in[i] * b;
+}
+
 #endif // !_MATRIX4X4_H_DEFINED_
@@ -0,0 +1,286 @@
+//=========================================================================================================
+// Quaternion.h: Encapsulates a Rotation as a Quaternion (x, y, z, w) and Supporting Functions
+// - Uses Template Functions to work on Float and Double Values
+// Float(Quaternion, Quaternionf), Double(Quaterniond) - NOT SUPPORTING INT
+//=========================================================================================================
+// Header-only: All functions are defined here (constexpr / noexcept where possible) so the compiler
+// can inline them at the call site
+//=========================================================================================================
+// Follows the same conventions as Matrix4x4.h: Left-Handed rotations, angles in Radians, and
+// MatrixRotation(q) gives the same Rotation Matrix as the matching MatrixRotationX/Y/Z calls
+// Quaternion Multiplication q1 * q2 is the standard (Hamilton) product, which applies q2 FIRST then q1.
+// This is the opposite order to Matrix Multiplication, where A * B applies A first
+//=========================================================================================================
+
+#ifndef _QUATERNION_H_DEFINED_
+#define _QUATERNION_H_DEFINED_
+
+#include "Vector3.h"
+#include "Matrix4x4.h"
+
+// Template Class to Support Float or Double Values. DO NOT use this typename, use simpler ones below.
+template<typename T> class QuaternionT;
+
+// Define Convinient names for Quaternions of Different Types to avoid using Angle Bracket Syntax in Main Code
+using Quaternionf = QuaternionT<float>;		// Quaternion with Float Values
+using Quaterniond = QuaternionT<double>;	// Quaternion with Double Values
+using Quaternion = Quaternionf;				// Add Extra simple name for Float Values (Most Common Use-Case)
+
+template<typename T> class QuaternionT
+{
+	// Only Float and Double are Supported
+	static_assert(std::is_floating_point_v<T>, "QuaternionT only supports Float and Double Types");
+
+// ALLOW PUBLIC ACCESS. For simple, well-defined Class
+public:
+	// Vector (Axis) Part
+	T x;
+	T y;
+	T z;
+
+	// Scalar (Angle) Part
+	T w;
+
+	//===============
+	// Constructors
+	//===============
+
+	// Default Constructor - Leaves Values Uninitialised (For Performance)
+#pragma warning(suppress: 26495)
+	constexpr QuaternionT() noexcept {}
+
+	// Construct with 4 Values
+	constexpr QuaternionT(const T xIn, const T yIn, const T zIn, const T wIn) noexcept
+		: x(xIn), y(yIn), z(zIn), w(wIn) {}
+
+	// Construct from Vector Part and Scalar Part
+	constexpr QuaternionT(const Vector3T<T>& v, const T wIn) noexcept
+		: x(v.x), y(v.y), z(v.z), w(wIn) {}
+
+	//=====================
+	// Member Operators
+	//=====================
+
+	// Combine another Rotation with this one - q *= r applies r FIRST then the original q
+	constexpr QuaternionT& operator*=(const QuaternionT& q) noexcept;
+
+	// Negate all Components - Represents the SAME Rotation (Quaternions cover each Rotation twice)
+	constexpr QuaternionT operator-() const noexcept
+	{
+		return { -x, -y, -z, -w };
+	}
+
+	//==========================
+	// Other Member Functions
+	//==========================
+
+	// Vector Part of the Quaternion
+	constexpr Vector3T<T> Vector() const noexcept
+	{
+		return { x, y, z };
+	}
+
+	// Returns the Length of the Quaternion (1 for a Rotation)
+	T Length() const noexcept
+	{
+		return std::sqrt(LengthSq());
+	}
+
+	// Returns the Square Length of the Quaternion
+	constexpr T LengthSq() const noexcept
+	{
+		return x * x + y * y + z * z + w * w;
+	}
+};
+
+//===============================
+// Quaternion Factory Functions
+//===============================
+
+// Identity Quaternion (No Rotation)
+template<typename T = float> constexpr QuaternionT<T> QuaternionIdentity() noexcept
+{
+	return { 0, 0, 0, 1 };
+}
+
+// Rotation of Angle (Radians) around a given Axis. Axis must be Unit Length
+template<typename T> QuaternionT<T> QuaternionAxisAngle(const Vector3T<T>& axis, const T angle) noexcept
+{
+	T halfAngle = angle / 2;
+	return { axis * std::sin(halfAngle), std::cos(halfAngle) };
+}
+
+// Rotation from Euler Angles (x, y and z Rotations in Radians) - Same Rotation as MatrixRotation(rotations)
+// Applied in the order Z, X, then Y. Written out in full rather than multiplying three Axis-Angle Quaternions
+template<typename T> QuaternionT<T> QuaternionFromEuler(const Vector3T<T>& rotations) noexcept
+{
+	T sx = std::sin(rotations.x / 2), cx = std::cos(rotations.x / 2);
+	T sy = std::sin(rotations.y / 2), cy = std::cos(rotations.y / 2);
+	T sz = std::sin(rotations.z / 2), cz = std::cos(rotations.z / 2);
+	return
+	{
+		cy * sx * cz + sy * cx * sz,
+		sy * cx * cz - cy * sx * sz,
+		cy * cx * sz - sy * sx * cz,
+		cy * cx * cz + sy * sx * sz
+	};
+}
+
+// Rotation from the Rotation part of a Matrix. The X, Y and Z axes must be Unit Length and at Right Angles
+// (i.e. No Scale or Shear) - use Normalise on the Axes first if needed
+template<typename T> QuaternionT<T> QuaternionFromMatrix(const Matrix4x4T<T>& m) noexcept
+{
+	// Choose the Largest Component to divide by, for accuracy
+	T trace = m.e00 + m.e11 + m.e22;
+	if (trace > 0)
+	{
+		T s = std::sqrt(trace + 1) * 2; // 4w
+		return { (m.e12 - m.e21) / s, (m.e20 - m.e02) / s, (m.e01 - m.e10) / s, s / 4 };
+	}
+	else if (m.e00 > m.e11 && m.e00 > m.e22)
+	{
+		T s = std::sqrt(1 + m.e00 - m.e11 - m.e22) * 2; // 4x
+		return { s / 4, (m.e01 + m.e10) / s, (m.e02 + m.e20) / s, (m.e12 - m.e21) / s };
+	}
+	else if (m.e11 > m.e22)
+	{
+		T s = std::sqrt(1 + m.e11 - m.e00 - m.e22) * 2; // 4y
+		return { (m.e01 + m.e10) / s, s / 4, (m.e12 + m.e21) / s, (m.e20 - m.e02) / s };
+	}
+	else
+	{
+		T s = std::sqrt(1 + m.e22 - m.e00 - m.e11) * 2; // 4z
+		return { (m.e02 + m.e20) / s, (m.e12 + m.e21) / s, s / 4, (m.e01 - m.e10) / s };
+	}
+}
+
+// Rotation Matrix from a Unit Quaternion - Cheaper than MatrixRotation(Euler Angles) as no sin / cos needed
+template<typename T> constexpr Matrix4x4T<T> MatrixRotation(const QuaternionT<T>& q) noexcept
+{
+	T xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	T xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	T wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+	return
+	{
+		1 - 2 * (yy + zz),     2 * (xy + wz),     2 * (xz - wy), 0,
+		    2 * (xy - wz), 1 - 2 * (xx + zz),     2 * (yz + wx), 0,
+		    2 * (xz + wy),     2 * (yz - wx), 1 - 2 * (xx + yy), 0,
+		                0,                 0,                 0, 1
+	};
+}
+
+
+//========================
+// Non-Member Operators
+//========================
+
+// Quaternion Multiplication (Order Is Important) - q1 * q2 applies q2 FIRST then q1
+template<typename T> constexpr QuaternionT<T> operator*(const QuaternionT<T>& q1, const QuaternionT<T>& q2) noexcept
+{
+	return
+	{
+		q1.w * q2.x + q1.x * q2.w + q1.y * q2.z - q1.z * q2.y,
+		q1.w * q2.y - q1.x * q2.z + q1.y * q2.w + q1.z * q2.x,
+		q1.w * q2.z + q1.x * q2.y - q1.y * q2.x + q1.z * q2.w,
+		q1.w * q2.w - q1.x * q2.x - q1.y * q2.y - q1.z * q2.z
+	};
+}
+
+template<typename T> constexpr QuaternionT<T>& QuaternionT<T>::operator*=(const QuaternionT<T>& q) noexcept
+{
+	return *this = *this * q;
+}
+
+
+//========================
+// Non-Member Functions
+//========================
+
+// Dot Product of two Quaternions - Measures how similar two Rotations are
+template<typename T> constexpr T Dot(const QuaternionT<T>& q1, const QuaternionT<T>& q2) noexcept
+{
+	return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+}
+
+// Conjugate - For a Unit Quaternion this is the Inverse (Opposite) Rotation
+template<typename T> constexpr QuaternionT<T> Conjugate(const QuaternionT<T>& q) noexcept
+{
+	return { -q.x, -q.y, -q.z, q.w };
+}
+
+// Inverse of any non-zero Quaternion. Use Conjugate for Unit Quaternions, it is cheaper
+template<typename T> constexpr QuaternionT<T> Inverse(const QuaternionT<T>& q) noexcept
+{
+	T invLengthSq = 1 / q.LengthSq();
+	return { -q.x * invLengthSq, -q.y * invLengthSq, -q.z * invLengthSq, q.w * invLengthSq };
+}
+
+// Return Unit Length Quaternion. Zero Length Quaternions return the Identity
+// Rotations built by repeated multiplication should be Normalised occasionally to remove drift
+template<typename T> QuaternionT<T> Normalise(const QuaternionT<T>& q) noexcept
+{
+	T lengthSq = q.LengthSq();
+
+	// Can't Normalise Zero Length Quaternion
+	if (IsZero(lengthSq))
+		return QuaternionIdentity<T>();
+
+	T invLength = InvSqrt(lengthSq);
+	return { q.x * invLength, q.y * invLength, q.z * invLength, q.w * invLength };
+}
+
+// Rotate a Vector by a Unit Quaternion
+// Uses the expanded form of q * v * Conjugate(q): 15 multiplies rather than two full Quaternion products
+template<typename T> constexpr Vector3T<T> Rotate(const QuaternionT<T>& q, const Vector3T<T>& v) noexcept
+{
+	Vector3T<T> u = q.Vector();
+	Vector3T<T> t = Cross(u, v) * T(2);
+	return v + t * q.w + Cross(u, t);
+}
+
+// Extract the Axis and Angle (Radians) from a Unit Quaternion. No Rotation gives the X Axis and Angle 0
+template<typename T> void ToAxisAngle(const QuaternionT<T>& q, Vector3T<T>& axis, T& angle) noexcept
+{
+	// Ensure w is positive so the Angle is 0 -> pi (the shorter way around)
+	QuaternionT<T> p = q.w < 0 ? -q : q;
+	T sinHalfAngle = p.Vector().Length();
+	angle = 2 * std::atan2(sinHalfAngle, p.w);
+	axis = IsZero(sinHalfAngle) ? Vector3T<T>{ 1, 0, 0 } : p.Vector() / sinHalfAngle;
+}
+
+// Normalised Linear Interpolation between two Unit Quaternions (t from 0 to 1)
+// Cheaper than Slerp and fine for small steps (e.g. Blending per-frame), but the speed of rotation is not constant
+template<typename T> QuaternionT<T> Nlerp(const QuaternionT<T>& q1, const QuaternionT<T>& q2, const T t) noexcept
+{
+	// Flip q2 if needed to take the shorter way around
+	T sign = Dot(q1, q2) < 0 ? T(-1) : T(1);
+	T s = 1 - t;
+	T u = t * sign;
+	return Normalise(QuaternionT<T>{ q1.x * s + q2.x * u, q1.y * s + q2.y * u, q1.z * s + q2.z * u, q1.w * s + q2.w * u });
+}
+
+// Spherical Linear Interpolation between two Unit Quaternions (t from 0 to 1) - Constant rotation speed
+template<typename T> QuaternionT<T> Slerp(const QuaternionT<T>& q1, const QuaternionT<T>& q2, const T t) noexcept
+{
+	T cosAngle = Dot(q1, q2);
+
+	// Flip q2 if needed to take the shorter way around
+	T sign = 1;
+	if (cosAngle < 0)
+	{
+		cosAngle = -cosAngle;
+		sign = -1;
+	}
+
+	// Very close Rotations - sin(angle) approaches zero so use Nlerp instead
+	if (cosAngle > T(0.9995))
+		return Nlerp(q1, q2, t);
+
+	T angle = std::acos(cosAngle);
+	T invSin = 1 / std::sin(angle);
+	T s = std::sin((1 - t) * angle) * invSin;
+	T u = std::sin(t * angle) * invSin * sign;
+	return { q1.x * s + q2.x * u, q1.y * s + q2.y * u, q1.z * s + q2.z * u, q1.w * s + q2.w * u };
+}
+
+#endif // !_QUATERNION_H_DEFINED_
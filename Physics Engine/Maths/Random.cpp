@@ -0,0 +1,314 @@
+//=========================================================================================================
+// Random.cpp: Fast, Seedable Random Number Generation
+// - Bulk fills run four xoshiro128+ generators side by side, one per Float4 lane, seeded from the
+//   RandomGenerator passed in. The SSE2 and plain versions of the lanes run the same integer steps
+//=========================================================================================================
+
+#include "Random.h"
+
+#include "SIMDFloat.h"
+
+#include <atomic>
+#include <cstring>
+
+//======================
+// Per-Thread Generator
+//======================
+
+// Number of threads that have used ThreadRandom so far, gives each thread a different starting seed
+static std::atomic<uint64_t> gThreadRandomCount{ 0 };
+
+RandomGenerator& ThreadRandom() noexcept
+{
+	// Seeded when the thread first calls this function
+	thread_local RandomGenerator generator(RandomGenerator::DefaultSeed + gThreadRandomCount.fetch_add(1, std::memory_order_relaxed));
+	return generator;
+}
+
+void SeedThreadRandom(uint64_t seed) noexcept
+{
+	ThreadRandom().Seed(seed);
+}
+
+
+//====================================
+// RandomGenerator Member Functions
+//====================================
+
+void RandomGenerator::Jump() noexcept
+{
+	static constexpr uint64_t JumpPolynomial[] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+
+	uint64_t state[4] = { 0, 0, 0, 0 };
+	for (uint64_t polynomial : JumpPolynomial)
+	{
+		for (int bit = 0; bit < 64; ++bit)
+		{
+			if (polynomial & (1ULL << bit))
+			{
+				for (int i = 0; i < 4; ++i)
+					state[i] ^= mState[i];
+			}
+			Next();
+		}
+	}
+	std::memcpy(mState, state, sizeof(mState));
+}
+
+// Marsaglia's method: a point in the unit disc (u, v) maps to the sphere surface with no sin / cos
+Vector3f RandomGenerator::NextOnUnitSphere() noexcept
+{
+	float u, v, s;
+	do
+	{
+		u = NextFloat(-1, 1);
+		v = NextFloat(-1, 1);
+		s = u * u + v * v;
+	} while (s >= 1 || s == 0);
+
+	float scale = 2 * std::sqrt(1 - s);
+	return { u * scale, v * scale, 1 - 2 * s };
+}
+
+// Rejection sampling from the surrounding cube - accepts ~52% of points, still cheaper than cube roots and trig
+Vector3f RandomGenerator::NextInUnitSphere() noexcept
+{
+	Vector3f p;
+	do
+	{
+		p = NextVector3({ -1, -1, -1 }, { 1, 1, 1 });
+	} while (p.LengthSq() >= 1);
+	return p;
+}
+
+// Rejection sampling from the surrounding square - accepts ~79% of points
+Vector2f RandomGenerator::NextInUnitDisc() noexcept
+{
+	Vector2f p;
+	do
+	{
+		p = { NextFloat(-1, 1), NextFloat(-1, 1) };
+	} while (p.LengthSq() >= 1);
+	return p;
+}
+
+
+//=====================
+// SIMD Generation
+//=====================
+
+namespace
+{
+	// Take the starting state for each of the four lanes from the scalar generator. The generator moves
+	// on, so consecutive fills give different values. state[word][lane]
+	void SeedLanes(RandomGenerator& generator, uint32_t state[4][4])
+	{
+		for (int word = 0; word < 4; ++word)
+		{
+			for (int lane = 0; lane < 4; lane += 2)
+			{
+				uint64_t bits = generator.Next();
+				state[word][lane] = static_cast<uint32_t>(bits);
+				state[word][lane + 1] = static_cast<uint32_t>(bits >> 32);
+			}
+		}
+
+		// xoshiro must not start from all zeros (astronomically unlikely, but cheap to rule out)
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			if ((state[0][lane] | state[1][lane] | state[2][lane] | state[3][lane]) == 0)
+				state[0][lane] = 1;
+		}
+	}
+
+	// Four xoshiro128+ generators, one per lane
+	// Only the upper 23 bits of each result are used, avoiding the weaker low bits of the "+" scrambler
+	class RandomLanes
+	{
+	public:
+#if defined(MATHS_SIMD_X86)
+		explicit RandomLanes(RandomGenerator& generator) noexcept
+		{
+			alignas(16) uint32_t state[4][4];
+			SeedLanes(generator, state);
+			s0 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[0]));
+			s1 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[1]));
+			s2 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[2]));
+			s3 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[3]));
+		}
+
+		// Four floats from 0 to 1 (not including 1)
+		Float4 Next() noexcept
+		{
+			const __m128i result = _mm_add_epi32(s0, s3);
+			const __m128i t = _mm_slli_epi32(s1, 9);
+
+			s2 = _mm_xor_si128(s2, s0);
+			s3 = _mm_xor_si128(s3, s1);
+			s1 = _mm_xor_si128(s1, s2);
+			s0 = _mm_xor_si128(s0, s3);
+			s2 = _mm_xor_si128(s2, t);
+			s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+			// Put 23 random bits in the mantissa of 1.0f to give 1 <= f < 2, then subtract 1
+			const __m128i bits = _mm_or_si128(_mm_srli_epi32(result, 9), _mm_set1_epi32(0x3F800000));
+			return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.0f));
+		}
+
+	private:
+		__m128i s0, s1, s2, s3;
+#else
+		explicit RandomLanes(RandomGenerator& generator) noexcept
+		{
+			SeedLanes(generator, s);
+		}
+
+		// Four floats from 0 to 1 (not including 1)
+		Float4 Next() noexcept
+		{
+			float lanes[4];
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				const uint32_t result = s[0][lane] + s[3][lane];
+				const uint32_t t = s[1][lane] << 9;
+
+				s[2][lane] ^= s[0][lane];
+				s[3][lane] ^= s[1][lane];
+				s[1][lane] ^= s[2][lane];
+				s[0][lane] ^= s[3][lane];
+				s[2][lane] ^= t;
+				s[3][lane] = (s[3][lane] << 11) | (s[3][lane] >> 21);
+
+				const uint32_t bits = (result >> 9) | 0x3F800000u;
+				std::memcpy(&lanes[lane], &bits, 4);
+				lanes[lane] -= 1.0f;
+			}
+			return Float4::Load(lanes);
+		}
+
+	private:
+		uint32_t s[4][4];
+#endif
+	};
+
+	// Fill with floats from a to b, four at a time
+	void FillLanes(RandomLanes& lanes, float* out, std::size_t count, float a, float b) noexcept
+	{
+		const Float4 a4(a);
+		const Float4 range4(b - a);
+
+		std::size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+			MulAdd(lanes.Next(), range4, a4).StoreUnaligned(out + i);
+
+		if (i < count)
+		{
+			alignas(16) float last[4];
+			MulAdd(lanes.Next(), range4, a4).Store(last);
+			std::memcpy(out + i, last, (count - i) * sizeof(float));
+		}
+	}
+
+	// Supplies floats from -1 to 1 for the rejection sampling fills, generated a block at a time
+	class CandidateBlock
+	{
+	public:
+		explicit CandidateBlock(RandomGenerator& generator) noexcept : mLanes(generator) {}
+
+		float Next() noexcept
+		{
+			if (mUsed == BlockSize)
+			{
+				FillLanes(mLanes, mValues, BlockSize, -1, 1);
+				mUsed = 0;
+			}
+			return mValues[mUsed++];
+		}
+
+	private:
+		static constexpr std::size_t BlockSize = 256;
+
+		RandomLanes mLanes;
+		float mValues[BlockSize];
+		std::size_t mUsed = BlockSize;
+	};
+}
+
+
+//===========================
+// Bulk Fill Functions
+//===========================
+
+void FillUniform(RandomGenerator& generator, float* out, std::size_t count, float a, float b) noexcept
+{
+	RandomLanes lanes(generator);
+	FillLanes(lanes, out, count, a, b);
+}
+
+void FillUniform(RandomGenerator& generator, Vector3f* out, std::size_t count, const Vector3f& min, const Vector3f& max) noexcept
+{
+	static_assert(sizeof(Vector3f) == 3 * sizeof(float), "Vector3f must be three packed floats");
+
+	// Fill every component from 0 to 1 in one pass, then scale to the range for each axis
+	RandomLanes lanes(generator);
+	FillLanes(lanes, &out->x, count * 3, 0, 1);
+
+	const Vector3f range = max - min;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		Vector3f& v = out[i];
+		v = { min.x + range.x * v.x, min.y + range.y * v.y, min.z + range.z * v.z };
+	}
+}
+
+void FillOnUnitSphere(RandomGenerator& generator, Vector3f* out, std::size_t count) noexcept
+{
+	// Same method as RandomGenerator::NextOnUnitSphere
+	CandidateBlock candidates(generator);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		float u, v, s;
+		do
+		{
+			u = candidates.Next();
+			v = candidates.Next();
+			s = u * u + v * v;
+		} while (s >= 1 || s == 0);
+
+		float scale = 2 * std::sqrt(1 - s);
+		out[i] = { u * scale, v * scale, 1 - 2 * s };
+	}
+}
+
+void FillInUnitSphere(RandomGenerator& generator, Vector3f* out, std::size_t count) noexcept
+{
+	CandidateBlock candidates(generator);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		Vector3f p;
+		do
+		{
+			float x = candidates.Next();
+			float y = candidates.Next();
+			float z = candidates.Next();
+			p = { x, y, z };
+		} while (p.LengthSq() >= 1);
+		out[i] = p;
+	}
+}
+
+void FillInUnitDisc(RandomGenerator& generator, Vector2f* out, std::size_t count) noexcept
+{
+	CandidateBlock candidates(generator);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		Vector2f p;
+		do
+		{
+			float x = candidates.Next();
+			float y = candidates.Next();
+			p = { x, y };
+		} while (p.LengthSq() >= 1);
+		out[i] = p;
+	}
+}
@@ -0,0 +1,207 @@
+//=========================================================================================================
+// Random.h: Fast, Seedable Random Number Generation
+// - RandomGenerator is xoshiro256** (Blackman / Vigna): 32 bytes of state, no locks and no global state,
+//   so each thread (or each system that needs to replay) can own its own generator
+// - The same seed always gives the same sequence on every platform, so scenarios can be replayed
+// - Bulk fill functions generate many values at once, four at a time with SIMD where available
+//=========================================================================================================
+// Random(a, b) uses a generator owned by the calling thread (ThreadRandom). Use SeedThreadRandom, or a
+// seperate RandomGenerator, where results must be reproducible
+//=========================================================================================================
+
+#ifndef _RANDOM_H_DEFINED_
+#define _RANDOM_H_DEFINED_
+
+#include "Vector2.h"
+#include "Vector3.h"
+
+#include <cstddef>
+#include <cstdint>
+
+class RandomGenerator
+{
+public:
+	// Seed used by default constructed generators
+	static constexpr uint64_t DefaultSeed = 0x2545F4914F6CDD1DULL;
+
+	//================
+	// Constructors
+	//================
+
+	explicit RandomGenerator(uint64_t seed = DefaultSeed) noexcept
+	{
+		Seed(seed);
+	}
+
+	// Restart the sequence from a new seed
+	// The 64 bit seed is expanded to the full 256 bit state with SplitMix64, as recommended for xoshiro
+	void Seed(uint64_t seed) noexcept
+	{
+		for (uint64_t& s : mState)
+		{
+			seed += 0x9E3779B97F4A7C15ULL;
+			uint64_t z = seed;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			s = z ^ (z >> 31);
+		}
+	}
+
+	//=================
+	// Random Values
+	//=================
+
+	// Next 64 random bits
+	uint64_t Next() noexcept
+	{
+		const uint64_t result = RotateLeft(mState[1] * 5, 7) * 9;
+		const uint64_t t = mState[1] << 17;
+
+		mState[2] ^= mState[0];
+		mState[3] ^= mState[1];
+		mState[1] ^= mState[2];
+		mState[0] ^= mState[3];
+		mState[2] ^= t;
+		mState[3] = RotateLeft(mState[3], 45);
+
+		return result;
+	}
+
+	// Next 32 random bits (Upper bits of Next, which are the best quality)
+	uint32_t NextUInt32() noexcept
+	{
+		return static_cast<uint32_t>(Next() >> 32);
+	}
+
+	// Float from 0 to 1 (not including 1) - Top 24 bits, so every value is exactly representable
+	float NextFloat() noexcept
+	{
+		return static_cast<float>(Next() >> 40) * 0x1.0p-24f;
+	}
+
+	// Double from 0 to 1 (not including 1) - Top 53 bits
+	double NextDouble() noexcept
+	{
+		return static_cast<double>(Next() >> 11) * 0x1.0p-53;
+	}
+
+	// Int from a to b (inclusive), evenly distributed over the whole range with no modulo bias
+	int NextInt(int a, int b) noexcept
+	{
+		// Lemire's multiply and shift method. Unsigned so the full int range does not overflow
+		const uint32_t range = static_cast<uint32_t>(b) - static_cast<uint32_t>(a) + 1;
+		if (range == 0)
+			return static_cast<int>(NextUInt32()); // a to b is every int
+
+		uint64_t m = static_cast<uint64_t>(NextUInt32()) * range;
+		if (static_cast<uint32_t>(m) < range)
+		{
+			const uint32_t threshold = (0 - range) % range;
+			while (static_cast<uint32_t>(m) < threshold)
+				m = static_cast<uint64_t>(NextUInt32()) * range;
+		}
+		return static_cast<int>(static_cast<uint32_t>(a) + static_cast<uint32_t>(m >> 32));
+	}
+
+	// Float / Double from a to b
+	float NextFloat(float a, float b) noexcept    { return a + (b - a) * NextFloat(); }
+	double NextDouble(double a, double b) noexcept { return a + (b - a) * NextDouble(); }
+
+	// Vector3 with each component in the range min to max
+	Vector3f NextVector3(const Vector3f& min, const Vector3f& max) noexcept
+	{
+		float x = NextFloat(min.x, max.x);
+		float y = NextFloat(min.y, max.y);
+		float z = NextFloat(min.z, max.z);
+		return { x, y, z };
+	}
+
+	// Point on the surface of the unit sphere (evenly distributed)
+	Vector3f NextOnUnitSphere() noexcept;
+
+	// Point inside the unit sphere (evenly distributed)
+	Vector3f NextInUnitSphere() noexcept;
+
+	// Point inside the unit disc (evenly distributed)
+	Vector2f NextInUnitDisc() noexcept;
+
+	//=========================
+	// Independent Sequences
+	//=========================
+
+	// Advance the state by 2^128 calls to Next. Call on copies of one generator to give each thread its
+	// own sequence that will never overlap with the others - still reproducible from the single seed
+	void Jump() noexcept;
+
+private:
+	static constexpr uint64_t RotateLeft(const uint64_t x, const int k) noexcept
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+
+	uint64_t mState[4];
+};
+
+
+//======================
+// Per-Thread Generator
+//======================
+
+// Generator owned by the calling thread. No locking is needed to use it
+// Each thread starts from a different seed based on the order threads first call this function
+RandomGenerator& ThreadRandom() noexcept;
+
+// Reseed the calling thread's generator, e.g. at the start of a replay
+void SeedThreadRandom(uint64_t seed) noexcept;
+
+
+//===========================
+// Bulk Fill Functions
+//===========================
+
+// Each fill only depends on the generator state, so the same seed gives the same values. The SIMD and
+// scalar versions produce identical results, but not the same values as calling NextFloat "count" times
+
+// Fill with floats from a to b
+void FillUniform(RandomGenerator& generator, float* out, std::size_t count, float a, float b) noexcept;
+
+// Fill with Vector3 with each component in the range min to max
+void FillUniform(RandomGenerator& generator, Vector3f* out, std::size_t count, const Vector3f& min, const Vector3f& max) noexcept;
+
+// Fill with points on the surface of the unit sphere
+void FillOnUnitSphere(RandomGenerator& generator, Vector3f* out, std::size_t count) noexcept;
+
+// Fill with points inside the unit sphere
+void FillInUnitSphere(RandomGenerator& generator, Vector3f* out, std::size_t count) noexcept;
+
+// Fill with points inside the unit disc
+void FillInUnitDisc(RandomGenerator& generator, Vector2f* out, std::size_t count) noexcept;
+
+
+//==================
+// Random Numbers
+//==================
+
+// Return random number from a to b - Will return Int, Float or Double of a Random number matching Type of parameters a & b
+// Uses the calling thread's generator (ThreadRandom)
+template<typename T> T Random(const T a, const T b);
+
+// Returns a Random Integer from a to b (inclusive)
+template<> inline int Random<int>(const int a, const int b)
+{
+	return ThreadRandom().NextInt(a, b);
+}
+
+// Return a Random Float from a to b
+template<> inline float Random<float>(const float a, const float b)
+{
+	return ThreadRandom().NextFloat(a, b);
+}
+
+// Return a Random Double from a to b
+template<> inline double Random<double>(const double a, const double b)
+{
+	return ThreadRandom().NextDouble(a, b);
+}
+
+#endif // !_RANDOM_H_DEFINED_
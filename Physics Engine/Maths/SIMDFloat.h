@@ -0,0 +1,174 @@
+//=========================================================================================================
+// SIMDFloat.h: Float4 - Four Float Lanes Operated on Together
+// - SSE2 on x86 / x64 (always available on x64 so no runtime dispatch is needed)
+// - Plain arrays on other platforms, so code written with Float4 still compiles and runs everywhere
+//=========================================================================================================
+// Used by the bulk Structure-of-Arrays code: load four x values, four y values and four z values and
+// the Vector3 maths reads the same as the scalar version, e.g. Float4 dot = ax * bx + ay * by + az * bz
+//=========================================================================================================
+
+#ifndef _SIMD_FLOAT_H_DEFINED_
+#define _SIMD_FLOAT_H_DEFINED_
+
+// x86 / x64 builds can use SSE2 (and AVX2 where detected at runtime), other platforms only have scalar code
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define MATHS_SIMD_X86
+#endif
+
+#if defined(MATHS_SIMD_X86)
+#include <emmintrin.h>
+#else
+#include <cmath>
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+class Float4
+{
+public:
+	static constexpr int Width = 4;
+
+#if defined(MATHS_SIMD_X86)
+	__m128 v;
+
+	Float4() {}
+	Float4(__m128 vIn) : v(vIn) {}
+
+	// Broadcast a single value to all lanes
+	explicit Float4(float s) : v(_mm_set1_ps(s)) {}
+
+	Float4(float x, float y, float z, float w) : v(_mm_setr_ps(x, y, z, w)) {}
+
+	// Load / Store four values. Aligned versions require 16 byte alignment
+	static Float4 Load(const float* p)          { return _mm_load_ps(p); }
+	static Float4 LoadUnaligned(const float* p) { return _mm_loadu_ps(p); }
+	void Store(float* p) const                  { _mm_store_ps(p, v); }
+	void StoreUnaligned(float* p) const         { _mm_storeu_ps(p, v); }
+
+	// Lane by lane arithmetic
+	friend Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+	friend Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+	friend Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+	friend Float4 operator/(Float4 a, Float4 b) { return _mm_div_ps(a.v, b.v); }
+	friend Float4 operator-(Float4 a)           { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+
+	friend Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a.v, b.v); }
+	friend Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a.v, b.v); }
+	friend Float4 Sqrt(Float4 a)          { return _mm_sqrt_ps(a.v); }
+	friend Float4 Abs(Float4 a)           { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+
+	// Comparisons give a mask with all bits set in lanes where the comparison is true
+	friend Float4 operator< (Float4 a, Float4 b) { return _mm_cmplt_ps(a.v, b.v); }
+	friend Float4 operator> (Float4 a, Float4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+	friend Float4 operator<=(Float4 a, Float4 b) { return _mm_cmple_ps(a.v, b.v); }
+	friend Float4 operator>=(Float4 a, Float4 b) { return _mm_cmpge_ps(a.v, b.v); }
+	friend Float4 operator& (Float4 a, Float4 b) { return _mm_and_ps(a.v, b.v); }
+	friend Float4 operator| (Float4 a, Float4 b) { return _mm_or_ps(a.v, b.v); }
+
+	// Lanes of a where mask is set, otherwise lanes of b
+	friend Float4 Select(Float4 mask, Float4 a, Float4 b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+
+	// One bit per lane (lane 0 in bit 0) from a comparison mask
+	friend int MoveMask(Float4 mask) { return _mm_movemask_ps(mask.v); }
+
+	// Sum of all four lanes
+	friend float HorizontalSum(Float4 a)
+	{
+		__m128 t = _mm_add_ps(a.v, _mm_movehl_ps(a.v, a.v));
+		t = _mm_add_ss(t, _mm_shuffle_ps(t, t, 1));
+		return _mm_cvtss_f32(t);
+	}
+
+	// Single lane access - slow, for setup and debugging only
+	float Lane(int i) const
+	{
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, v);
+		return lanes[i];
+	}
+
+#else
+	float v[4];
+
+	Float4() {}
+	explicit Float4(float s) : v{ s, s, s, s } {}
+	Float4(float x, float y, float z, float w) : v{ x, y, z, w } {}
+
+	static Float4 Load(const float* p)          { return { p[0], p[1], p[2], p[3] }; }
+	static Float4 LoadUnaligned(const float* p) { return Load(p); }
+	void Store(float* p) const                  { for (int i = 0; i < 4; ++i) p[i] = v[i]; }
+	void StoreUnaligned(float* p) const         { Store(p); }
+
+	friend Float4 operator+(Float4 a, Float4 b) { return Lanes(a, b, [](float x, float y) { return x + y; }); }
+	friend Float4 operator-(Float4 a, Float4 b) { return Lanes(a, b, [](float x, float y) { return x - y; }); }
+	friend Float4 operator*(Float4 a, Float4 b) { return Lanes(a, b, [](float x, float y) { return x * y; }); }
+	friend Float4 operator/(Float4 a, Float4 b) { return Lanes(a, b, [](float x, float y) { return x / y; }); }
+	friend Float4 operator-(Float4 a)           { return Float4(0) - a; }
+
+	friend Float4 Min(Float4 a, Float4 b) { return Lanes(a, b, [](float x, float y) { return x < y ? x : y; }); }
+	friend Float4 Max(Float4 a, Float4 b) { return Lanes(a, b, [](float x, float y) { return x > y ? x : y; }); }
+	friend Float4 Sqrt(Float4 a)          { return Lanes(a, a, [](float x, float) { return std::sqrt(x); }); }
+	friend Float4 Abs(Float4 a)           { return Lanes(a, a, [](float x, float) { return std::abs(x); }); }
+
+	friend Float4 operator< (Float4 a, Float4 b) { return Lanes(a, b, [](float x, float y) { return Mask(x < y); }); }
+	friend Float4 operator> (Float4 a, Float4 b) { return Lanes(a, b, [](float x, float y) { return Mask(x > y); }); }
+	friend Float4 operator<=(Float4 a, Float4 b) { return Lanes(a, b, [](float x, float y) { return Mask(x <= y); }); }
+	friend Float4 operator>=(Float4 a, Float4 b) { return Lanes(a, b, [](float x, float y) { return Mask(x >= y); }); }
+	friend Float4 operator& (Float4 a, Float4 b) { return Bits(a, b, [](uint32_t x, uint32_t y) { return x & y; }); }
+	friend Float4 operator| (Float4 a, Float4 b) { return Bits(a, b, [](uint32_t x, uint32_t y) { return x | y; }); }
+
+	friend Float4 Select(Float4 mask, Float4 a, Float4 b) { return (mask & a) | Bits(mask, b, [](uint32_t m, uint32_t y) { return ~m & y; }); }
+
+	friend int MoveMask(Float4 mask)
+	{
+		int bits = 0;
+		for (int i = 0; i < 4; ++i)
+			bits |= (std::signbit(mask.v[i]) ? 1 : 0) << i;
+		return bits;
+	}
+
+	friend float HorizontalSum(Float4 a) { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+
+	float Lane(int i) const { return v[i]; }
+
+private:
+	template<typename F> static Float4 Lanes(Float4 a, Float4 b, F f)
+	{
+		return { f(a.v[0], b.v[0]), f(a.v[1], b.v[1]), f(a.v[2], b.v[2]), f(a.v[3], b.v[3]) };
+	}
+
+	template<typename F> static Float4 Bits(Float4 a, Float4 b, F f)
+	{
+		Float4 r;
+		for (int i = 0; i < 4; ++i)
+		{
+			uint32_t x, y;
+			std::memcpy(&x, &a.v[i], 4);
+			std::memcpy(&y, &b.v[i], 4);
+			x = f(x, y);
+			std::memcpy(&r.v[i], &x, 4);
+		}
+		return r;
+	}
+
+	static float Mask(bool set)
+	{
+		uint32_t bits = set ? 0xffffffffu : 0;
+		float f;
+		std::memcpy(&f, &bits, 4);
+		return f;
+	}
+#endif
+
+public:
+	// a * b + c
+	friend Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return a * b + c; }
+
+	// Compound assignment in terms of the operators above
+	Float4& operator+=(Float4 b) { return *this = *this + b; }
+	Float4& operator-=(Float4 b) { return *this = *this - b; }
+	Float4& operator*=(Float4 b) { return *this = *this * b; }
+};
+
+#endif // !_SIMD_FLOAT_H_DEFINED_
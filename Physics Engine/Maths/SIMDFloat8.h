@@ -0,0 +1,93 @@
+//=========================================================================================================
+// SIMDFloat8.h: Float8 - Eight Float Lanes Operated on Together (AVX2)
+// - Same interface as Float4 (SIMDFloat.h), so code written as a template on the lane type can be built
+//   for either
+// - ONLY include this in files built with AVX2 code generation (see MathsSIMD_AVX2.cpp), and only call
+//   that code after DetectSIMDLevel() has reported AVX2
+//=========================================================================================================
+// Header-only: All functions are defined here so the compiler can inline them at the call site
+//=========================================================================================================
+
+#ifndef _SIMD_FLOAT8_H_DEFINED_
+#define _SIMD_FLOAT8_H_DEFINED_
+
+#include "SIMDFloat.h" // For MATHS_SIMD_X86
+
+#if defined(MATHS_SIMD_X86)
+
+#include <immintrin.h>
+
+class Float8
+{
+public:
+	static constexpr int Width = 8;
+
+	__m256 v;
+
+	Float8() {}
+	Float8(__m256 vIn) : v(vIn) {}
+
+	// Broadcast a single value to all lanes
+	explicit Float8(float s) : v(_mm256_set1_ps(s)) {}
+
+	// Load / Store eight values. Aligned versions require 32 byte alignment
+	static Float8 Load(const float* p)          { return _mm256_load_ps(p); }
+	static Float8 LoadUnaligned(const float* p) { return _mm256_loadu_ps(p); }
+	void Store(float* p) const                  { _mm256_store_ps(p, v); }
+	void StoreUnaligned(float* p) const         { _mm256_storeu_ps(p, v); }
+
+	// Lane by lane arithmetic
+	friend Float8 operator+(Float8 a, Float8 b) { return _mm256_add_ps(a.v, b.v); }
+	friend Float8 operator-(Float8 a, Float8 b) { return _mm256_sub_ps(a.v, b.v); }
+	friend Float8 operator*(Float8 a, Float8 b) { return _mm256_mul_ps(a.v, b.v); }
+	friend Float8 operator/(Float8 a, Float8 b) { return _mm256_div_ps(a.v, b.v); }
+	friend Float8 operator-(Float8 a)           { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+
+	friend Float8 Min(Float8 a, Float8 b) { return _mm256_min_ps(a.v, b.v); }
+	friend Float8 Max(Float8 a, Float8 b) { return _mm256_max_ps(a.v, b.v); }
+	friend Float8 Sqrt(Float8 a)          { return _mm256_sqrt_ps(a.v); }
+	friend Float8 Abs(Float8 a)           { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+
+	// Comparisons give a mask with all bits set in lanes where the comparison is true
+	friend Float8 operator< (Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+	friend Float8 operator> (Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+	friend Float8 operator<=(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+	friend Float8 operator>=(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+	friend Float8 operator& (Float8 a, Float8 b) { return _mm256_and_ps(a.v, b.v); }
+	friend Float8 operator| (Float8 a, Float8 b) { return _mm256_or_ps(a.v, b.v); }
+
+	// Lanes of a where mask is set, otherwise lanes of b
+	friend Float8 Select(Float8 mask, Float8 a, Float8 b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+
+	// One bit per lane (lane 0 in bit 0) from a comparison mask
+	friend int MoveMask(Float8 mask) { return _mm256_movemask_ps(mask.v); }
+
+	// Sum of all eight lanes
+	friend float HorizontalSum(Float8 a)
+	{
+		__m128 t = _mm_add_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1));
+		t = _mm_add_ps(t, _mm_movehl_ps(t, t));
+		t = _mm_add_ss(t, _mm_shuffle_ps(t, t, 1));
+		return _mm_cvtss_f32(t);
+	}
+
+	// Single lane access - slow, for setup and debugging only
+	float Lane(int i) const
+	{
+		alignas(32) float lanes[8];
+		_mm256_store_ps(lanes, v);
+		return lanes[i];
+	}
+
+	// a * b + c, a single rounding with FMA
+	friend Float8 MulAdd(Float8 a, Float8 b, Float8 c) { return _mm256_fmadd_ps(a.v, b.v, c.v); }
+
+	// Compound assignment in terms of the operators above
+	Float8& operator+=(Float8 b) { return *this = *this + b; }
+	Float8& operator-=(Float8 b) { return *this = *this - b; }
+	Float8& operator*=(Float8 b) { return *this = *this * b; }
+};
+
+#endif // MATHS_SIMD_X86
+
+#endif // !_SIMD_FLOAT8_H_DEFINED_
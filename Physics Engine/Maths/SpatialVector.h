@@ -0,0 +1,258 @@
+//=========================================================================================================
+// SpatialVector.h: 6D Spatial Vectors and Matrices for Articulated Bodies (Featherstone)
+// - Uses Template Functions to work on Float and Double Values
+// Float(SpatialVectorf, SpatialMatrixf), Double(SpatialVectord, SpatialMatrixd) - NOT SUPPORTING INT
+//=========================================================================================================
+// A spatial vector joins the angular and linear parts of a body's motion, or of a force on it, so that a
+// whole chain of bodies can be worked through with one vector per body
+// - Motion vectors (velocity, acceleration): angular velocity, and the velocity of the body's point at the
+//   reference point
+// - Force vectors (force, momentum, impulse): moment about the reference point, and the force
+// Both depend on the reference point: Shift moves them from one reference point to another. The axes
+// are always the world's, only the point moves
+//
+// Header-only: All functions are defined here (constexpr / noexcept where possible) so the compiler
+// can inline them at the call site rather than calling into a seperate .cpp file
+//=========================================================================================================
+
+#ifndef _SPATIAL_VECTOR_H_DEFINED_
+#define _SPATIAL_VECTOR_H_DEFINED_
+
+#include "Vector3.h"
+#include "Quaternion.h"
+
+// Template Classes to Support Float or Double Values. DO NOT use these typenames, use simpler ones below.
+template<typename T> class SpatialVectorT;
+template<typename T> class SpatialMatrixT;
+
+// Define Convinient names for Spatial Vectors and Matrices of Different Types to avoid Angle Bracket Syntax
+using SpatialVectorf = SpatialVectorT<float>;	// Spatial Vector with Float Values
+using SpatialVectord = SpatialVectorT<double>;	// Spatial Vector with Double Values
+using SpatialVector = SpatialVectorf;			// Add Extra simple name for Float Values (Most Common Use-Case)
+
+using SpatialMatrixf = SpatialMatrixT<float>;	// 6x6 Spatial Matrix with Float Values
+using SpatialMatrixd = SpatialMatrixT<double>;	// 6x6 Spatial Matrix with Double Values
+using SpatialMatrix = SpatialMatrixf;			// Add Extra simple name for Float Values (Most Common Use-Case)
+
+template<typename T> class SpatialVectorT
+{
+	// Only Float and Double are Supported
+	static_assert(std::is_floating_point_v<T>, "SpatialVectorT only supports Float and Double Types");
+
+// ALLOW PUBLIC ACCESS. For simple, well-defined Class
+public:
+	Vector3T<T> angular; // Angular velocity, or moment about the reference point
+	Vector3T<T> linear;  // Velocity of the point at the reference point, or force
+
+	//===============
+	// Constructors
+	//===============
+
+	// Default Constructor - Leaves Values Uninitialised (For Performance)
+#pragma warning(suppress: 26495)
+	constexpr SpatialVectorT() noexcept {}
+
+	constexpr SpatialVectorT(const Vector3T<T>& angularIn, const Vector3T<T>& linearIn) noexcept
+		: angular(angularIn), linear(linearIn) {}
+
+	//=====================
+	// Member Operators
+	//=====================
+
+	constexpr SpatialVectorT& operator+=(const SpatialVectorT& v) noexcept
+	{
+		angular += v.angular;
+		linear += v.linear;
+		return *this;
+	}
+
+	constexpr SpatialVectorT& operator-=(const SpatialVectorT& v) noexcept
+	{
+		angular -= v.angular;
+		linear -= v.linear;
+		return *this;
+	}
+
+	constexpr SpatialVectorT operator-() const noexcept
+	{
+		return { -angular, -linear };
+	}
+
+	// Element by index, angular (0 to 2) then linear (3 to 5)
+	constexpr T Get(int i) const noexcept
+	{
+		const Vector3T<T>& v = i < 3 ? angular : linear;
+		const int k = i % 3;
+		return k == 0 ? v.x : k == 1 ? v.y : v.z;
+	}
+};
+
+// Zero Spatial Vector
+template<typename T = float> constexpr SpatialVectorT<T> SpatialZero() noexcept
+{
+	return { { 0, 0, 0 }, { 0, 0, 0 } };
+}
+
+
+//=================================
+// Spatial Vector Non-Member Operators
+//=================================
+
+template<typename T> constexpr SpatialVectorT<T> operator+(const SpatialVectorT<T>& v, const SpatialVectorT<T>& w) noexcept
+{
+	return { v.angular + w.angular, v.linear + w.linear };
+}
+
+template<typename T> constexpr SpatialVectorT<T> operator-(const SpatialVectorT<T>& v, const SpatialVectorT<T>& w) noexcept
+{
+	return { v.angular - w.angular, v.linear - w.linear };
+}
+
+template<typename T> constexpr SpatialVectorT<T> operator*(const SpatialVectorT<T>& v, T s) noexcept
+{
+	return { v.angular * s, v.linear * s };
+}
+
+
+//=================================
+// Spatial Vector Non-Member Functions
+//=================================
+
+// Motion . Force: the power of a force on a moving body, or the work of an impulse (Order Not Important)
+template<typename T> constexpr T Dot(const SpatialVectorT<T>& v, const SpatialVectorT<T>& w) noexcept
+{
+	return Dot(v.angular, w.angular) + Dot(v.linear, w.linear);
+}
+
+// Rate of change of motion vector m carried along with velocity v (v x m)
+template<typename T> constexpr SpatialVectorT<T> CrossMotion(const SpatialVectorT<T>& v, const SpatialVectorT<T>& m) noexcept
+{
+	return { Cross(v.angular, m.angular), Cross(v.angular, m.linear) + Cross(v.linear, m.angular) };
+}
+
+// Rate of change of force vector f carried along with velocity v (v x* f)
+template<typename T> constexpr SpatialVectorT<T> CrossForce(const SpatialVectorT<T>& v, const SpatialVectorT<T>& f) noexcept
+{
+	return { Cross(v.angular, f.angular) + Cross(v.linear, f.linear), Cross(v.angular, f.linear) };
+}
+
+// Motion vector at a reference point offset from the current one
+template<typename T> constexpr SpatialVectorT<T> ShiftMotion(const SpatialVectorT<T>& m, const Vector3T<T>& offset) noexcept
+{
+	return { m.angular, m.linear + Cross(m.angular, offset) };
+}
+
+// Force vector at a reference point offset from the current one
+template<typename T> constexpr SpatialVectorT<T> ShiftForce(const SpatialVectorT<T>& f, const Vector3T<T>& offset) noexcept
+{
+	return { f.angular - Cross(offset, f.linear), f.linear };
+}
+
+
+//=================
+// Spatial Matrix
+//=================
+
+// Maps motion vectors to force vectors (inertias) or the reverse. Stored in rows, angular rows/columns first
+template<typename T> class SpatialMatrixT
+{
+	// Only Float and Double are Supported
+	static_assert(std::is_floating_point_v<T>, "SpatialMatrixT only supports Float and Double Types");
+
+// ALLOW PUBLIC ACCESS. For simple, well-defined Class
+public:
+	T e[6][6];
+
+	//=====================
+	// Member Operators
+	//=====================
+
+	constexpr SpatialMatrixT& operator+=(const SpatialMatrixT& m) noexcept
+	{
+		for (int r = 0; r < 6; ++r)
+			for (int c = 0; c < 6; ++c)
+				e[r][c] += m.e[r][c];
+		return *this;
+	}
+
+	// Subtract s * a * b^T, e.g. taking a joint's free directions out of an articulated inertia
+	constexpr void SubtractOuter(const SpatialVectorT<T>& a, const SpatialVectorT<T>& b, T s) noexcept
+	{
+		for (int r = 0; r < 6; ++r)
+		{
+			const T ar = a.Get(r) * s;
+			for (int c = 0; c < 6; ++c)
+				e[r][c] -= ar * b.Get(c);
+		}
+	}
+};
+
+//===================================
+// Spatial Matrix Factory Functions
+//===================================
+
+template<typename T = float> constexpr SpatialMatrixT<T> SpatialMatrixZero() noexcept
+{
+	SpatialMatrixT<T> m;
+	for (int r = 0; r < 6; ++r)
+		for (int c = 0; c < 6; ++c)
+			m.e[r][c] = 0;
+	return m;
+}
+
+// Spatial inertia of a body at its centre of mass: world inertia tensor R * diag(principal) * R^T in the
+// angular block, mass in the linear block
+template<typename T> constexpr SpatialMatrixT<T> SpatialInertia(const QuaternionT<T>& orientation, const Vector3T<T>& principalInertia, T mass) noexcept
+{
+	SpatialMatrixT<T> m = SpatialMatrixZero<T>();
+	const Vector3T<T> axes[3] = { Rotate(orientation, Vector3T<T>(1, 0, 0)), Rotate(orientation, Vector3T<T>(0, 1, 0)), Rotate(orientation, Vector3T<T>(0, 0, 1)) };
+	const T moments[3] = { principalInertia.x, principalInertia.y, principalInertia.z };
+	for (int k = 0; k < 3; ++k)
+	{
+		const T a[3] = { axes[k].x, axes[k].y, axes[k].z };
+		for (int r = 0; r < 3; ++r)
+			for (int c = 0; c < 3; ++c)
+				m.e[r][c] += moments[k] * a[r] * a[c];
+	}
+	m.e[3][3] = m.e[4][4] = m.e[5][5] = mass;
+	return m;
+}
+
+
+//===================================
+// Spatial Matrix Non-Member Functions
+//===================================
+
+template<typename T> constexpr SpatialVectorT<T> operator*(const SpatialMatrixT<T>& m, const SpatialVectorT<T>& v) noexcept
+{
+	T r[6];
+	for (int i = 0; i < 6; ++i)
+	{
+		r[i] = m.e[i][0] * v.angular.x + m.e[i][1] * v.angular.y + m.e[i][2] * v.angular.z +
+		       m.e[i][3] * v.linear.x + m.e[i][4] * v.linear.y + m.e[i][5] * v.linear.z;
+	}
+	return { { r[0], r[1], r[2] }, { r[3], r[4], r[5] } };
+}
+
+// Inertia at a reference point offset from the current one: T^T * I * T, where T takes motion at the new
+// point to the old (angular unchanged, linear + offset x angular)
+template<typename T> constexpr SpatialMatrixT<T> ShiftInertia(const SpatialMatrixT<T>& m, const Vector3T<T>& offset) noexcept
+{
+	// Cross product matrix of the offset
+	const T x[3][3] = { { 0, -offset.z, offset.y }, { offset.z, 0, -offset.x }, { -offset.y, offset.x, 0 } };
+
+	// I * T: the angular columns take in the linear columns through the cross product matrix
+	SpatialMatrixT<T> it = m;
+	for (int r = 0; r < 6; ++r)
+		for (int c = 0; c < 3; ++c)
+			it.e[r][c] += m.e[r][3] * x[0][c] + m.e[r][4] * x[1][c] + m.e[r][5] * x[2][c];
+
+	// T^T * (I * T): the same for the angular rows
+	SpatialMatrixT<T> result = it;
+	for (int r = 0; r < 3; ++r)
+		for (int c = 0; c < 6; ++c)
+			result.e[r][c] += x[0][r] * it.e[3][c] + x[1][r] * it.e[4][c] + x[2][r] * it.e[5][c];
+	return result;
+}
+
+#endif // !_SPATIAL_VECTOR_H_DEFINED_
@@ -0,0 +1,127 @@
+//=========================================================================================================
+// Transform.h: Compact Rigid Transform - Position and Rotation (Quaternion), No Scale
+// - Uses Template Functions to work on Float and Double Values
+// Float(Transform, Transformf), Double(Transformd) - NOT SUPPORTING INT
+//=========================================================================================================
+// 7 values rather than the 16 of a Matrix4x4T, and composing or inverting two transforms is cheaper than
+// the Matrix equivalent. Use this for rigid bodies and convert to a Matrix4x4T (ToMatrix) for rendering
+//
+// Follows the Matrix4x4T order: a * b applies a FIRST then b, so ToMatrix(a * b) == ToMatrix(a) * ToMatrix(b)
+//=========================================================================================================
+
+#ifndef _TRANSFORM_H_DEFINED_
+#define _TRANSFORM_H_DEFINED_
+
+#include "Quaternion.h"
+
+// Template Class to Support Float or Double Values. DO NOT use this typename, use simpler ones below.
+template<typename T> class TransformT;
+
+// Define Convinient names for Transforms of Different Types to avoid using Angle Bracket Syntax in Main Code
+using Transformf = TransformT<float>;	// Transform with Float Values
+using Transformd = TransformT<double>;	// Transform with Double Values
+using Transform = Transformf;			// Add Extra simple name for Float Values (Most Common Use-Case)
+
+template<typename T> class TransformT
+{
+// ALLOW PUBLIC ACCESS. For simple, well-defined Class
+public:
+	Vector3T<T> position;
+	QuaternionT<T> rotation; // Must be Unit Length
+
+	//===============
+	// Constructors
+	//===============
+
+	// Default Constructor - Leaves Values Uninitialised (For Performance)
+#pragma warning(suppress: 26495)
+	constexpr TransformT() noexcept {}
+
+	// Construct from Position and Rotation, Rotation defaults to none
+	constexpr TransformT(const Vector3T<T>& positionIn, const QuaternionT<T>& rotationIn = QuaternionIdentity<T>()) noexcept
+		: position(positionIn), rotation(rotationIn) {}
+
+	// Construct from the Position and Rotation of a Matrix. Any Scale in the Matrix must be removed first
+	explicit TransformT(const Matrix4x4T<T>& m) noexcept
+		: position(m.Position()), rotation(QuaternionFromMatrix(m)) {}
+
+	//=====================
+	// Member Operators
+	//=====================
+
+	// Apply another Transform after this one - Same as Matrix4x4T *=
+	constexpr TransformT& operator*=(const TransformT& t) noexcept;
+
+	//==========================
+	// Other Member Functions
+	//==========================
+
+	// Transform a Point (Rotation then Translation)
+	constexpr Vector3T<T> TransformPoint(const Vector3T<T>& p) const noexcept
+	{
+		return Rotate(rotation, p) + position;
+	}
+
+	// Transform a Vector (Rotation only)
+	constexpr Vector3T<T> TransformVector(const Vector3T<T>& v) const noexcept
+	{
+		return Rotate(rotation, v);
+	}
+
+	// Equivalent Matrix4x4T
+	constexpr Matrix4x4T<T> ToMatrix() const noexcept
+	{
+		Matrix4x4T<T> m = MatrixRotation(rotation);
+		m.e30 = position.x;
+		m.e31 = position.y;
+		m.e32 = position.z;
+		return m;
+	}
+};
+
+//===============================
+// Transform Factory Functions
+//===============================
+
+// Identity Transform (No Movement or Rotation)
+template<typename T = float> constexpr TransformT<T> TransformIdentity() noexcept
+{
+	return { { 0, 0, 0 }, QuaternionIdentity<T>() };
+}
+
+
+//========================
+// Non-Member Operators
+//========================
+
+// Combine two Transforms - a * b applies a FIRST then b (Same as Matrix4x4T)
+template<typename T> constexpr TransformT<T> operator*(const TransformT<T>& a, const TransformT<T>& b) noexcept
+{
+	// Quaternion Multiplication is in the opposite order
+	return { Rotate(b.rotation, a.position) + b.position, b.rotation * a.rotation };
+}
+
+template<typename T> constexpr TransformT<T>& TransformT<T>::operator*=(const TransformT<T>& t) noexcept
+{
+	return *this = *this * t;
+}
+
+
+//========================
+// Non-Member Functions
+//========================
+
+// Inverse of a Transform - Always exists, and far cheaper than InverseAffine on the equivalent Matrix
+template<typename T> constexpr TransformT<T> Inverse(const TransformT<T>& t) noexcept
+{
+	QuaternionT<T> inverseRotation = Conjugate(t.rotation);
+	return { -Rotate(inverseRotation, t.position), inverseRotation };
+}
+
+// Interpolate between two Transforms (t from 0 to 1) - Linear for Position, Slerp for Rotation
+template<typename T> TransformT<T> Interpolate(const TransformT<T>& a, const TransformT<T>& b, const T t) noexcept
+{
+	return { a.position + (b.position - a.position) * t, Slerp(a.rotation, b.rotation, t) };
+}
+
+#endif // !_TRANSFORM_H_DEFINED_
@@ -3,9 +3,8 @@
 // - Uses Template Functions to work on Integer, Float and Double Values
 // Integer (Vector2i), Float(Vector2, Vector2f), Double(Vector2d)
 //=========================================================================================================
-// Template Classes usually put all code in Header.h files. However explicit template instantiation is
-// used at the end of the .cpp file. Allows for code to be in the cpp file and
-// the Class Interface here
+// Header-only: All functions are defined here (constexpr / noexcept where possible) so the compiler
+// can inline and fold vector maths at the call site rather than calling into a seperate .cpp file
 //=========================================================================================================
 
 
@@ -27,6 +26,9 @@ using Vector2 = Vector2f;			// Single name for 2D Vector with Float Coordinates
 // Full Decleration
 template<typename T> class Vector2T
 {
+	// Only Numeric Types are Supported (int, float, double)
+	static_assert(std::is_arithmetic_v<T>, "Vector2T only supports Numeric Types");
+
 public:
 	// Allow Public Access - For Simple, Well Defined Class
 
@@ -39,55 +41,95 @@ public:
 	//================
 
 	// Default Constructor
-#pragma warning (supress: 26495) // Disable Warning about Constuctor leaving values uninitalised
-	Vector2T() {}
+#pragma warning (suppress: 26495) // Disable Warning about Constuctor leaving values uninitalised
+	constexpr Vector2T() noexcept {}
 
 	// Construct with 2 Values
-	Vector2T(const T xIn, const T yIn) : x(xIn), y(yIn) {}
+	constexpr Vector2T(const T xIn, const T yIn) noexcept : x(xIn), y(yIn) {}
 
 	// Construct with Pointer to 2 Values
-	explicit Vector2T(const T* elts) : x(elts[0]), y(elts[1]) {}
+	constexpr explicit Vector2T(const T* elts) noexcept : x(elts[0]), y(elts[1]) {}
 	// Explicit doesn't allow Conversion from Pointer to Vector2 without writing the constuctor name
 		// NOT ALLOWED:
 		// Vector2 v = pointer;
 
 		// ALLOWED:
 		// Vector2 v = Vector2(pointer)
-	
+
 
 	//=====================
 	// Member Operators
 	//=====================
 
 	// Addition of Another Vector to this one (e.g. Position += Velocity)
-	Vector2T& operator+=(const Vector2T& v);
+	constexpr Vector2T& operator+=(const Vector2T& v) noexcept
+	{
+		x += v.x;
+		y += v.y;
+
+		return *this;
+	}
 
 	// Subtraction of Another Vector to this one (e.g. Velocity -= Acceleration)
-	Vector2T& operator-=(const Vector2T& v);
+	constexpr Vector2T& operator-=(const Vector2T& v) noexcept
+	{
+		x -= v.x;
+		y -= v.y;
+
+		return *this;
+	}
 
 	// Negate this Vector (e.g. Velocity = -Velocity)
-	Vector2T& operator-();
+	constexpr Vector2T operator-() const noexcept
+	{
+		return { -x, -y };
+	}
 
 	// Plus sign infront of Vector - Unary Positive and Usually does Nothing. Included for Completeness to reduce error when using Plus Signs (e.g. Velocity = +Velocity)
-	Vector2T& operator+();
+	constexpr Vector2T operator+() const noexcept
+	{
+		return *this;
+	}
 
 	// Multiply Vector by Scalar (Scales Vector)
 	// Integer Vectors can be Multiplied by a Float but Resulting Vector will be Rounded to Integers
-	Vector2T<T>& operator*=(FloatTypeFor<T> s);
+	constexpr Vector2T<T>& operator*=(FloatTypeFor<T> s) noexcept
+	{
+		x = static_cast<T>(x * s);
+		y = static_cast<T>(y * s);
+
+		return *this;
+	}
 
 	// Divide Vector by Scalar (Scales Vector)
 	// Integer Vector can be Divided by a Float but the Resulting Vector will be Rounded to Integers
-	Vector2T<T>& operator/=(FloatTypeFor<T> s);
+	constexpr Vector2T<T>& operator/=(FloatTypeFor<T> s) noexcept
+	{
+		x = static_cast<T>(x / s);
+		y = static_cast<T>(y / s);
+
+		return *this;
+	}
 
 	//==========================
 	// Other Member Functions
 	//==========================
 
 	// Returns the Length of the Vector (Return Type always a Float, when with a Integer Vector)
-	FloatTypeFor<T> Length() const;
+	FloatTypeFor<T> Length() const noexcept
+	{
+		return std::sqrt(LengthSq());
+	}
 
 	// Returns the Square Length of the Vector (Return Type always a Float, when with a Integer Vector)
-	FloatTypeFor<T> LengthSq() const;
+	constexpr FloatTypeFor<T> LengthSq() const noexcept
+	{
+		return static_cast<FloatTypeFor<T>>
+			(
+				x * x +
+				y * y
+			);
+	}
 };
 
 //========================
@@ -95,30 +137,81 @@ public:
 //========================
 
 // Vector - Vector Addition
-template<typename T> Vector2T<T> operator+(const Vector2T<T>& v, const Vector2T<T>& w);
+template<typename T> constexpr Vector2T<T> operator+(const Vector2T<T>& v, const Vector2T<T>& w) noexcept
+{
+	return
+	{
+		v.x + w.x,
+		v.y + w.y
+	};
+}
 
 // Vector - Vector Subtraction
-template<typename T> Vector2T<T> operator-(const Vector2T<T>& v, const Vector2T<T>& w);
+template<typename T> constexpr Vector2T<T> operator-(const Vector2T<T>& v, const Vector2T<T>& w) noexcept
+{
+	return
+	{
+		v.x - w.x,
+		v.y - w.y
+	};
+}
 
 // Vector - Scalar Multiplication / Division
-template<typename T> Vector2T<T> operator* (const Vector2T<T>& v, FloatTypeFor<T> s);
-template<typename T> Vector2T<T> operator* (FloatTypeFor<T> s, const Vector2T<T>& v);
-template<typename T> Vector2T<T> operator/ (const Vector2T<T>& v, FloatTypeFor<T> s);
+// Use of FloatTypeFor allows for Scalar Type to NOT MATCH Vector Type (e.g. Vector2i * float)
+template<typename T> constexpr Vector2T<T> operator* (const Vector2T<T>& v, FloatTypeFor<T> s) noexcept
+{
+	return
+	{
+		static_cast<T>(v.x * s),
+		static_cast<T>(v.y * s)
+	};
+}
+template<typename T> constexpr Vector2T<T> operator* (FloatTypeFor<T> s, const Vector2T<T>& v) noexcept
+{
+	return v * s;
+}
+template<typename T> constexpr Vector2T<T> operator/ (const Vector2T<T>& v, FloatTypeFor<T> s) noexcept
+{
+	return
+	{
+		static_cast<T>(v.x / s),
+		static_cast<T>(v.y / s)
+	};
+}
 
 //========================
 // Non-Member Functions
 //========================
 
 // Distance between two Vector2 Points
-template<typename T> FloatTypeFor<T> Distance(const Vector2T<T>& v, const Vector2T<T>& w)
+template<typename T> FloatTypeFor<T> Distance(const Vector2T<T>& v, const Vector2T<T>& w) noexcept
 {
 	return (w - v).Length();
 }
 
 // Dot Product of two given Vectors (Order Not Important)
-template<typename T> T Dot(const Vector2T<T>& v, const Vector2T<T>& w);
+template<typename T> constexpr T Dot(const Vector2T<T>& v, const Vector2T<T>& w) noexcept
+{
+	return
+		v.x * w.x +
+		v.y * w.y;
+}
 
 // Return unit Length Vector in the SAME DIRECTION as the one given (NOT SUPPORTED FOR INT COORDINATES: Vector2i)
-template<typename T> Vector2T<T> Normalise(const Vector2T<T>& v);
+template<typename T> Vector2T<T> Normalise(const Vector2T<T>& v) noexcept
+{
+	T lengthSq = v.LengthSq();
+
+	// Can't Normalise Zero Length Vector
+	if (IsZero(lengthSq))
+		return { 0,0 };
+
+	T invLength = InvSqrt(lengthSq);
+	return
+	{
+		v.x * invLength,
+		v.y * invLength
+	};
+}
 
-#endif // !_VECTOR2_H_DEFINED_s
+#endif // !_VECTOR2_H_DEFINED_
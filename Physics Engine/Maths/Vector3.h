@@ -1,11 +1,10 @@
 //=========================================================================================================
-// Vector3.h: Encapsulates (x, y) Coordinates and Supporting Functions
+// Vector3.h: Encapsulates (x, y, z) Coordinates and Supporting Functions
 // - Uses Template Functions to work on Integer, Float and Double Values
 // Integer (Vector3i), Float(Vector3, Vector3f), Double(Vector3d)
 //=========================================================================================================
-// Template Classes usually put all code in Header.h files. However explicit template instantiation is
-// used at the end of the .cpp file. Allows for code to be in the cpp file and
-// the Class Interface here
+// Header-only: All functions are defined here (constexpr / noexcept where possible) so the compiler
+// can inline and fold vector maths at the call site rather than calling into a seperate .cpp file
 //=========================================================================================================
 
 
@@ -14,19 +13,24 @@
 
 #include "MathsHelpers.h"
 
+#include <algorithm>
+
 // Template Class to Support Float, Double or Int Coordinates
 template<typename T> class Vector3T;
 
 
 // Define convenient names for Vectors of different types to avoid Angle Bracket Syntax
-using Vector3i = Vector3T<int>;		// 2D Vector with Int Coordinates
-using Vector3f = Vector3T<float>;	// 2D Vector with Float Coordinates
-using Vector3d = Vector3T<double>;	// 2D Vector with Double Coordinates
-using Vector3 = Vector3f;			// Single name for 2D Vector with Float Coordinates (To use the Float version as Default)
+using Vector3i = Vector3T<int>;		// 3D Vector with Int Coordinates
+using Vector3f = Vector3T<float>;	// 3D Vector with Float Coordinates
+using Vector3d = Vector3T<double>;	// 3D Vector with Double Coordinates
+using Vector3 = Vector3f;			// Single name for 3D Vector with Float Coordinates (To use the Float version as Default)
 
 // Full Decleration
 template<typename T> class Vector3T
 {
+	// Only Numeric Types are Supported (int, float, double)
+	static_assert(std::is_arithmetic_v<T>, "Vector3T only supports Numeric Types");
+
 public:
 	// Allow Public Access - For Simple, Well Defined Class
 
@@ -40,14 +44,14 @@ public:
 	//================
 
 	// Default Constructor
-#pragma warning (supress: 26495) // Disable Warning about Constuctor leaving values uninitalised
-	Vector3T() {}
+#pragma warning (suppress: 26495) // Disable Warning about Constuctor leaving values uninitalised
+	constexpr Vector3T() noexcept {}
 
-	// Construct with 2 Values
-	Vector3T(const T xIn, const T yIn, const T zIn) : x(xIn), y(yIn), z(zIn) {}
+	// Construct with 3 Values
+	constexpr Vector3T(const T xIn, const T yIn, const T zIn) noexcept : x(xIn), y(yIn), z(zIn) {}
 
-	// Construct with Point to 2 Values
-	explicit Vector3T(const T* elts)
+	// Construct with Pointer to 3 Values
+	constexpr explicit Vector3T(const T* elts) noexcept
 	// Explicit doesn't allow Conversion from Pointer to Vector3 without writing the constuctor name
 		// NOT ALLOWED:
 		// Vector3 v = pointer;
@@ -62,34 +66,79 @@ public:
 	//=====================
 
 	// Addition of Another Vector to this one (e.g. Position += Velocity)
-	Vector3T& operator+=(const Vector3T& v);
+	constexpr Vector3T& operator+=(const Vector3T& v) noexcept
+	{
+		x += v.x;
+		y += v.y;
+		z += v.z;
+
+		return *this;
+	}
 
 	// Subtraction of Another Vector to this one (e.g. Velocity -= Acceleration)
-	Vector3T& operator-=(const Vector3T& v);
+	constexpr Vector3T& operator-=(const Vector3T& v) noexcept
+	{
+		x -= v.x;
+		y -= v.y;
+		z -= v.z;
+
+		return *this;
+	}
 
 	// Negate this Vector (e.g. Velocity = -Velocity)
-	Vector3T& operator-();
+	constexpr Vector3T operator-() const noexcept
+	{
+		return { -x, -y, -z };
+	}
 
 	// Plus sign infront of Vector - Unary Positive and Usually does Nothing. Included for Completeness to reduce error when using Plus Signs (e.g. Velocity = +Velocity)
-	Vector3T& operator+();
+	constexpr Vector3T operator+() const noexcept
+	{
+		return *this;
+	}
 
 	// Multiply Vector by Scalar (Scales Vector)
 	// Integer Vectors can be Multiplied by a Float but Resulting Vector will be Rounded to Integers
-	Vector3T<T>& operator*=(FloatTypeFor<T> s);
+	constexpr Vector3T<T>& operator*=(FloatTypeFor<T> s) noexcept
+	{
+		x = static_cast<T>(x * s);
+		y = static_cast<T>(y * s);
+		z = static_cast<T>(z * s);
+
+		return *this;
+	}
 
 	// Divide Vector by Scalar (Scales Vector)
 	// Integer Vector can be Divided by a Float but the Resulting Vector will be Rounded to Integers
-	Vector3T<T>& operator/=(FloatTypeFor<T> s);
+	constexpr Vector3T<T>& operator/=(FloatTypeFor<T> s) noexcept
+	{
+		x = static_cast<T>(x / s);
+		y = static_cast<T>(y / s);
+		z = static_cast<T>(z / s);
+
+		return *this;
+	}
 
 	//==========================
 	// Other Member Functions
 	//==========================
 
 	// Returns the Length of the Vector (Return Type always a Float, when with a Integer Vector)
-	FloatTypeFor<T> Length() const;
+	FloatTypeFor<T> Length() const noexcept
+	{
+		return std::sqrt(LengthSq());
+	}
 
 	// Returns the Square Length of the Vector (Return Type always a Float, when with a Integer Vector)
-	FloatTypeFor<T> LengthSq() const;
+	constexpr FloatTypeFor<T> LengthSq() const noexcept
+	{
+		return static_cast<FloatTypeFor<T>>
+			(
+				x * x +
+				y * y +
+				z * z
+			);
+	}
 };
 
 //========================
@@ -97,36 +146,113 @@ public:
 //========================
 
 // Vector - Vector Addition
-template<typename T> Vector3T<T> operator+(const Vector3T<T>& v, const Vector3T<T>& w);
+template<typename T> constexpr Vector3T<T> operator+(const Vector3T<T>& v, const Vector3T<T>& w) noexcept
+{
+	return
+	{
+		v.x + w.x,
+		v.y + w.y,
+		v.z + w.z
+	};
+}
 
 // Vector - Vector Subtraction
-template<typename T> Vector3T<T> operator-(const Vector3T<T>& v, const Vector3T<T>& w);
+template<typename T> constexpr Vector3T<T> operator-(const Vector3T<T>& v, const Vector3T<T>& w) noexcept
+{
+	return
+	{
+		v.x - w.x,
+		v.y - w.y,
+		v.z - w.z
+	};
+}
 
 // Vector - Scalar Multiplication / Division
-template <typename T> Vector3T<T> operator* (const Vector3T<T>& v, FloatTypeFor<T> s);
-template <typename T> Vector3T<T> operator* (FloatTypeFor<T> s, const Vector3T<T>& v);
-template <typename T> Vector3T<T> operator/ (const Vector3T<T>& v, FloatTypeFor<T> s);
+// Use of FloatTypeFor allows for Scalar Type to NOT MATCH Vector Type (e.g. Vector3i * float)
+template <typename T> constexpr Vector3T<T> operator* (const Vector3T<T>& v, FloatTypeFor<T> s) noexcept
+{
+	return
+	{
+		static_cast<T>(v.x * s),
+		static_cast<T>(v.y * s),
+		static_cast<T>(v.z * s)
+	};
+}
+template <typename T> constexpr Vector3T<T> operator* (FloatTypeFor<T> s, const Vector3T<T>& v) noexcept
+{
+	return v * s;
+}
+template <typename T> constexpr Vector3T<T> operator/ (const Vector3T<T>& v, FloatTypeFor<T> s) noexcept
+{
+	return
+	{
+		static_cast<T>(v.x / s),
+		static_cast<T>(v.y / s),
+		static_cast<T>(v.z / s)
+	};
+}
 
 //========================
 // Non-Member Functions
 //========================
 
 // Distance between two Vector3 Points
-template<typename T> FloatTypeFor<T> Distance(const Vector3T<T>& v, const Vector3T<T>& w)
+template<typename T> FloatTypeFor<T> Distance(const Vector3T<T>& v, const Vector3T<T>& w) noexcept
 {
 	return (w - v).Length();
 }
 
 // Dot Product of two given Vectors (Order Not Important) - Non-Member Function
-template<typename T> T Dot(const Vector3T<T>& v, const Vector3T<T>& w);
+template<typename T> constexpr T Dot(const Vector3T<T>& v, const Vector3T<T>& w) noexcept
+{
+	return
+		v.x * w.x +
+		v.y * w.y +
+		v.z * w.z;
+}
 
 // Cross Product of two given Vectors (Order Is Important) - Non-Member Function
-template<typename T> Vector3T<T> Cross(const Vector3T<T>& v, const Vector3T<T>& w);
+template<typename T> constexpr Vector3T<T> Cross(const Vector3T<T>& v, const Vector3T<T>& w) noexcept
+{
+	return
+	{
+		v.y * w.z - v.z * w.y,
+		v.z * w.x - v.x * w.z,
+		v.x * w.y - v.y * w.x
+	};
+}
 
 // Return Unit Length Vector in the SAME DIRECTION as the one given (NOT SUPPORTED FOR INT VECTORS: Vector3i)
-template<typename T> Vector3T<T> Normalise(const Vector3T<T>& v);
+template<typename T> Vector3T<T> Normalise(const Vector3T<T>& v) noexcept
+{
+	T lengthSq = v.LengthSq();
+
+	// Can't Normalise Zero Length Vector
+	if (IsZero(lengthSq))
+		return { 0,0,0 };
+
+	T invLength = InvSqrt(lengthSq);
+	return
+	{
+		v.x * invLength,
+		v.y * invLength,
+		v.z * invLength
+	};
+}
 
 // Returns Angle Between two Vectors (Return Type always a Float, when with Integer Version)
-template<typename T> FloatTypeFor<T> AngleBetween(const Vector3T<T>& v, const Vector3T<T>& w);
+template<typename T> FloatTypeFor<T> AngleBetween(const Vector3T<T>& v, const Vector3T<T>& w) noexcept
+{
+	using F = FloatTypeFor<T>;
+	F lengths = std::sqrt(v.LengthSq() * w.LengthSq());
+
+	// No Angle is Defined against a Zero Length Vector
+	if (IsZero(lengths))
+		return 0;
+
+	// Clamp before acos, rounding can push the cosine very slightly outside of -1 -> 1
+	F cosAngle = std::clamp(static_cast<F>(Dot(v, w)) / lengths, F(-1), F(1));
+	return std::acos(cosAngle);
+}
 
-#endif // !_Vector3_H_DEFINED_s
+#endif // !_VECTOR3_H_DEFINED_
@@ -0,0 +1,232 @@
+//=========================================================================================================
+// Vector3SoA.cpp: Structure-of-Arrays Storage for Large Numbers of Vector3f
+// - Each bulk operation processes four vectors per step using Float4, then finishes any remaining
+//   (count % 4) vectors with the scalar Vector3 code
+//=========================================================================================================
+
+#include "Vector3SoA.h"
+
+#include "SIMDFloat.h"
+
+#include <cassert>
+
+//===============
+// Conversion
+//===============
+
+void Vector3SoA::FromVector(const std::vector<Vector3f>& vectors)
+{
+	Resize(vectors.size());
+	for (std::size_t i = 0; i < vectors.size(); ++i)
+		Set(i, vectors[i]);
+}
+
+std::vector<Vector3f> Vector3SoA::ToVector() const
+{
+	std::vector<Vector3f> vectors;
+	ToVector(vectors);
+	return vectors;
+}
+
+void Vector3SoA::ToVector(std::vector<Vector3f>& vectors) const
+{
+	vectors.resize(Size());
+	for (std::size_t i = 0; i < vectors.size(); ++i)
+		vectors[i] = Get(i);
+}
+
+
+//=====================
+// Bulk Operations
+//=====================
+
+// Component arrays are 32 byte aligned and each SIMD step starts at a multiple of 4 floats,
+// so all the loads and stores below can use the aligned versions
+
+void Add(const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& out)
+{
+	assert(a.Size() == b.Size());
+	const std::size_t count = a.Size();
+	out.Resize(count);
+
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		(Float4::Load(a.X() + i) + Float4::Load(b.X() + i)).Store(out.X() + i);
+		(Float4::Load(a.Y() + i) + Float4::Load(b.Y() + i)).Store(out.Y() + i);
+		(Float4::Load(a.Z() + i) + Float4::Load(b.Z() + i)).Store(out.Z() + i);
+	}
+	for (; i < count; ++i)
+		out.Set(i, a.Get(i) + b.Get(i));
+}
+
+void Subtract(const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& out)
+{
+	assert(a.Size() == b.Size());
+	const std::size_t count = a.Size();
+	out.Resize(count);
+
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		(Float4::Load(a.X() + i) - Float4::Load(b.X() + i)).Store(out.X() + i);
+		(Float4::Load(a.Y() + i) - Float4::Load(b.Y() + i)).Store(out.Y() + i);
+		(Float4::Load(a.Z() + i) - Float4::Load(b.Z() + i)).Store(out.Z() + i);
+	}
+	for (; i < count; ++i)
+		out.Set(i, a.Get(i) - b.Get(i));
+}
+
+void Scale(const Vector3SoA& a, float s, Vector3SoA& out)
+{
+	const std::size_t count = a.Size();
+	out.Resize(count);
+
+	Float4 s4(s);
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		(Float4::Load(a.X() + i) * s4).Store(out.X() + i);
+		(Float4::Load(a.Y() + i) * s4).Store(out.Y() + i);
+		(Float4::Load(a.Z() + i) * s4).Store(out.Z() + i);
+	}
+	for (; i < count; ++i)
+		out.Set(i, a.Get(i) * s);
+}
+
+void ScaleAdd(Vector3SoA& y, float s, const Vector3SoA& x)
+{
+	assert(y.Size() == x.Size());
+	const std::size_t count = y.Size();
+
+	Float4 s4(s);
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		MulAdd(s4, Float4::Load(x.X() + i), Float4::Load(y.X() + i)).Store(y.X() + i);
+		MulAdd(s4, Float4::Load(x.Y() + i), Float4::Load(y.Y() + i)).Store(y.Y() + i);
+		MulAdd(s4, Float4::Load(x.Z() + i), Float4::Load(y.Z() + i)).Store(y.Z() + i);
+	}
+	for (; i < count; ++i)
+		y.Set(i, y.Get(i) + s * x.Get(i));
+}
+
+void Dot(const Vector3SoA& a, const Vector3SoA& b, std::vector<float>& out)
+{
+	assert(a.Size() == b.Size());
+	const std::size_t count = a.Size();
+	out.resize(count);
+
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		Float4 dot = Float4::Load(a.X() + i) * Float4::Load(b.X() + i) +
+		             Float4::Load(a.Y() + i) * Float4::Load(b.Y() + i) +
+		             Float4::Load(a.Z() + i) * Float4::Load(b.Z() + i);
+		dot.StoreUnaligned(out.data() + i); // std::vector<float> is not guaranteed 16 byte aligned
+	}
+	for (; i < count; ++i)
+		out[i] = Dot(a.Get(i), b.Get(i));
+}
+
+void Cross(const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& out)
+{
+	assert(a.Size() == b.Size());
+	const std::size_t count = a.Size();
+	out.Resize(count);
+
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		// Load all inputs before storing so "out" can be the same as "a" or "b"
+		Float4 ax = Float4::Load(a.X() + i), ay = Float4::Load(a.Y() + i), az = Float4::Load(a.Z() + i);
+		Float4 bx = Float4::Load(b.X() + i), by = Float4::Load(b.Y() + i), bz = Float4::Load(b.Z() + i);
+		(ay * bz - az * by).Store(out.X() + i);
+		(az * bx - ax * bz).Store(out.Y() + i);
+		(ax * by - ay * bx).Store(out.Z() + i);
+	}
+	for (; i < count; ++i)
+		out.Set(i, Cross(a.Get(i), b.Get(i)));
+}
+
+void Length(const Vector3SoA& a, std::vector<float>& out)
+{
+	const std::size_t count = a.Size();
+	out.resize(count);
+
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		Float4 x = Float4::Load(a.X() + i), y = Float4::Load(a.Y() + i), z = Float4::Load(a.Z() + i);
+		Sqrt(x * x + y * y + z * z).StoreUnaligned(out.data() + i);
+	}
+	for (; i < count; ++i)
+		out[i] = a.Get(i).Length();
+}
+
+void Normalise(const Vector3SoA& a, Vector3SoA& out)
+{
+	const std::size_t count = a.Size();
+	out.Resize(count);
+
+	const Float4 zero(0.0f);
+	const Float4 one(1.0f);
+	const Float4 epsilon(EPSILON<float>);
+
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		Float4 x = Float4::Load(a.X() + i), y = Float4::Load(a.Y() + i), z = Float4::Load(a.Z() + i);
+		Float4 lengthSq = x * x + y * y + z * z;
+
+		// Same test as IsZero, zero length lanes produce a zero vector
+		Float4 valid = lengthSq >= epsilon;
+		Float4 invLength = Select(valid, one / Sqrt(lengthSq), zero);
+		(x * invLength).Store(out.X() + i);
+		(y * invLength).Store(out.Y() + i);
+		(z * invLength).Store(out.Z() + i);
+	}
+	for (; i < count; ++i)
+		out.Set(i, Normalise(a.Get(i)));
+}
+
+// Shared by TransformPoints / TransformVectors, "w" is 1 for points and 0 for vectors
+static void Transform(const Matrix4x4f& m, const Vector3SoA& a, Vector3SoA& out, float w)
+{
+	const std::size_t count = a.Size();
+	out.Resize(count);
+
+	const Float4 m00(m.e00), m01(m.e01), m02(m.e02);
+	const Float4 m10(m.e10), m11(m.e11), m12(m.e12);
+	const Float4 m20(m.e20), m21(m.e21), m22(m.e22);
+	const Float4 t0(m.e30 * w), t1(m.e31 * w), t2(m.e32 * w);
+
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		Float4 x = Float4::Load(a.X() + i), y = Float4::Load(a.Y() + i), z = Float4::Load(a.Z() + i);
+		(x * m00 + y * m10 + z * m20 + t0).Store(out.X() + i);
+		(x * m01 + y * m11 + z * m21 + t1).Store(out.Y() + i);
+		(x * m02 + y * m12 + z * m22 + t2).Store(out.Z() + i);
+	}
+	for (; i < count; ++i)
+	{
+		Vector3f v = a.Get(i);
+		out.Set(i,
+		{
+			v.x * m.e00 + v.y * m.e10 + v.z * m.e20 + m.e30 * w,
+			v.x * m.e01 + v.y * m.e11 + v.z * m.e21 + m.e31 * w,
+			v.x * m.e02 + v.y * m.e12 + v.z * m.e22 + m.e32 * w
+		});
+	}
+}
+
+void TransformPoints(const Matrix4x4f& m, const Vector3SoA& a, Vector3SoA& out)
+{
+	Transform(m, a, out, 1);
+}
+
+void TransformVectors(const Matrix4x4f& m, const Vector3SoA& a, Vector3SoA& out)
+{
+	Transform(m, a, out, 0);
+}
@@ -0,0 +1,154 @@
+//=========================================================================================================
+// Vector3SoA.h: Structure-of-Arrays Storage for Large Numbers of Vector3f
+// - Stores all x values, all y values and all z values in seperate aligned arrays rather than as an
+//   array of Vector3f (x, y, z, x, y, z...). Bulk operations can then process four vectors at once
+//   with SIMD without the 12 byte stride of Vector3f getting in the way
+// - Bulk operations are non-member functions matching the Vector3 function names (Dot, Cross, etc.)
+//=========================================================================================================
+
+#ifndef _VECTOR3_SOA_H_DEFINED_
+#define _VECTOR3_SOA_H_DEFINED_
+
+#include "Vector3.h"
+#include "Matrix4x4.h"
+#include "AlignedAllocator.h"
+
+#include <cstddef>
+#include <vector>
+
+class Vector3SoA
+{
+public:
+	//================
+	// Constructors
+	//================
+
+	Vector3SoA() {}
+
+	// Construct with "count" vectors, all set to zero
+	explicit Vector3SoA(std::size_t count) : mX(count), mY(count), mZ(count) {}
+
+	// Construct from an array of Vector3f
+	explicit Vector3SoA(const std::vector<Vector3f>& vectors) { FromVector(vectors); }
+
+	//===================
+	// Size / Capacity
+	//===================
+
+	std::size_t Size() const { return mX.size(); }
+	bool Empty() const { return mX.empty(); }
+
+	// New vectors are set to zero
+	void Resize(std::size_t count)
+	{
+		mX.resize(count);
+		mY.resize(count);
+		mZ.resize(count);
+	}
+
+	void Reserve(std::size_t count)
+	{
+		mX.reserve(count);
+		mY.reserve(count);
+		mZ.reserve(count);
+	}
+
+	void Clear()
+	{
+		mX.clear();
+		mY.clear();
+		mZ.clear();
+	}
+
+	void PushBack(const Vector3f& v)
+	{
+		mX.push_back(v.x);
+		mY.push_back(v.y);
+		mZ.push_back(v.z);
+	}
+
+	// Remove vector i by moving the last vector into its place - Does not keep the order
+	void SwapRemove(std::size_t i)
+	{
+		Set(i, Get(Size() - 1));
+		Resize(Size() - 1);
+	}
+
+	//===============
+	// Data Access
+	//===============
+
+	// Gather / Scatter a single vector - convenient but slow, use the bulk operations in loops
+	Vector3f Get(std::size_t i) const { return { mX[i], mY[i], mZ[i] }; }
+	void Set(std::size_t i, const Vector3f& v)
+	{
+		mX[i] = v.x;
+		mY[i] = v.y;
+		mZ[i] = v.z;
+	}
+
+	// Direct access to each component array. Each array is 32 byte aligned
+	float* X() { return mX.data(); }
+	float* Y() { return mY.data(); }
+	float* Z() { return mZ.data(); }
+	const float* X() const { return mX.data(); }
+	const float* Y() const { return mY.data(); }
+	const float* Z() const { return mZ.data(); }
+
+	//===============
+	// Conversion
+	//===============
+
+	// Replace contents with an array of Vector3f
+	void FromVector(const std::vector<Vector3f>& vectors);
+
+	// Copy contents out to an array of Vector3f
+	std::vector<Vector3f> ToVector() const;
+	void ToVector(std::vector<Vector3f>& vectors) const;
+
+private:
+	AlignedVector<float> mX;
+	AlignedVector<float> mY;
+	AlignedVector<float> mZ;
+};
+
+// Alternative name used by the streaming code, a "stream" of vectors all processed together
+using Vector3Stream = Vector3SoA;
+
+
+//=====================
+// Bulk Operations
+//=====================
+// All inputs must be the same size. Outputs are resized to match and may be the same object as an input
+
+// out[i] = a[i] + b[i]
+void Add(const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& out);
+
+// out[i] = a[i] - b[i]
+void Subtract(const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& out);
+
+// out[i] = a[i] * s
+void Scale(const Vector3SoA& a, float s, Vector3SoA& out);
+
+// y[i] += s * x[i] (e.g. Positions += dt * Velocities)
+void ScaleAdd(Vector3SoA& y, float s, const Vector3SoA& x);
+
+// out[i] = Dot(a[i], b[i])
+void Dot(const Vector3SoA& a, const Vector3SoA& b, std::vector<float>& out);
+
+// out[i] = Cross(a[i], b[i])
+void Cross(const Vector3SoA& a, const Vector3SoA& b, Vector3SoA& out);
+
+// out[i] = Length(a[i])
+void Length(const Vector3SoA& a, std::vector<float>& out);
+
+// out[i] = Normalise(a[i]) - Zero length vectors stay zero, as with Normalise
+void Normalise(const Vector3SoA& a, Vector3SoA& out);
+
+// out[i] = a[i] * m, treating a[i] as a point (w = 1, includes translation)
+void TransformPoints(const Matrix4x4f& m, const Vector3SoA& a, Vector3SoA& out);
+
+// out[i] = a[i] * m, treating a[i] as a direction (w = 0, no translation)
+void TransformVectors(const Matrix4x4f& m, const Vector3SoA& a, Vector3SoA& out);
+
+#endif // !_VECTOR3_SOA_H_DEFINED_
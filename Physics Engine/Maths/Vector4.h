@@ -1,11 +1,10 @@
 //=========================================================================================================
-// Vector3.h: Encapsulates (x, y, z, w) Coordinates and Supporting Functions
+// Vector4.h: Encapsulates (x, y, z, w) Coordinates and Supporting Functions
 // - Uses Template Functions to work on Float and Double Values
 // Float(Vector4, Vector4f), Double(Vector4d) - NOT SUPPORTING INT
 //=========================================================================================================
-// Template Classes usually put all code in Header.h files. However explicit template instantiation is
-// used at the end of the .cpp file. Allows for code to be in the cpp file and
-// the Class Interface here
+// Header-only: All functions are defined here (constexpr / noexcept where possible) so the compiler
+// can inline them at the call site rather than calling into a seperate .cpp file
 //=========================================================================================================
 
 #ifndef _VECTOR4_H_DEFINED_
@@ -23,8 +22,12 @@ using Vector4 = Vector4f; // Simple name for Vector4
 // NOT SUPPORTING int Vector4
 
 // Full Declaration
-template<typename T> class Vector4T
+// Aligned to 16 bytes so a Vector4f can be loaded directly into an SSE register (see MathsSIMD.h)
+template<typename T> class alignas(16) Vector4T
 {
+	// Only Float and Double are Supported
+	static_assert(std::is_floating_point_v<T>, "Vector4T only supports Float and Double Types");
+
 // ALLOW PUBLIC ACCESS. For such a simple, well-defined Class
 public:
 	T x;
@@ -37,15 +40,15 @@ public:
 	//===============
 
 	// Default Constructor - Leaves Values uninitialised (For Performance)
-#pragma warning(supress: 26495)
-	Vector4T<T>() {}
+#pragma warning(suppress: 26495)
+	constexpr Vector4T() noexcept {}
 
 	// Construct with 4 Values
-	Vector4T(const T xIn, const T yIn, const T zIn, const T wIn)
+	constexpr Vector4T(const T xIn, const T yIn, const T zIn, const T wIn) noexcept
 		: x(xIn), y(yIn), z(zIn), w(wIn) {}
 
 	// Construct with Pointer to 4 Values
-	explicit Vector4T(const T* elts)
+	constexpr explicit Vector4T(const T* elts) noexcept
 		// Explicit doesn't allow Conversion from Pointer to Vector3 without writing the constuctor name
 		// NOT ALLOWED:
 		// Vector3 v = pointer;
@@ -55,9 +58,9 @@ public:
 		: x(elts[0]), y(elts[1]), z(elts[2]), w(elts[3]) {}
 
 	// Cast to Vector3 - Allows use of Vector3 Methods on x, y, z members only (e.g. Dot Product)
-	operator Vector3T<T>()
+	constexpr operator Vector3T<T>() const noexcept
 	{
-		return Vector3T<T>(&x);
+		return Vector3T<T>(x, y, z);
 	}
 
 };
@@ -0,0 +1,721 @@
+//=========================================================================================================
+// Articulation.cpp: Articulated Body Algorithm, Limits, Impulses and Storage
+// - Notation follows Featherstone's: S the motion subspace of a joint (the link's spatial velocity from a
+//   unit joint speed), I^A and p^A the articulated inertia and bias force, U = I^A S, D = S^T U, u the joint
+//   force less what the bias force takes of it
+// - Working at each link's centre of mass with world axes keeps the numbers small however far the
+//   articulation is from the origin. Moving a vector from a link to its parent is then only a shift of
+//   reference point (SpatialVector.h), no rotation
+//=========================================================================================================
+
+#include "Articulation.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Limit impulses are found together by a few passes over the limits that are reached this step
+	const int LimitIterations = 4;
+
+	// Fraction of a limit's overshoot removed each step, as the iterative joints' jointBaumgarte
+	const float LimitBaumgarte = 0.2f;
+
+	// Runge-Kutta stages: how far into the step each is taken, and its weight in the step
+	const float StageTimes[] = { 0, 0.5f, 0.5f, 1 };
+	const float StageWeights[] = { 1.0f / 6, 2.0f / 6, 2.0f / 6, 1.0f / 6 };
+
+	// Inverse of the n x n top left of a symmetric positive definite matrix, by its Cholesky factor L L^T.
+	// Zero where it isn't positive definite (a joint whose link has no inertia in a free direction)
+	void InvertSymmetric(const float m[6][6], int n, float inverse[6][6])
+	{
+		float l[6][6] = {};
+		for (int i = 0; i < n; ++i)
+		{
+			for (int j = 0; j <= i; ++j)
+			{
+				float sum = m[i][j];
+				for (int k = 0; k < j; ++k)
+					sum -= l[i][k] * l[j][k];
+				if (i == j)
+				{
+					if (sum <= 0)
+					{
+						for (int r = 0; r < n; ++r)
+							for (int c = 0; c < n; ++c)
+								inverse[r][c] = 0;
+						return;
+					}
+					l[i][i] = std::sqrt(sum);
+				}
+				else
+				{
+					l[i][j] = sum / l[j][j];
+				}
+			}
+		}
+
+		// Each column of the inverse: L y = e, then L^T x = y
+		for (int c = 0; c < n; ++c)
+		{
+			float y[6];
+			for (int i = 0; i < n; ++i)
+			{
+				float sum = i == c ? 1.0f : 0.0f;
+				for (int k = 0; k < i; ++k)
+					sum -= l[i][k] * y[k];
+				y[i] = sum / l[i][i];
+			}
+			for (int i = n; i-- > 0; )
+			{
+				float sum = y[i];
+				for (int k = i + 1; k < n; ++k)
+					sum -= l[k][i] * inverse[k][c];
+				inverse[i][c] = sum / l[i][i];
+			}
+		}
+	}
+
+	// World inertia tensor times a vector, from the principal moments
+	Vector3f ApplyInertia(const Quaternionf& orientation, const Vector3f& inertia, const Vector3f& v)
+	{
+		const Vector3f local = Rotate(Conjugate(orientation), v);
+		return Rotate(orientation, { local.x * inertia.x, local.y * inertia.y, local.z * inertia.z });
+	}
+
+	// Orientation turned by an angular velocity for a time, first order then normalised, as the integrator
+	Quaternionf Turn(const Quaternionf& q, const Vector3f& angularVelocity, float time)
+	{
+		const Quaternionf spin = Quaternionf(angularVelocity, 0) * q;
+		const float h = 0.5f * time;
+		return Normalise(Quaternionf(q.x + spin.x * h, q.y + spin.y * h, q.z + spin.z * h, q.w + spin.w * h));
+	}
+}
+
+
+//=================
+// Setup
+//=================
+
+// Joint frames are fixed to the parent (or the world) and the link from their starting positions
+Articulation::Articulation(const ArticulationDesc& desc, const std::vector<BodyHandle>& linkBodies)
+	: mJointDamping(desc.jointDamping), mMaxJointSpeed(desc.maxJointSpeed), mSubsteps(std::max(desc.substeps, 1))
+{
+	int dofs = 0;
+	mLinks.resize(desc.links.size());
+	for (std::size_t i = 0; i < desc.links.size(); ++i)
+	{
+		const ArticulationLinkDesc& d = desc.links[i];
+		Link& link = mLinks[i];
+		const bool floating = i == 0 && desc.floatingBase;
+
+		link.body = linkBodies[i];
+		link.parent = i == 0 ? -1 : d.parent;
+		link.joint = floating ? JointType::Fixed : d.joint;
+		link.dofs = floating ? 6 : link.joint == JointType::Ball ? 3 : link.joint == JointType::Fixed ? 0 : 1;
+		link.impulse = SpatialZero();
+		link.firstDof = dofs;
+		dofs += link.dofs;
+
+		link.mass = 1 / d.body.inverseMass;
+		link.inertia = { 1 / d.body.inverseInertia.x, 1 / d.body.inverseInertia.y, 1 / d.body.inverseInertia.z };
+
+		const bool hasParent = link.parent >= 0;
+		const Quaternionf parentOrientation = hasParent ? desc.links[link.parent].body.orientation : QuaternionIdentity();
+		const Vector3f parentCentre = hasParent ? desc.links[link.parent].body.position : Vector3f(0, 0, 0);
+		const Quaternionf orientation = Normalise(d.body.orientation);
+		link.parentAnchor = Rotate(Conjugate(parentOrientation), d.anchor - parentCentre);
+		link.axis = Rotate(Conjugate(parentOrientation), Normalise(d.axis));
+		link.childAnchor = Rotate(Conjugate(orientation), d.anchor - d.body.position);
+		link.rest = Conjugate(parentOrientation) * orientation;
+
+		link.position = 0;
+		link.rotation = floating ? orientation : QuaternionIdentity();
+		link.rootPosition = d.body.position;
+
+		const bool oneDof = link.joint == JointType::Hinge || link.joint == JointType::Slider;
+		link.limited = d.limited && oneDof && !floating;
+		link.lower = d.lower;
+		link.upper = d.upper;
+		const bool driven = oneDof && !floating;
+		link.driveStiffness = driven ? d.driveStiffness : 0;
+		link.driveDamping = driven ? d.driveDamping : 0;
+		link.driveTarget = d.driveTarget;
+		link.driveTargetSpeed = d.driveTargetSpeed;
+	}
+
+	mSpeeds.assign(dofs, 0);
+	mStartSpeeds.resize(dofs);
+	mEndSpeeds.assign(dofs, 0);
+	mMeanSpeeds.resize(dofs);
+	mMeanAccelerations.resize(dofs);
+	mSubspace.resize(dofs);
+	mU.resize(dofs);
+	mStartU.resize(dofs);
+	mJointForces.resize(dofs);
+	mAccelerations.resize(dofs);
+	mImpulses.resize(mLinks.size());
+	mLinkImpulses.resize(mLinks.size());
+	mResponse.resize(dofs);
+	for (Link& link : mLinks)
+	{
+		link.endPosition = link.position;
+		link.endRotation = link.rotation;
+		link.endRootPosition = link.rootPosition;
+	}
+	Kinematics();
+	LinkVelocities();
+}
+
+float Articulation::JointPosition(std::size_t link) const
+{
+	const Link& l = mLinks[link];
+	return l.dofs == 1 ? l.position : 0;
+}
+
+float Articulation::JointSpeed(std::size_t link) const
+{
+	const Link& l = mLinks[link];
+	return l.dofs == 1 ? mSpeeds[l.firstDof] : 0;
+}
+
+void Articulation::SetDrive(std::size_t link, float stiffness, float damping, float target, float targetSpeed)
+{
+	Link& l = mLinks[link];
+	if (l.dofs != 1)
+		return;
+	l.driveStiffness = stiffness;
+	l.driveDamping = damping;
+	l.driveTarget = target;
+	l.driveTargetSpeed = targetSpeed;
+}
+
+
+//=================
+// Passes
+//=================
+
+// Link orientations and centres from the joint positions, root outwards, and each joint's motion subspace
+void Articulation::Kinematics()
+{
+	const Vector3f axes[] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+	for (Link& link : mLinks)
+	{
+		SpatialVectorf* s = mSubspace.data() + link.firstDof;
+		if (link.dofs == 6)
+		{
+			link.orientation = link.rotation;
+			link.centre = link.rootPosition;
+			for (int k = 0; k < 3; ++k)
+			{
+				s[k] = { axes[k], { 0, 0, 0 } };
+				s[k + 3] = { { 0, 0, 0 }, axes[k] };
+			}
+			continue;
+		}
+
+		const bool hasParent = link.parent >= 0;
+		const Quaternionf parentOrientation = hasParent ? mLinks[link.parent].orientation : QuaternionIdentity();
+		const Vector3f parentCentre = hasParent ? mLinks[link.parent].centre : Vector3f(0, 0, 0);
+		Vector3f anchor = parentCentre + Rotate(parentOrientation, link.parentAnchor);
+		const Vector3f axis = Rotate(parentOrientation, link.axis);
+
+		switch (link.joint)
+		{
+		case JointType::Hinge:
+			link.orientation = Normalise(parentOrientation * QuaternionAxisAngle(link.axis, link.position) * link.rest);
+			break;
+		case JointType::Ball:
+			link.orientation = Normalise(parentOrientation * link.rotation * link.rest);
+			break;
+		case JointType::Slider:
+			anchor += axis * link.position;
+			link.orientation = Normalise(parentOrientation * link.rest);
+			break;
+		default:
+			link.orientation = Normalise(parentOrientation * link.rest);
+			break;
+		}
+		link.centre = anchor - Rotate(link.orientation, link.childAnchor);
+
+		// Turning about the anchor moves the centre by w x (centre - anchor). Directions are fixed to the parent
+		const Vector3f lever = link.centre - anchor;
+		if (link.joint == JointType::Hinge)
+		{
+			s[0] = { axis, Cross(axis, lever) };
+		}
+		else if (link.joint == JointType::Slider)
+		{
+			s[0] = { { 0, 0, 0 }, axis };
+		}
+		else if (link.joint == JointType::Ball)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				const Vector3f direction = Rotate(parentOrientation, axes[k]);
+				s[k] = { direction, Cross(direction, lever) };
+			}
+		}
+	}
+}
+
+// Joint positions a time on from the start positions at the given rates (mSpeeds layout), and the link frames
+void Articulation::Advance(float time, const float* rates)
+{
+	for (Link& link : mLinks)
+	{
+		const float* r = rates + link.firstDof;
+		if (link.dofs == 1)
+		{
+			link.position = link.startPosition + r[0] * time;
+		}
+		else if (link.dofs == 3)
+		{
+			link.rotation = Turn(link.startRotation, { r[0], r[1], r[2] }, time);
+		}
+		else if (link.dofs == 6)
+		{
+			link.rotation = Turn(link.startRotation, { r[0], r[1], r[2] }, time);
+			link.rootPosition = link.startRootPosition + Vector3f(r[3], r[4], r[5]) * time;
+		}
+	}
+	Kinematics();
+}
+
+void Articulation::LinkVelocities()
+{
+	for (Link& link : mLinks)
+	{
+		link.velocity = link.parent >= 0 ? ShiftMotion(mLinks[link.parent].velocity, link.centre - mLinks[link.parent].centre) : SpatialZero();
+		for (int k = 0; k < link.dofs; ++k)
+			link.velocity += mSubspace[link.firstDof + k] * mSpeeds[link.firstDof + k];
+	}
+}
+
+// The three passes of the articulated body algorithm. Gravity is the base accelerating upwards
+// Drives are implicit: their force uses the speed at the end of the step, speed + acceleration * timeStep,
+// which adds (stiffness * timeStep + damping) * timeStep to the joint's D. So is the joint damping
+void Articulation::Dynamics(const SpatialVectorf& baseAcceleration, float timeStep)
+{
+	// Outwards: velocity product accelerations, and each link's own inertia and bias force
+	for (Link& link : mLinks)
+	{
+		link.biasForceA = -link.force;
+		SpatialVectorf jointVelocity = SpatialZero();
+		for (int k = 0; k < link.dofs; ++k)
+			jointVelocity += mSubspace[link.firstDof + k] * mSpeeds[link.firstDof + k];
+		link.biasAcceleration = CrossMotion(link.velocity, jointVelocity);
+
+		link.inertiaA = SpatialInertia(link.orientation, link.inertia, link.mass);
+		link.biasForceA += CrossForce(link.velocity, link.inertiaA * link.velocity);
+	}
+
+	// Inwards: each link passes its parent the inertia and bias force of itself and the links beyond it,
+	// less what its joint is free to take up
+	for (std::size_t i = mLinks.size(); i-- > 0; )
+	{
+		Link& link = mLinks[i];
+		const int n = link.dofs;
+		const SpatialVectorf* s = mSubspace.data() + link.firstDof;
+		SpatialVectorf* u = mU.data() + link.firstDof;
+		float* jointForce = mJointForces.data() + link.firstDof;
+
+		float d[6][6];
+		for (int j = 0; j < n; ++j)
+		{
+			u[j] = link.inertiaA * s[j];
+			for (int k = 0; k < n; ++k)
+				d[k][j] = Dot(s[k], u[j]);
+			jointForce[j] = -Dot(s[j], link.biasForceA);
+		}
+		if (n < 6)
+		{
+			for (int j = 0; j < n; ++j)
+			{
+				jointForce[j] -= mJointDamping * mSpeeds[link.firstDof + j];
+				d[j][j] += mJointDamping * timeStep;
+			}
+		}
+		if (n == 1)
+		{
+			const float q = link.position, speed = mSpeeds[link.firstDof];
+			jointForce[0] += link.driveStiffness * (link.driveTarget - q - speed * timeStep) + link.driveDamping * (link.driveTargetSpeed - speed);
+			d[0][0] += (link.driveStiffness * timeStep + link.driveDamping) * timeStep;
+		}
+		InvertSymmetric(d, n, link.inverseD);
+
+		if (link.parent < 0)
+			continue;
+
+		SpatialMatrixf inertia = link.inertiaA;
+		for (int j = 0; j < n; ++j)
+			for (int k = 0; k < n; ++k)
+				inertia.SubtractOuter(u[j], u[k], link.inverseD[j][k]);
+
+		SpatialVectorf force = link.biasForceA + inertia * link.biasAcceleration;
+		for (int j = 0; j < n; ++j)
+			for (int k = 0; k < n; ++k)
+				force += u[j] * (link.inverseD[j][k] * jointForce[k]);
+
+		Link& parent = mLinks[link.parent];
+		const Vector3f toParent = parent.centre - link.centre;
+		parent.inertiaA += ShiftInertia(inertia, toParent);
+		parent.biasForceA += ShiftForce(force, toParent);
+	}
+
+	// Outwards: accelerations
+	for (std::size_t i = 0; i < mLinks.size(); ++i)
+	{
+		Link& link = mLinks[i];
+		const SpatialVectorf parentAcceleration =
+			link.parent >= 0 ? ShiftMotion(mImpulses[link.parent], link.centre - mLinks[link.parent].centre) : baseAcceleration;
+		const SpatialVectorf acceleration = parentAcceleration + link.biasAcceleration;
+		const int n = link.dofs;
+		float remaining[6];
+		for (int j = 0; j < n; ++j)
+			remaining[j] = mJointForces[link.firstDof + j] - Dot(mU[link.firstDof + j], acceleration);
+
+		SpatialVectorf linkAcceleration = acceleration;
+		for (int j = 0; j < n; ++j)
+		{
+			float jointAcceleration = 0;
+			for (int k = 0; k < n; ++k)
+				jointAcceleration += link.inverseD[j][k] * remaining[k];
+			mAccelerations[link.firstDof + j] = jointAcceleration;
+			linkAcceleration += mSubspace[link.firstDof + j] * jointAcceleration;
+		}
+		mImpulses[i] = linkAcceleration; // Scratch: the link accelerations
+	}
+
+	// A floating root's speeds are at a point fixed in space that its centre is passing through. Its centre
+	// accelerates by w x v more than that point
+	if (!mLinks.empty() && mLinks[0].dofs == 6)
+	{
+		const Vector3f extra = Cross(mLinks[0].velocity.angular, mLinks[0].velocity.linear);
+		mAccelerations[3] += extra.x;
+		mAccelerations[4] += extra.y;
+		mAccelerations[5] += extra.z;
+	}
+}
+
+// Joint speed changes for impulses, the articulated body algorithm without velocities or gravity
+void Articulation::Response(const SpatialVectorf* linkImpulses, const float* jointImpulses, float* speedChanges)
+{
+	// Inwards: the impulse each link passes to its parent. The bias forces are the impulses, negated
+	for (std::size_t i = 0; i < mLinks.size(); ++i)
+		mImpulses[i] = linkImpulses ? -linkImpulses[i] : SpatialZero();
+	for (std::size_t i = mLinks.size(); i-- > 0; )
+	{
+		const Link& link = mLinks[i];
+		float* u = mResponse.data() + link.firstDof;
+		for (int j = 0; j < link.dofs; ++j)
+			u[j] = (jointImpulses ? jointImpulses[link.firstDof + j] : 0) - Dot(mSubspace[link.firstDof + j], mImpulses[i]);
+
+		if (link.parent < 0)
+			continue;
+		SpatialVectorf force = mImpulses[i];
+		for (int j = 0; j < link.dofs; ++j)
+			for (int k = 0; k < link.dofs; ++k)
+				force += mStartU[link.firstDof + j] * (link.startInverseD[j][k] * u[k]);
+		mImpulses[link.parent] += ShiftForce(force, mLinks[link.parent].centre - link.centre);
+	}
+
+	// Outwards: the velocity changes. A link's impulse is no longer needed once its parent's change is known
+	for (std::size_t i = 0; i < mLinks.size(); ++i)
+	{
+		const Link& link = mLinks[i];
+		const SpatialVectorf parentChange = link.parent >= 0 ? ShiftMotion(mImpulses[link.parent], link.centre - mLinks[link.parent].centre) : SpatialZero();
+		const float* u = mResponse.data() + link.firstDof;
+		float remaining[6];
+		for (int j = 0; j < link.dofs; ++j)
+			remaining[j] = u[j] - Dot(mStartU[link.firstDof + j], parentChange);
+
+		SpatialVectorf change = parentChange;
+		for (int j = 0; j < link.dofs; ++j)
+		{
+			float speedChange = 0;
+			for (int k = 0; k < link.dofs; ++k)
+				speedChange += link.startInverseD[j][k] * remaining[k];
+			speedChanges[link.firstDof + j] = speedChange;
+			change += mSubspace[link.firstDof + j] * speedChange;
+		}
+		mImpulses[i] = change;
+	}
+}
+
+// Each limit the joint would pass this step gets an impulse that only pushes, enough to stop it at the
+// limit (or pull it back by LimitBaumgarte of its overshoot). Impulses on one joint move all the others,
+// so the response of every joint to each limit's impulse is found first, then the impulses together
+// The joint ends the step at the end of the free step plus the speed change times the step
+void Articulation::Limits(float timeStep)
+{
+	struct ActiveLimit
+	{
+		int dof;
+		float direction; // +1 lower limit (pushes the speed up), -1 upper
+		float target;    // Least speed along the direction
+		float impulse;
+	};
+	ActiveLimit active[64];
+	int count = 0;
+	for (const Link& link : mLinks)
+	{
+		if (!link.limited || count == 64)
+			continue;
+		for (float direction : { 1.0f, -1.0f })
+		{
+			const float gap = direction > 0 ? link.position - link.lower : link.upper - link.position;
+			const float predictedGap = direction > 0 ? link.endPosition - link.lower : link.upper - link.endPosition;
+			const float targetGap = gap < 0 ? (1 - LimitBaumgarte) * gap : 0;
+			if (predictedGap < targetGap && count < 64)
+				active[count++] = { link.firstDof, direction, (targetGap - gap) / timeStep, 0 };
+		}
+	}
+	if (count == 0)
+		return;
+
+	const std::size_t dofs = mSpeeds.size();
+	mLimitResponses.resize(dofs * count);
+	std::vector<float>& unit = mAccelerations; // Free once the speeds are updated
+	for (int m = 0; m < count; ++m)
+	{
+		std::fill(unit.begin(), unit.end(), 0.0f);
+		unit[active[m].dof] = active[m].direction;
+		Response(nullptr, unit.data(), mLimitResponses.data() + m * dofs);
+	}
+
+	for (int iteration = 0; iteration < LimitIterations; ++iteration)
+	{
+		for (int m = 0; m < count; ++m)
+		{
+			ActiveLimit& limit = active[m];
+			const float* response = mLimitResponses.data() + m * dofs;
+			const float effective = limit.direction * response[limit.dof];
+			if (effective <= 0)
+				continue;
+			const float speed = limit.direction * mSpeeds[limit.dof];
+			const float impulse = std::max(limit.impulse + (limit.target - speed) / effective, 0.0f);
+			const float change = impulse - limit.impulse;
+			limit.impulse = impulse;
+			for (std::size_t k = 0; k < dofs; ++k)
+				mSpeeds[k] += response[k] * change;
+		}
+	}
+}
+
+
+//=================
+// Stepping
+//=================
+
+// Fourth order Runge-Kutta over the joint positions and speeds. Semi-implicit Euler, as the integrator steps
+// the bodies, is only symplectic when the inertia doesn't change with position: a chain stepped that way
+// gains energy steadily, and fast once it whips round. Each stage is a full articulated body pass.
+// The joints are left where they were, where the contacts are, with the end of the free step kept for
+// UpdatePositions. So are U and D from the first stage, for the impulse passes
+void Articulation::UpdateVelocities(RigidBodies& bodies, const Vector3f& gravity, float timeStep)
+{
+	// Forces added to the link bodies are external forces on the links, at their centres
+	for (Link& link : mLinks)
+	{
+		const std::size_t i = bodies.Index(link.body);
+		link.force = SpatialVectorf{ bodies.torques.Get(i), bodies.forces.Get(i) } + link.impulse * (1 / timeStep);
+		bodies.forces.Set(i, { 0, 0, 0 });
+		bodies.torques.Set(i, { 0, 0, 0 });
+		link.endPosition = link.position;
+		link.endRotation = link.rotation;
+		link.endRootPosition = link.rootPosition;
+	}
+
+	const SpatialVectorf baseAcceleration = { { 0, 0, 0 }, -gravity };
+	const std::size_t dofs = mSpeeds.size();
+	const float subTime = timeStep / mSubsteps;
+	for (int substep = 0; substep < mSubsteps; ++substep)
+	{
+		for (Link& link : mLinks)
+		{
+			link.startPosition = link.position;
+			link.startRotation = link.rotation;
+			link.startRootPosition = link.rootPosition;
+		}
+		mStartSpeeds = mSpeeds;
+		std::fill(mMeanSpeeds.begin(), mMeanSpeeds.end(), 0.0f);
+		std::fill(mMeanAccelerations.begin(), mMeanAccelerations.end(), 0.0f);
+
+		for (int stage = 0; stage < 4; ++stage)
+		{
+			if (stage > 0)
+			{
+				// Positions on at the last stage's speeds, speeds on at its accelerations
+				const float time = StageTimes[stage] * subTime;
+				Advance(time, mSpeeds.data());
+				for (std::size_t k = 0; k < dofs; ++k)
+					mSpeeds[k] = mStartSpeeds[k] + mAccelerations[k] * time;
+				LinkVelocities();
+			}
+			Dynamics(baseAcceleration, subTime);
+
+			for (std::size_t k = 0; k < dofs; ++k)
+			{
+				mMeanSpeeds[k] += mSpeeds[k] * StageWeights[stage];
+				mMeanAccelerations[k] += mAccelerations[k] * StageWeights[stage];
+			}
+			if (substep == 0 && stage == 0)
+			{
+				mStartU = mU;
+				for (Link& link : mLinks)
+					std::copy(&link.inverseD[0][0], &link.inverseD[0][0] + 36, &link.startInverseD[0][0]);
+			}
+		}
+
+		Advance(subTime, mMeanSpeeds.data());
+		for (std::size_t k = 0; k < dofs; ++k)
+			mSpeeds[k] = std::clamp(mStartSpeeds[k] + mMeanAccelerations[k] * subTime, -mMaxJointSpeed, mMaxJointSpeed);
+		LinkVelocities();
+	}
+
+	// Back to the start of the step
+	for (Link& link : mLinks)
+	{
+		std::swap(link.position, link.endPosition);
+		std::swap(link.rotation, link.endRotation);
+		std::swap(link.rootPosition, link.endRootPosition);
+	}
+	Kinematics();
+
+	// Last step's contact impulses went in as forces, so a link held up by a contact is held through the
+	// step as the drives and damping see it. They come out again as impulses for the solver to warm start
+	// with: held or not is left to it
+	for (std::size_t l = 0; l < mLinks.size(); ++l)
+	{
+		mLinkImpulses[l] = mLinks[l].impulse;
+		mLinks[l].impulse = SpatialZero();
+	}
+	Response(mLinkImpulses.data(), nullptr, mAccelerations.data());
+	for (std::size_t k = 0; k < dofs; ++k)
+		mSpeeds[k] -= mAccelerations[k];
+	mEndSpeeds = mSpeeds;
+
+	Limits(timeStep);
+	LinkVelocities();
+}
+
+void Articulation::VelocitiesToBodies(RigidBodies& bodies) const
+{
+	for (const Link& link : mLinks)
+	{
+		const std::size_t i = bodies.Index(link.body);
+		bodies.linearVelocities.Set(i, link.velocity.linear);
+		bodies.angularVelocities.Set(i, link.velocity.angular);
+	}
+}
+
+void Articulation::ImpulsesFromBodies(const RigidBodies& bodies)
+{
+	bool any = false;
+	for (std::size_t l = 0; l < mLinks.size(); ++l)
+	{
+		const Link& link = mLinks[l];
+		const std::size_t i = bodies.Index(link.body);
+		const Vector3f linear = bodies.linearVelocities.Get(i) - link.velocity.linear;
+		const Vector3f angular = bodies.angularVelocities.Get(i) - link.velocity.angular;
+		mLinkImpulses[l] = { ApplyInertia(link.orientation, link.inertia, angular), linear * link.mass };
+		mLinks[l].impulse += mLinkImpulses[l];
+		any |= linear.LengthSq() > 0 || angular.LengthSq() > 0;
+	}
+	if (!any)
+		return;
+
+	Response(mLinkImpulses.data(), nullptr, mAccelerations.data());
+	for (std::size_t k = 0; k < mSpeeds.size(); ++k)
+		mSpeeds[k] += mAccelerations[k];
+	LinkVelocities();
+}
+
+void Articulation::RewindBodies(const RigidBodies& bodies, Vector3SoA& startLinear, Vector3SoA& startAngular) const
+{
+	for (const Link& link : mLinks)
+	{
+		const std::size_t i = bodies.Index(link.body);
+		startLinear.Set(i, startLinear.Get(i) + link.velocity.linear - bodies.linearVelocities.Get(i));
+		startAngular.Set(i, startAngular.Get(i) + link.velocity.angular - bodies.angularVelocities.Get(i));
+	}
+}
+
+// The joints go to the end of the free step, then on by what the limits and contacts changed the speeds by
+void Articulation::UpdatePositions(RigidBodies& bodies, float timeStep)
+{
+	// The limits and the solver work as the bodies are stepped, the positions moving on by the speeds at the
+	// end of the step. The free step's own positions would keep half its acceleration from them: a link
+	// resting on the ground would be left falling at g dt / 2, and damping that speed tips a driven arm
+	const bool pushed = mSpeeds != mEndSpeeds;
+	for (Link& link : mLinks)
+	{
+		link.startPosition = pushed ? link.position : link.endPosition;
+		link.startRotation = pushed ? link.rotation : link.endRotation;
+		link.startRootPosition = pushed ? link.rootPosition : link.endRootPosition;
+	}
+	for (float& speed : mSpeeds)
+		speed = std::clamp(speed, -mMaxJointSpeed, mMaxJointSpeed);
+	Advance(pushed ? timeStep : 0, mSpeeds.data());
+	LinkVelocities();
+
+	for (const Link& link : mLinks)
+	{
+		const std::size_t i = bodies.Index(link.body);
+		bodies.positions.Set(i, link.centre);
+		bodies.SetOrientation(i, link.orientation);
+		bodies.linearVelocities.Set(i, link.velocity.linear);
+		bodies.angularVelocities.Set(i, link.velocity.angular);
+	}
+}
+
+
+//======================
+// Articulation Storage
+//======================
+
+ArticulationHandle Articulations::Add(Articulation&& articulation)
+{
+	const uint32_t index = static_cast<uint32_t>(Size());
+
+	// Reuse a free slot if there is one, its generation was already moved on when it was freed
+	uint32_t slot;
+	if (!mFreeSlots.empty())
+	{
+		slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+		mSlots[slot].index = index;
+	}
+	else
+	{
+		slot = static_cast<uint32_t>(mSlots.size());
+		mSlots.push_back({ index, 0 });
+	}
+	mSlotOfArticulation.push_back(slot);
+	articulations.push_back(std::move(articulation));
+	return { slot, mSlots[slot].generation };
+}
+
+void Articulations::Remove(ArticulationHandle handle)
+{
+	if (!IsValid(handle))
+		return;
+
+	// Move the last articulation into the gap and fix up its slot
+	const uint32_t index = mSlots[handle.slot].index;
+	const uint32_t last = static_cast<uint32_t>(Size() - 1);
+	if (index != last)
+		articulations[index] = std::move(articulations[last]);
+	articulations.pop_back();
+
+	const uint32_t movedSlot = mSlotOfArticulation[last];
+	mSlots[movedSlot].index = index;
+	mSlotOfArticulation[index] = movedSlot;
+	mSlotOfArticulation.pop_back();
+
+	// Free the slot, new generation so existing handles to it become invalid
+	mSlots[handle.slot].index = ArticulationHandle::InvalidSlot;
+	++mSlots[handle.slot].generation;
+	mFreeSlots.push_back(handle.slot);
+}
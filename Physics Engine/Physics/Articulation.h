@@ -0,0 +1,284 @@
+//=========================================================================================================
+// Articulation.h: Chains and Trees of Links in Reduced Coordinates (Featherstone's Articulated Body Algorithm)
+// - An articulation is a tree of links, each joined to its parent (or to the world, for the root) by a
+//   ball, hinge, slider or fixed joint. Rather than bodies held together by constraint rows (Joints.h),
+//   its state is the joint angles and travels themselves, so the links can't drift apart, whatever the
+//   length of the chain or the masses of the links
+// - Each step the articulated body algorithm finds the joint accelerations in three passes over the
+//   links, O(links): velocities outwards from the root, the inertia each link carries of the links beyond
+//   it inwards, then the accelerations outwards again. Spatial vectors (SpatialVector.h) hold the angular
+//   and linear parts together, each link's at its centre of mass with world axes. The joint positions and
+//   speeds are stepped by fourth order Runge-Kutta, four passes a step, which holds the energy of a long
+//   swinging chain where a first order step would add to it
+// - The root is fixed to the world by its joint, or floats free (a ragdoll). Hinges and sliders have
+//   limits, and drives: springs pulling towards a target angle / travel and speed, stepped implicitly so
+//   even very stiff drives are stable. Limits are stopped by joint impulses, as the iterative joints' limits
+// - Each link has a body (RigidBodies.h) with its shape, which the world moves to match. The bodies take
+//   part in contacts and joints as ordinary bodies of the link's mass. After the solve, the change in each
+//   link body's velocity is an impulse on the articulation, which passes it on to the rest of the tree.
+//   The world runs the solver a few times, each pass from the articulation's velocities, and the impulses
+//   go into the next step as forces, so a link held up by a contact rests where its drives say
+//=========================================================================================================
+
+#ifndef _ARTICULATION_H_DEFINED_
+#define _ARTICULATION_H_DEFINED_
+
+#include "RigidBodies.h"
+#include "Joints.h"
+#include "SpatialVector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//=====================
+// Articulation Handle
+//=====================
+
+struct ArticulationHandle
+{
+	static constexpr uint32_t InvalidSlot = 0xFFFFFFFF;
+
+	uint32_t slot = InvalidSlot; // Position in the handle table, not the articulation array
+	uint32_t generation = 0;     // Incremented each time the slot is freed
+
+	bool operator==(const ArticulationHandle& h) const { return slot == h.slot && generation == h.generation; }
+	bool operator!=(const ArticulationHandle& h) const { return !(*this == h); }
+};
+
+
+//==========================
+// Articulation Description
+//==========================
+
+// A link in its starting position, at rest. Points and directions are world space
+struct ArticulationLinkDesc
+{
+	// Position, orientation, mass, inertia and shape of the link. Velocities are ignored, and the mass
+	// must not be zero
+	BodyDesc body;
+
+	// Index of an earlier link, or -1 to join the root to the world
+	int parent = -1;
+
+	// Ball, Hinge, Slider or Fixed
+	JointType joint = JointType::Hinge;
+	Vector3f anchor = { 0, 0, 0 }; // The point the link is joined to its parent at
+	Vector3f axis = { 0, 1, 0 };   // Hinge: axis of rotation. Slider: direction of travel
+
+	// Hinge and slider: least and greatest angle (radians) or travel (metres) from the start
+	bool limited = false;
+	float lower = 0;
+	float upper = 0;
+
+	// Hinge and slider: torque / force of stiffness * (target - position) + damping * (targetSpeed - speed)
+	float driveStiffness = 0;
+	float driveDamping = 0;
+	float driveTarget = 0;
+	float driveTargetSpeed = 0;
+};
+
+struct ArticulationDesc
+{
+	// The root first, each link after its parent
+	std::vector<ArticulationLinkDesc> links;
+
+	// The root moves freely rather than being joined to the world, its joint is ignored
+	bool floatingBase = false;
+
+	// Torque / force of -jointDamping * speed on every joint but a floating root's, stepped implicitly
+	float jointDamping = 0;
+
+	// Joint speeds are held under this (radians or metres / second), so a whipping chain can't go faster
+	// than the step can follow
+	float maxJointSpeed = 100;
+
+	// Runge-Kutta steps per world step. A long chain pulled tight by the weight below it is stiff, each link
+	// rocking against its neighbours faster than a large step can follow: 200 links of 1 kg and 0.4 m need
+	// about 4 at 60 steps / second
+	int substeps = 1;
+};
+
+
+//==================
+// Articulation
+//==================
+
+class Articulation
+{
+public:
+	// Links from the description, with their bodies already created in the same order
+	Articulation(const ArticulationDesc& desc, const std::vector<BodyHandle>& linkBodies);
+
+	std::size_t LinkCount() const { return mLinks.size(); }
+	BodyHandle LinkBody(std::size_t link) const { return mLinks[link].body; }
+	int Parent(std::size_t link) const { return mLinks[link].parent; }
+
+	// Hinge angle or slider travel from the start, and its rate. Zero for other joints
+	float JointPosition(std::size_t link) const;
+	float JointSpeed(std::size_t link) const;
+
+	void SetDrive(std::size_t link, float stiffness, float damping, float target, float targetSpeed);
+
+	//=================
+	// Stepping
+	//=================
+	// Called by PhysicsWorld in this order each step
+
+	// Joint accelerations from gravity, the drives and the forces added to the link bodies, into the joint
+	// speeds, then the limits. Clears the link bodies' forces
+	void UpdateVelocities(RigidBodies& bodies, const Vector3f& gravity, float timeStep);
+
+	// Link velocities into their bodies, for the contact solver
+	void VelocitiesToBodies(RigidBodies& bodies) const;
+
+	// The solver's changes to the link bodies' velocities, as impulses on the articulation
+	void ImpulsesFromBodies(const RigidBodies& bodies);
+
+	// Before another pass of the solver: move each link body's velocity from before the solve by the
+	// difference between the articulation's velocity and the solver's. The solver's warm start then lands
+	// the link bodies on the articulation's velocities, with the impulses so far
+	void RewindBodies(const RigidBodies& bodies, Vector3SoA& startLinear, Vector3SoA& startAngular) const;
+
+	// Joint positions forward, then the link bodies to match
+	void UpdatePositions(RigidBodies& bodies, float timeStep);
+
+private:
+	struct Link
+	{
+		BodyHandle body;
+		int parent;
+		JointType joint;
+		int dofs;     // Joint speeds: hinge and slider 1, ball 3, floating root 6, fixed 0
+		int firstDof; // Into mSpeeds
+
+		float mass;
+		Vector3f inertia; // Principal moments
+
+		// Joint frame. Parent body space, or world space for the root
+		Vector3f parentAnchor;
+		Vector3f axis;
+		Vector3f childAnchor;  // Link body space
+		Quaternionf rest;      // The link's orientation relative to its parent at the start
+
+		// Joint position: hinge angle / slider travel, ball rotation, floating root position and orientation
+		float position;
+		Quaternionf rotation;
+		Vector3f rootPosition;
+		float startPosition; // The Runge-Kutta stages are taken from here
+		Quaternionf startRotation;
+		Vector3f startRootPosition;
+		float endPosition;   // Where the free step ends, before the limits and contacts
+		Quaternionf endRotation;
+		Vector3f endRootPosition;
+
+		bool limited;
+		float lower;
+		float upper;
+		float driveStiffness;
+		float driveDamping;
+		float driveTarget;
+		float driveTargetSpeed;
+
+		SpatialVectorf force;   // External torque and force this step, from the link body
+		SpatialVectorf impulse; // From the solver last step, carried into this one as a force
+
+		// This step, from the joint positions. All spatial vectors at the link's centre of mass
+		Quaternionf orientation;
+		Vector3f centre;
+		SpatialVectorf velocity;
+		SpatialVectorf biasAcceleration; // Velocity product part of the acceleration (c)
+		SpatialMatrixf inertiaA;         // Articulated inertia: the link's own plus what the links beyond it pass in
+		SpatialVectorf biasForceA;       // Articulated bias force
+		float inverseD[6][6];            // Inverse of the joint space articulated inertia (S^T I S)
+		float startInverseD[6][6];       // As at the start of the step, for the impulse passes
+	};
+
+	// Link orientations, centres and motion subspaces from the joint positions
+	void Kinematics();
+	void Advance(float time, const float* rates);
+	void Dynamics(const SpatialVectorf& baseAcceleration, float timeStep);
+	void Limits(float timeStep);
+
+	// Joint speed changes from impulses on the links (force vectors at their centres) and on the joints,
+	// using the articulated inertias at the start of the step. Either may be null
+	void Response(const SpatialVectorf* linkImpulses, const float* jointImpulses, float* speedChanges);
+
+	// Link spatial velocities from the joint speeds
+	void LinkVelocities();
+
+private:
+	std::vector<Link> mLinks;
+	float mJointDamping;
+	float mMaxJointSpeed;
+	int mSubsteps;
+	std::vector<float> mSpeeds; // Joint speeds, each link's dofs at its firstDof
+	std::vector<float> mStartSpeeds;
+	std::vector<float> mEndSpeeds; // At the end of the free step, before the limits and contacts
+	std::vector<float> mMeanSpeeds;
+	std::vector<float> mMeanAccelerations;
+
+	// Per dof, this step: motion subspace S (the link motion from a unit joint speed), U = I S, and
+	// u = joint force - S^T p
+	std::vector<SpatialVectorf> mSubspace;
+	std::vector<SpatialVectorf> mU;
+	std::vector<SpatialVectorf> mStartU; // At the start of the step, for the impulse passes
+	std::vector<float> mJointForces;
+	std::vector<float> mAccelerations;
+
+	// Scratch for the impulse passes
+	std::vector<SpatialVectorf> mImpulses;
+	std::vector<SpatialVectorf> mLinkImpulses;
+	std::vector<float> mResponse;
+	std::vector<float> mLimitResponses; // One column of joint speed changes per active limit
+};
+
+
+//======================
+// Articulation Storage
+//======================
+
+// Articulations packed in an array. Removing one moves the last into its place, handles stay valid
+class Articulations
+{
+public:
+	ArticulationHandle Add(Articulation&& articulation);
+
+	// Removing an invalid handle does nothing
+	void Remove(ArticulationHandle handle);
+
+	bool IsValid(ArticulationHandle handle) const
+	{
+		return handle.slot < mSlots.size() && mSlots[handle.slot].generation == handle.generation &&
+		       mSlots[handle.slot].index != ArticulationHandle::InvalidSlot;
+	}
+
+	// Current array index of an articulation. Handle must be valid
+	std::size_t Index(ArticulationHandle handle) const { return mSlots[handle.slot].index; }
+
+	// Handle of the articulation at an array index
+	ArticulationHandle Handle(std::size_t index) const
+	{
+		const uint32_t slot = mSlotOfArticulation[index];
+		return { slot, mSlots[slot].generation };
+	}
+
+	std::size_t Size() const { return articulations.size(); }
+	bool Empty() const { return articulations.empty(); }
+
+	// Public for the passes over all articulations. Add and remove through the above
+	std::vector<Articulation> articulations;
+
+private:
+	struct Slot
+	{
+		uint32_t index; // Array index of the articulation using this slot, InvalidSlot if free
+		uint32_t generation;
+	};
+
+	std::vector<Slot> mSlots;
+	std::vector<uint32_t> mFreeSlots;
+	std::vector<uint32_t> mSlotOfArticulation;
+};
+
+#endif // !_ARTICULATION_H_DEFINED_
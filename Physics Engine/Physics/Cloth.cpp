@@ -0,0 +1,331 @@
+//=========================================================================================================
+// Cloth.cpp: Cloth and Rope Building, Colouring and Packing, Long Range Attachments, Kernel Dispatch
+//=========================================================================================================
+
+#include "Cloth.h"
+#include "ClothLanes.h"
+#include "SIMDFloat.h"
+
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace
+{
+	// Smallest pieces the particle passes and a colour's groups are split into for the jobs
+	const std::size_t ParticlesPerJob = 1024;
+	const std::size_t GroupsPerJob = 64;
+
+	// Colours are bits of a 64 bit mask per particle. Constraints that find them all used go in one more
+	// colour, one to a group, solved in order
+	const int OverflowColour = 64;
+
+	std::size_t PaddedCount(std::size_t count)
+	{
+		return (count + ClothGroup::Lanes - 1) / ClothGroup::Lanes * ClothGroup::Lanes;
+	}
+}
+
+
+//=================
+// Building
+//=================
+
+ClothDesc ClothGrid(int columns, int rows, float spacing, const Vector3f& corner, float particleMass)
+{
+	ClothDesc desc;
+	for (int row = 0; row < rows; ++row)
+	{
+		for (int column = 0; column < columns; ++column)
+		{
+			desc.positions.push_back(corner + Vector3f(column * spacing, 0, row * spacing));
+			desc.inverseMasses.push_back(1 / particleMass);
+		}
+	}
+
+	auto index = [&](int column, int row) { return static_cast<uint32_t>(row * columns + column); };
+	for (int row = 0; row < rows; ++row)
+	{
+		for (int column = 0; column < columns; ++column)
+		{
+			if (column + 1 < columns)
+				desc.stretch.push_back({ index(column, row), index(column + 1, row) });
+			if (row + 1 < rows)
+				desc.stretch.push_back({ index(column, row), index(column, row + 1) });
+
+			// The diagonals alternate so the cloth doesn't fold more easily one way than the other
+			if (column + 1 < columns && row + 1 < rows)
+			{
+				if ((column + row) % 2 == 0)
+					desc.stretch.push_back({ index(column, row), index(column + 1, row + 1) });
+				else
+					desc.stretch.push_back({ index(column + 1, row), index(column, row + 1) });
+			}
+
+			if (column + 2 < columns)
+				desc.bend.push_back({ index(column, row), index(column + 2, row) });
+			if (row + 2 < rows)
+				desc.bend.push_back({ index(column, row), index(column, row + 2) });
+		}
+	}
+	return desc;
+}
+
+ClothDesc ClothRope(int count, float spacing, const Vector3f& start, const Vector3f& direction, float particleMass)
+{
+	ClothDesc desc;
+	for (int i = 0; i < count; ++i)
+	{
+		desc.positions.push_back(start + direction * (i * spacing));
+		desc.inverseMasses.push_back(1 / particleMass);
+		if (i + 1 < count)
+			desc.stretch.push_back({ static_cast<uint32_t>(i), static_cast<uint32_t>(i + 1) });
+		if (i + 2 < count)
+			desc.bend.push_back({ static_cast<uint32_t>(i), static_cast<uint32_t>(i + 2) });
+	}
+	return desc;
+}
+
+// The spare particle after the last has no mass and is the particle of the groups' empty lanes
+Cloth::Cloth(const ClothDesc& desc)
+	: mSubsteps(std::max(desc.substeps, 1)), mDamping(desc.damping), mThickness(desc.thickness), mFriction(desc.friction), mGravity(desc.gravity)
+{
+	mCount = desc.positions.size();
+	const std::size_t padded = PaddedCount(mCount + 1);
+	mPositions.Resize(padded);
+	mLastPositions.Resize(padded);
+	mVelocities.Resize(padded);
+	mInverseMasses.assign(padded, 0);
+	for (std::size_t i = 0; i < mCount; ++i)
+	{
+		mPositions.Set(i, desc.positions[i]);
+		mInverseMasses[i] = desc.inverseMasses[i];
+	}
+	mLastPositions = mPositions;
+
+	std::vector<ClothEdge> edges = desc.stretch;
+	edges.insert(edges.end(), desc.bend.begin(), desc.bend.end());
+	std::vector<float> compliances(desc.stretch.size(), desc.stretchCompliance);
+	compliances.resize(edges.size(), desc.bendCompliance);
+	Colour(edges, compliances);
+	Attach(desc);
+}
+
+// Greedy colouring in the order given, then a counting sort by colour into groups of eight
+void Cloth::Colour(const std::vector<ClothEdge>& edges, const std::vector<float>& compliances)
+{
+	mConstraintCount = edges.size();
+	std::vector<uint64_t> particleColours(mCount, 0);
+	std::vector<uint8_t> colours(edges.size());
+	std::size_t colourSizes[OverflowColour + 1] = {};
+	for (std::size_t c = 0; c < edges.size(); ++c)
+	{
+		const ClothEdge& edge = edges[c];
+		const uint64_t used = particleColours[edge.a] | particleColours[edge.b];
+		const int colour = used == ~0ull ? OverflowColour : std::countr_one(used);
+		if (colour != OverflowColour)
+		{
+			particleColours[edge.a] |= 1ull << colour;
+			particleColours[edge.b] |= 1ull << colour;
+		}
+		colours[c] = static_cast<uint8_t>(colour);
+		++colourSizes[colour];
+	}
+
+	std::size_t colourStarts[OverflowColour + 2] = {};
+	for (int colour = 0; colour <= OverflowColour; ++colour)
+		colourStarts[colour + 1] = colourStarts[colour] + colourSizes[colour];
+	std::vector<uint32_t> order(edges.size());
+	{
+		std::size_t next[OverflowColour + 1];
+		std::copy(colourStarts, colourStarts + OverflowColour + 1, next);
+		for (std::size_t c = 0; c < edges.size(); ++c)
+			order[next[colours[c]]++] = static_cast<uint32_t>(c);
+	}
+
+	// Groups of up to eight within each colour, one each in the overflow colour
+	const uint32_t spare = static_cast<uint32_t>(mCount);
+	mGroups.clear();
+	mColourGroups.clear();
+	mOverflow = colourSizes[OverflowColour] != 0;
+	for (int colour = 0; colour <= OverflowColour; ++colour)
+	{
+		if (colourSizes[colour] == 0)
+			continue;
+		mColourGroups.push_back(static_cast<uint32_t>(mGroups.size()));
+		const std::size_t perGroup = colour == OverflowColour ? 1 : ClothGroup::Lanes;
+		for (std::size_t first = colourStarts[colour]; first < colourStarts[colour + 1]; first += perGroup)
+		{
+			ClothGroup& group = mGroups.emplace_back();
+			for (int lane = 0; lane < ClothGroup::Lanes; ++lane)
+			{
+				const std::size_t k = first + lane;
+				const bool used = lane < static_cast<int>(perGroup) && k < colourStarts[colour + 1];
+				const ClothEdge edge = used ? edges[order[k]] : ClothEdge{ spare, spare };
+				group.a[lane] = edge.a;
+				group.b[lane] = edge.b;
+				group.restLength[lane] = used ? (mPositions.Get(edge.b) - mPositions.Get(edge.a)).Length() : 0;
+				group.compliance[lane] = used ? compliances[order[k]] : 0;
+			}
+		}
+	}
+	mColourGroups.push_back(static_cast<uint32_t>(mGroups.size()));
+}
+
+// Each particle's nearest pinned particle along the stretch edges, by Dijkstra's algorithm from all the
+// pinned particles at once. Particles with no pinned particle to reach are left unattached
+void Cloth::Attach(const ClothDesc& desc)
+{
+	const std::size_t padded = mInverseMasses.size();
+	mAnchors.resize(padded);
+	mAnchorDistances.assign(padded, FLT_MAX);
+	for (std::size_t i = 0; i < padded; ++i)
+		mAnchors[i] = static_cast<uint32_t>(i);
+	if (!desc.longRangeAttachments)
+		return;
+
+	// Edges of each particle, [starts[i], starts[i + 1])
+	std::vector<uint32_t> starts(mCount + 1, 0);
+	for (const ClothEdge& edge : desc.stretch)
+	{
+		++starts[edge.a + 1];
+		++starts[edge.b + 1];
+	}
+	for (std::size_t i = 0; i < mCount; ++i)
+		starts[i + 1] += starts[i];
+	std::vector<uint32_t> neighbours(starts[mCount]);
+	{
+		std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+		for (const ClothEdge& edge : desc.stretch)
+		{
+			neighbours[next[edge.a]++] = edge.b;
+			neighbours[next[edge.b]++] = edge.a;
+		}
+	}
+
+	using Entry = std::pair<float, uint32_t>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+	for (std::size_t i = 0; i < mCount; ++i)
+	{
+		if (mInverseMasses[i] == 0)
+		{
+			mAnchorDistances[i] = 0;
+			open.push({ 0.0f, static_cast<uint32_t>(i) });
+		}
+	}
+	while (!open.empty())
+	{
+		const auto [distance, i] = open.top();
+		open.pop();
+		if (distance > mAnchorDistances[i])
+			continue;
+		for (uint32_t k = starts[i]; k < starts[i + 1]; ++k)
+		{
+			const uint32_t j = neighbours[k];
+			const float through = distance + (mPositions.Get(j) - mPositions.Get(i)).Length();
+			if (through < mAnchorDistances[j])
+			{
+				mAnchorDistances[j] = through;
+				mAnchors[j] = mAnchors[i];
+				open.push({ through, j });
+			}
+		}
+	}
+}
+
+
+//=================
+// Stepping
+//=================
+
+template<typename F> void Cloth::ForParticles(F&& function)
+{
+	const std::size_t padded = mInverseMasses.size();
+	if (!mJobs || padded <= ParticlesPerJob)
+	{
+		function(std::size_t(0), padded);
+		return;
+	}
+	mJobs->ParallelFor(padded / ClothGroup::Lanes, ParticlesPerJob / ClothGroup::Lanes, [&](std::size_t begin, std::size_t end)
+	{
+		function(begin * ClothGroup::Lanes, end * ClothGroup::Lanes);
+	});
+}
+
+// Each substep: predict, a pass over the colours in turn, every job finishing a colour before the next
+// starts as the next shares particles with it, then attachments, colliders and velocities
+void Cloth::Step(float timeStep, const ClothColliders& colliders, const ClothKernels& kernels)
+{
+	const float substepTime = timeStep / mSubsteps;
+	const ClothParticles particles =
+	{
+		mPositions.X(), mPositions.Y(), mPositions.Z(),
+		mLastPositions.X(), mLastPositions.Y(), mLastPositions.Z(),
+		mVelocities.X(), mVelocities.Y(), mVelocities.Z(),
+		mInverseMasses.data(), mAnchors.data(), mAnchorDistances.data(),
+		mGravity, substepTime, std::max(1 - mDamping * substepTime, 0.0f), mThickness, mFriction, &colliders
+	};
+
+	for (int substep = 0; substep < mSubsteps; ++substep)
+	{
+		ForParticles([&](std::size_t begin, std::size_t end) { kernels.predict(particles, begin, end); });
+
+		for (std::size_t colour = 0; colour < ColourCount(); ++colour)
+		{
+			const ClothGroup* groups = mGroups.data() + mColourGroups[colour];
+			const std::size_t count = mColourGroups[colour + 1] - mColourGroups[colour];
+			const bool overflow = mOverflow && colour + 1 == ColourCount();
+			if (!mJobs || overflow || count <= GroupsPerJob)
+			{
+				kernels.solveGroups(groups, count, particles);
+				continue;
+			}
+			mJobs->ParallelFor(count, GroupsPerJob, [&](std::size_t begin, std::size_t end)
+			{
+				kernels.solveGroups(groups + begin, end - begin, particles);
+			});
+		}
+
+		ForParticles([&](std::size_t begin, std::size_t end) { kernels.finish(particles, begin, end); });
+	}
+}
+
+
+//=====================
+// Kernel Tables
+//=====================
+
+static const ClothKernels gScalarClothKernels = { PredictParticles<float>, SolveClothGroups<float>, FinishParticles<float> };
+
+#if defined(MATHS_SIMD_X86)
+
+static const ClothKernels gSSE2ClothKernels = { PredictParticles<Float4>, SolveClothGroups<Float4>, FinishParticles<Float4> };
+
+// Cloth_AVX2.cpp
+extern const ClothKernels gAVX2ClothKernels;
+
+#endif
+
+const ClothKernels& GetClothKernels(SIMDLevel level)
+{
+	if (level > DetectSIMDLevel())
+		level = DetectSIMDLevel();
+
+#if defined(MATHS_SIMD_X86)
+	if (level == SIMDLevel::AVX2)
+		return gAVX2ClothKernels;
+	if (level == SIMDLevel::SSE2)
+		return gSSE2ClothKernels;
+#endif
+	return gScalarClothKernels;
+}
+
+const ClothKernels& GetClothKernels()
+{
+	static const ClothKernels& kernels = GetClothKernels(DetectSIMDLevel());
+	return kernels;
+}
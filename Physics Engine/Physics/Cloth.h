@@ -0,0 +1,238 @@
+//=========================================================================================================
+// Cloth.h: Cloth and Rope as Particles Held by Constraints (Extended Position Based Dynamics)
+// - Particles are moved by gravity to predicted positions, the constraints then move the positions
+//   directly, and the velocities are whatever the positions moved by. XPBD gives each constraint a
+//   compliance (inverse stiffness, m/N) so how stiff it is doesn't depend on the step or the iterations
+// - Each step is split into substeps with one pass over the constraints each ("small steps"): stiffer and
+//   cheaper than the same work as iterations of one large step, and no multipliers need to be kept
+// - Stretch constraints hold neighbours at their rest distance, bend constraints hold particles two apart
+//   at theirs, with a much larger compliance so the cloth folds but doesn't crumple. Long range
+//   attachments keep each particle within its rest distance (along the cloth) of the nearest pinned
+//   particle, so a long hanging cloth or rope can't stretch however few substeps it has
+// - Particles collide with spheres, capsules and planes (ClothColliders), kept a thickness from them, with
+//   friction against their movement along the surface. Colliders push particles, nothing pushes back
+//=========================================================================================================
+// Layout: positions, last positions and velocities are Structure-of-Arrays (Vector3SoA) with inverse masses
+// alongside, padded to a multiple of eight. The distance constraints (stretch and bend) are graph coloured
+// so no two of a colour share a particle, then each colour is packed into groups of eight (ClothGroup)
+// solved one per SIMD lane, as ContactSolver.h's manifolds. Everything else is per particle, eight at a
+// time straight from the arrays. Kernels are chosen at runtime as in MathsSIMD.h, colours and particles
+// are split between jobs. The results don't depend on the threads, and on the kernels only by rounding
+//=========================================================================================================
+
+#ifndef _CLOTH_H_DEFINED_
+#define _CLOTH_H_DEFINED_
+
+#include "Vector3.h"
+#include "Vector3SoA.h"
+#include "MathsSIMD.h" // For SIMDLevel
+#include "AlignedAllocator.h"
+#include "JobSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//=====================
+// Description
+//=====================
+
+struct ClothEdge
+{
+	uint32_t a;
+	uint32_t b;
+};
+
+struct ClothDesc
+{
+	std::vector<Vector3f> positions;
+	std::vector<float> inverseMasses; // Zero pins a particle where it is
+	std::vector<ClothEdge> stretch;   // Rest lengths are the starting distances
+	std::vector<ClothEdge> bend;
+
+	float stretchCompliance = 0;  // m/N, zero for as stiff as the substeps allow
+	float bendCompliance = 1e-3f;
+
+	// Hold each particle within its distance along the stretch edges from the nearest pinned particle
+	bool longRangeAttachments = true;
+
+	int substeps = 10;
+	float damping = 0.1f;   // Fraction of the velocity lost per second
+	float thickness = 0.01f; // Distance particles keep from colliders
+	float friction = 0.3f;   // Against colliders
+	Vector3f gravity = { 0, -9.81f, 0 };
+};
+
+// columns * rows particles spacing apart in the x-z plane from corner (x along columns, z along rows), each
+// of the given mass. The sides of each quad and one diagonal, alternating, are stretch constraints, and bend
+// constraints join particles two apart along the rows and columns. Particle (column, row) is row * columns + column
+ClothDesc ClothGrid(int columns, int rows, float spacing, const Vector3f& corner, float particleMass);
+
+// count particles spacing apart from start along direction (unit length), with bend constraints two apart
+ClothDesc ClothRope(int count, float spacing, const Vector3f& start, const Vector3f& direction, float particleMass);
+
+
+//=====================
+// Colliders
+//=====================
+
+struct ClothSphere
+{
+	Vector3f centre;
+	float radius;
+};
+
+struct ClothCapsule
+{
+	Vector3f a; // Ends of the segment
+	Vector3f b;
+	float radius;
+};
+
+// Points p with Dot(normal, p) < distance are inside
+struct ClothPlane
+{
+	Vector3f normal;
+	float distance;
+};
+
+struct ClothColliders
+{
+	std::vector<ClothSphere> spheres;
+	std::vector<ClothCapsule> capsules;
+	std::vector<ClothPlane> planes;
+};
+
+
+//=====================
+// Batched Constraints
+//=====================
+
+// Eight distance constraints that share no particle, one per SIMD lane. Empty lanes join the spare
+// particle to itself, which has no mass, so they move nothing
+struct alignas(32) ClothGroup
+{
+	static constexpr int Lanes = 8;
+
+	uint32_t a[Lanes];
+	uint32_t b[Lanes];
+	float restLength[Lanes];
+	float compliance[Lanes];
+};
+
+// The particle arrays and step constants the kernels work on. Particles from begin to end, begin a
+// multiple of eight, the arrays padded so a whole eight can always be loaded
+struct ClothParticles
+{
+	float* x; float* y; float* z;                // Positions
+	float* lastX; float* lastY; float* lastZ;    // At the start of the substep
+	float* velocityX; float* velocityY; float* velocityZ;
+	const float* inverseMasses;
+	const uint32_t* anchors;       // Long range attachment: a pinned particle, or the particle itself
+	const float* anchorDistances;  // Furthest from it. Unattached particles are their own anchor at any distance
+
+	Vector3f gravity;
+	float substepTime;
+	float damping;    // Velocity kept per substep
+	float thickness;
+	float friction;
+	const ClothColliders* colliders;
+};
+
+// Function table of cloth kernels for one instruction set
+struct ClothKernels
+{
+	// Velocities on by gravity, last positions kept, positions on by the velocities
+	void (*predict)(const ClothParticles& particles, std::size_t begin, std::size_t end);
+
+	// One pass over the groups' distance constraints
+	void (*solveGroups)(const ClothGroup* groups, std::size_t count, const ClothParticles& particles);
+
+	// Long range attachments and colliders, then the velocities from how far the positions moved
+	void (*finish)(const ClothParticles& particles, std::size_t begin, std::size_t end);
+};
+
+// Kernel table for a specific level - used to compare kernels against each other
+// Asking for an unsupported level returns the best supported level below it
+const ClothKernels& GetClothKernels(SIMDLevel level);
+
+// Kernel table for the best level on this CPU
+const ClothKernels& GetClothKernels();
+
+
+//=====================
+// Cloth
+//=====================
+
+class Cloth
+{
+public:
+	// Colours and packs the constraints, and finds the long range attachments. The description's arrays
+	// must be the same length, and its edges between different particles
+	explicit Cloth(const ClothDesc& desc);
+
+	// Move the particles on by timeStep, in the description's substeps
+	void Step(float timeStep, const ClothColliders& colliders, const ClothKernels& kernels = GetClothKernels());
+
+	// Split colours and particles between jobs on this system. Null to go back to the calling thread only
+	void SetJobSystem(JobSystem* jobs) { mJobs = jobs; }
+
+	//=================
+	// Particles
+	//=================
+
+	std::size_t ParticleCount() const { return mCount; }
+	Vector3f Position(std::size_t i) const { return mPositions.Get(i); }
+	Vector3f Velocity(std::size_t i) const { return mVelocities.Get(i); }
+	float InverseMass(std::size_t i) const { return mInverseMasses[i]; }
+
+	// Move a particle, e.g. a pinned one to drag the cloth. Its velocity is left as it was
+	void SetPosition(std::size_t i, const Vector3f& position) { mPositions.Set(i, position); }
+
+	// Padded to a multiple of eight, the particles beyond ParticleCount are spare
+	const Vector3SoA& Positions() const { return mPositions; }
+
+	//=================
+	// Constraints
+	//=================
+
+	std::size_t ConstraintCount() const { return mConstraintCount; }
+	std::size_t ColourCount() const { return mColourGroups.empty() ? 0 : mColourGroups.size() - 1; }
+	std::size_t GroupCount() const { return mGroups.size(); }
+	const AlignedVector<ClothGroup>& Groups() const { return mGroups; }
+	const std::vector<uint32_t>& ColourGroups() const { return mColourGroups; } // Each colour's first group, plus the end
+
+	// Particle with its long range attachment, and the furthest it can be from it
+	uint32_t Anchor(std::size_t i) const { return mAnchors[i]; }
+	float AnchorDistance(std::size_t i) const { return mAnchorDistances[i]; }
+
+private:
+	void Colour(const std::vector<ClothEdge>& edges, const std::vector<float>& compliances);
+	void Attach(const ClothDesc& desc);
+
+	template<typename F> void ForParticles(F&& function);
+
+private:
+	JobSystem* mJobs = nullptr;
+
+	std::size_t mCount = 0;
+	Vector3SoA mPositions;
+	Vector3SoA mLastPositions;
+	Vector3SoA mVelocities;
+	AlignedVector<float> mInverseMasses;
+	AlignedVector<uint32_t> mAnchors;
+	AlignedVector<float> mAnchorDistances;
+
+	std::size_t mConstraintCount = 0;
+	AlignedVector<ClothGroup> mGroups;
+	std::vector<uint32_t> mColourGroups; // Index of each colour's first group, plus the end
+	bool mOverflow = false;              // The last colour's constraints share particles, one per group
+
+	int mSubsteps;
+	float mDamping;
+	float mThickness;
+	float mFriction;
+	Vector3f mGravity;
+};
+
+#endif // !_CLOTH_H_DEFINED_
@@ -0,0 +1,199 @@
+//=========================================================================================================
+// ClothLanes.h: The Cloth Kernels Written Once for Any Lane Type (internal to the cloth)
+// - Templates on the lane type F as ContactLanes.h: float one particle or constraint at a time
+//   (Cloth.cpp), Float4 four at a time (Cloth.cpp), Float8 eight at a time (Cloth_AVX2.cpp)
+// - The particle kernels load straight from the Structure-of-Arrays, the group kernel gathers the
+//   particles of its lanes and scatters them back, as the contact solver's groups do their bodies
+//=========================================================================================================
+// Header-only: Templates, defined here so each kernel file can instantiate them for its own lane type
+//=========================================================================================================
+
+#ifndef _CLOTH_LANES_H_DEFINED_
+#define _CLOTH_LANES_H_DEFINED_
+
+#include "Cloth.h"
+#include "ContactLanes.h"
+
+//=====================
+// Particles
+//=====================
+
+template<typename F> Vector3N<F> LoadParticles(const float* x, const float* y, const float* z, std::size_t i)
+{
+	return { LoadLanes<F>(x + i), LoadLanes<F>(y + i), LoadLanes<F>(z + i) };
+}
+
+template<typename F> void StoreParticles(const Vector3N<F>& lanes, float* x, float* y, float* z, std::size_t i)
+{
+	StoreLanes(lanes.x, x + i);
+	StoreLanes(lanes.y, y + i);
+	StoreLanes(lanes.z, z + i);
+}
+
+template<typename F> F GatherFloats(const float* values, const uint32_t* indices)
+{
+	alignas(32) float lanes[LaneWidth<F>];
+	for (int i = 0; i < LaneWidth<F>; ++i)
+		lanes[i] = values[indices[i]];
+	return LoadLanes<F>(lanes);
+}
+
+template<typename F> Vector3N<F> GatherParticles(const float* x, const float* y, const float* z, const uint32_t* indices)
+{
+	return { GatherFloats<F>(x, indices), GatherFloats<F>(y, indices), GatherFloats<F>(z, indices) };
+}
+
+// Lanes never share a particle, except the spare particle of empty lanes which is written back unchanged
+template<typename F> void ScatterParticles(const Vector3N<F>& lanes, float* x, float* y, float* z, const uint32_t* indices)
+{
+	alignas(32) float lx[LaneWidth<F>], ly[LaneWidth<F>], lz[LaneWidth<F>];
+	StoreLanes(lanes.x, lx);
+	StoreLanes(lanes.y, ly);
+	StoreLanes(lanes.z, lz);
+	for (int i = 0; i < LaneWidth<F>; ++i)
+	{
+		x[indices[i]] = lx[i];
+		y[indices[i]] = ly[i];
+		z[indices[i]] = lz[i];
+	}
+}
+
+template<typename F> Vector3N<F> BroadcastLanes(const Vector3f& v)
+{
+	return { F(v.x), F(v.y), F(v.z) };
+}
+
+
+//=====================
+// Colliders
+//=====================
+
+// Push the lanes that are hit out along the normal by the penetration, then take away their movement
+// along the surface this substep, up to friction * penetration (Coulomb friction as a position change)
+template<typename F, typename M> Vector3N<F> PushOut(const Vector3N<F>& position, const Vector3N<F>& last, const Vector3N<F>& normal,
+                                                     const F& penetration, const M& hit, float friction)
+{
+	const F zero(0.0f);
+	const F one(1.0f);
+	const Vector3N<F> pushed = position + normal * penetration;
+	const Vector3N<F> moved = pushed - last;
+	const Vector3N<F> sliding = moved - normal * Dot(normal, moved);
+	const F slide = Sqrt(Dot(sliding, sliding));
+	const M slides = And(hit, slide > F(1e-9f));
+	const F held = Select(slides, Min(F(friction) * penetration / Select(slides, slide, one), one), zero);
+	return Select(hit, pushed - sliding * held, position);
+}
+
+template<typename F, typename M> Vector3N<F> CollideSphere(const Vector3N<F>& position, const Vector3N<F>& last, const M& free,
+                                                           const Vector3N<F>& centre, float radius, float friction)
+{
+	const F one(1.0f);
+	const Vector3N<F> offset = position - centre;
+	const F distance = Sqrt(Dot(offset, offset));
+	const F penetration = F(radius) - distance;
+	const M hit = And(free, And(penetration > F(0.0f), distance > F(1e-9f)));
+	const Vector3N<F> normal = offset * (one / Select(hit, distance, one));
+	return PushOut(position, last, normal, penetration, hit, friction);
+}
+
+
+//=====================
+// Kernels
+//=====================
+
+template<typename F> void PredictParticles(const ClothParticles& p, std::size_t begin, std::size_t end)
+{
+	const F time(p.substepTime);
+	const Vector3N<F> gravity = BroadcastLanes<F>(p.gravity * p.substepTime);
+	for (std::size_t i = begin; i < end; i += LaneWidth<F>)
+	{
+		const auto free = LoadLanes<F>(p.inverseMasses + i) > F(0.0f);
+		Vector3N<F> velocity = LoadParticles<F>(p.velocityX, p.velocityY, p.velocityZ, i);
+		velocity = Select(free, velocity + gravity, velocity);
+		const Vector3N<F> position = LoadParticles<F>(p.x, p.y, p.z, i);
+		StoreParticles(position, p.lastX, p.lastY, p.lastZ, i);
+		StoreParticles(position + velocity * time, p.x, p.y, p.z, i);
+		StoreParticles(velocity, p.velocityX, p.velocityY, p.velocityZ, i);
+	}
+}
+
+// XPBD with the multiplier starting from zero each substep: the correction is C / (wA + wB + compliance / h^2)
+// along the constraint, shared between the two particles by inverse mass
+template<typename F> void SolveClothGroups(const ClothGroup* groups, std::size_t count, const ClothParticles& p)
+{
+	const F zero(0.0f);
+	const F one(1.0f);
+	const F complianceScale(1.0f / (p.substepTime * p.substepTime));
+	for (std::size_t g = 0; g < count; ++g)
+	{
+		const ClothGroup& group = groups[g];
+		for (int lane = 0; lane < ClothGroup::Lanes; lane += LaneWidth<F>)
+		{
+			Vector3N<F> a = GatherParticles<F>(p.x, p.y, p.z, group.a + lane);
+			Vector3N<F> b = GatherParticles<F>(p.x, p.y, p.z, group.b + lane);
+			const F inverseMassA = GatherFloats<F>(p.inverseMasses, group.a + lane);
+			const F inverseMassB = GatherFloats<F>(p.inverseMasses, group.b + lane);
+
+			const Vector3N<F> difference = b - a;
+			const F length = Sqrt(Dot(difference, difference));
+			const F error = length - LoadLanes<F>(group.restLength + lane);
+			const F denominator = (inverseMassA + inverseMassB + LoadLanes<F>(group.compliance + lane) * complianceScale) * length;
+			const auto moves = And(length > F(1e-9f), denominator > zero);
+			const F scale = Select(moves, error / Select(moves, denominator, one), zero);
+
+			a = a + difference * (inverseMassA * scale);
+			b = b - difference * (inverseMassB * scale);
+			ScatterParticles(a, p.x, p.y, p.z, group.a + lane);
+			ScatterParticles(b, p.x, p.y, p.z, group.b + lane);
+		}
+	}
+}
+
+// Anchors are pinned, so where they were at the start of the substep is where they are
+template<typename F> void FinishParticles(const ClothParticles& p, std::size_t begin, std::size_t end)
+{
+	const F zero(0.0f);
+	const F one(1.0f);
+	const F velocityScale(p.damping / p.substepTime);
+	const ClothColliders& colliders = *p.colliders;
+	for (std::size_t i = begin; i < end; i += LaneWidth<F>)
+	{
+		const auto free = LoadLanes<F>(p.inverseMasses + i) > zero;
+		Vector3N<F> position = LoadParticles<F>(p.x, p.y, p.z, i);
+		const Vector3N<F> last = LoadParticles<F>(p.lastX, p.lastY, p.lastZ, i);
+
+		// Long range attachment: back to the furthest it can be from its anchor
+		const Vector3N<F> anchor = GatherParticles<F>(p.lastX, p.lastY, p.lastZ, p.anchors + i);
+		const Vector3N<F> offset = position - anchor;
+		const F distance = Sqrt(Dot(offset, offset));
+		const F over = distance - LoadLanes<F>(p.anchorDistances + i);
+		const auto stretched = And(free, over > zero);
+		position = Select(stretched, position - offset * (over / Select(stretched, distance, one)), position);
+
+		for (const ClothSphere& sphere : colliders.spheres)
+			position = CollideSphere(position, last, free, BroadcastLanes<F>(sphere.centre), sphere.radius + p.thickness, p.friction);
+
+		for (const ClothCapsule& capsule : colliders.capsules)
+		{
+			// Nearest point of the segment, then as a sphere there
+			const Vector3f axis = capsule.b - capsule.a;
+			const float lengthSq = Dot(axis, axis);
+			const Vector3N<F> start = BroadcastLanes<F>(capsule.a);
+			const Vector3N<F> direction = BroadcastLanes<F>(axis);
+			const F along = Clamp(Dot(position - start, direction) * F(lengthSq > 0 ? 1 / lengthSq : 0.0f), zero, one);
+			position = CollideSphere(position, last, free, start + direction * along, capsule.radius + p.thickness, p.friction);
+		}
+
+		for (const ClothPlane& plane : colliders.planes)
+		{
+			const Vector3N<F> normal = BroadcastLanes<F>(plane.normal);
+			const F penetration = F(plane.distance + p.thickness) - Dot(normal, position);
+			position = PushOut(position, last, normal, penetration, And(free, penetration > zero), p.friction);
+		}
+
+		StoreParticles(position, p.x, p.y, p.z, i);
+		StoreParticles((position - last) * velocityScale, p.velocityX, p.velocityY, p.velocityZ, i);
+	}
+}
+
+#endif // !_CLOTH_LANES_H_DEFINED_
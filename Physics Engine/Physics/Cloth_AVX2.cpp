@@ -0,0 +1,21 @@
+//=========================================================================================================
+// Cloth_AVX2.cpp: Cloth Kernels Eight Particles or Constraints at a Time
+// - Only called after DetectSIMDLevel() has confirmed AVX2 and FMA are available
+// - Built with AVX2 code generation for this file only, as MathsSIMD_AVX2.cpp
+//=========================================================================================================
+
+#include "Cloth.h"
+
+#if defined(MATHS_SIMD_X86)
+
+#if !defined(_MSC_VER)
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "ClothLanes.h"
+#include "SIMDFloat8.h"
+
+extern const ClothKernels gAVX2ClothKernels;
+const ClothKernels gAVX2ClothKernels = { PredictParticles<Float8>, SolveClothGroups<Float8>, FinishParticles<Float8> };
+
+#endif // MATHS_SIMD_X86
@@ -0,0 +1,557 @@
+//=========================================================================================================
+// ContactSolver.cpp: Constraint Preparation, Colouring and Packing, Sequential Solver, Kernel Dispatch
+//=========================================================================================================
+
+#include "ContactSolver.h"
+#include "ContactSolverLanes.h"
+#include "SIMDFloat.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <barrier>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	// Fewer groups than this per thread and splitting a colour costs more in waiting than it saves
+	const std::size_t MinGroupsPerThread = 64;
+
+	// Two unit tangents perpendicular to a unit normal and each other, the friction directions
+	void ContactTangents(const Vector3f& normal, Vector3f& tangent1, Vector3f& tangent2)
+	{
+		// Cross with whichever world axis is least parallel to the normal
+		if (std::abs(normal.x) < 0.57735f)
+			tangent1 = Normalise(Vector3f(0, normal.z, -normal.y));
+		else
+			tangent1 = Normalise(Vector3f(normal.y, -normal.x, 0));
+		tangent2 = Cross(normal, tangent1);
+	}
+}
+
+
+//=================
+// Solving
+//=================
+
+void ContactSolver::Solve(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const ContactSolverSettings& settings, float timeStep,
+                          const ContactSolverKernels& kernels)
+{
+	Solve(bodies, manifolds, AllManifolds(manifolds.size()), manifolds.size(), settings, timeStep, 1, kernels);
+}
+
+void ContactSolver::Solve(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, std::size_t count,
+                          const ContactSolverSettings& settings, float timeStep, unsigned int threadCount, const ContactSolverKernels& kernels)
+{
+	Solve(bodies, manifolds, manifoldIndices, count, nullptr, nullptr, 0, settings, timeStep, threadCount, kernels);
+}
+
+void ContactSolver::Solve(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, std::size_t count,
+                          Joint* joints, const uint32_t* jointIndices, std::size_t jointCount, const ContactSolverSettings& settings, float timeStep,
+                          unsigned int threadCount, const ContactSolverKernels& kernels)
+{
+	if (count == 0 && jointCount == 0)
+		return;
+
+	Prepare(bodies, manifolds, manifoldIndices, count, joints, jointIndices, jointCount, settings, timeStep);
+	Colour();
+	Pack(static_cast<uint32_t>(mBodyIndices.size()));
+
+	// A colour's groups then its joints, numbered together: items [begin, end) of the colour
+	Vector3f* linearVelocities = mLinearVelocities.data();
+	Vector3f* angularVelocities = mAngularVelocities.data();
+	auto itemCount = [&](std::size_t colour)
+	{
+		return mColourGroups[colour + 1] - mColourGroups[colour] + mColourJoints[colour + 1] - mColourJoints[colour];
+	};
+	auto solveItems = [&](std::size_t colour, std::size_t begin, std::size_t end, bool warmStart)
+	{
+		const std::size_t groups = mColourGroups[colour + 1] - mColourGroups[colour];
+		if (begin < groups)
+		{
+			ContactSolverGroup* first = mGroups.data() + mColourGroups[colour] + begin;
+			const std::size_t n = std::min(end, groups) - begin;
+			if (warmStart)
+				kernels.warmStart(first, n, linearVelocities, angularVelocities);
+			else
+				kernels.iterate(first, n, linearVelocities, angularVelocities);
+		}
+		for (std::size_t k = std::max(begin, groups); k < end; ++k)
+		{
+			JointConstraint& joint = mJoints[mJointOrder[mColourJoints[colour] + k - groups]];
+			if (warmStart)
+				WarmStartJoint(joint, linearVelocities, angularVelocities);
+			else
+				SolveJoint(joint, linearVelocities, angularVelocities, settings.jointBlocks);
+		}
+	};
+
+	// Each pass visits the colours in turn, the items of a colour split between the threads. Every thread
+	// must finish a colour before any starts the next, as the next colour's manifolds share bodies with it
+	auto solvePasses = [&](auto&& solveColour)
+	{
+		if (settings.warmStarting)
+		{
+			for (std::size_t colour = 0; colour < ColourCount(); ++colour)
+				solveColour(colour, true);
+		}
+		for (int iteration = 0; iteration < settings.iterations; ++iteration)
+		{
+			for (std::size_t colour = 0; colour < ColourCount(); ++colour)
+				solveColour(colour, false);
+		}
+	};
+
+	const unsigned int threads = ParallelRangeCount(mGroups.size() + mJoints.size(), threadCount, MinGroupsPerThread);
+	if (threads == 1)
+	{
+		solvePasses([&](std::size_t colour, bool warmStart) { solveItems(colour, 0, itemCount(colour), warmStart); });
+	}
+	else if (mJobs)
+	{
+		// Jobs can't wait for each other at a barrier, so each colour is a parallel loop of its own
+		solvePasses([&](std::size_t colour, bool warmStart)
+		{
+			mJobs->ParallelFor(itemCount(colour), MinGroupsPerThread, [&](std::size_t begin, std::size_t end) { solveItems(colour, begin, end, warmStart); });
+		});
+	}
+	else
+	{
+		std::barrier colourDone(threads);
+		ParallelFor(threads, threads, 1, [&](std::size_t, std::size_t, unsigned int thread)
+		{
+			solvePasses([&](std::size_t colour, bool warmStart)
+			{
+				const std::size_t items = itemCount(colour);
+				solveItems(colour, items * thread / threads, items * (thread + 1) / threads, warmStart);
+				colourDone.arrive_and_wait();
+			});
+		});
+	}
+
+	// Final normal impulses from the groups back to the constraints
+	for (std::size_t g = 0; g < mGroups.size(); ++g)
+	{
+		for (uint32_t k = mGroupStarts[g]; k < mGroupStarts[g + 1]; ++k)
+		{
+			ManifoldConstraint& c = mConstraints[mSolveOrder[k]];
+			for (int p = 0; p < c.pointCount; ++p)
+				c.normals[p].impulse = mGroups[g].rows[p].impulse[k - mGroupStarts[g]];
+		}
+	}
+
+	StoreImpulses(manifolds, manifoldIndices, joints);
+	ScatterVelocities(bodies);
+}
+
+void ContactSolver::SolveSequential(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const ContactSolverSettings& settings, float timeStep)
+{
+	SolveSequential(bodies, manifolds, AllManifolds(manifolds.size()), manifolds.size(), settings, timeStep);
+}
+
+void ContactSolver::SolveSequential(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, std::size_t count,
+                                    const ContactSolverSettings& settings, float timeStep)
+{
+	SolveSequential(bodies, manifolds, manifoldIndices, count, nullptr, nullptr, 0, settings, timeStep);
+}
+
+void ContactSolver::SolveSequential(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, std::size_t count,
+                                    Joint* joints, const uint32_t* jointIndices, std::size_t jointCount, const ContactSolverSettings& settings,
+                                    float timeStep)
+{
+	if (count == 0 && jointCount == 0)
+		return;
+
+	Prepare(bodies, manifolds, manifoldIndices, count, joints, jointIndices, jointCount, settings, timeStep);
+	if (settings.warmStarting)
+		WarmStart();
+	for (int iteration = 0; iteration < settings.iterations; ++iteration)
+		Iterate(settings.jointBlocks);
+
+	StoreImpulses(manifolds, manifoldIndices, joints);
+	ScatterVelocities(bodies);
+}
+
+// 0, 1, 2 ... count - 1, for solving every manifold
+const uint32_t* ContactSolver::AllManifolds(std::size_t count)
+{
+	while (mAllManifolds.size() < count)
+		mAllManifolds.push_back(static_cast<uint32_t>(mAllManifolds.size()));
+	return mAllManifolds.data();
+}
+
+// Local slot of a body for this solve, taking its velocity the first time it is seen
+uint32_t ContactSolver::LocalBody(const RigidBodies& bodies, std::size_t index)
+{
+	if (mLocalBodies.size() < bodies.Size())
+		mLocalBodies.resize(bodies.Size(), NoLocalBody);
+
+	uint32_t& local = mLocalBodies[index];
+	if (local == NoLocalBody)
+	{
+		local = static_cast<uint32_t>(mBodyIndices.size());
+		mBodyIndices.push_back(static_cast<uint32_t>(index));
+		mLinearVelocities.push_back(bodies.linearVelocities.Get(index));
+		mAngularVelocities.push_back(bodies.angularVelocities.Get(index));
+	}
+	return local;
+}
+
+// Dynamic bodies' velocities back to the body arrays. Static bodies are left alone, another solve on
+// another thread may be reading them. The local slots are cleared for the next solve
+void ContactSolver::ScatterVelocities(RigidBodies& bodies)
+{
+	for (std::size_t local = 0; local < mBodyIndices.size(); ++local)
+	{
+		const uint32_t i = mBodyIndices[local];
+		if (bodies.inverseMasses[i] != 0)
+		{
+			bodies.linearVelocities.Set(i, mLinearVelocities[local]);
+			bodies.angularVelocities.Set(i, mAngularVelocities[local]);
+		}
+		mLocalBodies[i] = NoLocalBody;
+	}
+}
+
+// Final normal impulses back to the manifolds, and joint impulses to the joints, for next step's warm start
+void ContactSolver::StoreImpulses(std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, Joint* joints) const
+{
+	for (std::size_t k = 0; k < mConstraints.size(); ++k)
+	{
+		for (int p = 0; p < mConstraints[k].pointCount; ++p)
+			manifolds[manifoldIndices[k]].points[p].normalImpulse = mConstraints[k].normals[p].impulse;
+	}
+	for (const JointConstraint& c : mJoints)
+		StoreJointImpulses(c, joints[c.joint]);
+}
+
+// Everything about the rows that stays the same over the iterations: lever arms, effective masses, biases
+// Also gathers the velocities of the bodies involved into local slots, which the constraints refer to
+void ContactSolver::Prepare(const RigidBodies& bodies, const std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, std::size_t count,
+                            const Joint* joints, const uint32_t* jointIndices, std::size_t jointCount, const ContactSolverSettings& settings,
+                            float timeStep)
+{
+	const float inverseTimeStep = 1 / timeStep;
+	mBodyIndices.clear();
+	mLinearVelocities.clear();
+	mAngularVelocities.clear();
+	mConstraints.resize(count);
+	mRowCount = 0;
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		const ContactManifold& manifold = manifolds[manifoldIndices[k]];
+		ManifoldConstraint& c = mConstraints[k];
+		const std::size_t indexA = bodies.SlotIndex(manifold.bodyA);
+		const std::size_t indexB = bodies.SlotIndex(manifold.bodyB);
+		c.bodyA = LocalBody(bodies, indexA);
+		c.bodyB = LocalBody(bodies, indexB);
+		c.inverseMassA = bodies.inverseMasses[indexA];
+		c.inverseMassB = bodies.inverseMasses[indexB];
+		c.friction = settings.friction;
+		c.pointCount = manifold.pointCount;
+		mRowCount += manifold.pointCount + 3;
+
+		const Vector3f positionA = bodies.positions.Get(indexA);
+		const Vector3f positionB = bodies.positions.Get(indexB);
+		auto prepareRow = [&](Row& row, const Vector3f& linear, const Vector3f& angularA, const Vector3f& angularB, float impulse)
+		{
+			row.linear = linear;
+			row.angularA = angularA;
+			row.angularB = angularB;
+			row.turnA = bodies.ApplyInverseInertia(indexA, angularA);
+			row.turnB = bodies.ApplyInverseInertia(indexB, angularB);
+			const float k = (c.inverseMassA + c.inverseMassB) * linear.LengthSq() + Dot(angularA, row.turnA) + Dot(angularB, row.turnB);
+			row.effectiveMass = k > 0 ? 1 / k : 0;
+			row.bias = 0;
+			row.impulse = settings.warmStarting ? impulse : 0;
+		};
+
+		Vector3f centre = { 0, 0, 0 };
+		for (int p = 0; p < manifold.pointCount; ++p)
+		{
+			const ManifoldPoint& point = manifold.points[p];
+			const Vector3f rA = point.point.position - positionA;
+			const Vector3f rB = point.point.position - positionB;
+			Row& row = c.normals[p];
+			prepareRow(row, manifold.normal, Cross(rA, manifold.normal), Cross(rB, manifold.normal), point.normalImpulse);
+
+			// Push out penetration beyond the allowed amount, or let the bodies close a gap in one step
+			const float depth = point.point.depth;
+			row.bias = std::min(settings.baumgarte * (depth - settings.allowedPenetration), depth) * inverseTimeStep;
+
+			// Bounce if approaching fast enough, from the velocities before any contact impulses
+			const Vector3f velocityA = mLinearVelocities[c.bodyA] + Cross(mAngularVelocities[c.bodyA], rA);
+			const Vector3f velocityB = mLinearVelocities[c.bodyB] + Cross(mAngularVelocities[c.bodyB], rB);
+			const float approach = Dot(velocityB - velocityA, manifold.normal);
+			if (approach < -settings.restitutionThreshold)
+				row.bias = std::max(row.bias, -settings.restitution * approach);
+
+			centre += point.point.position;
+		}
+		centre = centre * (1.0f / manifold.pointCount);
+
+		c.twistRadius = 0;
+		for (int p = 0; p < manifold.pointCount; ++p)
+			c.twistRadius += (manifold.points[p].point.position - centre).Length();
+		c.twistRadius *= 1.0f / manifold.pointCount;
+
+		// Friction starts from zero each step
+		Vector3f tangents[2];
+		ContactTangents(manifold.normal, tangents[0], tangents[1]);
+		const Vector3f rA = centre - positionA;
+		const Vector3f rB = centre - positionB;
+		for (int t = 0; t < 2; ++t)
+			prepareRow(c.tangents[t], tangents[t], Cross(rA, tangents[t]), Cross(rB, tangents[t]), 0);
+		prepareRow(c.twist, { 0, 0, 0 }, manifold.normal, manifold.normal, 0);
+	}
+
+	mJoints.resize(jointCount);
+	for (std::size_t k = 0; k < jointCount; ++k)
+	{
+		const Joint& joint = joints[jointIndices[k]];
+		JointConstraint& c = mJoints[k];
+		const std::size_t indexA = bodies.SlotIndex(joint.bodyA);
+		const std::size_t indexB = bodies.SlotIndex(joint.bodyB);
+		c.joint = jointIndices[k];
+		c.bodyA = LocalBody(bodies, indexA);
+		c.bodyB = LocalBody(bodies, indexB);
+		PrepareJoint(c, joint, bodies, indexA, indexB, settings.jointBaumgarte, settings.warmStarting, timeStep);
+		mRowCount += c.blockRows + c.singleRows;
+	}
+
+	// Spare body at rest for the empty lanes of groups
+	mLinearVelocities.push_back({ 0, 0, 0 });
+	mAngularVelocities.push_back({ 0, 0, 0 });
+}
+
+
+//=================
+// Batching
+//=================
+
+// Greedy colouring: each manifold takes the lowest colour not yet used by either of its dynamic bodies.
+// Static bodies never change velocity so they can be shared. A manifold whose bodies have used all 64
+// colours goes in a final overflow colour and gets a group to itself
+// The joints are coloured first, then the manifolds take the same colours around them
+void ContactSolver::Colour()
+{
+	const int OverflowColour = 64;
+	mBodyColours.assign(mBodyIndices.size(), 0);
+
+	auto colourOf = [&](uint32_t bodyA, uint32_t bodyB, float inverseMassA, float inverseMassB)
+	{
+		const uint64_t used = (inverseMassA != 0 ? mBodyColours[bodyA] : 0) | (inverseMassB != 0 ? mBodyColours[bodyB] : 0);
+		const int colour = used == ~0ull ? OverflowColour : std::countr_one(used);
+		if (colour != OverflowColour)
+		{
+			if (inverseMassA != 0)
+				mBodyColours[bodyA] |= 1ull << colour;
+			if (inverseMassB != 0)
+				mBodyColours[bodyB] |= 1ull << colour;
+		}
+		return static_cast<uint8_t>(colour);
+	};
+
+	std::size_t jointSizes[OverflowColour + 1] = {};
+	mJointColours.resize(mJoints.size());
+	for (std::size_t j = 0; j < mJoints.size(); ++j)
+	{
+		const JointConstraint& c = mJoints[j];
+		mJointColours[j] = colourOf(c.bodyA, c.bodyB, c.inverseMassA, c.inverseMassB);
+		++jointSizes[mJointColours[j]];
+	}
+
+	std::vector<uint8_t>& colours = mManifoldColours;
+	colours.resize(mConstraints.size());
+	std::size_t colourSizes[OverflowColour + 1] = {};
+	for (std::size_t m = 0; m < mConstraints.size(); ++m)
+	{
+		const ManifoldConstraint& c = mConstraints[m];
+		colours[m] = colourOf(c.bodyA, c.bodyB, c.inverseMassA, c.inverseMassB);
+		++colourSizes[colours[m]];
+	}
+
+	// Counting sort by colour, keeping the manifold order within each colour
+	std::size_t colourStarts[OverflowColour + 2] = {};
+	for (int colour = 0; colour <= OverflowColour; ++colour)
+		colourStarts[colour + 1] = colourStarts[colour] + colourSizes[colour];
+	mSolveOrder.resize(mConstraints.size());
+	{
+		std::size_t next[OverflowColour + 1];
+		std::copy(colourStarts, colourStarts + OverflowColour + 1, next);
+		for (std::size_t m = 0; m < mConstraints.size(); ++m)
+			mSolveOrder[next[colours[m]]++] = static_cast<uint32_t>(m);
+	}
+
+	// The same for the joints
+	std::size_t jointStarts[OverflowColour + 2] = {};
+	for (int colour = 0; colour <= OverflowColour; ++colour)
+		jointStarts[colour + 1] = jointStarts[colour] + jointSizes[colour];
+	mJointOrder.resize(mJoints.size());
+	{
+		std::size_t next[OverflowColour + 1];
+		std::copy(jointStarts, jointStarts + OverflowColour + 1, next);
+		for (std::size_t j = 0; j < mJoints.size(); ++j)
+			mJointOrder[next[mJointColours[j]]++] = static_cast<uint32_t>(j);
+	}
+
+	// Groups of up to eight within each colour, one each in the overflow colour
+	mGroupStarts.clear();
+	mColourGroups.clear();
+	mColourJoints.clear();
+	for (int colour = 0; colour <= OverflowColour; ++colour)
+	{
+		if (colourSizes[colour] == 0 && jointSizes[colour] == 0)
+			continue;
+		mColourGroups.push_back(static_cast<uint32_t>(mGroupStarts.size()));
+		mColourJoints.push_back(static_cast<uint32_t>(jointStarts[colour]));
+		const std::size_t groupSize = colour == OverflowColour ? 1 : ContactSolverGroup::Lanes;
+		for (std::size_t k = colourStarts[colour]; k < colourStarts[colour + 1]; k += groupSize)
+			mGroupStarts.push_back(static_cast<uint32_t>(k));
+	}
+	mGroupStarts.push_back(static_cast<uint32_t>(mSolveOrder.size()));
+	mColourGroups.push_back(static_cast<uint32_t>(mGroupStarts.size() - 1));
+	mColourJoints.push_back(static_cast<uint32_t>(mJointOrder.size()));
+}
+
+// Copy the prepared constraints into their groups' lanes. Empty lanes and missing points stay zero
+void ContactSolver::Pack(uint32_t spareBody)
+{
+	mGroups.resize(mGroupStarts.size() - 1);
+	for (std::size_t g = 0; g < mGroups.size(); ++g)
+	{
+		ContactSolverGroup& group = mGroups[g];
+		std::memset(&group, 0, sizeof(group));
+		for (int lane = 0; lane < ContactSolverGroup::Lanes; ++lane)
+		{
+			group.bodyA[lane] = spareBody;
+			group.bodyB[lane] = spareBody;
+		}
+
+		for (uint32_t k = mGroupStarts[g]; k < mGroupStarts[g + 1]; ++k)
+		{
+			const int lane = static_cast<int>(k - mGroupStarts[g]);
+			const ManifoldConstraint& c = mConstraints[mSolveOrder[k]];
+			group.bodyA[lane] = c.bodyA;
+			group.bodyB[lane] = c.bodyB;
+			group.inverseMassA[lane] = c.inverseMassA;
+			group.inverseMassB[lane] = c.inverseMassB;
+			group.friction[lane] = c.friction;
+			group.twistRadius[lane] = c.twistRadius;
+
+			auto packRow = [&](ContactSolverGroup::Rows& rows, const Row& row)
+			{
+				const Vector3f* vectors[] = { &row.linear, &row.angularA, &row.angularB, &row.turnA, &row.turnB };
+				float (*lanes[])[ContactSolverGroup::Lanes] = { rows.linear, rows.angularA, rows.angularB, rows.turnA, rows.turnB };
+				for (int v = 0; v < 5; ++v)
+				{
+					lanes[v][0][lane] = vectors[v]->x;
+					lanes[v][1][lane] = vectors[v]->y;
+					lanes[v][2][lane] = vectors[v]->z;
+				}
+				rows.effectiveMass[lane] = row.effectiveMass;
+				rows.bias[lane] = row.bias;
+				rows.impulse[lane] = row.impulse;
+			};
+			for (int p = 0; p < c.pointCount; ++p)
+				packRow(group.rows[p], c.normals[p]);
+			packRow(group.rows[ContactSolverGroup::Tangent0], c.tangents[0]);
+			packRow(group.rows[ContactSolverGroup::Tangent1], c.tangents[1]);
+			packRow(group.rows[ContactSolverGroup::Twist], c.twist);
+		}
+	}
+}
+
+
+//=================
+// Sequential
+//=================
+
+void ContactSolver::WarmStart()
+{
+	for (const JointConstraint& joint : mJoints)
+		WarmStartJoint(joint, mLinearVelocities.data(), mAngularVelocities.data());
+	for (const ManifoldConstraint& c : mConstraints)
+	{
+		for (int p = 0; p < c.pointCount; ++p)
+			ApplyImpulse(c, c.normals[p], c.normals[p].impulse);
+	}
+}
+
+// One pass over every joint, then every manifold. Friction first, its limit uses the normal impulses from
+// the last pass, then the normals, which matter most, so they have the final say
+void ContactSolver::Iterate(bool jointBlocks)
+{
+	for (JointConstraint& joint : mJoints)
+		SolveJoint(joint, mLinearVelocities.data(), mAngularVelocities.data(), jointBlocks);
+
+	for (ManifoldConstraint& c : mConstraints)
+	{
+		auto solveRow = [&](Row& row, float low, float high)
+		{
+			const float velocity = Dot(row.linear, mLinearVelocities[c.bodyB] - mLinearVelocities[c.bodyA]) +
+			                       Dot(mAngularVelocities[c.bodyB], row.angularB) - Dot(mAngularVelocities[c.bodyA], row.angularA);
+			const float impulse = std::clamp(row.impulse + row.effectiveMass * (row.bias - velocity), low, high);
+			ApplyImpulse(c, row, impulse - row.impulse);
+			row.impulse = impulse;
+		};
+
+		float normalImpulse = 0;
+		for (int p = 0; p < c.pointCount; ++p)
+			normalImpulse += c.normals[p].impulse;
+		const float limit = c.friction * normalImpulse;
+		solveRow(c.tangents[0], -limit, limit);
+		solveRow(c.tangents[1], -limit, limit);
+		solveRow(c.twist, -limit * c.twistRadius, limit * c.twistRadius);
+
+		for (int p = 0; p < c.pointCount; ++p)
+			solveRow(c.normals[p], 0, std::numeric_limits<float>::max());
+	}
+}
+
+// Equal and opposite impulse along a row: A is pushed back, B forward
+void ContactSolver::ApplyImpulse(const ManifoldConstraint& c, const Row& row, float impulse)
+{
+	mLinearVelocities[c.bodyA] -= row.linear * (c.inverseMassA * impulse);
+	mAngularVelocities[c.bodyA] -= row.turnA * impulse;
+	mLinearVelocities[c.bodyB] += row.linear * (c.inverseMassB * impulse);
+	mAngularVelocities[c.bodyB] += row.turnB * impulse;
+}
+
+
+//=====================
+// Kernel Tables
+//=====================
+
+static const ContactSolverKernels gScalarContactSolverKernels = { WarmStartGroups<float>, IterateGroups<float> };
+
+#if defined(MATHS_SIMD_X86)
+
+static const ContactSolverKernels gSSE2ContactSolverKernels = { WarmStartGroups<Float4>, IterateGroups<Float4> };
+
+// ContactSolver_AVX2.cpp
+extern const ContactSolverKernels gAVX2ContactSolverKernels;
+
+#endif
+
+const ContactSolverKernels& GetContactSolverKernels(SIMDLevel level)
+{
+	if (level > DetectSIMDLevel())
+		level = DetectSIMDLevel();
+
+#if defined(MATHS_SIMD_X86)
+	if (level == SIMDLevel::AVX2)
+		return gAVX2ContactSolverKernels;
+	if (level == SIMDLevel::SSE2)
+		return gSSE2ContactSolverKernels;
+#endif
+	return gScalarContactSolverKernels;
+}
+
+const ContactSolverKernels& GetContactSolverKernels()
+{
+	static const ContactSolverKernels& kernels = GetContactSolverKernels(DetectSIMDLevel());
+	return kernels;
+}
@@ -0,0 +1,253 @@
+//=========================================================================================================
+// ContactSolver.h: Sequential Impulse Solver for Contacts with Friction and Restitution
+// - Runs between the velocity and position halves of integration. Each iteration visits every contact
+//   point in turn and applies the impulse that corrects the relative velocity at that point, so the
+//   corrections spread through the contact network over the iterations (Projected Gauss-Seidel)
+// - Impulses are accumulated over the iterations and the total is clamped, not each step's change:
+//   normal impulses can only push, friction is limited to friction * total normal impulse
+// - Friction acts on each manifold as a whole, at the centre of its points: two tangent directions and a
+//   twist around the normal. Separate friction at each point ties sliding and tipping together through
+//   the point's lever arm, and tall stacks then need many times more iterations to settle
+// - Penetration is pushed back towards the allowed amount over several steps by the velocity each normal
+//   aims for (Baumgarte stabilisation). This push is real velocity, so too large a fraction per step
+//   feeds energy into a tilting body and tall stacks start rocking. Points still apart (within the
+//   contact margin) let the bodies close the gap in one step but no more
+// - Points approaching faster than the restitution threshold aim to separate at restitution times the
+//   approach speed instead, if that is faster. Slower contacts don't bounce, so resting bodies stay put
+// - With warm starting the accumulated normal impulses from the contact cache (ContactCache.h) are applied
+//   before the first iteration, and the final ones are written back for the next step. Friction starts
+//   from zero each step (see ContactCache.h)
+//=========================================================================================================
+// Batching: manifolds are graph coloured so no two manifolds of a colour share a dynamic body, then each
+// colour is packed into groups of eight (ContactSolverGroup). The manifolds of a group can be solved at
+// the same time, one per SIMD lane (SSE2 four lanes, AVX2 eight, chosen at runtime as in MathsSIMD.h),
+// and the result is the same as solving them one after another. So the batched solver gives the same
+// answer as the sequential solver run over the manifolds in colour order (SolveOrder)
+//=========================================================================================================
+// Joints (Joints.h) are solved with the contacts, each joint as one block of rows. The sequential solver
+// visits the joints before the manifolds in each iteration. The batched solver colours the joints first,
+// with the same colours as the manifolds, and solves each colour's joints alongside its groups
+//=========================================================================================================
+
+#ifndef _CONTACT_SOLVER_H_DEFINED_
+#define _CONTACT_SOLVER_H_DEFINED_
+
+#include "RigidBodies.h"
+#include "ContactCache.h"
+#include "Joints.h"
+#include "MathsSIMD.h" // For SIMDLevel
+#include "AlignedAllocator.h"
+#include "JobSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ContactSolverSettings
+{
+	int iterations = 8;
+	float friction = 0.6f;
+
+	// Fraction of the approach speed kept as separating speed, 0 for no bounce, 1 for a perfect bounce
+	float restitution = 0;
+	float restitutionThreshold = 1; // m/s
+
+	// Fraction of the penetration beyond allowedPenetration removed each step
+	float baumgarte = 0.05f;
+	float allowedPenetration = 0.005f;
+
+	// Start from last step's impulses. Without it stacks need many more iterations to stay up
+	bool warmStarting = true;
+
+	// Fraction of a joint's position error removed each step. Joints hold, so can take far more than contacts
+	float jointBaumgarte = 0.2f;
+
+	// Solve each joint's locked directions together as a block (Joints.h), rather than one row at a time.
+	// Cheaper, and no worse at any iteration count on driven 50 link chains; at 8 under half the error
+	bool jointBlocks = true;
+
+	// Solve in graph coloured SIMD batches (Solve) rather than one manifold at a time in pair order
+	// (SolveSequential). Batches solve up to twice the rows per second, but the colours visit a stack's
+	// contacts alternately instead of bottom to top, so tall stacks need many more iterations to stand
+	bool batched = false;
+};
+
+
+//=====================
+// Batched Constraints
+//=====================
+
+// Eight manifolds that share no dynamic body, as Structure-of-Arrays so each can be one SIMD lane
+// Lanes without a manifold point at a spare body slot with zero masses, and missing points (manifolds
+// with fewer than four) have zero effective mass, so neither changes any velocity
+struct alignas(32) ContactSolverGroup
+{
+	static constexpr int Lanes = 8;
+
+	// Normal rows are 0 to 3, one per point, then the friction rows
+	enum RowIndex { Tangent0 = Contact::MaxPoints, Tangent1, Twist, RowCount };
+
+	// One constraint direction per lane: relative velocity = linear . (vB - vA) + angularB . wB - angularA . wA
+	struct Rows
+	{
+		float linear[3][Lanes];   // x, y and z of each lane. Zero for the twist row
+		float angularA[3][Lanes]; // rA x direction, how body A's angular velocity moves the point along it
+		float angularB[3][Lanes];
+		float turnA[3][Lanes];    // World inverse inertia * angularA, change in A's angular velocity per unit impulse
+		float turnB[3][Lanes];
+		float effectiveMass[Lanes];
+		float bias[Lanes];        // Relative velocity the row aims for
+		float impulse[Lanes];     // Accumulated
+	};
+
+	uint32_t bodyA[Lanes]; // Local body slots of the solve (see ContactSolver)
+	uint32_t bodyB[Lanes];
+	float inverseMassA[Lanes];
+	float inverseMassB[Lanes];
+	float friction[Lanes];
+	float twistRadius[Lanes]; // Average distance of the points from their centre, scales the twist limit
+	Rows rows[RowCount];
+};
+
+// Function table of batched solver kernels for one instruction set. Velocities are indexed by the group
+// body indices
+struct ContactSolverKernels
+{
+	void (*warmStart)(const ContactSolverGroup* groups, std::size_t count, Vector3f* linearVelocities, Vector3f* angularVelocities);
+	void (*iterate)(ContactSolverGroup* groups, std::size_t count, Vector3f* linearVelocities, Vector3f* angularVelocities);
+};
+
+// Kernel table for a specific level - used to compare kernels against each other
+// Asking for an unsupported level returns the best supported level below it
+const ContactSolverKernels& GetContactSolverKernels(SIMDLevel level);
+
+// Kernel table for the best level on this CPU
+const ContactSolverKernels& GetContactSolverKernels();
+
+
+//=====================
+// Solver
+//=====================
+
+class ContactSolver
+{
+public:
+	// Correct the bodies' velocities for the contacts in the manifolds, whose body ids are body handle
+	// slots. Manifolds must have at least one dynamic body. Their normal impulses are the starting point
+	// when warm starting, and are replaced by the final impulses
+	// Batched: coloured, packed into groups and solved with the given kernels (the best by default)
+	void Solve(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const ContactSolverSettings& settings, float timeStep,
+	           const ContactSolverKernels& kernels = GetContactSolverKernels());
+
+	// One manifold at a time in the order given. Also the reference for validating the batched solver
+	void SolveSequential(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const ContactSolverSettings& settings, float timeStep);
+
+	// Only the manifolds with the given indices, e.g. one island (Islands.h). Only the velocities of their
+	// dynamic bodies are read and written, so solvers on other threads can work on other manifolds at the
+	// same time provided no dynamic body is in both
+	// threadCount: threads to split each colour's groups over, for large islands. Small solves use one
+	// The threads are jobs if the solver has a job system, otherwise they are started for the solve
+	void Solve(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, std::size_t count,
+	           const ContactSolverSettings& settings, float timeStep, unsigned int threadCount = 1,
+	           const ContactSolverKernels& kernels = GetContactSolverKernels());
+	void SolveSequential(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, std::size_t count,
+	                     const ContactSolverSettings& settings, float timeStep);
+
+	// The same with joints: also the joints[jointIndices[k]] for k < jointCount, whose bodies are handle slots
+	// as for the manifolds. Their accumulated impulses are kept in them for the next step
+	void Solve(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, std::size_t count,
+	           Joint* joints, const uint32_t* jointIndices, std::size_t jointCount, const ContactSolverSettings& settings, float timeStep,
+	           unsigned int threadCount = 1, const ContactSolverKernels& kernels = GetContactSolverKernels());
+	void SolveSequential(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, std::size_t count,
+	                     Joint* joints, const uint32_t* jointIndices, std::size_t jointCount, const ContactSolverSettings& settings, float timeStep);
+
+	// Split batched solves between jobs on this system rather than threads of their own. Null to go back
+	void SetJobSystem(JobSystem* jobs) { mJobs = jobs; }
+
+	//=================
+	// Last Solve
+	//=================
+
+	// Positions in the list of manifolds solved (manifoldIndices if given) in the order the last batched
+	// Solve visited them, colour by colour
+	const std::vector<uint32_t>& SolveOrder() const { return mSolveOrder; }
+
+	std::size_t ColourCount() const { return mColourGroups.empty() ? 0 : mColourGroups.size() - 1; }
+	std::size_t GroupCount() const { return mGroups.size(); }
+	const AlignedVector<ContactSolverGroup>& Groups() const { return mGroups; }
+
+	// Constraint rows solved by one iteration: a normal per point and three friction rows per manifold, and
+	// every row of the joints
+	std::size_t RowCount() const { return mRowCount; }
+
+private:
+	// One constraint direction of a single manifold, as ContactSolverGroup::Rows for one lane
+	struct Row
+	{
+		Vector3f linear;
+		Vector3f angularA;
+		Vector3f angularB;
+		Vector3f turnA;
+		Vector3f turnB;
+		float effectiveMass;
+		float bias;
+		float impulse;
+	};
+
+	struct ManifoldConstraint
+	{
+		uint32_t bodyA; // Local body slots
+		uint32_t bodyB;
+		float inverseMassA;
+		float inverseMassB;
+		float friction;
+		float twistRadius; // Average distance of the points from their centre, scales the twist limit
+		int pointCount;
+		Row normals[Contact::MaxPoints];
+		Row tangents[2];
+		Row twist;
+	};
+
+	const uint32_t* AllManifolds(std::size_t count);
+	uint32_t LocalBody(const RigidBodies& bodies, std::size_t index);
+	void ScatterVelocities(RigidBodies& bodies);
+	void StoreImpulses(std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, Joint* joints) const;
+
+	void Prepare(const RigidBodies& bodies, const std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices, std::size_t count,
+	             const Joint* joints, const uint32_t* jointIndices, std::size_t jointCount, const ContactSolverSettings& settings, float timeStep);
+	void Colour();
+	void Pack(uint32_t spareBody);
+
+	void WarmStart();
+	void Iterate(bool jointBlocks);
+	void ApplyImpulse(const ManifoldConstraint& c, const Row& row, float impulse);
+
+private:
+	JobSystem* mJobs = nullptr;
+
+	std::vector<ManifoldConstraint> mConstraints; // One per manifold solved, bodies are local slots
+	std::vector<JointConstraint> mJoints;         // One per joint solved
+	std::size_t mRowCount = 0;
+	std::vector<uint32_t> mAllManifolds;
+
+	// Batching
+	std::vector<uint32_t> mSolveOrder;
+	std::vector<uint32_t> mGroupStarts; // Index into mSolveOrder of each group's first manifold, plus the end
+	std::vector<uint32_t> mColourGroups; // Index of each colour's first group, plus the end
+	std::vector<uint32_t> mJointOrder;   // Joints in colour order
+	std::vector<uint32_t> mColourJoints; // Index into mJointOrder of each colour's first joint, plus the end
+	std::vector<uint64_t> mBodyColours; // Bit per colour used by each local body's manifolds so far
+	std::vector<uint8_t> mManifoldColours;
+	std::vector<uint8_t> mJointColours;
+	AlignedVector<ContactSolverGroup> mGroups;
+
+	// Local slots: the bodies of the manifolds solved, in the order first seen, then a spare slot at rest
+	// for the empty lanes of groups. Velocities are gathered from the body arrays into them
+	static constexpr uint32_t NoLocalBody = ~0u;
+	std::vector<uint32_t> mLocalBodies; // Local slot of each body array index, NoLocalBody between solves
+	std::vector<uint32_t> mBodyIndices; // Body array index of each local slot
+	std::vector<Vector3f> mLinearVelocities;
+	std::vector<Vector3f> mAngularVelocities;
+};
+
+#endif // !_CONTACT_SOLVER_H_DEFINED_
@@ -0,0 +1,161 @@
+//=========================================================================================================
+// ContactSolverLanes.h: The Batched Solver Kernels Written Once for Any Lane Type (internal to the solver)
+// - Templates on the lane type F as ContactLanes.h: float solves a group one lane at a time
+//   (ContactSolver.cpp), Float4 half a group at a time (ContactSolver.cpp), Float8 a whole group at a
+//   time (ContactSolver_AVX2.cpp)
+// - Each set of lanes gathers its bodies' velocities once, solves all the rows of its manifolds in
+//   registers, in the same order as ContactSolver::Iterate, then scatters the velocities back
+//=========================================================================================================
+// Header-only: Templates, defined here so each kernel file can instantiate them for its own lane type
+//=========================================================================================================
+
+#ifndef _CONTACT_SOLVER_LANES_H_DEFINED_
+#define _CONTACT_SOLVER_LANES_H_DEFINED_
+
+#include "ContactSolver.h"
+#include "ContactLanes.h"
+
+#include <cfloat>
+
+//=====================
+// Body Velocities
+//=====================
+
+template<typename F> Vector3N<F> GatherLanes(const Vector3f* values, const uint32_t* indices)
+{
+	alignas(32) float x[LaneWidth<F>], y[LaneWidth<F>], z[LaneWidth<F>];
+	for (int i = 0; i < LaneWidth<F>; ++i)
+	{
+		const Vector3f& value = values[indices[i]];
+		x[i] = value.x;
+		y[i] = value.y;
+		z[i] = value.z;
+	}
+	return { LoadLanes<F>(x), LoadLanes<F>(y), LoadLanes<F>(z) };
+}
+
+// Lanes never share a dynamic body. Shared static bodies and the spare body are written back unchanged
+template<typename F> void ScatterLanes(const Vector3N<F>& lanes, Vector3f* values, const uint32_t* indices)
+{
+	alignas(32) float x[LaneWidth<F>], y[LaneWidth<F>], z[LaneWidth<F>];
+	StoreLanes(lanes.x, x);
+	StoreLanes(lanes.y, y);
+	StoreLanes(lanes.z, z);
+	for (int i = 0; i < LaneWidth<F>; ++i)
+		values[indices[i]] = { x[i], y[i], z[i] };
+}
+
+template<typename F> struct BodyPairLanes
+{
+	Vector3N<F> linearA, angularA;
+	Vector3N<F> linearB, angularB;
+	F inverseMassA, inverseMassB;
+};
+
+template<typename F> BodyPairLanes<F> GatherBodies(const ContactSolverGroup& group, int lane, const Vector3f* linearVelocities, const Vector3f* angularVelocities)
+{
+	BodyPairLanes<F> bodies;
+	bodies.linearA = GatherLanes<F>(linearVelocities, group.bodyA + lane);
+	bodies.angularA = GatherLanes<F>(angularVelocities, group.bodyA + lane);
+	bodies.linearB = GatherLanes<F>(linearVelocities, group.bodyB + lane);
+	bodies.angularB = GatherLanes<F>(angularVelocities, group.bodyB + lane);
+	bodies.inverseMassA = LoadLanes<F>(group.inverseMassA + lane);
+	bodies.inverseMassB = LoadLanes<F>(group.inverseMassB + lane);
+	return bodies;
+}
+
+template<typename F> void ScatterBodies(const ContactSolverGroup& group, int lane, const BodyPairLanes<F>& bodies, Vector3f* linearVelocities, Vector3f* angularVelocities)
+{
+	ScatterLanes(bodies.linearA, linearVelocities, group.bodyA + lane);
+	ScatterLanes(bodies.angularA, angularVelocities, group.bodyA + lane);
+	ScatterLanes(bodies.linearB, linearVelocities, group.bodyB + lane);
+	ScatterLanes(bodies.angularB, angularVelocities, group.bodyB + lane);
+}
+
+
+//=====================
+// Rows
+//=====================
+
+template<typename F> Vector3N<F> LoadRowVector(const float (&values)[3][ContactSolverGroup::Lanes], int lane)
+{
+	return { LoadLanes<F>(values[0] + lane), LoadLanes<F>(values[1] + lane), LoadLanes<F>(values[2] + lane) };
+}
+
+// Equal and opposite impulse along a row: A is pushed back, B forward
+template<typename F> void ApplyRowImpulse(const ContactSolverGroup::Rows& row, int lane, const F& impulse, BodyPairLanes<F>& bodies)
+{
+	const Vector3N<F> linear = LoadRowVector<F>(row.linear, lane);
+	bodies.linearA = bodies.linearA - linear * (bodies.inverseMassA * impulse);
+	bodies.angularA = bodies.angularA - LoadRowVector<F>(row.turnA, lane) * impulse;
+	bodies.linearB = bodies.linearB + linear * (bodies.inverseMassB * impulse);
+	bodies.angularB = bodies.angularB + LoadRowVector<F>(row.turnB, lane) * impulse;
+}
+
+// Move the row's accumulated impulse towards meeting its target velocity, within its limits
+template<typename F> void SolveRowLanes(ContactSolverGroup::Rows& row, int lane, const F& low, const F& high, BodyPairLanes<F>& bodies)
+{
+	const Vector3N<F> linear = LoadRowVector<F>(row.linear, lane);
+	const F velocity = Dot(linear, bodies.linearB - bodies.linearA) +
+	                   Dot(bodies.angularB, LoadRowVector<F>(row.angularB, lane)) - Dot(bodies.angularA, LoadRowVector<F>(row.angularA, lane));
+
+	const F oldImpulse = LoadLanes<F>(row.impulse + lane);
+	const F impulse = Clamp(oldImpulse + LoadLanes<F>(row.effectiveMass + lane) * (LoadLanes<F>(row.bias + lane) - velocity), low, high);
+	StoreLanes(impulse, row.impulse + lane);
+
+	const F change = impulse - oldImpulse;
+	bodies.linearA = bodies.linearA - linear * (bodies.inverseMassA * change);
+	bodies.angularA = bodies.angularA - LoadRowVector<F>(row.turnA, lane) * change;
+	bodies.linearB = bodies.linearB + linear * (bodies.inverseMassB * change);
+	bodies.angularB = bodies.angularB + LoadRowVector<F>(row.turnB, lane) * change;
+}
+
+
+//=====================
+// Kernels
+//=====================
+
+template<typename F> void WarmStartGroups(const ContactSolverGroup* groups, std::size_t count, Vector3f* linearVelocities, Vector3f* angularVelocities)
+{
+	for (std::size_t g = 0; g < count; ++g)
+	{
+		const ContactSolverGroup& group = groups[g];
+		for (int lane = 0; lane < ContactSolverGroup::Lanes; lane += LaneWidth<F>)
+		{
+			BodyPairLanes<F> bodies = GatherBodies<F>(group, lane, linearVelocities, angularVelocities);
+			for (int p = 0; p < Contact::MaxPoints; ++p)
+				ApplyRowImpulse(group.rows[p], lane, LoadLanes<F>(group.rows[p].impulse + lane), bodies);
+			ScatterBodies(group, lane, bodies, linearVelocities, angularVelocities);
+		}
+	}
+}
+
+// One pass over every group, friction first then the normals, as ContactSolver::Iterate
+template<typename F> void IterateGroups(ContactSolverGroup* groups, std::size_t count, Vector3f* linearVelocities, Vector3f* angularVelocities)
+{
+	const F zero(0.0f), maxImpulse(FLT_MAX);
+	for (std::size_t g = 0; g < count; ++g)
+	{
+		ContactSolverGroup& group = groups[g];
+		for (int lane = 0; lane < ContactSolverGroup::Lanes; lane += LaneWidth<F>)
+		{
+			BodyPairLanes<F> bodies = GatherBodies<F>(group, lane, linearVelocities, angularVelocities);
+
+			F normalImpulse = zero;
+			for (int p = 0; p < Contact::MaxPoints; ++p)
+				normalImpulse = normalImpulse + LoadLanes<F>(group.rows[p].impulse + lane);
+			const F limit = LoadLanes<F>(group.friction + lane) * normalImpulse;
+			const F twistLimit = limit * LoadLanes<F>(group.twistRadius + lane);
+			SolveRowLanes(group.rows[ContactSolverGroup::Tangent0], lane, -limit, limit, bodies);
+			SolveRowLanes(group.rows[ContactSolverGroup::Tangent1], lane, -limit, limit, bodies);
+			SolveRowLanes(group.rows[ContactSolverGroup::Twist], lane, -twistLimit, twistLimit, bodies);
+
+			for (int p = 0; p < Contact::MaxPoints; ++p)
+				SolveRowLanes(group.rows[p], lane, zero, maxImpulse, bodies);
+
+			ScatterBodies(group, lane, bodies, linearVelocities, angularVelocities);
+		}
+	}
+}
+
+#endif // !_CONTACT_SOLVER_LANES_H_DEFINED_
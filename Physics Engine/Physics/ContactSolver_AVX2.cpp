@@ -0,0 +1,21 @@
+//=========================================================================================================
+// ContactSolver_AVX2.cpp: Batched Solver Kernels Eight Manifolds at a Time
+// - Only called after DetectSIMDLevel() has confirmed AVX2 and FMA are available
+// - Built with AVX2 code generation for this file only, as MathsSIMD_AVX2.cpp
+//=========================================================================================================
+
+#include "ContactSolver.h"
+
+#if defined(MATHS_SIMD_X86)
+
+#if !defined(_MSC_VER)
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "ContactSolverLanes.h"
+#include "SIMDFloat8.h"
+
+extern const ContactSolverKernels gAVX2ContactSolverKernels;
+const ContactSolverKernels gAVX2ContactSolverKernels = { WarmStartGroups<Float8>, IterateGroups<Float8> };
+
+#endif // MATHS_SIMD_X86
@@ -0,0 +1,250 @@
+//=========================================================================================================
+// Fluid.cpp: Fluid Set Up, Sorting into the Grid's Order, Stepping and Kernel Dispatch
+//=========================================================================================================
+
+#include "Fluid.h"
+#include "FluidLanes.h"
+#include "SIMDFloat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+#include <utility>
+
+namespace
+{
+	// Smallest pieces the particle passes are split into for the jobs
+	const std::size_t ParticlesPerJob = 1024;
+
+	// Arrays are a multiple of this, the widest lane type
+	const std::size_t Lanes = 8;
+
+	std::size_t PaddedCount(std::size_t count)
+	{
+		return (count + Lanes - 1) / Lanes * Lanes;
+	}
+}
+
+
+//=================
+// Building
+//=================
+
+std::vector<Vector3f> FluidBlock(const Vector3f& corner, int columns, int layers, int rows, float spacing)
+{
+	std::vector<Vector3f> positions;
+	positions.reserve(static_cast<std::size_t>(columns) * layers * rows);
+	for (int row = 0; row < rows; ++row)
+	{
+		for (int layer = 0; layer < layers; ++layer)
+		{
+			for (int column = 0; column < columns; ++column)
+				positions.push_back(corner + Vector3f(column * spacing, layer * spacing, row * spacing));
+		}
+	}
+	return positions;
+}
+
+// The kernel constants come from a particle in the middle of a cubic lattice spacing apart: its density
+// sum sets the mass so it is at the rest density, and its gradient sum scales the relaxation and repulsion
+Fluid::Fluid(const FluidDesc& desc)
+	: mGrid(2 * desc.spacing, 1), mIterations(std::max(desc.iterations, 1)), mRadius(2 * desc.spacing), mRestDensity(desc.restDensity),
+	  mViscosity(desc.viscosity), mGravity(desc.gravity)
+{
+	mCount = desc.positions.size();
+
+	// Runs of neighbours can be loaded up to a lane type past their end, so eight more than a whole eight
+	const std::size_t padded = PaddedCount(mCount) + Lanes;
+	mPositions.Resize(padded);
+	mPredicted.Resize(padded);
+	mVelocities.Resize(padded);
+	mDeltas.Resize(padded);
+	mLambdas.assign(padded, 0);
+	mDensities.assign(padded, 0);
+	mIds.resize(mCount);
+	mSortedIds.resize(mCount);
+	std::iota(mIds.begin(), mIds.end(), 0u);
+	for (std::size_t i = 0; i < mCount; ++i)
+		mPositions.Set(i, desc.positions[i]);
+	mPredicted = mPositions;
+
+	const Vector3f inset = { desc.spacing / 2, desc.spacing / 2, desc.spacing / 2 };
+	mLower = desc.boundsMin + inset;
+	mUpper = desc.boundsMax - inset;
+
+	const double h = mRadius;
+	const double hSq = h * h;
+	const int reach = static_cast<int>(std::ceil(h / desc.spacing));
+	double densitySum = 0;
+	double gradientSum = 0;
+	for (int a = -reach; a <= reach; ++a)
+	{
+		for (int b = -reach; b <= reach; ++b)
+		{
+			for (int c = -reach; c <= reach; ++c)
+			{
+				const double distanceSq = (a * a + b * b + c * c) * static_cast<double>(desc.spacing) * desc.spacing;
+				if (distanceSq >= hSq)
+					continue;
+				const double w = hSq - distanceSq;
+				densitySum += w * w * w;
+				if (distanceSq > 0)
+					gradientSum += std::pow(h - std::sqrt(distanceSq), 4);
+			}
+		}
+	}
+
+	// poly6 = 315 / (64 pi h^9) (h^2 - r^2)^3, spiky gradient = -45 / (pi h^6) (h - r)^2 along the offset
+	const double pi = std::numbers::pi;
+	const double poly6 = 315 / (64 * pi * std::pow(h, 9));
+	const double spiky = 45 / (pi * std::pow(h, 6));
+	mParticleMass = static_cast<float>(mRestDensity / (poly6 * densitySum));
+	mDensityScale = static_cast<float>(1 / densitySum);
+	mGradientScale = static_cast<float>(spiky / (poly6 * densitySum));
+
+	const double restGradientSq = gradientSum * mGradientScale * mGradientScale;
+	mRelaxation = static_cast<float>(desc.relaxation * restGradientSq);
+	mTensileScale = static_cast<float>(desc.tensileCorrection / restGradientSq);
+	const double tensileW = hSq - 0.04 * hSq;
+	mTensileSum = static_cast<float>(tensileW * tensileW * tensileW);
+}
+
+void Fluid::SetJobSystem(JobSystem* jobs)
+{
+	mJobs = jobs;
+	mGrid.SetThreadCount(jobs ? jobs->ThreadCount() : 1);
+	mGrid.SetJobSystem(jobs);
+}
+
+
+//=================
+// Stepping
+//=================
+
+FluidParticles Fluid::Particles(float timeStep)
+{
+	return
+	{
+		mPositions.X(), mPositions.Y(), mPositions.Z(),
+		mPredicted.X(), mPredicted.Y(), mPredicted.Z(),
+		mVelocities.X(), mVelocities.Y(), mVelocities.Z(),
+		mDeltas.X(), mDeltas.Y(), mDeltas.Z(),
+		mLambdas.data(), mDensities.data(), mCount, &mGrid,
+		timeStep, mGravity, mLower, mUpper,
+		mRadius, mDensityScale, mGradientScale, mRelaxation, mTensileScale, mTensileSum, mRestDensity, mViscosity
+	};
+}
+
+template<typename F> void Fluid::ForParticles(F&& function)
+{
+	const std::size_t padded = PaddedCount(mCount);
+	if (!mJobs || padded <= ParticlesPerJob)
+	{
+		function(std::size_t(0), padded);
+		return;
+	}
+	mJobs->ParallelFor(padded / Lanes, ParticlesPerJob / Lanes, [&](std::size_t begin, std::size_t end)
+	{
+		function(begin * Lanes, end * Lanes);
+	});
+}
+
+// Grid on the predicted positions, then each array copied into the grid's order through the deltas
+void Fluid::Sort()
+{
+	mGridPositions.resize(mCount);
+	ForParticles([&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < std::min(end, mCount); ++i)
+			mGridPositions[i] = mPredicted.Get(i);
+	});
+	mGrid.Build(mGridPositions);
+
+	const std::vector<uint32_t>& order = mGrid.SortedParticles();
+	auto gather = [&](Vector3SoA& values)
+	{
+		ForParticles([&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t k = begin; k < std::min(end, mCount); ++k)
+				mDeltas.Set(k, values.Get(order[k]));
+		});
+		std::swap(values, mDeltas);
+	};
+	gather(mPositions);
+	gather(mPredicted);
+	gather(mVelocities);
+
+	ForParticles([&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t k = begin; k < std::min(end, mCount); ++k)
+			mSortedIds[k] = mIds[order[k]];
+	});
+	std::swap(mIds, mSortedIds);
+}
+
+// Predict and sort, the density iterations, then velocities and viscosity. Each pass finishes before
+// the next reads what it wrote
+void Fluid::Step(float timeStep, const FluidKernels& kernels)
+{
+	if (mCount == 0)
+		return;
+
+	ForParticles([&, particles = Particles(timeStep)](std::size_t begin, std::size_t end) { kernels.predict(particles, begin, end); });
+	Sort();
+
+	// Sorting swapped the arrays
+	const FluidParticles particles = Particles(timeStep);
+	for (int iteration = 0; iteration < mIterations; ++iteration)
+	{
+		ForParticles([&](std::size_t begin, std::size_t end) { kernels.lambdas(particles, begin, end); });
+		ForParticles([&](std::size_t begin, std::size_t end) { kernels.deltas(particles, begin, end); });
+		ForParticles([&](std::size_t begin, std::size_t end) { kernels.apply(particles, begin, end); });
+	}
+
+	ForParticles([&](std::size_t begin, std::size_t end) { kernels.velocities(particles, begin, end); });
+	ForParticles([&](std::size_t begin, std::size_t end) { kernels.viscosity(particles, begin, end); });
+	std::swap(mVelocities, mDeltas);
+}
+
+
+//=====================
+// Kernel Tables
+//=====================
+
+static const FluidKernels gScalarFluidKernels =
+{
+	PredictFluid<float>, FluidLambdas<float>, FluidDeltas<float>, ApplyFluidDeltas<float>, FluidVelocities<float>, FluidViscosity<float>
+};
+
+#if defined(MATHS_SIMD_X86)
+
+static const FluidKernels gSSE2FluidKernels =
+{
+	PredictFluid<Float4>, FluidLambdas<Float4>, FluidDeltas<Float4>, ApplyFluidDeltas<Float4>, FluidVelocities<Float4>, FluidViscosity<Float4>
+};
+
+// Fluid_AVX2.cpp
+extern const FluidKernels gAVX2FluidKernels;
+
+#endif
+
+const FluidKernels& GetFluidKernels(SIMDLevel level)
+{
+	if (level > DetectSIMDLevel())
+		level = DetectSIMDLevel();
+
+#if defined(MATHS_SIMD_X86)
+	if (level == SIMDLevel::AVX2)
+		return gAVX2FluidKernels;
+	if (level == SIMDLevel::SSE2)
+		return gSSE2FluidKernels;
+#endif
+	return gScalarFluidKernels;
+}
+
+const FluidKernels& GetFluidKernels()
+{
+	static const FluidKernels& kernels = GetFluidKernels(DetectSIMDLevel());
+	return kernels;
+}
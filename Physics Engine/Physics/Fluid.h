@@ -0,0 +1,200 @@
+//=========================================================================================================
+// Fluid.h: Liquid as Particles Kept at Their Rest Density (Position Based Fluids)
+// - Each step particles are moved by gravity to predicted positions, then a few iterations each work out
+//   every particle's density from its neighbours (SPH kernels), and move the particles so the densities
+//   come back to the rest density. Velocities are how far the particles moved (Macklin & Mueller 2013)
+// - Density is only pushed down, never pulled up, so the surface doesn't clump. A small repulsion between
+//   close particles (the "artificial pressure" term) keeps them from bunching at the surface too
+// - XSPH viscosity blends each particle's velocity towards its neighbours'
+// - The particles are kept inside a box. Nothing else collides with them, and they push back on nothing
+//=========================================================================================================
+// Layout: positions, predicted positions and velocities are Structure-of-Arrays (Vector3SoA). Neighbours
+// are found with a SpatialHashGrid of cells the kernel radius across, rebuilt each step by its counting
+// sort, and the particles are then copied into the grid's order. So the particles around any cell are 9
+// runs of the arrays, read LaneWidth at a time: each particle's sums over its neighbours are SIMD over the
+// neighbours. Passes over the particles are split between jobs. Each pass only writes its own particles,
+// reading others from the pass before (Jacobi), so the results don't depend on the threads, and on the
+// kernels only by rounding. Kernels are chosen at runtime as in MathsSIMD.h
+//=========================================================================================================
+
+#ifndef _FLUID_H_DEFINED_
+#define _FLUID_H_DEFINED_
+
+#include "Vector3.h"
+#include "Vector3SoA.h"
+#include "MathsSIMD.h" // For SIMDLevel
+#include "AlignedAllocator.h"
+#include "JobSystem.h"
+#include "SpatialHashGrid.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//=====================
+// Description
+//=====================
+
+struct FluidDesc
+{
+	std::vector<Vector3f> positions;
+
+	// Distance between particles at rest. Sets the kernel radius (twice it), and the particle mass so
+	// particles this far apart in a cubic lattice are at the rest density
+	float spacing = 0.02f;
+	float restDensity = 1000; // kg/m^3
+
+	int iterations = 3;
+	float viscosity = 0.01f; // XSPH, fraction of the difference from the neighbours' velocities taken per step
+
+	// Added to every particle's constraint, as a fraction of a particle at rest's, so particles with few
+	// neighbours (at the surface) aren't moved too far
+	float relaxation = 0.1f;
+
+	// Repulsion between particles closer than a fifth of the kernel radius, as a fraction of a rest particle's
+	float tensileCorrection = 0.01f;
+
+	// Box the particles stay inside, their centres half a spacing in from its sides
+	Vector3f boundsMin = { -1, 0, -1 };
+	Vector3f boundsMax = { 1, 2, 1 };
+
+	Vector3f gravity = { 0, -9.81f, 0 };
+};
+
+// columns * layers * rows particles spacing apart from corner (x along columns, y along layers, z along rows)
+std::vector<Vector3f> FluidBlock(const Vector3f& corner, int columns, int layers, int rows, float spacing);
+
+
+//=====================
+// Kernels
+//=====================
+
+// The particle arrays and step constants the kernels work on. Particles from begin to end, begin a
+// multiple of eight, the arrays padded so eight can always be loaded from any particle
+struct FluidParticles
+{
+	float* x; float* y; float* z;                         // Positions at the start of the step
+	float* predictedX; float* predictedY; float* predictedZ;
+	float* velocityX; float* velocityY; float* velocityZ;
+	float* deltaX; float* deltaY; float* deltaZ;          // Each iteration's moves, then the new velocities
+	float* lambdas;                                       // Each iteration's constraint multipliers
+	float* densities;
+	std::size_t count;
+	const SpatialHashGrid* grid;                          // Built on the predicted positions, in its order
+
+	float timeStep;
+	Vector3f gravity;
+	Vector3f lower; // Inside of the box, for the particle centres
+	Vector3f upper;
+
+	float radius;           // Kernel radius h
+	float densityScale;     // Density / rest density per sum of (h^2 - r^2)^3 (poly6, with the mass)
+	float gradientScale;    // Gradient of the density constraint per (h - r)^2 / r * offset (spiky, with the mass)
+	float relaxation;       // Added to the constraint's denominator
+	float tensileScale;     // Artificial pressure, times ((h^2 - r^2)^3 / tensileSum)^4
+	float tensileSum;       // (h^2 - r^2)^3 a fifth of h apart
+	float restDensity;
+	float viscosity;
+};
+
+// Function table of fluid kernels for one instruction set
+struct FluidKernels
+{
+	// Velocities on by gravity, predicted positions on from the positions, kept in the box
+	void (*predict)(const FluidParticles& particles, std::size_t begin, std::size_t end);
+
+	// Densities from the predicted positions, then each particle's constraint multiplier
+	void (*lambdas)(const FluidParticles& particles, std::size_t begin, std::size_t end);
+
+	// How far each particle moves from its and its neighbours' multipliers, into the deltas
+	void (*deltas)(const FluidParticles& particles, std::size_t begin, std::size_t end);
+
+	// Predicted positions on by the deltas, kept in the box
+	void (*apply)(const FluidParticles& particles, std::size_t begin, std::size_t end);
+
+	// Velocities from how far the particles moved, and the positions to the predicted positions
+	void (*velocities)(const FluidParticles& particles, std::size_t begin, std::size_t end);
+
+	// Velocities blended towards the neighbours', into the deltas
+	void (*viscosity)(const FluidParticles& particles, std::size_t begin, std::size_t end);
+};
+
+// Kernel table for a specific level - used to compare kernels against each other
+// Asking for an unsupported level returns the best supported level below it
+const FluidKernels& GetFluidKernels(SIMDLevel level);
+
+// Kernel table for the best level on this CPU
+const FluidKernels& GetFluidKernels();
+
+
+//=====================
+// Fluid
+//=====================
+
+class Fluid
+{
+public:
+	// Works out the particle mass and kernel constants from the spacing. At most 16 million particles
+	explicit Fluid(const FluidDesc& desc);
+
+	// Move the particles on by timeStep. Particles shouldn't move more than about a third of the kernel
+	// radius a step, so for fast flows this wants to be small (e.g. 1/240s for a one metre deep dam break)
+	void Step(float timeStep, const FluidKernels& kernels = GetFluidKernels());
+
+	// Split the passes over the particles between jobs on this system. Null to go back to the calling thread only
+	void SetJobSystem(JobSystem* jobs);
+
+	//=================
+	// Particles
+	//=================
+	// Particles are reordered each step to follow the grid. Id is the particle's index in the description
+
+	std::size_t ParticleCount() const { return mCount; }
+	uint32_t Id(std::size_t i) const { return mIds[i]; }
+	Vector3f Position(std::size_t i) const { return mPositions.Get(i); }
+	Vector3f Velocity(std::size_t i) const { return mVelocities.Get(i); }
+	float Density(std::size_t i) const { return mDensities[i]; } // From the last iteration of the last step
+
+	float ParticleMass() const { return mParticleMass; }
+	float KernelRadius() const { return mRadius; }
+
+	// Grid from the last step, in the same order as the particles
+	const SpatialHashGrid& Grid() const { return mGrid; }
+
+private:
+	FluidParticles Particles(float timeStep);
+	void Sort();
+
+	template<typename F> void ForParticles(F&& function);
+
+private:
+	JobSystem* mJobs = nullptr;
+
+	std::size_t mCount = 0;
+	Vector3SoA mPositions;
+	Vector3SoA mPredicted;
+	Vector3SoA mVelocities;
+	Vector3SoA mDeltas;
+	AlignedVector<float> mLambdas;
+	AlignedVector<float> mDensities;
+	std::vector<uint32_t> mIds;
+	std::vector<uint32_t> mSortedIds;
+	std::vector<Vector3f> mGridPositions;
+	SpatialHashGrid mGrid;
+
+	int mIterations;
+	float mRadius;
+	float mParticleMass;
+	float mRestDensity;
+	float mViscosity;
+	float mDensityScale;
+	float mGradientScale;
+	float mRelaxation;
+	float mTensileScale;
+	float mTensileSum;
+	Vector3f mLower;
+	Vector3f mUpper;
+	Vector3f mGravity;
+};
+
+#endif // !_FLUID_H_DEFINED_
@@ -0,0 +1,256 @@
+//=========================================================================================================
+// FluidLanes.h: The Fluid Kernels Written Once for Any Lane Type (internal to the fluid)
+// - Templates on the lane type F as ContactLanes.h: float one particle at a time (Fluid.cpp), Float4
+//   four at a time (Fluid.cpp), Float8 eight at a time (Fluid_AVX2.cpp)
+// - The per particle kernels load straight from the Structure-of-Arrays. The neighbour kernels take one
+//   particle at a time and its neighbours a lane each, from the grid's runs of the arrays, then add the
+//   lanes together at the end
+//=========================================================================================================
+// Header-only: Templates, defined here so each kernel file can instantiate them for its own lane type
+//=========================================================================================================
+
+#ifndef _FLUID_LANES_H_DEFINED_
+#define _FLUID_LANES_H_DEFINED_
+
+#include "Fluid.h"
+#include "ContactLanes.h"
+
+//=====================
+// Lane Helpers
+//=====================
+
+// Runs of neighbours start anywhere
+template<typename F> F LoadLanesUnaligned(const float* p) { return F::LoadUnaligned(p); }
+template<> inline float LoadLanesUnaligned<float>(const float* p) { return *p; }
+
+inline float HorizontalSum(float a) { return a; }
+
+template<typename F> Vector3N<F> LoadFluid(const float* x, const float* y, const float* z, std::size_t i)
+{
+	return { LoadLanes<F>(x + i), LoadLanes<F>(y + i), LoadLanes<F>(z + i) };
+}
+
+template<typename F> Vector3N<F> LoadFluidUnaligned(const float* x, const float* y, const float* z, std::size_t i)
+{
+	return { LoadLanesUnaligned<F>(x + i), LoadLanesUnaligned<F>(y + i), LoadLanesUnaligned<F>(z + i) };
+}
+
+template<typename F> void StoreFluid(const Vector3N<F>& lanes, float* x, float* y, float* z, std::size_t i)
+{
+	StoreLanes(lanes.x, x + i);
+	StoreLanes(lanes.y, y + i);
+	StoreLanes(lanes.z, z + i);
+}
+
+template<typename F> Vector3N<F> BroadcastFluid(const Vector3f& v)
+{
+	return { F(v.x), F(v.y), F(v.z) };
+}
+
+template<typename F> Vector3f SumLanes(const Vector3N<F>& v)
+{
+	return { HorizontalSum(v.x), HorizontalSum(v.y), HorizontalSum(v.z) };
+}
+
+template<typename F> Vector3N<F> ClampToBox(const Vector3N<F>& p, const FluidParticles& particles)
+{
+	return { Clamp(p.x, F(particles.lower.x), F(particles.upper.x)),
+	         Clamp(p.y, F(particles.lower.y), F(particles.upper.y)),
+	         Clamp(p.z, F(particles.lower.z), F(particles.upper.z)) };
+}
+
+
+//=====================
+// Neighbours
+//=====================
+
+// Neighbour ranges of the last cell asked for. The particles are in the grid's order, so the one before is
+// often in the same cell with the same neighbours
+struct FluidNeighbours
+{
+	SpatialHashGrid::ParticleRange ranges[SpatialHashGrid::MaxNeighbourRanges];
+	int rangeCount = 0;
+	Vector3i cell = { 0, 0, 0 };
+	bool haveCell = false;
+};
+
+// Call function(j, inRange) for the particles around predicted position p, LaneWidth at a time from j.
+// Lanes past the end of a run belong to other cells and are masked off
+template<typename F, typename Function> void ForNeighbourLanes(const FluidParticles& particles, const Vector3f& p, FluidNeighbours& neighbours,
+                                                               Function&& function)
+{
+	alignas(32) static const float offsets[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+	const F laneOffsets = LoadLanes<F>(offsets);
+
+	const Vector3i cell = particles.grid->Cell(p);
+	if (!neighbours.haveCell || cell.x != neighbours.cell.x || cell.y != neighbours.cell.y || cell.z != neighbours.cell.z)
+	{
+		neighbours.rangeCount = particles.grid->NeighbourRanges(cell, neighbours.ranges);
+		neighbours.cell = cell;
+		neighbours.haveCell = true;
+	}
+
+	for (int r = 0; r < neighbours.rangeCount; ++r)
+	{
+		const std::size_t end = neighbours.ranges[r].end;
+		for (std::size_t j = neighbours.ranges[r].begin; j < end; j += LaneWidth<F>)
+			function(j, laneOffsets < F(static_cast<float>(end - j)));
+	}
+}
+
+
+//=====================
+// Kernels
+//=====================
+
+template<typename F> void PredictFluid(const FluidParticles& p, std::size_t begin, std::size_t end)
+{
+	const F time(p.timeStep);
+	const Vector3N<F> gravity = BroadcastFluid<F>(p.gravity * p.timeStep);
+	for (std::size_t i = begin; i < end; i += LaneWidth<F>)
+	{
+		const Vector3N<F> velocity = LoadFluid<F>(p.velocityX, p.velocityY, p.velocityZ, i) + gravity;
+		const Vector3N<F> position = LoadFluid<F>(p.x, p.y, p.z, i);
+		StoreFluid(ClampToBox(position + velocity * time, p), p.predictedX, p.predictedY, p.predictedZ, i);
+		StoreFluid(velocity, p.velocityX, p.velocityY, p.velocityZ, i);
+	}
+}
+
+// Density constraint C = density / rest density - 1, only while compressed. Its multiplier is
+// -C / (sum of its squared gradients over every particle it moves + relaxation)
+template<typename F> void FluidLambdas(const FluidParticles& p, std::size_t begin, std::size_t end)
+{
+	const F zero(0.0f);
+	const F one(1.0f);
+	const F h(p.radius);
+	const F hSq(p.radius * p.radius);
+	const F gradientScale(p.gradientScale);
+	FluidNeighbours neighbours;
+	end = std::min(end, p.count);
+	for (std::size_t i = begin; i < end; ++i)
+	{
+		const Vector3f position = { p.predictedX[i], p.predictedY[i], p.predictedZ[i] };
+		const Vector3N<F> pi = BroadcastFluid<F>(position);
+		F density = zero;
+		F gradientSq = zero;
+		Vector3N<F> gradient = { zero, zero, zero };
+		ForNeighbourLanes<F>(p, position, neighbours, [&](std::size_t j, const auto& inRange)
+		{
+			const Vector3N<F> offset = pi - LoadFluidUnaligned<F>(p.predictedX, p.predictedY, p.predictedZ, j);
+			const F distanceSq = Dot(offset, offset);
+			const auto near = And(inRange, distanceSq < hSq);
+			const F w = hSq - distanceSq;
+			density = density + Select(near, w * w * w, zero);
+
+			// Spiky gradient. A particle has no gradient from itself
+			const auto apart = And(near, distanceSq > F(1e-12f));
+			const F distance = Sqrt(Select(apart, distanceSq, one));
+			const F fromCentre = h - distance;
+			const Vector3N<F> g = offset * Select(apart, gradientScale * fromCentre * fromCentre / distance, zero);
+			gradient = gradient + g;
+			gradientSq = gradientSq + Dot(g, g);
+		});
+
+		const float ratio = HorizontalSum(density) * p.densityScale;
+		const float constraint = std::max(ratio - 1, 0.0f);
+		const Vector3f own = SumLanes(gradient);
+		p.densities[i] = ratio * p.restDensity;
+		p.lambdas[i] = -constraint / (HorizontalSum(gradientSq) + Dot(own, own) + p.relaxation);
+	}
+}
+
+// Each neighbour moves the particle along the gradient by both their multipliers, plus the repulsion
+template<typename F> void FluidDeltas(const FluidParticles& p, std::size_t begin, std::size_t end)
+{
+	const F zero(0.0f);
+	const F one(1.0f);
+	const F h(p.radius);
+	const F hSq(p.radius * p.radius);
+	const F gradientScale(p.gradientScale);
+	const F tensileScale(p.tensileScale);
+	const F inverseTensileSum(1 / p.tensileSum);
+	FluidNeighbours neighbours;
+	end = std::min(end, p.count);
+	for (std::size_t i = begin; i < end; ++i)
+	{
+		const Vector3f position = { p.predictedX[i], p.predictedY[i], p.predictedZ[i] };
+		const Vector3N<F> pi = BroadcastFluid<F>(position);
+		const F lambda(p.lambdas[i]);
+		Vector3N<F> delta = { zero, zero, zero };
+		ForNeighbourLanes<F>(p, position, neighbours, [&](std::size_t j, const auto& inRange)
+		{
+			const Vector3N<F> offset = pi - LoadFluidUnaligned<F>(p.predictedX, p.predictedY, p.predictedZ, j);
+			const F distanceSq = Dot(offset, offset);
+			const auto apart = And(And(inRange, distanceSq < hSq), distanceSq > F(1e-12f));
+			const F distance = Sqrt(Select(apart, distanceSq, one));
+			const F fromCentre = h - distance;
+
+			const F w = hSq - distanceSq;
+			const F ratio = w * w * w * inverseTensileSum;
+			const F ratioSq = ratio * ratio;
+			const F tensile = tensileScale * ratioSq * ratioSq;
+
+			const F lambdas = lambda + LoadLanesUnaligned<F>(p.lambdas + j) - tensile;
+			delta = delta - offset * Select(apart, lambdas * gradientScale * fromCentre * fromCentre / distance, zero);
+		});
+
+		const Vector3f move = SumLanes(delta);
+		p.deltaX[i] = move.x;
+		p.deltaY[i] = move.y;
+		p.deltaZ[i] = move.z;
+	}
+}
+
+template<typename F> void ApplyFluidDeltas(const FluidParticles& p, std::size_t begin, std::size_t end)
+{
+	for (std::size_t i = begin; i < end; i += LaneWidth<F>)
+	{
+		const Vector3N<F> predicted = LoadFluid<F>(p.predictedX, p.predictedY, p.predictedZ, i) + LoadFluid<F>(p.deltaX, p.deltaY, p.deltaZ, i);
+		StoreFluid(ClampToBox(predicted, p), p.predictedX, p.predictedY, p.predictedZ, i);
+	}
+}
+
+template<typename F> void FluidVelocities(const FluidParticles& p, std::size_t begin, std::size_t end)
+{
+	const F inverseTime(1 / p.timeStep);
+	for (std::size_t i = begin; i < end; i += LaneWidth<F>)
+	{
+		const Vector3N<F> predicted = LoadFluid<F>(p.predictedX, p.predictedY, p.predictedZ, i);
+		const Vector3N<F> position = LoadFluid<F>(p.x, p.y, p.z, i);
+		StoreFluid((predicted - position) * inverseTime, p.velocityX, p.velocityY, p.velocityZ, i);
+		StoreFluid(predicted, p.x, p.y, p.z, i);
+	}
+}
+
+// XSPH: v += viscosity * sum of (neighbour's v - v) * poly6, with the mass over the rest density
+template<typename F> void FluidViscosity(const FluidParticles& p, std::size_t begin, std::size_t end)
+{
+	const F zero(0.0f);
+	const F hSq(p.radius * p.radius);
+	FluidNeighbours neighbours;
+	end = std::min(end, p.count);
+	for (std::size_t i = begin; i < end; ++i)
+	{
+		const Vector3f position = { p.x[i], p.y[i], p.z[i] };
+		const Vector3f velocity = { p.velocityX[i], p.velocityY[i], p.velocityZ[i] };
+		const Vector3N<F> pi = BroadcastFluid<F>(position);
+		const Vector3N<F> vi = BroadcastFluid<F>(velocity);
+		Vector3N<F> blend = { zero, zero, zero };
+		ForNeighbourLanes<F>(p, position, neighbours, [&](std::size_t j, const auto& inRange)
+		{
+			const Vector3N<F> offset = pi - LoadFluidUnaligned<F>(p.x, p.y, p.z, j);
+			const F distanceSq = Dot(offset, offset);
+			const auto near = And(inRange, distanceSq < hSq);
+			const F w = hSq - distanceSq;
+			const Vector3N<F> difference = LoadFluidUnaligned<F>(p.velocityX, p.velocityY, p.velocityZ, j) - vi;
+			blend = blend + difference * Select(near, w * w * w, zero);
+		});
+
+		const Vector3f v = velocity + SumLanes(blend) * (p.viscosity * p.densityScale);
+		p.deltaX[i] = v.x;
+		p.deltaY[i] = v.y;
+		p.deltaZ[i] = v.z;
+	}
+}
+
+#endif // !_FLUID_LANES_H_DEFINED_
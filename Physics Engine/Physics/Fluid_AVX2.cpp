@@ -0,0 +1,24 @@
+//=========================================================================================================
+// Fluid_AVX2.cpp: Fluid Kernels Eight Particles or Neighbours at a Time
+// - Only called after DetectSIMDLevel() has confirmed AVX2 and FMA are available
+// - Built with AVX2 code generation for this file only, as MathsSIMD_AVX2.cpp
+//=========================================================================================================
+
+#include "Fluid.h"
+
+#if defined(MATHS_SIMD_X86)
+
+#if !defined(_MSC_VER)
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "FluidLanes.h"
+#include "SIMDFloat8.h"
+
+extern const FluidKernels gAVX2FluidKernels;
+const FluidKernels gAVX2FluidKernels =
+{
+	PredictFluid<Float8>, FluidLambdas<Float8>, FluidDeltas<Float8>, ApplyFluidDeltas<Float8>, FluidVelocities<Float8>, FluidViscosity<Float8>
+};
+
+#endif // MATHS_SIMD_X86
@@ -0,0 +1,254 @@
+//=========================================================================================================
+// Integrator.cpp: Semi-Implicit (Symplectic) Euler Integration of Rigid Bodies
+// - Integrate processes four bodies per step using Float4, then finishes any remaining (count % 4)
+//   bodies with the scalar code. Both versions do the same calculation in the same order
+//=========================================================================================================
+
+#include "Integrator.h"
+
+#include "SIMDFloat.h"
+
+#include <algorithm>
+
+namespace
+{
+	//======================
+	// Scalar Integration
+	//======================
+
+	void IntegrateBodyVelocity(RigidBodies& bodies, const Vector3f& gravity, float timeStep, std::size_t i)
+	{
+		// Static bodies ignore gravity and forces
+		const float inverseMass = bodies.inverseMasses[i];
+		if (inverseMass > 0)
+		{
+			const Quaternionf orientation = bodies.Orientation(i);
+			bodies.linearVelocities.Set(i, bodies.linearVelocities.Get(i) + (gravity + bodies.forces.Get(i) * inverseMass) * timeStep);
+
+			// World inverse inertia = R * InverseInertia * R^T. Apply it by rotating the torque into local
+			// space, scaling by the diagonal inverse inertia, then rotating back to world space
+			Vector3f localTorque = Rotate(Conjugate(orientation), bodies.torques.Get(i));
+			Vector3f inverseInertia = bodies.inverseInertias.Get(i);
+			Vector3f localAcceleration = { localTorque.x * inverseInertia.x, localTorque.y * inverseInertia.y, localTorque.z * inverseInertia.z };
+			bodies.angularVelocities.Set(i, bodies.angularVelocities.Get(i) + Rotate(orientation, localAcceleration) * timeStep);
+		}
+
+		bodies.forces.Set(i, { 0, 0, 0 });
+		bodies.torques.Set(i, { 0, 0, 0 });
+	}
+
+	void IntegrateBodyPosition(RigidBodies& bodies, float timeStep, std::size_t i)
+	{
+		const Vector3f linearVelocity = bodies.linearVelocities.Get(i);
+		const Vector3f angularVelocity = bodies.angularVelocities.Get(i);
+		Quaternionf orientation = bodies.Orientation(i);
+
+		bodies.positions.Set(i, bodies.positions.Get(i) + linearVelocity * timeStep);
+
+		// dq/dt = 0.5 * (w, 0) * q, then normalise to remove the drift this first order step introduces
+		Quaternionf spin = QuaternionT<float>(angularVelocity, 0) * orientation;
+		const float h = 0.5f * timeStep;
+		orientation = { orientation.x + spin.x * h, orientation.y + spin.y * h, orientation.z + spin.z * h, orientation.w + spin.w * h };
+		bodies.SetOrientation(i, Normalise(orientation));
+	}
+
+
+	//======================
+	// SIMD Helpers
+	//======================
+
+	// Four Vector3 values, one per lane
+	struct Vector3x4
+	{
+		Float4 x, y, z;
+
+		static Vector3x4 Load(const Vector3SoA& v, std::size_t i)
+		{
+			return { Float4::Load(v.X() + i), Float4::Load(v.Y() + i), Float4::Load(v.Z() + i) };
+		}
+
+		void Store(Vector3SoA& v, std::size_t i) const
+		{
+			x.Store(v.X() + i);
+			y.Store(v.Y() + i);
+			z.Store(v.Z() + i);
+		}
+	};
+
+	Vector3x4 Cross(const Vector3x4& a, const Vector3x4& b)
+	{
+		return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+	}
+
+	// Same as Rotate(q, v) in Quaternion.h, for four quaternions (qx, qy, qz, qw) at once
+	Vector3x4 Rotate(const Vector3x4& q, Float4 qw, const Vector3x4& v)
+	{
+		const Float4 two(2.0f);
+		Vector3x4 t = Cross(q, v);
+		t = { t.x * two, t.y * two, t.z * two };
+		Vector3x4 c = Cross(q, t);
+		return { v.x + t.x * qw + c.x, v.y + t.y * qw + c.y, v.z + t.z * qw + c.z };
+	}
+
+
+	//======================
+	// SIMD Steps
+	//======================
+	// Four bodies starting at i, the same calculations as the scalar versions
+
+	struct StepConstants
+	{
+		Float4 zero, one, dt, h, gx, gy, gz;
+
+		StepConstants(const Vector3f& gravity, float timeStep)
+			: zero(0.0f), one(1.0f), dt(timeStep), h(0.5f * timeStep), gx(gravity.x), gy(gravity.y), gz(gravity.z) {}
+	};
+
+	void IntegrateVelocity4(RigidBodies& bodies, const StepConstants& c, std::size_t i)
+	{
+		const Float4 inverseMass = Float4::Load(bodies.inverseMasses.data() + i);
+		const Float4 dynamic = inverseMass > c.zero; // Static bodies ignore gravity and forces
+
+		const Vector3x4 q = { Float4::Load(bodies.orientationX.data() + i), Float4::Load(bodies.orientationY.data() + i), Float4::Load(bodies.orientationZ.data() + i) };
+		const Float4 qw = Float4::Load(bodies.orientationW.data() + i);
+
+		// Linear velocity
+		Vector3x4 force = Vector3x4::Load(bodies.forces, i);
+		Vector3x4 v = Vector3x4::Load(bodies.linearVelocities, i);
+		v.x += Select(dynamic, (c.gx + force.x * inverseMass) * c.dt, c.zero);
+		v.y += Select(dynamic, (c.gy + force.y * inverseMass) * c.dt, c.zero);
+		v.z += Select(dynamic, (c.gz + force.z * inverseMass) * c.dt, c.zero);
+
+		// Angular velocity - torque rotated into local space, scaled by the inverse inertia, rotated back
+		Vector3x4 torque = Vector3x4::Load(bodies.torques, i);
+		Vector3x4 inverseInertia = Vector3x4::Load(bodies.inverseInertias, i);
+		Vector3x4 local = Rotate({ -q.x, -q.y, -q.z }, qw, torque);
+		local = { local.x * inverseInertia.x, local.y * inverseInertia.y, local.z * inverseInertia.z };
+		Vector3x4 acceleration = Rotate(q, qw, local);
+
+		Vector3x4 w = Vector3x4::Load(bodies.angularVelocities, i);
+		w.x += Select(dynamic, acceleration.x * c.dt, c.zero);
+		w.y += Select(dynamic, acceleration.y * c.dt, c.zero);
+		w.z += Select(dynamic, acceleration.z * c.dt, c.zero);
+
+		v.Store(bodies.linearVelocities, i);
+		w.Store(bodies.angularVelocities, i);
+		Vector3x4{ c.zero, c.zero, c.zero }.Store(bodies.forces, i);
+		Vector3x4{ c.zero, c.zero, c.zero }.Store(bodies.torques, i);
+	}
+
+	void IntegratePosition4(RigidBodies& bodies, const StepConstants& c, std::size_t i)
+	{
+		Vector3x4 q = { Float4::Load(bodies.orientationX.data() + i), Float4::Load(bodies.orientationY.data() + i), Float4::Load(bodies.orientationZ.data() + i) };
+		Float4 qw = Float4::Load(bodies.orientationW.data() + i);
+		const Vector3x4 v = Vector3x4::Load(bodies.linearVelocities, i);
+		const Vector3x4 w = Vector3x4::Load(bodies.angularVelocities, i);
+
+		// Position
+		Vector3x4 p = Vector3x4::Load(bodies.positions, i);
+		p = { p.x + v.x * c.dt, p.y + v.y * c.dt, p.z + v.z * c.dt };
+
+		// Orientation: q += 0.5 * dt * (w, 0) * q, then normalise
+		Vector3x4 wq = Cross(w, q);
+		Float4 spinW = c.zero - (w.x * q.x + w.y * q.y + w.z * q.z);
+		Vector3x4 spin = { w.x * qw + wq.x, w.y * qw + wq.y, w.z * qw + wq.z };
+		q = { q.x + spin.x * c.h, q.y + spin.y * c.h, q.z + spin.z * c.h };
+		qw = qw + spinW * c.h;
+
+		Float4 invLength = c.one / Sqrt(q.x * q.x + q.y * q.y + q.z * q.z + qw * qw);
+
+		p.Store(bodies.positions, i);
+		(q.x * invLength).Store(bodies.orientationX.data() + i);
+		(q.y * invLength).Store(bodies.orientationY.data() + i);
+		(q.z * invLength).Store(bodies.orientationZ.data() + i);
+		(qw * invLength).Store(bodies.orientationW.data() + i);
+	}
+
+
+	//======================
+	// Jobs
+	//======================
+
+	// Bodies per job when integrating on a job system, a multiple of 4
+	const std::size_t BodiesPerJob = 1024;
+
+	// Call function(begin, end) for ranges of the awake bodies that start at multiples of 4, as jobs when
+	// given a job system
+	template<typename F> void ForAwakeBodies(const RigidBodies& bodies, JobSystem* jobs, F&& function)
+	{
+		const std::size_t count = bodies.AwakeCount();
+		if (!jobs)
+		{
+			function(std::size_t(0), count);
+			return;
+		}
+		jobs->ParallelFor((count + 3) / 4, BodiesPerJob / 4, [&](std::size_t begin, std::size_t end)
+		{
+			function(begin * 4, std::min(end * 4, count));
+		});
+	}
+}
+
+
+//=================
+// Integration
+//=================
+
+// Body arrays are 32 byte aligned and each SIMD step starts at a multiple of 4 bodies,
+// so all the loads and stores below can use the aligned versions
+
+void Integrate(RigidBodies& bodies, const Vector3f& gravity, float timeStep, JobSystem* jobs)
+{
+	const StepConstants constants(gravity, timeStep);
+	ForAwakeBodies(bodies, jobs, [&](std::size_t begin, std::size_t end)
+	{
+		// Both halves for each group of four while it is in the cache
+		std::size_t i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			IntegrateVelocity4(bodies, constants, i);
+			IntegratePosition4(bodies, constants, i);
+		}
+
+		for (; i < end; ++i)
+		{
+			IntegrateBodyVelocity(bodies, gravity, timeStep, i);
+			IntegrateBodyPosition(bodies, timeStep, i);
+		}
+	});
+}
+
+void IntegrateVelocities(RigidBodies& bodies, const Vector3f& gravity, float timeStep, JobSystem* jobs)
+{
+	const StepConstants constants(gravity, timeStep);
+	ForAwakeBodies(bodies, jobs, [&](std::size_t begin, std::size_t end)
+	{
+		std::size_t i = begin;
+		for (; i + 4 <= end; i += 4)
+			IntegrateVelocity4(bodies, constants, i);
+		for (; i < end; ++i)
+			IntegrateBodyVelocity(bodies, gravity, timeStep, i);
+	});
+}
+
+void IntegratePositions(RigidBodies& bodies, float timeStep, JobSystem* jobs)
+{
+	const StepConstants constants({ 0, 0, 0 }, timeStep);
+	ForAwakeBodies(bodies, jobs, [&](std::size_t begin, std::size_t end)
+	{
+		std::size_t i = begin;
+		for (; i + 4 <= end; i += 4)
+			IntegratePosition4(bodies, constants, i);
+		for (; i < end; ++i)
+			IntegrateBodyPosition(bodies, timeStep, i);
+	});
+}
+
+void IntegrateScalar(RigidBodies& bodies, const Vector3f& gravity, float timeStep)
+{
+	for (std::size_t i = 0; i < bodies.AwakeCount(); ++i)
+	{
+		IntegrateBodyVelocity(bodies, gravity, timeStep, i);
+		IntegrateBodyPosition(bodies, timeStep, i);
+	}
+}
@@ -0,0 +1,31 @@
+//=========================================================================================================
+// Integrator.h: Semi-Implicit (Symplectic) Euler Integration of Rigid Bodies
+// - Velocities are updated first from gravity and the accumulated forces / torques, then positions and
+//   orientations are moved with the NEW velocities. More stable than explicit Euler at the same cost
+// - Forces and torques are cleared afterwards, ready to be accumulated for the next step
+// - Gyroscopic torque is ignored (standard for game physics, keeps fast spinning bodies stable)
+// - The velocity and position halves can also be run separately, so the contact solver can correct the
+//   velocities in between (see PhysicsWorld::Step)
+// - Only awake bodies are integrated, sleeping bodies stay where they are (see RigidBodies.h)
+// - Given a job system the bodies are split into jobs of a thousand or so. Each body is integrated on its
+//   own, so the results are the same on any number of threads
+//=========================================================================================================
+
+#ifndef _INTEGRATOR_H_DEFINED_
+#define _INTEGRATOR_H_DEFINED_
+
+#include "RigidBodies.h"
+#include "JobSystem.h"
+
+// Integrate all bodies four at a time with SIMD, as jobs on the job system if one is given
+void Integrate(RigidBodies& bodies, const Vector3f& gravity, float timeStep, JobSystem* jobs = nullptr);
+
+// The two halves of Integrate: velocities from gravity and forces (clearing the forces), then positions
+// and orientations from the velocities
+void IntegrateVelocities(RigidBodies& bodies, const Vector3f& gravity, float timeStep, JobSystem* jobs = nullptr);
+void IntegratePositions(RigidBodies& bodies, float timeStep, JobSystem* jobs = nullptr);
+
+// Same calculation one body at a time with Vector3f / Quaternionf - reference for validating Integrate
+void IntegrateScalar(RigidBodies& bodies, const Vector3f& gravity, float timeStep);
+
+#endif // !_INTEGRATOR_H_DEFINED_
@@ -0,0 +1,332 @@
+//=========================================================================================================
+// Islands.cpp: Union-Find Island Building, Task Packing and Parallel Island Solving
+//=========================================================================================================
+
+#include "Islands.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+namespace
+{
+	// Fewer manifolds than this per thread and starting the thread costs more than it saves
+	const std::size_t MinManifoldsPerThread = 512;
+
+	// Small islands are put together until a task has at least this many manifolds
+	const std::size_t MinManifoldsPerTask = 256;
+
+	// Batched islands at least this big are split between all the threads rather than given to one
+	const std::size_t LargeIslandManifolds = 4096;
+
+	// For the solves without joints
+	std::vector<Joint> NoJoints;
+}
+
+
+//=================
+// Islands
+//=================
+
+// Root of a body's set, halving the path on the way so later finds are shorter
+uint32_t Islands::Find(uint32_t body)
+{
+	while (mParents[body] != body)
+	{
+		mParents[body] = mParents[mParents[body]];
+		body = mParents[body];
+	}
+	return body;
+}
+
+// The lower root index becomes the root of both, so the result doesn't depend on the manifold order
+void Islands::Union(uint32_t bodyA, uint32_t bodyB)
+{
+	const uint32_t rootA = Find(bodyA);
+	const uint32_t rootB = Find(bodyB);
+	if (rootA < rootB)
+		mParents[rootB] = rootA;
+	else if (rootB < rootA)
+		mParents[rootA] = rootB;
+}
+
+void Islands::Build(const RigidBodies& bodies, const std::vector<ContactManifold>& manifolds, Arena* arena)
+{
+	Build(bodies, manifolds, NoJoints, arena);
+}
+
+void Islands::Build(const RigidBodies& bodies, const std::vector<ContactManifold>& manifolds, const std::vector<Joint>& joints, Arena* arena)
+{
+	// Only awake bodies take part, they are all before AwakeCount
+	const std::size_t bodyCount = bodies.AwakeCount();
+	mParents.resize(bodies.Size());
+	std::iota(mParents.begin(), mParents.begin() + bodyCount, 0u);
+
+	// Join the dynamic bodies of each manifold and joint. Those between sleeping bodies are left out
+	auto isAwakeDynamic = [&](uint32_t i) { return bodies.inverseMasses[i] != 0 && bodies.IsAwake(i); };
+	auto join = [&](uint32_t slotA, uint32_t slotB)
+	{
+		const uint32_t a = static_cast<uint32_t>(bodies.SlotIndex(slotA));
+		const uint32_t b = static_cast<uint32_t>(bodies.SlotIndex(slotB));
+		if (isAwakeDynamic(a) && isAwakeDynamic(b))
+			Union(a, b);
+		return isAwakeDynamic(a) ? a : isAwakeDynamic(b) ? b : NoIsland; // Its island is found below
+	};
+	mManifoldIslands.resize(manifolds.size());
+	for (std::size_t m = 0; m < manifolds.size(); ++m)
+		mManifoldIslands[m] = join(manifolds[m].bodyA, manifolds[m].bodyB);
+	mJointIslands.resize(joints.size());
+	for (std::size_t j = 0; j < joints.size(); ++j)
+		mJointIslands[j] = join(joints[j].bodyA, joints[j].bodyB);
+
+	// Number the islands in the order of their first manifold, then of their first joint, and count their
+	// manifolds and joints
+	mBodyIslands.resize(bodies.Size());
+	std::fill(mBodyIslands.begin(), mBodyIslands.begin() + bodyCount, NoIsland);
+	mManifoldStarts.assign(1, 0);
+	mJointStarts.assign(1, 0);
+	auto number = [&](std::vector<uint32_t>& islands, std::vector<uint32_t>& starts)
+	{
+		for (uint32_t& body : islands)
+		{
+			if (body == NoIsland)
+				continue;
+
+			uint32_t& island = mBodyIslands[Find(body)];
+			if (island == NoIsland)
+			{
+				island = static_cast<uint32_t>(mManifoldStarts.size() - 1);
+				mManifoldStarts.push_back(0);
+				mJointStarts.push_back(0);
+			}
+			body = island;
+			++starts[island + 1];
+		}
+	};
+	number(mManifoldIslands, mManifoldStarts);
+	number(mJointIslands, mJointStarts);
+	const std::size_t islandCount = mManifoldStarts.size() - 1;
+
+	// Counting sort of the manifolds and joints by island
+	auto sortByIsland = [&](const std::vector<uint32_t>& islands, std::vector<uint32_t>& starts, std::vector<uint32_t>& sorted)
+	{
+		std::partial_sum(starts.begin(), starts.end(), starts.begin());
+		sorted.resize(starts.back());
+		ArenaVector<uint32_t> next(starts.begin(), starts.end() - 1, ArenaAllocator<uint32_t>(arena));
+		for (std::size_t k = 0; k < islands.size(); ++k)
+		{
+			if (islands[k] != NoIsland)
+				sorted[next[islands[k]]++] = static_cast<uint32_t>(k);
+		}
+	};
+	sortByIsland(mManifoldIslands, mManifoldStarts, mManifolds);
+	sortByIsland(mJointIslands, mJointStarts, mJoints);
+
+	// And of the dynamic bodies in an island. The roots are numbered, so each body takes its root's island
+	mBodyStarts.assign(islandCount + 1, 0);
+	for (uint32_t i = 0; i < bodyCount; ++i)
+	{
+		if (isAwakeDynamic(i))
+		{
+			mBodyIslands[i] = mBodyIslands[Find(i)];
+			if (mBodyIslands[i] != NoIsland)
+				++mBodyStarts[mBodyIslands[i] + 1];
+		}
+	}
+	std::partial_sum(mBodyStarts.begin(), mBodyStarts.end(), mBodyStarts.begin());
+	mBodies.resize(mBodyStarts.back());
+	{
+		ArenaVector<uint32_t> next(mBodyStarts.begin(), mBodyStarts.end() - 1, ArenaAllocator<uint32_t>(arena));
+		for (uint32_t i = 0; i < bodyCount; ++i)
+		{
+			if (isAwakeDynamic(i) && mBodyIslands[i] != NoIsland)
+				mBodies[next[mBodyIslands[i]]++] = i;
+		}
+	}
+}
+
+
+//=================
+// Island Solver
+//=================
+
+IslandSolver::IslandSolver(unsigned int threadCount)
+{
+	SetThreadCount(threadCount);
+}
+
+void IslandSolver::SetThreadCount(unsigned int threadCount)
+{
+	mThreadCount = threadCount > 0 ? threadCount : HardwareThreadCount();
+	mSolvers.resize(mThreadCount);
+	SetJobSystem(mJobs);
+}
+
+void IslandSolver::SetJobSystem(JobSystem* jobs)
+{
+	mJobs = jobs;
+	for (ContactSolver& solver : mSolvers)
+		solver.SetJobSystem(jobs);
+}
+
+void IslandSolver::Solve(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const ContactSolverSettings& settings, float timeStep,
+                         Arena* arena)
+{
+	Solve(bodies, manifolds, NoJoints, settings, timeStep, arena);
+}
+
+// Islands are sized by their manifolds and joints together, a joint is about as much work as a manifold
+void IslandSolver::Solve(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, std::vector<Joint>& joints, const ContactSolverSettings& settings,
+                         float timeStep, Arena* arena)
+{
+	BuildIslands(bodies, manifolds, joints, arena);
+	SolveIslands(bodies, manifolds, joints, settings, timeStep);
+}
+
+void IslandSolver::BuildIslands(const RigidBodies& bodies, const std::vector<ContactManifold>& manifolds, const std::vector<Joint>& joints,
+                                Arena* arena)
+{
+	mTaskStarts.clear();
+	mTaskJointStarts.clear();
+	mIslands.Build(bodies, manifolds, joints, arena);
+}
+
+void IslandSolver::SolveIslands(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, std::vector<Joint>& joints,
+                                const ContactSolverSettings& settings, float timeStep)
+{
+	mTaskStarts.clear();
+	mTaskJointStarts.clear();
+	if (mIslands.Count() == 0)
+		return;
+
+	const unsigned int threads = ParallelRangeCount(mIslands.ManifoldTotal() + mIslands.JointTotal(), mThreadCount, MinManifoldsPerThread);
+	auto islandSize = [&](uint32_t island) { return mIslands.ManifoldCount(island) + mIslands.JointCount(island); };
+
+	// Largest islands first, the order of the rest doesn't change any result
+	mOrder.resize(mIslands.Count());
+	std::iota(mOrder.begin(), mOrder.end(), 0u);
+	std::stable_sort(mOrder.begin(), mOrder.end(), [&](uint32_t a, uint32_t b) { return islandSize(a) > islandSize(b); });
+
+	// Large batched islands are solved one at a time by all the threads together
+	std::size_t first = 0;
+	if (settings.batched && threads > 1)
+	{
+		for (; first < mOrder.size() && islandSize(mOrder[first]) >= LargeIslandManifolds; ++first)
+		{
+			const uint32_t island = mOrder[first];
+			SolveConstraints(mSolvers[0], bodies, manifolds, mIslands.Manifolds(island), mIslands.ManifoldCount(island), joints,
+			                 mIslands.JointIndices(island), mIslands.JointCount(island), settings, timeStep, threads);
+		}
+	}
+
+	// The rest as tasks of one island, or of small islands together, taken by the threads in turn. A task
+	// is solved as one, so small islands fill the lanes of the batched solver's groups between them
+	mTaskManifolds.clear();
+	mTaskJoints.clear();
+	for (std::size_t i = first; i < mOrder.size(); )
+	{
+		mTaskStarts.push_back(static_cast<uint32_t>(mTaskManifolds.size()));
+		mTaskJointStarts.push_back(static_cast<uint32_t>(mTaskJoints.size()));
+		do
+		{
+			const uint32_t island = mOrder[i];
+			mTaskManifolds.insert(mTaskManifolds.end(), mIslands.Manifolds(island), mIslands.Manifolds(island) + mIslands.ManifoldCount(island));
+			mTaskJoints.insert(mTaskJoints.end(), mIslands.JointIndices(island), mIslands.JointIndices(island) + mIslands.JointCount(island));
+			++i;
+		} while (i < mOrder.size() && mTaskManifolds.size() - mTaskStarts.back() + mTaskJoints.size() - mTaskJointStarts.back() < MinManifoldsPerTask);
+	}
+	mTaskStarts.push_back(static_cast<uint32_t>(mTaskManifolds.size()));
+	mTaskJointStarts.push_back(static_cast<uint32_t>(mTaskJoints.size()));
+
+	std::atomic<std::size_t> nextTask{ 0 };
+	ParallelFor(mJobs, threads, threads, 1, [&](std::size_t, std::size_t, unsigned int thread)
+	{
+		for (std::size_t task = nextTask++; task < TaskCount(); task = nextTask++)
+		{
+			SolveConstraints(mSolvers[thread], bodies, manifolds, mTaskManifolds.data() + mTaskStarts[task], mTaskStarts[task + 1] - mTaskStarts[task],
+			                 joints, mTaskJoints.data() + mTaskJointStarts[task], mTaskJointStarts[task + 1] - mTaskJointStarts[task], settings, timeStep, 1);
+		}
+	});
+}
+
+// As one task, so the islands fill the batched solver's lanes between them, split colour by colour between
+// the threads as the large islands are
+void IslandSolver::SolveIslands(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, std::vector<Joint>& joints, const uint32_t* islands,
+                                std::size_t count, const ContactSolverSettings& settings, float timeStep)
+{
+	mSomeManifolds.clear();
+	mSomeJoints.clear();
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		const uint32_t island = islands[k];
+		mSomeManifolds.insert(mSomeManifolds.end(), mIslands.Manifolds(island), mIslands.Manifolds(island) + mIslands.ManifoldCount(island));
+		mSomeJoints.insert(mSomeJoints.end(), mIslands.JointIndices(island), mIslands.JointIndices(island) + mIslands.JointCount(island));
+	}
+	if (mSomeManifolds.empty() && mSomeJoints.empty())
+		return;
+
+	const unsigned int threads = ParallelRangeCount(mSomeManifolds.size() + mSomeJoints.size(), mThreadCount, MinManifoldsPerThread);
+	SolveConstraints(mSolvers[0], bodies, manifolds, mSomeManifolds.data(), mSomeManifolds.size(), joints, mSomeJoints.data(), mSomeJoints.size(),
+	                 settings, timeStep, threads);
+}
+
+void IslandSolver::SolveConstraints(ContactSolver& solver, RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices,
+                                    std::size_t count, std::vector<Joint>& joints, const uint32_t* jointIndices, std::size_t jointCount,
+                                    const ContactSolverSettings& settings, float timeStep, unsigned int threadCount)
+{
+	if (settings.batched)
+		solver.Solve(bodies, manifolds, manifoldIndices, count, joints.data(), jointIndices, jointCount, settings, timeStep, threadCount);
+	else
+		solver.SolveSequential(bodies, manifolds, manifoldIndices, count, joints.data(), jointIndices, jointCount, settings, timeStep);
+}
+
+
+//=================
+// Sleeping
+//=================
+
+void SleepingIslands::Sleep(RigidBodies& bodies, const uint32_t* slots, std::size_t count)
+{
+	uint32_t island;
+	if (!mFreeIslands.empty())
+	{
+		island = mFreeIslands.back();
+		mFreeIslands.pop_back();
+	}
+	else
+	{
+		island = static_cast<uint32_t>(mIslands.size());
+		mIslands.emplace_back();
+	}
+
+	mIslands[island].assign(slots, slots + count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		if (mIslandOfSlot.size() <= slots[k])
+			mIslandOfSlot.resize(slots[k] + 1, NoIsland);
+		mIslandOfSlot[slots[k]] = island;
+		bodies.Sleep(bodies.SlotIndex(slots[k]));
+	}
+}
+
+void SleepingIslands::Wake(RigidBodies& bodies, std::size_t index)
+{
+	if (bodies.IsAwake(index))
+		return;
+
+	const uint32_t island = mIslandOfSlot[bodies.Handle(index).slot];
+	for (uint32_t slot : mIslands[island])
+	{
+		mIslandOfSlot[slot] = NoIsland;
+		bodies.Wake(bodies.SlotIndex(slot));
+	}
+	mIslands[island].clear();
+	mFreeIslands.push_back(island);
+}
+
+void SleepingIslands::WakeAll(RigidBodies& bodies)
+{
+	while (bodies.AwakeCount() < bodies.Size())
+		Wake(bodies, bodies.AwakeCount());
+}
@@ -0,0 +1,183 @@
+//=========================================================================================================
+// Islands.h: Groups of Bodies Connected by Contacts, Solved Independently and in Parallel
+// - Two dynamic bodies touching or joined (Joints.h) are in the same island, and so is anything touching or
+//   joined to either of them. Static bodies don't join islands together, they are never moved by the
+//   solver, so a pile on the ground is an island of its own however many other piles share the ground.
+//   Sleeping bodies aren't in any island
+// - Islands are found each step with union-find over the body array indices (union by lower index, path
+//   halving), then the manifolds and bodies are counting sorted by island, keeping their order within each
+// - No manifold in one island shares a dynamic body with another island, so IslandSolver gives each
+//   worker thread its own ContactSolver and islands are solved at the same time. Small islands are put
+//   together into tasks so each is worth a thread picking up. Large islands go first so the threads finish
+//   together; with the batched solver they are also split between all the threads colour by colour
+// - The sequential solver gives exactly the same result as solving all the manifolds at once, as no
+//   manifold's impulses affect another island
+// - Islands also sleep as a whole (SleepingIslands): once every body of an island has been slow for long
+//   enough, they all stop and are moved out of the awake range of the body arrays together. A body
+//   touching any of them wakes them all, as they rest on each other
+//=========================================================================================================
+
+#ifndef _ISLANDS_H_DEFINED_
+#define _ISLANDS_H_DEFINED_
+
+#include "RigidBodies.h"
+#include "ContactCache.h"
+#include "ContactSolver.h"
+#include "Joints.h"
+#include "Arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//=====================
+// Islands
+//=====================
+
+class Islands
+{
+public:
+	// Find the islands of the manifolds' and joints' awake dynamic bodies. Their body ids are body handle slots
+	// Manifolds and joints without an awake dynamic body are left out, and must not join an awake dynamic
+	// body to a sleeping one. Dynamic bodies without contacts or joints are not in any island
+	// Temporaries come from the arena if given, otherwise the global allocator
+	void Build(const RigidBodies& bodies, const std::vector<ContactManifold>& manifolds, const std::vector<Joint>& joints, Arena* arena = nullptr);
+	void Build(const RigidBodies& bodies, const std::vector<ContactManifold>& manifolds, Arena* arena = nullptr);
+
+	std::size_t Count() const { return mManifoldStarts.empty() ? 0 : mManifoldStarts.size() - 1; }
+	std::size_t ManifoldTotal() const { return mManifolds.size(); }
+	std::size_t JointTotal() const { return mJoints.size(); }
+
+	// Island of an awake dynamic body (array index) from the last Build, NoIsland if it has no contacts
+	static constexpr uint32_t NoIsland = ~0u;
+	uint32_t IslandOf(std::size_t body) const { return mBodyIslands[body]; }
+
+	// Indices of an island's manifolds, in increasing order
+	const uint32_t* Manifolds(std::size_t island) const { return mManifolds.data() + mManifoldStarts[island]; }
+	std::size_t ManifoldCount(std::size_t island) const { return mManifoldStarts[island + 1] - mManifoldStarts[island]; }
+
+	// Indices of an island's joints, in increasing order
+	const uint32_t* JointIndices(std::size_t island) const { return mJoints.data() + mJointStarts[island]; }
+	std::size_t JointCount(std::size_t island) const { return mJointStarts[island + 1] - mJointStarts[island]; }
+
+	// Array indices of an island's dynamic bodies, in increasing order
+	const uint32_t* Bodies(std::size_t island) const { return mBodies.data() + mBodyStarts[island]; }
+	std::size_t BodyCount(std::size_t island) const { return mBodyStarts[island + 1] - mBodyStarts[island]; }
+
+private:
+	uint32_t Find(uint32_t body);
+	void Union(uint32_t bodyA, uint32_t bodyB);
+
+private:
+	std::vector<uint32_t> mParents;      // Union-find parent of each body array index, roots are their own
+	std::vector<uint32_t> mBodyIslands;  // Island of each awake dynamic body (of each root during Build)
+	std::vector<uint32_t> mManifoldIslands;
+	std::vector<uint32_t> mJointIslands;
+
+	std::vector<uint32_t> mManifolds;      // Grouped by island
+	std::vector<uint32_t> mManifoldStarts; // Index into mManifolds of each island's first, plus the end
+	std::vector<uint32_t> mJoints;
+	std::vector<uint32_t> mJointStarts;
+	std::vector<uint32_t> mBodies;
+	std::vector<uint32_t> mBodyStarts;
+};
+
+
+//=====================
+// Parallel Solving
+//=====================
+
+class IslandSolver
+{
+public:
+	//================
+	// Constructors
+	//================
+
+	// threadCount: threads to solve islands on, 0 for one per hardware thread
+	explicit IslandSolver(unsigned int threadCount = 0);
+
+	//=================
+	// Solving
+	//=================
+
+	// Build the islands of the manifolds and joints and solve them on the worker threads, batched or
+	// sequential as the settings choose. Scenes with few contacts are solved on the calling thread alone
+	// The tasks are the same whatever the thread count, so are the results
+	void Solve(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, std::vector<Joint>& joints, const ContactSolverSettings& settings,
+	           float timeStep, Arena* arena = nullptr);
+	void Solve(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const ContactSolverSettings& settings, float timeStep,
+	           Arena* arena = nullptr);
+
+	// Solve in two halves, for a caller that needs the islands before they are solved, or solves some again:
+	// BuildIslands finds them, SolveIslands solves every island of the last build just as Solve does
+	void BuildIslands(const RigidBodies& bodies, const std::vector<ContactManifold>& manifolds, const std::vector<Joint>& joints,
+	                  Arena* arena = nullptr);
+	void SolveIslands(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, std::vector<Joint>& joints, const ContactSolverSettings& settings,
+	                  float timeStep);
+
+	// Solve only some islands of the last build again (indices in increasing order), all of them together on
+	// every thread. The rest of the bodies and manifolds aren't touched
+	void SolveIslands(RigidBodies& bodies, std::vector<ContactManifold>& manifolds, std::vector<Joint>& joints, const uint32_t* islands,
+	                  std::size_t count, const ContactSolverSettings& settings, float timeStep);
+
+	const Islands& LastIslands() const { return mIslands; }
+
+	// Tasks the last Solve gave the threads, each one island or several small ones
+	std::size_t TaskCount() const { return mTaskStarts.empty() ? 0 : mTaskStarts.size() - 1; }
+
+	unsigned int ThreadCount() const { return mThreadCount; }
+	void SetThreadCount(unsigned int threadCount);
+
+	// Solve as jobs on this system (JobSystem.h) rather than on threads started for each solve. Null to go back
+	void SetJobSystem(JobSystem* jobs);
+
+private:
+	void SolveConstraints(ContactSolver& solver, RigidBodies& bodies, std::vector<ContactManifold>& manifolds, const uint32_t* manifoldIndices,
+	                      std::size_t count, std::vector<Joint>& joints, const uint32_t* jointIndices, std::size_t jointCount,
+	                      const ContactSolverSettings& settings, float timeStep, unsigned int threadCount);
+
+private:
+	unsigned int mThreadCount;
+	JobSystem* mJobs = nullptr;
+	Islands mIslands;
+	std::vector<ContactSolver> mSolvers; // One per thread
+
+	std::vector<uint32_t> mOrder;         // Island indices, largest first
+	std::vector<uint32_t> mTaskManifolds; // Manifold indices of the tasks' islands
+	std::vector<uint32_t> mTaskStarts;    // Index into mTaskManifolds of each task's first, plus the end
+	std::vector<uint32_t> mTaskJoints;    // The same for the joints
+	std::vector<uint32_t> mTaskJointStarts;
+
+	std::vector<uint32_t> mSomeManifolds; // Manifold and joint indices of the islands solved again
+	std::vector<uint32_t> mSomeJoints;
+};
+
+
+
+//=====================
+// Sleeping
+//=====================
+
+class SleepingIslands
+{
+public:
+	// Put awake bodies to sleep together as one island. They are given by handle slot, as putting each body
+	// to sleep moves it and another body in the arrays (RigidBodies::Sleep)
+	void Sleep(RigidBodies& bodies, const uint32_t* slots, std::size_t count);
+
+	// Wake every body in the island of a sleeping body (array index). An awake body is left alone
+	void Wake(RigidBodies& bodies, std::size_t index);
+	void WakeAll(RigidBodies& bodies);
+
+	std::size_t Count() const { return mIslands.size() - mFreeIslands.size(); }
+
+private:
+	static constexpr uint32_t NoIsland = ~0u;
+
+	std::vector<std::vector<uint32_t>> mIslands; // Handle slots of each island's bodies, empty if unused
+	std::vector<uint32_t> mFreeIslands;
+	std::vector<uint32_t> mIslandOfSlot;         // Island of each handle slot, NoIsland if awake
+};
+
+#endif // !_ISLANDS_H_DEFINED_
@@ -0,0 +1,493 @@
+//=========================================================================================================
+// Joints.cpp: Joint Setup and Storage, Row Preparation and Block Solving
+//=========================================================================================================
+
+#include "Joints.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// A block row whose effective mass is smaller than this fraction of its own diagonal once the rows before
+	// it are taken out depends on them (e.g. a body that can't turn about that axis), and is left out
+	const float DependentRowFraction = 1e-5f;
+
+	// Two unit vectors perpendicular to a unit axis and each other
+	void Perpendiculars(const Vector3f& axis, Vector3f& p, Vector3f& q)
+	{
+		// Cross with whichever world axis is least parallel to the axis
+		if (std::abs(axis.x) < 0.57735f)
+			p = Normalise(Vector3f(0, axis.z, -axis.y));
+		else
+			p = Normalise(Vector3f(axis.y, -axis.x, 0));
+		q = Cross(axis, p);
+	}
+
+	// Rotation taking B from where the joint wants it to where it is, as a rotation vector (axis * angle)
+	// for small errors. World space
+	Vector3f RotationError(const Quaternionf& orientationA, const Quaternionf& orientationB, const Quaternionf& rotationB)
+	{
+		Quaternionf error = orientationB * Conjugate(orientationA * rotationB);
+		if (error.w < 0)
+			error = -error;
+		return error.Vector() * 2.0f;
+	}
+
+	// Where the anchors are relative to the bodies, and how far B's is from A's
+	struct Anchors
+	{
+		Vector3f rA;
+		Vector3f rB;
+		Vector3f separation;
+	};
+
+	Anchors JointAnchors(const Joint& joint, const Transformf& a, const Transformf& b)
+	{
+		Anchors anchors;
+		anchors.rA = a.TransformVector(joint.localAnchorA);
+		anchors.rB = b.TransformVector(joint.localAnchorB);
+		anchors.separation = (b.position + anchors.rB) - (a.position + anchors.rA);
+		return anchors;
+	}
+
+	float HingeAngle(const Joint& joint, const Transformf& a, const Transformf& b)
+	{
+		const Vector3f axis = a.TransformVector(joint.localAxisA);
+		const Vector3f referenceA = a.TransformVector(joint.localReferenceA);
+		const Vector3f referenceB = b.TransformVector(joint.localReferenceB);
+		return std::atan2(Dot(Cross(referenceA, referenceB), axis), Dot(referenceA, referenceB));
+	}
+}
+
+
+//=================
+// Setup
+//=================
+
+Joint MakeJoint(const JointDesc& desc, const RigidBodies& bodies, std::size_t indexA, std::size_t indexB)
+{
+	const Transformf a = bodies.BodyTransform(indexA);
+	const Transformf b = bodies.BodyTransform(indexB);
+	const Transformf toA = Inverse(a);
+	const Transformf toB = Inverse(b);
+
+	Joint joint = {};
+	joint.type = desc.type;
+	joint.bodyA = bodies.Handle(indexA).slot;
+	joint.bodyB = bodies.Handle(indexB).slot;
+
+	const Vector3f anchorB = desc.type == JointType::Distance ? desc.anchorB : desc.anchor;
+	joint.localAnchorA = toA.TransformPoint(desc.anchor);
+	joint.localAnchorB = toB.TransformPoint(anchorB);
+	joint.length = (anchorB - desc.anchor).Length();
+
+	const Vector3f axis = Normalise(desc.axis);
+	Vector3f reference, unused;
+	Perpendiculars(axis, reference, unused);
+	joint.localAxisA = toA.TransformVector(axis);
+	joint.localAxisB = toB.TransformVector(axis);
+	joint.localReferenceA = toA.TransformVector(reference);
+	joint.localReferenceB = toB.TransformVector(reference);
+	joint.rotationB = Conjugate(a.rotation) * b.rotation;
+
+	// Only the joints with a free direction have limits, and only those with a free axis have motors
+	const bool hasLimits = desc.type == JointType::Hinge || desc.type == JointType::Slider || desc.type == JointType::Distance;
+	const bool hasMotor = desc.type == JointType::Hinge || desc.type == JointType::Slider;
+	joint.limited = desc.limited && hasLimits;
+	joint.lower = desc.lower;
+	joint.upper = desc.upper;
+	joint.motor = desc.motor && hasMotor;
+	joint.motorSpeed = desc.motorSpeed;
+	joint.maxMotorForce = desc.maxMotorForce;
+	joint.collideConnected = desc.collideConnected;
+	return joint;
+}
+
+float JointPosition(const Joint& joint, const RigidBodies& bodies)
+{
+	const Transformf a = bodies.BodyTransform(bodies.SlotIndex(joint.bodyA));
+	const Transformf b = bodies.BodyTransform(bodies.SlotIndex(joint.bodyB));
+	switch (joint.type)
+	{
+	case JointType::Hinge:
+		return HingeAngle(joint, a, b);
+	case JointType::Slider:
+		return Dot(JointAnchors(joint, a, b).separation, a.TransformVector(joint.localAxisA));
+	case JointType::Distance:
+		return JointAnchors(joint, a, b).separation.Length();
+	default:
+		return 0;
+	}
+}
+
+JointError MeasureJointError(const Joint& joint, const RigidBodies& bodies)
+{
+	const Transformf a = bodies.BodyTransform(bodies.SlotIndex(joint.bodyA));
+	const Transformf b = bodies.BodyTransform(bodies.SlotIndex(joint.bodyB));
+	const Vector3f separation = JointAnchors(joint, a, b).separation;
+	const Vector3f axisA = a.TransformVector(joint.localAxisA);
+
+	JointError error = { 0, 0 };
+	switch (joint.type)
+	{
+	case JointType::Ball:
+		error.linear = separation.Length();
+		break;
+	case JointType::Hinge:
+		error.linear = separation.Length();
+		error.angular = std::atan2(Cross(axisA, b.TransformVector(joint.localAxisB)).Length(), Dot(axisA, b.TransformVector(joint.localAxisB)));
+		break;
+	case JointType::Slider:
+		error.linear = (separation - axisA * Dot(separation, axisA)).Length();
+		error.angular = RotationError(a.rotation, b.rotation, joint.rotationB).Length();
+		break;
+	case JointType::Distance:
+	{
+		const float distance = separation.Length();
+		const float lower = joint.limited ? joint.lower : joint.length;
+		const float upper = joint.limited ? joint.upper : joint.length;
+		error.linear = std::max({ lower - distance, distance - upper, 0.0f });
+		break;
+	}
+	case JointType::Fixed:
+		error.linear = separation.Length();
+		error.angular = RotationError(a.rotation, b.rotation, joint.rotationB).Length();
+		break;
+	}
+	return error;
+}
+
+
+//=================
+// Joint Storage
+//=================
+
+JointHandle Joints::Add(const Joint& joint)
+{
+	const uint32_t index = static_cast<uint32_t>(Size());
+
+	// Reuse a free slot if there is one, its generation was already moved on when it was freed
+	uint32_t slot;
+	if (!mFreeSlots.empty())
+	{
+		slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+		mSlots[slot].index = index;
+	}
+	else
+	{
+		slot = static_cast<uint32_t>(mSlots.size());
+		mSlots.push_back({ index, 0 });
+	}
+	mSlotOfJoint.push_back(slot);
+	joints.push_back(joint);
+	return { slot, mSlots[slot].generation };
+}
+
+void Joints::Remove(JointHandle handle)
+{
+	if (!IsValid(handle))
+		return;
+
+	// Move the last joint into the gap and fix up its slot
+	const uint32_t index = mSlots[handle.slot].index;
+	const uint32_t last = static_cast<uint32_t>(Size() - 1);
+	joints[index] = joints[last];
+	joints.pop_back();
+
+	const uint32_t movedSlot = mSlotOfJoint[last];
+	mSlots[movedSlot].index = index;
+	mSlotOfJoint[index] = movedSlot;
+	mSlotOfJoint.pop_back();
+
+	// Free the slot, new generation so existing handles to it become invalid
+	mSlots[handle.slot].index = JointHandle::InvalidSlot;
+	++mSlots[handle.slot].generation;
+	mFreeSlots.push_back(handle.slot);
+}
+
+
+//=================
+// Preparation
+//=================
+
+// The rows of the joint's type: locked directions in the block, limits and motors as single rows. Each row
+// aims to remove baumgarte of its position error per step. Then the block's effective mass matrix is
+// factored, K = L L^T, so each iteration can solve K * impulses = velocity errors with two substitutions
+void PrepareJoint(JointConstraint& c, const Joint& joint, const RigidBodies& bodies, std::size_t indexA, std::size_t indexB,
+                  float baumgarte, bool warmStarting, float timeStep)
+{
+	const float inverseTimeStep = 1 / timeStep;
+	const float infinity = std::numeric_limits<float>::max();
+	const Transformf a = bodies.BodyTransform(indexA);
+	const Transformf b = bodies.BodyTransform(indexB);
+	c.inverseMassA = bodies.inverseMasses[indexA];
+	c.inverseMassB = bodies.inverseMasses[indexB];
+	c.blockRows = 0;
+	c.singleRows = 0;
+
+	auto prepareRow = [&](JointRow& row, const Vector3f& linear, const Vector3f& angularA, const Vector3f& angularB)
+	{
+		row.linear = linear;
+		row.angularA = angularA;
+		row.angularB = angularB;
+		row.turnA = bodies.ApplyInverseInertia(indexA, angularA);
+		row.turnB = bodies.ApplyInverseInertia(indexB, angularB);
+		const float k = (c.inverseMassA + c.inverseMassB) * linear.LengthSq() + Dot(angularA, row.turnA) + Dot(angularB, row.turnB);
+		row.effectiveMass = k > 0 ? 1 / k : 0;
+	};
+
+	// A locked direction, with its position error
+	auto lockRow = [&](const Vector3f& linear, const Vector3f& angularA, const Vector3f& angularB, float error)
+	{
+		JointRow& row = c.block[c.blockRows];
+		prepareRow(row, linear, angularA, angularB);
+		row.bias = -baumgarte * error * inverseTimeStep;
+		row.impulse = warmStarting ? joint.blockImpulses[c.blockRows] : 0;
+		row.low = -infinity;
+		row.high = infinity;
+		++c.blockRows;
+	};
+
+	// A limit gap, in the row's direction. Closes in one step while open, pushed back like a contact once past
+	auto limitRow = [&](const Vector3f& linear, const Vector3f& angularA, const Vector3f& angularB, float gap, float impulse)
+	{
+		JointRow& row = c.single[c.singleRows++];
+		prepareRow(row, linear, angularA, angularB);
+		row.bias = (gap > 0 ? -gap : -baumgarte * gap) * inverseTimeStep;
+		row.impulse = warmStarting ? impulse : 0;
+		row.low = 0;
+		row.high = infinity;
+	};
+
+	auto motorRow = [&](const Vector3f& linear, const Vector3f& angularA, const Vector3f& angularB)
+	{
+		JointRow& row = c.single[c.singleRows++];
+		prepareRow(row, linear, angularA, angularB);
+		row.bias = joint.motorSpeed;
+		row.impulse = warmStarting ? joint.motorImpulse : 0;
+		row.high = joint.maxMotorForce * timeStep;
+		row.low = -row.high;
+	};
+
+	const Anchors anchors = JointAnchors(joint, a, b);
+	const Vector3f& rA = anchors.rA;
+	const Vector3f& rB = anchors.rB;
+	const Vector3f& separation = anchors.separation;
+	const Vector3f axes[] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+	const Vector3f zero = { 0, 0, 0 };
+
+	// Anchors together, one row per world axis
+	auto lockPoint = [&]
+	{
+		for (int k = 0; k < 3; ++k)
+			lockRow(axes[k], Cross(rA, axes[k]), Cross(rB, axes[k]), Dot(separation, axes[k]));
+	};
+
+	// No relative rotation, one row per world axis
+	auto lockRotation = [&]
+	{
+		const Vector3f error = RotationError(a.rotation, b.rotation, joint.rotationB);
+		for (int k = 0; k < 3; ++k)
+			lockRow(zero, axes[k], axes[k], Dot(error, axes[k]));
+	};
+
+	const Vector3f axis = a.TransformVector(joint.localAxisA);
+	switch (joint.type)
+	{
+	case JointType::Ball:
+		lockPoint();
+		break;
+
+	case JointType::Hinge:
+	{
+		if (joint.motor)
+			motorRow(zero, axis, axis);
+		if (joint.limited)
+		{
+			const float angle = HingeAngle(joint, a, b);
+			limitRow(zero, axis, axis, angle - joint.lower, joint.lowerImpulse);
+			limitRow(zero, -axis, -axis, joint.upper - angle, joint.upperImpulse);
+		}
+
+		// B's axis can only turn about A's. Its misalignment is the cross product, seen along two perpendiculars
+		lockPoint();
+		Vector3f p, q;
+		Perpendiculars(axis, p, q);
+		const Vector3f misalignment = Cross(axis, b.TransformVector(joint.localAxisB));
+		lockRow(zero, p, p, Dot(misalignment, p));
+		lockRow(zero, q, q, Dot(misalignment, q));
+		break;
+	}
+
+	case JointType::Slider:
+	{
+		// The directions are fixed to A, so A turning moves B's anchor along them too: A's lever is to B's anchor
+		const Vector3f leverA = rA + separation;
+		if (joint.motor)
+			motorRow(axis, Cross(leverA, axis), Cross(rB, axis));
+		if (joint.limited)
+		{
+			const float travel = Dot(separation, axis);
+			limitRow(axis, Cross(leverA, axis), Cross(rB, axis), travel - joint.lower, joint.lowerImpulse);
+			limitRow(-axis, Cross(leverA, -axis), Cross(rB, -axis), joint.upper - travel, joint.upperImpulse);
+		}
+
+		Vector3f p, q;
+		Perpendiculars(axis, p, q);
+		lockRow(p, Cross(leverA, p), Cross(rB, p), Dot(separation, p));
+		lockRow(q, Cross(leverA, q), Cross(rB, q), Dot(separation, q));
+		lockRotation();
+		break;
+	}
+
+	case JointType::Distance:
+	{
+		const float distance = separation.Length();
+		const Vector3f direction = distance > 1e-6f ? separation * (1 / distance) : Vector3f(0, 1, 0);
+		if (joint.limited)
+		{
+			limitRow(direction, Cross(rA, direction), Cross(rB, direction), distance - joint.lower, joint.lowerImpulse);
+			limitRow(-direction, Cross(rA, -direction), Cross(rB, -direction), joint.upper - distance, joint.upperImpulse);
+		}
+		else
+		{
+			lockRow(direction, Cross(rA, direction), Cross(rB, direction), distance - joint.length);
+		}
+		break;
+	}
+
+	case JointType::Fixed:
+		lockPoint();
+		lockRotation();
+		break;
+	}
+
+	// Cholesky factor of the block's effective mass matrix, K[i][j] = row i's velocity from a unit impulse on row j
+	const float inverseMassSum = c.inverseMassA + c.inverseMassB;
+	for (int i = 0; i < c.blockRows; ++i)
+	{
+		const JointRow& rowI = c.block[i];
+		for (int j = 0; j <= i; ++j)
+		{
+			const JointRow& rowJ = c.block[j];
+			float k = inverseMassSum * Dot(rowI.linear, rowJ.linear) + Dot(rowI.angularA, rowJ.turnA) + Dot(rowI.angularB, rowJ.turnB);
+			for (int m = 0; m < j; ++m)
+				k -= c.factor[i][m] * c.factor[j][m];
+
+			if (j < i)
+			{
+				c.factor[i][j] = k * c.factor[j][j];
+			}
+			else
+			{
+				// The diagonal holds 1 / the factor's diagonal, zero for a dependent row, which then takes no impulse
+				const float diagonal = rowI.effectiveMass > 0 ? 1 / rowI.effectiveMass : 0;
+				c.factor[i][i] = k > DependentRowFraction * diagonal && k > 0 ? 1 / std::sqrt(k) : 0;
+			}
+		}
+	}
+}
+
+
+//=================
+// Solving
+//=================
+
+namespace
+{
+	void ApplyJointImpulse(const JointConstraint& c, const JointRow& row, float impulse, Vector3f* linearVelocities, Vector3f* angularVelocities)
+	{
+		linearVelocities[c.bodyA] -= row.linear * (c.inverseMassA * impulse);
+		angularVelocities[c.bodyA] -= row.turnA * impulse;
+		linearVelocities[c.bodyB] += row.linear * (c.inverseMassB * impulse);
+		angularVelocities[c.bodyB] += row.turnB * impulse;
+	}
+
+	float RowVelocity(const JointConstraint& c, const JointRow& row, const Vector3f* linearVelocities, const Vector3f* angularVelocities)
+	{
+		return Dot(row.linear, linearVelocities[c.bodyB] - linearVelocities[c.bodyA]) + Dot(angularVelocities[c.bodyB], row.angularB) -
+		       Dot(angularVelocities[c.bodyA], row.angularA);
+	}
+
+	// Accumulated impulse clamped to the row's limits, as the contact rows
+	void SolveRow(JointConstraint& c, JointRow& row, Vector3f* linearVelocities, Vector3f* angularVelocities)
+	{
+		const float velocity = RowVelocity(c, row, linearVelocities, angularVelocities);
+		const float impulse = std::clamp(row.impulse + row.effectiveMass * (row.bias - velocity), row.low, row.high);
+		ApplyJointImpulse(c, row, impulse - row.impulse, linearVelocities, angularVelocities);
+		row.impulse = impulse;
+	}
+}
+
+void WarmStartJoint(const JointConstraint& c, Vector3f* linearVelocities, Vector3f* angularVelocities)
+{
+	for (int k = 0; k < c.singleRows; ++k)
+		ApplyJointImpulse(c, c.single[k], c.single[k].impulse, linearVelocities, angularVelocities);
+	for (int k = 0; k < c.blockRows; ++k)
+		ApplyJointImpulse(c, c.block[k], c.block[k].impulse, linearVelocities, angularVelocities);
+}
+
+// Limits and motor first, the locked directions matter most so have the final say
+void SolveJoint(JointConstraint& c, Vector3f* linearVelocities, Vector3f* angularVelocities, bool block)
+{
+	for (int k = 0; k < c.singleRows; ++k)
+		SolveRow(c, c.single[k], linearVelocities, angularVelocities);
+
+	if (!block)
+	{
+		for (int k = 0; k < c.blockRows; ++k)
+			SolveRow(c, c.block[k], linearVelocities, angularVelocities);
+		return;
+	}
+
+	// Velocity error of every row from the same velocities, then L y = error and L^T impulses = y
+	float impulses[JointConstraint::MaxBlockRows];
+	for (int i = 0; i < c.blockRows; ++i)
+	{
+		float y = c.block[i].bias - RowVelocity(c, c.block[i], linearVelocities, angularVelocities);
+		for (int m = 0; m < i; ++m)
+			y -= c.factor[i][m] * impulses[m];
+		impulses[i] = y * c.factor[i][i];
+	}
+	for (int i = c.blockRows; i-- > 0; )
+	{
+		float x = impulses[i];
+		for (int m = i + 1; m < c.blockRows; ++m)
+			x -= c.factor[m][i] * impulses[m];
+		impulses[i] = x * c.factor[i][i];
+	}
+
+	// All the rows' impulses as one change per body
+	Vector3f linear = { 0, 0, 0 }, turnA = { 0, 0, 0 }, turnB = { 0, 0, 0 };
+	for (int i = 0; i < c.blockRows; ++i)
+	{
+		JointRow& row = c.block[i];
+		linear += row.linear * impulses[i];
+		turnA += row.turnA * impulses[i];
+		turnB += row.turnB * impulses[i];
+		row.impulse += impulses[i];
+	}
+	linearVelocities[c.bodyA] -= linear * c.inverseMassA;
+	angularVelocities[c.bodyA] -= turnA;
+	linearVelocities[c.bodyB] += linear * c.inverseMassB;
+	angularVelocities[c.bodyB] += turnB;
+}
+
+void StoreJointImpulses(const JointConstraint& c, Joint& joint)
+{
+	for (int k = 0; k < c.blockRows; ++k)
+		joint.blockImpulses[k] = c.block[k].impulse;
+
+	// Single rows are in the order they were prepared
+	int k = 0;
+	if (joint.motor)
+		joint.motorImpulse = c.single[k++].impulse;
+	if (joint.limited)
+	{
+		joint.lowerImpulse = c.single[k++].impulse;
+		joint.upperImpulse = c.single[k++].impulse;
+	}
+}
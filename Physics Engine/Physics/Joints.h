@@ -0,0 +1,243 @@
+//=========================================================================================================
+// Joints.h: Ball, Hinge, Slider, Distance and Fixed Joints Between Pairs of Bodies, with Limits and Motors
+// - A joint removes some of the relative movement of two bodies. Each removed direction is a constraint
+//   row, as for contacts: ball 3 (the anchors stay together), hinge 5 (and the axes stay lined up), slider
+//   5 (no sideways movement, no rotation), distance 1, fixed 6
+// - A joint's rows are coupled: pushing one anchor sideways also turns the body, which moves the anchor
+//   along the other rows. Solving them one at a time (Gauss-Seidel) needs many iterations to untangle,
+//   most of all along a chain. Instead the rows are solved together as one block: the 3x3 to 6x6 effective
+//   mass matrix is Cholesky factored once per step and each iteration solves for all the row impulses at
+//   once, so the joint is exactly satisfied after its own solve. On driven 50 link chains that is no worse
+//   than the rows at any iteration count, under half their error at the default 8, and costs less than
+//   the rows' passes. Where the rows don't couple, e.g. a chain hanging straight down, the two give the
+//   same answer (JointBenchmark.cpp)
+// - Limits (hinge angle, slider travel, distance range) and motors (hinge, slider) are single rows solved
+//   before the block. Limits are rows like contact normals: they only push, and let the joint close a gap
+//   up to the limit in one step. Motors aim for a speed using at most their maximum force
+// - Drift is pulled back by a fraction of the position error each step (Baumgarte, jointBaumgarte in
+//   ContactSolverSettings), and impulses are warm started from the last step
+// - The rows are prepared and solved by the ContactSolver alongside the contacts, coloured with them so
+//   joints and contact groups of a colour can be solved at the same time (ContactSolver.h). Joints also
+//   join bodies into islands (Islands.h), so jointed bodies are solved, and go to sleep, together
+//=========================================================================================================
+
+#ifndef _JOINTS_H_DEFINED_
+#define _JOINTS_H_DEFINED_
+
+#include "RigidBodies.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//===============
+// Joint Handle
+//===============
+
+struct JointHandle
+{
+	static constexpr uint32_t InvalidSlot = 0xFFFFFFFF;
+
+	uint32_t slot = InvalidSlot; // Position in the handle table, not the joint array
+	uint32_t generation = 0;     // Incremented each time the slot is freed
+
+	bool operator==(const JointHandle& h) const { return slot == h.slot && generation == h.generation; }
+	bool operator!=(const JointHandle& h) const { return !(*this == h); }
+};
+
+
+//===================
+// Joint Description
+//===================
+
+enum class JointType : uint8_t
+{
+	Ball,     // Anchors together, free to rotate
+	Hinge,    // Anchors together, rotates about the axis only
+	Slider,   // Moves along the axis only, no rotation
+	Distance, // Anchors kept at their distance apart, or within a range
+	Fixed,    // No relative movement
+};
+
+// Joint between two bodies in their current positions. Points and directions are world space, and are
+// fixed to the bodies from then on
+struct JointDesc
+{
+	JointType type = JointType::Ball;
+	BodyHandle bodyA;
+	BodyHandle bodyB;
+
+	Vector3f anchor = { 0, 0, 0 };  // The point the bodies are joined at. Distance: the point on A
+	Vector3f anchorB = { 0, 0, 0 }; // Distance only: the point on B
+	Vector3f axis = { 0, 1, 0 };    // Hinge: axis of rotation. Slider: direction of travel
+
+	// Hinge: angle in radians about the axis (-pi to pi) from the start. Slider: travel in metres along the
+	// axis from the start. Distance: the least and greatest distance, rather than the starting distance
+	bool limited = false;
+	float lower = 0;
+	float upper = 0;
+
+	// Hinge and slider: speed to aim for about / along the axis (radians/s or m/s), using at most the
+	// maximum torque / force (N m or N)
+	bool motor = false;
+	float motorSpeed = 0;
+	float maxMotorForce = 0;
+
+	// Contacts between the two bodies. Off by default, the shapes of neighbouring links usually overlap
+	bool collideConnected = false;
+};
+
+
+//=================
+// Stored Joint
+//=================
+
+struct Joint
+{
+	JointType type;
+	uint32_t bodyA; // Body handle slots
+	uint32_t bodyB;
+
+	// Body space
+	Vector3f localAnchorA;
+	Vector3f localAnchorB;
+	Vector3f localAxisA;      // Hinge, slider
+	Vector3f localAxisB;      // Hinge
+	Vector3f localReferenceA; // Hinge: perpendicular to the axis, the angle is measured between them
+	Vector3f localReferenceB;
+	Quaternionf rotationB;    // Slider, fixed: B's orientation relative to A's
+
+	float length; // Distance
+
+	bool limited;
+	float lower;
+	float upper;
+	bool motor;
+	float motorSpeed;
+	float maxMotorForce;
+	bool collideConnected;
+
+	// Accumulated over the solver iterations, kept for the next step's warm start
+	float blockImpulses[6];
+	float lowerImpulse;
+	float upperImpulse;
+	float motorImpulse;
+};
+
+// Joint from a description, given the array indices of its bodies
+Joint MakeJoint(const JointDesc& desc, const RigidBodies& bodies, std::size_t indexA, std::size_t indexB);
+
+// Hinge angle, slider travel or distance apart, which the limits apply to. Zero for ball and fixed
+float JointPosition(const Joint& joint, const RigidBodies& bodies);
+
+// How far the locked directions are from being satisfied: separation of the anchors in metres, and
+// misalignment in radians
+struct JointError
+{
+	float linear;
+	float angular;
+};
+JointError MeasureJointError(const Joint& joint, const RigidBodies& bodies);
+
+
+//=================
+// Joint Storage
+//=================
+
+// Joints packed in an array. Removing a joint moves the last joint into its place, handles stay valid
+class Joints
+{
+public:
+	JointHandle Add(const Joint& joint);
+
+	// Removing an invalid handle does nothing
+	void Remove(JointHandle handle);
+
+	bool IsValid(JointHandle handle) const
+	{
+		return handle.slot < mSlots.size() && mSlots[handle.slot].generation == handle.generation &&
+		       mSlots[handle.slot].index != JointHandle::InvalidSlot;
+	}
+
+	// Current array index of a joint. Handle must be valid
+	std::size_t Index(JointHandle handle) const { return mSlots[handle.slot].index; }
+
+	// Handle of the joint at an array index
+	JointHandle Handle(std::size_t index) const
+	{
+		const uint32_t slot = mSlotOfJoint[index];
+		return { slot, mSlots[slot].generation };
+	}
+
+	std::size_t Size() const { return joints.size(); }
+	bool Empty() const { return joints.empty(); }
+
+	// Public for the solver, which keeps the accumulated impulses in them. Add and remove through the above
+	std::vector<Joint> joints;
+
+private:
+	struct Slot
+	{
+		uint32_t index; // Array index of the joint using this slot, InvalidSlot if free
+		uint32_t generation;
+	};
+
+	std::vector<Slot> mSlots;
+	std::vector<uint32_t> mFreeSlots;
+	std::vector<uint32_t> mSlotOfJoint;
+};
+
+
+//=================
+// Solving
+//=================
+
+// One row of a joint, as ContactSolver's rows: relative velocity = linear . (vB - vA) + angularB . wB - angularA . wA
+struct JointRow
+{
+	Vector3f linear;
+	Vector3f angularA;
+	Vector3f angularB;
+	Vector3f turnA; // World inverse inertia * angularA
+	Vector3f turnB;
+	float effectiveMass; // Of the row on its own
+	float bias;          // Relative velocity the row aims for
+	float impulse;       // Accumulated
+	float low;           // Limits on the accumulated impulse
+	float high;
+};
+
+// A joint prepared for a step. Bodies are the solver's local slots
+struct JointConstraint
+{
+	static constexpr int MaxBlockRows = 6;
+	static constexpr int MaxSingleRows = 3; // Motor, lower and upper limit
+
+	uint32_t joint; // Index in the joint array, for storing the impulses
+	uint32_t bodyA;
+	uint32_t bodyB;
+	float inverseMassA;
+	float inverseMassB;
+
+	int blockRows;
+	int singleRows;
+	JointRow block[MaxBlockRows];
+	JointRow single[MaxSingleRows];
+	float factor[MaxBlockRows][MaxBlockRows]; // Lower triangle: Cholesky factor of the block's effective mass matrix, 1 / diagonal on the diagonal
+};
+
+// Rows, block factor and biases of a joint from the bodies' positions. Impulses are the joint's accumulated
+// ones if warm starting, otherwise zero
+void PrepareJoint(JointConstraint& constraint, const Joint& joint, const RigidBodies& bodies, std::size_t indexA, std::size_t indexB,
+                  float baumgarte, bool warmStarting, float timeStep);
+
+// Apply the accumulated impulses, before the first iteration
+void WarmStartJoint(const JointConstraint& constraint, Vector3f* linearVelocities, Vector3f* angularVelocities);
+
+// One iteration: the single rows, then the block all at once, or its rows one at a time if not block
+void SolveJoint(JointConstraint& constraint, Vector3f* linearVelocities, Vector3f* angularVelocities, bool block);
+
+// Accumulated impulses back to the joint for the next step
+void StoreJointImpulses(const JointConstraint& constraint, Joint& joint);
+
+#endif // !_JOINTS_H_DEFINED_
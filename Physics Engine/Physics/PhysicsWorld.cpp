@@ -0,0 +1,658 @@
+//=========================================================================================================
+// PhysicsWorld.cpp: Owns all the Rigid Bodies and Steps the Simulation
+//=========================================================================================================
+
+#include "PhysicsWorld.h"
+
+#include "Integrator.h"
+#include "ContactKernels.h"
+#include "TimeOfImpact.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace
+{
+	// Broadphase pairs collided per job
+	const std::size_t PairsPerJob = 256;
+
+	// Swept continuous collision bodies stop this fraction of the contact margin short of what they hit, so
+	// next step's contacts find it
+	const float SweepTargetMargin = 0.5f;
+
+	// Articulations stepped per job, each is a few passes over its links
+	const std::size_t ArticulationsPerJob = 4;
+
+	// Distance from the centre to the nearest surface, roughly. A body moving less than this in a step
+	// can't get more than halfway through anything, and the contacts push it back the way it came
+	float InnerRadius(const Shape& shape)
+	{
+		switch (shape.type)
+		{
+		case ShapeType::Box:
+			return std::min({ shape.halfExtents.x, shape.halfExtents.y, shape.halfExtents.z });
+
+		case ShapeType::ConvexHull:
+		{
+			float radius = FLT_MAX;
+			for (const Vector3f& axis : { Vector3f(1, 0, 0), Vector3f(0, 1, 0), Vector3f(0, 0, 1) })
+				radius = std::min({ radius, Dot(shape.SupportCore(axis), axis), -Dot(shape.SupportCore(-axis), axis) });
+			return radius;
+		}
+
+		default: // Sphere and Capsule
+			return shape.radius;
+		}
+	}
+}
+
+
+//=================
+// Constructors
+//=================
+
+PhysicsWorld::PhysicsWorld(const PhysicsSettings& settings)
+	: mSettings(settings), mJobs(std::make_unique<JobSystem>(settings.threadCount)),
+	  mFrameArena(std::make_unique<Arena>()), mScratchArenas(mJobs->ThreadCount()),
+	  mBroadphase(CreateBroadphase(settings.broadphase)), mSolver(settings.threadCount)
+{
+	mBroadphase->SetJobSystem(mJobs.get());
+	mSolver.SetJobSystem(mJobs.get());
+}
+
+
+//=================
+// Bodies
+//=================
+
+BodyHandle PhysicsWorld::CreateBody(const BodyDesc& desc)
+{
+	const BodyHandle handle = mBodies.Add(desc);
+	const std::size_t i = mBodies.Index(handle);
+	if (mBodies.boundingRadii[i] > 0)
+	{
+		mBodies.broadphaseProxies[i] = mBroadphase->CreateProxy(BoundingBox(i), handle.slot);
+	}
+	if (desc.continuousCollision)
+		mContinuous.push_back(handle.slot);
+	return handle;
+}
+
+void PhysicsWorld::DestroyBody(BodyHandle handle)
+{
+	if (!mBodies.IsValid(handle))
+		return;
+
+	for (std::size_t a = 0; a < mArticulations.Size(); ++a)
+	{
+		const Articulation& articulation = mArticulations.articulations[a];
+		for (std::size_t link = 0; link < articulation.LinkCount(); ++link)
+		{
+			if (articulation.LinkBody(link) == handle)
+			{
+				DestroyArticulation(mArticulations.Handle(a));
+				return;
+			}
+		}
+	}
+
+	WakeTouching(handle);
+	SetContinuousCollision(handle, false);
+	for (std::size_t k = mJoints.Size(); k-- > 0; )
+	{
+		if (mJoints.joints[k].bodyA == handle.slot || mJoints.joints[k].bodyB == handle.slot)
+			DestroyJoint(mJoints.Handle(k));
+	}
+
+	const uint32_t proxy = mBodies.broadphaseProxies[mBodies.Index(handle)];
+	if (proxy != Broadphase::NullProxy)
+		mBroadphase->DestroyProxy(proxy);
+	mBodies.Remove(handle);
+}
+
+AABB PhysicsWorld::BoundingBox(std::size_t index) const
+{
+	const Vector3f p = mBodies.positions.Get(index);
+	float r = mBodies.boundingRadii[index];
+	if (mBodies.hasShape[index])
+		r += mSettings.contactMargin;
+	return { p - Vector3f(r, r, r), p + Vector3f(r, r, r) };
+}
+
+
+//=================
+// Single Body
+//=================
+
+bool PhysicsWorld::HasContinuousCollision(BodyHandle body) const
+{
+	return std::find(mContinuous.begin(), mContinuous.end(), body.slot) != mContinuous.end();
+}
+
+void PhysicsWorld::SetContinuousCollision(BodyHandle body, bool continuous)
+{
+	auto found = std::find(mContinuous.begin(), mContinuous.end(), body.slot);
+	if (continuous && found == mContinuous.end())
+		mContinuous.push_back(body.slot);
+	else if (!continuous && found != mContinuous.end())
+		mContinuous.erase(found);
+}
+
+void PhysicsWorld::AddForce(BodyHandle body, const Vector3f& force)
+{
+	const std::size_t i = WokenIndex(body);
+	mBodies.forces.Set(i, mBodies.forces.Get(i) + force);
+}
+
+void PhysicsWorld::AddTorque(BodyHandle body, const Vector3f& torque)
+{
+	const std::size_t i = WokenIndex(body);
+	mBodies.torques.Set(i, mBodies.torques.Get(i) + torque);
+}
+
+void PhysicsWorld::AddForceAtPoint(BodyHandle body, const Vector3f& force, const Vector3f& point)
+{
+	const std::size_t i = WokenIndex(body);
+	mBodies.forces.Set(i, mBodies.forces.Get(i) + force);
+	mBodies.torques.Set(i, mBodies.torques.Get(i) + Cross(point - mBodies.positions.Get(i), force));
+}
+
+
+//=================
+// Joints
+//=================
+
+// Both bodies are woken first, a joint must not join an awake body to a sleeping one (Islands.h)
+JointHandle PhysicsWorld::CreateJoint(const JointDesc& desc)
+{
+	mSleeping.Wake(mBodies, mBodies.Index(desc.bodyA));
+	mSleeping.Wake(mBodies, mBodies.Index(desc.bodyB));
+	const Joint joint = MakeJoint(desc, mBodies, mBodies.Index(desc.bodyA), mBodies.Index(desc.bodyB));
+	if (!joint.collideConnected)
+		++mJointPairs[PairKey(joint.bodyA, joint.bodyB)];
+	return mJoints.Add(joint);
+}
+
+// The bodies are woken too, without the joint they may no longer be one island
+void PhysicsWorld::DestroyJoint(JointHandle handle)
+{
+	if (!mJoints.IsValid(handle))
+		return;
+
+	const Joint& joint = mJoints.joints[mJoints.Index(handle)];
+	mSleeping.Wake(mBodies, mBodies.SlotIndex(joint.bodyA));
+	mSleeping.Wake(mBodies, mBodies.SlotIndex(joint.bodyB));
+	if (!joint.collideConnected)
+	{
+		auto found = mJointPairs.find(PairKey(joint.bodyA, joint.bodyB));
+		if (--found->second == 0)
+			mJointPairs.erase(found);
+	}
+	mJoints.Remove(handle);
+}
+
+void PhysicsWorld::SetJointMotor(JointHandle handle, float speed, float maxForce)
+{
+	Joint& joint = mJoints.joints[mJoints.Index(handle)];
+	joint.motor = joint.type == JointType::Hinge || joint.type == JointType::Slider;
+	joint.motorSpeed = speed;
+	joint.maxMotorForce = maxForce;
+	mSleeping.Wake(mBodies, mBodies.SlotIndex(joint.bodyA));
+	mSleeping.Wake(mBodies, mBodies.SlotIndex(joint.bodyB));
+}
+
+bool PhysicsWorld::Collides(uint32_t slotA, uint32_t slotB) const
+{
+	return mJointPairs.empty() || mJointPairs.find(PairKey(slotA, slotB)) == mJointPairs.end();
+}
+
+
+//=================
+// Articulations
+//=================
+
+ArticulationHandle PhysicsWorld::CreateArticulation(const ArticulationDesc& desc)
+{
+	std::vector<BodyHandle> linkBodies;
+	linkBodies.reserve(desc.links.size());
+	for (const ArticulationLinkDesc& link : desc.links)
+		linkBodies.push_back(CreateBody(link.body));
+	for (std::size_t i = 1; i < desc.links.size(); ++i)
+		++mJointPairs[PairKey(linkBodies[i].slot, linkBodies[desc.links[i].parent].slot)];
+	return mArticulations.Add(Articulation(desc, linkBodies));
+}
+
+void PhysicsWorld::DestroyArticulation(ArticulationHandle handle)
+{
+	if (!mArticulations.IsValid(handle))
+		return;
+
+	const Articulation& articulation = mArticulations.articulations[mArticulations.Index(handle)];
+	std::vector<BodyHandle> linkBodies;
+	for (std::size_t i = 0; i < articulation.LinkCount(); ++i)
+	{
+		linkBodies.push_back(articulation.LinkBody(i));
+		if (articulation.Parent(i) < 0)
+			continue;
+		auto found = mJointPairs.find(PairKey(articulation.LinkBody(i).slot, articulation.LinkBody(articulation.Parent(i)).slot));
+		if (--found->second == 0)
+			mJointPairs.erase(found);
+	}
+	mArticulations.Remove(handle);
+	for (BodyHandle body : linkBodies)
+		DestroyBody(body);
+}
+
+void PhysicsWorld::SetArticulationDrive(ArticulationHandle handle, std::size_t link, float stiffness, float damping, float target, float targetSpeed)
+{
+	mArticulations.articulations[mArticulations.Index(handle)].SetDrive(link, stiffness, damping, target, targetSpeed);
+}
+
+template<typename F> void PhysicsWorld::ForEachArticulation(F&& function)
+{
+	mJobs->ParallelFor(mArticulations.Size(), ArticulationsPerJob, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t a = begin; a < end; ++a)
+			function(mArticulations.articulations[a]);
+	});
+}
+
+
+//=================
+// Simulation
+//=================
+
+// Contacts are found from the pairs at the end of the last step, which still match the body positions
+// Articulations find their own velocities, the link bodies carry them through the solve and take the
+// articulation's positions once it has moved
+void PhysicsWorld::Step(float timeStep)
+{
+	mFrameArena->Reset();
+	mScratchArenas.Reset();
+
+	UpdateContacts();
+	mContinuousStarts.resize(mContinuous.size());
+	for (std::size_t k = 0; k < mContinuous.size(); ++k)
+		mContinuousStarts[k] = mBodies.positions.Get(mBodies.SlotIndex(mContinuous[k]));
+	ForEachArticulation([&](Articulation& articulation) { articulation.UpdateVelocities(mBodies, mSettings.gravity, timeStep); });
+	mArticulationStats = {};
+	if (mContacts.Size() == 0 && mJoints.Empty())
+	{
+		Integrate(mBodies, mSettings.gravity, timeStep, mJobs.get());
+	}
+	else
+	{
+		IntegrateVelocities(mBodies, mSettings.gravity, timeStep, mJobs.get());
+		ForEachArticulation([&](Articulation& articulation) { articulation.VelocitiesToBodies(mBodies); });
+		mSolver.BuildIslands(mBodies, mContacts.Manifolds(), mJoints.joints, StepArena());
+		const int passes = FindArticulationIslands() ? std::max(mSettings.articulationPasses, 1) : 1;
+		if (passes > 1)
+		{
+			mArticulationStats.passes = passes - 1;
+			mArticulationStats.islands = mArticulationIslands.size();
+			for (const uint32_t island : mArticulationIslands)
+				mArticulationStats.bodies += mSolver.LastIslands().BodyCount(island);
+			mSolveStartLinear.Resize(mBodies.Size());
+			mSolveStartAngular.Resize(mBodies.Size());
+			for (const uint32_t i : mArticulationBodies)
+			{
+				mSolveStartLinear.Set(i, mBodies.linearVelocities.Get(i));
+				mSolveStartAngular.Set(i, mBodies.angularVelocities.Get(i));
+			}
+		}
+		mSolver.SolveIslands(mBodies, mContacts.Manifolds(), mJoints.joints, mSettings.solver, timeStep);
+		ForEachArticulation([&](Articulation& articulation) { articulation.ImpulsesFromBodies(mBodies); });
+		for (int pass = 1; pass < passes; ++pass)
+		{
+			ForEachArticulation([&](Articulation& articulation) { articulation.RewindBodies(mBodies, mSolveStartLinear, mSolveStartAngular); });
+			for (const uint32_t i : mArticulationBodies)
+			{
+				mBodies.linearVelocities.Set(i, mSolveStartLinear.Get(i));
+				mBodies.angularVelocities.Set(i, mSolveStartAngular.Get(i));
+			}
+			mSolver.SolveIslands(mBodies, mContacts.Manifolds(), mJoints.joints, mArticulationIslands.data(), mArticulationIslands.size(),
+			                     mSettings.solver, timeStep);
+			ForEachArticulation([&](Articulation& articulation) { articulation.ImpulsesFromBodies(mBodies); });
+		}
+		IntegratePositions(mBodies, timeStep, mJobs.get());
+	}
+	ForEachArticulation([&](Articulation& articulation) { articulation.UpdatePositions(mBodies, timeStep); });
+	SweepContinuous(timeStep);
+	UpdateBroadphase(timeStep);
+	if (mSettings.allowSleeping)
+		UpdateSleep(timeStep);
+}
+
+// The islands of the last build with link bodies in, and the bodies the articulation passes rewind: theirs,
+// and every link body, as an articulation moves all its links for an impulse on any. False if there are none
+bool PhysicsWorld::FindArticulationIslands()
+{
+	mArticulationIslands.clear();
+	mArticulationBodies.clear();
+	const Islands& islands = mSolver.LastIslands();
+	for (const Articulation& articulation : mArticulations.articulations)
+	{
+		for (std::size_t link = 0; link < articulation.LinkCount(); ++link)
+		{
+			const std::size_t i = mBodies.Index(articulation.LinkBody(link));
+			mArticulationBodies.push_back(static_cast<uint32_t>(i));
+			if (islands.IslandOf(i) != Islands::NoIsland)
+				mArticulationIslands.push_back(islands.IslandOf(i));
+		}
+	}
+	if (mArticulationIslands.empty())
+		return false;
+
+	std::sort(mArticulationIslands.begin(), mArticulationIslands.end());
+	mArticulationIslands.erase(std::unique(mArticulationIslands.begin(), mArticulationIslands.end()), mArticulationIslands.end());
+	for (const uint32_t island : mArticulationIslands)
+		mArticulationBodies.insert(mArticulationBodies.end(), islands.Bodies(island), islands.Bodies(island) + islands.BodyCount(island));
+	return true;
+}
+
+void PhysicsWorld::SetSettings(const PhysicsSettings& settings)
+{
+	const bool newBroadphase = settings.broadphase != mSettings.broadphase;
+	mSettings = settings;
+	mJobs->SetThreadCount(settings.threadCount);
+	mScratchArenas.SetThreadCount(mJobs->ThreadCount());
+	mSolver.SetThreadCount(settings.threadCount);
+	if (!settings.allowSleeping)
+		mSleeping.WakeAll(mBodies);
+	if (!newBroadphase)
+		return;
+
+	mBroadphase = CreateBroadphase(settings.broadphase);
+	mBroadphase->SetJobSystem(mJobs.get());
+	mPairs.clear();
+	for (std::size_t i = 0; i < mBodies.Size(); ++i)
+	{
+		if (mBodies.broadphaseProxies[i] != Broadphase::NullProxy)
+			mBodies.broadphaseProxies[i] = mBroadphase->CreateProxy(BoundingBox(i), mBodies.Handle(i).slot);
+	}
+}
+
+
+//=================
+// Broadphase
+//=================
+
+// Move every awake body's proxy to its new position, then find the overlapping pairs. Sleeping bodies
+// haven't moved
+void PhysicsWorld::UpdateBroadphase(float timeStep)
+{
+	if (mBroadphase->ProxyCount() == 0)
+	{
+		mPairs.clear();
+		return;
+	}
+
+	for (std::size_t i = 0; i < mBodies.AwakeCount(); ++i)
+	{
+		const uint32_t proxy = mBodies.broadphaseProxies[i];
+		if (proxy != Broadphase::NullProxy)
+			mBroadphase->MoveProxy(proxy, BoundingBox(i), mBodies.linearVelocities.Get(i) * timeStep);
+	}
+	mBroadphase->FindPairs(mPairs);
+}
+
+
+//=================
+// Contacts
+//=================
+
+// Collide each broadphase pair with shapes and at least one dynamic body, keeping the contacts in the cache
+// Pairs where neither body can move (asleep, or static without velocity) keep last step's manifold. A moving
+// body touching a sleeping one wakes its island
+// The pairs are collided as jobs, each into its own slot, then added to the cache in pair order. Waking an
+// island can make a still pair movable, those are collided again in the second pass
+// Only touching pairs keep a contact, taken from the colliding thread's scratch arena
+void PhysicsWorld::UpdateContacts()
+{
+	ArenaVector<CollidedPair> collided(mPairs.size(), CollidedPair(), ArenaAllocator<CollidedPair>(StepArena()));
+	mJobs->ParallelFor(mPairs.size(), PairsPerJob, [&](std::size_t begin, std::size_t end)
+	{
+		ArenaAllocator<Contact> allocator(ThreadScratchArena());
+		for (std::size_t k = begin; k < end; ++k)
+		{
+			Contact contact;
+			collided[k].result = CollidePair(mPairs[k], contact);
+			collided[k].contact = nullptr;
+			if (collided[k].result == PairResult::Touching)
+				collided[k].contact = new (allocator.allocate(1)) Contact(contact);
+		}
+	});
+
+	// Frees the contacts when they came from the global allocator, arena contacts go at the next Reset
+	ArenaAllocator<Contact> contacts(StepArena());
+
+	mContacts.BeginStep();
+	for (std::size_t k = 0; k < mPairs.size(); ++k)
+	{
+		const BroadphasePair& pair = mPairs[k];
+		PairResult result = collided[k].result;
+		Contact contact;
+		if (result == PairResult::Still)
+			result = CollidePair(pair, contact);
+
+		if (result == PairResult::Still)
+		{
+			mContacts.Keep(pair.a, pair.b);
+		}
+		else if (result == PairResult::Touching)
+		{
+			// Waking one body's island can move the other body in the arrays
+			mSleeping.Wake(mBodies, mBodies.SlotIndex(pair.a));
+			mSleeping.Wake(mBodies, mBodies.SlotIndex(pair.b));
+			mContacts.Add(pair.a, pair.b, collided[k].contact ? *collided[k].contact : contact, mSettings.solver.warmStarting);
+		}
+		if (collided[k].contact)
+			contacts.deallocate(collided[k].contact, 1);
+	}
+}
+
+PhysicsWorld::PairResult PhysicsWorld::CollidePair(const BroadphasePair& pair, Contact& contact) const
+{
+	// Skip bodies destroyed since the pairs were found
+	const std::size_t a = mBodies.SlotIndex(pair.a);
+	const std::size_t b = mBodies.SlotIndex(pair.b);
+	if (a >= mBodies.Size() || b >= mBodies.Size() || !mBodies.hasShape[a] || !mBodies.hasShape[b])
+		return PairResult::None;
+	if ((mBodies.inverseMasses[a] == 0 && mBodies.inverseMasses[b] == 0) || !Collides(pair.a, pair.b))
+		return PairResult::None;
+
+	auto isStill = [&](std::size_t i)
+	{
+		return !mBodies.IsAwake(i) || (mBodies.inverseMasses[i] == 0 && mBodies.linearVelocities.Get(i).LengthSq() == 0 &&
+		                               mBodies.angularVelocities.Get(i).LengthSq() == 0);
+	};
+	if (isStill(a) && isStill(b))
+		return PairResult::Still;
+
+	const bool touching = Collide(mBodies.shapes[a], mBodies.BodyTransform(a), mBodies.shapes[b], mBodies.BodyTransform(b), contact, nullptr,
+	                              mSettings.contactMargin);
+	return touching ? PairResult::Touching : PairResult::None;
+}
+
+void PhysicsWorld::WakeTouching(BodyHandle body)
+{
+	mSleeping.Wake(mBodies, mBodies.Index(body));
+	for (const ContactManifold& manifold : mContacts.Manifolds())
+	{
+		if (manifold.bodyA == body.slot || manifold.bodyB == body.slot)
+		{
+			const uint32_t other = manifold.bodyA == body.slot ? manifold.bodyB : manifold.bodyA;
+			if (mBodies.SlotIndex(other) < mBodies.Size())
+				mSleeping.Wake(mBodies, mBodies.SlotIndex(other));
+		}
+	}
+}
+
+
+//=================
+// Sleeping
+//=================
+
+// Count up how long each awake body has been slow, then put to sleep each island whose bodies have all been
+// slow for long enough, unless it rests on a moving static body. Bodies without contacts sleep on their own
+void PhysicsWorld::UpdateSleep(float timeStep)
+{
+	const float linearSq = mSettings.sleepLinearVelocity * mSettings.sleepLinearVelocity;
+	const float angularSq = mSettings.sleepAngularVelocity * mSettings.sleepAngularVelocity;
+	for (std::size_t i = 0; i < mBodies.AwakeCount(); ++i)
+	{
+		if (mBodies.inverseMasses[i] == 0)
+			continue;
+		const bool slow = mBodies.linearVelocities.Get(i).LengthSq() < linearSq && mBodies.angularVelocities.Get(i).LengthSq() < angularSq;
+		mBodies.sleepTimes[i] = slow ? mBodies.sleepTimes[i] + timeStep : 0;
+	}
+	for (const Articulation& articulation : mArticulations.articulations)
+	{
+		for (std::size_t link = 0; link < articulation.LinkCount(); ++link)
+			mBodies.sleepTimes[mBodies.Index(articulation.LinkBody(link))] = 0;
+	}
+
+	// Handle slots of the bodies of islands going to sleep, and the index of each island's first plus the end
+	Arena* arena = StepArena();
+	ArenaVector<uint32_t> fallingAsleep{ ArenaAllocator<uint32_t>(arena) };
+	ArenaVector<uint32_t> fallingAsleepStarts{ ArenaAllocator<uint32_t>(arena) };
+	fallingAsleep.reserve(mBodies.AwakeCount());
+	fallingAsleepStarts.reserve(mBodies.AwakeCount() + 1);
+	fallingAsleepStarts.push_back(0);
+
+	// A static body the island rests on or is joined to must be still too
+	auto isStill = [&](uint32_t slot)
+	{
+		const std::size_t i = mBodies.SlotIndex(slot);
+		return mBodies.inverseMasses[i] != 0 || (mBodies.linearVelocities.Get(i).LengthSq() == 0 && mBodies.angularVelocities.Get(i).LengthSq() == 0);
+	};
+
+	// The islands were found by this step's solve, before any body changed places
+	const Islands* islands = mContacts.Size() != 0 || !mJoints.Empty() ? &mSolver.LastIslands() : nullptr;
+	for (std::size_t island = 0; islands && island < islands->Count(); ++island)
+	{
+		bool sleepy = true;
+		for (std::size_t k = 0; k < islands->BodyCount(island) && sleepy; ++k)
+			sleepy = mBodies.sleepTimes[islands->Bodies(island)[k]] >= mSettings.timeToSleep;
+		for (std::size_t k = 0; k < islands->ManifoldCount(island) && sleepy; ++k)
+		{
+			const ContactManifold& manifold = mContacts.Manifolds()[islands->Manifolds(island)[k]];
+			sleepy = isStill(manifold.bodyA) && isStill(manifold.bodyB);
+		}
+		for (std::size_t k = 0; k < islands->JointCount(island) && sleepy; ++k)
+		{
+			const Joint& joint = mJoints.joints[islands->JointIndices(island)[k]];
+			sleepy = isStill(joint.bodyA) && isStill(joint.bodyB);
+		}
+
+		if (sleepy)
+		{
+			for (std::size_t k = 0; k < islands->BodyCount(island); ++k)
+				fallingAsleep.push_back(mBodies.Handle(islands->Bodies(island)[k]).slot);
+			fallingAsleepStarts.push_back(static_cast<uint32_t>(fallingAsleep.size()));
+		}
+	}
+
+	for (std::size_t i = 0; i < mBodies.AwakeCount(); ++i)
+	{
+		if (mBodies.inverseMasses[i] != 0 && mBodies.sleepTimes[i] >= mSettings.timeToSleep &&
+		    (!islands || islands->IslandOf(i) == Islands::NoIsland))
+		{
+			fallingAsleep.push_back(mBodies.Handle(i).slot);
+			fallingAsleepStarts.push_back(static_cast<uint32_t>(fallingAsleep.size()));
+		}
+	}
+
+	for (std::size_t k = 0; k + 1 < fallingAsleepStarts.size(); ++k)
+		mSleeping.Sleep(mBodies, fallingAsleep.data() + fallingAsleepStarts[k], fallingAsleepStarts[k + 1] - fallingAsleepStarts[k]);
+}
+
+
+//=================
+// Continuous
+//=================
+
+// Sweep each continuous collision body that moved far enough from where it started the step to where it
+// ended up, against the bodies whose broadphase boxes (from the end of the last step) are near its path
+// At the first impact the body stops, its velocity is corrected against the body it hit, and it sweeps on
+// with the new velocity for the rest of the step. The body it hit moves on with its own new velocity too
+void PhysicsWorld::SweepContinuous(float timeStep)
+{
+	mContinuousStats = {};
+	const float target = mSettings.contactMargin * SweepTargetMargin;
+	for (std::size_t k = 0; k < mContinuous.size(); ++k)
+	{
+		const uint32_t slot = mContinuous[k];
+		std::size_t i = mBodies.SlotIndex(slot);
+		if (!mBodies.IsAwake(i) || !mBodies.hasShape[i])
+			continue;
+
+		const Shape& shape = mBodies.shapes[i];
+		Vector3f start = mContinuousStarts[k];
+		Vector3f displacement = mBodies.positions.Get(i) - start;
+		const float innerRadius = InnerRadius(shape);
+		if (displacement.LengthSq() <= innerRadius * innerRadius)
+			continue;
+		++mContinuousStats.swept;
+
+		const Quaternionf rotation = mBodies.Orientation(i);
+		const AABB path = Union(shape.BoundingBox({ start, rotation }), shape.BoundingBox({ start + displacement, rotation }));
+		mBroadphase->FindOverlaps(path.Expanded(mSettings.contactMargin), mSweepNear);
+
+		float remaining = 1; // Fraction of the step still to move
+		for (int impacts = 0; ; ++impacts)
+		{
+			TimeOfImpactResult first = { false, 1, { 0, 0, 0 }, { 0, 0, 0 }, 0 };
+			uint32_t firstSlot = 0;
+			for (uint32_t other : mSweepNear)
+			{
+				const std::size_t j = mBodies.SlotIndex(other);
+				if (other == slot || !mBodies.hasShape[j] || !Collides(slot, other))
+					continue;
+				const TimeOfImpactResult hit = TimeOfImpact(shape, { start, rotation }, displacement, mBodies.shapes[j], mBodies.BodyTransform(j), target);
+				if (hit.hit && hit.time < first.time)
+				{
+					first = hit;
+					firstSlot = other;
+				}
+			}
+
+			if (!first.hit)
+			{
+				start += displacement;
+				break;
+			}
+			start += displacement * first.time;
+			++mContinuousStats.impacts;
+			if (impacts == mSettings.maxContinuousImpacts)
+				break;
+
+			// Waking what it hit can move this body in the arrays
+			mSleeping.Wake(mBodies, mBodies.SlotIndex(firstSlot));
+			i = mBodies.SlotIndex(slot);
+			remaining *= 1 - first.time;
+			Impact(i, mBodies.SlotIndex(firstSlot), first.normal, timeStep * remaining);
+			displacement = mBodies.linearVelocities.Get(i) * (timeStep * remaining);
+		}
+		mBodies.positions.Set(mBodies.SlotIndex(slot), start);
+	}
+}
+
+// Take away body i's speed towards body j along the normal (i to j), bouncing by the restitution if it hit
+// fast enough. The impulse is through the centres of mass, the contacts of the next step sort out the spin
+// Body j was integrated with its old velocity, the change applies for the rest of the step
+void PhysicsWorld::Impact(std::size_t i, std::size_t j, const Vector3f& normal, float remainingTime)
+{
+	const Vector3f velocityI = mBodies.linearVelocities.Get(i);
+	const Vector3f velocityJ = mBodies.linearVelocities.Get(j);
+	const float approach = Dot(velocityI - velocityJ, normal);
+	const float inverseMassSum = mBodies.inverseMasses[i] + mBodies.inverseMasses[j];
+	if (approach <= 0 || inverseMassSum == 0)
+		return;
+
+	const float restitution = approach > mSettings.solver.restitutionThreshold ? mSettings.solver.restitution : 0;
+	const float impulse = (1 + restitution) * approach / inverseMassSum;
+	mBodies.linearVelocities.Set(i, velocityI - normal * (impulse * mBodies.inverseMasses[i]));
+	mBodies.linearVelocities.Set(j, velocityJ + normal * (impulse * mBodies.inverseMasses[j]));
+	mBodies.positions.Set(j, mBodies.positions.Get(j) + normal * (impulse * mBodies.inverseMasses[j] * remainingTime));
+}
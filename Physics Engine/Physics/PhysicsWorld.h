@@ -0,0 +1,325 @@
+//=========================================================================================================
+// PhysicsWorld.h: Owns all the Rigid Bodies and Steps the Simulation
+// - Bodies are created and referred to by BodyHandle (see RigidBodies.h)
+// - Step is the function to pass to CSimulationHost, it is called once per fixed (sub)step
+// - Bodies with a bounding radius are put in the broadphase, which finds the pairs whose boxes overlap
+//   at the end of each step. The broadphase type is chosen per scene in PhysicsSettings
+// - Bodies with a shape get contacts: each step the broadphase pairs are collided (ContactKernels.h), the
+//   contacts kept in the contact cache so their impulses carry over, and the contact solver corrects the
+//   velocities between the velocity and position halves of integration. Separate islands of touching
+//   bodies are solved on worker threads (Islands.h)
+// - The world's job system (JobSystem.h) runs every stage of the step: the broadphase sweep, colliding the
+//   pairs, solving the islands and integrating. Contacts are collided in parallel but added to the cache
+//   in pair order, so the results are the same on any number of threads
+// - Islands that have been resting for a while go to sleep: their bodies aren't integrated, solved or
+//   moved in the broadphase, and their contacts are kept as they are rather than collided again. They
+//   wake when an awake or moving body touches them, or when one of their bodies is changed or destroyed
+// - Joints (Joints.h) hold pairs of bodies together. They are solved with the contacts and join their
+//   bodies' islands, so jointed bodies sleep and wake together. The bodies of a joint don't collide unless
+//   the joint asks for it
+// - Bodies flagged for continuous collision are swept along their path after integration whenever they
+//   move further than about half their thickness. The bodies near the path come from the broadphase, the
+//   first impact from conservative advancement (TimeOfImpact.h). The body is stopped there, its velocity
+//   corrected against the body it hit, and it moves on for the rest of the step, up to a few impacts.
+//   Only the flagged bodies are swept, so the cost is in proportion to them rather than the world
+// - The step's temporaries (collided pairs and their contacts, island sorting, islands falling asleep) come
+//   from arenas (Arena.h) reset at the start of each step: a frame arena for the calling thread, and a
+//   scratch arena for each job thread so the collision jobs don't contend over the global allocator
+// - Articulations (Articulation.h) are chains and trees of links in reduced coordinates. Their links have
+//   bodies for contacts and joints, which the world moves to match the articulation after each step. The
+//   solver's changes to a link body's velocity go back into the articulation as an impulse, over a few
+//   passes of the solver that only go over the islands with link bodies in. Link bodies never sleep, and a
+//   link doesn't collide with its parent
+//=========================================================================================================
+
+#ifndef _PHYSICS_WORLD_H_DEFINED_
+#define _PHYSICS_WORLD_H_DEFINED_
+
+#include "RigidBodies.h"
+#include "Broadphase.h"
+#include "ContactCache.h"
+#include "ContactSolver.h"
+#include "Islands.h"
+#include "Joints.h"
+#include "Articulation.h"
+#include "JobSystem.h"
+#include "Arena.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+struct PhysicsSettings
+{
+	Vector3f gravity = { 0, -9.81f, 0 };
+
+	// DynamicTree for mostly static scenes, SweepAndPrune when most bodies move every step
+	BroadphaseType broadphase = BroadphaseType::DynamicTree;
+
+	// Shapes further apart than this have no contact. A small margin lets the solver stop bodies at the
+	// surface rather than after they overlap
+	float contactMargin = 0.02f;
+
+	ContactSolverSettings solver;
+
+	// Threads of the job system that runs the step, 0 for one per hardware thread
+	unsigned int threadCount = 0;
+
+	// Take the step's temporaries from the world's arenas, or from the global allocator each step
+	bool useArenas = true;
+
+	// Passes of the contact solver over the islands with link bodies in. The solver takes link bodies as free
+	// bodies, so moves them too easily and other bodies too little. After each pass the articulation takes
+	// the impulses on its links and the next pass carries on from the articulation's velocities. Islands
+	// without link bodies are solved once, and there are no more passes while no link touches anything
+	int articulationPasses = 4;
+
+	// Impacts a continuous collision body can have in one step, each followed by a sub-step for the rest
+	// of its movement. After the last the body waits at the impact for the contacts of the next step
+	int maxContinuousImpacts = 4;
+
+	// An island sleeps once all its bodies have moved slower than these for timeToSleep
+	bool allowSleeping = true;
+	float sleepLinearVelocity = 0.05f;  // m/s
+	float sleepAngularVelocity = 0.05f; // radians/s
+	float timeToSleep = 0.5f;           // seconds
+};
+
+class PhysicsWorld
+{
+public:
+	//================
+	// Constructors
+	//================
+
+	explicit PhysicsWorld(const PhysicsSettings& settings = PhysicsSettings());
+
+	//=================
+	// Bodies
+	//=================
+
+	BodyHandle CreateBody(const BodyDesc& desc);
+
+	// Destroying an invalid handle does nothing
+	void DestroyBody(BodyHandle handle);
+
+	bool IsValid(BodyHandle handle) const { return mBodies.IsValid(handle); }
+	std::size_t BodyCount() const { return mBodies.Size(); }
+
+	// Direct access to the body arrays for passes over all bodies. Add and remove bodies through the world
+	RigidBodies& Bodies() { return mBodies; }
+	const RigidBodies& Bodies() const { return mBodies; }
+
+	//=================
+	// Single Body
+	//=================
+	// Handles must be valid
+
+	Vector3f Position(BodyHandle body) const { return mBodies.positions.Get(mBodies.Index(body)); }
+	void SetPosition(BodyHandle body, const Vector3f& p) { mBodies.positions.Set(WokenIndex(body), p); }
+
+	Quaternionf Orientation(BodyHandle body) const { return mBodies.Orientation(mBodies.Index(body)); }
+	void SetOrientation(BodyHandle body, const Quaternionf& q) { mBodies.SetOrientation(WokenIndex(body), Normalise(q)); }
+
+	Vector3f LinearVelocity(BodyHandle body) const { return mBodies.linearVelocities.Get(mBodies.Index(body)); }
+	void SetLinearVelocity(BodyHandle body, const Vector3f& v) { mBodies.linearVelocities.Set(WokenIndex(body), v); }
+
+	Vector3f AngularVelocity(BodyHandle body) const { return mBodies.angularVelocities.Get(mBodies.Index(body)); }
+	void SetAngularVelocity(BodyHandle body, const Vector3f& w) { mBodies.angularVelocities.Set(WokenIndex(body), w); }
+
+	Transformf BodyTransform(BodyHandle body) const { return mBodies.BodyTransform(mBodies.Index(body)); }
+
+	// World matrix for rendering
+	Matrix4x4f WorldMatrix(BodyHandle body) const { return BodyTransform(body).ToMatrix(); }
+
+	// Setting any of the above or adding forces wakes a sleeping body's island
+	bool IsAwake(BodyHandle body) const { return mBodies.IsAwake(mBodies.Index(body)); }
+	void WakeBody(BodyHandle body) { mSleeping.Wake(mBodies, mBodies.Index(body)); }
+
+	// Sweep the body's path each step (BodyDesc::continuousCollision)
+	bool HasContinuousCollision(BodyHandle body) const;
+	void SetContinuousCollision(BodyHandle body, bool continuous);
+
+	// Forces / torques act for the next step only
+	void AddForce(BodyHandle body, const Vector3f& force);
+	void AddTorque(BodyHandle body, const Vector3f& torque);
+
+	// Force applied at a world space point, also gives a torque around the centre of mass
+	void AddForceAtPoint(BodyHandle body, const Vector3f& force, const Vector3f& point);
+
+	//=================
+	// Joints
+	//=================
+
+	// Join two bodies as they are now (see JointDesc). The handles must be valid and different, and at
+	// least one of the bodies dynamic. Wakes both bodies
+	JointHandle CreateJoint(const JointDesc& desc);
+
+	// Destroying an invalid handle does nothing. Destroying a body destroys its joints
+	void DestroyJoint(JointHandle joint);
+
+	bool IsValid(JointHandle joint) const { return mJoints.IsValid(joint); }
+	std::size_t JointCount() const { return mJoints.Size(); }
+
+	// The joints with their impulses from the last step. Body ids are handle slots
+	const Joints& AllJoints() const { return mJoints; }
+
+	// Hinge angle, slider travel or distance apart, and how far the joint is from holding (Joints.h)
+	float JointPosition(JointHandle joint) const { return ::JointPosition(mJoints.joints[mJoints.Index(joint)], mBodies); }
+	JointError MeasureJointError(JointHandle joint) const { return ::MeasureJointError(mJoints.joints[mJoints.Index(joint)], mBodies); }
+
+	// Turn on or change a hinge or slider's motor. Wakes the bodies
+	void SetJointMotor(JointHandle joint, float speed, float maxForce);
+
+	//=================
+	// Articulations
+	//=================
+
+	// Create the link bodies and join them as the description says. The links must be dynamic
+	ArticulationHandle CreateArticulation(const ArticulationDesc& desc);
+
+	// Destroys the link bodies too. Destroying an invalid handle does nothing, destroying a link body
+	// destroys its articulation
+	void DestroyArticulation(ArticulationHandle articulation);
+
+	bool IsValid(ArticulationHandle articulation) const { return mArticulations.IsValid(articulation); }
+	std::size_t ArticulationCount() const { return mArticulations.Size(); }
+
+	// Handle must be valid. Links are in the order of the description
+	const Articulation& GetArticulation(ArticulationHandle articulation) const { return mArticulations.articulations[mArticulations.Index(articulation)]; }
+	BodyHandle ArticulationLinkBody(ArticulationHandle articulation, std::size_t link) const { return GetArticulation(articulation).LinkBody(link); }
+
+	// Hinge angle or slider travel from the start, and its rate
+	float ArticulationJointPosition(ArticulationHandle articulation, std::size_t link) const { return GetArticulation(articulation).JointPosition(link); }
+	float ArticulationJointSpeed(ArticulationHandle articulation, std::size_t link) const { return GetArticulation(articulation).JointSpeed(link); }
+
+	// Change a hinge or slider's drive (ArticulationLinkDesc)
+	void SetArticulationDrive(ArticulationHandle articulation, std::size_t link, float stiffness, float damping, float target, float targetSpeed);
+
+	//=================
+	// Simulation
+	//=================
+
+	void Step(float timeStep);
+
+	// Pairs of bodies whose broadphase boxes overlapped at the end of the last step
+	// Values are body handle slots, use Bodies().SlotIndex to get the array index
+	const std::vector<BroadphasePair>& BroadphasePairs() const { return mPairs; }
+
+	// Contact manifolds of the last step with the impulses the solver applied. Body ids are handle slots
+	const ContactCache& Contacts() const { return mContacts; }
+
+	// Continuous collision in the last step
+	struct ContinuousStats
+	{
+		std::size_t swept = 0;   // Bodies that moved far enough to be swept
+		std::size_t impacts = 0;
+	};
+	const ContinuousStats& LastContinuousStats() const { return mContinuousStats; }
+
+	// Articulation passes in the last step, after the first solve of every island
+	struct ArticulationStats
+	{
+		std::size_t passes = 0;  // 0 while no link touches anything
+		std::size_t islands = 0; // Islands with link bodies in, solved again by each pass
+		std::size_t bodies = 0;  // Bodies in them
+	};
+	const ArticulationStats& LastArticulationStats() const { return mArticulationStats; }
+
+	const PhysicsSettings& Settings() const { return mSettings; }
+
+	// Job system the step runs on. Other work can be submitted to it between steps
+	JobSystem& Jobs() { return *mJobs; }
+
+	// Arenas of the step's temporaries, their stats show what the last step used
+	const Arena& FrameArena() const { return *mFrameArena; }
+	const ThreadArenas& ScratchArenas() const { return mScratchArenas; }
+
+	// Islands of contacts and joints of the last step, awake bodies only
+	const Islands& ContactIslands() const { return mSolver.LastIslands(); }
+	const SleepingIslands& Sleeping() const { return mSleeping; }
+
+	// Changing the broadphase type moves all bodies to a new broadphase
+	void SetSettings(const PhysicsSettings& settings);
+
+private:
+	AABB BoundingBox(std::size_t index) const;
+	void UpdateBroadphase(float timeStep);
+	void UpdateContacts();
+	void UpdateSleep(float timeStep);
+	void SweepContinuous(float timeStep);
+	void Impact(std::size_t i, std::size_t j, const Vector3f& normal, float remainingTime);
+
+	// Articulation stages of the step, over all articulations in parallel
+	template<typename F> void ForEachArticulation(F&& function);
+	bool FindArticulationIslands();
+
+	// Array index of a body after waking its island
+	std::size_t WokenIndex(BodyHandle body)
+	{
+		mSleeping.Wake(mBodies, mBodies.Index(body));
+		return mBodies.Index(body);
+	}
+
+	// Wake the sleeping islands a body touches, e.g. before it is destroyed
+	void WakeTouching(BodyHandle body);
+
+	// Whether two bodies (handle slots) can have contacts, false if a joint between them turns them off
+	bool Collides(uint32_t slotA, uint32_t slotB) const;
+	static uint64_t PairKey(uint32_t slotA, uint32_t slotB)
+	{
+		return slotA < slotB ? uint64_t(slotA) << 32 | slotB : uint64_t(slotB) << 32 | slotA;
+	}
+
+	// What colliding a broadphase pair found, before the contacts are added to the cache
+	enum class PairResult : uint8_t
+	{
+		None,     // Not collided, or not touching
+		Still,    // Neither body can move, keep last step's manifold
+		Touching,
+	};
+	PairResult CollidePair(const BroadphasePair& pair, Contact& contact) const;
+
+	struct CollidedPair
+	{
+		PairResult result;
+		Contact* contact; // Touching pairs only, in the scratch arena of the thread that collided it
+	};
+
+	// Null when the settings choose the global allocator
+	Arena* StepArena() { return mSettings.useArenas ? mFrameArena.get() : nullptr; }
+	Arena* ThreadScratchArena() { return mSettings.useArenas ? &mScratchArenas[mJobs->ThreadIndex()] : nullptr; }
+
+private:
+	PhysicsSettings mSettings;
+	std::unique_ptr<JobSystem> mJobs; // Held by pointer so the world can be moved, the stages keep a pointer to it
+	RigidBodies mBodies;
+
+	std::unique_ptr<Arena> mFrameArena; // Arenas can't be moved
+	ThreadArenas mScratchArenas;
+
+	std::unique_ptr<Broadphase> mBroadphase;
+	std::vector<BroadphasePair> mPairs;
+
+	ContactCache mContacts;
+	IslandSolver mSolver;
+
+	SleepingIslands mSleeping;
+
+	Joints mJoints;
+	std::unordered_map<uint64_t, uint32_t> mJointPairs; // Joints without collideConnected between each pair of bodies
+
+	Articulations mArticulations; // Their parent and child link pairs are in mJointPairs too
+	std::vector<uint32_t> mArticulationIslands; // Islands with link bodies in, solved again by the articulation passes
+	std::vector<uint32_t> mArticulationBodies;  // Their bodies and all the link bodies, by array index
+	Vector3SoA mSolveStartLinear;  // Those bodies' velocities before the solve, for the articulation passes
+	Vector3SoA mSolveStartAngular;
+
+	std::vector<uint32_t> mContinuous;       // Handle slots of the continuous collision bodies
+	std::vector<Vector3f> mContinuousStarts; // Their positions before integration
+	std::vector<uint32_t> mSweepNear;        // Bodies near the path being swept
+	ContinuousStats mContinuousStats;
+	ArticulationStats mArticulationStats;
+};
+
+#endif // !_PHYSICS_WORLD_H_DEFINED_
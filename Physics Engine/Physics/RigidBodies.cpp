@@ -0,0 +1,248 @@
+//=========================================================================================================
+// RigidBodies.cpp: Structure-of-Arrays Storage for Rigid Bodies
+//=========================================================================================================
+
+#include "RigidBodies.h"
+
+#include <utility>
+
+//=====================
+// Adding / Removing
+//=====================
+
+BodyHandle RigidBodies::Add(const BodyDesc& desc)
+{
+	const uint32_t index = static_cast<uint32_t>(Size());
+
+	// Reuse a free slot if there is one, its generation was already moved on when it was freed
+	uint32_t slot;
+	if (!mFreeSlots.empty())
+	{
+		slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+		mSlots[slot].index = index;
+	}
+	else
+	{
+		slot = static_cast<uint32_t>(mSlots.size());
+		mSlots.push_back({ index, 0 });
+	}
+	mSlotOfBody.push_back(slot);
+
+	Quaternionf orientation = Normalise(desc.orientation);
+	positions.PushBack(desc.position);
+	orientationX.push_back(orientation.x);
+	orientationY.push_back(orientation.y);
+	orientationZ.push_back(orientation.z);
+	orientationW.push_back(orientation.w);
+	linearVelocities.PushBack(desc.linearVelocity);
+	angularVelocities.PushBack(desc.angularVelocity);
+	inverseMasses.push_back(desc.inverseMass);
+	inverseInertias.PushBack(desc.inverseInertia);
+	forces.PushBack({ 0, 0, 0 });
+	torques.PushBack({ 0, 0, 0 });
+	broadphaseProxies.push_back(0xFFFFFFFF); // No proxy
+
+	float boundingRadius = desc.boundingRadius;
+	if (desc.shape)
+	{
+		if (boundingRadius == 0)
+			boundingRadius = desc.shape->BoundingBox(TransformIdentity()).Extents().Length();
+		shapes.push_back(*desc.shape);
+		hasShape.push_back(1);
+	}
+	else
+	{
+		shapes.push_back(ShapeSphere(0));
+		hasShape.push_back(0);
+	}
+	boundingRadii.push_back(boundingRadius);
+	sleepTimes.push_back(0);
+
+	// Awake, so before any sleeping bodies
+	Swap(index, mAwakeCount);
+	++mAwakeCount;
+
+	return { slot, mSlots[slot].generation };
+}
+
+void RigidBodies::Remove(BodyHandle handle)
+{
+	if (!IsValid(handle))
+		return;
+
+	// An awake body first becomes the last awake body, then leaves the awake range, so moving the last body
+	// into its place keeps the ranges intact. Then fix up the moved body's slot
+	uint32_t index = mSlots[handle.slot].index;
+	if (index < mAwakeCount)
+	{
+		--mAwakeCount;
+		Swap(index, mAwakeCount);
+		index = static_cast<uint32_t>(mAwakeCount);
+	}
+	const uint32_t last = static_cast<uint32_t>(Size() - 1);
+
+	positions.SwapRemove(index);
+	orientationX[index] = orientationX[last]; orientationX.pop_back();
+	orientationY[index] = orientationY[last]; orientationY.pop_back();
+	orientationZ[index] = orientationZ[last]; orientationZ.pop_back();
+	orientationW[index] = orientationW[last]; orientationW.pop_back();
+	linearVelocities.SwapRemove(index);
+	angularVelocities.SwapRemove(index);
+	inverseMasses[index] = inverseMasses[last]; inverseMasses.pop_back();
+	inverseInertias.SwapRemove(index);
+	forces.SwapRemove(index);
+	torques.SwapRemove(index);
+	boundingRadii[index] = boundingRadii[last]; boundingRadii.pop_back();
+	broadphaseProxies[index] = broadphaseProxies[last]; broadphaseProxies.pop_back();
+	shapes[index] = shapes[last]; shapes.pop_back();
+	hasShape[index] = hasShape[last]; hasShape.pop_back();
+	sleepTimes[index] = sleepTimes[last]; sleepTimes.pop_back();
+
+	const uint32_t movedSlot = mSlotOfBody[last];
+	mSlots[movedSlot].index = index;
+	mSlotOfBody[index] = movedSlot;
+	mSlotOfBody.pop_back();
+
+	// Free the slot, new generation so existing handles to it become invalid
+	mSlots[handle.slot].index = BodyHandle::InvalidSlot;
+	++mSlots[handle.slot].generation;
+	mFreeSlots.push_back(handle.slot);
+}
+
+void RigidBodies::Clear()
+{
+	// Free every slot in use so old handles become invalid
+	for (uint32_t slot : mSlotOfBody)
+	{
+		mSlots[slot].index = BodyHandle::InvalidSlot;
+		++mSlots[slot].generation;
+		mFreeSlots.push_back(slot);
+	}
+	mSlotOfBody.clear();
+
+	positions.Clear();
+	orientationX.clear();
+	orientationY.clear();
+	orientationZ.clear();
+	orientationW.clear();
+	linearVelocities.Clear();
+	angularVelocities.Clear();
+	inverseMasses.clear();
+	inverseInertias.Clear();
+	forces.Clear();
+	torques.Clear();
+	boundingRadii.clear();
+	broadphaseProxies.clear();
+	shapes.clear();
+	hasShape.clear();
+	sleepTimes.clear();
+	mAwakeCount = 0;
+}
+
+void RigidBodies::Reserve(std::size_t count)
+{
+	mSlots.reserve(count);
+	mSlotOfBody.reserve(count);
+
+	positions.Reserve(count);
+	orientationX.reserve(count);
+	orientationY.reserve(count);
+	orientationZ.reserve(count);
+	orientationW.reserve(count);
+	linearVelocities.Reserve(count);
+	angularVelocities.Reserve(count);
+	inverseMasses.reserve(count);
+	inverseInertias.Reserve(count);
+	forces.Reserve(count);
+	torques.Reserve(count);
+	boundingRadii.reserve(count);
+	broadphaseProxies.reserve(count);
+	shapes.reserve(count);
+	hasShape.reserve(count);
+	sleepTimes.reserve(count);
+}
+
+void RigidBodies::Swap(std::size_t i, std::size_t j)
+{
+	if (i == j)
+		return;
+
+	auto swapVectors = [&](Vector3SoA& v)
+	{
+		const Vector3f t = v.Get(i);
+		v.Set(i, v.Get(j));
+		v.Set(j, t);
+	};
+	swapVectors(positions);
+	swapVectors(linearVelocities);
+	swapVectors(angularVelocities);
+	swapVectors(inverseInertias);
+	swapVectors(forces);
+	swapVectors(torques);
+	std::swap(orientationX[i], orientationX[j]);
+	std::swap(orientationY[i], orientationY[j]);
+	std::swap(orientationZ[i], orientationZ[j]);
+	std::swap(orientationW[i], orientationW[j]);
+	std::swap(inverseMasses[i], inverseMasses[j]);
+	std::swap(boundingRadii[i], boundingRadii[j]);
+	std::swap(broadphaseProxies[i], broadphaseProxies[j]);
+	std::swap(shapes[i], shapes[j]);
+	std::swap(hasShape[i], hasShape[j]);
+	std::swap(sleepTimes[i], sleepTimes[j]);
+
+	std::swap(mSlotOfBody[i], mSlotOfBody[j]);
+	mSlots[mSlotOfBody[i]].index = static_cast<uint32_t>(i);
+	mSlots[mSlotOfBody[j]].index = static_cast<uint32_t>(j);
+}
+
+
+//=================
+// Sleeping
+//=================
+
+std::size_t RigidBodies::Sleep(std::size_t i)
+{
+	if (i >= mAwakeCount)
+		return i;
+
+	--mAwakeCount;
+	Swap(i, mAwakeCount);
+	linearVelocities.Set(mAwakeCount, { 0, 0, 0 });
+	angularVelocities.Set(mAwakeCount, { 0, 0, 0 });
+	return mAwakeCount;
+}
+
+std::size_t RigidBodies::Wake(std::size_t i)
+{
+	if (i < mAwakeCount)
+		return i;
+
+	Swap(i, mAwakeCount);
+	sleepTimes[mAwakeCount] = 0;
+	return mAwakeCount++;
+}
+
+
+//=================
+// Single Body
+//=================
+
+void RigidBodies::SetOrientation(std::size_t i, const Quaternionf& q)
+{
+	orientationX[i] = q.x;
+	orientationY[i] = q.y;
+	orientationZ[i] = q.z;
+	orientationW[i] = q.w;
+}
+
+Vector3f RigidBodies::ApplyInverseInertia(std::size_t i, const Vector3f& v) const
+{
+	if (inverseMasses[i] == 0)
+		return { 0, 0, 0 };
+
+	const Quaternionf orientation = Orientation(i);
+	const Vector3f local = Rotate(Conjugate(orientation), v);
+	const Vector3f inverseInertia = inverseInertias.Get(i);
+	return Rotate(orientation, { local.x * inverseInertia.x, local.y * inverseInertia.y, local.z * inverseInertia.z });
+}
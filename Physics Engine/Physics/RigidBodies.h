@@ -0,0 +1,191 @@
+//=========================================================================================================
+// RigidBodies.h: Structure-of-Arrays Storage for Rigid Bodies
+// - Each body property is a seperate aligned array (all positions together, all velocities together...)
+//   so passes such as integration stream through contiguous memory, four bodies per SIMD step
+// - Bodies are referred to outside the storage by a BodyHandle. Removing a body moves the last body into
+//   its place to keep the arrays packed, so array indices change but handles stay valid
+// - Handles are generational: a handle to a removed body is detected as invalid, even if its slot has
+//   since been reused by a new body
+// - Awake bodies are kept at the start of the arrays and sleeping bodies after them, so passes over the
+//   moving bodies (integration, broadphase updates) stop at AwakeCount(). Putting a body to sleep or
+//   waking it swaps it with the body at the boundary
+//=========================================================================================================
+
+#ifndef _RIGID_BODIES_H_DEFINED_
+#define _RIGID_BODIES_H_DEFINED_
+
+#include "Vector3SoA.h"
+#include "Quaternion.h"
+#include "Transform.h"
+#include "AlignedAllocator.h"
+#include "Shapes.h"
+
+#include <cstdint>
+#include <vector>
+
+//===============
+// Body Handle
+//===============
+
+struct BodyHandle
+{
+	static constexpr uint32_t InvalidSlot = 0xFFFFFFFF;
+
+	uint32_t slot = InvalidSlot; // Position in the handle table, not the body arrays
+	uint32_t generation = 0;     // Incremented each time the slot is freed
+
+	bool operator==(const BodyHandle& h) const { return slot == h.slot && generation == h.generation; }
+	bool operator!=(const BodyHandle& h) const { return !(*this == h); }
+};
+
+
+//==================
+// Body Description
+//==================
+
+// Initial values for a new body
+struct BodyDesc
+{
+	Vector3f position = { 0, 0, 0 };
+	Quaternionf orientation = QuaternionIdentity();
+	Vector3f linearVelocity = { 0, 0, 0 };
+	Vector3f angularVelocity = { 0, 0, 0 };  // World space, radians / second
+
+	// Zero inverse mass gives a static body - not moved by forces or gravity, but still moves with its velocity
+	float inverseMass = 1;
+
+	// Inverse of the principal moments of inertia (diagonal of the inertia tensor in the body's local space)
+	Vector3f inverseInertia = { 1, 1, 1 };
+
+	// Radius of a sphere around the position enclosing the body, gives its broadphase box
+	// Zero for a body that takes no part in collision detection, unless it has a shape
+	float boundingRadius = 0;
+
+	// Collision shape centred on the position, copied into the body. Null for a body without contacts
+	// A shape with a zero bounding radius is given the radius of a sphere enclosing the shape
+	const Shape* shape = nullptr;
+
+	// Continuous collision for fast bodies such as projectiles, which would otherwise pass through thin
+	// bodies in a single step. Used by PhysicsWorld, which sweeps the body's path in any step it moves
+	// further than about half its thickness
+	bool continuousCollision = false;
+};
+
+
+//=================
+// Body Storage
+//=================
+
+class RigidBodies
+{
+public:
+	//=====================
+	// Adding / Removing
+	//=====================
+
+	BodyHandle Add(const BodyDesc& desc);
+
+	// Removing an invalid handle does nothing
+	void Remove(BodyHandle handle);
+
+	void Clear();
+	void Reserve(std::size_t count);
+
+	//=================
+	// Handles
+	//=================
+
+	bool IsValid(BodyHandle handle) const
+	{
+		return handle.slot < mSlots.size() && mSlots[handle.slot].generation == handle.generation &&
+		       mSlots[handle.slot].index != BodyHandle::InvalidSlot;
+	}
+
+	// Current array index of a body. Handle must be valid, the index changes when other bodies are removed
+	std::size_t Index(BodyHandle handle) const { return mSlots[handle.slot].index; }
+
+	// Array index of the body using a handle slot, for code that stores slots (e.g. broadphase user values)
+	std::size_t SlotIndex(uint32_t slot) const { return mSlots[slot].index; }
+
+	// Handle of the body at an array index
+	BodyHandle Handle(std::size_t index) const
+	{
+		uint32_t slot = mSlotOfBody[index];
+		return { slot, mSlots[slot].generation };
+	}
+
+	std::size_t Size() const { return positions.Size(); }
+	bool Empty() const { return positions.Empty(); }
+
+	// Exchange two bodies' places in the arrays, their handles follow them
+	void Swap(std::size_t i, std::size_t j);
+
+	//=================
+	// Sleeping
+	//=================
+
+	// Bodies [0, AwakeCount()) are awake, the rest asleep. New bodies are awake
+	std::size_t AwakeCount() const { return mAwakeCount; }
+	bool IsAwake(std::size_t i) const { return i < mAwakeCount; }
+
+	// Move an awake body to the sleeping range, zeroing its velocities, or a sleeping body to the awake
+	// range, clearing its sleep time. Returns the body's new array index
+	std::size_t Sleep(std::size_t i);
+	std::size_t Wake(std::size_t i);
+
+	//=================
+	// Single Body
+	//=================
+
+	// Gather / Scatter a single body's values by array index - use the arrays directly in loops
+	Quaternionf Orientation(std::size_t i) const { return { orientationX[i], orientationY[i], orientationZ[i], orientationW[i] }; }
+	void SetOrientation(std::size_t i, const Quaternionf& q);
+
+	Transformf BodyTransform(std::size_t i) const { return { positions.Get(i), Orientation(i) }; }
+
+	// World space inverse inertia applied to a vector: rotate into body space, scale by the diagonal, rotate
+	// back. Zero for static bodies, they don't turn
+	Vector3f ApplyInverseInertia(std::size_t i, const Vector3f& v) const;
+
+	//=================
+	// Body Arrays
+	//=================
+	// Public for the passes over all bodies (integration, solver etc.). All arrays have Size() elements
+
+	Vector3SoA positions;
+	AlignedVector<float> orientationX; // Orientation quaternions, one array per component
+	AlignedVector<float> orientationY;
+	AlignedVector<float> orientationZ;
+	AlignedVector<float> orientationW;
+	Vector3SoA linearVelocities;
+	Vector3SoA angularVelocities;       // World space
+	AlignedVector<float> inverseMasses;
+	Vector3SoA inverseInertias;         // Local space, diagonal
+
+	// Accumulated each step and cleared by the integrator
+	Vector3SoA forces;
+	Vector3SoA torques;
+
+	AlignedVector<float> boundingRadii;
+	std::vector<uint32_t> broadphaseProxies; // Managed by PhysicsWorld, Broadphase::NullProxy if none
+
+	std::vector<Shape> shapes;     // Only meaningful where hasShape is set
+	std::vector<uint8_t> hasShape;
+
+	AlignedVector<float> sleepTimes; // How long each body has been slow enough to sleep, managed by PhysicsWorld
+
+private:
+	struct Slot
+	{
+		uint32_t index;      // Array index of the body using this slot, InvalidSlot if free
+		uint32_t generation;
+	};
+
+	std::vector<Slot> mSlots;
+	std::vector<uint32_t> mFreeSlots;
+	std::vector<uint32_t> mSlotOfBody; // Array index -> slot, to fix up the handle table when bodies move
+
+	std::size_t mAwakeCount = 0;
+};
+
+#endif // !_RIGID_BODIES_H_DEFINED_
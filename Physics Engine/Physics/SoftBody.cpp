@@ -0,0 +1,355 @@
+//=========================================================================================================
+// SoftBody.cpp: Soft Body Building, Element Rotations and Forces, and the Conjugate Gradient Step
+//=========================================================================================================
+
+#include "SoftBody.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Smallest pieces the element passes are split into for the jobs, and the fixed blocks of the node passes
+	const std::size_t ElementsPerJob = 256;
+	const std::size_t NodesPerBlock = 1024;
+
+	// Warm started from last step's, the rotations usually only need a turn or two more. More if the body
+	// was moved, or is turning very fast
+	const int RotationIterations = 20;
+	const float RotationTolerance = 1e-5f;
+
+	// Isotropic linear stress of a displacement gradient g: lambda tr(e) I + 2 mu e, e the symmetric part of g
+	Matrix3x3 Stress(const Matrix3x3& g, float lambda, float mu)
+	{
+		const float pressure = lambda * Trace(g);
+		Matrix3x3 stress = (g + Transpose(g)) * mu;
+		stress.e00 += pressure;
+		stress.e11 += pressure;
+		stress.e22 += pressure;
+		return stress;
+	}
+}
+
+
+//=================
+// Building
+//=================
+
+SoftBodyDesc SoftBodyBlock(const Vector3f& corner, int columns, int layers, int rows, float size)
+{
+	SoftBodyDesc desc;
+	for (int row = 0; row <= rows; ++row)
+	{
+		for (int layer = 0; layer <= layers; ++layer)
+		{
+			for (int column = 0; column <= columns; ++column)
+				desc.positions.push_back(corner + Vector3f(column * size, layer * size, row * size));
+		}
+	}
+
+	auto index = [&](int column, int layer, int row)
+	{
+		return static_cast<uint32_t>((row * (layers + 1) + layer) * (columns + 1) + column);
+	};
+
+	// Each of the six tetrahedra runs from the cube's first corner to its opposite along the edges in one
+	// order of the axes. Corners are numbered by bits: 1 along x, 2 along y, 4 along z
+	const int orders[6][3] = { { 1, 2, 4 }, { 1, 4, 2 }, { 2, 1, 4 }, { 2, 4, 1 }, { 4, 1, 2 }, { 4, 2, 1 } };
+	for (int row = 0; row < rows; ++row)
+	{
+		for (int layer = 0; layer < layers; ++layer)
+		{
+			for (int column = 0; column < columns; ++column)
+			{
+				auto cubeCorner = [&](int bits) { return index(column + (bits & 1), layer + (bits >> 1 & 1), row + (bits >> 2)); };
+				for (const auto& order : orders)
+					desc.tetrahedra.push_back({ { cubeCorner(0), cubeCorner(order[0]), cubeCorner(order[0] | order[1]), cubeCorner(7) } });
+			}
+		}
+	}
+	return desc;
+}
+
+// Rest edges from the first corner are the rows of Dm, so the deformation gradient is Dm^-1 Ds, Ds the
+// current edges: the sum over the corners of OuterProduct(gradient, position), with the gradients the
+// columns of Dm^-1 and the first minus the other three
+SoftBody::SoftBody(const SoftBodyDesc& desc)
+	: mPositions(desc.positions), mVelocities(desc.positions.size(), { 0, 0, 0 }), mMasses(desc.positions.size(), 0),
+	  mFixed(desc.positions.size(), 0), mTetrahedra(desc.tetrahedra), mMassDamping(desc.massDamping),
+	  mStiffnessDamping(desc.stiffnessDamping), mGravity(desc.gravity), mMaxIterations(std::max(desc.maxIterations, 1)),
+	  mTolerance(desc.tolerance)
+{
+	const float e = desc.youngsModulus;
+	const float nu = desc.poissonRatio;
+	mLambda = e * nu / ((1 + nu) * (1 - 2 * nu));
+	mMu = e / (2 * (1 + nu));
+
+	const std::size_t elementCount = mTetrahedra.size();
+	mGradients.resize(elementCount * 4);
+	mVolumes.resize(elementCount);
+	mOrientations.assign(elementCount, QuaternionIdentity<float>());
+	mRotations.assign(elementCount, Matrix3x3Identity<float>());
+	mCorners.resize(elementCount * 4);
+	for (std::size_t element = 0; element < elementCount; ++element)
+	{
+		const uint32_t* nodes = mTetrahedra[element].nodes;
+		const Vector3f origin = mPositions[nodes[0]];
+		const Matrix3x3 edges = Matrix3x3FromRows(mPositions[nodes[1]] - origin, mPositions[nodes[2]] - origin, mPositions[nodes[3]] - origin);
+		const Matrix3x3 inverse = Inverse(edges);
+		Vector3f* gradients = &mGradients[element * 4];
+		gradients[1] = inverse.Column(0);
+		gradients[2] = inverse.Column(1);
+		gradients[3] = inverse.Column(2);
+		gradients[0] = -(gradients[1] + gradients[2] + gradients[3]);
+
+		mVolumes[element] = std::abs(Determinant(edges)) / 6;
+		for (int corner = 0; corner < 4; ++corner)
+			mMasses[nodes[corner]] += desc.density * mVolumes[element] / 4;
+	}
+
+	for (uint32_t node : desc.pinned)
+		mFixed[node] = 1;
+	for (std::size_t i = 0; i < mMasses.size(); ++i)
+		mFixed[i] |= mMasses[i] == 0;
+
+	// Corners of each node, in element order
+	mNodeCornerStart.assign(mPositions.size() + 1, 0);
+	for (const SoftBodyTetrahedron& tetrahedron : mTetrahedra)
+	{
+		for (uint32_t node : tetrahedron.nodes)
+			mNodeCornerStart[node + 1]++;
+	}
+	for (std::size_t i = 0; i < mPositions.size(); ++i)
+		mNodeCornerStart[i + 1] += mNodeCornerStart[i];
+	mNodeCorners.resize(elementCount * 4);
+	std::vector<uint32_t> next(mNodeCornerStart.begin(), mNodeCornerStart.end() - 1);
+	for (std::size_t element = 0; element < elementCount; ++element)
+	{
+		for (int corner = 0; corner < 4; ++corner)
+			mNodeCorners[next[mTetrahedra[element].nodes[corner]]++] = static_cast<uint32_t>(element * 4 + corner);
+	}
+
+	const std::size_t nodeCount = mPositions.size();
+	mRightHandSide.resize(nodeCount);
+	mResiduals.resize(nodeCount);
+	mDirections.resize(nodeCount);
+	mProducts.resize(nodeCount);
+	mPreconditioned.resize(nodeCount);
+	mInverseDiagonals.resize(nodeCount);
+}
+
+
+//=================
+// Passes
+//=================
+
+template<typename F> void SoftBody::ForElements(F&& function)
+{
+	const std::size_t count = mTetrahedra.size();
+	if (!mJobs || count <= ElementsPerJob)
+	{
+		function(std::size_t(0), count);
+		return;
+	}
+	mJobs->ParallelFor(count, ElementsPerJob, function);
+}
+
+template<typename F> void SoftBody::ForNodeBlocks(F&& function)
+{
+	const std::size_t count = mPositions.size();
+	const std::size_t blocks = (count + NodesPerBlock - 1) / NodesPerBlock;
+	auto run = [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t block = begin; block < end; ++block)
+			function(block, block * NodesPerBlock, std::min(count, (block + 1) * NodesPerBlock));
+	};
+	if (!mJobs || blocks <= 1)
+		run(0, blocks);
+	else
+		mJobs->ParallelFor(blocks, 1, run);
+}
+
+template<typename F> double SoftBody::SumNodes(F&& function)
+{
+	mPartialSums.assign((mPositions.size() + NodesPerBlock - 1) / NodesPerBlock, 0);
+	ForNodeBlocks([&](std::size_t block, std::size_t begin, std::size_t end)
+	{
+		double sum = 0;
+		for (std::size_t i = begin; i < end; ++i)
+			sum += function(i);
+		mPartialSums[block] = sum;
+	});
+
+	double sum = 0;
+	for (double partial : mPartialSums)
+		sum += partial;
+	return sum;
+}
+
+// Elastic force on each corner: the stress of the stretch with the rotation taken off, turned back
+void SoftBody::Rotate()
+{
+	ForElements([&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t element = begin; element < end; ++element)
+		{
+			const uint32_t* nodes = mTetrahedra[element].nodes;
+			const Vector3f* gradients = &mGradients[element * 4];
+			Matrix3x3 deformation = OuterProduct(gradients[0], mPositions[nodes[0]]);
+			for (int corner = 1; corner < 4; ++corner)
+				deformation += OuterProduct(gradients[corner], mPositions[nodes[corner]]);
+
+			ExtractRotation(deformation, mOrientations[element], RotationIterations, RotationTolerance);
+			const Matrix3x3 rotation = Matrix3x3Rotation(mOrientations[element]);
+			mRotations[element] = rotation;
+
+			const Matrix3x3 stress = Stress(deformation * Transpose(rotation) - Matrix3x3Identity<float>(), mLambda, mMu);
+			for (int corner = 0; corner < 4; ++corner)
+				mCorners[element * 4 + corner] = (gradients[corner] * stress) * rotation * -mVolumes[element];
+		}
+	});
+}
+
+// The stiffness product is the elastic force again, of the displacements p with the rotations held
+void SoftBody::Multiply(const std::vector<Vector3f>& p, std::vector<Vector3f>& out)
+{
+	ForElements([&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t element = begin; element < end; ++element)
+		{
+			const uint32_t* nodes = mTetrahedra[element].nodes;
+			const Vector3f* gradients = &mGradients[element * 4];
+			Matrix3x3 displacement = OuterProduct(gradients[0], p[nodes[0]]);
+			for (int corner = 1; corner < 4; ++corner)
+				displacement += OuterProduct(gradients[corner], p[nodes[corner]]);
+
+			const Matrix3x3& rotation = mRotations[element];
+			const Matrix3x3 stress = Stress(displacement * Transpose(rotation), mLambda, mMu);
+			const float scale = mStiffnessScale * mVolumes[element];
+			for (int corner = 0; corner < 4; ++corner)
+				mCorners[element * 4 + corner] = (gradients[corner] * stress) * rotation * scale;
+		}
+	});
+
+	ForNodeBlocks([&](std::size_t, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			if (mFixed[i])
+			{
+				out[i] = { 0, 0, 0 };
+				continue;
+			}
+			Vector3f sum = p[i] * (mMassScale * mMasses[i]);
+			for (uint32_t k = mNodeCornerStart[i]; k < mNodeCornerStart[i + 1]; ++k)
+				sum += mCorners[mNodeCorners[k]];
+			out[i] = sum;
+		}
+	});
+}
+
+
+//=================
+// Stepping
+//=================
+
+// The velocities are the solution, warm started from the last. Fixed nodes are kept out of the solve by
+// zeroing them in every vector it makes
+void SoftBody::Step(float timeStep)
+{
+	if (mTetrahedra.empty())
+		return;
+
+	const float h = timeStep;
+	mMassScale = 1 + h * mMassDamping;
+	mStiffnessScale = h * mStiffnessDamping + h * h;
+	Rotate();
+
+	// Right hand side, and each node's diagonal block: (lambda + mu) OuterProduct(gR, gR) + mu |g|^2 I per
+	// corner, gR the corner's gradient turned by the element's rotation
+	ForNodeBlocks([&](std::size_t, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			if (mFixed[i])
+			{
+				mRightHandSide[i] = { 0, 0, 0 };
+				mVelocities[i] = { 0, 0, 0 };
+				mInverseDiagonals[i] = Matrix3x3Identity<float>();
+				continue;
+			}
+
+			Vector3f force = mGravity * mMasses[i];
+			Matrix3x3 stiffness = Matrix3x3Scale(Vector3f(0, 0, 0));
+			for (uint32_t k = mNodeCornerStart[i]; k < mNodeCornerStart[i + 1]; ++k)
+			{
+				const uint32_t slot = mNodeCorners[k];
+				const std::size_t element = slot / 4;
+				force += mCorners[slot];
+
+				const Vector3f& gradient = mGradients[slot];
+				const Vector3f turned = gradient * mRotations[element];
+				const float gradientSq = Dot(gradient, gradient);
+				Matrix3x3 block = OuterProduct(turned, turned) * (mLambda + mMu);
+				block.e00 += mMu * gradientSq;
+				block.e11 += mMu * gradientSq;
+				block.e22 += mMu * gradientSq;
+				stiffness += block * mVolumes[element];
+			}
+			mRightHandSide[i] = mVelocities[i] * mMasses[i] + force * h;
+
+			Matrix3x3 diagonal = stiffness * mStiffnessScale;
+			diagonal.e00 += mMassScale * mMasses[i];
+			diagonal.e11 += mMassScale * mMasses[i];
+			diagonal.e22 += mMassScale * mMasses[i];
+			mInverseDiagonals[i] = Inverse(diagonal);
+		}
+	});
+
+	Multiply(mVelocities, mProducts);
+	double residualZ = SumNodes([&](std::size_t i)
+	{
+		mResiduals[i] = mRightHandSide[i] - mProducts[i];
+		mPreconditioned[i] = mResiduals[i] * mInverseDiagonals[i];
+		mDirections[i] = mPreconditioned[i];
+		return static_cast<double>(Dot(mResiduals[i], mPreconditioned[i]));
+	});
+	const double rightHandSq = SumNodes([&](std::size_t i) { return static_cast<double>(Dot(mRightHandSide[i], mRightHandSide[i])); });
+	const double stopSq = static_cast<double>(mTolerance) * mTolerance * rightHandSq;
+
+	double residualSq = SumNodes([&](std::size_t i) { return static_cast<double>(Dot(mResiduals[i], mResiduals[i])); });
+	int iteration = 0;
+	while (iteration < mMaxIterations && residualSq > stopSq)
+	{
+		Multiply(mDirections, mProducts);
+		const double curvature = SumNodes([&](std::size_t i) { return static_cast<double>(Dot(mDirections[i], mProducts[i])); });
+		if (curvature <= 0)
+			break;
+
+		const float alpha = static_cast<float>(residualZ / curvature);
+		const double nextResidualZ = SumNodes([&](std::size_t i)
+		{
+			mVelocities[i] += mDirections[i] * alpha;
+			mResiduals[i] -= mProducts[i] * alpha;
+			mPreconditioned[i] = mResiduals[i] * mInverseDiagonals[i];
+			return static_cast<double>(Dot(mResiduals[i], mPreconditioned[i]));
+		});
+
+		const float beta = static_cast<float>(nextResidualZ / residualZ);
+		residualZ = nextResidualZ;
+		residualSq = SumNodes([&](std::size_t i)
+		{
+			mDirections[i] = mPreconditioned[i] + mDirections[i] * beta;
+			return static_cast<double>(Dot(mResiduals[i], mResiduals[i]));
+		});
+		++iteration;
+	}
+	mIterations = iteration;
+	mResidual = rightHandSq > 0 ? static_cast<float>(std::sqrt(residualSq / rightHandSq)) : 0;
+
+	ForNodeBlocks([&](std::size_t, std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+			mPositions[i] += mVelocities[i] * h;
+	});
+}
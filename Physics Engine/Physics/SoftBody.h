@@ -0,0 +1,174 @@
+//=========================================================================================================
+// SoftBody.h: Deformable Solids as Tetrahedral Meshes (Corotational Linear Finite Elements)
+// - Each tetrahedron's deformation gradient is split into a rotation and a stretch (Matrix3x3.h's
+//   ExtractRotation, started from the element's last rotation). Its linear elastic forces are worked out
+//   with the rotation taken off, then turned back, so a body can swing and spin as far as it likes without
+//   the growing and shrinking plain linear elements show, while staying as cheap as them
+// - Stepped by linearised backward Euler, stable at any time step and stiffness: with the rotations held
+//   for the step, (M (1 + h alpha) + (h beta + h^2) K) v' = M v + h (f + M g), then x += h v'. Alpha and
+//   beta are Rayleigh damping. Solved by conjugate gradient preconditioned by each node's 3x3 block of
+//   the diagonal, warm started from the last velocities, stopping at a relative residual or an iteration
+//   limit
+// - Matrix-free: K is never assembled. Each product K p is a pass over the elements, each working out the
+//   forces its own four corners would feel, then a pass over the nodes adding them up
+// - Nodes can be pinned where they are. There are no collisions yet: soft bodies only feel gravity and
+//   their pins
+//=========================================================================================================
+// Layout: positions and velocities are Arrays-of-Structures (Vector3f), as each element reads its four
+// nodes together from anywhere in them. Elements write each corner's result to its own slot, elements x 4,
+// and each node adds its corners up in a fixed order through a list of the corners it is at, so nothing
+// is written by two jobs and the results don't depend on the threads. The conjugate gradient's dot products
+// are summed in fixed blocks of nodes, then the blocks in order, for the same reason
+//=========================================================================================================
+
+#ifndef _SOFT_BODY_H_DEFINED_
+#define _SOFT_BODY_H_DEFINED_
+
+#include "Vector3.h"
+#include "Matrix3x3.h"
+#include "Quaternion.h"
+#include "JobSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//=====================
+// Description
+//=====================
+
+struct SoftBodyTetrahedron
+{
+	uint32_t nodes[4];
+};
+
+struct SoftBodyDesc
+{
+	std::vector<Vector3f> positions;                // Rest positions, also where the body starts
+	std::vector<SoftBodyTetrahedron> tetrahedra;    // Must not be flat, either winding
+	std::vector<uint32_t> pinned;                   // Nodes held where they are
+
+	float density = 1000;     // kg/m^3, lumped a quarter of each element's mass at each corner
+	float youngsModulus = 1e6f; // Pa
+	float poissonRatio = 0.3f;  // Below 0.5
+	float massDamping = 0;          // Rayleigh alpha, 1/s
+	float stiffnessDamping = 0.01f; // Rayleigh beta, s
+	Vector3f gravity = { 0, -9.81f, 0 };
+
+	// Conjugate gradient iterations a step, and the residual to stop at as a fraction of the right hand side.
+	// Long, soft bodies need the most: the benchmark's rubber cantilevers 24 elements long take up to 180
+	int maxIterations = 300;
+	float tolerance = 1e-3f;
+};
+
+// columns * layers * rows cubes of the given size from corner (x along columns, y layers, z rows), each
+// split into six tetrahedra along its diagonal, the same way in each so neighbours' faces match. Node
+// (column, layer, row) is (row * (layers + 1) + layer) * (columns + 1) + column
+SoftBodyDesc SoftBodyBlock(const Vector3f& corner, int columns, int layers, int rows, float size);
+
+
+//=====================
+// Soft Body
+//=====================
+
+class SoftBody
+{
+public:
+	// Works out each element's rest shape and volume and each node's mass. Nodes in no element have no
+	// mass, and are held where they are as the pinned nodes
+	explicit SoftBody(const SoftBodyDesc& desc);
+
+	void Step(float timeStep);
+
+	// Split the element and node passes between jobs on this system. Null to go back to the calling thread only
+	void SetJobSystem(JobSystem* jobs) { mJobs = jobs; }
+
+	//=================
+	// Nodes
+	//=================
+
+	std::size_t NodeCount() const { return mPositions.size(); }
+	const Vector3f& Position(std::size_t i) const { return mPositions[i]; }
+	const Vector3f& Velocity(std::size_t i) const { return mVelocities[i]; }
+	float Mass(std::size_t i) const { return mMasses[i]; }
+	bool IsPinned(std::size_t i) const { return mFixed[i] != 0; }
+
+	// Move a node, e.g. a pinned one to drag the body. Its velocity is left as it was
+	void SetPosition(std::size_t i, const Vector3f& position) { mPositions[i] = position; }
+	void SetVelocity(std::size_t i, const Vector3f& velocity) { mVelocities[i] = velocity; }
+
+	//=================
+	// Elements
+	//=================
+
+	std::size_t TetrahedronCount() const { return mTetrahedra.size(); }
+	const SoftBodyTetrahedron& Tetrahedron(std::size_t e) const { return mTetrahedra[e]; }
+	float RestVolume(std::size_t e) const { return mVolumes[e]; }
+
+	// Element's rotation at the start of the last step
+	const QuaternionT<float>& Orientation(std::size_t e) const { return mOrientations[e]; }
+
+	//=================
+	// Last Solve
+	//=================
+
+	int Iterations() const { return mIterations; }
+	float Residual() const { return mResidual; } // Relative to the right hand side
+
+private:
+	template<typename F> void ForElements(F&& function);
+	template<typename F> void ForNodeBlocks(F&& function);
+
+	// Sum of function(i) over the nodes, in fixed blocks then the blocks in order
+	template<typename F> double SumNodes(F&& function);
+
+	// Each element's rotation and its corners' elastic forces
+	void Rotate();
+
+	// out = A p, zero at the fixed nodes
+	void Multiply(const std::vector<Vector3f>& p, std::vector<Vector3f>& out);
+
+private:
+	JobSystem* mJobs = nullptr;
+
+	// Nodes
+	std::vector<Vector3f> mPositions;
+	std::vector<Vector3f> mVelocities;
+	std::vector<float> mMasses;
+	std::vector<uint8_t> mFixed;            // Pinned, or in no element
+	std::vector<uint32_t> mNodeCornerStart; // Each node's first entry in mNodeCorners, plus the end
+	std::vector<uint32_t> mNodeCorners;     // Element * 4 + corner, in element order
+
+	// Elements
+	std::vector<SoftBodyTetrahedron> mTetrahedra;
+	std::vector<Vector3f> mGradients; // Four per element, of each corner's shape function at rest
+	std::vector<float> mVolumes;
+	std::vector<QuaternionT<float>> mOrientations;
+	std::vector<Matrix3x3> mRotations;
+	std::vector<Vector3f> mCorners;   // Four per element, written by the element passes
+
+	// Solver
+	std::vector<Vector3f> mRightHandSide;
+	std::vector<Vector3f> mResiduals;
+	std::vector<Vector3f> mDirections;
+	std::vector<Vector3f> mProducts;
+	std::vector<Vector3f> mPreconditioned;
+	std::vector<Matrix3x3> mInverseDiagonals;
+	std::vector<double> mPartialSums;
+	int mIterations = 0;
+	float mResidual = 0;
+
+	float mLambda; // Lame parameters
+	float mMu;
+	float mMassDamping;
+	float mStiffnessDamping;
+	Vector3f mGravity;
+	int mMaxIterations;
+	float mTolerance;
+
+	// Set for the step, used by the products
+	float mMassScale = 1;
+	float mStiffnessScale = 0;
+};
+
+#endif // !_SOFT_BODY_H_DEFINED_
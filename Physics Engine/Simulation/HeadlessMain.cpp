@@ -0,0 +1,134 @@
+//=========================================================================================================
+// HeadlessMain.cpp: Entry Point for the Headless Runner - No Window or Graphics, Runs on Any Platform
+// - Runs the simulation for a number of fixed steps as fast as possible and reports steps / second
+// - With --frame-time the steps are driven through the fixed timestep accumulator instead, as a front
+//   end rendering at that frame time would drive them (still without waiting for real time to pass)
+//
+// Usage: PhysicsEngineHeadless [--steps N] [--timestep seconds] [--substeps N] [--max-steps N]
+//                              [--frame-time seconds] [--bodies N] [--seed N] [--broadphase tree|sap]
+//=========================================================================================================
+
+#include "SimulationHost.h"
+
+#include "PhysicsWorld.h"
+#include "Random.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	// Test scene: randomly placed bodies falling and spinning
+	void CreateScene(PhysicsWorld& world, std::size_t count, uint64_t seed)
+	{
+		RandomGenerator generator(seed);
+		world.Bodies().Reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			BodyDesc desc;
+			desc.position = generator.NextVector3({ -50, 0, -50 }, { 50, 100, 50 });
+			desc.orientation = QuaternionAxisAngle(generator.NextOnUnitSphere(), generator.NextFloat(0, 6.28f));
+			desc.linearVelocity = generator.NextVector3({ -5, -5, -5 }, { 5, 5, 5 });
+			desc.angularVelocity = generator.NextVector3({ -3, -3, -3 }, { 3, 3, 3 });
+			desc.boundingRadius = 0.5f;
+			world.CreateBody(desc);
+		}
+	}
+
+	// Average height, printed so runs with the same seed can be compared
+	float AverageHeight(const PhysicsWorld& world)
+	{
+		const RigidBodies& bodies = world.Bodies();
+		double sum = 0;
+		for (std::size_t i = 0; i < bodies.Size(); ++i)
+			sum += bodies.positions.Y()[i];
+		return bodies.Empty() ? 0.0f : static_cast<float>(sum / bodies.Size());
+	}
+
+	void PrintUsage()
+	{
+		std::printf("Usage: PhysicsEngineHeadless [--steps N] [--timestep seconds] [--substeps N] [--max-steps N]\n"
+		            "                             [--frame-time seconds] [--bodies N] [--seed N] [--broadphase tree|sap]\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	SimulationSettings settings;
+	PhysicsSettings physicsSettings;
+	physicsSettings.broadphase = BroadphaseType::SweepAndPrune; // Every body in the test scene moves every step
+	uint64_t steps = 1000;
+	float frameTime = 0;
+	std::size_t bodies = 10000;
+	uint64_t seed = RandomGenerator::DefaultSeed;
+
+	// Every option takes a value
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* option = argv[i];
+		if (i + 1 >= argc)
+		{
+			PrintUsage();
+			return 1;
+		}
+		const char* value = argv[++i];
+
+		if      (std::strcmp(option, "--steps") == 0)      steps = std::strtoull(value, nullptr, 10);
+		else if (std::strcmp(option, "--timestep") == 0)   settings.timeStep = std::strtof(value, nullptr);
+		else if (std::strcmp(option, "--substeps") == 0)   settings.subSteps = std::atoi(value);
+		else if (std::strcmp(option, "--max-steps") == 0)  settings.maxStepsPerFrame = std::atoi(value);
+		else if (std::strcmp(option, "--frame-time") == 0) frameTime = std::strtof(value, nullptr);
+		else if (std::strcmp(option, "--bodies") == 0)     bodies = std::strtoull(value, nullptr, 10);
+		else if (std::strcmp(option, "--seed") == 0)       seed = std::strtoull(value, nullptr, 10);
+		else if (std::strcmp(option, "--broadphase") == 0 && std::strcmp(value, "tree") == 0) physicsSettings.broadphase = BroadphaseType::DynamicTree;
+		else if (std::strcmp(option, "--broadphase") == 0 && std::strcmp(value, "sap") == 0)  physicsSettings.broadphase = BroadphaseType::SweepAndPrune;
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (settings.timeStep <= 0 || settings.subSteps < 1 || settings.maxStepsPerFrame < 1 || frameTime < 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	PhysicsWorld world(physicsSettings);
+	CreateScene(world, bodies, seed);
+	CSimulationHost host([&world](float timeStep) { world.Step(timeStep); }, settings);
+
+	HeadlessResult result;
+	if (frameTime > 0)
+	{
+		// Feed fixed frame times through the accumulator until enough steps have run
+		uint64_t frames = 0;
+		auto start = std::chrono::steady_clock::now();
+		while (host.StepCount() < steps)
+		{
+			host.Advance(frameTime);
+			++frames;
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		result.steps = host.StepCount();
+		result.seconds = elapsed.count();
+		std::printf("frames: %llu, dropped time: %.3f s\n", static_cast<unsigned long long>(frames), host.DroppedTime());
+	}
+	else
+	{
+		result = host.RunHeadless(steps);
+	}
+
+	std::printf("bodies: %zu, timestep: %g s, substeps: %d\n", bodies, settings.timeStep, settings.subSteps);
+	std::printf("steps: %llu, simulated: %.3f s, real: %.3f s\n",
+	            static_cast<unsigned long long>(result.steps), host.SimulationTime(), result.seconds);
+	std::printf("steps/second: %.1f\n", result.StepsPerSecond());
+	std::printf("average height: %.4f\n", AverageHeight(world));
+	std::printf("broadphase pairs: %zu\n", world.BroadphasePairs().size());
+
+	return 0;
+}
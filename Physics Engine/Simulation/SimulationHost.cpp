@@ -0,0 +1,80 @@
+//=========================================================================================================
+// SimulationHost.cpp: Platform-Neutral Fixed Timestep Simulation Loop
+//=========================================================================================================
+
+#include "SimulationHost.h"
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+CSimulationHost::CSimulationHost(StepFunction step, const SimulationSettings& settings)
+	: mStep(std::move(step))
+{
+	SetSettings(settings);
+}
+
+void CSimulationHost::SetSettings(const SimulationSettings& settings)
+{
+	assert(settings.timeStep > 0 && settings.subSteps >= 1 && settings.maxStepsPerFrame >= 1);
+	mSettings = settings;
+}
+
+void CSimulationHost::Reset()
+{
+	mAccumulator = 0;
+	mStepCount = 0;
+	mDroppedTime = 0;
+}
+
+
+//=================
+// Running
+//=================
+
+int CSimulationHost::Advance(float frameTime)
+{
+	// Negative times can come from timer glitches (e.g. after a debugger break), ignore them
+	if (frameTime > 0)
+		mAccumulator += frameTime;
+
+	int steps = 0;
+	while (mAccumulator >= mSettings.timeStep && steps < mSettings.maxStepsPerFrame)
+	{
+		Step();
+		mAccumulator -= mSettings.timeStep;
+		++steps;
+	}
+
+	// Catch-up clamp - drop whole steps we didn't have time for, keeping the fraction for interpolation
+	if (mAccumulator >= mSettings.timeStep)
+	{
+		float dropped = mAccumulator - std::fmod(mAccumulator, mSettings.timeStep);
+		mAccumulator -= dropped;
+		mDroppedTime += dropped;
+	}
+
+	return steps;
+}
+
+HeadlessResult CSimulationHost::RunHeadless(uint64_t steps)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < steps; ++i)
+		Step();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	HeadlessResult result;
+	result.steps = steps;
+	result.seconds = elapsed.count();
+	return result;
+}
+
+void CSimulationHost::Step()
+{
+	const float subStepTime = mSettings.timeStep / mSettings.subSteps;
+	for (int i = 0; i < mSettings.subSteps; ++i)
+		mStep(subStepTime);
+	++mStepCount;
+}
@@ -0,0 +1,86 @@
+//=========================================================================================================
+// SimulationHost.h: Platform-Neutral Fixed Timestep Simulation Loop
+// - Front ends (the Win32 window, the headless runner) pass in how much real time has passed and the
+//   host runs the simulation in whole fixed steps, so results don't depend on the frame rate
+// - Each fixed step can be split into several smaller substeps for stability
+// - If a frame takes too long, at most maxStepsPerFrame steps are run and the rest of the time is
+//   dropped, so a slow frame can't cause a "spiral of death" where catching up takes ever longer
+//=========================================================================================================
+
+#ifndef _SIMULATION_HOST_H_DEFINED_
+#define _SIMULATION_HOST_H_DEFINED_
+
+#include <cstdint>
+#include <functional>
+
+struct SimulationSettings
+{
+	float timeStep = 1.0f / 60.0f; // Seconds of simulation per fixed step
+	int subSteps = 1;              // Each step calls the simulation subSteps times with timeStep / subSteps
+	int maxStepsPerFrame = 5;      // Catch-up clamp, time beyond this many steps in one frame is dropped
+};
+
+// Result of a headless run
+struct HeadlessResult
+{
+	uint64_t steps = 0;
+	double seconds = 0; // Real (wall clock) time taken
+
+	double StepsPerSecond() const { return seconds > 0 ? steps / seconds : 0; }
+};
+
+class CSimulationHost
+{
+public:
+	// Called once per substep with the substep time in seconds
+	using StepFunction = std::function<void(float)>;
+
+	//================
+	// Constructors
+	//================
+
+	explicit CSimulationHost(StepFunction step, const SimulationSettings& settings = SimulationSettings());
+
+	//=================
+	// Running
+	//=================
+
+	// Add a frame's worth of real time (seconds) and run as many whole fixed steps as it covers, up to the
+	// catch-up clamp. Time less than a step is kept for the next frame. Returns the number of steps run
+	int Advance(float frameTime);
+
+	// Run a number of fixed steps one after another as fast as possible, ignoring real time
+	HeadlessResult RunHeadless(uint64_t steps);
+
+	// Clear the accumulated time and counters, ready to start again
+	void Reset();
+
+	//=================
+	// Data Access
+	//=================
+
+	const SimulationSettings& Settings() const { return mSettings; }
+	void SetSettings(const SimulationSettings& settings);
+
+	// Fraction of a step (0 to 1) waiting in the accumulator. Renderers can blend the last two
+	// simulation states by this amount for smooth motion between fixed steps
+	float Alpha() const { return mAccumulator / mSettings.timeStep; }
+
+	uint64_t StepCount() const { return mStepCount; }     // Fixed steps run since the last Reset
+	double SimulationTime() const { return mStepCount * static_cast<double>(mSettings.timeStep); }
+	double DroppedTime() const { return mDroppedTime; }   // Real time discarded by the catch-up clamp
+
+private:
+	// One fixed step, made up of all its substeps
+	void Step();
+
+private:
+	StepFunction mStep;
+	SimulationSettings mSettings;
+
+	float mAccumulator = 0;
+	uint64_t mStepCount = 0;
+	double mDroppedTime = 0;
+};
+
+#endif // !_SIMULATION_HOST_H_DEFINED_
@@ -0,0 +1,44 @@
+//=========================================================================================================
+// AlignedAllocator.h: STL Allocator returning Memory Aligned to a Given Boundary
+// - Lets std::vector hold arrays that can be read with aligned SIMD loads
+//   e.g. AlignedVector<float> xs; // xs.data() is 32 byte aligned
+//=========================================================================================================
+
+#ifndef _ALIGNED_ALLOCATOR_H_INCLUDED_
+#define _ALIGNED_ALLOCATOR_H_INCLUDED_
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+template<typename T, std::size_t Alignment> class AlignedAllocator
+{
+	static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of 2");
+
+public:
+	using value_type = T;
+
+	// Needed as the template has a non-type parameter so std::allocator_traits can't rebind automatically
+	template<typename U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+	AlignedAllocator() noexcept {}
+	template<typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+	T* allocate(std::size_t count)
+	{
+		return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+	}
+
+	void deallocate(T* p, std::size_t) noexcept
+	{
+		::operator delete(p, std::align_val_t(Alignment));
+	}
+
+	template<typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+	template<typename U> bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+// Vector aligned to 32 bytes - Enough for both SSE (16) and AVX (32) aligned loads
+template<typename T> using AlignedVector = std::vector<T, AlignedAllocator<T, 32>>;
+
+#endif // !_ALIGNED_ALLOCATOR_H_INCLUDED_
@@ -0,0 +1,144 @@
+//=========================================================================================================
+// Arena.cpp: Linear Arena and Per-Thread Scratch Arenas
+//=========================================================================================================
+
+#include "Arena.h"
+
+#include <cstdint>
+
+namespace
+{
+	// Blocks start on a cache line, so arenas of different threads never share one
+	const std::size_t BlockAlignment = 64;
+}
+
+
+//=================
+// Arena
+//=================
+
+Arena::Arena(std::size_t blockSize)
+	: mBlockSize(std::max<std::size_t>(blockSize, BlockAlignment))
+{
+}
+
+Arena::~Arena()
+{
+	FreeBlocks();
+}
+
+void* Arena::Allocate(std::size_t size, std::size_t alignment)
+{
+	const std::uintptr_t current = reinterpret_cast<std::uintptr_t>(mCurrent);
+	char* start = reinterpret_cast<char*>((current + alignment - 1) & ~(std::uintptr_t(alignment) - 1));
+	if (!mCurrent || start + size > mEnd)
+	{
+		NewBlock(size + alignment);
+		start = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(mCurrent) + alignment - 1) & ~(std::uintptr_t(alignment) - 1));
+	}
+
+	mCurrent = start + size;
+	++mAllocations;
+	return start;
+}
+
+// Blocks at least double, so a frame of any size needs only a few
+void Arena::NewBlock(std::size_t minimumSize)
+{
+	if (!mBlocks.empty())
+		mBytesInFullBlocks += mCurrent - mBlocks.back().memory;
+
+	std::size_t size = mBlocks.empty() ? mBlockSize : mBlocks.back().size * 2;
+	size = std::max(size, minimumSize);
+	char* memory = static_cast<char*>(::operator new(size, std::align_val_t(BlockAlignment)));
+	mBlocks.push_back({ memory, size });
+	mCurrent = memory;
+	mEnd = memory + size;
+	mCapacity += size;
+	++mSystemAllocations;
+}
+
+void Arena::FreeBlocks()
+{
+	for (const Block& block : mBlocks)
+		::operator delete(block.memory, std::align_val_t(BlockAlignment));
+	mBlocks.clear();
+	mCurrent = mEnd = nullptr;
+	mCapacity = 0;
+}
+
+void Arena::Reset()
+{
+	const MemoryStats stats = Stats();
+	mPeakBytes = stats.peakBytes;
+
+	// Several blocks: one as big as all of them next time
+	if (mBlocks.size() > 1)
+	{
+		const std::size_t size = mCapacity;
+		FreeBlocks();
+		mBytesInFullBlocks = 0;
+		mBlockSize = size;
+		NewBlock(size);
+	}
+	else if (!mBlocks.empty())
+	{
+		mCurrent = mBlocks.back().memory;
+	}
+
+	mBytesInFullBlocks = 0;
+	mAllocations = 0;
+}
+
+MemoryStats Arena::Stats() const
+{
+	MemoryStats stats;
+	stats.allocations = mAllocations;
+	stats.bytesInUse = mBytesInFullBlocks + (mBlocks.empty() ? 0 : mCurrent - mBlocks.back().memory);
+	stats.peakBytes = std::max(mPeakBytes, stats.bytesInUse);
+	stats.capacity = mCapacity;
+	stats.systemAllocations = mSystemAllocations;
+	return stats;
+}
+
+
+//=================
+// Scratch Arenas
+//=================
+
+ThreadArenas::ThreadArenas(unsigned int threadCount, std::size_t blockSize)
+	: mBlockSize(blockSize)
+{
+	SetThreadCount(threadCount);
+}
+
+void ThreadArenas::SetThreadCount(unsigned int threadCount)
+{
+	mArenas.resize(std::max(1u, threadCount));
+	for (std::unique_ptr<Arena>& arena : mArenas)
+	{
+		if (!arena)
+			arena = std::make_unique<Arena>(mBlockSize);
+	}
+}
+
+void ThreadArenas::Reset()
+{
+	for (std::unique_ptr<Arena>& arena : mArenas)
+		arena->Reset();
+}
+
+MemoryStats ThreadArenas::Stats() const
+{
+	MemoryStats total;
+	for (const std::unique_ptr<Arena>& arena : mArenas)
+	{
+		const MemoryStats stats = arena->Stats();
+		total.allocations += stats.allocations;
+		total.bytesInUse += stats.bytesInUse;
+		total.peakBytes += stats.peakBytes;
+		total.capacity += stats.capacity;
+		total.systemAllocations += stats.systemAllocations;
+	}
+	return total;
+}
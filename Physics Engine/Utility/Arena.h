@@ -0,0 +1,149 @@
+//=========================================================================================================
+// Arena.h: Linear Arena Allocator for Temporaries that all Die Together
+// - Allocation moves a pointer along a block, nothing is freed on its own. Reset frees everything at once,
+//   e.g. once per step for the step's temporaries (frame arena)
+// - When a frame needs more than one block, Reset swaps them for one block as big as all of them, so after
+//   the first few frames the arena asks the system for nothing
+// - An arena is for one thread at a time. ThreadArenas gives each job system thread its own (scratch
+//   arenas), so jobs can allocate without locking or sharing cache lines
+// - ArenaAllocator lets standard containers use an arena, or the global allocator when given none
+//   e.g. ArenaVector<uint32_t> indices(ArenaAllocator<uint32_t>(&frameArena));
+//   A growing vector leaves its old buffers in the arena until Reset, so reserve the size up front
+//=========================================================================================================
+
+#ifndef _ARENA_H_DEFINED_
+#define _ARENA_H_DEFINED_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Allocation statistics of an arena or pool
+struct MemoryStats
+{
+	std::size_t allocations = 0;       // Arena: since the last Reset. Pool: objects alive
+	std::size_t bytesInUse = 0;
+	std::size_t peakBytes = 0;         // Most in use at once
+	std::size_t capacity = 0;          // Bytes held from the system
+	std::size_t systemAllocations = 0; // Blocks ever asked of the system
+};
+
+
+//=====================
+// Arena
+//=====================
+
+class alignas(64) Arena
+{
+public:
+	// blockSize: size of the first block, later blocks are at least as large as the one before
+	explicit Arena(std::size_t blockSize = 64 * 1024);
+	~Arena();
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	// Uninitialised memory, freed by the next Reset
+	void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+	template<typename T> T* Allocate(std::size_t count = 1) { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+
+	// Free everything allocated since the last Reset
+	void Reset();
+
+	MemoryStats Stats() const;
+
+private:
+	struct Block
+	{
+		char* memory;
+		std::size_t size;
+	};
+
+	void NewBlock(std::size_t minimumSize);
+	void FreeBlocks();
+
+private:
+	std::vector<Block> mBlocks; // The last is the one being allocated from
+	char* mCurrent = nullptr;
+	char* mEnd = nullptr;
+	std::size_t mBlockSize;
+
+	std::size_t mBytesInFullBlocks = 0; // Used in the blocks before the last
+	std::size_t mAllocations = 0;
+	std::size_t mPeakBytes = 0;
+	std::size_t mCapacity = 0;
+	std::size_t mSystemAllocations = 0;
+};
+
+
+//=====================
+// Scratch Arenas
+//=====================
+
+// One arena per job system thread (JobSystem::ThreadIndex)
+class ThreadArenas
+{
+public:
+	explicit ThreadArenas(unsigned int threadCount = 1, std::size_t blockSize = 64 * 1024);
+
+	// Replaces the arenas, nothing may still be using them
+	void SetThreadCount(unsigned int threadCount);
+	unsigned int ThreadCount() const { return static_cast<unsigned int>(mArenas.size()); }
+
+	Arena& operator[](unsigned int thread) { return *mArenas[thread]; }
+	const Arena& operator[](unsigned int thread) const { return *mArenas[thread]; }
+
+	void Reset();
+
+	// Summed over the threads
+	MemoryStats Stats() const;
+
+private:
+	std::size_t mBlockSize;
+	std::vector<std::unique_ptr<Arena>> mArenas;
+};
+
+
+//=====================
+// STL Adaptor
+//=====================
+
+// Allocates from an arena, or the global allocator if the arena is null. Deallocating arena memory does
+// nothing, it is freed by the arena's Reset
+template<typename T> class ArenaAllocator
+{
+public:
+	using value_type = T;
+
+	ArenaAllocator(Arena* arena = nullptr) noexcept : mArena(arena) {}
+	template<typename U> ArenaAllocator(const ArenaAllocator<U>& other) noexcept : mArena(other.GetArena()) {}
+
+	T* allocate(std::size_t count)
+	{
+		if (mArena)
+			return mArena->Allocate<T>(count);
+		return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+	}
+
+	void deallocate(T* p, std::size_t) noexcept
+	{
+		if (!mArena)
+			::operator delete(p, std::align_val_t(Alignment));
+	}
+
+	Arena* GetArena() const { return mArena; }
+
+	template<typename U> bool operator==(const ArenaAllocator<U>& other) const noexcept { return mArena == other.GetArena(); }
+	template<typename U> bool operator!=(const ArenaAllocator<U>& other) const noexcept { return mArena != other.GetArena(); }
+
+private:
+	static constexpr std::size_t Alignment = std::max(alignof(T), alignof(std::max_align_t));
+
+	Arena* mArena;
+};
+
+template<typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif // !_ARENA_H_DEFINED_
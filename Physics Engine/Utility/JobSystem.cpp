@@ -0,0 +1,348 @@
+//=========================================================================================================
+// JobSystem.cpp: Worker Threads, Chase-Lev Deques and Job Counters
+//=========================================================================================================
+
+#include "JobSystem.h"
+#include "ParallelFor.h" // For HardwareThreadCount
+
+#include <cstdint>
+#include <thread>
+
+namespace
+{
+	// Jobs each thread can have in its deque and ring at once. Jobs pushed to a full deque are run straight away
+	const std::size_t MaxJobs = 4096;
+
+	// Ring slots looked at for a finished job before giving up
+	const std::size_t JobSearch = 64;
+
+	// Rounds of failed stealing before an idle worker goes to sleep
+	const int IdleSpins = 64;
+
+	// Worker threads know their system and index. Any other thread is thread 0 of every system
+	thread_local const JobSystem* tSystem = nullptr;
+	thread_local unsigned int tThread = 0;
+}
+
+
+//=================
+// Deques
+//=================
+
+// Each thread's jobs. The deque is the fixed size version of Chase-Lev with the memory orders of Le et al.,
+// "Correct and Efficient Work-Stealing for Weak Memory Models": only the owner pushes and pops at the
+// bottom, any thread steals from the top, and they only contend over the last job
+struct JobSystem::Thread
+{
+	alignas(64) std::atomic<std::int64_t> top{ 0 };
+	alignas(64) std::atomic<std::int64_t> bottom{ 0 };
+	std::atomic<Job*> deque[MaxJobs];
+
+	Job jobs[MaxJobs]; // Ring of jobs submitted by this thread
+	std::size_t nextJob = 0;
+
+	uint32_t random = 1; // Xorshift state for choosing who to steal from
+	std::atomic<std::size_t> steals{ 0 };
+	std::thread thread;
+
+	bool Push(Job* job)
+	{
+		const std::int64_t b = bottom.load(std::memory_order_relaxed);
+		const std::int64_t t = top.load(std::memory_order_acquire);
+		if (b - t >= static_cast<std::int64_t>(MaxJobs))
+			return false;
+
+		deque[b & (MaxJobs - 1)].store(job, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	Job* Pop()
+	{
+		const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t t = top.load(std::memory_order_relaxed);
+		if (t > b)
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job* job = deque[b & (MaxJobs - 1)].load(std::memory_order_relaxed);
+		if (t == b)
+		{
+			// The last job, a thief may be taking it at the same time
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				job = nullptr;
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	Job* Steal()
+	{
+		std::int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const std::int64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b)
+			return nullptr;
+
+		Job* job = deque[t & (MaxJobs - 1)].load(std::memory_order_relaxed);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+		return job;
+	}
+};
+
+
+//=================
+// Threads
+//=================
+
+JobSystem::JobSystem(unsigned int threadCount)
+{
+	Start(threadCount);
+}
+
+JobSystem::~JobSystem()
+{
+	Stop();
+}
+
+void JobSystem::SetThreadCount(unsigned int threadCount)
+{
+	const unsigned int count = threadCount > 0 ? threadCount : HardwareThreadCount();
+	if (count == ThreadCount())
+		return;
+	Stop();
+	Start(count);
+}
+
+unsigned int JobSystem::ThreadIndex() const
+{
+	return tSystem == this ? tThread : 0;
+}
+
+std::size_t JobSystem::StealCount() const
+{
+	std::size_t steals = 0;
+	for (const std::unique_ptr<Thread>& thread : mThreads)
+		steals += thread->steals.load(std::memory_order_relaxed);
+	return steals;
+}
+
+void JobSystem::Start(unsigned int threadCount)
+{
+	const unsigned int count = threadCount > 0 ? threadCount : HardwareThreadCount();
+	mStopping = false;
+	mThreads.resize(count);
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		mThreads[i] = std::make_unique<Thread>();
+		mThreads[i]->random = 0x9E3779B9u * (i + 1);
+	}
+	for (unsigned int i = 1; i < count; ++i)
+		mThreads[i]->thread = std::thread([this, i]() { WorkerMain(i); });
+}
+
+void JobSystem::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mStopping = true;
+	}
+	mWake.notify_all();
+	for (std::unique_ptr<Thread>& thread : mThreads)
+	{
+		if (thread->thread.joinable())
+			thread->thread.join();
+	}
+	mThreads.clear();
+}
+
+void JobSystem::WorkerMain(unsigned int thread)
+{
+	tSystem = this;
+	tThread = thread;
+
+	int idle = 0;
+	while (!mStopping.load(std::memory_order_relaxed))
+	{
+		if (RunOne(thread))
+		{
+			idle = 0;
+			continue;
+		}
+		if (++idle < IdleSpins)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Sleep until a job is pushed. The pusher counts the job before checking for sleepers, and this
+		// thread counts itself before checking for jobs, so one of them always sees the other
+		idle = 0;
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		++mSleepingWorkers;
+		mWake.wait(lock, [this]() { return mStopping.load() || mQueuedJobs.load() > 0; });
+		--mSleepingWorkers;
+	}
+}
+
+
+//=================
+// Jobs
+//=================
+
+// The next finished job in the ring, skipping any still queued or running. Null if none of the next few has
+// finished, the caller then runs the work itself. Waiting for a slot instead could wait for a job further
+// up this thread's own stack
+JobSystem::Job* JobSystem::NewJob(JobCounter& counter, unsigned int thread)
+{
+	Thread& self = *mThreads[thread];
+	Job* job = nullptr;
+	for (std::size_t k = 0; k < JobSearch && !job; ++k)
+	{
+		Job* next = &self.jobs[self.nextJob++ % MaxJobs];
+		if (next->finished.load(std::memory_order_acquire))
+			job = next;
+	}
+	if (!job)
+		return nullptr;
+
+	job->finished.store(false, std::memory_order_relaxed);
+	job->begin = 0;
+	job->end = 0;
+	job->grainSize = 0;
+	job->counter = &counter;
+	job->nextWaiting = nullptr;
+	counter.mPending.fetch_add(1);
+	return job;
+}
+
+void JobSystem::Push(Job* job, unsigned int thread)
+{
+	mQueuedJobs.fetch_add(1);
+	if (!mThreads[thread]->Push(job))
+	{
+		mQueuedJobs.fetch_sub(1);
+		Execute(job, thread);
+		return;
+	}
+
+	if (mSleepingWorkers.load() > 0)
+	{
+		// Taking the lock means a worker about to sleep is either still to check for jobs or already waiting
+		{
+			std::lock_guard<std::mutex> lock(mSleepMutex);
+		}
+		mWake.notify_one();
+	}
+}
+
+// Held back on the counter's list, unless it has already reached zero. The last job of the counter takes
+// the list under the same lock after reaching zero, so a job is never missed
+void JobSystem::SubmitAfter(JobCounter& after, Job* job, unsigned int thread)
+{
+	{
+		std::lock_guard<std::mutex> lock(after.mMutex);
+		if (after.mPending.load() != 0)
+		{
+			job->nextWaiting = after.mWaiting;
+			after.mWaiting = job;
+			return;
+		}
+	}
+	Push(job, thread);
+}
+
+bool JobSystem::RunOne(unsigned int thread)
+{
+	Thread& self = *mThreads[thread];
+	Job* job = self.Pop();
+	if (!job)
+	{
+		// Start from a random thread, so thieves don't all queue up on the same one
+		self.random ^= self.random << 13;
+		self.random ^= self.random >> 17;
+		self.random ^= self.random << 5;
+		const std::size_t count = mThreads.size();
+		const std::size_t first = self.random % count;
+		for (std::size_t k = 0; k < count && !job; ++k)
+		{
+			const std::size_t victim = (first + k) % count;
+			if (victim != thread)
+				job = mThreads[victim]->Steal();
+		}
+		if (!job)
+			return false;
+		self.steals.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	mQueuedJobs.fetch_sub(1);
+	Execute(job, thread);
+	return true;
+}
+
+void JobSystem::RunOneOrYield(unsigned int thread)
+{
+	if (!RunOne(thread))
+		std::this_thread::yield();
+}
+
+void JobSystem::Execute(Job* job, unsigned int thread)
+{
+	// Push the second half of a range as a new job until what is left is no larger than the grain. With the
+	// ring full the rest is run here in one go
+	while (job->grainSize != 0 && job->end - job->begin > job->grainSize)
+	{
+		const std::size_t middle = job->begin + (job->end - job->begin) / 2;
+		Job* half = NewJob(*job->counter, thread);
+		if (!half)
+			break;
+		half->invoke = job->invoke;
+		half->function = job->function;
+		half->begin = middle;
+		half->end = job->end;
+		half->grainSize = job->grainSize;
+		job->end = middle;
+		Push(half, thread);
+	}
+
+	job->invoke(job->function, job->begin, job->end);
+	Finish(job, thread);
+}
+
+// The counter's owner may destroy it as soon as it is done, so it counts as in use until this returns
+void JobSystem::Finish(Job* job, unsigned int thread)
+{
+	JobCounter& counter = *job->counter;
+	counter.mFinishing.fetch_add(1);
+	job->finished.store(true, std::memory_order_release); // The job can be reused from here on
+
+	if (counter.mPending.fetch_sub(1) == 1)
+	{
+		Job* waiting;
+		{
+			std::lock_guard<std::mutex> lock(counter.mMutex);
+			waiting = counter.mWaiting;
+			counter.mWaiting = nullptr;
+		}
+		while (waiting)
+		{
+			Job* next = waiting->nextWaiting;
+			Push(waiting, thread);
+			waiting = next;
+		}
+	}
+	counter.mFinishing.fetch_sub(1);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	const unsigned int thread = ThreadIndex();
+	while (!counter.IsDone())
+		RunOneOrYield(thread);
+}
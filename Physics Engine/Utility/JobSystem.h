@@ -0,0 +1,193 @@
+//=========================================================================================================
+// JobSystem.h: Work-Stealing Job System
+// - A fixed set of worker threads started once, each with its own deque of jobs (Chase-Lev). A thread
+//   pushes and pops jobs at the bottom of its own deque without locking, threads with nothing to do steal
+//   from the top of the others'. Idle workers spin briefly, then sleep until a job is pushed
+// - Jobs are counted by a JobCounter, which goes up when a job is submitted and down when it finishes.
+//   Wait runs other jobs until the counter reaches zero, so the thread that created the system works on
+//   the jobs too rather than blocking, and jobs can wait for jobs they started themselves
+// - A job can be held back until another counter reaches zero (RunAfter), to chain stages together
+// - ParallelFor splits its range in half over and over down to the grain size, pushing the second half
+//   as a new job each time. Thieves take from the top of a deque, so they take the largest pieces first
+//   and the splitting spreads itself over the threads
+// - Jobs may only be submitted from the thread that created the system or from inside its jobs
+//=========================================================================================================
+
+#ifndef _JOB_SYSTEM_H_DEFINED_
+#define _JOB_SYSTEM_H_DEFINED_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+class JobCounter;
+
+class JobSystem
+{
+public:
+	//================
+	// Constructors
+	//================
+
+	// threadCount: threads working on jobs including the calling thread, 0 for one per hardware thread
+	explicit JobSystem(unsigned int threadCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Stops the workers and starts a new set. No jobs may be running
+	void SetThreadCount(unsigned int threadCount);
+	unsigned int ThreadCount() const { return static_cast<unsigned int>(mThreads.size()); }
+
+	// 0 for the thread that created the system, 1 to ThreadCount - 1 for the workers
+	unsigned int ThreadIndex() const;
+
+	//=================
+	// Jobs
+	//=================
+
+	// Run function() as a job. The function is not copied, it must live until the job has finished
+	// With thousands of jobs already waiting on this thread it is called straight away instead
+	template<typename F> void Run(F& function, JobCounter& counter);
+
+	// As Run, but the job isn't started until "after" reaches zero
+	template<typename F> void RunAfter(JobCounter& after, F& function, JobCounter& counter);
+
+	// Run jobs until the counter reaches zero
+	void Wait(JobCounter& counter);
+
+	// Call function(begin, end) for pieces of [0, count) no larger than grainSize and wait for them all
+	// The pieces and which thread runs each vary from call to call, results must not depend on them
+	template<typename F> void ParallelFor(std::size_t count, std::size_t grainSize, F&& function);
+
+	// Jobs taken from another thread's deque since the system was started
+	std::size_t StealCount() const;
+
+private:
+	// Jobs are stored in a ring per thread and reused once finished, the deques hold pointers to them
+	struct alignas(64) Job
+	{
+		void (*invoke)(const void* function, std::size_t begin, std::size_t end);
+		const void* function;
+		std::size_t begin;
+		std::size_t end;
+		std::size_t grainSize; // Split the range down to this, 0 for a job that is called once
+		JobCounter* counter;
+		Job* nextWaiting;      // Held back jobs of a counter
+		std::atomic<bool> finished{ true };
+	};
+	struct Thread;
+	friend class JobCounter;
+
+	Job* NewJob(JobCounter& counter, unsigned int thread);
+	void SubmitAfter(JobCounter& after, Job* job, unsigned int thread);
+	void Execute(Job* job, unsigned int thread);
+	void Finish(Job* job, unsigned int thread);
+	void Push(Job* job, unsigned int thread);
+	bool RunOne(unsigned int thread);
+	void RunOneOrYield(unsigned int thread);
+
+	void Start(unsigned int threadCount);
+	void Stop();
+	void WorkerMain(unsigned int thread);
+
+private:
+	std::vector<std::unique_ptr<Thread>> mThreads; // Thread 0 is the creating thread, it has no std::thread
+
+	// Sleeping workers are woken when a job is pushed
+	std::atomic<std::size_t> mQueuedJobs{ 0 };
+	std::atomic<unsigned int> mSleepingWorkers{ 0 };
+	std::atomic<bool> mStopping{ false };
+	std::mutex mSleepMutex;
+	std::condition_variable mWake;
+};
+
+
+//=====================
+// Counters
+//=====================
+
+// Unfinished jobs submitted with this counter. Must outlive its jobs, and isn't reused until they finish
+class JobCounter
+{
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool IsDone() const { return mPending.load() == 0 && mFinishing.load() == 0; }
+
+private:
+	friend class JobSystem;
+
+	std::atomic<std::size_t> mPending{ 0 };
+	std::atomic<std::size_t> mFinishing{ 0 }; // Threads still using the counter after their job finished
+	std::mutex mMutex;                        // Guards mWaiting
+	JobSystem::Job* mWaiting = nullptr;       // Jobs held back until mPending reaches zero
+};
+
+
+//=====================
+// Templates
+//=====================
+
+template<typename F> void JobSystem::Run(F& function, JobCounter& counter)
+{
+	const unsigned int thread = ThreadIndex();
+	Job* job = NewJob(counter, thread);
+	if (!job)
+	{
+		function();
+		return;
+	}
+	job->invoke = [](const void* f, std::size_t, std::size_t) { (*static_cast<F*>(const_cast<void*>(f)))(); };
+	job->function = &function;
+	Push(job, thread);
+}
+
+template<typename F> void JobSystem::RunAfter(JobCounter& after, F& function, JobCounter& counter)
+{
+	// Can't be run straight away, so wait for room
+	const unsigned int thread = ThreadIndex();
+	Job* job = NewJob(counter, thread);
+	while (!job)
+	{
+		RunOneOrYield(thread);
+		job = NewJob(counter, thread);
+	}
+	job->invoke = [](const void* f, std::size_t, std::size_t) { (*static_cast<F*>(const_cast<void*>(f)))(); };
+	job->function = &function;
+	SubmitAfter(after, job, thread);
+}
+
+template<typename F> void JobSystem::ParallelFor(std::size_t count, std::size_t grainSize, F&& function)
+{
+	grainSize = std::max<std::size_t>(1, grainSize);
+	const unsigned int thread = ThreadIndex();
+	JobCounter counter;
+	Job* job = count > grainSize && mThreads.size() > 1 ? NewJob(counter, thread) : nullptr;
+	if (!job)
+	{
+		for (std::size_t begin = 0; begin < count; begin += grainSize)
+			function(begin, std::min(begin + grainSize, count));
+		return;
+	}
+
+	// The first job is run here, it pushes its second halves for the other threads as it splits
+	using Function = std::remove_reference_t<F>;
+	job->invoke = [](const void* f, std::size_t begin, std::size_t end) { (*static_cast<Function*>(const_cast<void*>(f)))(begin, end); };
+	job->function = &function;
+	job->begin = 0;
+	job->end = count;
+	job->grainSize = grainSize;
+	Execute(job, thread);
+	Wait(counter);
+}
+
+#endif // !_JOB_SYSTEM_H_DEFINED_
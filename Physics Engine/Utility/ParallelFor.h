@@ -0,0 +1,74 @@
+//=========================================================================================================
+// ParallelFor.h: Split a Loop into Equal Ranges Run on Separate Threads
+// - For large passes over arrays (broadphase sweeps, grid builds). Threads are started for the call and
+//   joined before it returns, so only worth it when each thread has thousands of items
+// - The ranges and their order depend only on the count and thread count, so results gathered per range
+//   can be merged in a repeatable order
+// - Given a job system (JobSystem.h) the ranges are jobs instead, run by its threads already waiting. Jobs
+//   aren't sure to run at the same time, so ranges must not wait for each other (e.g. at a barrier)
+//=========================================================================================================
+// Header-only: All functions are defined here so the compiler can inline them at the call site
+//=========================================================================================================
+
+#ifndef _PARALLEL_FOR_H_DEFINED_
+#define _PARALLEL_FOR_H_DEFINED_
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Number of hardware threads, at least 1
+inline unsigned int HardwareThreadCount()
+{
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Number of ranges ParallelFor will use: at most maxThreads, and fewer so each has at least minPerThread items
+inline unsigned int ParallelRangeCount(std::size_t count, unsigned int maxThreads, std::size_t minPerThread)
+{
+	const std::size_t ranges = std::min<std::size_t>(maxThreads, count / std::max<std::size_t>(1, minPerThread));
+	return static_cast<unsigned int>(std::max<std::size_t>(1, ranges));
+}
+
+// Call function(begin, end, range) for ParallelRangeCount equal ranges covering [0, count). The calling
+// thread runs the last range. Ranges are in order: range 0 starts at 0, range 1 follows it...
+template<typename F> void ParallelFor(std::size_t count, unsigned int maxThreads, std::size_t minPerThread, F&& function)
+{
+	const unsigned int ranges = ParallelRangeCount(count, maxThreads, minPerThread);
+
+	std::vector<std::thread> workers;
+	workers.reserve(ranges - 1);
+	for (unsigned int r = 0; r < ranges; ++r)
+	{
+		const std::size_t begin = count * r / ranges;
+		const std::size_t end = count * (r + 1) / ranges;
+		if (r + 1 < ranges)
+			workers.emplace_back([&function, begin, end, r]() { function(begin, end, r); });
+		else
+			function(begin, end, r);
+	}
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+// As above, with the ranges run as jobs when given a job system, or on threads started for the call if null
+template<typename F> void ParallelFor(JobSystem* jobs, std::size_t count, unsigned int maxThreads, std::size_t minPerThread, F&& function)
+{
+	if (!jobs)
+	{
+		ParallelFor(count, maxThreads, minPerThread, function);
+		return;
+	}
+
+	const unsigned int ranges = ParallelRangeCount(count, maxThreads, minPerThread);
+	jobs->ParallelFor(ranges, 1, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t r = first; r < last; ++r)
+			function(count * r / ranges, count * (r + 1) / ranges, static_cast<unsigned int>(r));
+	});
+}
+
+#endif // !_PARALLEL_FOR_H_DEFINED_
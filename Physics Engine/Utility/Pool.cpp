@@ -0,0 +1,106 @@
+//=========================================================================================================
+// Pool.cpp: Fixed-Size Pools and the Pools Behind PoolAllocator
+//=========================================================================================================
+
+#include "Pool.h"
+
+#include <algorithm>
+
+//=================
+// Untyped Pool
+//=================
+
+// Slots hold the free list's link while free, so are at least a pointer in size and alignment
+FixedPool::FixedPool(std::size_t slotSize, std::size_t alignment, std::size_t slotsPerBlock)
+	: mAlignment(std::max(alignment, alignof(FreeSlot)))
+	, mSlotsPerBlock(std::max<std::size_t>(1, slotsPerBlock))
+{
+	const std::size_t size = std::max(slotSize, sizeof(FreeSlot));
+	mSlotSize = (size + mAlignment - 1) / mAlignment * mAlignment;
+}
+
+FixedPool::~FixedPool()
+{
+	for (void* block : mBlocks)
+		::operator delete(block, std::align_val_t(mAlignment));
+}
+
+void* FixedPool::Allocate()
+{
+	if (!mFree)
+		NewBlock();
+
+	FreeSlot* slot = mFree;
+	mFree = slot->next;
+	mPeak = std::max(mPeak, ++mLive);
+	return slot;
+}
+
+void FixedPool::Free(void* slot)
+{
+	if (!slot)
+		return;
+	FreeSlot* freed = static_cast<FreeSlot*>(slot);
+	freed->next = mFree;
+	mFree = freed;
+	--mLive;
+}
+
+// The new block's slots go on the free list in address order, so objects created one after another sit
+// next to each other in memory
+void FixedPool::NewBlock()
+{
+	const std::size_t bytes = mSlotSize * mSlotsPerBlock;
+	char* block = static_cast<char*>(::operator new(bytes, std::align_val_t(mAlignment)));
+	mBlocks.push_back(block);
+	mCapacity += bytes;
+
+	for (std::size_t i = mSlotsPerBlock; i-- > 0; )
+	{
+		FreeSlot* slot = reinterpret_cast<FreeSlot*>(block + i * mSlotSize);
+		slot->next = mFree;
+		mFree = slot;
+	}
+}
+
+MemoryStats FixedPool::Stats() const
+{
+	MemoryStats stats;
+	stats.allocations = mLive;
+	stats.bytesInUse = mLive * mSlotSize;
+	stats.peakBytes = mPeak * mSlotSize;
+	stats.capacity = mCapacity;
+	stats.systemAllocations = mBlocks.size();
+	return stats;
+}
+
+
+//=================
+// Resource
+//=================
+
+FixedPool& PoolResource::PoolFor(std::size_t size, std::size_t alignment)
+{
+	for (const std::unique_ptr<FixedPool>& pool : mPools)
+	{
+		if (pool->SlotSize() >= size && pool->SlotSize() < size + pool->Alignment() && pool->Alignment() >= alignment)
+			return *pool;
+	}
+	mPools.push_back(std::make_unique<FixedPool>(size, alignment, mSlotsPerBlock));
+	return *mPools.back();
+}
+
+MemoryStats PoolResource::Stats() const
+{
+	MemoryStats total;
+	for (const std::unique_ptr<FixedPool>& pool : mPools)
+	{
+		const MemoryStats stats = pool->Stats();
+		total.allocations += stats.allocations;
+		total.bytesInUse += stats.bytesInUse;
+		total.peakBytes += stats.peakBytes;
+		total.capacity += stats.capacity;
+		total.systemAllocations += stats.systemAllocations;
+	}
+	return total;
+}
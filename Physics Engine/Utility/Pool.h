@@ -0,0 +1,158 @@
+//=========================================================================================================
+// Pool.h: Fixed-Size Object Pools
+// - Slots of one size carved from large blocks, freed slots are kept on a list and handed out again, so
+//   creating and destroying objects of one type never goes to the system once the pool has grown
+// - Pool<T> creates and destroys objects of type T. PoolResource keeps a pool per slot size and
+//   PoolAllocator lets node-based containers (std::list, std::map ...) take their nodes from it
+// - A pool is for one thread at a time
+//=========================================================================================================
+
+#ifndef _POOL_H_DEFINED_
+#define _POOL_H_DEFINED_
+
+#include "Arena.h" // For MemoryStats
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+//=====================
+// Untyped Pool
+//=====================
+
+class FixedPool
+{
+public:
+	FixedPool(std::size_t slotSize, std::size_t alignment, std::size_t slotsPerBlock = 256);
+	~FixedPool();
+
+	FixedPool(const FixedPool&) = delete;
+	FixedPool& operator=(const FixedPool&) = delete;
+
+	// Uninitialised slot of SlotSize bytes
+	void* Allocate();
+	void Free(void* slot);
+
+	std::size_t SlotSize() const { return mSlotSize; }
+	std::size_t Alignment() const { return mAlignment; }
+
+	MemoryStats Stats() const;
+
+private:
+	struct FreeSlot
+	{
+		FreeSlot* next;
+	};
+
+	void NewBlock();
+
+private:
+	std::size_t mSlotSize;
+	std::size_t mAlignment;
+	std::size_t mSlotsPerBlock;
+
+	std::vector<void*> mBlocks;
+	FreeSlot* mFree = nullptr;
+
+	std::size_t mLive = 0;
+	std::size_t mPeak = 0;
+	std::size_t mCapacity = 0;
+};
+
+
+//=====================
+// Typed Pool
+//=====================
+
+template<typename T> class Pool
+{
+public:
+	explicit Pool(std::size_t objectsPerBlock = 256) : mPool(sizeof(T), alignof(T), objectsPerBlock) {}
+
+	template<typename... Args> T* Create(Args&&... args)
+	{
+		void* slot = mPool.Allocate();
+		try
+		{
+			return new (slot) T(std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			mPool.Free(slot);
+			throw;
+		}
+	}
+
+	void Destroy(T* object)
+	{
+		if (!object)
+			return;
+		object->~T();
+		mPool.Free(object);
+	}
+
+	MemoryStats Stats() const { return mPool.Stats(); }
+
+private:
+	FixedPool mPool;
+};
+
+
+//=====================
+// STL Adaptor
+//=====================
+
+// A pool for each slot size asked for, made when first needed. Containers rebind their allocator to node
+// types they never name, so the pools can't be chosen up front
+class PoolResource
+{
+public:
+	explicit PoolResource(std::size_t slotsPerBlock = 256) : mSlotsPerBlock(slotsPerBlock) {}
+
+	FixedPool& PoolFor(std::size_t size, std::size_t alignment);
+
+	// Summed over the pools
+	MemoryStats Stats() const;
+
+private:
+	std::size_t mSlotsPerBlock;
+	std::vector<std::unique_ptr<FixedPool>> mPools;
+};
+
+// Single objects come from the resource's pools, arrays (e.g. a hash table's buckets) from the global
+// allocator. The resource must outlive every container using it
+template<typename T> class PoolAllocator
+{
+public:
+	using value_type = T;
+
+	PoolAllocator(PoolResource& resource) noexcept : mResource(&resource) {}
+	template<typename U> PoolAllocator(const PoolAllocator<U>& other) noexcept : mResource(other.GetResource()) {}
+
+	T* allocate(std::size_t count)
+	{
+		if (count == 1)
+			return static_cast<T*>(mResource->PoolFor(sizeof(T), alignof(T)).Allocate());
+		return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignof(T))));
+	}
+
+	void deallocate(T* p, std::size_t count) noexcept
+	{
+		if (count == 1)
+			mResource->PoolFor(sizeof(T), alignof(T)).Free(p);
+		else
+			::operator delete(p, std::align_val_t(alignof(T)));
+	}
+
+	PoolResource* GetResource() const { return mResource; }
+
+	template<typename U> bool operator==(const PoolAllocator<U>& other) const noexcept { return mResource == other.GetResource(); }
+	template<typename U> bool operator!=(const PoolAllocator<U>& other) const noexcept { return mResource != other.GetResource(); }
+
+private:
+	PoolResource* mResource;
+};
+
+#endif // !_POOL_H_DEFINED_